@@ -0,0 +1,42 @@
+/**
+ * @file ABRBench.cpp
+ * @brief Custo de AdaptiveBitRateController::UpdateMetrics por amostra de rede
+ */
+
+#include "OptimizationLayer.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// Arg 0: modo (0 = CONSERVATIVE, 1 = BALANCED, 2 = AGGRESSIVE, 3 = MODEL_BASED)
+void BM_ABRUpdateMetrics(benchmark::State& state) {
+    AdaptiveBitRateController controller(5, 100);
+    controller.SetAdaptationMode(
+        static_cast<AdaptiveBitRateController::AdaptationMode>(state.range(0)));
+
+    // Sequência fixa alternando rede boa/ruim para exercitar as mudanças de bitrate
+    const double latencies[] = { 20.0, 35.0, 90.0, 120.0, 45.0, 15.0, 60.0, 30.0 };
+    const double losses[] = { 0.1, 0.4, 4.0, 6.0, 0.8, 0.0, 2.0, 0.2 };
+    size_t index = 0;
+
+    // MODEL_BASED: relógio virtual de 100 ms por amostra, 6 frames confirmados por amostra
+    double nowMs = 0.0;
+    controller.SetTimeSource([&nowMs]() { return nowMs; });
+
+    for (auto _ : state) {
+        for (int frame = 0; frame < 6; ++frame) {
+            double sendMs = nowMs + frame * 16.7;
+            controller.OnPacketFeedback(sendMs, sendMs + latencies[index], 40000);
+        }
+        nowMs += 100.0;
+        controller.UpdateMetrics(latencies[index], losses[index], 30.0);
+        benchmark::DoNotOptimize(controller.GetTargetBitrate());
+        index = (index + 1) % 8;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["changes"] = static_cast<double>(controller.GetStats().bitrateChangeCount);
+}
+BENCHMARK(BM_ABRUpdateMetrics)->DenseRange(0, 3)->ArgName("mode");
+
+} // namespace
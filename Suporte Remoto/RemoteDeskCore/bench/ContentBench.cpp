@@ -0,0 +1,165 @@
+/**
+ * @file ContentBench.cpp
+ * @brief Classificação de conteúdo em uma tela sintética mista (texto + UI + vídeo)
+ *
+ * Layout 1080p: editor de texto à esquerda, player de vídeo 640x384 no canto
+ * superior direito e painéis de UI abaixo dele. Além do tempo por frame, os
+ * counters reportam a acurácia por classe contra o layout conhecido.
+ */
+
+#include "ContentClassifier.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t WIDTH = 1920;
+constexpr uint32_t HEIGHT = 1080;
+constexpr uint32_t STRIDE = WIDTH * 4;
+constexpr uint32_t TILE_SIZE = 64;
+
+constexpr uint32_t TEXT_RIGHT = 1152;                   // Texto: x < 1152
+constexpr uint32_t VIDEO_X = 1216, VIDEO_Y = 64;        // Vídeo alinhado a tiles
+constexpr uint32_t VIDEO_W = 640, VIDEO_H = 384;
+
+inline uint32_t Hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline void Put(std::vector<uint8_t>& frame, uint32_t x, uint32_t y,
+                uint8_t b, uint8_t g, uint8_t r) {
+    uint8_t* p = frame.data() + static_cast<size_t>(y) * STRIDE + x * 4;
+    p[0] = b; p[1] = g; p[2] = r; p[3] = 255;
+}
+
+ContentClass Truth(uint32_t tx, uint32_t ty) {
+    uint32_t cx = tx * TILE_SIZE + TILE_SIZE / 2;
+    uint32_t cy = ty * TILE_SIZE + TILE_SIZE / 2;
+    if (cx >= VIDEO_X && cx < VIDEO_X + VIDEO_W && cy >= VIDEO_Y && cy < VIDEO_Y + VIDEO_H) {
+        return ContentClass::VIDEO;
+    }
+    return cx < TEXT_RIGHT ? ContentClass::TEXT : ContentClass::UI;
+}
+
+// Tela base: texto anti-aliased (preto/cinza sobre branco) e painéis de UI
+void DrawDesktop(std::vector<uint8_t>& frame) {
+    for (uint32_t y = 0; y < HEIGHT; ++y) {
+        for (uint32_t x = 0; x < WIDTH; ++x) {
+            if (x < TEXT_RIGHT) {
+                // Linhas de 18 px com glifos 8x12; traços de 1-2 px com borda cinza
+                uint32_t line = y / 18, gy = y % 18;
+                uint32_t glyph = x / 8, gx = x % 8;
+                uint32_t seed = Hash(line * 4096 + glyph);
+                bool blank = gy >= 12 || gx == 7 || (seed & 7) == 0;
+                bool stroke = !blank && ((seed >> (gx + (gy % 4) * 3)) & 1);
+                uint8_t v = stroke ? 20 : 255;
+                if (!blank && !stroke && ((seed >> (gy + gx)) & 3) == 0) {
+                    v = 160;    // Anti-aliasing
+                }
+                Put(frame, x, y, v, v, v);
+            } else {
+                // Painéis planos com botões e gradiente suave de cabeçalho
+                uint32_t panel = (y / 96) % 3;
+                uint8_t base = static_cast<uint8_t>(230 - panel * 12);
+                bool button = (x % 160) >= 16 && (x % 160) < 112 && (y % 96) >= 40 && (y % 96) < 68;
+                if (button) {
+                    Put(frame, x, y, 215, 120, 0);
+                } else if ((y % 96) < 24) {
+                    uint8_t shade = static_cast<uint8_t>(200 + (x - TEXT_RIGHT) / 32);
+                    Put(frame, x, y, shade, shade, shade);
+                } else {
+                    Put(frame, x, y, base, base, base);
+                }
+            }
+        }
+    }
+}
+
+// Vídeo: gradiente em movimento + ruído de câmera, novo a cada frame
+void DrawVideo(std::vector<uint8_t>& frame, uint32_t frameIndex) {
+    for (uint32_t y = 0; y < VIDEO_H; ++y) {
+        for (uint32_t x = 0; x < VIDEO_W; ++x) {
+            uint32_t noise = Hash((frameIndex * VIDEO_H + y) * VIDEO_W + x) & 31;
+            uint8_t r = static_cast<uint8_t>((x + frameIndex * 3) / 3 + noise);
+            uint8_t g = static_cast<uint8_t>((y + frameIndex * 2) / 2 + noise);
+            uint8_t b = static_cast<uint8_t>((x + y) / 4 + frameIndex + noise);
+            Put(frame, VIDEO_X + x, VIDEO_Y + y, b, g, r);
+        }
+    }
+}
+
+// Digitação: troca um glifo por frame na região de texto
+void TypeGlyph(std::vector<uint8_t>& frame, uint32_t frameIndex) {
+    uint32_t gx0 = (frameIndex * 8) % TEXT_RIGHT;
+    uint32_t gy0 = 18 * 20;
+    for (uint32_t y = 0; y < 12; ++y) {
+        for (uint32_t x = 0; x < 7; ++x) {
+            uint8_t v = ((Hash(frameIndex) >> (x + y)) & 1) ? 20 : 255;
+            Put(frame, gx0 + x, gy0 + y, v, v, v);
+        }
+    }
+}
+
+void BM_ContentClassifyMixed(benchmark::State& state) {
+    constexpr uint32_t FRAME_VARIANTS = 8;
+
+    // Frames pré-gerados para medir só o classificador
+    std::vector<uint8_t> base(static_cast<size_t>(STRIDE) * HEIGHT);
+    DrawDesktop(base);
+
+    std::vector<std::vector<uint8_t>> frames(FRAME_VARIANTS, base);
+    for (uint32_t i = 0; i < FRAME_VARIANTS; ++i) {
+        DrawVideo(frames[i], i);
+        TypeGlyph(frames[i], i);
+    }
+
+    ContentClassifier classifier(TILE_SIZE);
+
+    // Aquecimento do histórico temporal (taxa de mudança)
+    for (uint32_t i = 0; i < 16; ++i) {
+        classifier.Classify(frames[i % FRAME_VARIANTS].data(), WIDTH, HEIGHT, STRIDE);
+    }
+
+    uint32_t index = 0;
+    for (auto _ : state) {
+        const ContentMap& map = classifier.Classify(frames[index % FRAME_VARIANTS].data(),
+                                                    WIDTH, HEIGHT, STRIDE);
+        benchmark::DoNotOptimize(map.videoTiles);
+        index++;
+    }
+
+    // Acurácia por classe contra o layout sintético
+    const ContentMap& map = classifier.GetMap();
+    uint32_t hits[3] = {}, totals[3] = {};
+    for (uint32_t ty = 0; ty < map.tilesY; ++ty) {
+        for (uint32_t tx = 0; tx < map.tilesX; ++tx) {
+            ContentClass truth = Truth(tx, ty);
+            totals[static_cast<int>(truth)]++;
+            if (map.classes[static_cast<size_t>(ty) * map.tilesX + tx] == truth) {
+                hits[static_cast<int>(truth)]++;
+            }
+        }
+    }
+
+    // Interseção/união do retângulo de vídeo detectado com o real
+    const FrameRect& r = map.videoRect;
+    double ix = std::max(0.0, std::min<double>(r.x + r.width, VIDEO_X + VIDEO_W) - std::max<double>(r.x, VIDEO_X));
+    double iy = std::max(0.0, std::min<double>(r.y + r.height, VIDEO_Y + VIDEO_H) - std::max<double>(r.y, VIDEO_Y));
+    double intersection = ix * iy;
+    double unionArea = static_cast<double>(r.width) * r.height + VIDEO_W * VIDEO_H - intersection;
+
+    state.counters["ui_acc"] = totals[0] ? static_cast<double>(hits[0]) / totals[0] : 0.0;
+    state.counters["text_acc"] = totals[1] ? static_cast<double>(hits[1]) / totals[1] : 0.0;
+    state.counters["video_acc"] = totals[2] ? static_cast<double>(hits[2]) / totals[2] : 0.0;
+    state.counters["video_iou"] = unionArea > 0.0 ? intersection / unionArea : 0.0;
+    state.counters["fps_hint"] = map.suggestedFps;
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(base.size()));
+}
+BENCHMARK(BM_ContentClassifyMixed)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,85 @@
+/**
+ * @file FrameBench.cpp
+ * @brief Cópia de linhas estilo Renderer::UpdateFrame e diff de frames BGRA
+ */
+
+#include "FrameUtils.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+namespace {
+
+struct Resolution {
+    uint32_t width;
+    uint32_t height;
+};
+
+constexpr Resolution RESOLUTIONS[] = { { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+// Arg 0: índice da resolução; Arg 1: padding extra no pitch destino (bytes)
+void BM_CopyFrameRows(benchmark::State& state) {
+    const Resolution res = RESOLUTIONS[state.range(0)];
+    const size_t rowBytes = static_cast<size_t>(res.width) * 4;
+    const size_t dstPitch = rowBytes + static_cast<size_t>(state.range(1));
+
+    std::vector<uint8_t> src(rowBytes * res.height, 0x11);
+    std::vector<uint8_t> dst(dstPitch * res.height);
+
+    for (auto _ : state) {
+        CopyFrameRows(dst.data(), dstPitch, src.data(), rowBytes, rowBytes, res.height);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(src.size()));
+}
+BENCHMARK(BM_CopyFrameRows)
+    ->ArgsProduct({ { 0, 1, 2 }, { 0, 256 } })
+    ->ArgNames({ "res", "pad" });
+
+// Arg 0: índice da resolução; Arg 1: porcentagem de linhas alteradas
+void BM_DiffFrameTiles(benchmark::State& state) {
+    const Resolution res = RESOLUTIONS[state.range(0)];
+    const uint32_t stride = res.width * 4;
+    const int64_t changedPercent = state.range(1);
+
+    std::vector<uint8_t> previous(static_cast<size_t>(stride) * res.height, 0x20);
+    std::vector<uint8_t> current = previous;
+
+    // Alteração de 1 pixel a cada 64 colunas nas primeiras N% linhas
+    const uint32_t changedRows = static_cast<uint32_t>(res.height * changedPercent / 100);
+    for (uint32_t y = 0; y < changedRows; ++y) {
+        for (uint32_t x = 0; x < res.width; x += 64) {
+            current[static_cast<size_t>(y) * stride + x * 4] ^= 0xFF;
+        }
+    }
+
+    std::vector<uint8_t> dirtyTiles;
+    for (auto _ : state) {
+        uint32_t dirty = DiffFrameTiles(previous.data(), current.data(),
+                                        res.width, res.height, stride, 64, dirtyTiles);
+        benchmark::DoNotOptimize(dirty);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(previous.size()));
+}
+BENCHMARK(BM_DiffFrameTiles)
+    ->ArgsProduct({ { 0, 2 }, { 0, 10, 100 } })
+    ->ArgNames({ "res", "changed%" });
+
+// Hashes por tile de cada frame enviado (histórico da retomada de sessão)
+void BM_HashFrameTiles(benchmark::State& state) {
+    const Resolution res = RESOLUTIONS[state.range(0)];
+    const uint32_t stride = res.width * 4;
+    std::vector<uint8_t> frame(static_cast<size_t>(stride) * res.height, 0x20);
+
+    std::vector<uint64_t> hashes;
+    for (auto _ : state) {
+        HashFrameTiles(frame.data(), res.width, res.height, stride, 64, hashes);
+        benchmark::DoNotOptimize(hashes.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_HashFrameTiles)->Arg(0)->Arg(2)->ArgName("res");
+
+} // namespace
@@ -0,0 +1,174 @@
+/**
+ * @file InputBench.cpp
+ * @brief Protocolo de input: 1 s de mouse a 1000 Hz com cliques e teclas, lotes por tick;
+ *        texto colado (UTF-8 → blocos KEYEVENTF_UNICODE); tradução uinput contra device mock
+ */
+
+#include "InputProtocol.h"
+#include "NetworkProtocol.h"
+#include "TextInput.h"
+#include "UInputInjector.h"
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace {
+
+// 1 s de input: movimento contínuo a 1000 Hz, um clique a cada 250 ms, tecla a cada 100 ms
+std::vector<InputEvent> MakeInputSecond() {
+    std::vector<InputEvent> events;
+    for (uint64_t ms = 0; ms < 1000; ++ms) {
+        const uint64_t t = ms * 1000;
+        int32_t x = 32768 + static_cast<int32_t>(20000 * std::sin(ms * 0.01));
+        int32_t y = 32768 + static_cast<int32_t>(12000 * std::cos(ms * 0.013));
+        events.push_back(InputEvent::MouseMove(x, y, t));
+
+        if (ms % 250 == 0) {
+            events.push_back(InputEvent::MouseButton(InputMouseButton::LEFT, true, t + 100));
+            events.push_back(InputEvent::MouseButton(InputMouseButton::LEFT, false, t + 200));
+        }
+        if (ms % 100 == 50) {
+            events.push_back(InputEvent::Key(static_cast<uint16_t>('A' + ms % 26), true, t + 300));
+            events.push_back(InputEvent::Key(static_cast<uint16_t>('A' + ms % 26), false, t + 400));
+        }
+    }
+    return events;
+}
+
+// Arg 0: tick de envio em µs (0 = um datagrama por evento)
+void BM_InputBatching(benchmark::State& state) {
+    const uint32_t tickUs = static_cast<uint32_t>(state.range(0));
+    const std::vector<InputEvent> events = MakeInputSecond();
+    std::vector<uint8_t> payload;
+
+    uint64_t datagrams = 0;
+    uint64_t bytes = 0;
+
+    for (auto _ : state) {
+        InputBatcher batcher(tickUs);
+        datagrams = 0;
+        bytes = 0;
+
+        for (const InputEvent& event : events) {
+            if (tickUs == 0) {
+                EncodeInputBatch(0, &event, 1, payload);
+                datagrams++;
+                bytes += sizeof(NetworkFrameHeader) + payload.size();
+                continue;
+            }
+
+            batcher.Push(event);
+            while (batcher.ShouldFlush(event.timestampUs) && batcher.Flush(payload, event.timestampUs)) {
+                datagrams++;
+                bytes += sizeof(NetworkFrameHeader) + payload.size();
+            }
+        }
+        benchmark::DoNotOptimize(payload.data());
+    }
+
+    // Por segundo de input (o cenário tem 1 s)
+    state.counters["datagrams/s"] = static_cast<double>(datagrams);
+    state.counters["wire_kbps"] = bytes * 8 / 1000.0;
+}
+BENCHMARK(BM_InputBatching)
+    ->Arg(0)->Arg(4000)->Arg(8000)
+    ->ArgNames({ "tick_us" })
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_InputDecode(benchmark::State& state) {
+    const std::vector<InputEvent> events = MakeInputSecond();
+    std::vector<uint8_t> payload;
+    EncodeInputBatch(1, events.data(), std::min(events.size(), INPUT_MAX_BATCH_EVENTS), payload);
+
+    InputBatch batch;
+    for (auto _ : state) {
+        bool ok = DecodeInputBatch(payload.data(), payload.size(), batch);
+        benchmark::DoNotOptimize(ok);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batch.events.size()));
+    state.counters["bytes/event"] = static_cast<double>(payload.size()) / batch.events.size();
+}
+BENCHMARK(BM_InputDecode);
+
+// Texto colado com acentos, quebras de linha e emoji. Arg 0: tamanho em KB
+void BM_TextKeyStrokes(benchmark::State& state) {
+    const std::string paragraph =
+        "Configuração do acesso remoto: ação concluída com êxito.\r\n"
+        "\tPróximo passo — validar a sessão \xF0\x9F\x98\x80 e reconectar.\n";
+    std::string text;
+    while (text.size() < static_cast<size_t>(state.range(0)) * 1024) {
+        text += paragraph;
+    }
+
+    std::vector<TextKeyStroke> strokes;
+    size_t chunks = 0;
+    for (auto _ : state) {
+        strokes.clear();
+        BuildTextKeyStrokes(text.data(), text.size(), strokes);
+
+        chunks = 0;
+        for (size_t begin = 0; begin < strokes.size(); ++chunks) {
+            begin = NextTextChunkEnd(strokes, begin, TEXT_MAX_CHUNK_STROKES);
+        }
+        benchmark::DoNotOptimize(strokes.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+    state.counters["SendInput_calls"] = static_cast<double>(chunks);
+    state.counters["strokes"] = static_cast<double>(strokes.size());
+}
+BENCHMARK(BM_TextKeyStrokes)
+    ->Arg(1)->Arg(64)
+    ->ArgNames({ "KB" })
+    ->Unit(benchmark::kMicrosecond);
+
+// Backend uinput sobre MockUInputDevice (sem root): 1 s de input em lotes de 4 ms
+void BM_UInputInject(benchmark::State& state) {
+    const std::vector<InputEvent> events = MakeInputSecond();
+
+    InputBatcher batcher(4000);
+    std::vector<uint8_t> payload;
+    std::vector<InputBatch> batches;
+    for (const InputEvent& event : events) {
+        batcher.Push(event);
+        while (batcher.ShouldFlush(event.timestampUs) && batcher.Flush(payload, event.timestampUs)) {
+            batches.emplace_back();
+            DecodeInputBatch(payload.data(), payload.size(), batches.back());
+        }
+    }
+
+    auto pointer = std::make_unique<MockUInputDevice>();
+    auto keyboard = std::make_unique<MockUInputDevice>();
+    MockUInputDevice* pointerDevice = pointer.get();
+    MockUInputDevice* keyboardDevice = keyboard.get();
+    UInputInjector injector(std::move(pointer), std::move(keyboard));
+    injector.Initialize();
+
+    uint64_t injected = 0;
+    uint64_t writes = 0;
+    uint64_t records = 0;
+    for (auto _ : state) {
+        pointerDevice->writes.clear();
+        keyboardDevice->writes.clear();
+        injected = 0;
+        for (const InputBatch& batch : batches) {
+            injected += injector.InjectEvents(batch.events.data(), batch.events.size());
+        }
+
+        writes = pointerDevice->writes.size() + keyboardDevice->writes.size();
+        records = 0;
+        for (const auto& write : pointerDevice->writes) records += write.size();
+        for (const auto& write : keyboardDevice->writes) records += write.size();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(injected));
+    state.counters["batches"] = static_cast<double>(batches.size());
+    state.counters["write_calls"] = static_cast<double>(writes);
+    state.counters["input_events"] = static_cast<double>(records);
+}
+BENCHMARK(BM_UInputInject)->Unit(benchmark::kMicrosecond);
+
+} // namespace
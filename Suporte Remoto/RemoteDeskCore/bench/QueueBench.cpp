@@ -0,0 +1,77 @@
+/**
+ * @file QueueBench.cpp
+ * @brief ThreadSafeQueue::Queue push/pop com 1..N threads concorrentes
+ *
+ * Threads de índice par produzem e ímpares consomem, como captura → encode.
+ */
+
+#include "OptimizationLayer.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+ThreadSafeQueue::Queue<uint64_t> g_contendedQueue;
+
+void BM_QueuePushPopSingleThread(benchmark::State& state) {
+    ThreadSafeQueue::Queue<uint64_t> queue;
+    uint64_t value = 0;
+
+    for (auto _ : state) {
+        queue.Push(value);
+        queue.TryPop(value);
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueuePushPopSingleThread);
+
+void BM_QueueContended(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_contendedQueue.Clear();
+    }
+
+    const bool isProducer = (state.thread_index() % 2) == 0 || state.threads() == 1;
+    uint64_t value = static_cast<uint64_t>(state.thread_index());
+    int64_t popped = 0;
+
+    for (auto _ : state) {
+        if (isProducer) {
+            g_contendedQueue.Push(value);
+        } else if (g_contendedQueue.TryPop(value)) {
+            ++popped;
+        }
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["popped"] = benchmark::Counter(static_cast<double>(popped),
+                                                  benchmark::Counter::kAvgThreads);
+
+    if (state.thread_index() == 0) {
+        g_contendedQueue.Clear();
+    }
+}
+BENCHMARK(BM_QueueContended)->ThreadRange(2, 8)->UseRealTime();
+
+// Payload realista: FrameBuffer 1080p movido pela fila (inclui cópia do vetor no Push)
+void BM_QueueFrameBuffer1080p(benchmark::State& state) {
+    ThreadSafeQueue::Queue<FrameBuffer> queue;
+    FrameBuffer frame;
+    frame.width = 1920;
+    frame.height = 1080;
+    frame.stride = 1920 * 4;
+    frame.pixels.resize(static_cast<size_t>(frame.stride) * frame.height);
+
+    FrameBuffer out;
+    for (auto _ : state) {
+        queue.Push(frame);
+        queue.TryPop(out);
+        benchmark::DoNotOptimize(out.pixels.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.pixels.size()));
+}
+BENCHMARK(BM_QueueFrameBuffer1080p);
+
+} // namespace
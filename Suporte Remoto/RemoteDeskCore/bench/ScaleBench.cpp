@@ -0,0 +1,104 @@
+/**
+ * @file ScaleBench.cpp
+ * @brief Downscaler do encode: 4K→1080p e 1440p→720p (box 2:1), degraus do ABR (bilinear)
+ */
+
+#include "FrameScaler.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+struct ScaleCase {
+    uint32_t srcWidth;
+    uint32_t srcHeight;
+    uint32_t dstWidth;
+    uint32_t dstHeight;
+    ScaleFilter filter;
+};
+
+constexpr ScaleCase CASES[] = {
+    { 3840, 2160, 1920, 1080, ScaleFilter::BOX },          // 4K → 1080p
+    { 2560, 1440, 1280,  720, ScaleFilter::BOX },          // 1440p → 720p
+    { 3840, 2160, 1920, 1080, ScaleFilter::BILINEAR },     // 4K → 1080p, bilinear forçado
+    { 2560, 1440, 1280,  720, ScaleFilter::BILINEAR },
+    { 1920, 1080, 1600,  900, ScaleFilter::BILINEAR },     // Degrau 5/6 da escada
+    { 1920, 1080, 1280,  720, ScaleFilter::BILINEAR },     // Degrau 2/3 da escada
+};
+
+std::vector<uint8_t> MakeSource(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    uint32_t seed = 0x12345678;
+    for (auto& value : pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    return pixels;
+}
+
+// Arg 0: índice do caso; Arg 1: SSE2 (1) ou escalar (0)
+void BM_ScaleFrame(benchmark::State& state) {
+    const ScaleCase& c = CASES[state.range(0)];
+    const uint32_t dstStride = c.dstWidth * 4;
+
+    std::vector<uint8_t> src = MakeSource(c.srcWidth, c.srcHeight);
+    std::vector<uint8_t> dst(static_cast<size_t>(dstStride) * c.dstHeight);
+
+    FrameScaler scaler;
+    if (!scaler.Configure(c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, c.filter)) {
+        state.SkipWithError("Configure failed");
+        return;
+    }
+    scaler.SetUseSimd(state.range(1) != 0);
+
+    for (auto _ : state) {
+        scaler.Scale(src.data(), c.srcWidth * 4, dst.data(), dstStride);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(src.size()));
+}
+BENCHMARK(BM_ScaleFrame)
+    ->ArgsProduct({ { 0, 1, 2, 3, 4, 5 }, { 0, 1 } })
+    ->ArgNames({ "case", "simd" })
+    ->Unit(benchmark::kMicrosecond);
+
+// 4K→1080p só nos tiles alterados. Arg 0: porcentagem de tiles 64x64 alterados
+void BM_ScaleDirtyTiles(benchmark::State& state) {
+    constexpr uint32_t SRC_W = 3840, SRC_H = 2160, DST_W = 1920, DST_H = 1080, TILE = 64;
+    const int64_t dirtyPercent = state.range(0);
+
+    std::vector<uint8_t> src = MakeSource(SRC_W, SRC_H);
+    std::vector<uint8_t> dst(static_cast<size_t>(DST_W) * DST_H * 4);
+
+    FrameScaler scaler;
+    scaler.Configure(SRC_W, SRC_H, DST_W, DST_H);
+
+    // Tiles alterados espalhados uniformemente
+    std::vector<FrameRect> dirtyRects;
+    const uint32_t tilesX = SRC_W / TILE, tilesY = (SRC_H + TILE - 1) / TILE;
+    for (uint32_t i = 0; i < tilesX * tilesY; ++i) {
+        if ((i * 37) % 100 < static_cast<uint32_t>(dirtyPercent)) {
+            FrameRect tile;
+            tile.x = (i % tilesX) * TILE;
+            tile.y = (i / tilesX) * TILE;
+            tile.width = TILE;
+            tile.height = std::min(TILE, SRC_H - tile.y);
+            dirtyRects.push_back(scaler.MapSourceRect(tile));
+        }
+    }
+
+    for (auto _ : state) {
+        for (const FrameRect& rect : dirtyRects) {
+            scaler.ScaleRegion(src.data(), SRC_W * 4, dst.data(), DST_W * 4, rect);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["tiles"] = static_cast<double>(dirtyRects.size());
+}
+BENCHMARK(BM_ScaleDirtyTiles)
+    ->Arg(5)->Arg(25)->Arg(100)
+    ->ArgNames({ "dirty%" })
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
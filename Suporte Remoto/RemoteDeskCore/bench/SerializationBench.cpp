@@ -0,0 +1,65 @@
+/**
+ * @file SerializationBench.cpp
+ * @brief Montagem de pacote como P2PManager::SendFrame + SendPacket (sem sendto)
+ */
+
+#include "NetworkProtocol.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+void BM_SerializePacket(benchmark::State& state) {
+    const size_t payloadSize = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> pixels(payloadSize, 0x5A);
+    std::vector<uint8_t> sendBuffer;
+    sendBuffer.reserve(sizeof(NetworkFrameHeader) + payloadSize);
+    uint16_t sequence = 0;
+
+    for (auto _ : state) {
+        // Mesmos passos de SendFrame: header, cópia dos pixels, serialização
+        NetworkPacket packet;
+        packet.header.magic = NetworkFrameHeader::MAGIC;
+        packet.header.version = NetworkFrameHeader::VERSION;
+        packet.header.frameSequence = sequence++;
+        packet.header.frameWidth = static_cast<uint32_t>(payloadSize / 4);
+        packet.header.frameHeight = 1;
+        packet.header.frameStride = static_cast<uint32_t>(payloadSize);
+        packet.header.pixelDataSize = static_cast<uint32_t>(payloadSize);
+        packet.header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        packet.header.flags = 0;
+
+        packet.pixelData.resize(payloadSize);
+        std::memcpy(packet.pixelData.data(), pixels.data(), payloadSize);
+
+        SerializePacket(packet, sendBuffer);
+        benchmark::DoNotOptimize(sendBuffer.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(payloadSize));
+}
+BENCHMARK(BM_SerializePacket)->Arg(1200)->Arg(16 * 1024)->Arg(64 * 1024 - 40);
+
+void BM_DeserializePacket(benchmark::State& state) {
+    const size_t payloadSize = static_cast<size_t>(state.range(0));
+    NetworkPacket source;
+    source.header = {};
+    source.header.magic = NetworkFrameHeader::MAGIC;
+    source.pixelData.assign(payloadSize, 0xA5);
+
+    std::vector<uint8_t> wire;
+    SerializePacket(source, wire);
+
+    NetworkPacket packet;
+    for (auto _ : state) {
+        bool ok = DeserializePacket(wire.data(), wire.size(), packet);
+        benchmark::DoNotOptimize(ok);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(wire.size()));
+}
+BENCHMARK(BM_DeserializePacket)->Arg(1200)->Arg(16 * 1024)->Arg(64 * 1024 - 40);
+
+} // namespace
@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * @file CertificateFingerprint.h
+ * @brief Fingerprint SHA-256 de certificado (formato a=fingerprint do SDP) para fixar o peer
+ *
+ * O host anuncia o fingerprint do seu certificado pela sinalização (como o DTLS do
+ * WebRTC) e o cliente compara com o certificado recebido no handshake. Certificado
+ * autoassinado serve: a confiança vem do canal de sinalização, não de uma CA.
+ *
+ * Exemplo:
+ * ```cpp
+ * std::string fingerprint;
+ * ComputeCertificateFileFingerprint("cert.pem", fingerprint);     // host → sinalização
+ * CertificateFingerprintMatches(fingerprint, der, derSize);       // cliente, no handshake
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr size_t SHA256_DIGEST_SIZE = 32;
+
+// SHA-256 (FIPS 180-4)
+void Sha256(const uint8_t* data, size_t size, uint8_t outDigest[SHA256_DIGEST_SIZE]);
+
+// SHA-256 do certificado DER em hex maiúsculo separado por ':' ("AB:CD:...")
+std::string FormatCertificateFingerprint(const uint8_t* der, size_t size);
+
+// Primeiro bloco CERTIFICATE de um arquivo PEM → DER
+bool LoadPemCertificate(const std::string& path, std::vector<uint8_t>& outDer);
+
+// Fingerprint do certificado de um arquivo PEM; false se não há certificado
+bool ComputeCertificateFileFingerprint(const std::string& path, std::string& outFingerprint);
+
+// Compara sem diferenciar maiúsculas e com ou sem ':'; fingerprint vazio nunca confere
+bool CertificateFingerprintMatches(const std::string& expected, const uint8_t* der, size_t size);
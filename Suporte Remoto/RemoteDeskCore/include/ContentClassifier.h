@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @file ContentClassifier.h
+ * @brief Classificação de regiões da tela em texto, UI ou vídeo para qualidade por região
+ *
+ * Cada tile recebe três features baratas, calculadas sobre uma amostra dos pixels:
+ * - número de cores distintas (texto/UI têm poucas, vídeo/foto muitas)
+ * - densidade de bordas (transições fortes de luminância, típicas de glifos)
+ * - taxa de mudança temporal (média móvel dos tiles alterados entre frames)
+ *
+ * O resultado é um ContentMap com a classe e o delta de QP de cada tile, o retângulo
+ * da região de vídeo e o fps sugerido para o conteúdo dominante.
+ *
+ * Exemplo:
+ * ```cpp
+ * ContentClassifier classifier;
+ * const ContentMap& map = classifier.Classify(frame.pixels.data(), frame.width,
+ *                                             frame.height, frame.stride);
+ * encoder->SetContentMap(map);
+ * ```
+ */
+
+#include "FrameTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class ContentClass : uint8_t {
+    UI = 0,         // Áreas planas, ícones, gradientes
+    TEXT = 1,       // Poucas cores e muitas bordas: alta qualidade, fps menor
+    VIDEO = 2       // Muitas cores e mudança contínua: lossy, fps cheio
+};
+
+// Features de um tile (expostas para diagnóstico e benchmarks)
+struct TileFeatures {
+    uint32_t colorCount = 0;        // Cores distintas (quantizadas) na amostra
+    float edgeDensity = 0.0f;       // Fração de pares vizinhos com borda forte
+    float changeRate = 0.0f;        // Média móvel de "tile alterado" (0..1)
+};
+
+struct ContentMap {
+    uint32_t tileSize = 0;
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    std::vector<ContentClass> classes;      // Um por tile, row-major
+    std::vector<int8_t> qpDeltas;           // Delta de QP por tile (negativo = mais qualidade)
+    FrameRect videoRect;                    // Maior região contígua de vídeo
+    uint32_t textTiles = 0;
+    uint32_t uiTiles = 0;
+    uint32_t videoTiles = 0;
+    uint32_t suggestedFps = 60;             // 60 com vídeo; menor para tela dominada por texto
+};
+
+class ContentClassifier {
+public:
+    explicit ContentClassifier(uint32_t tileSize = 64);
+
+    // Classifica um frame BGRA; o histórico temporal vem das chamadas anteriores
+    const ContentMap& Classify(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride);
+
+    const ContentMap& GetMap() const { return m_map; }
+    const std::vector<TileFeatures>& GetFeatures() const { return m_features; }
+
+    // Descarta o histórico (mudança de resolução, nova sessão)
+    void Reset();
+
+    // Expande o mapa de tiles para blocos de blockSize pixels (16 = macroblocos H.264),
+    // no layout esperado por NV_ENC_PIC_PARAMS::qpDeltaMap
+    static void BuildBlockQpMap(const ContentMap& map, uint32_t width, uint32_t height,
+                                uint32_t blockSize, std::vector<int8_t>& outBlockDeltas);
+
+private:
+    void ComputeTileFeatures(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride);
+    void UpdateChangeRates(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride);
+    void FindVideoRect();
+
+    uint32_t m_tileSize;
+    ContentMap m_map;
+    std::vector<TileFeatures> m_features;
+
+    // Frame anterior (compactado, stride = width * 4) para a taxa de mudança
+    std::vector<uint8_t> m_previousFrame;
+    std::vector<uint8_t> m_dirtyTiles;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+/**
+ * @file CursorProtocol.h
+ * @brief Cursor como canal separado do vídeo: posição e forma em mensagens pequenas
+ *
+ * O Desktop Duplication entrega o ponteiro fora da imagem da tela. O host envia:
+ * - CURSOR_POSITION (24 bytes) a cada movimento, com o hash da forma atual
+ * - CURSOR_SHAPE (16 bytes + BGRA) só quando a forma muda ou o cliente pede
+ *
+ * O cliente guarda as formas por hash (CursorShapeCache) e desenha o cursor
+ * localmente a cada refresh, então mover o mouse não gera bytes de vídeo.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Maior forma enviada (formas maiores são recortadas; 96x96 BGRA cabe em um datagrama)
+constexpr uint32_t CURSOR_MAX_DIMENSION = 96;
+
+// Formatos do DXGI_OUTDUPL_POINTER_SHAPE_TYPE (mesmos valores)
+enum class CursorShapeType : uint32_t {
+    MONOCHROME = 1,         // 1 bpp: máscara AND seguida da máscara XOR (altura dobrada)
+    COLOR = 2,              // BGRA com alpha
+    MASKED_COLOR = 4        // BGRA onde o alpha indica XOR com a tela
+};
+
+struct CursorPositionMessage {
+    int32_t x;                  // Posição do ponteiro em pixels da captura (pode ser negativa)
+    int32_t y;
+    uint64_t shapeHash;         // Forma atual (0 = nenhuma)
+    uint16_t sourceWidth;       // Resolução da captura (para mapear na janela do cliente)
+    uint16_t sourceHeight;
+    uint8_t visible;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(CursorPositionMessage) == 24, "CursorPositionMessage must be 24 bytes");
+
+struct CursorShapeHeader {
+    uint64_t hash;
+    uint16_t width;
+    uint16_t height;
+    int16_t hotspotX;
+    int16_t hotspotY;
+};
+
+static_assert(sizeof(CursorShapeHeader) == 16, "CursorShapeHeader must be 16 bytes");
+
+// Forma já convertida para BGRA com alpha (pré-multiplicação não aplicada)
+struct CursorShape {
+    uint64_t hash = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t hotspotX = 0;
+    int32_t hotspotY = 0;
+    std::vector<uint8_t> pixels;    // width * height * 4
+};
+
+// Converte a forma do DXGI (GetFramePointerShape) para BGRA e calcula o hash.
+// Pixels XOR (inversão da tela) viram preto opaco, a aproximação usual sem acesso à tela
+bool ConvertCursorShape(CursorShapeType type, uint32_t width, uint32_t height, uint32_t pitch,
+                        const uint8_t* data, size_t dataSize, int32_t hotspotX, int32_t hotspotY,
+                        CursorShape& outShape);
+
+// FNV-1a 64 sobre dimensões, hotspot e pixels
+uint64_t HashCursorShape(const CursorShape& shape);
+
+// Serialização das mensagens (payload de P2PManager::SendControlMessage)
+void SerializeCursorShape(const CursorShape& shape, std::vector<uint8_t>& outPayload);
+bool DeserializeCursorShape(const uint8_t* data, size_t size, CursorShape& outShape);
+bool DeserializeCursorPosition(const uint8_t* data, size_t size, CursorPositionMessage& outPosition);
+
+/**
+ * @class CursorShapeCache
+ * @brief Formas recentes por hash (LRU); o host responde pedidos, o cliente evita reenvios
+ */
+class CursorShapeCache {
+public:
+    explicit CursorShapeCache(size_t capacity = 32) : m_capacity(capacity) {}
+
+    // Insere ou atualiza a forma (marca como usada)
+    void Put(const CursorShape& shape);
+
+    // nullptr se a forma não está no cache
+    const CursorShape* Find(uint64_t hash);
+
+    size_t Size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        CursorShape shape;
+        uint64_t lastUsed = 0;
+    };
+
+    size_t m_capacity;
+    std::vector<Entry> m_entries;
+    uint64_t m_useCounter = 0;
+};
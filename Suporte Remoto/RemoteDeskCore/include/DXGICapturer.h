@@ -1,5 +1,8 @@
 #pragma once
 
+#include "FrameTypes.h"
+#include "CursorProtocol.h"
+
 #include <vector>
 #include <cstdint>
 #include <d3d11.h>
@@ -9,14 +12,6 @@
 
 using Microsoft::WRL::ComPtr;
 
-struct FrameData {
-    std::vector<uint8_t> pixels;
-    uint32_t width;
-    uint32_t height;
-    uint32_t stride;
-    bool hasChanged;
-};
-
 class DXGICapturer {
 public:
     DXGICapturer();
@@ -31,6 +26,21 @@ public:
     // Libera os recursos
     void Release();
 
+    // Ponteiro: o Desktop Duplication não o desenha na imagem, então posição e
+    // forma seguem por um canal próprio (CursorProtocol.h)
+    struct CursorState {
+        int32_t x = 0;
+        int32_t y = 0;
+        bool visible = false;
+        uint64_t shapeHash = 0;     // 0 = forma ainda não recebida
+    };
+
+    const CursorState& GetCursorState() const { return m_cursor; }
+    const CursorShape& GetCursorShape() const { return m_cursorShape; }
+
+    // Lê a posição atual (GetCursorInfo) entre frames do DXGI
+    void PollCursorPosition();
+
     // Obtém dimensões da tela
     uint32_t GetScreenWidth() const { return m_screenWidth; }
     uint32_t GetScreenHeight() const { return m_screenHeight; }
@@ -42,6 +52,9 @@ private:
     // Copia a textura para memória CPU
     bool CopyFrameToBuffer(ID3D11Texture2D* sourceTexture, FrameData& outFrame);
 
+    // Atualiza posição/forma do ponteiro a partir do frame adquirido
+    void UpdateCursor(const DXGI_OUTDUPL_FRAME_INFO& frameInfo);
+
     ComPtr<ID3D11Device> m_device;
     ComPtr<ID3D11DeviceContext> m_deviceContext;
     ComPtr<IDXGIOutputDuplication> m_desktopDuplication;
@@ -51,6 +64,12 @@ private:
     uint32_t m_screenWidth = 0;
     uint32_t m_screenHeight = 0;
     uint32_t m_stride = 0;
+    int32_t m_desktopLeft = 0;
+    int32_t m_desktopTop = 0;
+
+    CursorState m_cursor;
+    CursorShape m_cursorShape;
+    std::vector<uint8_t> m_pointerShapeBuffer;
 
     static const uint32_t FRAME_ACQUIRE_TIMEOUT_MS = 100;
 };
@@ -0,0 +1,261 @@
+#pragma once
+
+/**
+ * @file DataChannelMux.h
+ * @brief Vários data channels (confiabilidade parcial estilo SCTP) sobre um IDatagramChannel
+ *
+ * Um único stream SCTP ordenado e confiável põe todo frame atrás do pacote perdido
+ * (head-of-line blocking): um datagrama perdido atrasa em 1 RTO todos os frames
+ * seguintes. Cada peer connection abre, então, um canal por tipo de tráfego:
+ *
+ * | Canal   | Ordem        | Confiabilidade                    | Uso                        |
+ * |---------|--------------|-----------------------------------|----------------------------|
+ * | VIDEO   | não ordenado | maxRetransmits = 0                | frames (o próximo substitui)|
+ * | INPUT   | ordenado     | confiável                         | lotes de input             |
+ * | CONTROL | não ordenado | maxPacketLifeTime = 250 ms        | cursor / controle          |
+ *
+ * Com libdatachannel cada canal vira um rtc::DataChannel com rtc::Reliability
+ * equivalente (unordered, maxRetransmits / maxPacketLifeTime). DataChannelMux é o
+ * mesmo modelo implementado sobre datagramas, usado pelo loopback em processo
+ * (WebRTCDataChannel::InitializeWithChannel + EmulatedLink) e pelo rdc_dcloop.
+ *
+ * Formato do datagrama (little-endian):
+ * ```
+ * u8 type | u8 channel
+ *   DATA    u32 tsn | u32 msgSeq | u32 floorMsgSeq | u16 fragIndex | u16 fragCount | u8 flags | payload
+ *   ACK     u16 count | count × u32 tsn
+ *   FORWARD u32 floorMsgSeq
+ * ```
+ * tsn numera datagramas (para ACK/retransmissão); msgSeq numera mensagens por canal.
+ * floorMsgSeq é a menor mensagem ainda pendente no sender: tudo abaixo dela foi
+ * confirmado ou abandonado, e o receiver de um canal ordenado pode pular o que falta
+ * (o FORWARD-TSN do SCTP, de carona em cada DATA). As flags (ORDERED, RELIABLE) vão
+ * em cada DATA, então só o lado que envia precisa da configuração do canal.
+ *
+ * Sem controle de congestionamento: o ritmo é do chamador. SetSendRateKbps liga um
+ * pacer (token bucket, INPUT > CONTROL > VIDEO); o que não cabe espera na fila do
+ * canal e aparece em GetBufferedAmount (fila + bytes sem ACK, como o bufferedAmount
+ * do RTCDataChannel). Os watermarks avisam quando o canal passa do limite alto e
+ * quando volta ao baixo; o chamador pula frames (ou DropPendingMessages) e repassa
+ * o nível ao ABR (AdaptiveBitRateController::UpdateSendBuffer).
+ *
+ * Mensagens em std::shared_ptr<const std::vector<uint8_t>> não são copiadas: fila e
+ * retransmissões referenciam o buffer. Uma std::span é enviada direto quando pode sair
+ * inteira na hora sem retransmissão; caso contrário é copiada uma vez.
+ *
+ * Não é thread-safe: Send/Poll/Receive na mesma thread.
+ */
+
+#include "DatagramChannel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+enum class DataChannelKind : uint8_t {
+    VIDEO = 0,
+    INPUT = 1,
+    CONTROL = 2,     // Cursor e mensagens de controle
+};
+
+constexpr size_t DATA_CHANNEL_KIND_COUNT = 3;
+
+/**
+ * @struct DataChannelReliability
+ * @brief Mesmo significado de RTCDataChannelInit / rtc::Reliability
+ */
+struct DataChannelReliability {
+    bool ordered = true;
+    int32_t maxRetransmits = -1;        ///< -1 = sem limite; 0 = nunca retransmite
+    uint32_t maxPacketLifeTimeMs = 0;   ///< 0 = sem limite de tempo
+
+    // Precisa de ACK (retransmite pelo menos uma vez ou até o tempo de vida)
+    bool NeedsAck() const { return maxRetransmits != 0; }
+};
+
+// Configuração padrão do canal (ver tabela acima)
+DataChannelReliability DefaultDataChannelReliability(DataChannelKind kind);
+
+// Label do canal na peer connection ("video", "input", "control")
+const char* DataChannelLabel(DataChannelKind kind);
+
+/**
+ * @class DataChannelMux
+ * @brief Canais DataChannelKind sobre um transporte de datagramas, com tempo explícito
+ *
+ * ```cpp
+ * DataChannelMux mux(link->CreateEndpoint(EmulatedLink::Side::A));
+ * mux.Send(DataChannelKind::VIDEO, frame.data(), frame.size(), nowUs);
+ * mux.Poll(nowUs);    // lê datagramas, envia ACKs, retransmite/abandona
+ * while (mux.Receive(kind, message)) { ... }
+ * ```
+ */
+class DataChannelMux {
+public:
+    /// (canal, bufferedAmount atual)
+    using BufferedAmountCallback = std::function<void(DataChannelKind, size_t)>;
+
+    struct ChannelStats {
+        uint64_t messagesSent = 0;
+        uint64_t messagesDelivered = 0;     // Entregues a Receive() neste lado
+        uint64_t messagesAbandoned = 0;     // Sender desistiu (maxRetransmits / tempo de vida / descarte)
+        uint64_t messagesDropped = 0;       // Receiver descartou (incompleta ou atrasada)
+        uint64_t datagramsSent = 0;
+        uint64_t retransmissions = 0;
+        uint64_t bytesSent = 0;             // Datagramas, com header e retransmissões
+        uint64_t bytesReceived = 0;
+    };
+
+    // Payload máximo por datagrama (cabe em 1200 bytes com o header, sem fragmentação IP)
+    static constexpr size_t MAX_FRAGMENT_PAYLOAD = 1180;
+
+    explicit DataChannelMux(std::shared_ptr<IDatagramChannel> transport);
+
+    // Troca a confiabilidade das próximas mensagens do canal
+    void Configure(DataChannelKind kind, const DataChannelReliability& reliability);
+    const DataChannelReliability& GetReliability(DataChannelKind kind) const;
+
+    // Fragmenta e envia (ou enfileira) uma mensagem; false se vazia, grande demais
+    // ou o transporte falhou
+    bool Send(DataChannelKind kind, std::span<const uint8_t> data, uint64_t nowUs);
+    bool Send(DataChannelKind kind, std::shared_ptr<const std::vector<uint8_t>> buffer, uint64_t nowUs);
+    bool Send(DataChannelKind kind, const uint8_t* data, size_t size, uint64_t nowUs) {
+        return Send(kind, std::span<const uint8_t>(data, data ? size : 0), nowUs);
+    }
+
+    // Pacer de envio em kbps (0 = sem limite, padrão)
+    void SetSendRateKbps(double kbps);
+
+    // Bytes na fila do canal + bytes enviados sem ACK
+    size_t GetBufferedAmount(DataChannelKind kind) const;
+
+    // Watermarks do canal: onHigh ao passar de high, onLow ao voltar a <= low (0 = desligado)
+    void SetBufferedAmountThresholds(DataChannelKind kind, size_t lowBytes, size_t highBytes);
+    void SetBufferedAmountCallbacks(BufferedAmountCallback onLow, BufferedAmountCallback onHigh);
+    bool IsAboveHighWatermark(DataChannelKind kind) const;
+
+    // Descarta mensagens da fila que ainda não começaram a sair; retorna quantas
+    size_t DropPendingMessages(DataChannelKind kind);
+
+    // Lê o transporte, entrega mensagens completas, envia ACKs e trata timeouts
+    void Poll(uint64_t nowUs);
+
+    // Próxima mensagem entregue (false se não há)
+    bool Receive(DataChannelKind& outKind, std::vector<uint8_t>& outData);
+
+    // RTT suavizado medido pelos ACKs (0 antes da primeira amostra)
+    double GetSmoothedRttMs() const { return m_srttUs / 1000.0; }
+
+    // Bytes de payload aguardando ACK no canal
+    size_t GetOutstandingBytes(DataChannelKind kind) const;
+
+    ChannelStats GetStats(DataChannelKind kind) const;
+
+private:
+    using SharedBuffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // Mensagem na fila do canal (fragmentos saem conforme o pacer)
+    struct PendingMessage {
+        SharedBuffer buffer;
+        uint32_t msgSeq = 0;
+        uint16_t fragCount = 0;
+        uint16_t nextFragment = 0;
+        uint8_t flags = 0;
+        int32_t maxRetransmits = -1;
+        uint32_t lifetimeMs = 0;
+        uint64_t enqueueUs = 0;
+    };
+
+    // Fragmento enviado aguardando ACK (referencia o buffer da mensagem)
+    struct OutPacket {
+        SharedBuffer buffer;
+        size_t offset = 0;
+        size_t size = 0;
+        uint32_t msgSeq = 0;
+        uint16_t fragIndex = 0;
+        uint16_t fragCount = 0;
+        uint8_t flags = 0;
+        uint64_t firstSendUs = 0;           // Enfileiramento da mensagem (tempo de vida)
+        uint64_t lastSendUs = 0;
+        int32_t retransmits = 0;
+        int32_t maxRetransmits = -1;
+        uint32_t lifetimeMs = 0;
+    };
+
+    struct Reassembly {
+        std::vector<std::vector<uint8_t>> fragments;
+        std::vector<bool> present;
+        uint16_t received = 0;
+        bool reliable = false;
+        uint64_t firstArrivalUs = 0;
+    };
+
+    struct SendState {
+        DataChannelReliability reliability;
+        uint32_t nextTsn = 0;
+        uint32_t nextMsgSeq = 0;
+        std::map<uint32_t, OutPacket> outstanding;   // tsn → pacote aguardando ACK
+        size_t outstandingBytes = 0;
+        std::deque<PendingMessage> queue;
+        size_t queuedBytes = 0;                      // Fragmentos da fila ainda não enviados
+        uint32_t forwardRepeats = 0;                 // FORWARD ainda a reenviar
+        uint64_t lastForwardUs = 0;
+        size_t lowWatermark = 0;
+        size_t highWatermark = 0;
+        bool aboveLow = false;
+        bool aboveHigh = false;
+    };
+
+    struct ReceiveState {
+        std::map<uint32_t, Reassembly> partial;              // msgSeq → fragmentos
+        std::map<uint32_t, std::vector<uint8_t>> waiting;    // Completas fora de ordem (ordenado)
+        uint32_t nextDeliver = 0;                            // Canal ordenado
+        uint32_t floor = 0;                                  // Último floorMsgSeq do sender
+        std::deque<uint32_t> recentDelivered;                // Deduplicação (não ordenado)
+        std::vector<uint32_t> pendingAcks;
+    };
+
+    void HandleDatagram(const uint8_t* data, size_t size, uint64_t nowUs);
+    void HandleData(size_t channel, const uint8_t* data, size_t size, uint64_t nowUs);
+    void HandleAck(size_t channel, const uint8_t* data, size_t size, uint64_t nowUs);
+    void AdvanceFloor(size_t channel, uint32_t floor);
+    void Deliver(size_t channel, std::vector<uint8_t>&& message);
+    void CompleteMessage(size_t channel, uint32_t msgSeq, uint8_t flags, std::vector<uint8_t>&& message);
+    void ServiceTimers(size_t channel, uint64_t nowUs);
+    void Abandon(size_t channel, uint32_t msgSeq);
+    void SendAcks(size_t channel);
+    void SendForward(size_t channel, uint64_t nowUs);
+    bool Enqueue(size_t channel, SharedBuffer buffer, uint64_t nowUs);
+    bool DrainQueues(uint64_t nowUs);
+    bool SendFragment(size_t channel, PendingMessage& message, uint64_t nowUs);
+    bool TransmitData(size_t channel, uint32_t tsn, uint32_t msgSeq, uint32_t floor,
+                      uint16_t fragIndex, uint16_t fragCount, uint8_t flags,
+                      const uint8_t* payload, size_t size);
+    bool Transmit(size_t channel, const std::vector<uint8_t>& datagram);
+    void RefillTokens(uint64_t nowUs);
+    void CheckWatermarks(size_t channel);
+    uint32_t Floor(const SendState& state) const;
+    uint64_t RetransmitTimeoutUs() const;
+    void AddRttSample(uint64_t sampleUs);
+
+    std::shared_ptr<IDatagramChannel> m_transport;
+    SendState m_send[DATA_CHANNEL_KIND_COUNT];
+    ReceiveState m_receive[DATA_CHANNEL_KIND_COUNT];
+    ChannelStats m_stats[DATA_CHANNEL_KIND_COUNT];
+    std::deque<std::pair<DataChannelKind, std::vector<uint8_t>>> m_delivered;
+    std::vector<uint8_t> m_scratch;
+    std::vector<uint8_t> m_sendScratch;
+    BufferedAmountCallback m_onBufferedAmountLow;
+    BufferedAmountCallback m_onBufferedAmountHigh;
+    double m_sendRateKbps = 0.0;
+    double m_tokensBytes = 0.0;
+    uint64_t m_lastRefillUs = 0;
+    bool m_pacerPrimed = false;
+    double m_srttUs = 0.0;
+    double m_rttVarUs = 0.0;
+};
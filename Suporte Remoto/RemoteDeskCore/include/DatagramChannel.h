@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * @file DatagramChannel.h
+ * @brief Transporte de datagramas alternativo ao socket UDP do P2PManager
+ *
+ * Permite ligar dois P2PManager por canais em memória (ex: LinkEmulator)
+ * sem abrir sockets, com o mesmo formato de fio de NetworkProtocol.h.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class IDatagramChannel {
+public:
+    virtual ~IDatagramChannel() = default;
+
+    // Envia um datagrama (false = erro; descarte pelo link não é erro)
+    virtual bool Send(const uint8_t* data, size_t size) = 0;
+
+    // Retira o próximo datagrama disponível (não-bloqueante)
+    virtual bool Receive(std::vector<uint8_t>& outDatagram) = 0;
+
+    // Espera até haver datagrama disponível ou timeout
+    virtual bool WaitReadable(int timeoutMs) = 0;
+
+    // Bytes aceitos por Send e ainda não entregues à rede (0 = não medido)
+    virtual size_t GetBufferedAmount() const { return 0; }
+};
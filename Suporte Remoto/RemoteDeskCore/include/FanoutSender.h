@@ -0,0 +1,252 @@
+#pragma once
+
+/**
+ * @file FanoutSender.h
+ * @brief Um host, vários viewers: cada frame é codificado e serializado uma vez e o
+ * mesmo buffer (refcount) vai para todos
+ *
+ * P2PManager continua ponto a ponto (um peer por instância). O FanoutSender guarda um
+ * P2PManager por viewer (porta UDP própria + LockPeer, ou um canal) e, por viewer:
+ * - ritmo: token bucket em maxRateKbps e fila curta de frames (ponteiros compartilhados)
+ * - recuperação de perda: um frame que não é keyframe depende do anterior. Se a fila
+ *   do viewer transborda, ou o viewer manda KEYFRAME_REQUEST (FrameChainTracker do
+ *   lado do cliente viu um buraco na sequência), ele passa a esperar um keyframe e não
+ *   recebe mais deltas até lá
+ * - estatísticas próprias (ViewerStats)
+ *
+ * O encoder roda uma vez por frame para todos: NeedsKeyframe() diz ao host quando
+ * forçar um keyframe, e um keyframe atende de uma vez todos os viewers que esperam
+ * (com intervalo mínimo, para 50 viewers com perda não virarem keyframe em todo frame).
+ * ```cpp
+ * bool key = fanout.NeedsKeyframe(nowUs);
+ * encoder->EncodeFrame(bgra, w, h, stride, encoded, key);
+ * fanout.PublishFrame(encoded, stride, sequence++);
+ * fanout.Service(nowUs);     // a cada iteração: ritmo, KEYFRAME_REQUEST, probes
+ * ```
+ * O custo por viewer a mais é só o envio (sendto/canal); codificação e serialização
+ * não crescem com o número de viewers.
+ *
+ * Simulcast (SimulcastEncoder.h): o host publica as camadas de cada frame
+ * (EncodedFrame::layerId, mesma sequence) e cada viewer recebe uma. O controlador do
+ * viewer (um AdaptiveBitRateController por viewer) passa o alvo para
+ * UpdateViewerTarget, que escolhe a maior camada cujo bitrate medido cabe no alvo:
+ * desce na hora, sobe uma camada por vez depois de LAYER_UP_HOLD com folga. A troca
+ * acontece no próximo keyframe da camada nova (KeyframeLayerMask pede um), então
+ * a cadeia do viewer não quebra.
+ */
+
+#include "FrameTypes.h"
+#include "NetworkProtocol.h"
+#include "P2PManager.h"
+#include "TransportStats.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+enum class KeyframeRequestReason : uint8_t {
+    JOINED = 0,             // Ainda sem keyframe desde que entrou
+    FRAME_GAP = 1,          // Buraco na sequência (perda)
+    UNDECODABLE = 2         // Frame chegou mas não aplicou (ex: delta inválido)
+};
+
+// Payload de KEYFRAME_REQUEST
+struct KeyframeRequestMessage {
+    uint16_t lastSequence;          // Último frame decodificado (0 se nenhum)
+    uint8_t reason;                 // KeyframeRequestReason
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(KeyframeRequestMessage) == 8, "KeyframeRequestMessage must be 8 bytes");
+
+struct FanoutConfig {
+    uint64_t keyframeMinIntervalUs = 250000;    // Entre keyframes pedidos por viewers
+    uint64_t requestHoldoffUs = 150000;         // Pedido logo após um keyframe (+RTT): ignorado
+};
+
+struct FanoutViewerConfig {
+    double maxRateKbps = 0.0;       // Ritmo de envio (0 = sem limite)
+    uint32_t burstBytes = 65536;    // Crédito máximo acumulado do token bucket
+    size_t maxQueuedFrames = 2;     // Além disso a fila é descartada e o viewer espera keyframe
+    uint8_t layer = 0;              // Camada inicial (simulcast)
+};
+
+/**
+ * @class FanoutSender
+ * @brief Distribui frames codificados uma vez para N viewers, com ritmo e keyframes por viewer
+ */
+class FanoutSender {
+public:
+    using ViewerId = uint32_t;
+
+    struct ViewerStats {
+        ViewerId id = 0;
+        uint64_t framesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t keyframesSent = 0;
+        uint64_t framesSkipped = 0;         // Deltas não enviados: esperando keyframe
+        uint64_t framesDropped = 0;         // Descartados da fila (viewer mais lento que a fonte)
+        uint64_t keyframeRequests = 0;      // KEYFRAME_REQUEST recebidos (inclui os ignorados)
+        uint64_t sendFailures = 0;
+        size_t queuedFrames = 0;
+        bool awaitingKeyframe = false;
+        double maxRateKbps = 0.0;
+        double targetKbps = 0.0;            // Último UpdateViewerTarget
+        uint8_t layer = 0;                  // Camada recebida
+        uint8_t targetLayer = 0;            // Camada escolhida (troca no keyframe dela)
+        uint64_t layerSwitches = 0;
+        uint64_t idleMs = 0;                // Desde o último pacote do viewer
+        TransportStats transport;
+    };
+
+    struct Stats {
+        uint64_t framesPublished = 0;
+        uint64_t keyframesPublished = 0;
+        uint64_t bytesSerialized = 0;       // Uma vez por frame, independente dos viewers
+        uint64_t datagramsSent = 0;         // Soma dos envios aos viewers
+        size_t viewerCount = 0;
+    };
+
+    // Mensagens de controle dos viewers que não são KEYFRAME_REQUEST (input, cursor...)
+    using ControlMessageCallback = std::function<void(ViewerId, PacketType, const std::vector<uint8_t>&)>;
+
+    explicit FanoutSender(const FanoutConfig& config = FanoutConfig());
+
+    // transport já inicializado (InitializeAsServer/WithChannel). O viewer novo espera keyframe
+    ViewerId AddViewer(std::unique_ptr<P2PManager> transport, const FanoutViewerConfig& config = FanoutViewerConfig());
+    bool RemoveViewer(ViewerId id);
+    size_t GetViewerCount() const { return m_viewers.size(); }
+
+    // Ritmo do viewer (ex: alvo do ABR desse viewer)
+    bool SetViewerRate(ViewerId id, double maxRateKbps);
+
+    // Simulcast: camada fixa para o viewer (troca no próximo keyframe dela)
+    bool SetViewerLayer(ViewerId id, uint8_t layer);
+
+    // Simulcast: alvo do controlador do viewer → ritmo (alvo com folga) e camada
+    bool UpdateViewerTarget(ViewerId id, double targetKbps, uint64_t nowUs);
+
+    // Camadas vistas em PublishFrame e bitrate medido de cada uma (janela de 1 s, suavizado)
+    uint8_t GetLayerCount() const { return m_layerCount; }
+    double GetLayerBitrateKbps(uint8_t layer) const;
+
+    // Transporte do viewer (stats, LockPeer...); nullptr se não existe
+    P2PManager* GetViewerTransport(ViewerId id);
+
+    void SetControlMessageCallback(ControlMessageCallback callback) { m_controlCallback = std::move(callback); }
+
+    // Algum viewer espera keyframe e o intervalo mínimo já passou: forçar no próximo encode
+    bool NeedsKeyframe(uint64_t nowUs) const { return KeyframeLayerMask(nowUs) != 0; }
+
+    // Por camada (bit i = camada i), para IVideoEncoder::EncodeLayers
+    uint32_t KeyframeLayerMask(uint64_t nowUs) const;
+
+    // Serializa o frame uma vez e enfileira para cada viewer da camada frame.layerId.
+    // stride = bytes por linha do frame completo (payload bruto) ou 0; flags = FRAME_FLAG_*
+    // além de KEYFRAME (marcado a partir de frame.isKeyframe). Retorna em quantas filas entrou
+    size_t PublishFrame(const EncodedFrame& frame, uint32_t stride, uint16_t sequence, uint8_t flags = 0);
+
+    // Lê mensagens dos viewers, mede o transporte e envia o que o ritmo de cada um permite
+    void Service(uint64_t nowUs);
+
+    std::vector<ViewerStats> GetViewerStats() const;
+    Stats GetStats() const;
+
+private:
+    struct SharedFrame {
+        std::shared_ptr<const std::vector<uint8_t>> datagram;
+        uint16_t sequence = 0;
+        uint8_t layer = 0;
+        bool isKeyframe = false;
+    };
+
+    struct Viewer {
+        ViewerId id = 0;
+        std::unique_ptr<P2PManager> transport;
+        FanoutViewerConfig config;
+        std::deque<SharedFrame> queue;
+        double tokens = 0.0;                // Bytes de crédito (pode ficar negativo)
+        uint64_t lastRefillUs = 0;
+        bool hasRefill = false;
+        bool awaitingKeyframe = true;
+        uint8_t layer = 0;
+        uint8_t targetLayer = 0;
+        uint64_t layerUpSinceUs = 0;        // Folga para a camada de cima desde
+        bool hasLayerUp = false;
+        double targetKbps = 0.0;
+        uint64_t lastKeyframeSentUs = 0;
+        bool hasKeyframeSent = false;
+        ViewerStats stats;
+    };
+
+    Viewer* FindViewer(ViewerId id);
+    void Enqueue(Viewer& viewer, const SharedFrame& frame);
+    void HandleMessages(Viewer& viewer, uint64_t nowUs);
+    void Drain(Viewer& viewer, uint64_t nowUs);
+    void SampleLayerBitrates(uint64_t nowUs);
+
+    FanoutConfig m_config;
+    std::vector<Viewer> m_viewers;
+    ViewerId m_nextId = 1;
+    uint64_t m_lastKeyframeUs[MAX_SIMULCAST_LAYERS] = {};
+    bool m_hasKeyframe[MAX_SIMULCAST_LAYERS] = {};
+    uint64_t m_lastServiceUs = 0;
+
+    // Bitrate por camada
+    uint8_t m_layerCount = 0;
+    uint64_t m_layerBytes[MAX_SIMULCAST_LAYERS] = {};
+    double m_layerKbps[MAX_SIMULCAST_LAYERS] = {};
+    uint64_t m_layerWindowStartUs = 0;
+    bool m_hasLayerWindow = false;
+
+    ControlMessageCallback m_controlCallback;
+    std::vector<uint8_t> m_messageBuffer;
+    Stats m_stats;
+};
+
+/**
+ * @class FrameChainTracker
+ * @brief Lado do viewer: quais frames dá para decodificar e quando pedir keyframe
+ *
+ * Keyframe (FRAME_FLAG_KEYFRAME) sempre decodifica; os demais só se o anterior
+ * (sequence - 1) foi decodificado. Com a cadeia quebrada, PollKeyframeRequest devolve
+ * um pedido na hora e depois a cada retryMs (o próprio keyframe pode se perder).
+ */
+class FrameChainTracker {
+public:
+    struct Stats {
+        uint64_t framesDecodable = 0;
+        uint64_t framesUndecodable = 0;     // Chegaram com a cadeia quebrada
+        uint64_t framesStale = 0;           // Mais antigos que o último decodificado
+        uint64_t gaps = 0;
+        uint64_t keyframes = 0;
+        uint64_t requestsSent = 0;
+    };
+
+    explicit FrameChainTracker(uint64_t retryMs = 200) : m_retryMs(retryMs) {}
+
+    // Frame recebido (flags = P2PManager::GetLastFrameFlags). true = pode decodificar
+    bool OnFrame(uint16_t sequence, uint8_t flags);
+
+    // O frame decodificável não aplicou (ex: ApplyTileDelta falhou): cadeia quebrada
+    void MarkUndecodable();
+
+    // Pedido de keyframe a enviar agora (SendControlMessage(KEYFRAME_REQUEST, ...))
+    bool PollKeyframeRequest(uint64_t nowMs, KeyframeRequestMessage& outMessage);
+
+    bool IsBroken() const { return m_broken; }
+    Stats GetStats() const { return m_stats; }
+
+private:
+    uint64_t m_retryMs;
+    bool m_broken = true;
+    bool m_hasDecoded = false;
+    uint16_t m_lastSequence = 0;
+    KeyframeRequestReason m_reason = KeyframeRequestReason::JOINED;
+    bool m_hasRequest = false;
+    uint64_t m_lastRequestMs = 0;
+    Stats m_stats;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file FrameScaler.h
+ * @brief Downscaler BGRA entre captura e encode (box 2:1 e bilinear, SSE2)
+ *
+ * Configure() pré-calcula as tabelas de origem/peso por coluna e linha para um
+ * par de resoluções; Scale() e ScaleRegion() apenas consomem as tabelas. O
+ * layout segue FrameData (stride em bytes, 4 bytes por pixel).
+ *
+ * ScaleRegion() redimensiona só um retângulo do destino, para compor com os
+ * tiles alterados: MapSourceRect() converte um tile alterado da captura no
+ * retângulo do destino que depende dele.
+ *
+ * Exemplo:
+ * ```cpp
+ * FrameScaler scaler;
+ * scaler.Configure(3840, 2160, 1920, 1080);     // AUTO → box 2:1
+ * scaler.Scale(frame.pixels.data(), frame.stride, scaled.data(), 1920 * 4);
+ * ```
+ */
+
+#include "FrameTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class ScaleFilter {
+    AUTO,           // Box para 2:1 exato, bilinear para o resto
+    BOX,            // Média 2x2 (exige razão 2:1 exata)
+    BILINEAR
+};
+
+class FrameScaler {
+public:
+    FrameScaler() = default;
+
+    // Pré-calcula as tabelas; false se as dimensões/filtro forem inválidos
+    bool Configure(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                   ScaleFilter filter = ScaleFilter::AUTO);
+
+    bool IsConfigured() const { return m_dstWidth != 0; }
+
+    // Redimensiona o frame inteiro (usa buffer interno: uma thread por instância)
+    void Scale(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride);
+
+    // Redimensiona só dstRect (coordenadas do destino)
+    void ScaleRegion(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride,
+                     const FrameRect& dstRect);
+
+    // Retângulo do destino afetado por uma mudança em srcRect (inclui a vizinhança do filtro)
+    FrameRect MapSourceRect(const FrameRect& srcRect) const;
+
+    ScaleFilter GetFilter() const { return m_filter; }
+    uint32_t GetSourceWidth() const { return m_srcWidth; }
+    uint32_t GetSourceHeight() const { return m_srcHeight; }
+    uint32_t GetDestWidth() const { return m_dstWidth; }
+    uint32_t GetDestHeight() const { return m_dstHeight; }
+
+    // Liga/desliga o caminho SSE2 (benchmarks e comparação com o escalar)
+    void SetUseSimd(bool useSimd) { m_useSimd = useSimd && HasSimd(); }
+    static bool HasSimd();
+
+private:
+    void ScaleBoxRows(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride,
+                      const FrameRect& rect) const;
+    void ScaleBilinearRows(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride,
+                           const FrameRect& rect);
+
+    uint32_t m_srcWidth = 0;
+    uint32_t m_srcHeight = 0;
+    uint32_t m_dstWidth = 0;
+    uint32_t m_dstHeight = 0;
+    ScaleFilter m_filter = ScaleFilter::AUTO;
+    bool m_useSimd = HasSimd();
+
+    // Bilinear: offsets em bytes do pixel de origem e do vizinho, peso do vizinho (0..255)
+    std::vector<uint32_t> m_srcOffsetX;
+    std::vector<uint32_t> m_nextOffsetX;
+    std::vector<uint16_t> m_weightX;
+    std::vector<uint32_t> m_srcY;
+    std::vector<uint16_t> m_weightY;
+
+    // Linha intermediária (interpolação vertical), reusada entre linhas
+    std::vector<uint8_t> m_rowBuffer;
+};
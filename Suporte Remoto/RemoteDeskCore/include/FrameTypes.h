@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+ * @file FrameTypes.h
+ * @brief Tipos de frame compartilhados entre captura, encoder, rede e render
+ *
+ * Sem dependência de plataforma: adapters (DXGI, NVENC, SDL2) e rdc_core
+ * trocam frames apenas por estes tipos.
+ */
+
+#include <cstdint>
+#include <vector>
+
+// Retângulo em pixels (vazio quando width ou height = 0)
+struct FrameRect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool IsEmpty() const { return width == 0 || height == 0; }
+};
+
+// Frame BGRA bruto (saída da captura)
+struct FrameData {
+    std::vector<uint8_t> pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    bool hasChanged;
+};
+
+// Camadas de simulcast por frame capturado (layerId 0..MAX-1)
+constexpr uint8_t MAX_SIMULCAST_LAYERS = 4;
+
+// Frame comprimido (saída do encoder)
+struct EncodedFrame {
+    std::vector<uint8_t> data;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitrate;           // Alvo do encoder, em kbps
+    bool isKeyframe;
+    uint64_t timestamp;
+    uint8_t layerId = 0;        // Simulcast: 0 = camada de menor qualidade
+};
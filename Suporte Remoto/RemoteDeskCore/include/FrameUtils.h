@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file FrameUtils.h
+ * @brief Operações de CPU sobre frames BGRA (cópia de linhas, detecção e hash de tiles alterados)
+ *
+ * Funções puras e portáveis usadas pelo Renderer, pelo encoder e pelos benchmarks.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Copia height linhas de rowBytes entre buffers com pitches diferentes
+ *
+ * Quando os dois pitches coincidem com rowBytes a cópia vira um único memcpy.
+ */
+void CopyFrameRows(uint8_t* dst, size_t dstPitch,
+                   const uint8_t* src, size_t srcStride,
+                   size_t rowBytes, uint32_t height);
+
+/**
+ * @brief Compara dois frames BGRA em tiles de tileSize x tileSize pixels
+ * @param[out] outDirtyTiles Um byte por tile (row-major), 1 = alterado
+ * @return Número de tiles alterados
+ *
+ * Um tile é marcado no primeiro byte diferente; as linhas restantes dele não
+ * são comparadas.
+ */
+uint32_t DiffFrameTiles(const uint8_t* previous, const uint8_t* current,
+                        uint32_t width, uint32_t height, uint32_t stride,
+                        uint32_t tileSize, std::vector<uint8_t>& outDirtyTiles);
+
+/**
+ * @brief Hash de 64 bits de cada tile de tileSize x tileSize pixels
+ * @param[out] outHashes Um hash por tile (row-major)
+ *
+ * Permite comparar um frame com outro que não está mais em memória (só os hashes
+ * foram guardados), como o último frame que o cliente apresentou antes de uma queda.
+ */
+void HashFrameTiles(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                    uint32_t tileSize, std::vector<uint64_t>& outHashes);
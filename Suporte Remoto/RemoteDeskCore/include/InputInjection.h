@@ -0,0 +1,77 @@
+#pragma once
+
+/**
+ * @file InputInjection.h
+ * @brief Interface de injeção de input implementada pelos backends de plataforma
+ *
+ * RemoteDesktopSystem conversa apenas com IInputInjector: InputInjector (Windows,
+ * SendInput) e UInputInjector (Linux, /dev/uinput). RemoteInputHandler é a parte
+ * comum do host: decodifica os lotes do protocolo de input, descarta lotes
+ * atrasados, entrega cada lote inteiro ao backend e acerta teclas/botões presos
+ * pelo estado que vem em cada lote.
+ */
+
+#include "InputProtocol.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class IInputInjector {
+public:
+    virtual ~IInputInjector() = default;
+
+    // Inicializa o backend (cria devices, verifica privilégios)
+    virtual bool Initialize() = 0;
+
+    // Injeta um lote do protocolo de input de uma vez. Retorna quantos eventos foram aceitos;
+    // num lote parcial, os aceitos são os primeiros (SendInput para no primeiro recusado)
+    virtual uint32_t InjectEvents(const InputEvent* events, size_t count) = 0;
+
+    // Injeta texto UTF-8; false se o backend não alcança algum caractere (nada injetado)
+    virtual bool InjectText(const char* text) = 0;
+
+    // Libera recursos
+    virtual void Release() = 0;
+};
+
+/**
+ * @class RemoteInputHandler
+ * @brief Lado do host: payloads INPUT_BATCH → backend, na ordem de envio do cliente
+ */
+class RemoteInputHandler {
+public:
+    struct HandlerStats {
+        uint64_t batchesInjected = 0;
+        uint64_t batchesStale = 0;          // Atrasados/duplicados (descartados)
+        uint64_t batchesMalformed = 0;
+        uint64_t eventsInjected = 0;
+        uint64_t eventsRejected = 0;        // Não aceitos pelo backend
+        uint64_t eventsReconciled = 0;      // Soltos/pressionados pelo estado do lote (evento perdido)
+    };
+
+    explicit RemoteInputHandler(IInputInjector& injector) : m_injector(injector) {}
+
+    // false se o payload é inválido ou o lote chegou depois de um mais novo
+    bool HandleBatch(const uint8_t* payload, size_t size);
+
+    // Cliente novo ou sessão retomada: solta o que estiver pressionado e o próximo
+    // lote define a sequência (cada processo cliente começa do 0)
+    void Reset();
+
+    // Toque de tecla local (ex: tecla do probe de latência)
+    bool InjectKeyTap(uint16_t virtualKey, uint64_t timestampUs);
+
+    HandlerStats GetStats() const { return m_stats; }
+
+private:
+    // Injeta a diferença entre o estado injetado e target
+    void Reconcile(const InputPressedState& target, uint64_t timestampUs);
+
+    IInputInjector& m_injector;
+    InputBatch m_batch;
+    InputPressedState m_injectedState;      // O que o host pressionou e ainda não soltou
+    std::vector<InputEvent> m_fixups;
+    uint32_t m_nextSequence = 0;
+    bool m_hasSequence = false;
+    HandlerStats m_stats;
+};
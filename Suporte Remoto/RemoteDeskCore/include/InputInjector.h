@@ -1,18 +1,25 @@
 #pragma once
 
+#include "InputInjection.h"
+#include "InputProtocol.h"
+#include "TextInput.h"
+
 #include <cstdint>
+#include <string>
+#include <vector>
 #include <windows.h>
 
-class InputInjector {
+// Backend Windows (SendInput) de IInputInjector
+class InputInjector : public IInputInjector {
 public:
     enum class KeyState { PRESSED, RELEASED };
     enum class MouseButton { LEFT, RIGHT, MIDDLE };
 
     InputInjector();
-    ~InputInjector();
+    ~InputInjector() override;
 
     // Inicializa o injetor de entrada
-    bool Initialize();
+    bool Initialize() override;
 
     // ===== Mouse Input =====
 
@@ -33,8 +40,14 @@ public:
     // Injetar tecla (VK_* constants)
     bool InjectKey(uint8_t virtualKeyCode, KeyState state);
 
-    // Injetar texto (simula digitação)
-    bool InjectText(const char* text);
+    // Injetar texto UTF-8 (KEYEVENTF_UNICODE, um SendInput por bloco de até 500 caracteres)
+    bool InjectText(const char* text) override;
+
+    // ===== Batch Input =====
+
+    // Injeta um lote do protocolo de input com uma única chamada SendInput.
+    // Retorna quantos eventos o sistema aceitou
+    uint32_t InjectEvents(const InputEvent* events, size_t count) override;
 
     // ===== Special Keys =====
 
@@ -67,12 +80,16 @@ public:
     bool GetMousePosition(int32_t& outX, int32_t& outY) const;
 
     // Libera recursos
-    void Release();
+    void Release() override;
 
 private:
     bool SendKeyboardInput(uint8_t virtualKeyCode, bool isKeyDown);
     bool SendMouseInput(int32_t x, int32_t y, uint32_t flags);
 
+    // Buffers reusados entre lotes
+    std::vector<INPUT> m_batchInputs;
+    std::vector<TextKeyStroke> m_textStrokes;
+
     bool m_initialized = false;
     uint32_t m_inputDelayMs = 0;
 };
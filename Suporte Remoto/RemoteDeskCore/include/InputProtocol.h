@@ -0,0 +1,159 @@
+#pragma once
+
+/**
+ * @file InputProtocol.h
+ * @brief Protocolo de input cliente → host: lotes compactos com varint e deltas
+ *
+ * O cliente acumula eventos em um InputBatcher e envia um lote (PacketType::INPUT_BATCH)
+ * por tick de envio. Movimentos consecutivos do mouse dentro do lote são fundidos no
+ * último; botões, roda e teclas nunca são fundidos nem reordenados, e um lote com
+ * qualquer um deles sai imediatamente.
+ *
+ * Os lotes vão sem ack (datagrama). Para um key-up ou button-up perdido não deixar a
+ * tecla presa no host, todo lote leva no fim o estado completo de botões e teclas
+ * pressionados depois dos seus eventos, e o InputBatcher repete esse estado em lotes
+ * sem eventos algumas vezes depois de cada mudança. O host compara com o que injetou
+ * e solta/pressiona o que divergir.
+ *
+ * Formato do payload (varint = LEB128, zigzag para valores com sinal):
+ * ```
+ * varint sequence | varint baseTimestampUs | varint count
+ * count × { u8 type|flags, varint Δt(µs), campos do tipo }
+ *   MOUSE_MOVE   zigzag Δx, zigzag Δy   (relativo ao movimento anterior do lote)
+ *   MOUSE_BUTTON varint button           (flag PRESSED no byte de tipo)
+ *   MOUSE_WHEEL  zigzag delta
+ *   KEY          varint virtualKey       (flag PRESSED no byte de tipo)
+ * [estado: varint buttonMask | varint keyCount | keyCount × varint virtualKey]
+ * ```
+ * Coordenadas são normalizadas para 0..65535 (mesma escala do MOUSEEVENTF_ABSOLUTE),
+ * então independem da resolução da janela, do degrau do ABR e da tela do host.
+ * Cada lote é autocontido (o primeiro movimento é relativo a 0,0).
+ *
+ * Exemplo (cliente):
+ * ```cpp
+ * InputBatcher batcher;
+ * batcher.Push(event);
+ * if (batcher.ShouldFlush(nowUs)) {
+ *     batcher.Flush(payload);
+ *     network->SendControlMessage(PacketType::INPUT_BATCH, payload.data(), payload.size());
+ * }
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class InputEventType : uint8_t {
+    MOUSE_MOVE = 0,
+    MOUSE_BUTTON = 1,
+    MOUSE_WHEEL = 2,
+    KEY = 3
+};
+
+enum class InputMouseButton : uint8_t {
+    LEFT = 0,
+    RIGHT = 1,
+    MIDDLE = 2,
+    X1 = 3,
+    X2 = 4
+};
+
+// Coordenadas absolutas normalizadas (0..65535)
+constexpr int32_t INPUT_COORD_MAX = 65535;
+
+// Eventos por lote (um lote cabe com folga em um datagrama)
+constexpr size_t INPUT_MAX_BATCH_EVENTS = 256;
+
+// Teclas no estado do lote (além disso o teclado já perdeu teclas por rollover)
+constexpr size_t INPUT_MAX_PRESSED_KEYS = 64;
+
+// Repetição do estado após uma mudança de tecla/botão: 3 lotes, um a cada 50 ms
+constexpr uint32_t INPUT_STATE_REPEATS = 3;
+constexpr uint32_t INPUT_STATE_REPEAT_US = 50000;
+
+struct InputEvent {
+    InputEventType type = InputEventType::MOUSE_MOVE;
+    bool pressed = false;           // MOUSE_BUTTON / KEY
+    uint64_t timestampUs = 0;       // Relógio do cliente (steady_clock)
+    int32_t x = 0;                  // MOUSE_MOVE: 0..INPUT_COORD_MAX
+    int32_t y = 0;
+    int32_t wheelDelta = 0;         // MOUSE_WHEEL: múltiplos de 120 (WHEEL_DELTA)
+    InputMouseButton button = InputMouseButton::LEFT;
+    uint16_t virtualKey = 0;        // KEY: código VK_* do Windows
+
+    static InputEvent MouseMove(int32_t x, int32_t y, uint64_t timestampUs);
+    static InputEvent MouseButton(InputMouseButton button, bool pressed, uint64_t timestampUs);
+    static InputEvent MouseWheel(int32_t delta, uint64_t timestampUs);
+    static InputEvent Key(uint16_t virtualKey, bool pressed, uint64_t timestampUs);
+};
+
+// Botões e teclas pressionados
+struct InputPressedState {
+    uint8_t buttons = 0;                // Bit i = InputMouseButton i
+    std::vector<uint16_t> keys;         // virtualKey, ordenadas
+
+    // Aplica MOUSE_BUTTON/KEY; false se o estado não mudou
+    bool Apply(const InputEvent& event);
+    bool IsKeyPressed(uint16_t virtualKey) const;
+};
+
+struct InputBatch {
+    uint32_t sequence = 0;
+    std::vector<InputEvent> events;
+    bool hasState = false;              // Lote com o estado no fim
+    InputPressedState state;
+};
+
+// Serialização do lote; false se o payload estiver truncado ou malformado.
+// state != nullptr: estado após os eventos do lote, no fim do payload
+void EncodeInputBatch(uint32_t sequence, const InputEvent* events, size_t count,
+                      std::vector<uint8_t>& outPayload, const InputPressedState* state = nullptr);
+bool DecodeInputBatch(const uint8_t* data, size_t size, InputBatch& outBatch);
+
+/**
+ * @class InputBatcher
+ * @brief Lado do cliente: acumula eventos, funde movimentos e decide quando enviar
+ */
+class InputBatcher {
+public:
+    struct BatcherStats {
+        uint64_t eventsPushed = 0;
+        uint64_t movesCoalesced = 0;
+        uint64_t eventsSent = 0;
+        uint64_t batchesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t stateRefreshes = 0;    // Lotes só com o estado
+    };
+
+    // Tick de envio dos movimentos (µs); botões e teclas não esperam o tick
+    explicit InputBatcher(uint32_t sendIntervalUs = 4000) : m_sendIntervalUs(sendIntervalUs) {}
+
+    void Push(const InputEvent& event);
+
+    bool HasPending() const { return !m_pending.empty(); }
+    size_t GetPendingCount() const { return m_pending.size(); }
+
+    // Há algo a enviar agora: evento discreto pendente, tick vencido ou repetição do estado
+    bool ShouldFlush(uint64_t nowUs) const;
+
+    // Serializa até INPUT_MAX_BATCH_EVENTS eventos (o resto fica para o próximo Flush)
+    // e o estado após eles. Sem eventos e com repetição vencida: lote só com o estado
+    bool Flush(std::vector<uint8_t>& outPayload, uint64_t nowUs = 0);
+
+    // Estado enviado no último lote
+    const InputPressedState& GetSentState() const { return m_sentState; }
+
+    BatcherStats GetStats() const { return m_stats; }
+
+private:
+    std::vector<InputEvent> m_pending;
+    uint32_t m_sendIntervalUs;
+    uint64_t m_lastFlushUs = 0;
+    uint32_t m_sequence = 0;
+    bool m_hasDiscrete = false;
+    InputPressedState m_sentState;
+    uint32_t m_stateRepeatsLeft = 0;
+    uint64_t m_nextStateRepeatUs = 0;
+    BatcherStats m_stats;
+};
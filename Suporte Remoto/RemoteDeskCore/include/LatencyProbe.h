@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+ * @file LatencyProbe.h
+ * @brief Medição input → foto: probe marcado do cliente, marcador no frame do host
+ *
+ * O cliente envia um LATENCY_PROBE com um id (e opcionalmente uma tecla a injetar).
+ * O host injeta a tecla e grava o id em uma faixa de células preto/branco no canto
+ * superior esquerdo do frame capturado:
+ * - MARKER: no próximo frame capturado (mede rede + captura + envio + apresentação)
+ * - PIXEL_CHANGE: no primeiro frame que mudou depois da injeção (inclui a reação
+ *   da aplicação à tecla; qualquer mudança de tela conta)
+ *
+ * O cliente lê o marcador de cada frame apresentado; quando o id pendente aparece,
+ * o tempo desde o envio vai para um LatencyHistogram. As células têm largura
+ * proporcional ao frame (largura / 120), então o marcador sobrevive aos degraus de
+ * resolução do ABR.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class ProbeMode : uint8_t {
+    MARKER = 0,
+    PIXEL_CHANGE = 1
+};
+
+struct LatencyProbeMessage {
+    uint16_t probeId;           // 1..PROBE_MAX_ID (0 = nenhum)
+    uint16_t virtualKey;        // Tecla injetada no host (0 = nenhuma)
+    uint8_t mode;               // ProbeMode
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(LatencyProbeMessage) == 8, "LatencyProbeMessage must be 8 bytes");
+
+// Ids cabem nos 12 bits de dados do marcador
+constexpr uint16_t PROBE_MAX_ID = 4095;
+
+// Limites superiores dos buckets (ms); o último bucket é +Inf
+constexpr std::array<double, 12> LATENCY_BUCKETS_MS = {
+    8, 16, 24, 33, 50, 66, 83, 100, 150, 200, 300, 500
+};
+constexpr size_t LATENCY_BUCKET_COUNT = LATENCY_BUCKETS_MS.size() + 1;
+
+/**
+ * @class LatencyHistogram
+ * @brief Histograma de buckets fixos (mesmos limites do endpoint Prometheus)
+ */
+class LatencyHistogram {
+public:
+    void Record(double latencyMs);
+    void Reset();
+
+    uint64_t GetCount() const { return m_count; }
+    double GetSumMs() const { return m_sumMs; }
+    double GetMinMs() const { return m_count ? m_minMs : 0.0; }
+    double GetMaxMs() const { return m_maxMs; }
+    uint64_t GetBucket(size_t index) const { return m_buckets[index]; }
+
+    // Estimativa por interpolação linear dentro do bucket
+    double Percentile(double fraction) const;
+
+private:
+    std::array<uint64_t, LATENCY_BUCKET_COUNT> m_buckets{};
+    uint64_t m_count = 0;
+    double m_sumMs = 0.0;
+    double m_minMs = 0.0;
+    double m_maxMs = 0.0;
+};
+
+// Grava / lê o id no canto superior esquerdo de um frame BGRA. Read retorna false
+// se não há marcador válido (guardas ou paridade não conferem)
+bool StampProbeMarker(uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                      uint16_t probeId);
+bool ReadProbeMarker(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                     uint16_t& outProbeId);
+
+/**
+ * @class LatencyProbeHost
+ * @brief Lado do host: decide em qual frame o id do probe aparece
+ *
+ * O id disparado é gravado a partir do primeiro frame elegível e nos seguintes por
+ * uma janela curta (~200 ms), então a perda de um frame só atrasa a detecção; fora
+ * de um probe em andamento nenhum frame é marcado.
+ */
+class LatencyProbeHost {
+public:
+    explicit LatencyProbeHost(uint32_t pixelChangeTimeoutMs = 1000)
+        : m_pixelChangeTimeoutUs(static_cast<uint64_t>(pixelChangeTimeoutMs) * 1000) {}
+
+    // Probe recebido (a tecla, se houver, já foi injetada)
+    void OnProbe(const LatencyProbeMessage& message, uint64_t nowUs);
+
+    // Há um id novo esperando frame: o servidor deve enviar mesmo sem mudança de tela
+    bool NeedsFrame() const;
+
+    // Chamado para cada frame capturado antes do envio; grava o id corrente
+    void StampFrame(uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                    bool frameChanged, uint64_t nowUs);
+
+    uint16_t GetCurrentId() const { return m_currentId; }
+
+private:
+    uint16_t m_pendingId = 0;
+    ProbeMode m_pendingMode = ProbeMode::MARKER;
+    uint64_t m_pendingSinceUs = 0;
+    uint16_t m_currentId = 0;
+    uint64_t m_currentSinceUs = 0;
+    uint64_t m_pixelChangeTimeoutUs;
+};
+
+/**
+ * @class LatencyProbeClient
+ * @brief Lado do cliente: dispara probes periódicos e mede até a apresentação
+ */
+class LatencyProbeClient {
+public:
+    struct ProbeStats {
+        uint64_t probesSent = 0;
+        uint64_t probesCompleted = 0;
+        uint64_t probesTimedOut = 0;
+    };
+
+    LatencyProbeClient(ProbeMode mode = ProbeMode::MARKER, uint16_t virtualKey = 0,
+                       uint32_t intervalMs = 500, uint32_t timeoutMs = 2000);
+
+    // Preenche outMessage quando é hora de um novo probe (um por vez)
+    bool ShouldSend(uint64_t nowUs, LatencyProbeMessage& outMessage);
+
+    // Frame apresentado em nowUs; true se completou o probe pendente
+    bool OnFramePresented(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                          uint64_t nowUs);
+
+    const LatencyHistogram& GetHistogram() const { return m_histogram; }
+    ProbeStats GetStats() const { return m_stats; }
+
+private:
+    ProbeMode m_mode;
+    uint16_t m_virtualKey;
+    uint64_t m_intervalUs;
+    uint64_t m_timeoutUs;
+
+    uint16_t m_nextId = 1;
+    uint16_t m_pendingId = 0;
+    uint64_t m_pendingSentUs = 0;
+    uint64_t m_lastSentUs = 0;
+    bool m_hasSent = false;
+
+    LatencyHistogram m_histogram;
+    ProbeStats m_stats;
+};
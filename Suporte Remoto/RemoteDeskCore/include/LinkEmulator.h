@@ -0,0 +1,212 @@
+#pragma once
+
+/**
+ * @file LinkEmulator.h
+ * @brief Emulador de link de rede (estilo netem) para testes reprodutíveis de transporte/ABR
+ *
+ * Cada LinkEmulator modela uma direção: gargalo com banda e fila (tail drop),
+ * atraso + jitter, perda Bernoulli ou em rajada (Gilbert-Elliott), reordenação
+ * e duplicação. Toda a aleatoriedade vem de um RNG com seed, e o tempo é passado
+ * explicitamente, então o mesmo cenário produz sempre o mesmo resultado.
+ *
+ * EmulatedLink junta as duas direções e expõe endpoints IDatagramChannel para
+ * P2PManager::InitializeWithChannel:
+ * ```cpp
+ * auto link = std::make_shared<EmulatedLink>(profile, 42);
+ * P2PManager sender, receiver;
+ * sender.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::A), P2PManager::Role::SERVER);
+ * receiver.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::B), P2PManager::Role::CLIENT);
+ * link->AdvanceTo(1000);  // relógio virtual em µs
+ * ```
+ *
+ * Cenários ("cair para 3 Mbps por 10 s") são listas de LinkScenarioStep,
+ * escritas à mão ou lidas de um script de texto (ParseLinkScenario).
+ */
+
+#include "DatagramChannel.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @struct GilbertElliottParams
+ * @brief Perda em rajada: cadeia de Markov com estados GOOD/BAD
+ */
+struct GilbertElliottParams {
+    bool enabled = false;
+    double goodToBadPercent = 0.0;      ///< P(GOOD → BAD) por pacote
+    double badToGoodPercent = 100.0;    ///< P(BAD → GOOD) por pacote
+    double lossInGoodPercent = 0.0;     ///< Perda no estado GOOD
+    double lossInBadPercent = 100.0;    ///< Perda no estado BAD
+};
+
+/**
+ * @struct LinkProfile
+ * @brief Condições de uma direção do link
+ */
+struct LinkProfile {
+    double bandwidthKbps = 0.0;         ///< 0 = sem limite
+    double delayMs = 0.0;               ///< Atraso de propagação
+    double jitterMs = 0.0;              ///< Desvio padrão do atraso (normal, truncado em 0)
+    double lossPercent = 0.0;           ///< Perda Bernoulli (ignorada se burstLoss.enabled)
+    GilbertElliottParams burstLoss;
+    double reorderPercent = 0.0;        ///< Pacotes retidos para serem ultrapassados
+    double reorderDelayMs = 10.0;       ///< Retenção extra dos pacotes reordenados
+    double duplicatePercent = 0.0;
+    uint32_t queueLimitBytes = 256 * 1024; ///< Fila do gargalo (tail drop)
+};
+
+class LinkEmulator {
+public:
+    struct LinkStats {
+        uint64_t packetsSubmitted = 0;
+        uint64_t packetsDelivered = 0;
+        uint64_t packetsLost = 0;           ///< Perda aleatória (Bernoulli/rajada)
+        uint64_t packetsQueueDropped = 0;   ///< Fila do gargalo cheia
+        uint64_t packetsDuplicated = 0;
+        uint64_t packetsReordered = 0;
+        uint64_t bytesDelivered = 0;
+    };
+
+    explicit LinkEmulator(const LinkProfile& profile = LinkProfile(), uint64_t seed = 1);
+
+    // Troca as condições (pacotes em trânsito mantêm o agendamento)
+    void SetProfile(const LinkProfile& profile) { m_profile = profile; }
+    const LinkProfile& GetProfile() const { return m_profile; }
+
+    // Entrega um datagrama ao link no instante nowUs
+    void Submit(const uint8_t* data, size_t size, uint64_t nowUs);
+
+    // Retira o próximo datagrama com entrega <= nowUs
+    bool PopReady(uint64_t nowUs, std::vector<uint8_t>& outDatagram);
+
+    // Instante da próxima entrega (UINT64_MAX se vazio)
+    uint64_t NextDeliveryUs() const;
+
+    size_t GetInFlightCount() const { return m_inFlight.size(); }
+
+    LinkStats GetStats() const { return m_stats; }
+
+private:
+    struct InFlight {
+        uint64_t deliveryUs;
+        uint64_t order;
+        std::vector<uint8_t> data;
+    };
+
+    struct LaterFirst {
+        bool operator()(const InFlight& a, const InFlight& b) const {
+            return a.deliveryUs != b.deliveryUs ? a.deliveryUs > b.deliveryUs : a.order > b.order;
+        }
+    };
+
+    bool ShouldDrop();
+    bool Chance(double percent);
+    void Enqueue(const uint8_t* data, size_t size, uint64_t nowUs);
+
+    LinkProfile m_profile;
+    std::mt19937_64 m_rng;
+    std::uniform_real_distribution<double> m_uniform{ 0.0, 100.0 };
+    std::normal_distribution<double> m_normal{ 0.0, 1.0 };
+
+    std::priority_queue<InFlight, std::vector<InFlight>, LaterFirst> m_inFlight;
+    uint64_t m_nextOrder = 0;
+    uint64_t m_linkFreeAtUs = 0;        // Fim da transmissão do último pacote no gargalo
+    uint64_t m_lastDeliveryUs = 0;      // Preserva FIFO entre pacotes não reordenados
+    bool m_burstBadState = false;
+
+    LinkStats m_stats;
+};
+
+/**
+ * @class EmulatedLink
+ * @brief Link bidirecional (A→B, B→A) com relógio virtual ou de parede
+ *
+ * Deve ser criado com std::make_shared (os endpoints mantêm o link vivo).
+ * Com manualClock=true (padrão) o tempo só anda via AdvanceTo/AdvanceBy, o que
+ * torna a simulação determinística. Com manualClock=false usa steady_clock e
+ * WaitReadable bloqueia de verdade, para ligar P2PManager em threads reais.
+ */
+class EmulatedLink : public std::enable_shared_from_this<EmulatedLink> {
+public:
+    enum class Side { A, B };
+
+    EmulatedLink(const LinkProfile& profile = LinkProfile(), uint64_t seed = 1,
+                 bool manualClock = true);
+
+    // Endpoint do lado indicado (envia pela direção side→outro lado)
+    std::shared_ptr<IDatagramChannel> CreateEndpoint(Side side);
+
+    // Mesmas condições nas duas direções / direção específica (Side = origem)
+    void SetProfile(const LinkProfile& profile);
+    void SetProfile(Side from, const LinkProfile& profile);
+
+    // Relógio virtual (µs)
+    void AdvanceTo(uint64_t nowUs);
+    void AdvanceBy(uint64_t deltaUs) { AdvanceTo(NowUs() + deltaUs); }
+    uint64_t NowUs() const;
+
+    LinkEmulator::LinkStats GetStats(Side from) const;
+
+    // Usados pelos endpoints
+    bool Send(Side from, const uint8_t* data, size_t size);
+    bool Receive(Side to, std::vector<uint8_t>& outDatagram);
+    bool WaitReadable(Side to, int timeoutMs);
+
+private:
+    LinkEmulator& Direction(Side from) { return from == Side::A ? m_aToB : m_bToA; }
+    const LinkEmulator& Direction(Side from) const { return from == Side::A ? m_aToB : m_bToA; }
+    uint64_t NowUsLocked() const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    LinkEmulator m_aToB;
+    LinkEmulator m_bToA;
+    bool m_manualClock;
+    uint64_t m_virtualNowUs = 0;
+    std::chrono::steady_clock::time_point m_origin;
+};
+
+/**
+ * @struct LinkScenarioStep
+ * @brief A partir de atMs, o link passa a usar profile
+ */
+struct LinkScenarioStep {
+    uint64_t atMs = 0;
+    LinkProfile profile;
+};
+
+struct LinkScenario {
+    std::string name;
+    uint64_t durationMs = 30000;
+    uint64_t seed = 1;
+    std::vector<LinkScenarioStep> steps;
+
+    // Perfil ativo no instante tMs
+    const LinkProfile& ProfileAt(uint64_t tMs) const;
+};
+
+/**
+ * Lê um cenário de texto. Uma diretiva por linha, '#' inicia comentário:
+ * ```
+ * name     bw-drop
+ * duration 40s
+ * seed     7
+ * at 0s    bw=20mbps delay=20ms jitter=2ms loss=0.1%
+ * at 10s   bw=3mbps               # campos omitidos herdam do passo anterior
+ * at 20s   bw=20mbps
+ * ```
+ * Chaves de "at": bw (kbps|mbps), delay, jitter, loss (%), burst=P(G→B)%,P(B→G)%[,perda em BAD%]|off,
+ * reorder (%), reorder_delay, dup (%), queue (kb).
+ */
+bool ParseLinkScenario(const std::string& text, LinkScenario& outScenario, std::string& outError);
+
+// Cenários embutidos: clean, bw-drop, lossy, burst, jitter-reorder, duplicate
+std::vector<LinkScenario> BuiltinLinkScenarios();
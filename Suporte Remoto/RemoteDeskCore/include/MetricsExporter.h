@@ -0,0 +1,195 @@
+#pragma once
+
+/**
+ * @file MetricsExporter.h
+ * @brief Endpoint HTTP embutido com contadores do pipeline em formato Prometheus
+ *
+ * O pipeline publica um MetricsSnapshot periodicamente (Publish) e o listener
+ * serve o último snapshot em GET /metrics. A troca usa um seqlock: o publisher
+ * nunca espera pelo scrape e o scrape nunca bloqueia captura/envio.
+ *
+ * Exemplo:
+ * ```cpp
+ * MetricsExporter exporter;
+ * exporter.Start(9464);              // http://127.0.0.1:9464/metrics
+ * ...
+ * exporter.Publish(snapshot);        // thread do pipeline
+ * ```
+ */
+
+#include "LatencyProbe.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Cópia plana de SystemStats, ConnectionStats, EncoderStats, ABRStats e filas
+ *
+ * Apenas campos de 8 bytes para que o seqlock copie palavra a palavra.
+ */
+struct MetricsSnapshot {
+    // SystemStats
+    uint64_t framesProcessed = 0;
+    double averageFrameTimeMs = 0.0;
+    double averageFPS = 0.0;
+    double totalLatencyMs = 0.0;
+    double captureTimeMs = 0.0;
+    double encodeTimeMs = 0.0;
+    double networkTimeMs = 0.0;
+    double renderTimeMs = 0.0;
+    uint64_t systemBytesSent = 0;
+    uint64_t systemBytesReceived = 0;
+    uint64_t compressionRatio = 0;
+
+    // ConnectionStats (P2PManager)
+    uint64_t netBytesSent = 0;
+    uint64_t netBytesReceived = 0;
+    uint64_t netFramesSent = 0;
+    uint64_t netFramesReceived = 0;
+    double netLatencyMs = 0.0;
+    double netBandwidthMbps = 0.0;
+
+    // TransportStats (P2PManager / WebRTCDataChannel)
+    double netRttMs = 0.0;
+    double netPacketLossPercent = 0.0;
+    uint64_t netPacketsSent = 0;
+    uint64_t netPacketsLost = 0;
+    uint64_t netRetransmissions = 0;
+    double netSendBitrateKbps = 0.0;
+    double netAvailableBitrateKbps = 0.0;
+    uint64_t netCandidatePairType = 0;      // CandidatePairType
+
+    // EncoderStats (NVENCEncoder)
+    uint64_t encoderFramesEncoded = 0;
+    uint64_t encoderBytesEncoded = 0;
+    uint64_t encoderKeyframeInterval = 0;
+    double encoderAverageBitrateMbps = 0.0;
+
+    // ABRStats (AdaptiveBitRateController)
+    uint64_t abrBitrateMbps = 0;
+    double abrLatencyMs = 0.0;
+    double abrPacketLossPercent = 0.0;
+    uint64_t abrBitrateChangeCount = 0;
+    uint64_t abrRung = 0;
+    uint64_t abrTargetFps = 0;
+    uint64_t abrTargetWidth = 0;
+    uint64_t abrTargetHeight = 0;
+    uint64_t abrRungChangeCount = 0;
+    double abrAvailableBitrateKbps = 0.0;
+
+    // Filas (MultiThreadedCapture / MultiThreadedRenderer)
+    uint64_t captureQueueDepth = 0;
+    uint64_t captureFramesCaptured = 0;
+    uint64_t captureFramesDropped = 0;
+    uint64_t renderQueueDepth = 0;
+    uint64_t renderFramesRendered = 0;
+    uint64_t renderFramesDropped = 0;
+
+    // LatencyProbeClient (input → foto, só no cliente com probe ligado)
+    uint64_t probeLatencyBuckets[LATENCY_BUCKET_COUNT] = {};
+    uint64_t probeLatencyCount = 0;
+    double probeLatencySumMs = 0.0;
+    uint64_t probeTimeouts = 0;
+
+    // Momento da publicação (ms, relógio de sistema)
+    uint64_t publishTimestampMs = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<MetricsSnapshot>, "MetricsSnapshot must be POD");
+static_assert(sizeof(MetricsSnapshot) % sizeof(uint64_t) == 0,
+              "MetricsSnapshot must be made of 8-byte fields");
+
+/**
+ * @class SnapshotCell
+ * @brief Seqlock single-writer: Store nunca bloqueia, Load repete se pegou escrita em curso
+ */
+template<typename T>
+class SnapshotCell {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "SnapshotCell requires trivially copyable T");
+    static_assert(sizeof(T) % sizeof(uint64_t) == 0, "SnapshotCell requires 8-byte multiple");
+
+    void Store(const T& value) {
+        uint64_t words[WORD_COUNT];
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T Load() const {
+        uint64_t words[WORD_COUNT];
+        uint64_t before = 0;
+        uint64_t after = 0;
+
+        do {
+            before = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = sizeof(T) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> m_sequence{ 0 };
+    std::atomic<uint64_t> m_words[WORD_COUNT] = {};
+};
+
+class MetricsExporter {
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+
+    // Inicia listener HTTP (bindAddress padrão: somente loopback)
+    bool Start(uint16_t port, const std::string& bindAddress = "127.0.0.1");
+
+    // Para listener e fecha o socket
+    void Stop();
+
+    bool IsRunning() const { return m_isRunning; }
+
+    // Publica novo snapshot (thread do pipeline, lock-free)
+    void Publish(const MetricsSnapshot& snapshot) { m_snapshot.Store(snapshot); }
+
+    // Último snapshot publicado
+    MetricsSnapshot GetSnapshot() const { return m_snapshot.Load(); }
+
+    // Número de scrapes servidos
+    uint64_t GetScrapeCount() const { return m_scrapeCount.load(std::memory_order_relaxed); }
+
+    // Formata snapshot em Prometheus text exposition format (v0.0.4)
+    static std::string FormatPrometheus(const MetricsSnapshot& snapshot);
+
+private:
+    void ListenThreadMain();
+    void HandleClient(intptr_t clientSocket);
+
+    SnapshotCell<MetricsSnapshot> m_snapshot;
+
+    intptr_t m_listenSocket = -1;
+    std::thread m_listenThread;
+    std::atomic<bool> m_isRunning{ false };
+    std::atomic<bool> m_shouldStop{ false };
+    std::atomic<uint64_t> m_scrapeCount{ 0 };
+    bool m_socketsInitialized = false;
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "VideoEncoder.h"
+
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -9,49 +11,32 @@
 
 using Microsoft::WRL::ComPtr;
 
-struct EncodedFrame {
-    std::vector<uint8_t> data;
-    uint32_t width;
-    uint32_t height;
-    uint32_t bitrate;
-    bool isKeyframe;
-    uint64_t timestamp;
-};
-
-class NVENCEncoder {
+class NVENCEncoder : public IVideoEncoder {
 public:
     enum class BitRateMode { CONSTANT, VARIABLE };
 
     NVENCEncoder();
-    ~NVENCEncoder();
+    ~NVENCEncoder() override;
 
     // Inicializa o encoder NVENC
-    bool Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateMbps = 25);
+    bool Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps = 25000) override;
 
     // Codifica um frame BGRA em H.264
     bool EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
-                     uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe = false);
+                     uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe = false) override;
 
     // Finaliza a codificação (obtém frames restantes)
-    bool EndEncode(std::vector<EncodedFrame>& outFrames);
+    bool EndEncode(std::vector<EncodedFrame>& outFrames) override;
 
     // Configurações
-    void SetTargetBitrate(uint32_t mbps) { m_targetBitrateMbps = mbps; }
+    void SetTargetBitrate(uint32_t kbps) override { m_targetBitrateKbps = kbps; }
     void SetBitRateMode(BitRateMode mode) { m_bitrateMode = mode; }
     void SetPreset(uint32_t presetIndex);  // 0=default_preset, 11=lossless
 
-    // Estatísticas
-    struct EncoderStats {
-        uint64_t totalFramesEncoded = 0;
-        uint64_t totalBytesEncoded = 0;
-        uint32_t keyframeInterval = 60;
-        double averageBitrate = 0.0;
-    };
-
-    EncoderStats GetStats() const { return m_stats; }
+    EncoderStats GetStats() const override { return m_stats; }
 
     // Libera recursos
-    void Release();
+    void Release() override;
 
     // Obtém informações suportadas
     bool GetCapabilities(uint32_t& maxWidth, uint32_t& maxHeight,
@@ -81,8 +66,9 @@ private:
     // Configuration
     uint32_t m_width = 0;
     uint32_t m_height = 0;
-    uint32_t m_targetBitrateMbps = 25;
+    uint32_t m_targetBitrateKbps = 25000;
     BitRateMode m_bitrateMode = BitRateMode::VARIABLE;
+
     uint32_t m_presetIndex = 4; // NVENC_PRESET_DEFAULT
 
     // Statistics
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file NetworkProtocol.h
+ * @brief Formato de fio do transporte UDP (header + payload) e (de)serialização
+ *
+ * Independente de sockets: usado por P2PManager e pelos benchmarks/ferramentas.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tipo do datagrama: frames de vídeo e mensagens de controle pequenas dividem o socket
+enum class PacketType : uint8_t {
+    FRAME = 0,                  // Pixels / bitstream de vídeo
+    CURSOR_POSITION = 1,        // Host → cliente: posição do cursor (CursorProtocol.h)
+    CURSOR_SHAPE = 2,           // Host → cliente: forma do cursor em BGRA
+    CURSOR_SHAPE_REQUEST = 3,   // Cliente → host: pede uma forma que não está no cache
+    INPUT_BATCH = 4,            // Cliente → host: lote de eventos de input (InputProtocol.h)
+    LATENCY_PROBE = 5,          // Cliente → host: probe de latência input → foto (LatencyProbe.h)
+    TRANSPORT_PROBE = 6,        // Ambos: RTT/perda do transporte (TransportStats.h)
+    TRANSPORT_PROBE_REPLY = 7,  // Ambos: eco do probe com os pacotes recebidos
+    PATH_NOMINATION = 8,        // Cliente → host: caminho escolhido na corrida (SessionConnector.h)
+    SESSION_TOKEN = 9,          // Host → cliente: token de retomada (SessionResume.h)
+    SESSION_RESUME = 10,        // Cliente → host: retomada após queda, com o último frame apresentado
+    SESSION_RESUME_ACK = 11,    // Host → cliente: retomada aceita/recusada
+    KEYFRAME_REQUEST = 12,      // Cliente → host: cadeia de frames quebrada (FanoutSender.h)
+    FRAME_FEEDBACK = 13,        // Cliente → host: chegada de cada FRAME (TransportStats.h)
+};
+
+// NetworkFrameHeader::flags de um FRAME
+constexpr uint8_t FRAME_FLAG_TILE_DELTA = 0x01;    // Payload = tiles alterados (SessionResume.h)
+constexpr uint8_t FRAME_FLAG_KEYFRAME = 0x02;      // Não depende de frames anteriores (FanoutSender.h)
+
+struct NetworkFrameHeader {
+    static constexpr uint32_t MAGIC = 0xDEADBEEF;
+    static constexpr uint16_t VERSION = 3;      // v2: packetType (antes reserved[0]); v3: layerId
+
+    uint32_t magic;              // Validação
+    uint16_t version;            // Versão do protocolo
+    uint16_t frameSequence;      // Número sequencial do frame
+    uint32_t frameWidth;         // Largura da imagem
+    uint32_t frameHeight;        // Altura da imagem
+    uint32_t frameStride;        // Stride (bytes por linha)
+    uint32_t pixelDataSize;      // Tamanho dos pixels
+    uint64_t timestamp;          // Timestamp do frame
+    uint8_t flags;               // Flags (keyframe, etc)
+    uint8_t packetType;          // PacketType
+    uint8_t layerId;             // Camada de simulcast do FRAME (EncodedFrame::layerId)
+    uint8_t reserved[5];         // Padding para alinhamento
+};
+
+static_assert(sizeof(NetworkFrameHeader) == 40, "NetworkFrameHeader must be 40 bytes");
+
+struct NetworkPacket {
+    NetworkFrameHeader header;
+    std::vector<uint8_t> pixelData;
+};
+
+// Serializa header + payload em outBuffer (reutiliza a capacidade existente)
+// Retorna o tamanho total serializado
+size_t SerializePacket(const NetworkPacket& packet, std::vector<uint8_t>& outBuffer);
+
+// Desserializa um datagrama; falha se for menor que o header ou o magic não bater
+bool DeserializePacket(const uint8_t* data, size_t size, NetworkPacket& outPacket);
@@ -1,12 +1,19 @@
 #pragma once
 
+#include "TransportStats.h"
+
 #include <cstdint>
 #include <thread>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
 
 struct FrameBuffer {
     std::vector<uint8_t> pixels;
@@ -156,10 +163,30 @@ private:
     RenderStats m_stats;
 };
 
+// Ponto de operação combinado escolhido pelo ABR
+struct OperatingPoint {
+    uint32_t bitrateKbps = 0;
+    uint32_t fps = 60;              // Taxa de captura
+    uint32_t width = 0;             // Resolução do encode (0 = resolução da captura)
+    uint32_t height = 0;
+};
+
+// Degrau da escada: vale enquanto o bitrate alvo >= minBitrateKbps
+struct LadderRung {
+    uint32_t minBitrateKbps;
+    uint32_t fps;
+    uint32_t width;
+    uint32_t height;
+};
+
 class AdaptiveBitRateController {
 public:
     // Modo de adaptação de bitrate
-    enum class AdaptationMode { CONSERVATIVE, BALANCED, AGGRESSIVE };
+    // MODEL_BASED: gradiente de atraso (Kalman) + goodput + buffer do decoder, AIMD em kbps
+    enum class AdaptationMode { CONSERVATIVE, BALANCED, AGGRESSIVE, MODEL_BASED };
+
+    // Estado do detector de sobreuso (MODEL_BASED)
+    enum class BandwidthUsage { NORMAL, OVERUSING, UNDERUSING };
 
     AdaptiveBitRateController(uint32_t minBitrateMbps = 5, 
                               uint32_t maxBitrateMbps = 100);
@@ -168,32 +195,99 @@ public:
     void UpdateMetrics(double networkLatencyMs, double packetLossPercent,
                        double decoderBufferMs);
 
+    // Feedback de um frame/pacote confirmado pelo receptor (usado por MODEL_BASED)
+    // sendTimeMs no relógio do sender, arrivalTimeMs no do receptor: o offset
+    // entre relógios se cancela no gradiente de atraso
+    void OnPacketFeedback(double sendTimeMs, double arrivalTimeMs, size_t bytes);
+
+    // Ocupação do buffer de envio do vídeo (bufferedAmount do data channel) e seus
+    // watermarks. Acima do alto conta como congestionamento (reduz na próxima
+    // UpdateMetrics); acima do baixo segura aumentos. highWatermarkBytes = 0 desliga
+    void UpdateSendBuffer(size_t bufferedBytes, size_t lowWatermarkBytes, size_t highWatermarkBytes);
+
+    // Medições do transporte (P2PManager / WebRTCDataChannel): RTT/2 como latência de
+    // ida e perda da última janela vão para UpdateMetrics (mantém o último buffer do
+    // decoder); banda disponível > 0 limita o alvo. Ignorado sem amostra de RTT
+    void UpdateTransportStats(const TransportStats& stats);
+
     // Obtém bitrate recomendado
     uint32_t GetTargetBitrate() const { return m_currentBitrateMbps; }
 
+    // Bitrate recomendado em kbps (MODEL_BASED ajusta em passos de ABR_STEP_KBPS)
+    uint32_t GetTargetBitrateKbps() const { return m_currentBitrateKbps; }
+
     // Define modo de adaptação
     void SetAdaptationMode(AdaptationMode mode) { m_mode = mode; }
 
+    // Escada de resolução/fps (vazia = só bitrate, resolução e fps da captura).
+    // Baixa o mínimo do controlador para abaixo do limiar do 2º degrau, senão os
+    // degraus de baixo nunca seriam alcançados
+    void SetLadder(std::vector<LadderRung> ladder);
+
+    // Escada padrão para a resolução da captura: reduz fps antes da resolução
+    // para manter texto legível (60 → 30 fps, depois 5/6 e 2/3 da resolução)
+    static std::vector<LadderRung> BuildDefaultLadder(uint32_t sourceWidth, uint32_t sourceHeight);
+
+    // Bitrate + fps + resolução atuais
+    OperatingPoint GetOperatingPoint() const;
+
+    // Relógio do modelo em ms (padrão: steady_clock); simulações injetam tempo virtual
+    void SetTimeSource(std::function<double()> nowMs) { m_timeSource = std::move(nowMs); }
+
     // Força bitrate mínimo/máximo
     void SetBitRateRange(uint32_t minMbps, uint32_t maxMbps) {
         m_minBitrateMbps = minMbps;
+        m_minBitrateKbps = minMbps * 1000;
         m_maxBitrateMbps = maxMbps;
     }
 
+    // Mínimo efetivo em kbps (SetLadder pode baixar abaixo de 1 Mbps)
+    uint32_t GetMinBitrateKbps() const { return m_minBitrateKbps; }
+
     // Estatísticas
     struct ABRStats {
         uint32_t currentBitrateMbps = 0;
+        uint32_t currentBitrateKbps = 0;
         double currentLatencyMs = 0.0;
         double currentPacketLossPercent = 0.0;
+        double decoderBufferMs = 0.0;
+        double delayGradientMs = 0.0;       // Estimativa Kalman (MODEL_BASED)
+        double queueingDelayMs = 0.0;       // Atraso de ida acima do mínimo observado (MODEL_BASED)
+        double goodputKbps = 0.0;           // Bytes confirmados na janela (MODEL_BASED)
+        size_t sendBufferBytes = 0;         // Último UpdateSendBuffer
+        double transportRttMs = 0.0;        // Último UpdateTransportStats
+        double availableBitrateKbps = 0.0;  // Teto do transporte (0 = sem teto)
+        BandwidthUsage bandwidthUsage = BandwidthUsage::NORMAL;
         uint32_t bitrateChangeCount = 0;
+
+        // Escada (currentRung = -1 sem escada configurada)
+        int32_t currentRung = -1;
+        uint32_t rungCount = 0;
+        uint32_t targetFps = 0;
+        uint32_t targetWidth = 0;
+        uint32_t targetHeight = 0;
+        uint32_t rungChangeCount = 0;
     };
 
     ABRStats GetStats() const;
 
+    // Granularidade do modo MODEL_BASED
+    static constexpr uint32_t ABR_STEP_KBPS = 50;
+
 private:
     void CalculateTargetBitrate();
+    void CalculateModelBasedBitrate();
+    void UpdateOveruseDetector(double gradientMs, double deltaMs);
+    void UpdateQueueingDelay(double oneWayDelayMs, double arrivalTimeMs);
+    double MeasureGoodputKbps();
+    bool IsSendBufferAboveHigh() const;
+    bool IsSendBufferAboveLow() const;
+    void ApplyBitrateKbps(double bitrateKbps);
+    void UpdateRung();
+    double NowMs() const;
 
     uint32_t m_minBitrateMbps;
+    uint32_t m_minBitrateKbps;          // MODEL_BASED; abaixo de 1 Mbps só via SetLadder
     uint32_t m_maxBitrateMbps;
     uint32_t m_currentBitrateMbps;
     uint32_t m_previousBitrateMbps;
@@ -202,8 +296,61 @@ private:
     double m_packetLossPercent = 0.0;
     double m_decoderBufferMs = 0.0;
 
+    // Buffer de envio (UpdateSendBuffer)
+    size_t m_sendBufferBytes = 0;
+    size_t m_sendBufferLowBytes = 0;
+    size_t m_sendBufferHighBytes = 0;
+
+    // Transporte (UpdateTransportStats)
+    double m_transportRttMs = 0.0;
+    double m_availableBitrateKbps = 0.0;
+
     AdaptationMode m_mode = AdaptationMode::BALANCED;
     uint32_t m_bitrateChangeCount = 0;
+
+    // MODEL_BASED: alvo contínuo (kbps) e saída quantizada
+    uint32_t m_currentBitrateKbps;
+    double m_modelBitrateKbps;
+
+    // Filtro de Kalman do gradiente de atraso (ms por frame)
+    bool m_hasPreviousPacket = false;
+    double m_previousSendMs = 0.0;
+    double m_previousArrivalMs = 0.0;
+    double m_delayGradientMs = 0.0;
+    double m_gradientVariance = 1.0;
+    double m_measurementNoise = 10.0;
+    uint32_t m_gradientSamples = 0;
+
+    // Atraso de fila: atraso de ida menos o mínimo em janela (2 baldes) — pega
+    // fila cheia e estável, que o gradiente sozinho não enxerga
+    double m_baseDelayMs = 0.0;
+    double m_previousBucketMinMs = 0.0;
+    double m_bucketStartMs = 0.0;
+    bool m_hasBaseDelay = false;
+    double m_queueingDelayMs = 0.0;
+    double m_smoothedLossPercent = 0.0;
+
+    // Detector de sobreuso com limiar adaptativo
+    double m_overuseThresholdMs = 12.5;
+    uint32_t m_overuseCount = 0;
+    BandwidthUsage m_bandwidthUsage = BandwidthUsage::NORMAL;
+
+    // Goodput: bytes confirmados por instante de chegada
+    std::deque<std::pair<double, size_t>> m_ackedBytes;
+    size_t m_ackedBytesInWindow = 0;
+    double m_goodputKbps = 0.0;
+
+    // Relógio do modelo (decisões, hold-off)
+    std::function<double()> m_timeSource;
+    double m_lastUpdateMs = -1.0;
+    double m_lastDecreaseMs = -1.0e9;
+    double m_linkCapacityKbps = 0.0;    // Goodput médio nas reduções (0 = desconhecido)
+
+    // Escada com histerese: desce na hora, sobe com folga sustentada
+    std::vector<LadderRung> m_ladder;
+    int32_t m_currentRung = -1;
+    double m_rungUpSinceMs = -1.0;
+    uint32_t m_rungChangeCount = 0;
 };
 
 // Placeholder para futuro WebRTC
@@ -228,28 +375,109 @@ private:
     // Futuramente: rtc::PeerConnection*, etc
 };
 
-// Placeholder para futuro QUIC
+// Configuração do QUICTransport
+struct QUICTransportConfig {
+    std::string alpn = "rdc/1";
+    std::string certificateFile;        // Servidor: certificado e chave PEM (autoassinado serve)
+    std::string privateKeyFile;
+    std::string peerCertificateSha256;  // Cliente: fingerprint do certificado do host, recebido
+                                        // pela sinalização (GetCertificateFingerprint). Obrigatório
+    uint32_t idleTimeoutMs = 10000;
+    uint32_t connectTimeoutMs = 5000;
+    uint32_t maxFramesInFlight = 4;     // Streams de frame sem ack; além disso o mais antigo é abortado
+    uint32_t maxPendingFrames = 8;      // Frames completos esperando Receive (descarta o mais antigo)
+    bool useBBR = true;                 // BBR (sem suporte na lib: Cubic)
+};
+
+/**
+ * @class QUICTransport
+ * @brief QUIC sobre msquic: um stream unidirecional por frame, DATAGRAM para cursor/input
+ *
+ * Cada SendFrame abre um stream unidirecional e o fecha com FIN: perda em um frame só
+ * atrasa esse frame, e os seguintes chegam na ordem em que completam. Frames velhos
+ * (mais de maxFramesInFlight sem ack) têm o stream abortado em vez de disputar banda
+ * com o atual. Mensagens pequenas (cursor, input) vão em QUIC DATAGRAM, sem
+ * retransmissão. Controle de congestionamento BBR; GetLatencyMs é o RTT suavizado da
+ * conexão.
+ *
+ * Identidade do host: o certificado pode ser autoassinado, mas o cliente só conecta
+ * se o SHA-256 do certificado recebido no handshake for o peerCertificateSha256 que
+ * veio pela sinalização (como o a=fingerprint do DTLS no WebRTC).
+ *
+ * Sem msquic no build (RDC_WITH_MSQUIC), IsAvailable() é false e Initialize/Listen
+ * falham.
+ */
 class QUICTransport {
 public:
+    struct Stats {
+        uint64_t framesSent = 0;
+        uint64_t framesReceived = 0;
+        uint64_t framesAborted = 0;         // Streams abortados aqui (frame velho)
+        uint64_t framesDropped = 0;         // Abortados pelo peer ou descartados na fila
+        uint64_t datagramsSent = 0;
+        uint64_t datagramsReceived = 0;
+        uint64_t datagramsLost = 0;         // Dados como perdidos pelo transporte
+        uint64_t certificatesRejected = 0;  // Cliente: fingerprint do host não confere
+        double smoothedRttMs = 0.0;
+        double minRttMs = 0.0;
+        uint64_t packetsSent = 0;
+        uint64_t packetsLost = 0;           // Suspeitos de perda (retransmitidos)
+        uint32_t congestionWindow = 0;
+        bool bbr = false;                   // Controle de congestionamento em uso
+    };
+
     QUICTransport();
+    explicit QUICTransport(const QUICTransportConfig& config);
     ~QUICTransport();
 
-    // Inicializa transportador QUIC (futuro com Quinn/MASQUE)
+    // Build com msquic
+    static bool IsAvailable();
+
+    // Cliente: conecta ao servidor e espera o handshake (connectTimeoutMs)
     bool Initialize(const std::string& remoteAddr, uint16_t remotePort);
 
-    // Envia dados
-    bool Send(const uint8_t* data, uint32_t size);
+    // Servidor: escuta na porta (0 = efêmera, ver GetLocalPort) e aceita um peer
+    bool Listen(uint16_t port);
+    uint16_t GetLocalPort() const;
+
+    // Servidor: fingerprint SHA-256 de certificateFile, a anunciar pela sinalização
+    // (vazio se o arquivo não tem certificado)
+    std::string GetCertificateFingerprint() const;
+
+    // Espera a conexão (servidor: o peer chegar)
+    bool WaitConnected(int timeoutMs);
 
-    // Recebe dados
+    // Envia um frame (ou grupo de tiles) em um stream unidirecional próprio
+    bool SendFrame(const uint8_t* data, uint32_t size);
+
+    // Compatível com o placeholder: o mesmo que SendFrame
+    bool Send(const uint8_t* data, uint32_t size) { return SendFrame(data, size); }
+
+    // Mensagem pequena sem retransmissão (QUIC DATAGRAM); false se maior que
+    // GetMaxDatagramSize() ou se o peer não aceita datagramas
+    bool SendDatagram(const uint8_t* data, uint32_t size);
+    uint32_t GetMaxDatagramSize() const;
+
+    // Próximo frame completo, na ordem em que completaram (não-bloqueante)
     bool Receive(std::vector<uint8_t>& outData);
 
-    // Obtém latência estimada
-    double GetLatencyMs() const { return m_estimatedLatencyMs; }
+    // Próximo datagrama recebido (não-bloqueante)
+    bool ReceiveDatagram(std::vector<uint8_t>& outData);
 
-    bool IsConnected() const { return m_isConnected; }
+    // Espera até haver frame ou datagrama ou timeout
+    bool WaitReadable(int timeoutMs);
+
+    // RTT suavizado da conexão (ms; 0 sem conexão)
+    double GetLatencyMs() const;
+
+    bool IsConnected() const;
+
+    Stats GetStats() const;
+
+    // Fecha a conexão (e o listener)
+    void Shutdown();
 
 private:
-    bool m_isConnected = false;
-    double m_estimatedLatencyMs = 0.0;
-    // Futuramente: quic::Connection*, etc
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
 };
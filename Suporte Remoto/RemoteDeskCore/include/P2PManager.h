@@ -1,38 +1,17 @@
 #pragma once
 
+#include "DatagramChannel.h"
+#include "NetworkProtocol.h"
+#include "SocketCompat.h"
+#include "TransportStats.h"
+
 #include <cstdint>
+#include <deque>
 #include <vector>
 #include <memory>
 #include <string>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <chrono>
 
-#pragma comment(lib, "ws2_32.lib")
-
-struct NetworkFrameHeader {
-    static constexpr uint32_t MAGIC = 0xDEADBEEF;
-    static constexpr uint16_t VERSION = 1;
-
-    uint32_t magic;              // Validação
-    uint16_t version;            // Versão do protocolo
-    uint16_t frameSequence;      // Número sequencial do frame
-    uint32_t frameWidth;         // Largura da imagem
-    uint32_t frameHeight;        // Altura da imagem
-    uint32_t frameStride;        // Stride (bytes por linha)
-    uint32_t pixelDataSize;      // Tamanho dos pixels
-    uint64_t timestamp;          // Timestamp do frame
-    uint8_t flags;               // Flags (keyframe, etc)
-    uint8_t reserved[7];         // Padding para alinhamento
-};
-
-static_assert(sizeof(NetworkFrameHeader) == 48, "NetworkFrameHeader must be 48 bytes");
-
-struct NetworkPacket {
-    NetworkFrameHeader header;
-    std::vector<uint8_t> pixelData;
-};
-
 class P2PManager {
 public:
     enum class Role { CLIENT, SERVER };
@@ -46,15 +25,40 @@ public:
     // Inicializa como cliente (conecta a servidor)
     bool InitializeAsClient(const std::string& serverIP, uint16_t serverPort = 12345);
 
+    // Inicializa sobre um canal de datagramas já conectado (ex: EmulatedLink)
+    bool InitializeWithChannel(std::shared_ptr<IDatagramChannel> channel, Role role = Role::CLIENT);
+
     // Envia frame para o peer
     bool SendFrame(const uint8_t* pixelData, uint32_t width, uint32_t height,
                    uint32_t stride, uint16_t frameSequence = 0);
 
+    // Envia frame incremental (FRAME_FLAG_TILE_DELTA): payload de EncodeTileDelta,
+    // dimensões do frame completo
+    bool SendFrameDelta(const uint8_t* payload, size_t size, uint32_t width, uint32_t height,
+                        uint32_t stride, uint16_t frameSequence);
+
+    // Envia um datagrama já serializado (header + payload de SerializePacket). O
+    // FanoutSender serializa cada frame uma vez e entrega o mesmo buffer a todos os viewers
+    bool SendDatagram(const uint8_t* datagram, size_t size);
+
     // Recebe frame do peer (não-bloqueante)
     bool ReceiveFrame(std::vector<uint8_t>& outPixelData, 
                       uint32_t& outWidth, uint32_t& outHeight,
                       uint32_t& outStride, uint16_t& outFrameSequence);
 
+    // Flags do último frame de ReceiveFrame (FRAME_FLAG_*)
+    uint8_t GetLastFrameFlags() const { return m_lastFrameFlags; }
+
+    // Camada de simulcast do último frame de ReceiveFrame
+    uint8_t GetLastFrameLayer() const { return m_lastFrameLayer; }
+
+    // Envia mensagem de controle (cursor, input...) no mesmo transporte dos frames
+    bool SendControlMessage(PacketType type, const uint8_t* payload, size_t size);
+
+    // Recebe a próxima mensagem de controle (não-bloqueante). Frames lidos no
+    // caminho ficam guardados para o próximo ReceiveFrame (só o mais recente)
+    bool ReceiveControlMessage(PacketType& outType, std::vector<uint8_t>& outPayload);
+
     // Verifica se há dados disponíveis para leitura
     bool IsDataAvailable(int timeoutMs = 0);
 
@@ -70,9 +74,45 @@ public:
 
     ConnectionStats GetStats() const { return m_stats; }
 
+    // RTT/perda/taxa: envia TRANSPORT_PROBE a cada 250 ms e fecha a janela de
+    // perda e taxa. Chamar no loop; as respostas são tratadas ao ler pacotes
+    void ServiceTransportStats();
+    TransportStats GetTransportStats() const { return m_transportStats; }
+
+    // Frames confirmados pelo peer (FRAME_FEEDBACK) desde a última chamada, na ordem
+    // de chegada. O receptor devolve as chegadas em ServiceTransportStats
+    void TakeFrameFeedback(std::vector<FrameFeedback>& outFeedback);
+
     // Verifica status da conexão
     bool IsConnected() const { return m_isConnected; }
 
+    // Porta UDP local (útil com InitializeAsServer(0)); 0 sem socket
+    uint16_t GetLocalPort() const;
+
+    // Bytes enviados e ainda não entregues à rede: bufferedAmount do canal ou fila do
+    // socket (SIOCOUTQ). 0 onde não há como medir (UDP no Windows). Vai ao ABR
+    // (AdaptiveBitRateController::UpdateSendBuffer)
+    size_t GetSendBufferedBytes() const;
+
+    // Servidor: fixa o peer no endereço do último pacote recebido e descarta os
+    // demais (caminhos perdedores da corrida de conexão ainda podem ter probes em voo).
+    // SESSION_RESUME ainda entra de outros endereços: o cliente pode ter trocado de rede
+    void LockPeer() { m_peerLocked = true; }
+
+    // Servidor: adota o endereço do último SESSION_RESUME (depois de validar o token)
+    void AcceptResumedPeer();
+
+    // Servidor: muda a cada troca do endereço do peer (cliente novo, reiniciado ou
+    // retomado de outra rede). Estado por cliente (ex: sequência do input) recomeça
+    uint32_t GetPeerGeneration() const { return m_peerGeneration; }
+
+    // Cliente UDP: socket novo para o mesmo endereço do host (retomada depois de uma
+    // queda, sem sinalização nem ICE). Sobre canal não faz nada
+    bool ReopenSocket();
+
+    // ms desde o último pacote recebido (UINT64_MAX antes do primeiro)
+    uint64_t GetIdleMs() const;
+
     // Libera recursos
     void Disconnect();
 
@@ -82,28 +122,75 @@ public:
     void SetRecvBufferSize(uint32_t size) { m_recvBufferSize = size; }
 
 private:
-    bool InitializeWinsock();
+    bool InitializeSockets();
     bool CreateUDPSocket();
     bool BindSocket(uint16_t port);
     bool ConnectToServer(const std::string& ip, uint16_t port);
     bool SendPacket(const NetworkPacket& packet);
     bool ReceivePacket(NetworkPacket& outPacket);
+    void FillHeader(NetworkFrameHeader& header, PacketType type) const;
+
+    // Responde / consome TRANSPORT_PROBE(_REPLY) e FRAME_FEEDBACK; true se o pacote era um deles
+    bool HandleTransportMessage(const NetworkPacket& packet);
+    void HandleFrameFeedback(const NetworkPacket& packet);
+
+    // Chegadas de FRAME a devolver ao peer (FRAME_FEEDBACK)
+    void RecordFrameArrival(const NetworkPacket& packet, size_t bytes);
+    void FlushFrameArrivals();
 
     SOCKET m_socket = INVALID_SOCKET;
     sockaddr_in m_peerAddr = {};
+
+    // Transporte alternativo ao socket (nullptr = UDP)
+    std::shared_ptr<IDatagramChannel> m_channel;
     
     Role m_role = Role::CLIENT;
     bool m_isConnected = false;
+    bool m_peerLocked = false;
+    sockaddr_in m_resumeAddr = {};         // Origem do último SESSION_RESUME de outro endereço
+    bool m_hasResumeAddr = false;
+    uint32_t m_peerGeneration = 0;
+    uint8_t m_lastFrameFlags = 0;
+    uint8_t m_lastFrameLayer = 0;
     bool m_wsaInitialized = false;
 
     // Buffers
     std::vector<uint8_t> m_sendBuffer;
     std::vector<uint8_t> m_receiveBuffer;
+    std::vector<uint8_t> m_channelBuffer;
     uint32_t m_maxPacketSize = 65536;      // 64KB max UDP packet
     uint32_t m_sendBufferSize = 2097152;   // 2MB send buffer
     uint32_t m_recvBufferSize = 2097152;   // 2MB receive buffer
 
+    // Demultiplexação: mensagens lidas por ReceiveFrame e frame lido por ReceiveControlMessage
+    std::deque<NetworkPacket> m_pendingMessages;
+    NetworkPacket m_pendingFrame;
+    bool m_hasPendingFrame = false;
+
     // Estatísticas
     ConnectionStats m_stats;
     std::chrono::high_resolution_clock::time_point m_lastFrameTime;
+
+    // Medição do transporte (TRANSPORT_PROBE)
+    TransportStats m_transportStats;
+    TransportRateWindow m_transportWindow;
+    uint32_t m_probeSequence = 0;
+    std::chrono::steady_clock::time_point m_lastProbeSent;
+    bool m_hasProbeReply = false;
+    uint64_t m_lastReplyPacketsSent = 0;        // Ecoados na resposta anterior
+    uint64_t m_lastReplyPacketsReceived = 0;
+    uint64_t m_probedPacketsSent = 0;           // Enviados cobertos por respostas
+
+    // Feedback por frame (FRAME_FEEDBACK): envio indexado por frameSequence de um
+    // lado, chegadas a devolver do outro
+    struct SentFrame {
+        uint64_t sendTimeUs = 0;
+        uint16_t frameSequence = 0;
+        bool pending = false;
+    };
+    static constexpr size_t SENT_FRAME_HISTORY = 1024;
+    std::vector<SentFrame> m_sentFrames;
+    std::deque<FrameFeedback> m_frameFeedback;
+    std::vector<FrameArrivalEntry> m_frameArrivals;
+    std::chrono::steady_clock::time_point m_lastFeedbackSent;
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @file PlatformCompat.h
+ * @brief Shims mínimos para compilar o código portável fora do Windows
+ *
+ * No Windows apenas inclui <windows.h>. Em Linux (benchmarks, relays,
+ * ferramentas de teste) OutputDebugStringA segue a semântica do Windows:
+ * silencioso, a não ser que RDC_DEBUG_OUTPUT esteja definido (aí vai para stderr).
+ */
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cstdio>
+#include <cstdlib>
+
+inline void OutputDebugStringA(const char* message) {
+    static const bool enabled = std::getenv("RDC_DEBUG_OUTPUT") != nullptr;
+    if (enabled) {
+        std::fputs(message, stderr);
+    }
+}
+#endif
@@ -15,12 +15,23 @@
 #include "DXGICapturer.h"
 #include "Renderer.h"
 #include "P2PManager.h"
+#include "SessionConnector.h"
 #include "NVENCEncoder.h"
 #include "InputInjector.h"
 #include "OptimizationLayer.h"
+#include "MetricsExporter.h"
+#include "ContentClassifier.h"
+#include "FrameScaler.h"
+#include "CursorProtocol.h"
+#include "InputProtocol.h"
+#include "LatencyProbe.h"
+#include "SessionResume.h"
 
 #include <memory>
 #include <atomic>
+#include <string>
+#include <chrono>
+#include <vector>
 
 class RemoteDesktopSystem {
 public:
@@ -42,6 +53,15 @@ public:
     bool InitializeAsClient(const std::string& serverIP, 
                             uint16_t networkPort = 12345);
 
+    // Modo 4: Host via sinalização (SessionConnector: LAN UDP e WebRTC em corrida).
+    // Bloqueia até um guest conectar; o pipeline é montado enquanto isso
+    bool InitializeAsHost(const std::string& signalingUrl,
+                          uint32_t targetBitrateMbps = 25);
+
+    // Modo 5: Guest via sinalização (ID da sessão impresso pelo host)
+    bool InitializeAsGuest(const std::string& signalingUrl,
+                           const std::string& sessionId);
+
     // ===== Execução =====
 
     // Run main loop
@@ -58,6 +78,28 @@ public:
     void SetUseEncoding(bool useEncoding) { m_useEncoding = useEncoding; }
     void SetUseNetworking(bool useNetworking) { m_useNetworking = useNetworking; }
     void SetInputEnabled(bool enabled) { m_inputEnabled = enabled; }
+    void SetUseContentClassification(bool enabled) { m_useContentClassification = enabled; }
+
+    // Probe de latência input → foto (cliente): um probe a cada 500 ms, resultado
+    // no histograma rdc_input_to_photon_ms e em PrintStats
+    void SetLatencyProbe(bool enabled, ProbeMode mode = ProbeMode::MARKER, uint16_t virtualKey = 0) {
+        m_useLatencyProbe = enabled;
+        m_latencyProbeMode = mode;
+        m_latencyProbeKey = virtualKey;
+    }
+
+    // Tracing: habilita os trace points durante Run() e grava o arquivo ao final
+    // (".json" → Chrome trace-event, outra extensão → Perfetto protobuf)
+    void SetTraceOutputPath(const std::string& path) { m_traceOutputPath = path; }
+
+    // Exporta os ring buffers de trace sob demanda (pode ser chamado a qualquer momento)
+    bool DumpTrace(const std::string& path) const;
+
+    // Metrics: porta do endpoint Prometheus (0 = desabilitado)
+    void SetMetricsPort(uint16_t port, const std::string& bindAddress = "127.0.0.1") {
+        m_metricsPort = port;
+        m_metricsBindAddress = bindAddress;
+    }
 
     // ABR settings
     void SetAdaptiveMode(AdaptiveBitRateController::AdaptationMode mode) { 
@@ -95,6 +137,42 @@ private:
     void MainLoopClient();
     void MainLoopLoopback();
 
+    // Pipelines de host (captura, encode, input, threads) e cliente (render, input),
+    // comuns aos modos LAN e sinalização. Não tocam na rede
+    bool InitializeServerPipeline(uint32_t targetBitrateMbps);
+    bool InitializeClientPipeline();
+
+    // Poll do SessionConnector até conectar ou falhar; fica com o transporte vencedor
+    bool WaitForSession(SessionConnector& connector);
+
+    // Copia as estatísticas de todos os componentes para o endpoint de métricas
+    void PublishMetrics();
+
+    // Probe do transporte (RTT/perda/taxa) e, a cada janela fechada, o ABR
+    void UpdateTransportMetrics();
+
+    // Aplica o ponto de operação do ABR (fps de captura, resolução e bitrate do encode).
+    // Retorna o frame a codificar/enviar (o original ou a versão reduzida)
+    const FrameData& ApplyOperatingPoint(const FrameData& frame);
+
+    // Cursor (canal separado do vídeo): host envia posição/forma, cliente desenha.
+    // Retorna true no cliente se o cursor mudou e a janela precisa ser redesenhada.
+    // O cliente também lê aqui o token e o ack da retomada de sessão
+    void SendCursorUpdates();
+    bool ProcessCursorMessages();
+
+    // Host: mensagens do cliente (lotes de input, pedidos de forma do cursor, retomada)
+    void ProcessHostMessages();
+
+    // Host: frame de rede (delta de tiles se for a retomada de uma queda, senão completo)
+    void SendNetworkFrame(const FrameData& frame, uint16_t frameSequence);
+
+    // Cliente: detecta queda e manda SESSION_RESUME pelo último caminho (sem sinalização)
+    void ServiceSessionResume();
+
+    // Cliente: envia o input da janela em lotes (movimentos fundidos por tick)
+    void SendInputEvents();
+
     // Phase 1: Capture & Render
     std::unique_ptr<DXGICapturer> m_capturer;
     std::unique_ptr<Renderer> m_renderer;
@@ -103,25 +181,77 @@ private:
     std::unique_ptr<P2PManager> m_network;
 
     // Phase 3: Encoding
-    std::unique_ptr<NVENCEncoder> m_encoder;
+    std::unique_ptr<IVideoEncoder> m_encoder;
 
     // Phase 4: Input
-    std::unique_ptr<InputInjector> m_inputInjector;
+    std::unique_ptr<IInputInjector> m_inputInjector;
 
     // Phase 5: Optimization
     std::unique_ptr<MultiThreadedCapture> m_threadedCapture;
     std::unique_ptr<MultiThreadedRenderer> m_threadedRenderer;
     std::unique_ptr<AdaptiveBitRateController> m_abrController;
 
+    // Ponto de operação aplicado no servidor
+    std::chrono::steady_clock::time_point m_nextCaptureTime;
+    FrameScaler m_scaler;
+    FrameData m_scaledFrame{};
+    std::vector<uint8_t> m_scaleReference;  // Captura que gerou m_scaledFrame
+    std::vector<uint8_t> m_scaleDirtyTiles;
+    uint32_t m_encodeWidth = 0;
+    uint32_t m_encodeHeight = 0;
+    uint32_t m_encodeBitrateKbps = 0;
+
+    // Qualidade por região (texto / UI / vídeo)
+    std::unique_ptr<ContentClassifier> m_contentClassifier;
+    uint32_t m_contentFpsCap = 60;
+
+    // Cursor: formas por hash (host responde pedidos, cliente evita reenvios)
+    CursorShapeCache m_cursorShapes;
+    CursorPositionMessage m_lastCursor{};
+    uint64_t m_lastSentShapeHash = 0;      // Host: última forma enviada (independe da posição)
+    uint64_t m_pendingCursorShape = 0;     // Cliente: forma que falta no cache
+    std::chrono::steady_clock::time_point m_lastCursorSend;
+    std::chrono::steady_clock::time_point m_lastShapeRequest;
+
+    // Input: lotes no cliente, ordem dos lotes no host
+    InputBatcher m_inputBatcher;
+    std::vector<InputEvent> m_inputEvents;
+    std::vector<uint8_t> m_inputPayload;
+    std::unique_ptr<RemoteInputHandler> m_remoteInput;
+    uint32_t m_inputPeerGeneration = 0;    // P2PManager::GetPeerGeneration do último lote
+
+    // Probe de latência: host marca os frames, cliente mede até a apresentação
+    std::unique_ptr<LatencyProbeHost> m_latencyProbeHost;
+    std::unique_ptr<LatencyProbeClient> m_latencyProbeClient;
+
+    // Retomada de sessão após queda curta: token e histórico no host, referência no cliente
+    std::unique_ptr<SessionResumeHost> m_resumeHost;
+    std::unique_ptr<SessionResumeClient> m_resumeClient;
+    std::chrono::steady_clock::time_point m_lastTokenSend;
+    std::vector<uint8_t> m_resumePayload;
+
+    // Observabilidade
+    std::unique_ptr<MetricsExporter> m_metricsExporter;
+    uint16_t m_metricsPort = 0;
+    std::string m_metricsBindAddress = "127.0.0.1";
+    std::chrono::steady_clock::time_point m_lastMetricsPublish;
+    uint64_t m_lastTransportSample = 0;     // sampleCount já entregue ao ABR
+    std::vector<FrameFeedback> m_frameFeedback;
+
     // Configuration
     Mode m_mode = Mode::LOOPBACK;
     bool m_useMultiThreading = false;
     bool m_useEncoding = false;
     bool m_useNetworking = false;
     bool m_inputEnabled = false;
-
-    AdaptiveBitRateController::AdaptationMode m_abrMode = 
-        AdaptiveBitRateController::AdaptationMode::BALANCED;
+    bool m_useContentClassification = true;
+    bool m_useLatencyProbe = false;
+    ProbeMode m_latencyProbeMode = ProbeMode::MARKER;
+    uint16_t m_latencyProbeKey = 0;
+    std::string m_traceOutputPath;
+
+    AdaptiveBitRateController::AdaptationMode m_abrMode =
+        AdaptiveBitRateController::AdaptationMode::MODEL_BASED;
 
     // State
     std::atomic<bool> m_isRunning{ false };
@@ -1,14 +1,18 @@
 #pragma once
 
+#include "InputProtocol.h"
+
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 struct SDL_Window;
 struct SDL_Renderer;
 struct SDL_Texture;
 
 struct FrameData;
+struct CursorShape;
 
 class Renderer {
 public:
@@ -21,12 +25,22 @@ public:
     // Atualiza a textura com novos dados de pixels (BGRA)
     bool UpdateFrame(const uint8_t* pixelData, uint32_t width, uint32_t height, uint32_t stride);
 
-    // Renderiza o frame na tela
+    // Renderiza o frame na tela (com o cursor local por cima)
     bool RenderFrame();
 
+    // Cursor remoto desenhado localmente: forma BGRA e posição em pixels da captura
+    bool SetCursorShape(const CursorShape& shape);
+    void SetCursorPosition(int32_t x, int32_t y, bool visible,
+                           uint32_t sourceWidth, uint32_t sourceHeight);
+
     // Processa eventos de janela (redimensionamento, fechamento, etc)
     bool ProcessEvents();
 
+    // Input para o host: com a captura ligada, ProcessEvents converte mouse/teclado
+    // da janela em InputEvent (coordenadas normalizadas, teclas VK_*)
+    void SetInputCapture(bool enabled) { m_captureInput = enabled; }
+    void TakeInputEvents(std::vector<InputEvent>& outEvents);
+
     // Define o título da janela (útil para mostrar FPS)
     void SetWindowTitle(const std::string& title);
 
@@ -46,6 +60,7 @@ private:
     SDL_Window* m_window = nullptr;
     SDL_Renderer* m_renderer = nullptr;
     SDL_Texture* m_texture = nullptr;
+    SDL_Texture* m_cursorTexture = nullptr;
 
     uint32_t m_windowWidth = 0;
     uint32_t m_windowHeight = 0;
@@ -53,5 +68,20 @@ private:
     uint32_t m_textureHeight = 0;
 
     bool m_isRunning = false;
+
+    // Input capturado desde o último TakeInputEvents
+    bool m_captureInput = false;
+    std::vector<InputEvent> m_inputEvents;
+
+    // Cursor
+    uint32_t m_cursorWidth = 0;
+    uint32_t m_cursorHeight = 0;
+    int32_t m_cursorHotspotX = 0;
+    int32_t m_cursorHotspotY = 0;
+    int32_t m_cursorX = 0;
+    int32_t m_cursorY = 0;
+    bool m_cursorVisible = false;
+    uint32_t m_cursorSourceWidth = 0;
+    uint32_t m_cursorSourceHeight = 0;
     bool m_vsyncEnabled = true;
 };
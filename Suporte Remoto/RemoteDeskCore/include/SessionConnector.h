@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * @file SessionConnector.h
+ * @brief Abertura de sessão host/guest: sinalização, coleta de candidatos em paralelo e corrida de caminhos
+ *
+ * Em vez de registrar → oferta → resposta → coletar → conectar em sequência, tudo
+ * que não depende do peer começa em Start():
+ * - conexão e registro na sinalização (WebSocketSignalingClient)
+ * - host: socket UDP do caminho LAN e candidatos host de cada endereço local
+ * - WebRTC: Initialize + oferta (host) já no início, então a coleta host/srflx/relay
+ *   do libdatachannel corre junto com a sinalização
+ *
+ * Cada candidato local sai assim que existe (trickle, em lote por tick do cliente)
+ * e assim que o peer remoto é conhecido. Candidatos do caminho LAN usam
+ * sdpMid = "rdc-udp" (o WebRTC os ignora); os demais vão para AddIceCandidate,
+ * guardados até a descrição remota chegar. Com quicPort, o host também anuncia o
+ * QUICTransport (sdpMid = "rdc-quic") com o SHA-256 do certificado; o guest expõe
+ * esses endpoints em GetQuicEndpoints para fixar o certificado ao conectar.
+ *
+ * Caminhos correm em paralelo, todos como P2PManager (UDP direto ou sobre
+ * WebRTCDatagramChannel). O TRANSPORT_PROBE de cada um é o teste de conectividade:
+ * a primeira resposta conecta o caminho. O guest fica com o primeiro caminho que
+ * conectar e o indica com PATH_NOMINATION; o host adota o caminho em que a
+ * nomeação chegar. Os demais são fechados.
+ *
+ * Uso (sem bloquear a main loop):
+ * ```cpp
+ * SessionConnector connector;
+ * connector.Start(config);
+ * while (connector.Poll() == SessionConnector::State::CONNECTING) { ... }
+ * std::unique_ptr<P2PManager> network = connector.TakeTransport();
+ * ```
+ */
+
+#include "P2PManager.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SessionConnector {
+public:
+    enum class Role { HOST, GUEST };
+    enum class State { CONNECTING, CONNECTED, FAILED };
+
+    struct Config {
+        Role role = Role::HOST;
+        std::string signalingUrl;
+        std::string peerId;                 // Vazio = gerado
+        std::string sessionId;              // Guest: sessão do host
+        uint16_t lanPort = 0;               // Host: porta UDP do caminho LAN (0 = efêmera)
+        bool enableLanPath = true;
+        uint16_t quicPort = 0;              // Host: porta do QUICTransport (0 = não anuncia)
+        std::string quicCertificateFingerprint; // Host: QUICTransport::GetCertificateFingerprint()
+        bool enableWebRtcPath = true;
+        std::vector<std::string> stunServers;
+        std::vector<std::string> turnServers;
+        uint32_t timeoutMs = 15000;          // 0 = sem limite (host esperando guest)
+    };
+
+    // ms desde Start (-1 = ainda não aconteceu)
+    struct Timings {
+        double registeredMs = -1.0;             // register-ack
+        double remotePeerMs = -1.0;             // Peer remoto conhecido (guest: ack; host: guest-connected)
+        double firstLocalCandidateMs = -1.0;
+        double firstRemoteCandidateMs = -1.0;
+        double remoteDescriptionMs = -1.0;      // Oferta/resposta do peer aplicada
+        double connectedMs = -1.0;              // Caminho escolhido
+    };
+
+    // Guest: QUICTransport anunciado pelo host (peerCertificateSha256 = fingerprint)
+    struct QuicEndpoint {
+        std::string address;
+        uint16_t port = 0;
+        std::string fingerprint;
+    };
+
+    struct PathInfo {
+        std::string name;
+        bool connected = false;
+        double connectMs = -1.0;                // Primeira resposta de probe
+        double rttMs = 0.0;
+    };
+
+    SessionConnector();
+    ~SessionConnector();
+
+    SessionConnector(const SessionConnector&) = delete;
+    SessionConnector& operator=(const SessionConnector&) = delete;
+
+    // Inicia sinalização, coleta e caminhos locais; false se a URL é inválida
+    bool Start(const Config& config);
+
+    // Avança sinalização e corrida (não bloqueia)
+    State Poll();
+
+    // Caminho extra na corrida (ex: link emulado em ferramentas). O transporte pode
+    // ser inicializado depois; só conta a partir da primeira resposta de probe
+    void AddPath(const std::string& name, std::unique_ptr<P2PManager> transport);
+
+    // Transporte vencedor (uma vez, depois de CONNECTED); encerra a sinalização e
+    // os caminhos perdedores
+    std::unique_ptr<P2PManager> TakeTransport();
+
+    const std::string& GetWinnerName() const { return m_winnerName; }
+    std::string GetSessionId() const;
+    const std::string& GetPeerId() const { return m_config.peerId; }
+    Timings GetTimings() const { return m_timings; }
+    std::vector<PathInfo> GetPaths() const;
+    const std::vector<QuicEndpoint>& GetQuicEndpoints() const { return m_quicEndpoints; }
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_pImpl;
+
+    Config m_config;
+    Timings m_timings;
+    std::string m_winnerName;
+    std::vector<QuicEndpoint> m_quicEndpoints;
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+/**
+ * @file SessionResume.h
+ * @brief Retomada de sessão após quedas curtas (Wi-Fi): token, último caminho e frame incremental
+ *
+ * Depois de conectar, o host manda um token de sessão (SESSION_TOKEN, repetido a cada
+ * segundo). Quando o cliente passa resumeSilenceMs sem receber nada, ele não refaz
+ * sinalização nem ICE: reabre o socket e manda SESSION_RESUME direto para o último
+ * endereço do host que funcionou, com o token e o número do último frame apresentado.
+ *
+ * O host guarda os hashes por tile dos últimos frames enviados (o estado de referência
+ * do cliente) enquanto durar o período de graça. Se o frame do cliente ainda está no
+ * histórico, o próximo frame sai incremental (FRAME_FLAG_TILE_DELTA): só os tiles que
+ * mudaram desde ele, aplicados sobre a imagem que o cliente já tem. Sem referência, sai
+ * um frame completo; com o período de graça vencido, a retomada é recusada.
+ *
+ * O mesmo SESSION_RESUME sem referência serve de pedido de frame completo quando um
+ * delta não casa com o que o cliente tem.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+constexpr size_t SESSION_TOKEN_SIZE = 16;
+
+enum class ResumeStatus : uint8_t {
+    ACCEPTED = 0,
+    UNKNOWN_TOKEN = 1,      // Token de outra sessão (ou host reiniciado)
+    EXPIRED = 2             // Período de graça vencido: referência descartada
+};
+
+// Payload de SESSION_TOKEN
+struct SessionTokenMessage {
+    uint8_t token[SESSION_TOKEN_SIZE];
+    uint32_t graceMs;               // Quanto tempo o host espera o cliente voltar
+    uint32_t reserved;
+};
+
+// Payload de SESSION_RESUME
+struct SessionResumeMessage {
+    uint8_t token[SESSION_TOKEN_SIZE];
+    uint64_t sendTimeUs;            // Relógio do cliente (ecoado no ack)
+    uint16_t referenceSequence;     // Último frame apresentado
+    uint8_t hasReference;           // 0 = pedir frame completo
+    uint8_t reserved[5];
+};
+
+// Payload de SESSION_RESUME_ACK
+struct SessionResumeAckMessage {
+    uint64_t sendTimeUs;            // Ecoado do SESSION_RESUME
+    uint8_t status;                 // ResumeStatus
+    uint8_t incremental;            // 1 = o próximo frame é delta sobre referenceSequence
+    uint16_t referenceSequence;
+    uint32_t reserved;
+};
+
+// Início do payload de um frame FRAME_FLAG_TILE_DELTA; seguem tileCount tiles, cada um
+// com tileX/tileY (uint16) e as linhas do tile (recortadas na borda do frame)
+struct TileDeltaHeader {
+    uint16_t baseSequence;          // Frame do cliente sobre o qual o delta se aplica
+    uint16_t tileSize;
+    uint32_t tileCount;
+};
+
+static_assert(sizeof(SessionTokenMessage) == 24, "SessionTokenMessage must be 24 bytes");
+static_assert(sizeof(SessionResumeMessage) == 32, "SessionResumeMessage must be 32 bytes");
+static_assert(sizeof(SessionResumeAckMessage) == 16, "SessionResumeAckMessage must be 16 bytes");
+static_assert(sizeof(TileDeltaHeader) == 8, "TileDeltaHeader must be 8 bytes");
+
+// Delta com os tiles marcados em dirtyTiles (um byte por tile, row-major). Retorna o
+// tamanho do payload
+size_t EncodeTileDelta(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                       uint32_t tileSize, const std::vector<uint8_t>& dirtyTiles,
+                       uint16_t baseSequence, std::vector<uint8_t>& outPayload);
+
+// Aplica o delta sobre frame (mesmas dimensões). false se o payload é inválido; os
+// tiles não são escritos nesse caso
+bool ApplyTileDelta(const uint8_t* payload, size_t size, uint8_t* frame,
+                    uint32_t width, uint32_t height, uint32_t stride);
+
+/**
+ * @class SessionResumeHost
+ * @brief Token, histórico de hashes por tile e decisão de retomada no host
+ */
+class SessionResumeHost {
+public:
+    struct Stats {
+        uint64_t resumesAccepted = 0;
+        uint64_t resumesRejected = 0;
+        uint64_t incrementalFrames = 0;     // Retomadas respondidas com delta
+        uint64_t fullFrames = 0;            // Retomadas sem referência no histórico
+        uint32_t lastResumeTiles = 0;       // Tiles no último delta
+        uint32_t lastResumeTotalTiles = 0;
+        uint64_t lastResumeBytes = 0;       // Payload do último frame de retomada
+    };
+
+    explicit SessionResumeHost(uint32_t graceMs = 10000, uint32_t tileSize = 64,
+                               size_t historyFrames = 120);
+
+    void FillTokenMessage(SessionTokenMessage& outMessage) const;
+
+    // Frame enviado ao cliente: guarda os hashes por tile (histórico limitado). Com o
+    // cliente em silêncio o histórico congela: esses frames provavelmente não chegaram
+    void OnFrameSent(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                     uint16_t sequence);
+
+    // A cada iteração, antes de ler mensagens: idleMs = P2PManager::GetIdleMs(). O
+    // período de graça conta do último pacote; vencido, o histórico é descartado
+    void UpdatePeerActivity(uint64_t idleMs, uint64_t nowMs);
+
+    // Valida token e período de graça. Aceita: o próximo frame sai como retomada
+    ResumeStatus HandleResume(const SessionResumeMessage& message, uint64_t nowMs,
+                              SessionResumeAckMessage& outAck);
+
+    // Há um frame de retomada pendente (enviar mesmo sem mudança na tela)
+    bool NeedsResumeFrame() const { return m_pendingResume; }
+
+    // Frame de retomada: delta contra a referência do cliente em outPayload (true) ou
+    // false para mandar o frame completo. Limpa a pendência
+    bool BuildResumeDelta(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                          std::vector<uint8_t>& outPayload);
+
+    // Frame completo enviado no lugar do delta
+    void OnFullResumeFrame(size_t bytes);
+
+    Stats GetStats() const { return m_stats; }
+
+private:
+    struct Reference {
+        uint16_t sequence = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint64_t> tileHashes;
+    };
+
+    const Reference* FindReference(uint16_t sequence) const;
+
+    uint8_t m_token[SESSION_TOKEN_SIZE];
+    uint32_t m_graceMs;
+    uint32_t m_tileSize;
+    size_t m_historyFrames;
+
+    std::deque<Reference> m_history;        // Mais antigo na frente
+    uint64_t m_lastActivityMs = 0;
+    uint64_t m_peerIdleMs = 0;
+    bool m_hasActivity = false;
+
+    bool m_pendingResume = false;
+    bool m_pendingIncremental = false;
+    Reference m_resumeReference;            // Cópia: o histórico segue andando
+    std::vector<uint64_t> m_currentHashes;
+    std::vector<uint8_t> m_dirtyTiles;
+
+    Stats m_stats;
+};
+
+/**
+ * @class SessionResumeClient
+ * @brief Detecção de queda, SESSION_RESUME e referência para frames incrementais no cliente
+ */
+class SessionResumeClient {
+public:
+    struct Stats {
+        uint64_t outages = 0;                   // Quedas detectadas
+        uint64_t resumeAttempts = 0;            // SESSION_RESUME enviados
+        uint64_t resumesAccepted = 0;
+        uint64_t resumesRejected = 0;
+        uint64_t incrementalFrames = 0;         // Deltas aplicados
+        uint64_t deltaMismatches = 0;           // Delta sobre outra base: pediu frame completo
+        double lastReconnectToFrameMs = -1.0;   // SESSION_RESUME (aceito) → frame apresentado
+        double lastOutageMs = -1.0;             // Último pacote antes da queda → frame apresentado
+    };
+
+    explicit SessionResumeClient(uint32_t resumeSilenceMs = 1000, uint32_t retryMs = 250);
+
+    // SESSION_TOKEN do host
+    bool OnToken(const uint8_t* payload, size_t size);
+    bool HasToken() const { return m_hasToken; }
+
+    // A cada iteração: idleMs = tempo sem receber. true quando um SESSION_RESUME deve
+    // sair agora (outMessage); outReopenSocket = reabrir o socket antes de enviar
+    bool Service(uint64_t nowUs, uint64_t idleMs, SessionResumeMessage& outMessage, bool& outReopenSocket);
+
+    void OnResumeAck(const uint8_t* payload, size_t size);
+
+    // Frame completo apresentado: vira a referência (troca de buffers, sem cópia)
+    void KeepReference(std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, uint32_t stride,
+                       uint16_t sequence);
+
+    // Delta sobre a referência. false se a base ou as dimensões não batem: o próximo
+    // Service pede um frame completo
+    bool ApplyDelta(const uint8_t* payload, size_t size, uint32_t width, uint32_t height,
+                    uint32_t stride, uint16_t sequence);
+
+    const std::vector<uint8_t>& GetReference() const { return m_reference; }
+
+    // Frame apresentado (completo ou delta): fecha a medição da retomada
+    void OnFramePresented(uint64_t nowUs);
+
+    bool IsResuming() const { return m_state != State::CONNECTED; }
+    bool HasGivenUp() const { return m_state == State::GAVE_UP; }
+    Stats GetStats() const { return m_stats; }
+
+private:
+    enum class State { CONNECTED, RESUMING, AWAITING_FRAME, GAVE_UP };
+
+    uint32_t m_resumeSilenceMs;
+    uint32_t m_retryMs;
+
+    uint8_t m_token[SESSION_TOKEN_SIZE] = {};
+    uint32_t m_graceMs = 0;
+    bool m_hasToken = false;
+
+    State m_state = State::CONNECTED;
+    bool m_requestFullFrame = false;
+    uint64_t m_outageStartUs = 0;
+    uint64_t m_lastAttemptUs = 0;
+    uint32_t m_attempts = 0;                // Nesta queda
+    uint64_t m_acceptedSendTimeUs = 0;
+
+    std::vector<uint8_t> m_reference;
+    uint32_t m_referenceWidth = 0;
+    uint32_t m_referenceHeight = 0;
+    uint32_t m_referenceStride = 0;
+    uint16_t m_referenceSequence = 0;
+    bool m_hasReference = false;
+
+    Stats m_stats;
+};
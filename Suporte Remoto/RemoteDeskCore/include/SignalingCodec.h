@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * @file SignalingCodec.h
+ * @brief Mensagens de sinalização ↔ JSON do signaling-server.js
+ *
+ * JSON mínimo e sem dependências: só o formato plano que o servidor usa
+ * ({"type", "peerId", "remotePeerId", "sessionId", "data": {...}}).
+ *
+ * Candidatos ICE saem em lote: "ice-candidates" com data.candidates = [{...}, ...],
+ * um por tick do cliente em vez de uma mensagem por candidato. O decodificador
+ * expande o lote em várias mensagens ICE_CANDIDATE, então quem consome não muda.
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @struct SignalingMessage
+ * @brief Mensagem de sinalização
+ */
+struct SignalingMessage {
+    enum Type {
+        REGISTER,           // Registra novo peer
+        REGISTER_ACK,       // Servidor confirmou o registro (sessionId, resumeSecret, remotePeerId = host)
+        OFFER,              // Oferta SDP
+        ANSWER,             // Resposta SDP
+        ICE_CANDIDATE,      // Candidato ICE
+        PEER_CONNECTED,     // Guest entrou na sessão (remotePeerId = guest)
+        PEER_DISCONNECTED,  // Host saiu da sessão
+        PING,               // Keep-alive
+        PONG,               // Keep-alive response
+        SERVER_ERROR        // Erro (errorMessage)
+    };
+
+    Type type = PING;
+    std::string peerId;         // ID único do peer (remetente)
+    std::string remotePeerId;   // Destinatário (ou peer anunciado pelo servidor)
+    std::string role;           // "host" ou "guest"
+    std::string sessionId;      // ID da sessão
+    std::string resumeSecret;   // REGISTER_ACK → REGISTER da reconexão (retomar a sessão)
+    std::string sdpOffer;       // Para tipo OFFER
+    std::string sdpAnswer;      // Para tipo ANSWER
+    std::string iceCandidate;   // Para tipo ICE_CANDIDATE
+    std::string sdpMLineIndex;  // Para ICE_CANDIDATE
+    std::string sdpMid;         // Para ICE_CANDIDATE
+    std::string errorMessage;   // Para tipo SERVER_ERROR
+};
+
+// Mensagem → JSON (ICE_CANDIDATE sai como "ice-candidate" avulso)
+std::string EncodeSignalingMessage(const SignalingMessage& message);
+
+// Candidatos para o mesmo destinatário → um "ice-candidates". Cabeçalho do primeiro
+std::string EncodeIceCandidateBatch(const SignalingMessage* candidates, size_t count);
+
+// JSON → mensagens (anexa a outMessages; lotes viram várias). false se não é JSON
+// válido ou o tipo é desconhecido
+bool DecodeSignalingMessage(const char* json, size_t size, std::vector<SignalingMessage>& outMessages);
+
+// Escapa texto para uma string JSON (sem as aspas)
+void AppendJsonEscaped(const std::string& text, std::string& out);
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * @file SimulcastEncoder.h
+ * @brief Simulcast: várias camadas (resolução/bitrate) de cada frame capturado
+ *
+ * Um IVideoEncoder por camada, atrás da mesma interface. A camada de cima é a
+ * resolução da captura; as de baixo são reduzidas pelo FrameScaler (box 2:1 em
+ * cascata quando a razão entre camadas vizinhas é 2, bilinear senão) e recebem uma
+ * fração do bitrate. Cada camada é uma cadeia de frames independente, com seus
+ * próprios keyframes: o FanoutSender troca o viewer de camada num keyframe da camada
+ * nova, sem que os viewers rápidos fiquem presos ao bitrate do mais lento.
+ * ```cpp
+ * std::vector<std::unique_ptr<IVideoEncoder>> encoders;   // um por camada
+ * SimulcastEncoder simulcast(std::move(encoders), BuildDefaultSimulcastLayers(3));
+ * simulcast.Initialize(1920, 1080, 8000);   // kbps
+ * simulcast.EncodeLayers(bgra, 1920, 1080, stride, frames, fanout.KeyframeLayerMask(nowUs));
+ * for (const EncodedFrame& frame : frames) fanout.PublishFrame(frame, 0, sequence);
+ * ```
+ */
+
+#include "FrameScaler.h"
+#include "VideoEncoder.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Camada em relação à captura: resolução / scaleDivisor, bitrate * bitrateShare
+struct SimulcastLayerConfig {
+    uint32_t scaleDivisor = 1;
+    double bitrateShare = 1.0;
+};
+
+// 1 a MAX_SIMULCAST_LAYERS camadas, da menor para a maior: ... 1/4 (15%), 1/2 (35%), 1/1 (100%)
+std::vector<SimulcastLayerConfig> BuildDefaultSimulcastLayers(uint32_t layerCount = 3);
+
+/**
+ * @class SimulcastEncoder
+ * @brief IVideoEncoder de N camadas sobre N encoders de uma camada
+ */
+class SimulcastEncoder : public IVideoEncoder {
+public:
+    // encoders[i] codifica a camada i (layers ordenadas da menor para a maior)
+    SimulcastEncoder(std::vector<std::unique_ptr<IVideoEncoder>> encoders,
+                     std::vector<SimulcastLayerConfig> layers);
+
+    // width/height/bitrate da camada de cima; as demais saem das frações
+    bool Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps = 25000) override;
+
+    // Codifica todas as camadas e devolve a de cima (use EncodeLayers para as demais)
+    bool EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                     uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe = false) override;
+
+    uint32_t GetLayerCount() const override { return static_cast<uint32_t>(m_layers.size()); }
+
+    bool EncodeLayers(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                      uint32_t stride, std::vector<EncodedFrame>& outFrames,
+                      uint32_t keyframeLayerMask = 0) override;
+
+    bool EndEncode(std::vector<EncodedFrame>& outFrames) override;
+
+    // Bitrate da camada de cima (kbps); as de baixo seguem as frações (mínimo 50 kbps cada)
+    void SetTargetBitrate(uint32_t kbps) override;
+
+    void SetContentMap(const ContentMap& map) override;
+
+    // Somatório das camadas
+    EncoderStats GetStats() const override;
+
+    void Release() override;
+
+    uint32_t GetLayerWidth(uint32_t layer) const;
+    uint32_t GetLayerHeight(uint32_t layer) const;
+
+private:
+    struct Layer {
+        SimulcastLayerConfig config;
+        std::unique_ptr<IVideoEncoder> encoder;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int32_t scaleFrom = -1;             // Camada de origem do downscale (-1 = captura)
+        FrameScaler scaler;
+        std::vector<uint8_t> pixels;        // Frame reduzido (vazio na camada da captura)
+    };
+
+    std::vector<Layer> m_layers;
+    std::vector<EncodedFrame> m_scratch;
+    bool m_initialized = false;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file SocketCompat.h
+ * @brief Camada fina sobre Winsock / BSD sockets para o código de transporte portável
+ *
+ * Mantém a API no estilo Winsock (SOCKET, INVALID_SOCKET, closesocket,
+ * WSAGetLastError) que P2PManager já usa, mapeando para POSIX fora do Windows.
+ */
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#pragma comment(lib, "ws2_32.lib")
+
+constexpr int SOCKET_SEND_FLAGS = 0;
+
+// Bytes na fila de envio do kernel: o Winsock não expõe isso para UDP (0 = não medido)
+inline size_t SocketSendQueueBytes(SOCKET) {
+    return 0;
+}
+
+inline bool SocketStartup() {
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+}
+
+inline void SocketCleanup() {
+    WSACleanup();
+}
+
+inline bool SetSocketNonBlocking(SOCKET socketHandle) {
+    u_long mode = 1;
+    return ioctlsocket(socketHandle, FIONBIO, &mode) == 0;
+}
+
+// connect() não bloqueante em andamento
+inline bool SocketConnectPending() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/sockios.h>
+#endif
+
+#include "PlatformCompat.h"
+
+using SOCKET = int;
+
+#ifndef INVALID_SOCKET
+#define INVALID_SOCKET (-1)
+#endif
+#ifndef SOCKET_ERROR
+#define SOCKET_ERROR (-1)
+#endif
+#ifndef WSAEWOULDBLOCK
+#define WSAEWOULDBLOCK EWOULDBLOCK
+#endif
+
+// Evita SIGPIPE ao escrever em conexão TCP fechada pelo peer
+#ifdef MSG_NOSIGNAL
+constexpr int SOCKET_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SOCKET_SEND_FLAGS = 0;
+#endif
+
+inline int closesocket(SOCKET socketHandle) {
+    return close(socketHandle);
+}
+
+inline int WSAGetLastError() {
+    return errno;
+}
+
+// Bytes ainda na fila de envio do kernel (SIOCOUTQ no Linux; 0 = não medido)
+inline size_t SocketSendQueueBytes(SOCKET socketHandle) {
+#ifdef SIOCOUTQ
+    int queued = 0;
+    if (ioctl(socketHandle, SIOCOUTQ, &queued) == 0 && queued > 0) {
+        return static_cast<size_t>(queued);
+    }
+#else
+    (void)socketHandle;
+#endif
+    return 0;
+}
+
+inline bool SocketStartup() {
+    return true;
+}
+
+inline void SocketCleanup() {
+}
+
+inline bool SetSocketNonBlocking(SOCKET socketHandle) {
+    int flags = fcntl(socketHandle, F_GETFL, 0);
+    return flags >= 0 && fcntl(socketHandle, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+inline bool SocketConnectPending() {
+    return errno == EINPROGRESS;
+}
+
+#endif
+
+// Desliga o Nagle: mensagens pequenas (sinalização, controle) saem sem esperar ACK
+inline bool SetSocketNoDelay(SOCKET socketHandle) {
+    int enable = 1;
+    return setsockopt(socketHandle, IPPROTO_TCP, TCP_NODELAY,
+                      reinterpret_cast<const char*>(&enable), sizeof(enable)) == 0;
+}
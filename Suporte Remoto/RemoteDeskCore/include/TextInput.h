@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file TextInput.h
+ * @brief Texto UTF-8 → sequência de teclas KEYEVENTF_UNICODE, em blocos para o SendInput
+ *
+ * Parte portável do InputInjector::InjectText: a conversão UTF-8 → UTF-16 e a
+ * divisão em blocos não dependem do Windows. Cada unidade UTF-16 vira um par
+ * down/up; '\n' (ou "\r\n") e '\t' viram VK_RETURN/VK_TAB, que editores tratam
+ * melhor que os caracteres de controle.
+ *
+ * Exemplo:
+ * ```cpp
+ * std::vector<TextKeyStroke> strokes;
+ * BuildTextKeyStrokes(text, std::strlen(text), strokes);
+ * for (size_t begin = 0; begin < strokes.size();) {
+ *     size_t end = NextTextChunkEnd(strokes, begin, TEXT_MAX_CHUNK_STROKES);
+ *     // SendInput de [begin, end)
+ *     begin = end;
+ * }
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Entradas por SendInput: ~1,5 mensagem por entrada fica bem abaixo do limite
+// de 10000 mensagens da fila da thread de destino
+constexpr size_t TEXT_MAX_CHUNK_STROKES = 1000;
+
+struct TextKeyStroke {
+    uint16_t code;          // Unidade UTF-16 ou VK_* (isVirtualKey)
+    bool isVirtualKey;
+    bool keyUp;
+};
+
+// Substituto de sequências UTF-8 inválidas
+constexpr uint16_t TEXT_REPLACEMENT_CHAR = 0xFFFD;
+
+// UTF-8 → UTF-16 (pares surrogate fora do BMP). Sequências inválidas, overlong ou
+// surrogates codificados viram U+FFFD. Retorna quantas foram substituídas
+size_t Utf8ToUtf16(const char* utf8, size_t size, std::vector<uint16_t>& outUtf16);
+
+// UTF-8 → pares down/up (anexa a outStrokes). Retorna sequências inválidas substituídas
+size_t BuildTextKeyStrokes(const char* utf8, size_t size, std::vector<TextKeyStroke>& outStrokes);
+
+// Fim (exclusivo) do bloco que começa em begin com até maxStrokes entradas, sem
+// separar o down do up nem as duas metades de um par surrogate
+size_t NextTextChunkEnd(const std::vector<TextKeyStroke>& strokes, size_t begin, size_t maxStrokes);
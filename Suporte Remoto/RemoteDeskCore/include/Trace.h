@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file Trace.h
+ * @brief Trace points de baixo overhead para o pipeline (captura → encode → rede → render)
+ *
+ * Cada thread grava eventos em um ring buffer próprio (sem locks no hot path).
+ * Os buffers podem ser exportados sob demanda para:
+ * - Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+ * - Perfetto protobuf (ui.perfetto.dev, trace_processor)
+ *
+ * Uso:
+ * ```cpp
+ * bool DXGICapturer::AcquireFrame(FrameData& outFrame) {
+ *     RDC_TRACE_SCOPE("DXGICapturer::AcquireFrame");
+ *     ...
+ * }
+ *
+ * PipelineTracer::SetEnabled(true);
+ * ...
+ * PipelineTracer::WriteChromeJson("stutter.json");
+ * ```
+ *
+ * Com RDC_ENABLE_TRACING=0 as macros desaparecem por completo. Compilado mas
+ * desabilitado em runtime, o custo de cada scope é um load atômico relaxed.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#ifndef RDC_ENABLE_TRACING
+#define RDC_ENABLE_TRACING 1
+#endif
+
+/**
+ * @struct TraceEvent
+ * @brief Evento completo (início + duração) gravado no ring buffer
+ */
+struct TraceEvent {
+    const char* name;           ///< String literal estática (não copiada)
+    uint64_t startNs;           ///< Início (ns desde a origem do tracer)
+    uint64_t durationNs;        ///< Duração em ns
+};
+
+class PipelineTracer {
+public:
+    /// Eventos por thread antes de sobrescrever os mais antigos
+    static constexpr size_t RING_CAPACITY = 16384;
+
+    // Liga/desliga a gravação em runtime
+    static void SetEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Nomeia a thread atual no trace exportado (ex: "Capture", "Render")
+    static void SetThreadName(const char* name);
+
+    // Grava um evento completo no ring buffer da thread atual
+    static void Record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Relógio monotônico usado pelos trace points
+    static uint64_t NowNs();
+
+    // Exporta todos os ring buffers (formato por extensão: .json → Chrome, resto → Perfetto).
+    // Não pausa a gravação: eventos reescritos durante a cópia ficam de fora
+    static bool WriteTrace(const std::string& path);
+    static bool WriteChromeJson(const std::string& path);
+    static bool WritePerfetto(const std::string& path);
+
+    // Descarta os eventos gravados (mantém as threads registradas)
+    static void Clear();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @class ScopedTrace
+ * @brief RAII: grava [construção, destruição) se o tracer estiver habilitado
+ */
+class ScopedTrace {
+public:
+    explicit ScopedTrace(const char* name)
+        : m_name(name),
+          m_active(PipelineTracer::IsEnabled()),
+          m_startNs(m_active ? PipelineTracer::NowNs() : 0) {
+    }
+
+    ~ScopedTrace() {
+        if (m_active) {
+            PipelineTracer::Record(m_name, m_startNs, PipelineTracer::NowNs());
+        }
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    const char* m_name;
+    bool m_active;
+    uint64_t m_startNs;
+};
+
+#define RDC_TRACE_CONCAT_INNER(a, b) a##b
+#define RDC_TRACE_CONCAT(a, b) RDC_TRACE_CONCAT_INNER(a, b)
+
+#if RDC_ENABLE_TRACING
+#define RDC_TRACE_SCOPE(name) ScopedTrace RDC_TRACE_CONCAT(rdcTraceScope_, __LINE__)(name)
+#define RDC_TRACE_THREAD_NAME(name) PipelineTracer::SetThreadName(name)
+#else
+#define RDC_TRACE_SCOPE(name) ((void)0)
+#define RDC_TRACE_THREAD_NAME(name) ((void)0)
+#endif
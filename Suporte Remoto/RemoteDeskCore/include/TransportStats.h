@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file TransportStats.h
+ * @brief Medições do transporte (RTT, perda, taxa, par ICE) comuns a P2PManager e WebRTC
+ *
+ * Cada transporte mede do seu jeito e preenche a mesma struct:
+ * - WebRTCDataChannel: RTT do SCTP, retransmissões dos canais confiáveis, taxa do
+ *   pacer como banda disponível e o tipo do par de candidatos ICE selecionado
+ * - P2PManager (UDP puro): TRANSPORT_PROBE a cada 250 ms; o peer devolve o probe
+ *   com quantos pacotes recebeu, então o RTT e a perda saem da mesma troca (como
+ *   um RTCP receiver report). O receptor também devolve a chegada de cada FRAME
+ *   (FRAME_FEEDBACK), que vira FrameFeedback para o ABR MODEL_BASED
+ *
+ * Contadores são acumulados; perda e taxas valem para a última janela fechada
+ * (sampleCount muda a cada janela). O consumidor (ABR, métricas) lê a última
+ * amostra e não precisa saber qual transporte está embaixo.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+// Tipo do candidato ICE (RFC 8445): relay = TURN, custo e atraso extras
+enum class CandidatePairType : uint8_t {
+    NONE = 0,           // Sem ICE (UDP direto) ou ainda não selecionado
+    HOST = 1,
+    SERVER_REFLEXIVE = 2,
+    PEER_REFLEXIVE = 3,
+    RELAY = 4
+};
+
+constexpr size_t CANDIDATE_PAIR_TYPE_COUNT = 5;
+
+// "none", "host", "srflx", "prflx", "relay" (nomes do SDP)
+const char* CandidatePairTypeName(CandidatePairType type);
+
+struct TransportStats {
+    double rttMs = 0.0;                         // RTT suavizado (0 = ainda sem amostra)
+    double packetLossPercent = 0.0;             // Na última janela
+    double sendBitrateKbps = 0.0;               // Taxa de envio medida na última janela
+    double availableOutgoingBitrateKbps = 0.0;  // Estimativa do transporte (0 = desconhecida)
+    uint64_t packetsSent = 0;
+    uint64_t packetsLost = 0;                   // Estimados (peer) ou retransmitidos (SCTP)
+    uint64_t retransmissions = 0;
+    uint64_t bytesSent = 0;
+    CandidatePairType candidatePairType = CandidatePairType::NONE;
+    uint64_t sampleCount = 0;                   // Janelas fechadas até agora
+};
+
+// Payload de TRANSPORT_PROBE (ida) e TRANSPORT_PROBE_REPLY (volta, campos ecoados)
+struct TransportProbeMessage {
+    uint32_t sequence;
+    uint32_t reserved;
+    uint64_t sendTimeUs;        // Relógio de quem enviou o probe (ecoado)
+    uint64_t packetsSent;       // Pacotes enviados por quem enviou o probe, incluindo ele (ecoado)
+    uint64_t packetsReceived;   // Resposta: pacotes recebidos pelo peer até o probe
+};
+
+static_assert(sizeof(TransportProbeMessage) == 32, "TransportProbeMessage must be 32 bytes");
+
+// Payload de FRAME_FEEDBACK: uma entrada por FRAME recebido, até FRAME_FEEDBACK_MAX_ENTRIES
+struct FrameArrivalEntry {
+    uint16_t frameSequence;
+    uint16_t reserved;
+    uint32_t bytes;             // Datagrama inteiro (header + payload)
+    uint64_t arrivalTimeUs;     // Relógio do receptor
+};
+
+static_assert(sizeof(FrameArrivalEntry) == 16, "FrameArrivalEntry must be 16 bytes");
+
+constexpr size_t FRAME_FEEDBACK_MAX_ENTRIES = 64;
+
+// Frame confirmado pelo peer (AdaptiveBitRateController::OnPacketFeedback). Os relógios
+// de envio e chegada são de máquinas diferentes: só as diferenças entre frames contam
+struct FrameFeedback {
+    double sendTimeMs = 0.0;
+    double arrivalTimeMs = 0.0;
+    size_t bytes = 0;
+};
+
+/**
+ * @class TransportRateWindow
+ * @brief Fecha janelas de duração fixa sobre contadores acumulados (perda e taxa)
+ */
+class TransportRateWindow {
+public:
+    explicit TransportRateWindow(uint64_t windowMs = 500) : m_windowMs(windowMs) {}
+
+    // true quando a janela fechou: outLossPercent = perdidos / enviados e
+    // outBitrateKbps = bytes no intervalo. Antes da primeira chamada só marca a base
+    bool Sample(uint64_t nowMs, uint64_t packetsSent, uint64_t packetsLost, uint64_t bytesSent,
+                double& outLossPercent, double& outBitrateKbps);
+
+    void Reset() { m_hasBase = false; }
+
+private:
+    uint64_t m_windowMs;
+    bool m_hasBase = false;
+    uint64_t m_baseMs = 0;
+    uint64_t m_basePacketsSent = 0;
+    uint64_t m_basePacketsLost = 0;
+    uint64_t m_baseBytesSent = 0;
+};
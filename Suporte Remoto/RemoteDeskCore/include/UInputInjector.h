@@ -0,0 +1,208 @@
+#pragma once
+
+/**
+ * @file UInputInjector.h
+ * @brief Backend de input Linux: devices virtuais via /dev/uinput
+ *
+ * Dois devices virtuais: um ponteiro absoluto (ABS_X/ABS_Y em 0..65535, a mesma
+ * escala do protocolo de input, sem reescala) e um teclado. Cada lote do protocolo
+ * vira arrays de input_event escritos com um write() por device, terminando em um
+ * SYN_REPORT. Dentro do lote, um SYN_REPORT intermediário só é inserido quando o
+ * próximo evento repetiria um código já presente no quadro atual (ex: dois
+ * movimentos, ou down/up da mesma tecla), que o kernel/libinput fundiriam.
+ *
+ * A tradução (UInputTranslator) e o mapeamento VK_* → KEY_* são portáveis e
+ * escrevem em IUInputDevice, então rodam sem root contra MockUInputDevice. Só
+ * UInputDevice fala com o kernel (Linux; nas outras plataformas Open falha).
+ *
+ * Exemplo:
+ * ```cpp
+ * auto pointer = std::make_unique<MockUInputDevice>();
+ * auto keyboard = std::make_unique<MockUInputDevice>();
+ * MockUInputDevice* keys = keyboard.get();
+ * UInputInjector injector(std::move(pointer), std::move(keyboard));
+ * injector.Initialize();
+ * injector.InjectEvents(batch.events.data(), batch.events.size());
+ * // keys->writes: um vetor de UInputEvent por write()
+ * ```
+ */
+
+#include "InputInjection.h"
+#include "TextInput.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Subconjunto de linux/input-event-codes.h usado pelo backend (ABI estável do kernel)
+constexpr uint16_t EVDEV_EV_SYN = 0x00;
+constexpr uint16_t EVDEV_EV_KEY = 0x01;
+constexpr uint16_t EVDEV_EV_REL = 0x02;
+constexpr uint16_t EVDEV_EV_ABS = 0x03;
+
+constexpr uint16_t EVDEV_SYN_REPORT = 0;
+constexpr uint16_t EVDEV_ABS_X = 0x00;
+constexpr uint16_t EVDEV_ABS_Y = 0x01;
+constexpr uint16_t EVDEV_REL_WHEEL = 0x08;
+constexpr uint16_t EVDEV_REL_WHEEL_HI_RES = 0x0B;
+
+constexpr uint16_t EVDEV_KEY_LEFTSHIFT = 42;
+constexpr uint16_t EVDEV_BTN_LEFT = 0x110;
+constexpr uint16_t EVDEV_BTN_RIGHT = 0x111;
+constexpr uint16_t EVDEV_BTN_MIDDLE = 0x112;
+constexpr uint16_t EVDEV_BTN_SIDE = 0x113;
+constexpr uint16_t EVDEV_BTN_EXTRA = 0x114;
+
+// input_event sem o timestamp (o kernel preenche no write)
+struct UInputEvent {
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+};
+
+enum class UInputDeviceKind : uint8_t {
+    POINTER = 0,
+    KEYBOARD = 1
+};
+
+// Capacidades declaradas na criação do device
+struct UInputDeviceConfig {
+    UInputDeviceKind kind = UInputDeviceKind::POINTER;
+    const char* name = "RemoteDeskCore";
+    std::vector<uint16_t> keys;         // EV_KEY (teclas ou botões)
+    std::vector<uint16_t> relAxes;      // EV_REL
+    std::vector<uint16_t> absAxes;      // EV_ABS, faixa 0..INPUT_COORD_MAX
+};
+
+class IUInputDevice {
+public:
+    virtual ~IUInputDevice() = default;
+
+    virtual bool Open(const UInputDeviceConfig& config) = 0;
+
+    // Escreve o array inteiro de uma vez (o chamador garante o SYN_REPORT final)
+    virtual bool Write(const UInputEvent* events, size_t count) = 0;
+
+    virtual void Close() = 0;
+};
+
+/**
+ * @class UInputDevice
+ * @brief Device real em /dev/uinput (requer acesso de escrita ao nó, ex: grupo input)
+ */
+class UInputDevice : public IUInputDevice {
+public:
+    UInputDevice() = default;
+    ~UInputDevice() override;
+
+    bool Open(const UInputDeviceConfig& config) override;
+    bool Write(const UInputEvent* events, size_t count) override;
+    void Close() override;
+
+private:
+    int m_fd = -1;
+    std::vector<uint8_t> m_writeBuffer;   // Array de struct input_event reusado
+};
+
+/**
+ * @class MockUInputDevice
+ * @brief Device em memória: guarda a configuração e cada write() para inspeção
+ */
+class MockUInputDevice : public IUInputDevice {
+public:
+    bool Open(const UInputDeviceConfig& config) override {
+        this->config = config;
+        opened = true;
+        return true;
+    }
+
+    bool Write(const UInputEvent* events, size_t count) override {
+        if (!opened) {
+            return false;
+        }
+        writes.emplace_back(events, events + count);
+        return true;
+    }
+
+    void Close() override { opened = false; }
+
+    UInputDeviceConfig config;
+    std::vector<std::vector<UInputEvent>> writes;
+    bool opened = false;
+};
+
+// VK_* do Windows (código do protocolo de input) → KEY_* do evdev. 0 = sem mapeamento
+uint16_t VirtualKeyToEvdev(uint16_t virtualKey);
+
+// Caractere ASCII imprimível → tecla do layout US (+ Shift). false = sem tecla
+bool AsciiToEvdev(uint16_t character, uint16_t& outKey, bool& outShift);
+
+// Teclas declaradas no device de teclado (todas as alcançáveis por VirtualKeyToEvdev)
+std::vector<uint16_t> GetMappedEvdevKeys();
+
+/**
+ * @class UInputTranslator
+ * @brief InputEvent → writes por device, com SYN_REPORT só onde o quadro exige
+ */
+class UInputTranslator {
+public:
+    struct DeviceWrite {
+        UInputDeviceKind device;
+        std::vector<UInputEvent> events;    // Termina em SYN_REPORT
+    };
+
+    // Traduz o lote inteiro. Writes consecutivos do mesmo device são um só;
+    // a troca de device inicia outro (preserva a ordem entre mouse e teclado).
+    // Retorna quantos eventos foram traduzidos (teclas sem mapeamento ficam de fora)
+    uint32_t Translate(const InputEvent* events, size_t count, std::vector<DeviceWrite>& outWrites);
+
+    // Bloco de texto → toques de tecla no device de teclado (layout US; caracteres
+    // fora de ASCII não têm tecla e são contados em outSkipped)
+    void TranslateText(const TextKeyStroke* strokes, size_t count, std::vector<DeviceWrite>& outWrites,
+                       size_t& outSkipped);
+
+private:
+    std::vector<UInputEvent>& Frame(UInputDeviceKind device, std::vector<DeviceWrite>& outWrites);
+    void Emit(std::vector<UInputEvent>& frame, uint16_t type, uint16_t code, int32_t value);
+    void EndFrames(std::vector<DeviceWrite>& outWrites);
+
+    // Códigos (type << 16 | code) já presentes no quadro aberto
+    std::vector<uint32_t> m_frameCodes;
+    // Resto da roda em unidades de 1/120 ainda sem clique inteiro
+    int32_t m_wheelRemainder = 0;
+};
+
+/**
+ * @class UInputInjector
+ * @brief IInputInjector sobre dois devices uinput (ponteiro absoluto + teclado)
+ */
+class UInputInjector : public IInputInjector {
+public:
+    // Devices reais em /dev/uinput
+    UInputInjector();
+
+    // Devices injetados (ex: MockUInputDevice)
+    UInputInjector(std::unique_ptr<IUInputDevice> pointer, std::unique_ptr<IUInputDevice> keyboard);
+
+    ~UInputInjector() override;
+
+    bool Initialize() override;
+    uint32_t InjectEvents(const InputEvent* events, size_t count) override;
+    // Só layout US: com qualquer caractere sem tecla, nada é injetado e retorna false
+    bool InjectText(const char* text) override;
+    void Release() override;
+
+private:
+    bool WriteAll(const std::vector<UInputTranslator::DeviceWrite>& writes);
+
+    std::unique_ptr<IUInputDevice> m_pointer;
+    std::unique_ptr<IUInputDevice> m_keyboard;
+    UInputTranslator m_translator;
+
+    // Buffers reusados entre lotes
+    std::vector<UInputTranslator::DeviceWrite> m_writes;
+    std::vector<TextKeyStroke> m_textStrokes;
+
+    bool m_initialized = false;
+};
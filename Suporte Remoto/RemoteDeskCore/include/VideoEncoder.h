@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file VideoEncoder.h
+ * @brief Interface de encoder de vídeo implementada pelos adapters de plataforma
+ *
+ * RemoteDesktopSystem conversa apenas com IVideoEncoder; NVENCEncoder (Windows)
+ * é um adapter fora do rdc_core. SimulcastEncoder (SimulcastEncoder.h) junta um
+ * encoder por camada atrás da mesma interface.
+ */
+
+#include "FrameTypes.h"
+#include "ContentClassifier.h"
+
+#include <cstdint>
+#include <vector>
+
+class IVideoEncoder {
+public:
+    // Estatísticas
+    struct EncoderStats {
+        uint64_t totalFramesEncoded = 0;
+        uint64_t totalBytesEncoded = 0;
+        uint32_t keyframeInterval = 60;
+        double averageBitrate = 0.0;
+    };
+
+    virtual ~IVideoEncoder() = default;
+
+    // Inicializa o encoder (bitrate alvo em kbps)
+    virtual bool Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps = 25000) = 0;
+
+    // Codifica um frame BGRA
+    virtual bool EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                             uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe = false) = 0;
+
+    // Simulcast: quantas camadas EncodeLayers produz por frame (1 = só EncodeFrame)
+    virtual uint32_t GetLayerCount() const { return 1; }
+
+    // Codifica todas as camadas do frame, da menor (layerId 0) para a maior.
+    // keyframeLayerMask: bit i = forçar keyframe na camada i
+    virtual bool EncodeLayers(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                              uint32_t stride, std::vector<EncodedFrame>& outFrames,
+                              uint32_t keyframeLayerMask = 0) {
+        outFrames.resize(1);
+        if (!EncodeFrame(bgraPixels, width, height, stride, outFrames[0], (keyframeLayerMask & 1) != 0)) {
+            return false;
+        }
+        outFrames[0].layerId = 0;
+        return true;
+    }
+
+    // Finaliza a codificação (obtém frames restantes)
+    virtual bool EndEncode(std::vector<EncodedFrame>& outFrames) = 0;
+
+    // Em kbps: o alvo do ABR (passos de 50 kbps) chega sem arredondar
+    virtual void SetTargetBitrate(uint32_t kbps) = 0;
+
+    // Qualidade por região para os próximos frames (encoders sem QP map ignoram)
+    virtual void SetContentMap(const ContentMap& map) { (void)map; }
+
+    virtual EncoderStats GetStats() const = 0;
+
+    // Libera recursos
+    virtual void Release() = 0;
+};
@@ -10,6 +10,10 @@
  * - ICE candidates (STUN/TURN)
  * - Transmissão P2P de frames com NAT traversal automático
  * - Fallback para TURN se NAT bloqueado
+ * - Um data channel por tipo de tráfego (DataChannelKind): vídeo não ordenado e sem
+ *   retransmissão, input ordenado e confiável, cursor/controle não ordenado com tempo
+ *   de vida (ver DataChannelMux.h). Um pacote perdido de vídeo não segura os frames
+ *   seguintes nem o input
  *
  * Arquitetura:
  * ┌─────────────────┐      Signaling Server      ┌─────────────────┐
@@ -23,11 +27,16 @@
  * @date 2025-12-09
  */
 
+#include "DataChannelMux.h"
+#include "DatagramChannel.h"
+#include "TransportStats.h"
+
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <cstdint>
+#include <span>
 
 // Forward declarations (evitar circular dependencies)
 class WebSocketSignalingClient;
@@ -61,13 +70,14 @@ struct DataChannelMessage {
  * @brief Estatísticas da conexão WebRTC
  */
 struct WebRTCStats {
-    bool connected;             ///< true se conectado
-    uint64_t bytesSent;        ///< Bytes enviados
-    uint64_t bytesReceived;    ///< Bytes recebidos
-    double currentRoundTripTime; ///< RTT em ms
+    bool connected = false;             ///< true se conectado
+    uint64_t bytesSent = 0;             ///< Bytes enviados
+    uint64_t bytesReceived = 0;         ///< Bytes recebidos
+    double currentRoundTripTime = 0.0;  ///< RTT do SCTP em ms (0 = sem amostra)
     std::string currentConnectionState; ///< Estado (connected, disconnected, etc)
-    int candidatesSent;        ///< Número de ICE candidates enviados
-    int candidatesReceived;    ///< Número de ICE candidates recebidos
+    int candidatesSent = 0;             ///< Número de ICE candidates enviados
+    int candidatesReceived = 0;         ///< Número de ICE candidates recebidos
+    TransportStats transport;           ///< RTT, perda, retransmissões, banda, par ICE
 };
 
 /**
@@ -84,8 +94,8 @@ struct WebRTCStats {
  */
 class WebRTCDataChannel {
 public:
-    /// Tipo de callback para dados recebidos
-    using DataReceivedCallback = std::function<void(const uint8_t*, size_t)>;
+    /// Tipo de callback para dados recebidos (canal de origem, mensagem)
+    using DataReceivedCallback = std::function<void(DataChannelKind, const uint8_t*, size_t)>;
     
     /// Tipo de callback para mudanças de estado
     using StateChangedCallback = std::function<void(const std::string&)>;
@@ -93,6 +103,9 @@ public:
     /// Tipo de callback para ICE candidates
     using IceCandidateCallback = std::function<void(const ICECandidate&)>;
 
+    /// Tipo de callback de watermark do bufferedAmount (canal, bytes no buffer)
+    using BufferedAmountCallback = DataChannelMux::BufferedAmountCallback;
+
     /**
      * @brief Construtor
      * @param isInitiator true se este peer criará a oferta (host), false se responder (guest)
@@ -122,6 +135,29 @@ public:
     bool Initialize(const std::vector<std::string>& stunServers,
                     const std::vector<std::string>& turnServers = {});
 
+    /**
+     * @brief Conecta direto a um transporte de datagramas, sem SDP/ICE (loopback em processo)
+     * @param channel Endpoint do outro peer (ex: EmulatedLink::CreateEndpoint)
+     * @return true se conectado
+     *
+     * Os canais seguem o mesmo modelo de confiabilidade da conexão real (DataChannelMux),
+     * então dá para medir perda/latência por canal com EmulatedLink:
+     * ```cpp
+     * auto link = std::make_shared<EmulatedLink>(profile, 42, false);
+     * WebRTCDataChannel host(true), guest(false);
+     * host.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::A));
+     * guest.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::B));
+     * ```
+     */
+    bool InitializeWithChannel(std::shared_ptr<IDatagramChannel> channel);
+
+    /**
+     * @brief Troca a confiabilidade de um canal (antes de criar a oferta / conectar)
+     * @param kind Canal
+     * @param reliability Ordem, maxRetransmits e maxPacketLifeTime
+     */
+    void ConfigureChannel(DataChannelKind kind, const DataChannelReliability& reliability);
+
     /**
      * @brief Cria uma oferta SDP (para o initiator/host)
      * @param[out] sdpOffer String contendo a oferta SDP completa
@@ -158,13 +194,76 @@ public:
     bool AddIceCandidate(const ICECandidate& candidate);
 
     /**
-     * @brief Envia dados pelo data channel
+     * @brief Envia uma mensagem pelo data channel do tipo indicado
+     * @param channel VIDEO, INPUT ou CONTROL
      * @param data Ponteiro para dados
      * @param size Tamanho em bytes
      * @return true se enviado com sucesso (dados ficarão em buffer se necessário)
      */
+    bool SendData(DataChannelKind channel, const uint8_t* data, size_t size);
+
+    /**
+     * @brief Envia uma mensagem sem cópia intermediária
+     * @param channel VIDEO, INPUT ou CONTROL
+     * @param data Bytes da mensagem (copiados só se precisarem esperar no buffer)
+     * @return true se enviado ou enfileirado
+     */
+    bool SendData(DataChannelKind channel, std::span<const uint8_t> data);
+
+    /**
+     * @brief Envia um buffer compartilhado (fila e retransmissões referenciam, sem cópia)
+     * @param channel VIDEO, INPUT ou CONTROL
+     * @param buffer Mensagem; não deve ser alterada depois do envio
+     * @return true se enviado ou enfileirado
+     */
+    bool SendData(DataChannelKind channel, std::shared_ptr<const std::vector<uint8_t>> buffer);
+
+    /**
+     * @brief Envia pelo canal de vídeo (SendData(DataChannelKind::VIDEO, ...))
+     */
     bool SendData(const uint8_t* data, size_t size);
 
+    /**
+     * @brief Bytes aceitos por SendData e ainda não entregues à rede (ou sem ACK)
+     * @param channel Canal
+     * @return bufferedAmount do canal
+     */
+    size_t GetBufferedAmount(DataChannelKind channel) const;
+
+    /**
+     * @brief Define os watermarks do bufferedAmount de um canal
+     * @param channel Canal
+     * @param lowBytes onBufferedAmountLow dispara ao descer até este valor
+     * @param highBytes onBufferedAmountHigh dispara ao passar deste valor (0 = desligado)
+     *
+     * Uso típico no vídeo: acima do alto, pular frames (IsAboveHighWatermark) até o
+     * callback de baixo, e repassar GetBufferedAmount ao ABR (UpdateSendBuffer).
+     */
+    void SetBufferedAmountThresholds(DataChannelKind channel, size_t lowBytes, size_t highBytes);
+
+    /**
+     * @brief Conecta os callbacks de watermark (chamados dentro de SendData/ProcessMessages)
+     */
+    void SetBufferedAmountCallbacks(BufferedAmountCallback onLow, BufferedAmountCallback onHigh);
+
+    /**
+     * @brief true se o canal está acima do watermark alto (o chamador deve pular o frame)
+     */
+    bool IsAboveHighWatermark(DataChannelKind channel) const;
+
+    /**
+     * @brief Descarta mensagens do canal que ainda não começaram a sair (ex: frames velhos)
+     * @return Quantas mensagens foram descartadas
+     */
+    size_t DropPendingMessages(DataChannelKind channel);
+
+    /**
+     * @brief Limita a taxa de envio do loopback em kbps (0 = sem limite)
+     *
+     * Na conexão real o controle de congestionamento do SCTP faz esse papel.
+     */
+    void SetSendRateKbps(double kbps);
+
     /**
      * @brief Conecta callbacks de evento
      * @param onDataReceived Chamado quando dados chegam
@@ -175,6 +274,12 @@ public:
                       StateChangedCallback onStateChanged,
                       IceCandidateCallback onIceCandidate);
 
+    /**
+     * @brief Troca só o callback de dados (mantém estado e ICE)
+     * @param onDataReceived Chamado quando dados chegam
+     */
+    void SetDataReceivedCallback(DataReceivedCallback onDataReceived);
+
     /**
      * @brief Processa mensagens pendentes (polls para non-blocking)
      * Deve ser chamado periodicamente na main loop
@@ -187,6 +292,15 @@ public:
      */
     WebRTCStats GetStats() const;
 
+    /**
+     * @brief Última amostra do transporte (janela de 500 ms fechada em ProcessMessages)
+     *
+     * RTT do SCTP, retransmissões (perda = retransmitidos / enviados na janela; canais
+     * sem retransmissão não entram), taxa do pacer como banda disponível e o tipo do
+     * par de candidatos selecionado. Para AdaptiveBitRateController::UpdateTransportStats
+     */
+    TransportStats GetTransportStats() const;
+
     /**
      * @brief Verifica se está conectado
      * @return true se data channel está aberto e pronto para comunicação
@@ -212,3 +326,33 @@ private:
     bool m_isInitiator;
     bool m_initialized;
 };
+
+/**
+ * @class WebRTCDatagramChannel
+ * @brief IDatagramChannel sobre um data channel: P2PManager roda igual sobre WebRTC
+ *
+ * Cada datagrama vira uma mensagem do canal escolhido (padrão VIDEO: não ordenado e
+ * sem retransmissão, a mesma semântica do UDP que o P2PManager espera). Send falha
+ * enquanto o data channel não abriu. Os dados chegam pelo callback do canal (thread
+ * do libdatachannel), então a fila interna é protegida por mutex.
+ */
+class WebRTCDatagramChannel : public IDatagramChannel {
+public:
+    explicit WebRTCDatagramChannel(std::shared_ptr<WebRTCDataChannel> channel,
+                                   DataChannelKind kind = DataChannelKind::VIDEO);
+    ~WebRTCDatagramChannel() override;
+
+    bool Send(const uint8_t* data, size_t size) override;
+    bool Receive(std::vector<uint8_t>& outDatagram) override;
+    bool WaitReadable(int timeoutMs) override;
+    size_t GetBufferedAmount() const override { return m_channel->GetBufferedAmount(m_kind); }
+
+    WebRTCDataChannel& GetDataChannel() { return *m_channel; }
+
+private:
+    struct Inbox;
+
+    std::shared_ptr<WebRTCDataChannel> m_channel;
+    DataChannelKind m_kind;
+    std::shared_ptr<Inbox> m_inbox;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @file WebSocketFrame.h
+ * @brief Framing RFC 6455 do lado cliente: handshake HTTP/1.1, frames mascarados e parser incremental
+ *
+ * Só o necessário para o WebSocketSignalingClient falar com o signaling-server.js
+ * (pacote ws) sem dependências: ws:// (sem TLS), sem extensões (permessage-deflate
+ * não é negociado), mensagens de até WEBSOCKET_MAX_MESSAGE_SIZE.
+ *
+ * Exemplo:
+ * ```cpp
+ * std::vector<uint8_t> out;
+ * EncodeWebSocketFrame(WebSocketOpcode::TEXT, data, size, maskKey, out);   // anexa a out
+ *
+ * WebSocketFrameParser parser;
+ * parser.Feed(received, receivedSize);
+ * while (parser.Next(opcode, payload)) { ... }
+ * if (parser.HasError()) { // fechar a conexão }
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class WebSocketOpcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA
+};
+
+// Maior mensagem aceita (SDP com muitos candidatos fica abaixo de 64 KB)
+constexpr size_t WEBSOCKET_MAX_MESSAGE_SIZE = 1 << 20;
+
+// Cabeçalho máximo de um frame do cliente: 2 + 8 (tamanho) + 4 (máscara)
+constexpr size_t WEBSOCKET_MAX_HEADER_SIZE = 14;
+
+struct WebSocketUrl {
+    std::string host;
+    uint16_t port = 80;
+    std::string path = "/";
+    bool secure = false;        // wss:// (não suportado pelo cliente sem TLS)
+};
+
+// "ws://host[:port][/path]" ou "wss://..."; false se malformada
+bool ParseWebSocketUrl(const std::string& url, WebSocketUrl& outUrl);
+
+// Sec-WebSocket-Key a partir de 16 bytes aleatórios
+std::string MakeWebSocketKey(const uint8_t nonce[16]);
+
+// Requisição de upgrade HTTP/1.1
+std::string BuildWebSocketHandshake(const WebSocketUrl& url, const std::string& key);
+
+// base64(SHA-1(key + GUID)), o valor esperado em Sec-WebSocket-Accept
+std::string ComputeWebSocketAccept(const std::string& key);
+
+// Resposta do servidor (até o "\r\n\r\n"): status 101 e Sec-WebSocket-Accept corretos
+bool ValidateWebSocketHandshake(const std::string& response, const std::string& key);
+
+// Frame único (FIN) do cliente, sempre mascarado (RFC 6455 §5.3). Anexa a outFrame
+void EncodeWebSocketFrame(WebSocketOpcode opcode, const uint8_t* payload, size_t size,
+                          uint32_t maskKey, std::vector<uint8_t>& outFrame);
+
+/**
+ * @class WebSocketFrameParser
+ * @brief Reúne frames recebidos em mensagens; controles intercalados saem na ordem
+ */
+class WebSocketFrameParser {
+public:
+    // Acrescenta bytes recebidos do socket
+    void Feed(const uint8_t* data, size_t size);
+
+    // Próxima mensagem completa (TEXT/BINARY com fragmentos reunidos, ou controle).
+    // false = faltam bytes ou houve erro de protocolo (ver HasError)
+    bool Next(WebSocketOpcode& outOpcode, std::vector<uint8_t>& outPayload);
+
+    bool HasError() const { return m_error; }
+
+    void Reset();
+
+private:
+    std::vector<uint8_t> m_buffer;
+    size_t m_offset = 0;                    // Início do próximo frame em m_buffer
+    std::vector<uint8_t> m_message;         // Fragmentos acumulados
+    WebSocketOpcode m_messageOpcode = WebSocketOpcode::TEXT;
+    bool m_inMessage = false;
+    bool m_error = false;
+};
@@ -5,15 +5,20 @@
  * @brief Cliente WebSocket para comunicação de sinalização com servidor remoto
  *
  * Implementação de um cliente WebSocket que:
- * - Conecta a servidor de sinalização remoto
+ * - Conecta a servidor de sinalização remoto (RFC 6455 sobre TCP, ws://)
  * - Registra o peer (host/guest)
  * - Troca SDP offers/answers
- * - Troca ICE candidates
- * - Gerencia reconexão automática
+ * - Troca ICE candidates (em lote, uma mensagem por tick)
+ * - Gerencia reconexão automática (backoff exponencial, re-registro na mesma sessão)
  *
- * Protocolo de Sinalização (JSON):
+ * Uma thread de IO faz conexão, handshake, leitura e escrita. Os Send* só
+ * enfileiram (não bloqueiam a main loop); as mensagens recebidas esperam na fila
+ * até ProcessMessages(). Enquanto a conexão cai, a fila de envio é preservada e
+ * sai depois do re-registro.
+ *
+ * Protocolo de Sinalização (JSON, ver SignalingCodec.h):
  * {
- *   "type": "register" | "offer" | "answer" | "ice-candidate" | "ping",
+ *   "type": "register" | "offer" | "answer" | "ice-candidate" | "ice-candidates" | "ping",
  *   "peerId": "unique-peer-id",
  *   "role": "host" | "guest",
  *   "sessionId": "session-id",
@@ -24,6 +29,9 @@
  * @date 2025-12-09
  */
 
+#include "SignalingCodec.h"
+
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -32,52 +40,39 @@
 #include <thread>
 #include <mutex>
 
-/**
- * @struct SignalingMessage
- * @brief Mensagem de sinalização
- */
-struct SignalingMessage {
-    enum Type {
-        REGISTER,           // Registra novo peer
-        OFFER,              // Oferta SDP
-        ANSWER,             // Resposta SDP
-        ICE_CANDIDATE,      // Candidato ICE
-        PING,               // Keep-alive
-        PONG,               // Keep-alive response
-        ERROR               // Erro
-    };
-
-    Type type;
-    std::string peerId;         // ID único do peer
-    std::string role;           // "host" ou "guest"
-    std::string sessionId;      // ID da sessão
-    std::string sdpOffer;       // Para tipo OFFER
-    std::string sdpAnswer;      // Para tipo ANSWER
-    std::string iceCandidate;   // Para tipo ICE_CANDIDATE
-    std::string sdpMLineIndex;  // Para ICE_CANDIDATE
-    std::string sdpMid;         // Para ICE_CANDIDATE
-    std::string errorMessage;   // Para tipo ERROR
-};
-
 /**
  * @class WebSocketSignalingClient
  * @brief Cliente de sinalização WebSocket para NAT traversal
  *
- * Fluxo de Conexão:
- * 1. Connect() ao servidor de sinalização
- * 2. SendRegister() para se registrar (host gera sessionId)
- * 3. Host cria offer SDP → SendOffer()
- * 4. Guest recebe offer → CreateAnswer() em WebRTCDataChannel
- * 5. Guest envia answer → SendAnswer()
- * 6. Ambos coletam ICE candidates → SendIceCandidate()
- * 7. WebRTC P2P conecta
- * 8. Dados fluem direto P2P (sinalização não é mais usada)
+ * Fluxo de Conexão (SessionConnector.h faz isso em paralelo):
+ * 1. Connect() + SendRegister() (servidor devolve o sessionId ao host); o host já
+ *    cria a offer SDP, o que inicia a coleta de candidatos
+ * 2. Peer remoto conhecido (register-ack no guest, guest-connected no host) →
+ *    host envia a offer → SendOffer()
+ * 3. Guest recebe offer → CreateAnswer() em WebRTCDataChannel → SendAnswer()
+ * 4. Cada ICE candidate sai assim que é coletado → SendIceCandidate() (trickle),
+ *    junto com os candidatos do caminho UDP direto
+ * 5. O primeiro caminho que conectar vence (LAN UDP ou WebRTC)
+ * 6. Dados fluem direto P2P (sinalização não é mais usada)
  */
 class WebSocketSignalingClient {
 public:
     /// Callback para mensagens recebidas
     using MessageReceivedCallback = std::function<void(const SignalingMessage&)>;
 
+    struct SignalingStats {
+        uint64_t connectAttempts = 0;
+        uint64_t reconnects = 0;            // Conexões bem-sucedidas depois da primeira
+        uint64_t messagesSent = 0;          // Mensagens WebSocket (um lote ICE conta 1)
+        uint64_t messagesReceived = 0;
+        uint64_t iceCandidatesSent = 0;
+        uint64_t iceBatchesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+        double lastConnectMs = 0.0;         // TCP + upgrade HTTP
+        double lastRegisterMs = 0.0;        // Início da conexão → register-ack
+    };
+
     /**
      * @brief Construtor
      * @param signalingServerUrl URL do servidor de sinalização (ex: "ws://example.com:8080")
@@ -90,8 +85,8 @@ public:
     ~WebSocketSignalingClient();
 
     /**
-     * @brief Conecta ao servidor de sinalização
-     * @return true se conectado com sucesso
+     * @brief Inicia a thread de IO, que conecta e reconecta ao servidor
+     * @return false se a URL é inválida ou usa wss:// (TLS não suportado)
      *
      * A conexão é feita de forma assíncrona em thread separada.
      * Use IsConnected() para verificar quando está pronto.
@@ -100,16 +95,16 @@ public:
 
     /**
      * @brief Verifica se está conectado ao servidor
-     * @return true se conectado e pronto para enviar mensagens
+     * @return true se o handshake WebSocket terminou e a conexão está aberta
      */
     bool IsConnected() const;
 
     /**
-     * @brief Registra este peer no servidor (primeira mensagem)
+     * @brief Registra este peer no servidor (primeira mensagem, repetida a cada reconexão)
      * @param peerId ID único deste peer (ex: UUID)
      * @param role "host" ou "guest"
      * @param sessionId Para guest: ID da sessão do host. Para host: deixar vazio
-     * @return true se enviado com sucesso
+     * @return true se enfileirado
      */
     bool SendRegister(const std::string& peerId,
                       const std::string& role,
@@ -119,7 +114,7 @@ public:
      * @brief Envia uma oferta SDP ao peer remoto
      * @param peerId ID do peer remoto
      * @param sdpOffer String SDP completa
-     * @return true se enviado com sucesso
+     * @return true se enfileirado
      */
     bool SendOffer(const std::string& peerId, const std::string& sdpOffer);
 
@@ -127,7 +122,7 @@ public:
      * @brief Envia uma resposta SDP ao peer remoto
      * @param peerId ID do peer remoto
      * @param sdpAnswer String SDP completa
-     * @return true se enviado com sucesso
+     * @return true se enfileirado
      */
     bool SendAnswer(const std::string& peerId, const std::string& sdpAnswer);
 
@@ -137,7 +132,7 @@ public:
      * @param candidate String do candidato
      * @param sdpMLineIndex Índice da mídia
      * @param sdpMid ID da mídia
-     * @return true se enviado com sucesso
+     * @return true se enfileirado (sai no próximo tick, junto com os demais)
      */
     bool SendIceCandidate(const std::string& peerId,
                           const std::string& candidate,
@@ -146,7 +141,7 @@ public:
 
     /**
      * @brief Define callback para mensagens recebidas
-     * @param callback Função chamada quando mensagem chegar
+     * @param callback Função chamada (na thread de ProcessMessages) quando mensagem chegar
      */
     void SetMessageReceivedCallback(MessageReceivedCallback callback);
 
@@ -157,22 +152,27 @@ public:
     void ProcessMessages();
 
     /**
-     * @brief Desconecta do servidor de sinalização
+     * @brief Desconecta do servidor de sinalização (close frame) e encerra a thread de IO
      */
     void Disconnect();
 
     /**
-     * @brief Obtém sessão ID (preenchido após SendRegister como host)
+     * @brief Obtém sessão ID (preenchido pelo register-ack do servidor)
      * @return ID da sessão
      */
     std::string GetSessionId() const;
 
     /**
-     * @brief Obtém ID do peer remoto (preenchido após receber register)
+     * @brief Obtém ID do peer remoto (host no register-ack do guest, guest no guest-connected)
      * @return ID do peer remoto
      */
     std::string GetRemotePeerId() const;
 
+    /**
+     * @brief Contadores e tempos de conexão
+     */
+    SignalingStats GetStats() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> m_pImpl;
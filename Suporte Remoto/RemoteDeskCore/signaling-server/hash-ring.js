@@ -0,0 +1,71 @@
+/**
+ * @file hash-ring.js
+ * @brief Hash consistente de sessionId → shard (processo worker) do servidor de sinalização
+ *
+ * Cada shard ocupa VIRTUAL_NODES pontos no anel; a chave vai para o primeiro ponto
+ * com hash >= hash(chave). Com pontos virtuais a carga fica equilibrada entre os
+ * shards, e mudar o número de shards só move as sessões dos pontos afetados.
+ */
+
+const VIRTUAL_NODES = 64;
+
+// FNV-1a 32 bits + finalização do murmur3 (strings parecidas espalham bem no anel)
+function hashString(value) {
+    let hash = 0x811c9dc5;
+    for (let i = 0; i < value.length; i++) {
+        hash ^= value.charCodeAt(i);
+        hash = Math.imul(hash, 0x01000193);
+    }
+    hash ^= hash >>> 16;
+    hash = Math.imul(hash, 0x85ebca6b);
+    hash ^= hash >>> 13;
+    hash = Math.imul(hash, 0xc2b2ae35);
+    hash ^= hash >>> 16;
+    return hash >>> 0;
+}
+
+/**
+ * @class HashRing
+ * Anel imutável sobre shards 0..shardCount-1
+ */
+class HashRing {
+    constructor(shardCount, virtualNodes = VIRTUAL_NODES) {
+        this.shardCount = shardCount;
+        this.hashes = [];
+        this.shards = [];
+
+        const points = [];
+        for (let shard = 0; shard < shardCount; shard++) {
+            for (let v = 0; v < virtualNodes; v++) {
+                points.push({ hash: hashString(`shard-${shard}#${v}`), shard });
+            }
+        }
+        points.sort((a, b) => a.hash - b.hash);
+        for (const point of points) {
+            this.hashes.push(point.hash);
+            this.shards.push(point.shard);
+        }
+    }
+
+    lookup(key) {
+        if (this.shardCount <= 1) {
+            return 0;
+        }
+
+        // Busca binária do primeiro ponto >= hash (volta ao início no fim do anel)
+        const hash = hashString(key);
+        let low = 0;
+        let high = this.hashes.length;
+        while (low < high) {
+            const mid = (low + high) >>> 1;
+            if (this.hashes[mid] < hash) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return this.shards[low === this.hashes.length ? 0 : low];
+    }
+}
+
+module.exports = { HashRing, hashString };
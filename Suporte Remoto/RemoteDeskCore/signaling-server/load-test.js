@@ -0,0 +1,523 @@
+#!/usr/bin/env node
+
+/**
+ * @file load-test.js
+ * @brief Cliente de carga: dezenas de milhares de peers simulados contra o signaling-server.js
+ *
+ * Abre pares host/guest: host registra, guest entra na sessão, oferta/resposta e
+ * candidatos ICE em lote vão e voltam (como o WebSocketSignalingClient), e as conexões
+ * ficam abertas até o fim. Mede conexões por segundo e o tempo de negociação de cada par.
+ *
+ * A carga sobe em degraus (--steps, total de peers em cada um). Depois de abrir os
+ * pares de um degrau, o teste segura as conexões por --hold-ms. Nesse tempo cada par
+ * troca candidatos avulsos (--relay-rate por segundo, com o instante de envio), que dão
+ * a latência de relay do servidor. O /health do servidor, consultado a cada segundo,
+ * informa a memória e as varreduras do heartbeat. Relays enviados logo após uma
+ * varredura são separados dos demais. Quando o p99 deles passa do dobro do p99 normal,
+ * a varredura virou o gargalo. Com --hold-ms 0 (padrão) o degrau dura um intervalo de
+ * heartbeat + 2 s. Para não esperar 30 s por degrau, suba o servidor com
+ * SIGNALING_HEARTBEAT_MS menor. A memória por sessão vem de /health/cluster (soma de
+ * todos os workers sobre o total de sessões); o heartbeat é do worker que atende.
+ *
+ * Uma máquina Linux só: cada conexão usa uma porta efêmera por IP de origem
+ * (~28 mil em 127.0.0.1), então os peers se espalham por 127.0.0.1..127.0.0.N
+ * (--source-ips). O limite de arquivos abertos vale para este processo e para cada
+ * worker do servidor (ulimit -n).
+ *
+ * Execução:
+ * node load-test.js [--url ws://127.0.0.1:8080] [--peers 20000] [--steps 5000,10000,20000]
+ *                   [--concurrency 256] [--rate pares/s] [--source-ips N] [--ice 8]
+ *                   [--sdp-bytes 2500] [--relay-rate 0.5] [--hold-ms 0]
+ */
+
+const WebSocket = require('ws');
+const http = require('http');
+const { performance } = require('perf_hooks');
+
+const PORTS_PER_SOURCE_IP = 25000;
+const PAIR_TIMEOUT_MS = 30000;
+const PROBE_TICK_MS = 20;
+const HEALTH_POLL_MS = 1000;
+const SWEEP_WINDOW_MIN_MS = 1000;       // Janela "logo após a varredura" (ou até o último pong)
+const SWEEP_BOTTLENECK_FACTOR = 2;      // p99 na janela > 2x o p99 normal
+const SWEEP_BOTTLENECK_MIN_MS = 20;     // ... e pelo menos 20 ms acima dele
+
+function parseOptions(argv) {
+    const options = {
+        url: 'ws://127.0.0.1:8080',
+        peers: 2000,
+        steps: null,                    // null = um degrau só, com --peers
+        concurrency: 256,
+        rate: 0,                        // Pares iniciados por segundo (0 = sem limite)
+        sourceIps: 0,                   // 0 = o necessário para --peers
+        ice: 8,
+        sdpBytes: 2500,                 // Oferta/resposta típicas com um data channel
+        relayRate: 0.5,                 // Candidatos avulsos por par por segundo no degrau
+        holdMs: 0                       // 0 = intervalo do heartbeat + 2 s
+    };
+
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        const value = argv[i + 1];
+        if (arg === '--url' && value) {
+            options.url = value; i++;
+        } else if (arg === '--peers' && value) {
+            options.peers = parseInt(value, 10); i++;
+        } else if (arg === '--steps' && value) {
+            options.steps = value.split(',').map((step) => parseInt(step, 10)); i++;
+        } else if (arg === '--rate' && value) {
+            options.rate = parseFloat(value); i++;
+        } else if (arg === '--sdp-bytes' && value) {
+            options.sdpBytes = parseInt(value, 10); i++;
+        } else if (arg === '--relay-rate' && value) {
+            options.relayRate = parseFloat(value); i++;
+        } else if (arg === '--concurrency' && value) {
+            options.concurrency = parseInt(value, 10); i++;
+        } else if (arg === '--source-ips' && value) {
+            options.sourceIps = parseInt(value, 10); i++;
+        } else if (arg === '--ice' && value) {
+            options.ice = parseInt(value, 10); i++;
+        } else if (arg === '--hold-ms' && value) {
+            options.holdMs = parseInt(value, 10); i++;
+        } else {
+            console.log('Uso: node load-test.js [--url ws://host:porta] [--peers n] [--steps n,n,...]');
+            console.log('                       [--concurrency n] [--rate pares/s] [--source-ips n] [--ice n]');
+            console.log('                       [--sdp-bytes n] [--relay-rate n] [--hold-ms n]');
+            process.exit(arg === '--help' || arg === '-h' ? 0 : 1);
+        }
+    }
+
+    if (!options.steps || options.steps.some((step) => !(step > 0))) {
+        options.steps = [options.peers];
+    }
+    options.steps.sort((a, b) => a - b);
+    options.peers = options.steps[options.steps.length - 1];
+
+    if (options.sourceIps <= 0) {
+        options.sourceIps = Math.max(1, Math.ceil(options.peers / PORTS_PER_SOURCE_IP));
+    }
+    return options;
+}
+
+function percentile(sorted, p) {
+    if (sorted.length === 0) {
+        return 0;
+    }
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+function fakeSdp(kind, peerId, size) {
+    const header = `v=0\r\no=- ${peerId} 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=${kind}\r\n`;
+    return header + 'a=x-pad:'.padEnd(Math.max(0, size - header.length), 'x') + '\r\n';
+}
+
+function fakeCandidates(count, index) {
+    const candidates = [];
+    for (let i = 0; i < count; i++) {
+        candidates.push({
+            candidate: `candidate:${i} 1 udp ${2122260223 - i} 192.168.${index % 250}.${i + 1} ${50000 + i} typ host`,
+            sdpMLineIndex: '0',
+            sdpMid: '0'
+        });
+    }
+    return candidates;
+}
+
+/**
+ * @class LoadStats
+ * Contadores do teste inteiro
+ */
+class LoadStats {
+    constructor() {
+        this.connected = 0;
+        this.connectErrors = 0;
+        this.registerErrors = 0;
+        this.pairsDone = 0;
+        this.pairsFailed = 0;
+        this.closedEarly = 0;
+        this.negotiationMs = [];
+        this.messagesSent = 0;
+        this.messagesReceived = 0;
+        this.probesSent = 0;
+        this.probes = [];               // { sentAt (ms, relógio de parede), latencyMs } do degrau
+    }
+}
+
+function nowMs() {
+    return performance.timeOrigin + performance.now();
+}
+
+// GET /health/cluster do servidor (soma dos workers); servidor sem a rota cai no /health
+async function fetchHealth(options) {
+    const cluster = await fetchJson(options, '/health/cluster');
+    return cluster && cluster.status ? cluster : fetchJson(options, '/health');
+}
+
+// GET path no servidor (null em erro)
+function fetchJson(options, path) {
+    const url = options.url.replace(/^ws/, 'http').replace(/\/$/, '') + path;
+    return new Promise((resolve) => {
+        const request = http.get(url, { timeout: 2000 }, (res) => {
+            let body = '';
+            res.on('data', (chunk) => { body += chunk; });
+            res.on('end', () => {
+                try {
+                    resolve(JSON.parse(body));
+                } catch (e) {
+                    resolve(null);
+                }
+            });
+        });
+        request.on('timeout', () => request.destroy());
+        request.on('error', () => resolve(null));
+    });
+}
+
+// Abre uma conexão e resolve quando abrir (ou null em erro)
+function connect(options, sourceIp, stats, sockets) {
+    return new Promise((resolve) => {
+        const ws = new WebSocket(options.url, { localAddress: sourceIp, perMessageDeflate: false });
+        ws.waiters = [];
+        ws.once('open', () => {
+            stats.connected++;
+            sockets.push(ws);
+            resolve(ws);
+        });
+        ws.once('error', () => {
+            stats.connectErrors++;
+            resolve(null);
+        });
+        ws.on('message', (data) => {
+            stats.messagesReceived++;
+            const message = JSON.parse(data.toString());
+            if (message.data && message.data.probeAt !== undefined) {
+                stats.probes.push({ sentAt: message.data.probeAt, latencyMs: nowMs() - message.data.probeAt });
+                return;
+            }
+            ws.waiters = ws.waiters.filter((waiter) => !waiter(message));
+        });
+        ws.on('close', () => {
+            if (ws.expectOpen) {
+                stats.closedEarly++;
+            }
+        });
+    });
+}
+
+function send(ws, message, stats) {
+    stats.messagesSent++;
+    ws.send(JSON.stringify(message));
+}
+
+// Espera uma mensagem do tipo (as demais são ignoradas); null em erro ou timeout
+function waitFor(ws, type) {
+    return new Promise((resolve) => {
+        const timer = setTimeout(() => resolve(null), PAIR_TIMEOUT_MS);
+        ws.waiters.push((message) => {
+            if (message.type !== type && message.type !== 'error') {
+                return false;
+            }
+            clearTimeout(timer);
+            resolve(message.type === type ? message : null);
+            return true;
+        });
+    });
+}
+
+// Um par completo: registro, entrada do guest, oferta/resposta e candidatos nos dois
+// sentidos. Retorna o par negociado ou null
+async function runPair(index, options, stats, sockets) {
+    const start = process.hrtime.bigint();
+    const sourceIp = `127.0.0.${1 + (index % options.sourceIps)}`;
+    const hostId = `load-host-${index}-${process.pid}`;
+    const guestId = `load-guest-${index}-${process.pid}`;
+
+    const host = await connect(options, sourceIp, stats, sockets);
+    if (!host) {
+        return null;
+    }
+    const hostAck = waitFor(host, 'register-ack');
+    send(host, { type: 'register', peerId: hostId, role: 'host' }, stats);
+    const ack = await hostAck;
+    if (!ack) {
+        stats.registerErrors++;
+        return null;
+    }
+    const sessionId = ack.sessionId;
+
+    const guest = await connect(options, sourceIp, stats, sockets);
+    if (!guest) {
+        return null;
+    }
+    const guestConnected = waitFor(host, 'guest-connected');
+    const guestAck = waitFor(guest, 'register-ack');
+    send(guest, { type: 'register', peerId: guestId, role: 'guest', sessionId }, stats);
+    if (!await guestAck || !await guestConnected) {
+        stats.registerErrors++;
+        return null;
+    }
+
+    // Host: oferta; guest: resposta + candidatos; host: candidatos
+    const offer = waitFor(guest, 'offer');
+    send(host, { type: 'offer', peerId: hostId, remotePeerId: guestId, sessionId,
+                 data: { sdp: fakeSdp('offer', hostId, options.sdpBytes) } }, stats);
+    if (!await offer) {
+        return null;
+    }
+
+    const answer = waitFor(host, 'answer');
+    const hostCandidates = waitFor(host, 'ice-candidates');
+    send(guest, { type: 'answer', peerId: guestId, remotePeerId: hostId, sessionId,
+                  data: { sdp: fakeSdp('answer', guestId, options.sdpBytes) } }, stats);
+    send(guest, { type: 'ice-candidates', peerId: guestId, remotePeerId: hostId, sessionId,
+                  data: { candidates: fakeCandidates(options.ice, index) } }, stats);
+    if (!await answer || !await hostCandidates) {
+        return null;
+    }
+
+    const guestCandidates = waitFor(guest, 'ice-candidates');
+    send(host, { type: 'ice-candidates', peerId: hostId, remotePeerId: guestId, sessionId,
+                 data: { candidates: fakeCandidates(options.ice, index) } }, stats);
+    if (!await guestCandidates) {
+        return null;
+    }
+
+    host.expectOpen = true;
+    guest.expectOpen = true;
+    stats.negotiationMs.push(Number(process.hrtime.bigint() - start) / 1e6);
+    return { index, host, guest, hostId, guestId, sessionId };
+}
+
+// Candidato avulso com o instante de envio, alternando o sentido
+function sendProbe(pair, toGuest, stats) {
+    const from = toGuest ? pair.host : pair.guest;
+    if (from.readyState !== WebSocket.OPEN) {
+        return;
+    }
+    const [candidate] = fakeCandidates(1, pair.index);
+    stats.probesSent++;
+    send(from, {
+        type: 'ice-candidates',
+        peerId: toGuest ? pair.hostId : pair.guestId,
+        remotePeerId: toGuest ? pair.guestId : pair.hostId,
+        sessionId: pair.sessionId,
+        data: { candidates: [candidate], probeAt: nowMs() }
+    }, stats);
+}
+
+// Segura as conexões por holdMs com relays de sonda e /health a cada segundo.
+// Retorna as varreduras do heartbeat vistas e o último /health
+async function holdStep(options, holdMs, pairs, stats) {
+    const sweeps = [];
+    let health = null;
+    let probeBudget = 0;
+    let nextProbe = 0;
+    let lastTick = nowMs();
+
+    const probeTimer = setInterval(() => {
+        const now = nowMs();
+        probeBudget += pairs.length * options.relayRate * (now - lastTick) / 1000;
+        lastTick = now;
+        for (; probeBudget >= 1 && pairs.length > 0; probeBudget--) {
+            const turn = nextProbe++;
+            sendProbe(pairs[turn % pairs.length], Math.floor(turn / pairs.length) % 2 === 0, stats);
+        }
+    }, PROBE_TICK_MS);
+
+    const end = Date.now() + holdMs;
+    while (Date.now() < end) {
+        await new Promise((resolve) => setTimeout(resolve, Math.min(HEALTH_POLL_MS, end - Date.now())));
+        const current = await fetchHealth(options);
+        if (!current || !current.heartbeat) {
+            continue;
+        }
+        health = current;
+        const beat = current.heartbeat;
+        const last = sweeps[sweeps.length - 1];
+        if (beat.sweeps > 0 && (!last || last.at !== beat.lastSweepAt)) {
+            sweeps.push({ at: beat.lastSweepAt, sweepMs: beat.lastSweepMs,
+                          clients: beat.lastSweepClients, drainMs: 0, seen: beat.sweeps });
+        } else if (last && last.at === beat.lastSweepAt) {
+            last.drainMs = beat.lastPongDrainMs;      // Último pong chega depois
+        }
+    }
+    clearInterval(probeTimer);
+
+    // A primeira varredura vista pode ser anterior ao degrau
+    const stepStart = end - holdMs;
+    return { sweeps: sweeps.filter((sweep) => sweep.at >= stepStart), health };
+}
+
+function formatMs(value) {
+    return value === null ? '—' : value.toFixed(1);
+}
+
+// Latências de relay do degrau: normais e logo após uma varredura do heartbeat
+function summarizeStep(peers, connectRate, negotiation, probesSent, probes, hold, baseline) {
+    const inSweep = [];
+    const steady = [];
+    for (const probe of probes) {
+        const sweep = hold.sweeps.find((s) => probe.sentAt >= s.at &&
+                                              probe.sentAt <= s.at + Math.max(SWEEP_WINDOW_MIN_MS, s.drainMs));
+        (sweep ? inSweep : steady).push(probe.latencyMs);
+    }
+    inSweep.sort((a, b) => a - b);
+    steady.sort((a, b) => a - b);
+    negotiation.sort((a, b) => a - b);
+
+    const row = {
+        peers,
+        connectRate,
+        negotiationP50: percentile(negotiation, 0.5),
+        relayP50: percentile(steady, 0.5),
+        relayP95: percentile(steady, 0.95),
+        relayP99: percentile(steady, 0.99),
+        sweepP99: inSweep.length > 0 ? percentile(inSweep, 0.99) : null,
+        sweepMs: hold.sweeps.length > 0 ? Math.max(...hold.sweeps.map((s) => s.sweepMs)) : null,
+        drainMs: hold.sweeps.length > 0 ? Math.max(...hold.sweeps.map((s) => s.drainMs)) : null,
+        sweepDuty: null,                // Varredura + pongs em % do intervalo do heartbeat
+        probesLost: probesSent - probes.length,
+        rssPerSession: null,
+        heapPerSession: null
+    };
+    if (hold.health && row.drainMs !== null) {
+        row.sweepDuty = 100 * Math.max(row.sweepMs, row.drainMs) / hold.health.heartbeat.intervalMs;
+    }
+    // Memória e sessões de todos os workers: com /health de um worker só, a memória das
+    // conexões dele não bate com as sessões que ele é dono
+    const wholeCluster = (health) => health && (health.shards <= 1 ||
+                                                (health.workers !== undefined && health.missingShards === 0));
+    if (wholeCluster(hold.health) && wholeCluster(baseline) && hold.health.sessions > 0) {
+        row.rssPerSession = (hold.health.memory.rss - baseline.memory.rss) / hold.health.sessions / 1024;
+        row.heapPerSession = (hold.health.memory.heapUsed - baseline.memory.heapUsed) / hold.health.sessions / 1024;
+    }
+    row.sweepBound = row.sweepP99 !== null &&
+                     row.sweepP99 > row.relayP99 * SWEEP_BOTTLENECK_FACTOR &&
+                     row.sweepP99 > row.relayP99 + SWEEP_BOTTLENECK_MIN_MS;
+    return row;
+}
+
+async function main() {
+    const options = parseOptions(process.argv.slice(2));
+    const stats = new LoadStats();
+    const sockets = [];
+    const pairs = [];
+
+    const baseline = await fetchHealth(options);
+    let holdMs = options.holdMs;
+    if (holdMs <= 0) {
+        holdMs = baseline && baseline.heartbeat ? baseline.heartbeat.intervalMs + 2000 : 5000;
+    }
+
+    console.log(`[Load] ${options.peers} peers em ${options.url} (degraus: ${options.steps.join(', ')}), ` +
+                `${options.concurrency} em paralelo${options.rate > 0 ? `, ${options.rate} pares/s` : ''}, ` +
+                `${options.sourceIps} IP(s) de origem`);
+    console.log(`[Load] SDP ${options.sdpBytes} bytes, ${options.ice} candidatos em lote, ` +
+                `${options.relayRate} relays/s por par, ${(holdMs / 1000).toFixed(0)} s por degrau`);
+    if (!baseline) {
+        console.log('[Load] /health indisponível: sem memória nem heartbeat do servidor');
+    } else if (baseline.shards > 1) {
+        console.log(baseline.workers !== undefined
+            ? `[Load] Servidor com ${baseline.shards} workers: memória somada, heartbeat de um worker só`
+            : `[Load] Servidor com ${baseline.shards} workers sem /health/cluster: sem memória por sessão`);
+    }
+
+    // Progresso a cada segundo
+    const start = Date.now();
+    const progress = setInterval(() => {
+        const elapsed = (Date.now() - start) / 1000;
+        console.log(`[Load] ${elapsed.toFixed(0)} s: ${stats.connected} conectados, ` +
+                    `${stats.pairsDone} pares, ${stats.pairsFailed} com falha`);
+    }, 1000);
+
+    const rows = [];
+    let next = 0;
+    let nextStartAt = Date.now();
+    for (const stepPeers of options.steps) {
+        const stepPairs = Math.floor(stepPeers / 2);
+        const stepStart = Date.now();
+        const connectedBefore = stats.connected;
+        const negotiatedBefore = stats.negotiationMs.length;
+
+        const worker = async () => {
+            while (next < stepPairs) {
+                const index = next++;
+                if (options.rate > 0) {
+                    const wait = nextStartAt - Date.now();
+                    nextStartAt = Math.max(nextStartAt, Date.now()) + 1000 / options.rate;
+                    if (wait > 0) {
+                        await new Promise((resolve) => setTimeout(resolve, wait));
+                    }
+                }
+                const pair = await runPair(index, options, stats, sockets);
+                if (pair) {
+                    pairs.push(pair);
+                    stats.pairsDone++;
+                } else {
+                    stats.pairsFailed++;
+                }
+            }
+        };
+        await Promise.all(Array.from({ length: Math.max(1, Math.min(options.concurrency, stepPairs - next)) }, worker));
+        const rampSeconds = Math.max(0.001, (Date.now() - stepStart) / 1000);
+
+        // Conexões abertas por holdMs com relays de sonda (latência, heartbeat, memória)
+        stats.probes = [];
+        const probesBefore = stats.probesSent;
+        const hold = await holdStep(options, holdMs, pairs, stats);
+        await new Promise((resolve) => setTimeout(resolve, 200));     // Sondas em trânsito
+
+        const row = summarizeStep(pairs.length * 2, (stats.connected - connectedBefore) / rampSeconds,
+                                  stats.negotiationMs.slice(negotiatedBefore),
+                                  stats.probesSent - probesBefore, stats.probes, hold, baseline);
+        rows.push(row);
+        console.log(`[Load] Degrau ${row.peers} peers: relay p99 ${formatMs(row.relayP99)} ms, ` +
+                    `p99 após varredura ${formatMs(row.sweepP99)} ms, varredura ${formatMs(row.sweepMs)} ms`);
+        if (hold.sweeps.length === 0) {
+            console.log('[Load] Nenhuma varredura do heartbeat no degrau (--hold-ms menor que o intervalo?)');
+        }
+    }
+    clearInterval(progress);
+    const totalPairs = Math.floor(options.peers / 2);
+
+    const sorted = stats.negotiationMs.slice().sort((a, b) => a - b);
+    console.log('\n=== Resultado ===');
+    console.log(`Pares negociados:     ${stats.pairsDone}/${totalPairs} em ${((Date.now() - start) / 1000).toFixed(1)} s`);
+    console.log(`Pares com falha:      ${stats.pairsFailed} (conexão ${stats.connectErrors}, ` +
+                `registro ${stats.registerErrors}); fechados antes do fim ${stats.closedEarly}`);
+    console.log(`Negociação por par:   p50 ${percentile(sorted, 0.5).toFixed(1)} ms, ` +
+                `p95 ${percentile(sorted, 0.95).toFixed(1)} ms, p99 ${percentile(sorted, 0.99).toFixed(1)} ms`);
+    console.log(`Mensagens:            ${stats.messagesSent} enviadas, ${stats.messagesReceived} recebidas`);
+    console.log(`Memória do cliente:   ${(process.memoryUsage().rss / 1048576).toFixed(0)} MB RSS`);
+
+    console.log('\n   Peers  Conex/s  Negoc p50 | Relay p50    p95    p99 | p99 varredura | Varredura  último pong ' +
+                '  % interv. | RSS/sessão  heap/sessão | Perdidos');
+    for (const row of rows) {
+        console.log(`${String(row.peers).padStart(8)} ${row.connectRate.toFixed(0).padStart(8)} ` +
+                    `${formatMs(row.negotiationP50).padStart(10)} | ${formatMs(row.relayP50).padStart(9)} ` +
+                    `${formatMs(row.relayP95).padStart(6)} ${formatMs(row.relayP99).padStart(6)} | ` +
+                    `${formatMs(row.sweepP99).padStart(13)} | ${formatMs(row.sweepMs).padStart(9)} ` +
+                    `${formatMs(row.drainMs).padStart(11)} ` +
+                    `${(row.sweepDuty === null ? '—' : row.sweepDuty.toFixed(1) + '%').padStart(9)} | ` +
+                    `${(row.rssPerSession === null ? '—' : row.rssPerSession.toFixed(1) + ' KB').padStart(10)} ` +
+                    `${(row.heapPerSession === null ? '—' : row.heapPerSession.toFixed(1) + ' KB').padStart(12)} | ` +
+                    `${String(row.probesLost).padStart(8)}`);
+    }
+
+    const bound = rows.find((row) => row.sweepBound);
+    if (bound) {
+        console.log(`\nVarredura do heartbeat vira gargalo a partir de ~${bound.peers} peers ` +
+                    `(p99 após varredura ${bound.sweepP99.toFixed(1)} ms contra ${bound.relayP99.toFixed(1)} ms; ` +
+                    `varredura + pongs em ${formatMs(bound.drainMs)} ms)`);
+    } else if (rows.some((row) => row.sweepP99 !== null)) {
+        console.log(`\nVarredura do heartbeat não foi gargalo até ${rows[rows.length - 1].peers} peers`);
+    }
+
+    for (const ws of sockets) {
+        ws.expectOpen = false;
+        ws.terminate();
+    }
+    process.exit(stats.pairsDone === totalPairs ? 0 : 1);
+}
+
+main();
@@ -7,17 +7,29 @@
  * Funcionalidade:
  * - Gerencia registro de peers (host/guest)
  * - Facilita troca de SDP offers/answers
- * - Relaia ICE candidates
+ * - Relaia ICE candidates (avulsos ou em lote: "ice-candidates")
+ * - Aceita re-registro na mesma sessão (reconexão do cliente, com o segredo do register-ack)
  * - Mantém sessões P2P
  * - Heartbeat/keepalive
+ * - Vários processos (Node cluster): sessões divididas por hash consistente do sessionId
+ *
+ * Escala horizontal: com N workers, todos aceitam conexões na mesma porta e cada
+ * sessão pertence a um shard (HashRing). O shard dono guarda a sessão (host, guest e
+ * em que shard cada um está conectado) e decide registro/entrada; as conexões ficam
+ * no worker que as aceitou. Offer/answer/ICE vão direto para o shard do peer remoto
+ * (IPC repassado pelo processo primário); sem a localização, passam pelo dono da
+ * sessão. Sessões expiram por TTL em uma roda de timers (TimerWheel), sem varredura.
  *
  * Instalação:
  * npm install ws express
  *
  * Execução:
- * node signaling-server.js [port]
+ * node signaling-server.js [port] [workers]
  *
- * Padrão: porta 8080
+ * Padrão: porta 8080, 1 worker (SIGNALING_WORKERS no ambiente também vale)
+ * SIGNALING_LOG_MESSAGES=0 desliga o log por mensagem (conexão, tipo, relay), que com
+ * milhares de peers custa mais que o próprio relay; SIGNALING_HEARTBEAT_MS muda o
+ * intervalo do heartbeat (padrão 30 s)
  *
  * Exemplo de Deploy:
  * - Heroku: git push heroku main
@@ -31,9 +43,21 @@
 const WebSocket = require('ws');
 const express = require('express');
 const http = require('http');
-const url = require('url');
+const cluster = require('cluster');
+const crypto = require('crypto');
+const { HashRing } = require('./hash-ring');
+const { TimerWheel } = require('./timer-wheel');
 
 const PORT = process.env.PORT || (process.argv[2] || 8080);
+const WORKERS = Math.max(1, parseInt(process.env.SIGNALING_WORKERS || process.argv[3] || '1', 10) || 1);
+
+const SESSION_TTL_MS = 24 * 60 * 60 * 1000;   // Sessão expira 24 h após a criação
+const TIMER_WHEEL_TICK_MS = 1000;
+const TIMER_WHEEL_SLOTS = 3600;               // Uma volta = 1 hora
+const SHARD_REQUEST_TIMEOUT_MS = 5000;        // Shard dono sem responder (worker reiniciando)
+const HEARTBEAT_INTERVAL_MS = parseInt(process.env.SIGNALING_HEARTBEAT_MS || '30000', 10) || 30000;
+const LOG_MESSAGES = process.env.SIGNALING_LOG_MESSAGES !== '0';
+const RESUME_SECRET_BYTES = 32;               // Segredo de retomada entregue no register-ack
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Tipos de Dados
@@ -50,6 +74,8 @@ class Peer {
         this.role = role;              // "host" ou "guest"
         this.sessionId = null;
         this.remotePeerId = null;
+        this.remoteShard = null;       // Shard da conexão do peer remoto (relay direto)
+        this.resumeSecret = null;      // Do register-ack; exigido para substituir esta conexão
         this.isAlive = true;
         this.lastActivity = Date.now();
     }
@@ -61,6 +87,16 @@ class Peer {
     }
 }
 
+/**
+ * Compara o segredo de retomada apresentado com o emitido, em tempo constante
+ */
+function resumeSecretMatches(expected, presented) {
+    if (!expected || typeof presented !== 'string' || presented.length !== expected.length) {
+        return false;
+    }
+    return crypto.timingSafeEqual(Buffer.from(expected), Buffer.from(presented));
+}
+
 /**
  * @class Session
  * Representa uma sessão P2P entre host e guest
@@ -70,6 +106,10 @@ class Session {
         this.hostPeerId = hostPeerId;
         this.sessionId = sessionId;
         this.guestPeerId = null;
+        this.hostShard = null;         // Shard da conexão do host (null = desconectado)
+        this.guestShard = null;
+        this.hostSecret = crypto.randomBytes(RESUME_SECRET_BYTES).toString('hex');
+        this.guestSecret = null;       // Novo a cada guest que entra
         this.createdAt = Date.now();
         this.isActive = true;
         this.messageLog = [];         // Para debug
@@ -87,16 +127,98 @@ class Session {
     }
 }
 
+// ═══════════════════════════════════════════════════════════════════════════════
+// Mensagens entre Shards
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @class ShardLink
+ * Mensagens entre shards: {kind, ...}. Para o próprio shard a entrega é local (na
+ * ordem, em process.nextTick); no cluster, IPC pelo processo primário, que só
+ * repassa para o worker de destino.
+ */
+class ShardLink {
+    constructor(shardId, shardCount) {
+        this.shardId = shardId;
+        this.shardCount = shardCount;
+        this.handler = null;              // (message, fromShard, reply) => void
+        this.pending = new Map();         // requestId -> { resolve, timer }
+        this.nextRequestId = 1;
+
+        if (shardCount > 1) {
+            process.on('message', (envelope) => this.receive(envelope));
+        }
+    }
+
+    send(shard, message) {
+        this.post({ to: shard, from: this.shardId, message });
+    }
+
+    // Pedido com resposta; resolve com null se o shard não responder a tempo
+    request(shard, message) {
+        const requestId = this.nextRequestId++;
+        return new Promise((resolve) => {
+            const timer = setTimeout(() => {
+                this.pending.delete(requestId);
+                resolve(null);
+            }, SHARD_REQUEST_TIMEOUT_MS);
+            this.pending.set(requestId, { resolve, timer });
+            this.post({ to: shard, from: this.shardId, requestId, message });
+        });
+    }
+
+    post(envelope) {
+        if (envelope.to === this.shardId) {
+            process.nextTick(() => this.receive(envelope));
+        } else {
+            process.send(envelope);
+        }
+    }
+
+    receive(envelope) {
+        if (envelope.replyTo !== undefined) {
+            const pending = this.pending.get(envelope.replyTo);
+            if (pending) {
+                this.pending.delete(envelope.replyTo);
+                clearTimeout(pending.timer);
+                pending.resolve(envelope.message);
+            }
+            return;
+        }
+
+        // reply() pode ser chamado antes de outras mensagens do handler saírem
+        // (ex: register-ack do guest antes do guest-connected chegar ao host)
+        const reply = envelope.requestId === undefined ? () => {} : (result) => {
+            this.post({ to: envelope.from, from: this.shardId, replyTo: envelope.requestId, message: result });
+        };
+        this.handler(envelope.message, envelope.from, reply);
+    }
+}
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // Servidor Principal
 // ═══════════════════════════════════════════════════════════════════════════════
 
 class SignalingServer {
-    constructor(port) {
+    constructor(port, shardId = 0, shardCount = 1) {
         this.port = port;
-        this.peers = new Map();           // peerId -> Peer
-        this.sessions = new Map();        // sessionId -> Session
+        this.shardId = shardId;
+        this.peers = new Map();           // peerId -> Peer (conexões deste worker)
+        this.sessions = new Map();        // sessionId -> Session (sessões deste shard)
         this.hostsBySessionId = new Map(); // sessionId -> peerId do host
+        this.heartbeat = {
+            sweeps: 0,
+            lastSweepAt: 0,               // Date.now() do início da última varredura
+            lastSweepMs: 0,               // ping em todos os clientes (síncrono)
+            maxSweepMs: 0,
+            lastSweepClients: 0,
+            lastPongDrainMs: 0,           // Início da varredura → último pong
+            pendingPongs: 0
+        };
+
+        this.ring = new HashRing(shardCount);
+        this.shards = new ShardLink(shardId, shardCount);
+        this.shards.handler = (message, fromShard, reply) => this.handleShardMessage(message, fromShard, reply);
 
         this.app = express();
         this.setupRoutes();
@@ -112,12 +234,34 @@ class SignalingServer {
     setupRoutes() {
         // Health check
         this.app.get('/health', (req, res) => {
-            res.json({
-                status: 'ok',
-                uptime: process.uptime(),
-                peers: this.peers.size,
-                sessions: this.sessions.size
-            });
+            // No cluster: contagens do worker que atendeu
+            res.json(this.healthSnapshot());
+        });
+
+        // Soma de todos os workers: peers e memória ficam no worker que aceitou a
+        // conexão, sessões no shard dono, então só o total divide certo.
+        // heartbeat continua o do worker que atendeu
+        this.app.get('/health/cluster', async (req, res) => {
+            const shards = [...Array(this.ring.shardCount).keys()];
+            const workers = await Promise.all(shards.map((shard) => this.shards.request(shard, { kind: 'health' })));
+            const total = this.healthSnapshot();
+            total.peers = 0;
+            total.sessions = 0;
+            total.memory = {};
+            total.missingShards = 0;
+            for (const worker of workers) {
+                if (!worker) {
+                    total.missingShards++;
+                    continue;
+                }
+                total.peers += worker.peers;
+                total.sessions += worker.sessions;
+                for (const [key, value] of Object.entries(worker.memory)) {
+                    total.memory[key] = (total.memory[key] || 0) + value;
+                }
+            }
+            total.workers = workers;
+            res.json(total);
         });
 
         // Estatísticas do servidor
@@ -127,6 +271,8 @@ class SignalingServer {
 
             res.json({
                 port: this.port,
+                shard: this.shardId,
+                shards: this.ring.shardCount,
                 peers: this.peers.size,
                 activeSessions: activeSessions.length,
                 totalSessions: this.sessions.size,
@@ -146,19 +292,16 @@ class SignalingServer {
         });
 
         // Obter sessão por ID (público)
-        this.app.get('/session/:sessionId', (req, res) => {
-            const session = this.sessions.get(req.params.sessionId);
-            if (!session) {
+        this.app.get('/session/:sessionId', async (req, res) => {
+            // Pergunta ao shard dono (pode ser este)
+            const sessionId = req.params.sessionId;
+            const info = await this.shards.request(this.ownerOf(sessionId), { kind: 'session-info', sessionId });
+            if (!info || !info.found) {
                 return res.status(404).json({ error: 'Session not found' });
             }
 
             // Retornar informações públicas apenas
-            res.json({
-                sessionId: session.sessionId,
-                hostAvailable: session.hostPeerId !== null,
-                guestConnected: session.guestPeerId !== null,
-                createdAt: new Date(session.createdAt).toISOString()
-            });
+            res.json(info.session);
         });
 
         // Página HTML simples para monitoramento
@@ -201,6 +344,8 @@ Troca de SDP:
 ICE Candidates:
   {"type": "ice-candidate", "peerId": "uuid1", "remotePeerId": "uuid2", 
    "data": {"candidate": "...", "sdpMLineIndex": "0", "sdpMid": "0"}}
+  {"type": "ice-candidates", "peerId": "uuid1", "remotePeerId": "uuid2",
+   "data": {"candidates": [{"candidate": "...", "sdpMLineIndex": "0", "sdpMid": "0"}, ...]}}
     </pre>
 </body>
 </html>
@@ -208,9 +353,15 @@ ICE Candidates:
         });
     }
 
+    ownerOf(sessionId) {
+        return this.ring.lookup(sessionId);
+    }
+
     setupWebSocket() {
         this.wss.on('connection', (ws, req) => {
-            console.log(`[WS] Nova conexão: ${req.socket.remoteAddress}`);
+            if (LOG_MESSAGES) {
+                console.log(`[WS] Nova conexão: ${req.socket.remoteAddress}`);
+            }
 
             ws.on('message', (data) => {
                 try {
@@ -237,12 +388,21 @@ ICE Candidates:
             ws.isAlive = true;
             ws.on('pong', () => {
                 ws.isAlive = true;
+                if (this.heartbeat.pendingPongs > 0 && --this.heartbeat.pendingPongs === 0) {
+                    this.heartbeat.lastPongDrainMs = Date.now() - this.heartbeat.lastSweepAt;
+                }
             });
         });
     }
 
     setupHeartbeat() {
+        // Varredura de todos os clientes a cada HEARTBEAT_INTERVAL_MS (padrão 30 s); a
+        // duração e o tempo até o último pong aparecem em /health
         setInterval(() => {
+            const start = process.hrtime.bigint();
+            let pinged = 0;
+            this.heartbeat.lastSweepAt = Date.now();
+
             this.wss.clients.forEach((ws) => {
                 if (ws.isAlive === false) {
                     ws.terminate();
@@ -251,38 +411,55 @@ ICE Candidates:
 
                 ws.isAlive = false;
                 ws.ping();
+                pinged++;
             });
-        }, 30000); // A cada 30 segundos
+
+            const sweepMs = Number(process.hrtime.bigint() - start) / 1e6;
+            this.heartbeat.sweeps++;
+            this.heartbeat.lastSweepMs = sweepMs;
+            this.heartbeat.maxSweepMs = Math.max(this.heartbeat.maxSweepMs, sweepMs);
+            this.heartbeat.lastSweepClients = pinged;
+            this.heartbeat.pendingPongs = pinged;
+        }, HEARTBEAT_INTERVAL_MS);
     }
 
     setupCleanup() {
-        // Limpar sessões inativas a cada 5 minutos
-        setInterval(() => {
-            const now = Date.now();
-            for (const [sessionId, session] of this.sessions.entries()) {
-                const age = now - session.createdAt;
-                if (age > 24 * 60 * 60 * 1000) { // Mais de 24 horas
-                    this.sessions.delete(sessionId);
-                    console.log(`[Cleanup] Sessão expirada: ${sessionId}`);
-                }
-            }
-        }, 5 * 60 * 1000); // 5 minutos
+        // Sessões expiram 24 horas após a criação; cada tick olha só um slot da roda
+        this.expirations = new TimerWheel(TIMER_WHEEL_TICK_MS, TIMER_WHEEL_SLOTS, (sessionId) => {
+            this.sessions.delete(sessionId);
+            this.hostsBySessionId.delete(sessionId);
+            console.log(`[Cleanup] Sessão expirada: ${sessionId}`);
+        });
+        this.expirations.start();
+    }
+
+    createSession(hostPeerId, sessionId) {
+        const session = new Session(hostPeerId, sessionId);
+        this.sessions.set(sessionId, session);
+        this.hostsBySessionId.set(sessionId, hostPeerId);
+        this.expirations.schedule(sessionId, session.createdAt + SESSION_TTL_MS);
+        return session;
     }
 
     handleMessage(ws, message) {
-        const { type, peerId, role, sessionId } = message;
+        const { type, peerId, role, sessionId, resumeSecret } = message;
 
-        console.log(`[${type}] de ${peerId}`);
+        if (LOG_MESSAGES) {
+            console.log(`[${type}] de ${peerId}`);
+        }
 
         switch (type) {
             case 'register':
-                this.handleRegister(ws, peerId, role, sessionId);
+                this.handleRegister(ws, peerId, role, sessionId, resumeSecret).catch((e) => {
+                    console.error('[Error] Registro:', e.message);
+                });
                 break;
 
             case 'offer':
             case 'answer':
             case 'ice-candidate':
-                this.handleRelay(message);
+            case 'ice-candidates':
+                this.handleRelay(ws, message);
                 break;
 
             case 'ping':
@@ -294,148 +471,396 @@ ICE Candidates:
         }
     }
 
-    handleRegister(ws, peerId, role, sessionId) {
-        // Checar se peer já existe
-        if (this.peers.has(peerId)) {
-            ws.send(JSON.stringify({
-                type: 'error',
-                message: 'Peer ID já registrado'
-            }));
-            return;
+    async handleRegister(ws, peerId, role, sessionId, resumeSecret) {
+        // Checar se peer já existe (neste worker; peerIds são gerados pelos clientes)
+        const existing = this.peers.get(peerId);
+        if (existing) {
+            // Reconexão: mesmo peer e mesma sessão substituem a conexão antiga,
+            // que pode continuar "aberta" aqui até o próximo heartbeat. O peer prova
+            // que é o mesmo com o segredo do register-ack, não com o ID da sessão
+            if (!sessionId || existing.sessionId !== sessionId || existing.role !== role ||
+                !resumeSecretMatches(existing.resumeSecret, resumeSecret)) {
+                ws.send(JSON.stringify({
+                    type: 'error',
+                    message: 'Peer ID já registrado'
+                }));
+                return;
+            }
+            this.removeLocalPeer(existing);
+            if (existing.ws !== ws) {
+                existing.ws.terminate();
+            }
         }
 
-        let session;
-
         if (role === 'host') {
-            // Host cria nova sessão
-            const newSessionId = peerId + '_' + Date.now();
-            session = new Session(peerId, newSessionId);
-            this.sessions.set(newSessionId, session);
-            this.hostsBySessionId.set(newSessionId, peerId);
+            // Host retomando a própria sessão após reconectar: o dono confere o segredo
+            // do register-ack anterior
+            const resuming = Boolean(sessionId);
+            const targetSessionId = resuming ? sessionId : peerId + '_' + Date.now();
+
+            // Peer entra no mapa antes da resposta do dono: nada endereçado a ele se perde
+            const peer = this.addLocalPeer(ws, peerId, role, targetSessionId);
+            const result = await this.shards.request(this.ownerOf(targetSessionId), {
+                kind: 'host-register', sessionId: targetSessionId, peerId, resuming, resumeSecret
+            });
 
-            const peer = new Peer(ws, peerId, role);
-            peer.sessionId = newSessionId;
-            this.peers.set(peerId, peer);
+            if (!result || !result.ok) {
+                this.removeLocalPeer(peer);
+                peer.send({ type: 'error', message: result && result.error ? result.error : 'Sessão indisponível' });
+                return;
+            }
+            peer.resumeSecret = result.resumeSecret;
 
-            console.log(`[Host Registrado] ID: ${peerId}, Sessão: ${newSessionId}`);
+            console.log(`[Host ${result.resumed ? 'Reconectado' : 'Registrado'}] ID: ${peerId}, ` +
+                        `Sessão: ${targetSessionId}`);
 
-            ws.send(JSON.stringify({
+            peer.send({
                 type: 'register-ack',
-                sessionId: newSessionId,
-                role: 'host'
-            }));
-
-            session.addLog({
-                type: 'host_registered',
-                peerId: peerId
+                sessionId: targetSessionId,
+                role: 'host',
+                resumeSecret: result.resumeSecret
             });
 
         } else if (role === 'guest') {
-            // Guest conecta a sessão existente
-            session = this.sessions.get(sessionId);
-            if (!session) {
+            // Guest conecta a sessão existente (o shard dono decide)
+            const peer = this.addLocalPeer(ws, peerId, role, sessionId);
+            const result = sessionId ? await this.shards.request(this.ownerOf(sessionId), {
+                kind: 'guest-join', sessionId, peerId, resumeSecret
+            }) : { ok: false, error: 'Sessão não encontrada' };
+
+            if (!result || !result.ok) {
+                this.removeLocalPeer(peer);
                 ws.send(JSON.stringify({
                     type: 'error',
-                    message: 'Sessão não encontrada'
+                    message: result ? result.error : 'Sessão indisponível'
                 }));
                 return;
             }
 
-            if (session.guestPeerId !== null) {
-                ws.send(JSON.stringify({
-                    type: 'error',
-                    message: 'Sessão já tem guest'
-                }));
-                return;
-            }
-
-            const peer = new Peer(ws, peerId, role);
-            peer.sessionId = sessionId;
-            this.peers.set(peerId, peer);
-
-            session.guestPeerId = peerId;
+            peer.remotePeerId = result.hostPeerId;
+            peer.remoteShard = result.hostShard;
+            peer.resumeSecret = result.resumeSecret;
 
             console.log(`[Guest Registrado] ID: ${peerId}, Sessão: ${sessionId}`);
 
-            ws.send(JSON.stringify({
+            peer.send({
                 type: 'register-ack',
                 sessionId: sessionId,
                 role: 'guest',
-                hostPeerId: session.hostPeerId
-            }));
+                hostPeerId: result.hostPeerId,
+                resumeSecret: result.resumeSecret
+            });
+        }
+    }
 
-            // Notificar host sobre novo guest
-            const hostPeer = this.peers.get(session.hostPeerId);
-            if (hostPeer) {
-                hostPeer.send({
-                    type: 'guest-connected',
-                    guestPeerId: peerId
-                });
-            }
+    addLocalPeer(ws, peerId, role, sessionId) {
+        const peer = new Peer(ws, peerId, role);
+        peer.sessionId = sessionId;
+        this.peers.set(peerId, peer);
+        ws.peerId = peerId;            // handleDisconnect sem varrer os peers
+        return peer;
+    }
 
-            session.addLog({
-                type: 'guest_registered',
-                peerId: peerId
-            });
+    removeLocalPeer(peer) {
+        if (this.peers.get(peer.peerId) === peer) {
+            this.peers.delete(peer.peerId);
+        }
+        if (peer.ws.peerId === peer.peerId) {
+            peer.ws.peerId = undefined;
         }
     }
 
-    handleRelay(message) {
+    handleRelay(ws, message) {
         const { peerId, remotePeerId, sessionId, type } = message;
 
-        // Encontrar peer remoto
+        // Peer remoto neste worker: entrega direta
         const remotePeer = this.peers.get(remotePeerId);
-        if (!remotePeer) {
+        if (remotePeer) {
+            remotePeer.send(message);
+            this.logRelay(sessionId, type, peerId, remotePeerId);
+            if (LOG_MESSAGES) {
+                console.log(`[Relay] ${type} de ${peerId} para ${remotePeerId}`);
+            }
+            return;
+        }
+
+        // Em outro worker: direto para o shard conhecido, senão pelo dono da sessão
+        const sender = this.peers.get(ws.peerId);
+        if (sender && sender.remotePeerId === remotePeerId && sender.remoteShard !== null) {
+            this.shards.send(sender.remoteShard, { kind: 'deliver', peerId: remotePeerId, sessionId, payload: message });
+        } else if (sessionId) {
+            this.shards.send(this.ownerOf(sessionId), { kind: 'session-relay', sessionId, remotePeerId, payload: message });
+        } else {
             console.warn(`[Relay Falhou] Peer remoto não encontrado: ${remotePeerId}`);
             return;
         }
 
-        // Repassar mensagem
-        remotePeer.send(message);
+        if (LOG_MESSAGES) {
+            console.log(`[Relay] ${type} de ${peerId} para ${remotePeerId} (shard remoto)`);
+        }
+    }
 
-        // Log na sessão
+    // Log só no shard dono: relay entre workers não gera uma mensagem extra só para o log
+    logRelay(sessionId, type, from, to) {
         const session = this.sessions.get(sessionId);
         if (session) {
+            session.addLog({ type, from, to });
+        }
+    }
+
+    handleDisconnect(ws) {
+        const peer = ws.peerId !== undefined ? this.peers.get(ws.peerId) : undefined;
+        if (!peer || peer.ws !== ws) {
+            return;
+        }
+
+        console.log(`[Desconexão] ${peer.peerId} (${peer.role})`);
+        this.removeLocalPeer(peer);
+
+        // Dono da sessão avisa o guest (host saiu) ou libera a vaga (guest saiu)
+        if (peer.sessionId) {
+            this.shards.send(this.ownerOf(peer.sessionId), {
+                kind: 'peer-left', sessionId: peer.sessionId, peerId: peer.peerId, role: peer.role
+            });
+        }
+    }
+
+    // ───────────────────────────────────────────────────────────────────────────
+    // Shard dono da sessão / entrega entre shards
+    // ───────────────────────────────────────────────────────────────────────────
+
+    handleShardMessage(message, fromShard, reply) {
+        switch (message.kind) {
+            case 'host-register':
+                reply(this.onHostRegister(message, fromShard));
+                break;
+
+            case 'guest-join':
+                this.onGuestJoin(message, fromShard, reply);
+                break;
+
+            case 'peer-left':
+                this.onPeerLeft(message, fromShard);
+                break;
+
+            case 'session-relay':
+                this.onSessionRelay(message);
+                break;
+
+            case 'deliver':
+                this.onDeliver(message);
+                break;
+
+            case 'peer-replaced': {
+                // Peer reconectou em outro worker: a conexão antiga sai sem avisar o dono
+                const peer = this.peers.get(message.peerId);
+                if (peer && peer.sessionId === message.sessionId) {
+                    this.removeLocalPeer(peer);
+                    peer.ws.terminate();
+                }
+                break;
+            }
+
+            case 'health':
+                reply(this.healthSnapshot());
+                break;
+
+            case 'session-info': {
+                const session = this.sessions.get(message.sessionId);
+                reply(session ? {
+                    found: true,
+                    session: {
+                        sessionId: session.sessionId,
+                        hostAvailable: session.hostPeerId !== null,
+                        guestConnected: session.guestPeerId !== null,
+                        createdAt: new Date(session.createdAt).toISOString()
+                    }
+                } : { found: false });
+                break;
+            }
+
+            default:
+                console.warn(`[Warning] Mensagem de shard desconhecida: ${message.kind}`);
+        }
+    }
+
+    healthSnapshot() {
+        return {
+            status: 'ok',
+            uptime: process.uptime(),
+            shard: this.shardId,
+            shards: this.ring.shardCount,
+            peers: this.peers.size,
+            sessions: this.sessions.size,
+            memory: process.memoryUsage(),
+            heartbeat: {
+                intervalMs: HEARTBEAT_INTERVAL_MS,
+                sweeps: this.heartbeat.sweeps,
+                lastSweepAt: this.heartbeat.lastSweepAt,
+                lastSweepMs: this.heartbeat.lastSweepMs,
+                maxSweepMs: this.heartbeat.maxSweepMs,
+                lastSweepClients: this.heartbeat.lastSweepClients,
+                lastPongDrainMs: this.heartbeat.lastPongDrainMs
+            }
+        };
+    }
+
+    onHostRegister({ sessionId, peerId, resuming, resumeSecret }, fromShard) {
+        let session = this.sessions.get(sessionId);
+
+        if (resuming) {
+            // Só quem recebeu o segredo no register-ack retoma (e derruba a conexão antiga)
+            if (session && (session.hostPeerId !== peerId ||
+                            !resumeSecretMatches(session.hostSecret, resumeSecret))) {
+                return { ok: false, error: 'Peer ID já registrado' };
+            }
+            if (!session) {
+                // Servidor (ou worker) reiniciou: sessão recriada com o mesmo ID e segredo novo
+                if (!sessionId.startsWith(peerId + '_')) {
+                    return { ok: false, error: 'Sessão indisponível' };
+                }
+                session = this.createSession(peerId, sessionId);
+            } else if (session.hostShard !== null && session.hostShard !== fromShard) {
+                this.shards.send(session.hostShard, { kind: 'peer-replaced', peerId, sessionId });
+            }
+            session.isActive = true;
+            session.hostShard = fromShard;
             session.addLog({
-                type: type,
-                from: peerId,
-                to: remotePeerId
+                type: 'host_reconnected',
+                peerId: peerId
             });
+            return { ok: true, resumed: true, resumeSecret: session.hostSecret };
+        }
+
+        if (session) {
+            return { ok: false };
         }
 
-        console.log(`[Relay] ${type} de ${peerId} para ${remotePeerId}`);
+        session = this.createSession(peerId, sessionId);
+        session.hostShard = fromShard;
+        session.addLog({
+            type: 'host_registered',
+            peerId: peerId
+        });
+        return { ok: true, resumed: false, resumeSecret: session.hostSecret };
     }
 
-    handleDisconnect(ws) {
-        // Encontrar peer que desconectou
-        for (const [peerId, peer] of this.peers.entries()) {
-            if (peer.ws === ws) {
-                console.log(`[Desconexão] ${peerId} (${peer.role})`);
-
-                // Se era host, encerrar sessão
-                if (peer.role === 'host') {
-                    const session = this.sessions.get(peer.sessionId);
-                    if (session) {
-                        if (session.guestPeerId) {
-                            const guestPeer = this.peers.get(session.guestPeerId);
-                            if (guestPeer) {
-                                guestPeer.send({
-                                    type: 'host-disconnected'
-                                });
-                            }
-                        }
-                        session.isActive = false;
-                    }
+    onGuestJoin({ sessionId, peerId, resumeSecret }, fromShard, reply) {
+        const session = this.sessions.get(sessionId);
+        if (!session) {
+            reply({ ok: false, error: 'Sessão não encontrada' });
+            return;
+        }
+
+        if (session.guestPeerId !== null && session.guestPeerId !== peerId) {
+            reply({ ok: false, error: 'Sessão já tem guest' });
+            return;
+        }
+
+        if (session.guestPeerId === peerId) {
+            // Mesmo guest reconectando: só com o segredo do register-ack anterior
+            if (!resumeSecretMatches(session.guestSecret, resumeSecret)) {
+                reply({ ok: false, error: 'Peer ID já registrado' });
+                return;
+            }
+            if (session.guestShard !== null && session.guestShard !== fromShard) {
+                this.shards.send(session.guestShard, { kind: 'peer-replaced', peerId, sessionId });
+            }
+        } else {
+            session.guestSecret = crypto.randomBytes(RESUME_SECRET_BYTES).toString('hex');
+        }
+
+        session.guestPeerId = peerId;
+        session.guestShard = fromShard;
+        session.addLog({
+            type: 'guest_registered',
+            peerId: peerId
+        });
+
+        // register-ack do guest sai antes do guest-connected (o host responde com a oferta)
+        reply({ ok: true, hostPeerId: session.hostPeerId, hostShard: session.hostShard,
+                resumeSecret: session.guestSecret });
+
+        // Notificar host sobre novo guest (com o shard do guest para o relay direto)
+        if (session.hostShard !== null) {
+            this.shards.send(session.hostShard, {
+                kind: 'deliver',
+                notification: true,
+                peerId: session.hostPeerId,
+                remotePeerId: peerId,
+                remoteShard: fromShard,
+                payload: {
+                    type: 'guest-connected',
+                    guestPeerId: peerId
                 }
+            });
+        }
+    }
 
-                this.peers.delete(peerId);
-                break;
+    onPeerLeft({ sessionId, peerId, role }, fromShard) {
+        const session = this.sessions.get(sessionId);
+        if (!session) {
+            return;
+        }
+
+        // Se era host, encerrar sessão
+        if (role === 'host' && session.hostPeerId === peerId && session.hostShard === fromShard) {
+            session.hostShard = null;
+            session.isActive = false;
+            if (session.guestPeerId && session.guestShard !== null) {
+                this.shards.send(session.guestShard, {
+                    kind: 'deliver',
+                    notification: true,
+                    peerId: session.guestPeerId,
+                    payload: { type: 'host-disconnected' }
+                });
             }
+        } else if (role === 'guest' && session.guestPeerId === peerId && session.guestShard === fromShard) {
+            // Libera a vaga: o guest pode voltar (reconexão) ou outro entrar
+            session.guestPeerId = null;
+            session.guestShard = null;
         }
     }
 
+    onSessionRelay({ sessionId, remotePeerId, payload }) {
+        const session = this.sessions.get(sessionId);
+        const shard = !session ? null :
+            remotePeerId === session.hostPeerId ? session.hostShard :
+            remotePeerId === session.guestPeerId ? session.guestShard : null;
+        if (shard === null) {
+            console.warn(`[Relay Falhou] Peer remoto não encontrado: ${remotePeerId}`);
+            return;
+        }
+
+        this.shards.send(shard, { kind: 'deliver', peerId: remotePeerId, viaOwner: true, payload });
+        this.logRelay(sessionId, payload.type, payload.peerId, remotePeerId);
+    }
+
+    onDeliver({ peerId, sessionId, viaOwner, notification, remotePeerId, remoteShard, payload }) {
+        const peer = this.peers.get(peerId);
+        if (!peer) {
+            // Localização conhecida pelo remetente ficou velha (peer reconectou): dono da sessão.
+            // Aviso para quem já saiu (guest-connected, host-disconnected) só se perde
+            if (!viaOwner && sessionId) {
+                this.shards.send(this.ownerOf(sessionId), { kind: 'session-relay', sessionId, remotePeerId: peerId, payload });
+            } else if (!notification) {
+                console.warn(`[Relay Falhou] Peer remoto não encontrado: ${peerId}`);
+            }
+            return;
+        }
+
+        if (remoteShard !== undefined) {
+            peer.remotePeerId = remotePeerId;
+            peer.remoteShard = remoteShard;
+        }
+        peer.send(payload);
+    }
+
     start() {
         this.server.listen(this.port, '0.0.0.0', () => {
+            if (this.shardId !== 0) {
+                return;
+            }
             console.log(`
 ╔════════════════════════════════════════════════════════════╗
 ║   RemoteDeskCore Signaling Server                          ║
@@ -444,6 +869,7 @@ ICE Candidates:
 📡 Servidor Iniciado!
 
   WebSocket:  ws://0.0.0.0:${this.port}
+  Workers:    ${this.ring.shardCount}
   HTTP:       http://localhost:${this.port}
   Stats:      http://localhost:${this.port}/stats
 
@@ -472,18 +898,59 @@ Exemplo de conexão:
 // Inicializar e Executar
 // ═══════════════════════════════════════════════════════════════════════════════
 
-const server = new SignalingServer(PORT);
-server.start();
-
-// Graceful shutdown
-process.on('SIGTERM', () => {
-    console.log('\n[Info] SIGTERM recebido, encerrando...');
-    server.server.close();
-    process.exit(0);
-});
-
-process.on('SIGINT', () => {
-    console.log('\n[Info] Ctrl+C recebido, encerrando...');
-    server.server.close();
-    process.exit(0);
-});
+if (WORKERS > 1 && cluster.isPrimary) {
+    // Primário: cria um worker por shard e só repassa as mensagens entre eles.
+    // Worker que cai volta com o mesmo shard (o anel não muda); as sessões dele
+    // são recriadas quando os hosts se registram de novo
+    const workersByShard = new Array(WORKERS);
+    let shuttingDown = false;
+
+    const forkShard = (shardId) => {
+        const worker = cluster.fork({ SIGNALING_SHARD_ID: String(shardId) });
+        workersByShard[shardId] = worker;
+        worker.on('message', (envelope) => {
+            const target = workersByShard[envelope.to];
+            if (target && target.isConnected()) {
+                target.send(envelope);
+            }
+        });
+        worker.on('exit', (code, signal) => {
+            if (workersByShard[shardId] === worker && !shuttingDown) {
+                console.error(`[Cluster] Worker do shard ${shardId} saiu (${signal || code}), reiniciando`);
+                forkShard(shardId);
+            }
+        });
+    };
+
+    for (let shardId = 0; shardId < WORKERS; shardId++) {
+        forkShard(shardId);
+    }
+
+    const shutdown = (reason) => {
+        console.log(`\n[Info] ${reason}, encerrando...`);
+        shuttingDown = true;
+        for (const worker of workersByShard) {
+            worker.kill('SIGTERM');
+        }
+        process.exit(0);
+    };
+    process.on('SIGTERM', () => shutdown('SIGTERM recebido'));
+    process.on('SIGINT', () => shutdown('Ctrl+C recebido'));
+} else {
+    const shardId = cluster.isWorker ? parseInt(process.env.SIGNALING_SHARD_ID, 10) : 0;
+    const server = new SignalingServer(PORT, shardId, WORKERS);
+    server.start();
+
+    // Graceful shutdown
+    process.on('SIGTERM', () => {
+        console.log('\n[Info] SIGTERM recebido, encerrando...');
+        server.server.close();
+        process.exit(0);
+    });
+
+    process.on('SIGINT', () => {
+        console.log('\n[Info] Ctrl+C recebido, encerrando...');
+        server.server.close();
+        process.exit(0);
+    });
+}
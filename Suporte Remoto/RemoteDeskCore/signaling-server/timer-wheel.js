@@ -0,0 +1,78 @@
+/**
+ * @file timer-wheel.js
+ * @brief Roda de timers (hashed timing wheel) para expirar sessões por TTL
+ *
+ * Substitui a varredura de todas as sessões a cada 5 minutos: cada chave fica no
+ * slot do seu instante de expiração, e cada tick olha só um slot. TTLs maiores que
+ * uma volta da roda ficam no mesmo slot e são revistos a cada volta (uma vez por
+ * hora com os padrões), então o custo por tick é ~n / slotCount.
+ */
+
+/**
+ * @class TimerWheel
+ * schedule/cancel em O(1); onExpire(key) chamado no primeiro tick após expireAt
+ */
+class TimerWheel {
+    constructor(tickMs, slotCount, onExpire) {
+        this.tickMs = tickMs;
+        this.slotCount = slotCount;
+        this.onExpire = onExpire;
+        this.slots = Array.from({ length: slotCount }, () => new Map()); // key -> expireAt
+        this.slotByKey = new Map();
+        this.lastTick = Math.floor(Date.now() / tickMs);
+        this.timer = null;
+    }
+
+    get size() {
+        return this.slotByKey.size;
+    }
+
+    // Agenda (ou reagenda) a expiração de key
+    schedule(key, expireAt) {
+        this.cancel(key);
+        const tick = Math.max(Math.ceil(expireAt / this.tickMs), this.lastTick + 1);
+        const slot = tick % this.slotCount;
+        this.slots[slot].set(key, expireAt);
+        this.slotByKey.set(key, slot);
+    }
+
+    cancel(key) {
+        const slot = this.slotByKey.get(key);
+        if (slot !== undefined) {
+            this.slots[slot].delete(key);
+            this.slotByKey.delete(key);
+        }
+    }
+
+    // Processa os slots desde o último tick (no máximo uma volta se o loop atrasou)
+    advance(now = Date.now()) {
+        const nowTick = Math.floor(now / this.tickMs);
+        const firstTick = Math.max(this.lastTick + 1, nowTick - this.slotCount + 1);
+        this.lastTick = nowTick;
+
+        for (let tick = firstTick; tick <= nowTick; tick++) {
+            const entries = this.slots[tick % this.slotCount];
+            for (const [key, expireAt] of entries) {
+                if (expireAt <= now) {
+                    entries.delete(key);
+                    this.slotByKey.delete(key);
+                    this.onExpire(key);
+                }
+            }
+        }
+    }
+
+    start() {
+        if (!this.timer) {
+            this.timer = setInterval(() => this.advance(), this.tickMs);
+            this.timer.unref();
+        }
+    }
+
+    stop() {
+        clearInterval(this.timer);
+        this.timer = null;
+    }
+}
+
+module.exports = { TimerWheel };
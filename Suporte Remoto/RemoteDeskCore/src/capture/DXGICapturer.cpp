@@ -1,4 +1,5 @@
 #include "DXGICapturer.h"
+#include "Trace.h"
 #include <stdexcept>
 #include <cstring>
 
@@ -75,6 +76,8 @@ bool DXGICapturer::InitializeDirectX() {
     output->GetDesc(&outputDesc);
     m_screenWidth = outputDesc.DesktopCoordinates.right - outputDesc.DesktopCoordinates.left;
     m_screenHeight = outputDesc.DesktopCoordinates.bottom - outputDesc.DesktopCoordinates.top;
+    m_desktopLeft = outputDesc.DesktopCoordinates.left;
+    m_desktopTop = outputDesc.DesktopCoordinates.top;
     m_stride = m_screenWidth * 4; // BGRA
 
     // Obter Desktop Duplication
@@ -116,6 +119,8 @@ bool DXGICapturer::InitializeDirectX() {
 }
 
 bool DXGICapturer::AcquireFrame(FrameData& outFrame) {
+    RDC_TRACE_SCOPE("DXGICapturer::AcquireFrame");
+
     if (!m_desktopDuplication) {
         return false;
     }
@@ -144,6 +149,15 @@ bool DXGICapturer::AcquireFrame(FrameData& outFrame) {
         return false;
     }
 
+    UpdateCursor(frameInfo);
+
+    // Só o ponteiro mudou: nenhum byte de vídeo
+    if (frameInfo.LastPresentTime.QuadPart == 0) {
+        m_desktopDuplication->ReleaseFrame();
+        outFrame.hasChanged = false;
+        return true;
+    }
+
     // Converter recurso para Texture2D
     ComPtr<ID3D11Texture2D> screenTexture;
     hr = frameResource.As(&screenTexture);
@@ -180,6 +194,54 @@ bool DXGICapturer::AcquireFrame(FrameData& outFrame) {
     return true;
 }
 
+void DXGICapturer::UpdateCursor(const DXGI_OUTDUPL_FRAME_INFO& frameInfo) {
+    // Posição só vale quando houve atualização do mouse neste frame
+    if (frameInfo.LastMouseUpdateTime.QuadPart != 0) {
+        m_cursor.x = frameInfo.PointerPosition.Position.x;
+        m_cursor.y = frameInfo.PointerPosition.Position.y;
+        m_cursor.visible = frameInfo.PointerPosition.Visible != FALSE;
+    }
+
+    if (frameInfo.PointerShapeBufferSize == 0) {
+        return;
+    }
+
+    m_pointerShapeBuffer.resize(frameInfo.PointerShapeBufferSize);
+
+    UINT requiredSize = 0;
+    DXGI_OUTDUPL_POINTER_SHAPE_INFO shapeInfo = {};
+    HRESULT hr = m_desktopDuplication->GetFramePointerShape(
+        static_cast<UINT>(m_pointerShapeBuffer.size()),
+        m_pointerShapeBuffer.data(),
+        &requiredSize,
+        &shapeInfo
+    );
+
+    if (FAILED(hr)) {
+        OutputDebugStringA("GetFramePointerShape failed\n");
+        return;
+    }
+
+    if (ConvertCursorShape(static_cast<CursorShapeType>(shapeInfo.Type), shapeInfo.Width,
+                           shapeInfo.Height, shapeInfo.Pitch, m_pointerShapeBuffer.data(),
+                           requiredSize, shapeInfo.HotSpot.x, shapeInfo.HotSpot.y, m_cursorShape)) {
+        m_cursor.shapeHash = m_cursorShape.hash;
+    }
+}
+
+void DXGICapturer::PollCursorPosition() {
+    CURSORINFO cursorInfo = {};
+    cursorInfo.cbSize = sizeof(cursorInfo);
+    if (!GetCursorInfo(&cursorInfo)) {
+        return;
+    }
+
+    // Coordenadas do desktop virtual → coordenadas desta saída
+    m_cursor.x = cursorInfo.ptScreenPos.x - m_desktopLeft;
+    m_cursor.y = cursorInfo.ptScreenPos.y - m_desktopTop;
+    m_cursor.visible = (cursorInfo.flags & CURSOR_SHOWING) != 0;
+}
+
 bool DXGICapturer::CopyFrameToBuffer(ID3D11Texture2D* sourceTexture, FrameData& outFrame) {
     if (!sourceTexture || !m_stagingTexture) {
         return false;
@@ -0,0 +1,283 @@
+#include "ContentClassifier.h"
+#include "FrameUtils.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+namespace {
+
+// Amostragem: uma linha a cada 4, todos os pixels da linha (bordas de 1 px de glifos)
+constexpr uint32_t SAMPLE_ROW_STEP = 4;
+
+// Features
+constexpr uint32_t COLOR_QUANT_SHIFT = 5;           // 3 bits por canal → 512 cores
+constexpr int EDGE_LUMA_THRESHOLD = 64;             // Diferença de luminância entre vizinhos
+constexpr float CHANGE_RATE_ALPHA = 0.25f;          // Média móvel da mudança por tile
+
+// Regras de classificação
+constexpr uint32_t VIDEO_MIN_COLORS = 24;
+constexpr float VIDEO_MIN_CHANGE_RATE = 0.3f;
+constexpr uint32_t TEXT_MAX_COLORS = 48;
+constexpr float TEXT_MIN_EDGE_DENSITY = 0.04f;
+constexpr uint32_t MIN_VIDEO_TILES = 4;             // Região de vídeo menor que isso é ruído
+
+// Qualidade por classe (delta de QP: negativo = mais qualidade)
+constexpr int8_t QP_DELTA_TEXT = -6;
+constexpr int8_t QP_DELTA_UI = -2;
+constexpr int8_t QP_DELTA_VIDEO = 4;
+
+// Fps sugerido: vídeo precisa de fluidez; texto prefere bits por frame
+constexpr uint32_t VIDEO_FPS = 60;
+constexpr uint32_t TEXT_FPS = 30;
+constexpr uint32_t TEXT_DOMINANT_PERCENT = 25;
+
+inline int Luma(const uint8_t* bgra) {
+    return (bgra[2] * 77 + bgra[1] * 150 + bgra[0] * 29) >> 8;
+}
+
+int8_t QpDeltaFor(ContentClass contentClass) {
+    switch (contentClass) {
+        case ContentClass::TEXT: return QP_DELTA_TEXT;
+        case ContentClass::VIDEO: return QP_DELTA_VIDEO;
+        default: return QP_DELTA_UI;
+    }
+}
+
+} // namespace
+
+ContentClassifier::ContentClassifier(uint32_t tileSize)
+    : m_tileSize(std::max(16u, tileSize)) {
+}
+
+void ContentClassifier::Reset() {
+    m_previousFrame.clear();
+    m_features.clear();
+    m_map = ContentMap{};
+    m_width = 0;
+    m_height = 0;
+}
+
+const ContentMap& ContentClassifier::Classify(const uint8_t* pixels, uint32_t width,
+                                              uint32_t height, uint32_t stride) {
+    RDC_TRACE_SCOPE("ContentClassifier::Classify");
+
+    if (!pixels || width == 0 || height == 0) {
+        return m_map;
+    }
+
+    // Resolução nova: histórico temporal não vale mais
+    if (width != m_width || height != m_height ||
+        m_previousFrame.size() != static_cast<size_t>(stride) * height) {
+        Reset();
+        m_width = width;
+        m_height = height;
+        m_map.tileSize = m_tileSize;
+        m_map.tilesX = (width + m_tileSize - 1) / m_tileSize;
+        m_map.tilesY = (height + m_tileSize - 1) / m_tileSize;
+        m_features.resize(static_cast<size_t>(m_map.tilesX) * m_map.tilesY);
+    }
+
+    ComputeTileFeatures(pixels, width, height, stride);
+    UpdateChangeRates(pixels, width, height, stride);
+
+    const size_t tileCount = m_features.size();
+    m_map.classes.resize(tileCount);
+    m_map.qpDeltas.resize(tileCount);
+
+    for (size_t i = 0; i < tileCount; ++i) {
+        const TileFeatures& f = m_features[i];
+
+        // Mudança contínua que não parece texto rolando (poucas cores e muitas bordas)
+        bool textLike = f.edgeDensity >= TEXT_MIN_EDGE_DENSITY && f.colorCount <= TEXT_MAX_COLORS;
+        if (f.changeRate >= VIDEO_MIN_CHANGE_RATE && (f.colorCount >= VIDEO_MIN_COLORS || !textLike)) {
+            m_map.classes[i] = ContentClass::VIDEO;
+        } else if (textLike) {
+            m_map.classes[i] = ContentClass::TEXT;
+        } else {
+            m_map.classes[i] = ContentClass::UI;
+        }
+    }
+
+    FindVideoRect();
+
+    m_map.textTiles = 0;
+    m_map.uiTiles = 0;
+    m_map.videoTiles = 0;
+    for (size_t i = 0; i < tileCount; ++i) {
+        m_map.qpDeltas[i] = QpDeltaFor(m_map.classes[i]);
+        switch (m_map.classes[i]) {
+            case ContentClass::TEXT: m_map.textTiles++; break;
+            case ContentClass::VIDEO: m_map.videoTiles++; break;
+            default: m_map.uiTiles++; break;
+        }
+    }
+
+    if (!m_map.videoRect.IsEmpty()) {
+        m_map.suggestedFps = VIDEO_FPS;
+    } else if (m_map.textTiles * 100 >= tileCount * TEXT_DOMINANT_PERCENT) {
+        m_map.suggestedFps = TEXT_FPS;
+    } else {
+        m_map.suggestedFps = VIDEO_FPS;
+    }
+
+    return m_map;
+}
+
+void ContentClassifier::ComputeTileFeatures(const uint8_t* pixels, uint32_t width,
+                                            uint32_t height, uint32_t stride) {
+    std::bitset<512> colors;
+
+    for (uint32_t ty = 0; ty < m_map.tilesY; ++ty) {
+        const uint32_t y0 = ty * m_tileSize;
+        const uint32_t y1 = std::min(y0 + m_tileSize, height);
+
+        for (uint32_t tx = 0; tx < m_map.tilesX; ++tx) {
+            const uint32_t x0 = tx * m_tileSize;
+            const uint32_t x1 = std::min(x0 + m_tileSize, width);
+
+            colors.reset();
+            uint32_t edges = 0;
+            uint32_t pairs = 0;
+
+            for (uint32_t y = y0; y < y1; y += SAMPLE_ROW_STEP) {
+                const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+                int previousLuma = Luma(row + x0 * 4);
+
+                for (uint32_t x = x0; x < x1; ++x) {
+                    const uint8_t* p = row + x * 4;
+                    colors.set(((p[2] >> COLOR_QUANT_SHIFT) << 6) |
+                               ((p[1] >> COLOR_QUANT_SHIFT) << 3) |
+                               (p[0] >> COLOR_QUANT_SHIFT));
+
+                    int luma = Luma(p);
+                    int diff = luma - previousLuma;
+                    edges += (diff > EDGE_LUMA_THRESHOLD || diff < -EDGE_LUMA_THRESHOLD) ? 1 : 0;
+                    previousLuma = luma;
+                }
+                pairs += x1 - x0 - 1;
+            }
+
+            TileFeatures& f = m_features[static_cast<size_t>(ty) * m_map.tilesX + tx];
+            f.colorCount = static_cast<uint32_t>(colors.count());
+            f.edgeDensity = pairs ? static_cast<float>(edges) / pairs : 0.0f;
+        }
+    }
+}
+
+void ContentClassifier::UpdateChangeRates(const uint8_t* pixels, uint32_t width,
+                                          uint32_t height, uint32_t stride) {
+    const size_t frameBytes = static_cast<size_t>(stride) * height;
+
+    if (m_previousFrame.size() == frameBytes) {
+        DiffFrameTiles(m_previousFrame.data(), pixels, width, height, stride, m_tileSize, m_dirtyTiles);
+
+        for (size_t i = 0; i < m_features.size(); ++i) {
+            float dirty = m_dirtyTiles[i] ? 1.0f : 0.0f;
+            m_features[i].changeRate += CHANGE_RATE_ALPHA * (dirty - m_features[i].changeRate);
+        }
+    }
+
+    m_previousFrame.resize(frameBytes);
+    std::memcpy(m_previousFrame.data(), pixels, frameBytes);
+}
+
+void ContentClassifier::FindVideoRect() {
+    m_map.videoRect = FrameRect{};
+
+    const uint32_t tilesX = m_map.tilesX;
+    const uint32_t tilesY = m_map.tilesY;
+    std::vector<uint8_t> visited(m_map.classes.size(), 0);
+    std::vector<uint32_t> stack;
+
+    uint32_t bestSize = 0;
+    uint32_t bestMinX = 0, bestMinY = 0, bestMaxX = 0, bestMaxY = 0;
+
+    // Maior componente 4-conexo de tiles de vídeo
+    for (uint32_t start = 0; start < m_map.classes.size(); ++start) {
+        if (visited[start] || m_map.classes[start] != ContentClass::VIDEO) {
+            continue;
+        }
+
+        uint32_t size = 0;
+        uint32_t minX = tilesX, minY = tilesY, maxX = 0, maxY = 0;
+        stack.assign(1, start);
+        visited[start] = 1;
+
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+
+            uint32_t x = index % tilesX;
+            uint32_t y = index / tilesX;
+            size++;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+
+            auto visit = [&](uint32_t neighbor) {
+                if (!visited[neighbor] && m_map.classes[neighbor] == ContentClass::VIDEO) {
+                    visited[neighbor] = 1;
+                    stack.push_back(neighbor);
+                }
+            };
+            if (x > 0) visit(index - 1);
+            if (x + 1 < tilesX) visit(index + 1);
+            if (y > 0) visit(index - tilesX);
+            if (y + 1 < tilesY) visit(index + tilesX);
+        }
+
+        if (size > bestSize) {
+            bestSize = size;
+            bestMinX = minX;
+            bestMinY = minY;
+            bestMaxX = maxX;
+            bestMaxY = maxY;
+        }
+    }
+
+    // Tiles de vídeo fora da região principal voltam a ser UI (ruído: cursor, animações)
+    for (uint32_t i = 0; i < m_map.classes.size(); ++i) {
+        uint32_t x = i % tilesX;
+        uint32_t y = i / tilesX;
+        bool inside = bestSize >= MIN_VIDEO_TILES &&
+                      x >= bestMinX && x <= bestMaxX && y >= bestMinY && y <= bestMaxY;
+
+        if (inside) {
+            // Cenas escuras/estáticas dentro do player continuam sendo vídeo
+            m_map.classes[i] = ContentClass::VIDEO;
+        } else if (m_map.classes[i] == ContentClass::VIDEO) {
+            m_map.classes[i] = ContentClass::UI;
+        }
+    }
+
+    if (bestSize >= MIN_VIDEO_TILES) {
+        m_map.videoRect.x = bestMinX * m_tileSize;
+        m_map.videoRect.y = bestMinY * m_tileSize;
+        m_map.videoRect.width = std::min((bestMaxX + 1) * m_tileSize, m_width) - m_map.videoRect.x;
+        m_map.videoRect.height = std::min((bestMaxY + 1) * m_tileSize, m_height) - m_map.videoRect.y;
+    }
+}
+
+void ContentClassifier::BuildBlockQpMap(const ContentMap& map, uint32_t width, uint32_t height,
+                                        uint32_t blockSize, std::vector<int8_t>& outBlockDeltas) {
+    if (map.tileSize == 0 || blockSize == 0 || map.qpDeltas.empty()) {
+        outBlockDeltas.clear();
+        return;
+    }
+
+    const uint32_t blocksX = (width + blockSize - 1) / blockSize;
+    const uint32_t blocksY = (height + blockSize - 1) / blockSize;
+    outBlockDeltas.resize(static_cast<size_t>(blocksX) * blocksY);
+
+    for (uint32_t by = 0; by < blocksY; ++by) {
+        uint32_t ty = std::min((by * blockSize + blockSize / 2) / map.tileSize, map.tilesY - 1);
+        for (uint32_t bx = 0; bx < blocksX; ++bx) {
+            uint32_t tx = std::min((bx * blockSize + blockSize / 2) / map.tileSize, map.tilesX - 1);
+            outBlockDeltas[static_cast<size_t>(by) * blocksX + bx] =
+                map.qpDeltas[static_cast<size_t>(ty) * map.tilesX + tx];
+        }
+    }
+}
@@ -0,0 +1,305 @@
+#include "FrameScaler.h"
+#include "PlatformCompat.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RDC_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define RDC_HAVE_SSE2 0
+#endif
+
+namespace {
+
+// Pesos de 8 bits: p0 * (256 - w) + p1 * w cabe em 16 bits sem sinal
+constexpr uint32_t WEIGHT_SHIFT = 8;
+constexpr uint32_t WEIGHT_ONE = 1u << WEIGHT_SHIFT;
+constexpr uint32_t WEIGHT_ROUND = WEIGHT_ONE / 2;
+
+inline uint8_t Lerp(uint32_t a, uint32_t b, uint32_t weight) {
+    return static_cast<uint8_t>((a * (WEIGHT_ONE - weight) + b * weight + WEIGHT_ROUND) >> WEIGHT_SHIFT);
+}
+
+// Interpolação vertical de count bytes entre duas linhas
+void BlendRows(const uint8_t* row0, const uint8_t* row1, uint8_t* out, size_t count,
+               uint32_t weight, bool useSimd) {
+    size_t i = 0;
+
+#if RDC_HAVE_SSE2
+    if (useSimd) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i w1 = _mm_set1_epi16(static_cast<short>(weight));
+        const __m128i w0 = _mm_set1_epi16(static_cast<short>(WEIGHT_ONE - weight));
+        const __m128i round = _mm_set1_epi16(static_cast<short>(WEIGHT_ROUND));
+
+        for (; i + 16 <= count; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i));
+
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+                                       _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+                                       _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, round), WEIGHT_SHIFT);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, round), WEIGHT_SHIFT);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+        }
+    }
+#else
+    (void)useSimd;
+#endif
+
+    for (; i < count; ++i) {
+        out[i] = Lerp(row0[i], row1[i], weight);
+    }
+}
+
+inline uint32_t Load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+bool FrameScaler::HasSimd() {
+    return RDC_HAVE_SSE2 != 0;
+}
+
+bool FrameScaler::Configure(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth,
+                            uint32_t dstHeight, ScaleFilter filter) {
+    m_dstWidth = 0;
+
+    if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) {
+        return false;
+    }
+
+    const bool exactHalf = srcWidth == dstWidth * 2 && srcHeight == dstHeight * 2;
+    if (filter == ScaleFilter::AUTO) {
+        filter = exactHalf ? ScaleFilter::BOX : ScaleFilter::BILINEAR;
+    } else if (filter == ScaleFilter::BOX && !exactHalf) {
+        OutputDebugStringA("FrameScaler: box filter requires an exact 2:1 ratio\n");
+        return false;
+    }
+
+    m_srcWidth = srcWidth;
+    m_srcHeight = srcHeight;
+    m_filter = filter;
+
+    if (filter == ScaleFilter::BILINEAR) {
+        // Amostragem nos centros dos pixels, passo em ponto fixo 16.16
+        auto buildAxis = [](uint32_t srcSize, uint32_t dstSize,
+                            std::vector<uint32_t>& outIndex, std::vector<uint16_t>& outWeight) {
+            const uint64_t step = (static_cast<uint64_t>(srcSize) << 16) / dstSize;
+            const int64_t origin = static_cast<int64_t>(step / 2) - 0x8000;
+            const int64_t maxPos = static_cast<int64_t>(srcSize - 1) << 16;
+
+            outIndex.resize(dstSize);
+            outWeight.resize(dstSize);
+            for (uint32_t i = 0; i < dstSize; ++i) {
+                int64_t pos = std::clamp(origin + static_cast<int64_t>(i * step), int64_t(0), maxPos);
+                outIndex[i] = static_cast<uint32_t>(pos >> 16);
+                outWeight[i] = static_cast<uint16_t>((pos & 0xFFFF) >> (16 - WEIGHT_SHIFT));
+            }
+        };
+
+        std::vector<uint32_t> srcX;
+        buildAxis(srcWidth, dstWidth, srcX, m_weightX);
+        buildAxis(srcHeight, dstHeight, m_srcY, m_weightY);
+
+        m_srcOffsetX.resize(dstWidth);
+        m_nextOffsetX.resize(dstWidth);
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            m_srcOffsetX[x] = srcX[x] * 4;
+            m_nextOffsetX[x] = std::min(srcX[x] + 1, srcWidth - 1) * 4;
+        }
+
+        m_rowBuffer.resize(static_cast<size_t>(srcWidth) * 4);
+    }
+
+    m_dstWidth = dstWidth;
+    m_dstHeight = dstHeight;
+    return true;
+}
+
+void FrameScaler::Scale(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride) {
+    FrameRect all;
+    all.width = m_dstWidth;
+    all.height = m_dstHeight;
+    ScaleRegion(src, srcStride, dst, dstStride, all);
+}
+
+void FrameScaler::ScaleRegion(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride,
+                              const FrameRect& dstRect) {
+    RDC_TRACE_SCOPE("FrameScaler::Scale");
+
+    if (!IsConfigured() || !src || !dst) {
+        return;
+    }
+
+    // Recortar ao destino
+    FrameRect rect = dstRect;
+    rect.x = std::min(rect.x, m_dstWidth);
+    rect.y = std::min(rect.y, m_dstHeight);
+    rect.width = std::min(rect.width, m_dstWidth - rect.x);
+    rect.height = std::min(rect.height, m_dstHeight - rect.y);
+    if (rect.IsEmpty()) {
+        return;
+    }
+
+    if (m_filter == ScaleFilter::BOX) {
+        ScaleBoxRows(src, srcStride, dst, dstStride, rect);
+    } else {
+        ScaleBilinearRows(src, srcStride, dst, dstStride, rect);
+    }
+}
+
+void FrameScaler::ScaleBoxRows(const uint8_t* src, uint32_t srcStride, uint8_t* dst, uint32_t dstStride,
+                               const FrameRect& rect) const {
+    for (uint32_t dy = rect.y; dy < rect.y + rect.height; ++dy) {
+        const uint8_t* row0 = src + static_cast<size_t>(dy) * 2 * srcStride;
+        const uint8_t* row1 = row0 + srcStride;
+        uint8_t* out = dst + static_cast<size_t>(dy) * dstStride;
+
+        uint32_t dx = rect.x;
+        const uint32_t endX = rect.x + rect.width;
+
+#if RDC_HAVE_SSE2
+        if (m_useSimd) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+
+            // 8 pixels de origem (2 linhas) → 4 pixels de destino
+            for (; dx + 4 <= endX; dx += 4) {
+                const uint8_t* s0 = row0 + static_cast<size_t>(dx) * 8;
+                const uint8_t* s1 = row1 + static_cast<size_t>(dx) * 8;
+
+                __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0));
+                __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 16));
+                __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1));
+                __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 16));
+
+                // Soma vertical em 16 bits: v0 = (p0, p1), v1 = (p2, p3), ...
+                __m128i v0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+                __m128i v1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+                __m128i v2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+                __m128i v3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+                // Soma horizontal dos pares: (p0 + p1, p2 + p3)
+                __m128i r01 = _mm_add_epi16(_mm_unpacklo_epi64(v0, v1), _mm_unpackhi_epi64(v0, v1));
+                __m128i r23 = _mm_add_epi16(_mm_unpacklo_epi64(v2, v3), _mm_unpackhi_epi64(v2, v3));
+
+                r01 = _mm_srli_epi16(_mm_add_epi16(r01, two), 2);
+                r23 = _mm_srli_epi16(_mm_add_epi16(r23, two), 2);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + static_cast<size_t>(dx) * 4),
+                                 _mm_packus_epi16(r01, r23));
+            }
+        }
+#endif
+
+        for (; dx < endX; ++dx) {
+            const uint8_t* s0 = row0 + static_cast<size_t>(dx) * 8;
+            const uint8_t* s1 = row1 + static_cast<size_t>(dx) * 8;
+            uint8_t* p = out + static_cast<size_t>(dx) * 4;
+            for (int c = 0; c < 4; ++c) {
+                p[c] = static_cast<uint8_t>((s0[c] + s0[c + 4] + s1[c] + s1[c + 4] + 2) >> 2);
+            }
+        }
+    }
+}
+
+void FrameScaler::ScaleBilinearRows(const uint8_t* src, uint32_t srcStride, uint8_t* dst,
+                                    uint32_t dstStride, const FrameRect& rect) {
+    const uint32_t endX = rect.x + rect.width;
+
+    // Faixa de bytes da origem usada pelas colunas do retângulo
+    const uint32_t firstByte = m_srcOffsetX[rect.x];
+    const uint32_t lastByte = m_nextOffsetX[endX - 1] + 4;
+
+    for (uint32_t dy = rect.y; dy < rect.y + rect.height; ++dy) {
+        const uint32_t sy = m_srcY[dy];
+        const uint32_t wy = m_weightY[dy];
+        const uint8_t* row0 = src + static_cast<size_t>(sy) * srcStride;
+
+        // Passo vertical: linha intermediária (ou a própria linha quando o peso é 0)
+        const uint8_t* row = row0;
+        if (wy != 0) {
+            const uint8_t* row1 = src + static_cast<size_t>(std::min(sy + 1, m_srcHeight - 1)) * srcStride;
+            BlendRows(row0 + firstByte, row1 + firstByte, m_rowBuffer.data() + firstByte,
+                      lastByte - firstByte, wy, m_useSimd);
+            row = m_rowBuffer.data();
+        }
+
+        uint8_t* out = dst + static_cast<size_t>(dy) * dstStride;
+        uint32_t dx = rect.x;
+
+#if RDC_HAVE_SSE2
+        if (m_useSimd) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i one = _mm_set1_epi16(static_cast<short>(WEIGHT_ONE));
+            const __m128i round = _mm_set1_epi16(static_cast<short>(WEIGHT_ROUND));
+
+            // 2 pixels de destino por iteração (4 canais x 16 bits cada)
+            for (; dx + 2 <= endX; dx += 2) {
+                __m128i p0 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(Load32(row + m_srcOffsetX[dx]))),
+                                                _mm_cvtsi32_si128(static_cast<int>(Load32(row + m_srcOffsetX[dx + 1]))));
+                __m128i p1 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(Load32(row + m_nextOffsetX[dx]))),
+                                                _mm_cvtsi32_si128(static_cast<int>(Load32(row + m_nextOffsetX[dx + 1]))));
+                p0 = _mm_unpacklo_epi8(p0, zero);
+                p1 = _mm_unpacklo_epi8(p1, zero);
+
+                const short wa = static_cast<short>(m_weightX[dx]);
+                const short wb = static_cast<short>(m_weightX[dx + 1]);
+                __m128i w1 = _mm_set_epi16(wb, wb, wb, wb, wa, wa, wa, wa);
+                __m128i w0 = _mm_sub_epi16(one, w1);
+
+                __m128i sum = _mm_add_epi16(_mm_mullo_epi16(p0, w0), _mm_mullo_epi16(p1, w1));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, round), WEIGHT_SHIFT);
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + static_cast<size_t>(dx) * 4),
+                                 _mm_packus_epi16(sum, zero));
+            }
+        }
+#endif
+
+        for (; dx < endX; ++dx) {
+            const uint8_t* p0 = row + m_srcOffsetX[dx];
+            const uint8_t* p1 = row + m_nextOffsetX[dx];
+            const uint32_t wx = m_weightX[dx];
+            uint8_t* p = out + static_cast<size_t>(dx) * 4;
+            for (int c = 0; c < 4; ++c) {
+                p[c] = Lerp(p0[c], p1[c], wx);
+            }
+        }
+    }
+}
+
+FrameRect FrameScaler::MapSourceRect(const FrameRect& srcRect) const {
+    FrameRect out;
+    if (!IsConfigured() || srcRect.IsEmpty()) {
+        return out;
+    }
+
+    // Expande 1 pixel de origem para cobrir o vizinho do filtro bilinear
+    const uint32_t margin = m_filter == ScaleFilter::BOX ? 0 : 1;
+    const uint64_t sx0 = srcRect.x > margin ? srcRect.x - margin : 0;
+    const uint64_t sy0 = srcRect.y > margin ? srcRect.y - margin : 0;
+    const uint64_t sx1 = std::min<uint64_t>(static_cast<uint64_t>(srcRect.x) + srcRect.width + margin, m_srcWidth);
+    const uint64_t sy1 = std::min<uint64_t>(static_cast<uint64_t>(srcRect.y) + srcRect.height + margin, m_srcHeight);
+
+    const uint32_t dx0 = static_cast<uint32_t>(sx0 * m_dstWidth / m_srcWidth);
+    const uint32_t dy0 = static_cast<uint32_t>(sy0 * m_dstHeight / m_srcHeight);
+    const uint32_t dx1 = static_cast<uint32_t>(std::min<uint64_t>((sx1 * m_dstWidth + m_srcWidth - 1) / m_srcWidth, m_dstWidth));
+    const uint32_t dy1 = static_cast<uint32_t>(std::min<uint64_t>((sy1 * m_dstHeight + m_srcHeight - 1) / m_srcHeight, m_dstHeight));
+
+    out.x = dx0;
+    out.y = dy0;
+    out.width = dx1 > dx0 ? dx1 - dx0 : 0;
+    out.height = dy1 > dy0 ? dy1 - dy0 : 0;
+    return out;
+}
@@ -0,0 +1,132 @@
+#include "FrameUtils.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Mistura de 8 bytes por passo (multiplicação + rotação), bem mais rápida que FNV byte a byte
+constexpr uint64_t TILE_HASH_SEED = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t TILE_HASH_MULTIPLIER = 0xFF51AFD7ED558CCDull;
+
+inline uint64_t MixTileWord(uint64_t hash, uint64_t word) {
+    hash ^= word;
+    hash *= TILE_HASH_MULTIPLIER;
+    return (hash << 29) | (hash >> 35);
+}
+
+} // namespace
+
+void CopyFrameRows(uint8_t* dst, size_t dstPitch,
+                   const uint8_t* src, size_t srcStride,
+                   size_t rowBytes, uint32_t height) {
+    if (!dst || !src || height == 0) {
+        return;
+    }
+
+    // Buffers contíguos: uma única cópia
+    if (dstPitch == rowBytes && srcStride == rowBytes) {
+        std::memcpy(dst, src, rowBytes * height);
+        return;
+    }
+
+    for (uint32_t y = 0; y < height; ++y) {
+        std::memcpy(dst + (y * dstPitch), src + (y * srcStride), rowBytes);
+    }
+}
+
+uint32_t DiffFrameTiles(const uint8_t* previous, const uint8_t* current,
+                        uint32_t width, uint32_t height, uint32_t stride,
+                        uint32_t tileSize, std::vector<uint8_t>& outDirtyTiles) {
+    if (tileSize == 0) {
+        outDirtyTiles.clear();
+        return 0;
+    }
+
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+    outDirtyTiles.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+
+    if (!previous || !current) {
+        std::fill(outDirtyTiles.begin(), outDirtyTiles.end(), 1);
+        return tilesX * tilesY;
+    }
+
+    uint32_t dirtyCount = 0;
+
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY) {
+        uint8_t* rowFlags = outDirtyTiles.data() + static_cast<size_t>(tileY) * tilesX;
+        const uint32_t yBegin = tileY * tileSize;
+        const uint32_t yEnd = std::min(yBegin + tileSize, height);
+        uint32_t cleanRemaining = tilesX;
+
+        // Linha a linha para manter o acesso sequencial em memória
+        for (uint32_t y = yBegin; y < yEnd && cleanRemaining > 0; ++y) {
+            const uint8_t* prevRow = previous + static_cast<size_t>(y) * stride;
+            const uint8_t* curRow = current + static_cast<size_t>(y) * stride;
+
+            for (uint32_t tileX = 0; tileX < tilesX; ++tileX) {
+                if (rowFlags[tileX]) {
+                    continue;
+                }
+
+                const uint32_t xBegin = tileX * tileSize;
+                const uint32_t xEnd = std::min(xBegin + tileSize, width);
+                const size_t offset = static_cast<size_t>(xBegin) * 4;
+                const size_t bytes = static_cast<size_t>(xEnd - xBegin) * 4;
+
+                if (std::memcmp(prevRow + offset, curRow + offset, bytes) != 0) {
+                    rowFlags[tileX] = 1;
+                    --cleanRemaining;
+                    ++dirtyCount;
+                }
+            }
+        }
+    }
+
+    return dirtyCount;
+}
+
+void HashFrameTiles(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                    uint32_t tileSize, std::vector<uint64_t>& outHashes) {
+    if (tileSize == 0 || !pixels) {
+        outHashes.clear();
+        return;
+    }
+
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+    outHashes.assign(static_cast<size_t>(tilesX) * tilesY, TILE_HASH_SEED);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        uint64_t* rowHashes = outHashes.data() + static_cast<size_t>(y / tileSize) * tilesX;
+
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX) {
+            const uint32_t xBegin = tileX * tileSize;
+            const uint32_t xEnd = std::min(xBegin + tileSize, width);
+            const uint8_t* bytes = row + static_cast<size_t>(xBegin) * 4;
+            const size_t count = static_cast<size_t>(xEnd - xBegin) * 4;
+
+            uint64_t hash = rowHashes[tileX];
+            size_t offset = 0;
+            for (; offset + 8 <= count; offset += 8) {
+                uint64_t word;
+                std::memcpy(&word, bytes + offset, sizeof(word));
+                hash = MixTileWord(hash, word);
+            }
+            if (offset < count) {
+                uint32_t tail;  // Largura ímpar: sobra um pixel
+                std::memcpy(&tail, bytes + offset, sizeof(tail));
+                hash = MixTileWord(hash, tail);
+            }
+            rowHashes[tileX] = hash;
+        }
+    }
+
+    // Finalização: os bits altos da mistura também chegam aos baixos
+    for (uint64_t& hash : outHashes) {
+        hash ^= hash >> 33;
+        hash *= TILE_HASH_MULTIPLIER;
+        hash ^= hash >> 33;
+    }
+}
@@ -0,0 +1,250 @@
+#include "LatencyProbe.h"
+
+#include <algorithm>
+
+namespace {
+
+// Layout do marcador: guarda branca, guarda preta, 12 bits de id (MSB primeiro),
+// paridade par, guarda branca
+constexpr uint32_t MARKER_CELLS = 16;
+constexpr uint32_t MARKER_DATA_BITS = 12;
+constexpr uint32_t MARKER_FIRST_DATA_CELL = 2;
+constexpr uint32_t MARKER_PARITY_CELL = MARKER_FIRST_DATA_CELL + MARKER_DATA_BITS;
+
+// Célula = largura / 120 (16 px em 1080p, 10,67 px no degrau 720p). As bordas
+// são fracionárias para o marcador escalar junto com o frame
+constexpr double CELLS_PER_WIDTH = 120.0;
+constexpr double MIN_CELL_SIZE = 4.0;
+
+constexpr uint32_t LUMA_THRESHOLD = 128;
+
+// Espalha os probes em 0..16 ms além do intervalo para não travar na fase do vsync
+constexpr uint32_t PROBE_SPREAD_STEPS = 17;
+constexpr uint64_t PROBE_SPREAD_STEP_US = 1000;
+
+// Depois de gravado, o id segue nos frames seguintes só por esta janela: cobre a
+// perda de alguns frames sem deixar o marcador preso na tela
+constexpr uint64_t PROBE_STAMP_WINDOW_US = 200000;
+
+double CellSize(uint32_t width) {
+    return std::max(MIN_CELL_SIZE, width / CELLS_PER_WIDTH);
+}
+
+uint32_t CellEdge(double cell, uint32_t index) {
+    return static_cast<uint32_t>(cell * index + 0.5);
+}
+
+bool MarkerFits(uint32_t width, uint32_t height) {
+    const double cell = CellSize(width);
+    return CellEdge(cell, MARKER_CELLS) <= width && CellEdge(cell, 1) <= height;
+}
+
+bool CellBit(uint16_t probeId, uint32_t cell) {
+    if (cell == 0 || cell == MARKER_CELLS - 1) {
+        return true;
+    }
+    if (cell == 1) {
+        return false;
+    }
+    if (cell == MARKER_PARITY_CELL) {
+        uint32_t ones = 0;
+        for (uint32_t bit = 0; bit < MARKER_DATA_BITS; ++bit) {
+            ones += (probeId >> bit) & 1;
+        }
+        return (ones & 1) != 0;
+    }
+    const uint32_t bit = MARKER_DATA_BITS - 1 - (cell - MARKER_FIRST_DATA_CELL);
+    return ((probeId >> bit) & 1) != 0;
+}
+
+} // namespace
+
+void LatencyHistogram::Record(double latencyMs) {
+    latencyMs = std::max(0.0, latencyMs);
+
+    size_t bucket = 0;
+    while (bucket < LATENCY_BUCKETS_MS.size() && latencyMs > LATENCY_BUCKETS_MS[bucket]) {
+        ++bucket;
+    }
+    m_buckets[bucket]++;
+
+    m_minMs = m_count == 0 ? latencyMs : std::min(m_minMs, latencyMs);
+    m_maxMs = std::max(m_maxMs, latencyMs);
+    m_sumMs += latencyMs;
+    m_count++;
+}
+
+void LatencyHistogram::Reset() {
+    *this = LatencyHistogram();
+}
+
+double LatencyHistogram::Percentile(double fraction) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+
+    const double target = std::clamp(fraction, 0.0, 1.0) * m_count;
+    double cumulative = 0.0;
+
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        if (m_buckets[i] == 0) {
+            continue;
+        }
+
+        double lower = i == 0 ? 0.0 : LATENCY_BUCKETS_MS[i - 1];
+        double upper = i < LATENCY_BUCKETS_MS.size() ? LATENCY_BUCKETS_MS[i] : m_maxMs;
+        lower = std::max(lower, m_minMs);
+        upper = std::min(upper, m_maxMs);
+
+        if (cumulative + m_buckets[i] >= target) {
+            double position = (target - cumulative) / m_buckets[i];
+            return lower + (upper - lower) * position;
+        }
+        cumulative += m_buckets[i];
+    }
+
+    return m_maxMs;
+}
+
+bool StampProbeMarker(uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                      uint16_t probeId) {
+    if (!pixels || probeId == 0 || probeId > PROBE_MAX_ID || !MarkerFits(width, height)) {
+        return false;
+    }
+
+    const double cell = CellSize(width);
+    const uint32_t cellHeight = CellEdge(cell, 1);
+    for (uint32_t y = 0; y < cellHeight; ++y) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        for (uint32_t c = 0; c < MARKER_CELLS; ++c) {
+            const uint8_t value = CellBit(probeId, c) ? 0xFF : 0x00;
+            uint8_t* p = row + static_cast<size_t>(CellEdge(cell, c)) * 4;
+            for (uint32_t x = CellEdge(cell, c); x < CellEdge(cell, c + 1); ++x, p += 4) {
+                p[0] = value;
+                p[1] = value;
+                p[2] = value;
+                p[3] = 0xFF;
+            }
+        }
+    }
+    return true;
+}
+
+bool ReadProbeMarker(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                     uint16_t& outProbeId) {
+    if (!pixels || !MarkerFits(width, height)) {
+        return false;
+    }
+
+    // Centro de cada célula (longe das bordas borradas pelo downscale)
+    const double cell = CellSize(width);
+    const uint8_t* row = pixels + static_cast<size_t>(cell / 2) * stride;
+
+    uint16_t probeId = 0;
+    for (uint32_t c = 0; c < MARKER_CELLS; ++c) {
+        const uint8_t* p = row + static_cast<size_t>((c + 0.5) * cell) * 4;
+        const bool bit = (static_cast<uint32_t>(p[0]) + p[1] + p[2]) / 3 >= LUMA_THRESHOLD;
+
+        if (c >= MARKER_FIRST_DATA_CELL && c < MARKER_PARITY_CELL) {
+            probeId = static_cast<uint16_t>((probeId << 1) | (bit ? 1 : 0));
+        } else if (c != MARKER_PARITY_CELL && bit != CellBit(0, c)) {
+            return false;   // Guarda não confere
+        }
+
+        if (c == MARKER_PARITY_CELL && bit != CellBit(probeId, c)) {
+            return false;
+        }
+    }
+
+    if (probeId == 0) {
+        return false;
+    }
+
+    outProbeId = probeId;
+    return true;
+}
+
+void LatencyProbeHost::OnProbe(const LatencyProbeMessage& message, uint64_t nowUs) {
+    if (message.probeId == 0 || message.probeId > PROBE_MAX_ID) {
+        return;
+    }
+
+    m_pendingId = message.probeId;
+    m_pendingMode = message.mode == static_cast<uint8_t>(ProbeMode::PIXEL_CHANGE)
+        ? ProbeMode::PIXEL_CHANGE : ProbeMode::MARKER;
+    m_pendingSinceUs = nowUs;
+    m_currentId = 0;
+}
+
+bool LatencyProbeHost::NeedsFrame() const {
+    return m_pendingId != 0 && m_pendingMode == ProbeMode::MARKER;
+}
+
+void LatencyProbeHost::StampFrame(uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                                  bool frameChanged, uint64_t nowUs) {
+    if (m_pendingId != 0) {
+        if (m_pendingMode == ProbeMode::MARKER || frameChanged) {
+            m_currentId = m_pendingId;
+            m_currentSinceUs = nowUs;
+            m_pendingId = 0;
+        } else if (nowUs - m_pendingSinceUs > m_pixelChangeTimeoutUs) {
+            m_pendingId = 0;    // A tela não reagiu: o cliente conta timeout
+        }
+    } else if (m_currentId != 0 && nowUs - m_currentSinceUs > PROBE_STAMP_WINDOW_US) {
+        m_currentId = 0;        // Probe já entregue: o frame volta a ser só a tela
+    }
+
+    if (m_currentId != 0) {
+        StampProbeMarker(pixels, width, height, stride, m_currentId);
+    }
+}
+
+LatencyProbeClient::LatencyProbeClient(ProbeMode mode, uint16_t virtualKey,
+                                       uint32_t intervalMs, uint32_t timeoutMs)
+    : m_mode(mode),
+      m_virtualKey(virtualKey),
+      m_intervalUs(static_cast<uint64_t>(intervalMs) * 1000),
+      m_timeoutUs(static_cast<uint64_t>(timeoutMs) * 1000) {
+}
+
+bool LatencyProbeClient::ShouldSend(uint64_t nowUs, LatencyProbeMessage& outMessage) {
+    if (m_pendingId != 0) {
+        if (nowUs - m_pendingSentUs < m_timeoutUs) {
+            return false;
+        }
+        m_pendingId = 0;
+        m_stats.probesTimedOut++;
+    }
+
+    const uint64_t spreadUs = (m_nextId * 7u % PROBE_SPREAD_STEPS) * PROBE_SPREAD_STEP_US;
+    if (m_hasSent && nowUs - m_lastSentUs < m_intervalUs + spreadUs) {
+        return false;
+    }
+
+    m_pendingId = m_nextId;
+    m_nextId = m_nextId == PROBE_MAX_ID ? 1 : m_nextId + 1;
+    m_pendingSentUs = nowUs;
+    m_lastSentUs = nowUs;
+    m_hasSent = true;
+    m_stats.probesSent++;
+
+    outMessage = {};
+    outMessage.probeId = m_pendingId;
+    outMessage.virtualKey = m_virtualKey;
+    outMessage.mode = static_cast<uint8_t>(m_mode);
+    return true;
+}
+
+bool LatencyProbeClient::OnFramePresented(const uint8_t* pixels, uint32_t width, uint32_t height,
+                                          uint32_t stride, uint64_t nowUs) {
+    uint16_t probeId;
+    if (m_pendingId == 0 || !ReadProbeMarker(pixels, width, height, stride, probeId) ||
+        probeId != m_pendingId) {
+        return false;
+    }
+
+    m_histogram.Record((nowUs - m_pendingSentUs) / 1000.0);
+    m_pendingId = 0;
+    m_stats.probesCompleted++;
+    return true;
+}
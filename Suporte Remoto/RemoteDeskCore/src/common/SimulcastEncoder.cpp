@@ -0,0 +1,206 @@
+#include "SimulcastEncoder.h"
+#include "PlatformCompat.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+constexpr uint32_t MIN_LAYER_KBPS = 50;     // Passo do ABR
+
+uint32_t LayerBitrateKbps(uint32_t topKbps, const SimulcastLayerConfig& config) {
+    return std::max(MIN_LAYER_KBPS, static_cast<uint32_t>(std::lround(topKbps * config.bitrateShare)));
+}
+
+// Da menor para a maior; BuildDefaultSimulcastLayers pega as últimas layerCount
+const SimulcastLayerConfig DEFAULT_LAYERS[MAX_SIMULCAST_LAYERS] = {
+    { 8, 0.06 },
+    { 4, 0.15 },
+    { 2, 0.35 },
+    { 1, 1.00 },
+};
+
+} // namespace
+
+std::vector<SimulcastLayerConfig> BuildDefaultSimulcastLayers(uint32_t layerCount) {
+    layerCount = std::clamp<uint32_t>(layerCount, 1, MAX_SIMULCAST_LAYERS);
+    return std::vector<SimulcastLayerConfig>(DEFAULT_LAYERS + (MAX_SIMULCAST_LAYERS - layerCount),
+                                             DEFAULT_LAYERS + MAX_SIMULCAST_LAYERS);
+}
+
+SimulcastEncoder::SimulcastEncoder(std::vector<std::unique_ptr<IVideoEncoder>> encoders,
+                                   std::vector<SimulcastLayerConfig> layers) {
+    size_t count = std::min({ encoders.size(), layers.size(), static_cast<size_t>(MAX_SIMULCAST_LAYERS) });
+    m_layers.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        m_layers[i].config = layers[i];
+        m_layers[i].config.scaleDivisor = std::max<uint32_t>(1, layers[i].scaleDivisor);
+        m_layers[i].encoder = std::move(encoders[i]);
+    }
+}
+
+bool SimulcastEncoder::Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps) {
+    if (m_layers.empty() || width == 0 || height == 0) {
+        OutputDebugStringA("SimulcastEncoder: sem camadas ou dimensoes invalidas\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        if (!layer.encoder) {
+            OutputDebugStringA("SimulcastEncoder: camada sem encoder\n");
+            return false;
+        }
+
+        layer.width = std::max<uint32_t>(1, width / layer.config.scaleDivisor);
+        layer.height = std::max<uint32_t>(1, height / layer.config.scaleDivisor);
+        layer.scaleFrom = -1;
+        layer.pixels.clear();
+
+        if (layer.width != width || layer.height != height) {
+            // Cascata: reduz a partir da próxima camada maior quando a razão é exatamente 2 (box)
+            uint32_t srcWidth = width;
+            uint32_t srcHeight = height;
+            for (size_t j = i + 1; j < m_layers.size(); ++j) {
+                if (layer.config.scaleDivisor == 2 * m_layers[j].config.scaleDivisor &&
+                    m_layers[j].config.scaleDivisor > 1) {
+                    layer.scaleFrom = static_cast<int32_t>(j);
+                    srcWidth = width / m_layers[j].config.scaleDivisor;
+                    srcHeight = height / m_layers[j].config.scaleDivisor;
+                    break;
+                }
+            }
+            if (!layer.scaler.Configure(srcWidth, srcHeight, layer.width, layer.height)) {
+                OutputDebugStringA("SimulcastEncoder: falha ao configurar o downscale\n");
+                return false;
+            }
+            layer.pixels.resize(static_cast<size_t>(layer.width) * layer.height * BYTES_PER_PIXEL);
+        }
+
+        if (!layer.encoder->Initialize(layer.width, layer.height,
+                                       LayerBitrateKbps(targetBitrateKbps, layer.config))) {
+            OutputDebugStringA("SimulcastEncoder: falha ao inicializar o encoder da camada\n");
+            return false;
+        }
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+bool SimulcastEncoder::EncodeLayers(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                                    uint32_t stride, std::vector<EncodedFrame>& outFrames,
+                                    uint32_t keyframeLayerMask) {
+    RDC_TRACE_SCOPE("SimulcastEncoder::EncodeLayers");
+
+    if (!m_initialized || !bgraPixels) {
+        return false;
+    }
+
+    // Downscale de cima para baixo (a cascata lê a camada maior já reduzida)
+    for (size_t i = m_layers.size(); i-- > 0;) {
+        Layer& layer = m_layers[i];
+        if (layer.pixels.empty()) {
+            continue;
+        }
+        if (layer.scaleFrom >= 0) {
+            const Layer& source = m_layers[layer.scaleFrom];
+            layer.scaler.Scale(source.pixels.data(), source.width * BYTES_PER_PIXEL,
+                               layer.pixels.data(), layer.width * BYTES_PER_PIXEL);
+        } else {
+            layer.scaler.Scale(bgraPixels, stride, layer.pixels.data(), layer.width * BYTES_PER_PIXEL);
+        }
+    }
+
+    outFrames.resize(m_layers.size());
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        bool forceKeyframe = (keyframeLayerMask >> i) & 1;
+        bool encoded = layer.pixels.empty()
+            ? layer.encoder->EncodeFrame(bgraPixels, width, height, stride, outFrames[i], forceKeyframe)
+            : layer.encoder->EncodeFrame(layer.pixels.data(), layer.width, layer.height,
+                                         layer.width * BYTES_PER_PIXEL, outFrames[i], forceKeyframe);
+        if (!encoded) {
+            return false;
+        }
+        outFrames[i].layerId = static_cast<uint8_t>(i);
+    }
+    return true;
+}
+
+bool SimulcastEncoder::EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
+                                   uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe) {
+    uint32_t mask = forceKeyframe ? (1u << m_layers.size()) - 1 : 0;
+    if (!EncodeLayers(bgraPixels, width, height, stride, m_scratch, mask) || m_scratch.empty()) {
+        return false;
+    }
+    outFrame = std::move(m_scratch.back());
+    return true;
+}
+
+bool SimulcastEncoder::EndEncode(std::vector<EncodedFrame>& outFrames) {
+    outFrames.clear();
+    bool ok = true;
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        std::vector<EncodedFrame> layerFrames;
+        if (!m_layers[i].encoder || !m_layers[i].encoder->EndEncode(layerFrames)) {
+            ok = false;
+            continue;
+        }
+        for (EncodedFrame& frame : layerFrames) {
+            frame.layerId = static_cast<uint8_t>(i);
+            outFrames.push_back(std::move(frame));
+        }
+    }
+    return ok;
+}
+
+void SimulcastEncoder::SetTargetBitrate(uint32_t kbps) {
+    for (Layer& layer : m_layers) {
+        if (layer.encoder) {
+            layer.encoder->SetTargetBitrate(LayerBitrateKbps(kbps, layer.config));
+        }
+    }
+}
+
+void SimulcastEncoder::SetContentMap(const ContentMap& map) {
+    // O mapa está na resolução da captura: só a camada de cima usa
+    if (!m_layers.empty() && m_layers.back().encoder && m_layers.back().pixels.empty()) {
+        m_layers.back().encoder->SetContentMap(map);
+    }
+}
+
+IVideoEncoder::EncoderStats SimulcastEncoder::GetStats() const {
+    EncoderStats total;
+    for (const Layer& layer : m_layers) {
+        if (!layer.encoder) {
+            continue;
+        }
+        EncoderStats stats = layer.encoder->GetStats();
+        total.totalFramesEncoded += stats.totalFramesEncoded;
+        total.totalBytesEncoded += stats.totalBytesEncoded;
+        total.averageBitrate += stats.averageBitrate;
+        total.keyframeInterval = stats.keyframeInterval;
+    }
+    return total;
+}
+
+void SimulcastEncoder::Release() {
+    for (Layer& layer : m_layers) {
+        if (layer.encoder) {
+            layer.encoder->Release();
+        }
+    }
+    m_initialized = false;
+}
+
+uint32_t SimulcastEncoder::GetLayerWidth(uint32_t layer) const {
+    return layer < m_layers.size() ? m_layers[layer].width : 0;
+}
+
+uint32_t SimulcastEncoder::GetLayerHeight(uint32_t layer) const {
+    return layer < m_layers.size() ? m_layers[layer].height : 0;
+}
@@ -0,0 +1,153 @@
+#include "TextInput.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint16_t VK_RETURN_CODE = 0x0D;
+constexpr uint16_t VK_TAB_CODE = 0x09;
+
+constexpr uint32_t MAX_CODE_POINT = 0x10FFFF;
+
+bool IsContinuation(uint8_t byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+bool IsHighSurrogate(uint16_t unit) {
+    return unit >= 0xD800 && unit <= 0xDBFF;
+}
+
+// Decodifica um code point a partir de utf8[i]; avança i. false = sequência inválida
+// (i avança o máximo de bytes que ainda podiam pertencer a ela)
+bool DecodeCodePoint(const uint8_t* utf8, size_t size, size_t& i, uint32_t& outCodePoint) {
+    const uint8_t lead = utf8[i++];
+    if (lead < 0x80) {
+        outCodePoint = lead;
+        return true;
+    }
+
+    size_t length;
+    uint32_t minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 1;
+        minimum = 0x80;
+        outCodePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 2;
+        minimum = 0x800;
+        outCodePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 3;
+        minimum = 0x10000;
+        outCodePoint = lead & 0x07;
+    } else {
+        return false;       // Continuação solta ou byte inválido
+    }
+
+    for (size_t k = 0; k < length; ++k) {
+        if (i >= size || !IsContinuation(utf8[i])) {
+            return false;   // Truncada: o próximo byte começa outro caractere
+        }
+        outCodePoint = (outCodePoint << 6) | (utf8[i++] & 0x3F);
+    }
+
+    // Overlong, surrogate codificado ou fora do Unicode
+    return outCodePoint >= minimum && outCodePoint <= MAX_CODE_POINT &&
+           (outCodePoint < 0xD800 || outCodePoint > 0xDFFF);
+}
+
+void AppendUtf16(uint32_t codePoint, std::vector<uint16_t>& out) {
+    if (codePoint < 0x10000) {
+        out.push_back(static_cast<uint16_t>(codePoint));
+        return;
+    }
+    codePoint -= 0x10000;
+    out.push_back(static_cast<uint16_t>(0xD800 + (codePoint >> 10)));
+    out.push_back(static_cast<uint16_t>(0xDC00 + (codePoint & 0x3FF)));
+}
+
+void AppendKeyPair(uint16_t code, bool isVirtualKey, std::vector<TextKeyStroke>& out) {
+    out.push_back({ code, isVirtualKey, false });
+    out.push_back({ code, isVirtualKey, true });
+}
+
+} // namespace
+
+size_t Utf8ToUtf16(const char* utf8, size_t size, std::vector<uint16_t>& outUtf16) {
+    outUtf16.clear();
+    if (!utf8) {
+        return 0;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(utf8);
+    outUtf16.reserve(size);
+
+    size_t invalid = 0;
+    size_t i = 0;
+    while (i < size) {
+        uint32_t codePoint;
+        if (!DecodeCodePoint(bytes, size, i, codePoint)) {
+            codePoint = TEXT_REPLACEMENT_CHAR;
+            invalid++;
+        }
+        AppendUtf16(codePoint, outUtf16);
+    }
+
+    return invalid;
+}
+
+size_t BuildTextKeyStrokes(const char* utf8, size_t size, std::vector<TextKeyStroke>& outStrokes) {
+    std::vector<uint16_t> utf16;
+    size_t invalid = Utf8ToUtf16(utf8, size, utf16);
+
+    outStrokes.reserve(outStrokes.size() + utf16.size() * 2);
+
+    for (size_t i = 0; i < utf16.size(); ++i) {
+        const uint16_t unit = utf16[i];
+
+        if (unit == '\r') {
+            // "\r\n" é uma quebra só; '\r' sozinho também vira Enter
+            if (i + 1 < utf16.size() && utf16[i + 1] == '\n') {
+                ++i;
+            }
+            AppendKeyPair(VK_RETURN_CODE, true, outStrokes);
+        } else if (unit == '\n') {
+            AppendKeyPair(VK_RETURN_CODE, true, outStrokes);
+        } else if (unit == '\t') {
+            AppendKeyPair(VK_TAB_CODE, true, outStrokes);
+        } else if (unit < 0x20 || unit == 0x7F) {
+            continue;       // Outros controles não têm efeito útil como texto
+        } else {
+            AppendKeyPair(unit, false, outStrokes);
+        }
+    }
+
+    return invalid;
+}
+
+size_t NextTextChunkEnd(const std::vector<TextKeyStroke>& strokes, size_t begin, size_t maxStrokes) {
+    if (begin >= strokes.size()) {
+        return strokes.size();
+    }
+
+    // Par surrogate = 4 entradas; um bloco precisa caber ao menos um caractere
+    maxStrokes = std::max<size_t>(maxStrokes, 4);
+
+    size_t end = std::min(strokes.size(), begin + maxStrokes);
+    if (end == strokes.size()) {
+        return end;
+    }
+
+    // Nunca termina entre down e up
+    if (end > begin && !strokes[end - 1].keyUp) {
+        --end;
+    }
+
+    // Nem logo após a metade alta de um surrogate (down/up da alta, depois a baixa)
+    if (end >= 2 && end - 2 >= begin && !strokes[end - 1].isVirtualKey &&
+        IsHighSurrogate(strokes[end - 1].code)) {
+        end -= 2;
+    }
+
+    return end;
+}
@@ -0,0 +1,389 @@
+/**
+ * @file Trace.cpp
+ * @brief Ring buffers por thread e exportação Chrome JSON / Perfetto protobuf
+ *
+ * Hot path (Record): stores relaxed no slot entre dois contadores da thread, o de
+ * gravações iniciadas e o de concluídas (seqlock; em x86 são movs simples). A
+ * exportação copia sem pausar o tracer e descarta os slots que uma gravação
+ * iniciada durante a cópia pode ter reescrito. O registro global só é tocado na
+ * primeira gravação de cada thread.
+ */
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define RDC_GETPID _getpid
+#else
+#include <unistd.h>
+#define RDC_GETPID getpid
+#endif
+
+std::atomic<bool> PipelineTracer::s_enabled{ false };
+
+namespace {
+
+// Campos atômicos: a exportação lê o slot enquanto a thread dona pode reescrevê-lo
+struct TraceSlot {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<uint64_t> startNs{ 0 };
+    std::atomic<uint64_t> durationNs{ 0 };
+};
+
+struct ThreadRing {
+    std::array<TraceSlot, PipelineTracer::RING_CAPACITY> slots;
+    std::atomic<uint64_t> startCount{ 0 };      // Gravações iniciadas (slot pode estar pela metade)
+    std::atomic<uint64_t> writeCount{ 0 };      // Gravações concluídas
+    std::atomic<uint64_t> clearCount{ 0 };      // Clear(): índices abaixo não são exportados
+    uint32_t ordinal = 0;
+    char name[32] = {};                         // Sob o mutex do registro
+};
+
+struct ThreadSnapshot {
+    uint32_t ordinal;
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+};
+
+TraceRegistry& GetRegistry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+const std::chrono::steady_clock::time_point g_traceOrigin = std::chrono::steady_clock::now();
+
+thread_local ThreadRing* t_ring = nullptr;
+
+ThreadRing* GetThreadRing() {
+    if (t_ring) {
+        return t_ring;
+    }
+
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto ring = std::make_unique<ThreadRing>();
+    ring->ordinal = static_cast<uint32_t>(registry.rings.size()) + 1;
+    std::snprintf(ring->name, sizeof(ring->name), "Thread %u", ring->ordinal);
+
+    t_ring = ring.get();
+    registry.rings.push_back(std::move(ring));
+    return t_ring;
+}
+
+// Copia o conteúdo válido de cada ring sem parar as threads. O slot do índice i só
+// é reescrito pela gravação i + RING_CAPACITY: se ela já tinha começado ao fim da
+// cópia (startCount), o evento copiado pode estar misturado e é descartado.
+std::vector<ThreadSnapshot> SnapshotRings() {
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::vector<ThreadSnapshot> snapshots;
+    snapshots.reserve(registry.rings.size());
+
+    for (const auto& ring : registry.rings) {
+        uint64_t count = ring->writeCount.load(std::memory_order_acquire);
+        uint64_t first = count - std::min<uint64_t>(count, PipelineTracer::RING_CAPACITY);
+        first = std::max(first, ring->clearCount.load(std::memory_order_acquire));
+
+        ThreadSnapshot snapshot;
+        snapshot.ordinal = ring->ordinal;
+        snapshot.name = ring->name;
+        snapshot.events.reserve(static_cast<size_t>(count - first));
+
+        for (uint64_t i = first; i < count; ++i) {
+            const TraceSlot& slot = ring->slots[i % PipelineTracer::RING_CAPACITY];
+            snapshot.events.push_back({ slot.name.load(std::memory_order_relaxed),
+                                        slot.startNs.load(std::memory_order_relaxed),
+                                        slot.durationNs.load(std::memory_order_relaxed) });
+        }
+
+        // Par do fence release do Record: um slot lido de uma gravação nova garante
+        // que o startCount dela aparece aqui
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t started = ring->startCount.load(std::memory_order_relaxed);
+        if (started > first + PipelineTracer::RING_CAPACITY) {
+            uint64_t overwritten = std::min<uint64_t>(started - PipelineTracer::RING_CAPACITY - first,
+                                                      snapshot.events.size());
+            snapshot.events.erase(snapshot.events.begin(),
+                                  snapshot.events.begin() + static_cast<std::ptrdiff_t>(overwritten));
+        }
+
+        snapshots.push_back(std::move(snapshot));
+    }
+
+    return snapshots;
+}
+
+void AppendJsonString(std::string& out, const char* text) {
+    out.push_back('"');
+    for (const char* p = text; *p != '\0'; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+// ===== Encoder protobuf mínimo (apenas o necessário para perfetto.protos.Trace) =====
+
+class ProtoWriter {
+public:
+    void Varint(uint64_t value) {
+        while (value >= 0x80) {
+            m_buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    void Tag(uint32_t field, uint32_t wireType) { Varint((field << 3) | wireType); }
+
+    void UInt(uint32_t field, uint64_t value) {
+        Tag(field, 0);
+        Varint(value);
+    }
+
+    void Bytes(uint32_t field, const void* data, size_t size) {
+        Tag(field, 2);
+        Varint(size);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    void String(uint32_t field, const std::string& value) { Bytes(field, value.data(), value.size()); }
+
+    void Message(uint32_t field, const ProtoWriter& nested) {
+        Bytes(field, nested.m_buffer.data(), nested.m_buffer.size());
+    }
+
+    const std::vector<uint8_t>& Data() const { return m_buffer; }
+
+private:
+    std::vector<uint8_t> m_buffer;
+};
+
+// Números de campo de perfetto/protos (trace_packet.proto, track_event.proto, ...)
+constexpr uint32_t TRACE_PACKET = 1;
+constexpr uint32_t PACKET_TIMESTAMP = 8;
+constexpr uint32_t PACKET_SEQUENCE_ID = 10;
+constexpr uint32_t PACKET_TRACK_EVENT = 11;
+constexpr uint32_t PACKET_SEQUENCE_FLAGS = 13;
+constexpr uint32_t PACKET_TRACK_DESCRIPTOR = 60;
+constexpr uint32_t TRACK_DESCRIPTOR_UUID = 1;
+constexpr uint32_t TRACK_DESCRIPTOR_THREAD = 4;
+constexpr uint32_t THREAD_PID = 1;
+constexpr uint32_t THREAD_TID = 2;
+constexpr uint32_t THREAD_NAME = 5;
+constexpr uint32_t TRACK_EVENT_TYPE = 9;
+constexpr uint32_t TRACK_EVENT_TRACK_UUID = 11;
+constexpr uint32_t TRACK_EVENT_NAME = 23;
+constexpr uint64_t TYPE_SLICE_BEGIN = 1;
+constexpr uint64_t TYPE_SLICE_END = 2;
+constexpr uint64_t SEQ_INCREMENTAL_STATE_CLEARED = 1;
+constexpr uint64_t SEQ_NEEDS_INCREMENTAL_STATE = 2;
+constexpr uint32_t SEQUENCE_ID = 1;
+
+void AppendSlicePacket(ProtoWriter& trace, uint64_t uuid, uint64_t timestampNs,
+                       uint64_t type, const char* name) {
+    ProtoWriter event;
+    event.UInt(TRACK_EVENT_TYPE, type);
+    event.UInt(TRACK_EVENT_TRACK_UUID, uuid);
+    if (name) {
+        event.String(TRACK_EVENT_NAME, name);
+    }
+
+    ProtoWriter packet;
+    packet.UInt(PACKET_TIMESTAMP, timestampNs);
+    packet.UInt(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+    packet.UInt(PACKET_SEQUENCE_FLAGS, SEQ_NEEDS_INCREMENTAL_STATE);
+    packet.Message(PACKET_TRACK_EVENT, event);
+
+    trace.Message(TRACE_PACKET, packet);
+}
+
+bool WriteFile(const std::string& path, const void* data, size_t size) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return file.good();
+}
+
+} // namespace
+
+void PipelineTracer::SetThreadName(const char* name) {
+    if (!name) {
+        return;
+    }
+    ThreadRing* ring = GetThreadRing();
+    std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+    std::snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+void PipelineTracer::Record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadRing* ring = GetThreadRing();
+
+    // Só esta thread escreve nos contadores do ring
+    uint64_t index = ring->writeCount.load(std::memory_order_relaxed);
+    ring->startCount.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceSlot& slot = ring->slots[index % RING_CAPACITY];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs > startNs ? endNs - startNs : 0, std::memory_order_relaxed);
+
+    ring->writeCount.store(index + 1, std::memory_order_release);
+}
+
+uint64_t PipelineTracer::NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_traceOrigin).count());
+}
+
+bool PipelineTracer::WriteTrace(const std::string& path) {
+    const std::string jsonExt = ".json";
+    if (path.size() >= jsonExt.size() &&
+        path.compare(path.size() - jsonExt.size(), jsonExt.size(), jsonExt) == 0) {
+        return WriteChromeJson(path);
+    }
+    return WritePerfetto(path);
+}
+
+bool PipelineTracer::WriteChromeJson(const std::string& path) {
+    std::vector<ThreadSnapshot> snapshots = SnapshotRings();
+    int pid = static_cast<int>(RDC_GETPID());
+
+    std::string out;
+    out.reserve(4096);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    char numbers[128];
+
+    for (const auto& thread : snapshots) {
+        // Metadado com o nome da thread
+        std::snprintf(numbers, sizeof(numbers),
+                      "{\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":",
+                      pid, thread.ordinal);
+        if (!first) out += ",\n";
+        first = false;
+        out += numbers;
+        AppendJsonString(out, thread.name.c_str());
+        out += "}}";
+
+        for (const auto& event : thread.events) {
+            out += ",\n{\"ph\":\"X\",\"name\":";
+            AppendJsonString(out, event.name);
+            std::snprintf(numbers, sizeof(numbers),
+                          ",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                          pid, thread.ordinal,
+                          event.startNs / 1000.0, event.durationNs / 1000.0);
+            out += numbers;
+        }
+    }
+
+    out += "\n]}\n";
+    return WriteFile(path, out.data(), out.size());
+}
+
+bool PipelineTracer::WritePerfetto(const std::string& path) {
+    std::vector<ThreadSnapshot> snapshots = SnapshotRings();
+    int pid = static_cast<int>(RDC_GETPID());
+
+    ProtoWriter trace;
+
+    // Primeiro pacote da sequência: limpa estado incremental
+    {
+        ProtoWriter packet;
+        packet.UInt(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+        packet.UInt(PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+        trace.Message(TRACE_PACKET, packet);
+    }
+
+    for (auto& thread : snapshots) {
+        uint64_t uuid = thread.ordinal;
+
+        ProtoWriter threadDesc;
+        threadDesc.UInt(THREAD_PID, static_cast<uint64_t>(pid));
+        threadDesc.UInt(THREAD_TID, thread.ordinal);
+        threadDesc.String(THREAD_NAME, thread.name);
+
+        ProtoWriter trackDesc;
+        trackDesc.UInt(TRACK_DESCRIPTOR_UUID, uuid);
+        trackDesc.Message(TRACK_DESCRIPTOR_THREAD, threadDesc);
+
+        ProtoWriter packet;
+        packet.UInt(PACKET_SEQUENCE_ID, SEQUENCE_ID);
+        packet.Message(PACKET_TRACK_DESCRIPTOR, trackDesc);
+        trace.Message(TRACE_PACKET, packet);
+
+        // Eventos são gravados no fim do scope (internos antes dos externos);
+        // reordenar para emitir BEGIN/END aninhados corretamente.
+        std::sort(thread.events.begin(), thread.events.end(),
+                  [](const TraceEvent& a, const TraceEvent& b) {
+                      if (a.startNs != b.startNs) return a.startNs < b.startNs;
+                      return a.durationNs > b.durationNs;
+                  });
+
+        std::vector<uint64_t> openEnds;
+        for (const auto& event : thread.events) {
+            while (!openEnds.empty() && openEnds.back() <= event.startNs) {
+                AppendSlicePacket(trace, uuid, openEnds.back(), TYPE_SLICE_END, nullptr);
+                openEnds.pop_back();
+            }
+
+            AppendSlicePacket(trace, uuid, event.startNs, TYPE_SLICE_BEGIN, event.name);
+
+            // Eventos que ultrapassam o pai (ring sobrescrito) são truncados
+            uint64_t endNs = event.startNs + event.durationNs;
+            if (!openEnds.empty()) {
+                endNs = std::min(endNs, openEnds.back());
+            }
+            openEnds.push_back(endNs);
+        }
+
+        while (!openEnds.empty()) {
+            AppendSlicePacket(trace, uuid, openEnds.back(), TYPE_SLICE_END, nullptr);
+            openEnds.pop_back();
+        }
+    }
+
+    return WriteFile(path, trace.Data().data(), trace.Data().size());
+}
+
+void PipelineTracer::Clear() {
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // Os contadores são da thread dona; zerá-los daqui perderia gravações em andamento
+    for (auto& ring : registry.rings) {
+        ring->clearCount.store(ring->writeCount.load(std::memory_order_acquire), std::memory_order_release);
+    }
+}
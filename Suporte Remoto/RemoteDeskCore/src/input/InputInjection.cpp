@@ -0,0 +1,87 @@
+#include "InputInjection.h"
+
+bool RemoteInputHandler::HandleBatch(const uint8_t* payload, size_t size) {
+    if (!DecodeInputBatch(payload, size, m_batch)) {
+        m_stats.batchesMalformed++;
+        return false;
+    }
+
+    // Lote atrasado/duplicado: injetar fora de ordem trocaria teclas e botões
+    if (m_hasSequence && static_cast<int32_t>(m_batch.sequence - m_nextSequence) < 0) {
+        m_stats.batchesStale++;
+        return false;
+    }
+    m_nextSequence = m_batch.sequence + 1;
+    m_hasSequence = true;
+
+    // Estado injetado só com o que o backend aceitou: um lote recusado (ex: SendInput
+    // bloqueado) não deixa tecla "pressionada" que o host nunca viu
+    uint32_t accepted = m_injector.InjectEvents(m_batch.events.data(), m_batch.events.size());
+    for (uint32_t i = 0; i < accepted; ++i) {
+        m_injectedState.Apply(m_batch.events[i]);
+    }
+
+    // Lote anterior perdido (ex: key-up): o estado do cliente corrige o host
+    if (m_batch.hasState) {
+        uint64_t timestampUs = m_batch.events.empty() ? 0 : m_batch.events.back().timestampUs;
+        Reconcile(m_batch.state, timestampUs);
+    }
+
+    m_stats.batchesInjected++;
+    m_stats.eventsInjected += accepted;
+    m_stats.eventsRejected += m_batch.events.size() - accepted;
+    return true;
+}
+
+void RemoteInputHandler::Reconcile(const InputPressedState& target, uint64_t timestampUs) {
+    m_fixups.clear();
+
+    // Soltar antes de pressionar (atalhos: modificador preso + tecla nova)
+    for (uint16_t virtualKey : m_injectedState.keys) {
+        if (!target.IsKeyPressed(virtualKey)) {
+            m_fixups.push_back(InputEvent::Key(virtualKey, false, timestampUs));
+        }
+    }
+    for (uint8_t button = 0; button <= static_cast<uint8_t>(InputMouseButton::X2); ++button) {
+        uint8_t bit = static_cast<uint8_t>(1u << button);
+        if ((m_injectedState.buttons & bit) && !(target.buttons & bit)) {
+            m_fixups.push_back(InputEvent::MouseButton(static_cast<InputMouseButton>(button), false, timestampUs));
+        }
+    }
+    for (uint16_t virtualKey : target.keys) {
+        if (!m_injectedState.IsKeyPressed(virtualKey)) {
+            m_fixups.push_back(InputEvent::Key(virtualKey, true, timestampUs));
+        }
+    }
+    for (uint8_t button = 0; button <= static_cast<uint8_t>(InputMouseButton::X2); ++button) {
+        uint8_t bit = static_cast<uint8_t>(1u << button);
+        if (!(m_injectedState.buttons & bit) && (target.buttons & bit)) {
+            m_fixups.push_back(InputEvent::MouseButton(static_cast<InputMouseButton>(button), true, timestampUs));
+        }
+    }
+
+    if (m_fixups.empty()) {
+        return;
+    }
+
+    uint32_t accepted = m_injector.InjectEvents(m_fixups.data(), m_fixups.size());
+    for (uint32_t i = 0; i < accepted; ++i) {
+        m_injectedState.Apply(m_fixups[i]);
+    }
+    m_stats.eventsReconciled += accepted;
+}
+
+void RemoteInputHandler::Reset() {
+    // Nada fica preso do cliente anterior
+    Reconcile(InputPressedState(), 0);
+    m_hasSequence = false;
+    m_nextSequence = 0;
+}
+
+bool RemoteInputHandler::InjectKeyTap(uint16_t virtualKey, uint64_t timestampUs) {
+    const InputEvent tap[2] = {
+        InputEvent::Key(virtualKey, true, timestampUs),
+        InputEvent::Key(virtualKey, false, timestampUs)
+    };
+    return m_injector.InjectEvents(tap, 2) == 2;
+}
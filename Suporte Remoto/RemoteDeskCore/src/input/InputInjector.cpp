@@ -1,7 +1,16 @@
 #include "InputInjector.h"
+#include "TextInput.h"
+#include <algorithm>
 #include <thread>
 #include <cstring>
 
+namespace {
+
+// Pausa entre blocos de texto (ms)
+constexpr uint32_t TEXT_CHUNK_PAUSE_MS = 5;
+
+} // namespace
+
 InputInjector::InputInjector() {
 }
 
@@ -89,51 +98,108 @@ bool InputInjector::InjectText(const char* text) {
         return false;
     }
 
-    for (const char* p = text; *p != '\0'; ++p) {
-        char c = *p;
-
-        // Suportar caracteres ASCII básicos
-        // Para caracteres especiais, usar ShiftState appropriadamente
-        INPUT inputs[2] = {};
-        inputs[0].type = INPUT_KEYBOARD;
-        inputs[1].type = INPUT_KEYBOARD;
+    // UTF-8 → pares down/up KEYEVENTF_UNICODE (independe do layout e do Shift)
+    m_textStrokes.clear();
+    if (BuildTextKeyStrokes(text, std::strlen(text), m_textStrokes) > 0) {
+        OutputDebugStringA("InjectText: invalid UTF-8 replaced with U+FFFD\n");
+    }
 
-        // Determinar se precisa de Shift
-        bool needsShift = isupper(c) || strchr("!@#$%^&*()", c) != nullptr;
+    for (size_t begin = 0; begin < m_textStrokes.size();) {
+        size_t end = NextTextChunkEnd(m_textStrokes, begin, TEXT_MAX_CHUNK_STROKES);
+
+        m_batchInputs.assign(end - begin, INPUT{});
+        for (size_t i = begin; i < end; ++i) {
+            const TextKeyStroke& stroke = m_textStrokes[i];
+            INPUT& input = m_batchInputs[i - begin];
+            input.type = INPUT_KEYBOARD;
+
+            if (stroke.isVirtualKey) {
+                input.ki.wVk = stroke.code;
+                input.ki.dwFlags = stroke.keyUp ? KEYEVENTF_KEYUP : 0;
+            } else {
+                input.ki.wScan = stroke.code;
+                input.ki.dwFlags = KEYEVENTF_UNICODE | (stroke.keyUp ? KEYEVENTF_KEYUP : 0);
+            }
+        }
 
-        if (needsShift) {
-            inputs[0].ki.wVk = VK_SHIFT;
-            inputs[0].ki.dwFlags = 0;
+        UINT sent = SendInput(static_cast<UINT>(m_batchInputs.size()), m_batchInputs.data(), sizeof(INPUT));
+        if (sent != m_batchInputs.size()) {
+            OutputDebugStringA("SendInput (text) blocked or partially injected\n");
+            return false;
+        }
 
-            inputs[1].ki.wVk = VkKeyScanA(c) & 0xFF;
-            inputs[1].ki.dwFlags = 0;
+        begin = end;
 
-            if (SendInput(2, inputs, sizeof(INPUT)) == 0) {
-                return false;
-            }
+        // Entre blocos a aplicação de destino esvazia a fila de mensagens
+        if (begin < m_textStrokes.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(m_inputDelayMs, TEXT_CHUNK_PAUSE_MS)));
+        }
+    }
 
-            // Release shift
-            inputs[0].ki.dwFlags = KEYEVENTF_KEYUP;
-            inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
-            SendInput(2, inputs, sizeof(INPUT));
-        } else {
-            inputs[0].ki.wVk = VkKeyScanA(c) & 0xFF;
-            inputs[0].ki.dwFlags = 0;
+    return true;
+}
 
-            inputs[1].ki.wVk = VkKeyScanA(c) & 0xFF;
-            inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+uint32_t InputInjector::InjectEvents(const InputEvent* events, size_t count) {
+    if (!m_initialized || !events || count == 0) {
+        return 0;
+    }
 
-            if (SendInput(2, inputs, sizeof(INPUT)) == 0) {
-                return false;
+    m_batchInputs.assign(count, INPUT{});
+
+    for (size_t i = 0; i < count; ++i) {
+        const InputEvent& event = events[i];
+        INPUT& input = m_batchInputs[i];
+
+        switch (event.type) {
+        case InputEventType::MOUSE_MOVE:
+            // Coordenadas do protocolo já estão na escala 0-65535 do ABSOLUTE
+            input.type = INPUT_MOUSE;
+            input.mi.dx = event.x;
+            input.mi.dy = event.y;
+            input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE;
+            break;
+
+        case InputEventType::MOUSE_BUTTON:
+            input.type = INPUT_MOUSE;
+            switch (event.button) {
+            case InputMouseButton::LEFT:
+                input.mi.dwFlags = event.pressed ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+                break;
+            case InputMouseButton::RIGHT:
+                input.mi.dwFlags = event.pressed ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+                break;
+            case InputMouseButton::MIDDLE:
+                input.mi.dwFlags = event.pressed ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+                break;
+            case InputMouseButton::X1:
+            case InputMouseButton::X2:
+                input.mi.dwFlags = event.pressed ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+                input.mi.mouseData = event.button == InputMouseButton::X1 ? XBUTTON1 : XBUTTON2;
+                break;
             }
+            break;
+
+        case InputEventType::MOUSE_WHEEL:
+            input.type = INPUT_MOUSE;
+            input.mi.mouseData = static_cast<DWORD>(event.wheelDelta);
+            input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+            break;
+
+        case InputEventType::KEY:
+            input.type = INPUT_KEYBOARD;
+            input.ki.wVk = event.virtualKey;
+            input.ki.wScan = static_cast<WORD>(MapVirtualKeyA(event.virtualKey, MAPVK_VK_TO_VSC));
+            input.ki.dwFlags = event.pressed ? 0 : KEYEVENTF_KEYUP;
+            break;
         }
+    }
 
-        if (m_inputDelayMs > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(m_inputDelayMs));
-        }
+    UINT sent = SendInput(static_cast<UINT>(m_batchInputs.size()), m_batchInputs.data(), sizeof(INPUT));
+    if (sent != m_batchInputs.size()) {
+        OutputDebugStringA("SendInput (batch) blocked or partially injected\n");
     }
 
-    return true;
+    return sent;
 }
 
 bool InputInjector::MoveMouseAbsolute(int32_t x, int32_t y) {
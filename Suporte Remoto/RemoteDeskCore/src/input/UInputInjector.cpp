@@ -0,0 +1,500 @@
+#include "UInputInjector.h"
+#include "PlatformCompat.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Blocos de texto menores que no Windows: cada leitor do evdev tem um buffer de
+// ~64 eventos por device, e um caractere com Shift gera até 6 (com os SYN_REPORT)
+constexpr size_t UINPUT_TEXT_CHUNK_STROKES = 16;
+
+// Pausa entre blocos de texto (ms), para o compositor drenar o buffer
+constexpr uint32_t UINPUT_TEXT_CHUNK_PAUSE_MS = 4;
+
+// Unidades de roda por clique (WHEEL_DELTA do protocolo = 120, igual ao REL_WHEEL_HI_RES)
+constexpr int32_t WHEEL_UNITS_PER_CLICK = 120;
+
+constexpr const char* POINTER_DEVICE_NAME = "RemoteDeskCore Pointer";
+constexpr const char* KEYBOARD_DEVICE_NAME = "RemoteDeskCore Keyboard";
+
+struct KeyMapping {
+    uint16_t virtualKey;
+    uint16_t evdevKey;
+};
+
+// VK_* → KEY_*. Genéricos (VK_SHIFT/VK_CONTROL/VK_MENU) vão para o lado esquerdo
+constexpr KeyMapping KEY_MAPPINGS[] = {
+    { 0x08, 14 },  { 0x09, 15 },  { 0x0D, 28 },  { 0x10, 42 },  { 0x11, 29 },  { 0x12, 56 },
+    { 0x13, 119 }, { 0x14, 58 },  { 0x1B, 1 },   { 0x20, 57 },  { 0x21, 104 }, { 0x22, 109 },
+    { 0x23, 107 }, { 0x24, 102 }, { 0x25, 105 }, { 0x26, 103 }, { 0x27, 106 }, { 0x28, 108 },
+    { 0x2C, 99 },  { 0x2D, 110 }, { 0x2E, 111 },
+    // 0-9
+    { 0x30, 11 },  { 0x31, 2 },   { 0x32, 3 },   { 0x33, 4 },   { 0x34, 5 },   { 0x35, 6 },
+    { 0x36, 7 },   { 0x37, 8 },   { 0x38, 9 },   { 0x39, 10 },
+    // A-Z
+    { 0x41, 30 },  { 0x42, 48 },  { 0x43, 46 },  { 0x44, 32 },  { 0x45, 18 },  { 0x46, 33 },
+    { 0x47, 34 },  { 0x48, 35 },  { 0x49, 23 },  { 0x4A, 36 },  { 0x4B, 37 },  { 0x4C, 38 },
+    { 0x4D, 50 },  { 0x4E, 49 },  { 0x4F, 24 },  { 0x50, 25 },  { 0x51, 16 },  { 0x52, 19 },
+    { 0x53, 31 },  { 0x54, 20 },  { 0x55, 22 },  { 0x56, 47 },  { 0x57, 17 },  { 0x58, 45 },
+    { 0x59, 21 },  { 0x5A, 44 },
+    // Win, menu de contexto
+    { 0x5B, 125 }, { 0x5C, 126 }, { 0x5D, 127 },
+    // Teclado numérico
+    { 0x60, 82 },  { 0x61, 79 },  { 0x62, 80 },  { 0x63, 81 },  { 0x64, 75 },  { 0x65, 76 },
+    { 0x66, 77 },  { 0x67, 71 },  { 0x68, 72 },  { 0x69, 73 },  { 0x6A, 55 },  { 0x6B, 78 },
+    { 0x6C, 121 }, { 0x6D, 74 },  { 0x6E, 83 },  { 0x6F, 98 },
+    // F1-F12, F13-F24
+    { 0x70, 59 },  { 0x71, 60 },  { 0x72, 61 },  { 0x73, 62 },  { 0x74, 63 },  { 0x75, 64 },
+    { 0x76, 65 },  { 0x77, 66 },  { 0x78, 67 },  { 0x79, 68 },  { 0x7A, 87 },  { 0x7B, 88 },
+    { 0x7C, 183 }, { 0x7D, 184 }, { 0x7E, 185 }, { 0x7F, 186 }, { 0x80, 187 }, { 0x81, 188 },
+    { 0x82, 189 }, { 0x83, 190 }, { 0x84, 191 }, { 0x85, 192 }, { 0x86, 193 }, { 0x87, 194 },
+    { 0x90, 69 },  { 0x91, 70 },
+    // Modificadores com lado
+    { 0xA0, 42 },  { 0xA1, 54 },  { 0xA2, 29 },  { 0xA3, 97 },  { 0xA4, 56 },  { 0xA5, 100 },
+    // OEM: ; = , - . / ` (ç e ' no ABNT2 ficam nas mesmas posições físicas)
+    { 0xBA, 39 },  { 0xBB, 13 },  { 0xBC, 51 },  { 0xBD, 12 },  { 0xBE, 52 },  { 0xBF, 53 },
+    { 0xC0, 41 },
+    // ABNT2: / (KEY_RO) e . do teclado numérico (KEY_KPJPCOMMA)
+    { 0xC1, 89 },  { 0xC2, 95 },
+    // [ \ ] ' e a tecla extra do ISO (VK_OEM_102)
+    { 0xDB, 26 },  { 0xDC, 43 },  { 0xDD, 27 },  { 0xDE, 40 },  { 0xE2, 86 }
+};
+
+// Layout US: mesma posição, sem e com Shift
+constexpr char ASCII_UNSHIFTED[] = "`1234567890-=qwertyuiop[]\\asdfghjkl;'zxcvbnm,./";
+constexpr char ASCII_SHIFTED[]   = "~!@#$%^&*()_+QWERTYUIOP{}|ASDFGHJKL:\"ZXCVBNM<>?";
+constexpr uint16_t ASCII_KEYS[] = {
+    41, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 43,
+    30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    44, 45, 46, 47, 48, 49, 50, 51, 52, 53
+};
+static_assert(sizeof(ASCII_UNSHIFTED) - 1 == sizeof(ASCII_KEYS) / sizeof(ASCII_KEYS[0]));
+static_assert(sizeof(ASCII_SHIFTED) == sizeof(ASCII_UNSHIFTED));
+
+constexpr uint16_t EVDEV_KEY_SPACE = 57;
+
+const std::array<uint16_t, 256>& VirtualKeyTable() {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> t{};
+        for (const KeyMapping& mapping : KEY_MAPPINGS) {
+            t[mapping.virtualKey] = mapping.evdevKey;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint16_t MouseButtonToEvdev(InputMouseButton button) {
+    switch (button) {
+        case InputMouseButton::LEFT:   return EVDEV_BTN_LEFT;
+        case InputMouseButton::RIGHT:  return EVDEV_BTN_RIGHT;
+        case InputMouseButton::MIDDLE: return EVDEV_BTN_MIDDLE;
+        case InputMouseButton::X1:     return EVDEV_BTN_SIDE;
+        case InputMouseButton::X2:     return EVDEV_BTN_EXTRA;
+    }
+    return 0;
+}
+
+} // namespace
+
+// ===== Mapeamento de teclas =====
+
+uint16_t VirtualKeyToEvdev(uint16_t virtualKey) {
+    return virtualKey < 256 ? VirtualKeyTable()[virtualKey] : 0;
+}
+
+bool AsciiToEvdev(uint16_t character, uint16_t& outKey, bool& outShift) {
+    if (character == ' ') {
+        outKey = EVDEV_KEY_SPACE;
+        outShift = false;
+        return true;
+    }
+    if (character == 0 || character > 0x7F) {
+        return false;
+    }
+
+    const char c = static_cast<char>(character);
+    for (size_t i = 0; i < sizeof(ASCII_KEYS) / sizeof(ASCII_KEYS[0]); ++i) {
+        if (ASCII_UNSHIFTED[i] == c || ASCII_SHIFTED[i] == c) {
+            outKey = ASCII_KEYS[i];
+            outShift = ASCII_SHIFTED[i] == c;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint16_t> GetMappedEvdevKeys() {
+    std::vector<uint16_t> keys;
+    for (const KeyMapping& mapping : KEY_MAPPINGS) {
+        keys.push_back(mapping.evdevKey);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// ===== UInputTranslator =====
+
+std::vector<UInputEvent>& UInputTranslator::Frame(UInputDeviceKind device,
+                                                  std::vector<DeviceWrite>& outWrites) {
+    if (outWrites.empty() || outWrites.back().device != device) {
+        EndFrames(outWrites);
+        outWrites.push_back({ device, {} });
+    }
+    return outWrites.back().events;
+}
+
+void UInputTranslator::Emit(std::vector<UInputEvent>& frame, uint16_t type, uint16_t code, int32_t value) {
+    const uint32_t key = (static_cast<uint32_t>(type) << 16) | code;
+
+    // O mesmo código duas vezes no quadro: o leitor só veria o último valor
+    if (std::find(m_frameCodes.begin(), m_frameCodes.end(), key) != m_frameCodes.end()) {
+        frame.push_back({ EVDEV_EV_SYN, EVDEV_SYN_REPORT, 0 });
+        m_frameCodes.clear();
+    }
+
+    frame.push_back({ type, code, value });
+    m_frameCodes.push_back(key);
+}
+
+void UInputTranslator::EndFrames(std::vector<DeviceWrite>& outWrites) {
+    if (!outWrites.empty()) {
+        std::vector<UInputEvent>& events = outWrites.back().events;
+        if (!events.empty() && events.back().type != EVDEV_EV_SYN) {
+            events.push_back({ EVDEV_EV_SYN, EVDEV_SYN_REPORT, 0 });
+        }
+    }
+    m_frameCodes.clear();
+}
+
+uint32_t UInputTranslator::Translate(const InputEvent* events, size_t count,
+                                     std::vector<DeviceWrite>& outWrites) {
+    outWrites.clear();
+    m_frameCodes.clear();
+
+    uint32_t translated = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const InputEvent& event = events[i];
+
+        switch (event.type) {
+            case InputEventType::MOUSE_MOVE: {
+                std::vector<UInputEvent>& frame = Frame(UInputDeviceKind::POINTER, outWrites);
+                Emit(frame, EVDEV_EV_ABS, EVDEV_ABS_X, std::clamp(event.x, 0, INPUT_COORD_MAX));
+                Emit(frame, EVDEV_EV_ABS, EVDEV_ABS_Y, std::clamp(event.y, 0, INPUT_COORD_MAX));
+                break;
+            }
+
+            case InputEventType::MOUSE_BUTTON: {
+                const uint16_t code = MouseButtonToEvdev(event.button);
+                if (code == 0) {
+                    continue;
+                }
+                Emit(Frame(UInputDeviceKind::POINTER, outWrites), EVDEV_EV_KEY, code, event.pressed ? 1 : 0);
+                break;
+            }
+
+            case InputEventType::MOUSE_WHEEL: {
+                if (event.wheelDelta == 0) {
+                    continue;
+                }
+                // Alta resolução sempre; o clique clássico só quando fecha 120 unidades
+                std::vector<UInputEvent>& frame = Frame(UInputDeviceKind::POINTER, outWrites);
+                Emit(frame, EVDEV_EV_REL, EVDEV_REL_WHEEL_HI_RES, event.wheelDelta);
+
+                m_wheelRemainder += event.wheelDelta;
+                const int32_t clicks = m_wheelRemainder / WHEEL_UNITS_PER_CLICK;
+                if (clicks != 0) {
+                    m_wheelRemainder -= clicks * WHEEL_UNITS_PER_CLICK;
+                    Emit(frame, EVDEV_EV_REL, EVDEV_REL_WHEEL, clicks);
+                }
+                break;
+            }
+
+            case InputEventType::KEY: {
+                const uint16_t code = VirtualKeyToEvdev(event.virtualKey);
+                if (code == 0) {
+                    continue;
+                }
+                Emit(Frame(UInputDeviceKind::KEYBOARD, outWrites), EVDEV_EV_KEY, code, event.pressed ? 1 : 0);
+                break;
+            }
+
+            default:
+                continue;
+        }
+        translated++;
+    }
+
+    EndFrames(outWrites);
+    return translated;
+}
+
+void UInputTranslator::TranslateText(const TextKeyStroke* strokes, size_t count,
+                                     std::vector<DeviceWrite>& outWrites, size_t& outSkipped) {
+    outWrites.clear();
+    m_frameCodes.clear();
+
+    for (size_t i = 0; i < count; ++i) {
+        const TextKeyStroke& stroke = strokes[i];
+
+        uint16_t code = 0;
+        bool shift = false;
+        if (stroke.isVirtualKey) {
+            code = VirtualKeyToEvdev(stroke.code);
+        } else if (!AsciiToEvdev(stroke.code, code, shift)) {
+            code = 0;
+        }
+
+        if (code == 0) {
+            if (!stroke.keyUp) {
+                outSkipped++;
+            }
+            continue;
+        }
+
+        std::vector<UInputEvent>& frame = Frame(UInputDeviceKind::KEYBOARD, outWrites);
+        if (!stroke.keyUp) {
+            if (shift) {
+                Emit(frame, EVDEV_EV_KEY, EVDEV_KEY_LEFTSHIFT, 1);
+            }
+            Emit(frame, EVDEV_EV_KEY, code, 1);
+        } else {
+            Emit(frame, EVDEV_EV_KEY, code, 0);
+            if (shift) {
+                Emit(frame, EVDEV_EV_KEY, EVDEV_KEY_LEFTSHIFT, 0);
+            }
+        }
+    }
+
+    EndFrames(outWrites);
+}
+
+// ===== UInputDevice =====
+
+UInputDevice::~UInputDevice() {
+    Close();
+}
+
+#ifdef __linux__
+
+bool UInputDevice::Open(const UInputDeviceConfig& config) {
+    Close();
+
+    m_fd = open("/dev/uinput", O_WRONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        OutputDebugStringA("UInputDevice: failed to open /dev/uinput (needs write access)\n");
+        return false;
+    }
+
+    bool ok = ioctl(m_fd, UI_SET_EVBIT, EV_SYN) == 0;
+    if (!config.keys.empty()) {
+        ok = ok && ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0;
+        for (uint16_t key : config.keys) {
+            ok = ok && ioctl(m_fd, UI_SET_KEYBIT, key) == 0;
+        }
+    }
+    if (!config.relAxes.empty()) {
+        ok = ok && ioctl(m_fd, UI_SET_EVBIT, EV_REL) == 0;
+        for (uint16_t axis : config.relAxes) {
+            ok = ok && ioctl(m_fd, UI_SET_RELBIT, axis) == 0;
+        }
+    }
+    if (!config.absAxes.empty()) {
+        ok = ok && ioctl(m_fd, UI_SET_EVBIT, EV_ABS) == 0;
+        for (uint16_t axis : config.absAxes) {
+            uinput_abs_setup absSetup = {};
+            absSetup.code = axis;
+            absSetup.absinfo.minimum = 0;
+            absSetup.absinfo.maximum = INPUT_COORD_MAX;
+            ok = ok && ioctl(m_fd, UI_SET_ABSBIT, axis) == 0 && ioctl(m_fd, UI_ABS_SETUP, &absSetup) == 0;
+        }
+    }
+
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.product = config.kind == UInputDeviceKind::POINTER ? 1 : 2;
+    std::strncpy(setup.name, config.name, UINPUT_MAX_NAME_SIZE - 1);
+
+    ok = ok && ioctl(m_fd, UI_DEV_SETUP, &setup) == 0 && ioctl(m_fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        OutputDebugStringA("UInputDevice: device setup failed\n");
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool UInputDevice::Write(const UInputEvent* events, size_t count) {
+    if (m_fd < 0 || count == 0) {
+        return false;
+    }
+
+    // Um write() com o array inteiro: o kernel entrega o lote de uma vez aos leitores
+    m_writeBuffer.assign(count * sizeof(input_event), 0);
+    input_event* out = reinterpret_cast<input_event*>(m_writeBuffer.data());
+    for (size_t i = 0; i < count; ++i) {
+        out[i].type = events[i].type;
+        out[i].code = events[i].code;
+        out[i].value = events[i].value;
+    }
+
+    const ssize_t written = write(m_fd, m_writeBuffer.data(), m_writeBuffer.size());
+    if (written != static_cast<ssize_t>(m_writeBuffer.size())) {
+        OutputDebugStringA("UInputDevice: write failed\n");
+        return false;
+    }
+    return true;
+}
+
+void UInputDevice::Close() {
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+#else
+
+bool UInputDevice::Open(const UInputDeviceConfig&) {
+    OutputDebugStringA("UInputDevice: uinput is only available on Linux\n");
+    return false;
+}
+
+bool UInputDevice::Write(const UInputEvent*, size_t) {
+    return false;
+}
+
+void UInputDevice::Close() {
+}
+
+#endif
+
+// ===== UInputInjector =====
+
+UInputInjector::UInputInjector()
+    : UInputInjector(std::make_unique<UInputDevice>(), std::make_unique<UInputDevice>()) {
+}
+
+UInputInjector::UInputInjector(std::unique_ptr<IUInputDevice> pointer, std::unique_ptr<IUInputDevice> keyboard)
+    : m_pointer(std::move(pointer)), m_keyboard(std::move(keyboard)) {
+}
+
+UInputInjector::~UInputInjector() {
+    Release();
+}
+
+bool UInputInjector::Initialize() {
+    if (!m_pointer || !m_keyboard) {
+        return false;
+    }
+
+    // Ponteiro absoluto: sem BTN_TOUCH/BTN_TOOL_*, o libinput o trata como mouse
+    // absoluto mapeado na tela inteira (como o tablet USB de uma VM)
+    UInputDeviceConfig pointerConfig;
+    pointerConfig.kind = UInputDeviceKind::POINTER;
+    pointerConfig.name = POINTER_DEVICE_NAME;
+    pointerConfig.keys = { EVDEV_BTN_LEFT, EVDEV_BTN_RIGHT, EVDEV_BTN_MIDDLE, EVDEV_BTN_SIDE, EVDEV_BTN_EXTRA };
+    pointerConfig.relAxes = { EVDEV_REL_WHEEL, EVDEV_REL_WHEEL_HI_RES };
+    pointerConfig.absAxes = { EVDEV_ABS_X, EVDEV_ABS_Y };
+
+    UInputDeviceConfig keyboardConfig;
+    keyboardConfig.kind = UInputDeviceKind::KEYBOARD;
+    keyboardConfig.name = KEYBOARD_DEVICE_NAME;
+    keyboardConfig.keys = GetMappedEvdevKeys();
+
+    if (!m_pointer->Open(pointerConfig)) {
+        return false;
+    }
+    if (!m_keyboard->Open(keyboardConfig)) {
+        m_pointer->Close();
+        return false;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+bool UInputInjector::WriteAll(const std::vector<UInputTranslator::DeviceWrite>& writes) {
+    for (const UInputTranslator::DeviceWrite& deviceWrite : writes) {
+        IUInputDevice& device = deviceWrite.device == UInputDeviceKind::POINTER ? *m_pointer : *m_keyboard;
+        if (!device.Write(deviceWrite.events.data(), deviceWrite.events.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t UInputInjector::InjectEvents(const InputEvent* events, size_t count) {
+    if (!m_initialized || count == 0) {
+        return 0;
+    }
+
+    const uint32_t translated = m_translator.Translate(events, count, m_writes);
+    if (!WriteAll(m_writes)) {
+        return 0;
+    }
+    return translated;
+}
+
+bool UInputInjector::InjectText(const char* text) {
+    if (!m_initialized || !text) {
+        return false;
+    }
+
+    m_textStrokes.clear();
+    BuildTextKeyStrokes(text, std::strlen(text), m_textStrokes);
+
+    // Sem IME, só o que o layout US alcança vira tecla. Texto com caractere fora dele
+    // não sai pela metade: nada é injetado e o chamador recebe false
+    size_t skipped = 0;
+    m_translator.TranslateText(m_textStrokes.data(), m_textStrokes.size(), m_writes, skipped);
+    if (skipped > 0) {
+        std::string message = "UInputInjector: " + std::to_string(skipped) +
+                              " characters outside the US layout, text not injected\n";
+        OutputDebugStringA(message.c_str());
+        return false;
+    }
+
+    for (size_t begin = 0; begin < m_textStrokes.size();) {
+        const size_t end = NextTextChunkEnd(m_textStrokes, begin, UINPUT_TEXT_CHUNK_STROKES);
+
+        m_translator.TranslateText(m_textStrokes.data() + begin, end - begin, m_writes, skipped);
+        if (!WriteAll(m_writes)) {
+            return false;
+        }
+
+        begin = end;
+        if (begin < m_textStrokes.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(UINPUT_TEXT_CHUNK_PAUSE_MS));
+        }
+    }
+    return true;
+}
+
+void UInputInjector::Release() {
+    if (m_pointer) {
+        m_pointer->Close();
+    }
+    if (m_keyboard) {
+        m_keyboard->Close();
+    }
+    m_initialized = false;
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cstdlib>
 
 /**
  * @brief Imprime as instruções de uso do programa.
@@ -16,6 +17,12 @@ void PrintUsage() {
     std::cout << "  server <porta>            - (LAN) Inicia no modo servidor, escutando na porta." << std::endl;
     std::cout << "  client <ip> <porta>       - (LAN) Inicia no modo cliente, conectando ao IP e porta." << std::endl;
     std::cout << "  loopback (ou sem args)    - Inicia no modo de teste loopback local." << std::endl;
+    std::cout << "\nVariaveis de Ambiente:" << std::endl;
+    std::cout << "  RDC_TRACE_FILE=<arquivo>  - Grava trace do pipeline (.json = Chrome, outro = Perfetto)." << std::endl;
+    std::cout << "  RDC_METRICS_PORT=<porta>  - Serve metricas Prometheus em http://127.0.0.1:<porta>/metrics." << std::endl;
+    std::cout << "  RDC_LATENCY_PROBE=<modo>  - (Cliente) Mede input -> foto: marker, pixel ou pixel:<vk>." << std::endl;
+    std::cout << "  RDC_SIGNALING_URL=<url>   - (host/join) Servidor de sinalizacao (padrao ws://127.0.0.1:8080)." << std::endl;
+    std::cout << "  RDC_ABR_MODE=<modo>       - (Host) ABR: model (padrao), conservative, balanced ou aggressive." << std::endl;
     std::cout << "\nExemplos:" << std::endl;
     std::cout << "  remote_desktop_app.exe server 12345" << std::endl;
     std::cout << "  remote_desktop_app.exe client 192.168.1.100 12345" << std::endl;
@@ -30,6 +37,49 @@ int main(int argc, char* argv[]) {
     std::vector<std::string> args(argv, argv + argc);
     RemoteDesktopSystem system;
 
+    // host/join: servidor de sinalização (signaling-server.js)
+    std::string signalingUrl = "ws://127.0.0.1:8080";
+    if (const char* url = std::getenv("RDC_SIGNALING_URL")) {
+        signalingUrl = url;
+    }
+
+    if (const char* traceFile = std::getenv("RDC_TRACE_FILE")) {
+        system.SetTraceOutputPath(traceFile);
+    }
+    if (const char* metricsPort = std::getenv("RDC_METRICS_PORT")) {
+        system.SetMetricsPort(static_cast<uint16_t>(std::atoi(metricsPort)));
+    }
+    if (const char* abrMode = std::getenv("RDC_ABR_MODE")) {
+        // model: atraso por frame (FRAME_FEEDBACK) + goodput; os demais só RTT/perda
+        std::string mode = abrMode;
+        using Mode = AdaptiveBitRateController::AdaptationMode;
+        if (mode == "conservative") {
+            system.SetAdaptiveMode(Mode::CONSERVATIVE);
+        } else if (mode == "balanced") {
+            system.SetAdaptiveMode(Mode::BALANCED);
+        } else if (mode == "aggressive") {
+            system.SetAdaptiveMode(Mode::AGGRESSIVE);
+        } else if (mode == "model") {
+            system.SetAdaptiveMode(Mode::MODEL_BASED);
+        } else {
+            std::cerr << "RDC_ABR_MODE invalido: " << mode << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (const char* probe = std::getenv("RDC_LATENCY_PROBE")) {
+        // "pixel:<vk>" injeta a tecla no host e espera a tela reagir
+        std::string probeMode = probe;
+        uint16_t virtualKey = 0;
+        size_t colon = probeMode.find(':');
+        if (colon != std::string::npos) {
+            virtualKey = static_cast<uint16_t>(std::strtoul(probeMode.c_str() + colon + 1, nullptr, 0));
+            probeMode.resize(colon);
+        }
+        system.SetLatencyProbe(true, probeMode == "pixel" ? ProbeMode::PIXEL_CHANGE : ProbeMode::MARKER,
+                               virtualKey);
+    }
+
     // Modo Loopback (padrão)
     if (args.size() == 1 || args[1] == "loopback") {
         std::cout << "Iniciando em modo Loopback..." << std::endl;
@@ -48,8 +98,8 @@ int main(int argc, char* argv[]) {
         system.SetUseNetworking(true);
         system.SetInputEnabled(true);
 
-        // InitializeAsHost se conectaria ao servidor de sinalização e obteria um ID
-        if (!system.InitializeAsHost("ws://your-signaling-server.com:8080")) {
+        // Registra na sinalização, imprime o ID da sessão e espera o guest
+        if (!system.InitializeAsHost(signalingUrl)) {
             std::cerr << "Falha ao inicializar o modo Host." << std::endl;
             return 1;
         }
@@ -62,7 +112,7 @@ int main(int argc, char* argv[]) {
         system.SetUseMultiThreading(true);
         system.SetInputEnabled(true);
 
-        if (!system.InitializeAsGuest("ws://your-signaling-server.com:8080", sessionId)) {
+        if (!system.InitializeAsGuest(signalingUrl, sessionId)) {
             std::cerr << "Falha ao conectar a sessao." << std::endl;
             return 1;
         }
@@ -0,0 +1,197 @@
+#include "CertificateFingerprint.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+constexpr const char* PEM_BEGIN = "-----BEGIN CERTIFICATE-----";
+constexpr const char* PEM_END = "-----END CERTIFICATE-----";
+
+uint32_t RotateRight(uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+int Base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+// Base64 com quebras de linha (PEM); para no '='
+bool Base64Decode(const std::string& text, std::vector<uint8_t>& out) {
+    out.clear();
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (char c : text) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            continue;
+        }
+        if (c == '=') {
+            break;
+        }
+        int value = Base64Value(c);
+        if (value < 0) {
+            return false;
+        }
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>(accumulator >> bits));
+        }
+    }
+    return !out.empty();
+}
+
+// Só os dígitos hex, em maiúsculas
+std::string NormalizeFingerprint(const std::string& fingerprint) {
+    std::string out;
+    for (char c : fingerprint) {
+        if (std::isxdigit(static_cast<unsigned char>(c))) {
+            out.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+void Sha256(const uint8_t* data, size_t size, uint8_t outDigest[SHA256_DIGEST_SIZE]) {
+    uint32_t h[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    std::vector<uint8_t> message(data, data + size);
+    message.push_back(0x80);
+    while (message.size() % 64 != 56) {
+        message.push_back(0);
+    }
+    const uint64_t bitLength = static_cast<uint64_t>(size) * 8;
+    for (int i = 7; i >= 0; --i) {
+        message.push_back(static_cast<uint8_t>(bitLength >> (i * 8)));
+    }
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            const uint8_t* p = &message[block + i * 4];
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+            uint32_t choose = (e & f) ^ (~e & g);
+            uint32_t temp1 = k + s1 + choose + SHA256_K[i] + w[i];
+            uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+            uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t temp2 = s0 + majority;
+            k = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += k;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        outDigest[i * 4 + 0] = static_cast<uint8_t>(h[i] >> 24);
+        outDigest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        outDigest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        outDigest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+}
+
+std::string FormatCertificateFingerprint(const uint8_t* der, size_t size) {
+    static const char HEX[] = "0123456789ABCDEF";
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    Sha256(der, size, digest);
+
+    std::string out;
+    out.reserve(SHA256_DIGEST_SIZE * 3);
+    for (size_t i = 0; i < SHA256_DIGEST_SIZE; ++i) {
+        if (i > 0) {
+            out.push_back(':');
+        }
+        out.push_back(HEX[digest[i] >> 4]);
+        out.push_back(HEX[digest[i] & 0x0F]);
+    }
+    return out;
+}
+
+bool LoadPemCertificate(const std::string& path, std::vector<uint8_t>& outDer) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    const std::string text = content.str();
+
+    size_t begin = text.find(PEM_BEGIN);
+    if (begin == std::string::npos) {
+        return false;
+    }
+    begin += std::char_traits<char>::length(PEM_BEGIN);
+    size_t end = text.find(PEM_END, begin);
+    if (end == std::string::npos) {
+        return false;
+    }
+    return Base64Decode(text.substr(begin, end - begin), outDer);
+}
+
+bool ComputeCertificateFileFingerprint(const std::string& path, std::string& outFingerprint) {
+    std::vector<uint8_t> der;
+    if (!LoadPemCertificate(path, der)) {
+        return false;
+    }
+    outFingerprint = FormatCertificateFingerprint(der.data(), der.size());
+    return true;
+}
+
+bool CertificateFingerprintMatches(const std::string& expected, const uint8_t* der, size_t size) {
+    const std::string want = NormalizeFingerprint(expected);
+    if (want.size() != SHA256_DIGEST_SIZE * 2 || !der || size == 0) {
+        return false;
+    }
+    const std::string got = NormalizeFingerprint(FormatCertificateFingerprint(der, size));
+
+    // Sem saída antecipada
+    uint8_t difference = 0;
+    for (size_t i = 0; i < want.size(); ++i) {
+        difference |= static_cast<uint8_t>(want[i] ^ got[i]);
+    }
+    return difference == 0;
+}
@@ -0,0 +1,192 @@
+#include "CursorProtocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline void PutPixel(uint8_t* p, uint8_t b, uint8_t g, uint8_t r, uint8_t a) {
+    p[0] = b;
+    p[1] = g;
+    p[2] = r;
+    p[3] = a;
+}
+
+} // namespace
+
+bool ConvertCursorShape(CursorShapeType type, uint32_t width, uint32_t height, uint32_t pitch,
+                        const uint8_t* data, size_t dataSize, int32_t hotspotX, int32_t hotspotY,
+                        CursorShape& outShape) {
+    if (!data || width == 0 || height == 0) {
+        return false;
+    }
+
+    // Monocromático: a altura inclui as duas máscaras
+    const uint32_t shapeHeight = type == CursorShapeType::MONOCHROME ? height / 2 : height;
+    const uint32_t rowBytes = type == CursorShapeType::MONOCHROME ? (width + 7) / 8 : width * 4;
+    if (shapeHeight == 0 || pitch < rowBytes ||
+        dataSize < static_cast<size_t>(pitch) * (height - 1) + rowBytes) {
+        return false;
+    }
+
+    const uint32_t outWidth = std::min(width, CURSOR_MAX_DIMENSION);
+    const uint32_t outHeight = std::min(shapeHeight, CURSOR_MAX_DIMENSION);
+
+    outShape.width = outWidth;
+    outShape.height = outHeight;
+    outShape.hotspotX = std::min<int32_t>(hotspotX, static_cast<int32_t>(outWidth) - 1);
+    outShape.hotspotY = std::min<int32_t>(hotspotY, static_cast<int32_t>(outHeight) - 1);
+    outShape.pixels.resize(static_cast<size_t>(outWidth) * outHeight * 4);
+
+    for (uint32_t y = 0; y < outHeight; ++y) {
+        uint8_t* out = outShape.pixels.data() + static_cast<size_t>(y) * outWidth * 4;
+
+        switch (type) {
+            case CursorShapeType::MONOCHROME: {
+                const uint8_t* andRow = data + static_cast<size_t>(y) * pitch;
+                const uint8_t* xorRow = data + static_cast<size_t>(y + shapeHeight) * pitch;
+                for (uint32_t x = 0; x < outWidth; ++x) {
+                    const uint8_t bit = static_cast<uint8_t>(0x80 >> (x % 8));
+                    const bool andBit = (andRow[x / 8] & bit) != 0;
+                    const bool xorBit = (xorRow[x / 8] & bit) != 0;
+
+                    if (!andBit) {
+                        uint8_t v = xorBit ? 0xFF : 0x00;       // Branco / preto
+                        PutPixel(out + x * 4, v, v, v, 0xFF);
+                    } else if (xorBit) {
+                        PutPixel(out + x * 4, 0, 0, 0, 0xFF);   // Inversão
+                    } else {
+                        PutPixel(out + x * 4, 0, 0, 0, 0);      // Transparente
+                    }
+                }
+                break;
+            }
+
+            case CursorShapeType::COLOR: {
+                std::memcpy(out, data + static_cast<size_t>(y) * pitch, static_cast<size_t>(outWidth) * 4);
+                break;
+            }
+
+            case CursorShapeType::MASKED_COLOR: {
+                const uint8_t* row = data + static_cast<size_t>(y) * pitch;
+                for (uint32_t x = 0; x < outWidth; ++x) {
+                    const uint8_t* p = row + x * 4;
+                    const bool xorWithScreen = p[3] == 0xFF;
+                    const bool empty = p[0] == 0 && p[1] == 0 && p[2] == 0;
+
+                    if (xorWithScreen && empty) {
+                        PutPixel(out + x * 4, 0, 0, 0, 0);      // XOR com 0: tela inalterada
+                    } else if (xorWithScreen) {
+                        PutPixel(out + x * 4, 0, 0, 0, 0xFF);   // Inversão
+                    } else {
+                        PutPixel(out + x * 4, p[0], p[1], p[2], 0xFF);
+                    }
+                }
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    outShape.hash = HashCursorShape(outShape);
+    return true;
+}
+
+uint64_t HashCursorShape(const CursorShape& shape) {
+    const int32_t dims[4] = { static_cast<int32_t>(shape.width), static_cast<int32_t>(shape.height),
+                              shape.hotspotX, shape.hotspotY };
+    uint64_t hash = Fnv1a(FNV_OFFSET, dims, sizeof(dims));
+    hash = Fnv1a(hash, shape.pixels.data(), shape.pixels.size());
+
+    // 0 é reservado para "sem forma"
+    return hash != 0 ? hash : 1;
+}
+
+void SerializeCursorShape(const CursorShape& shape, std::vector<uint8_t>& outPayload) {
+    CursorShapeHeader header;
+    header.hash = shape.hash;
+    header.width = static_cast<uint16_t>(shape.width);
+    header.height = static_cast<uint16_t>(shape.height);
+    header.hotspotX = static_cast<int16_t>(shape.hotspotX);
+    header.hotspotY = static_cast<int16_t>(shape.hotspotY);
+
+    outPayload.resize(sizeof(header) + shape.pixels.size());
+    std::memcpy(outPayload.data(), &header, sizeof(header));
+    if (!shape.pixels.empty()) {
+        std::memcpy(outPayload.data() + sizeof(header), shape.pixels.data(), shape.pixels.size());
+    }
+}
+
+bool DeserializeCursorShape(const uint8_t* data, size_t size, CursorShape& outShape) {
+    if (!data || size < sizeof(CursorShapeHeader)) {
+        return false;
+    }
+
+    CursorShapeHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const size_t pixelBytes = static_cast<size_t>(header.width) * header.height * 4;
+    if (header.width == 0 || header.height == 0 ||
+        header.width > CURSOR_MAX_DIMENSION || header.height > CURSOR_MAX_DIMENSION ||
+        size != sizeof(header) + pixelBytes) {
+        return false;
+    }
+
+    outShape.hash = header.hash;
+    outShape.width = header.width;
+    outShape.height = header.height;
+    outShape.hotspotX = header.hotspotX;
+    outShape.hotspotY = header.hotspotY;
+    outShape.pixels.assign(data + sizeof(header), data + size);
+    return true;
+}
+
+bool DeserializeCursorPosition(const uint8_t* data, size_t size, CursorPositionMessage& outPosition) {
+    if (!data || size != sizeof(CursorPositionMessage)) {
+        return false;
+    }
+
+    std::memcpy(&outPosition, data, sizeof(outPosition));
+    return true;
+}
+
+void CursorShapeCache::Put(const CursorShape& shape) {
+    for (Entry& entry : m_entries) {
+        if (entry.shape.hash == shape.hash) {
+            entry.lastUsed = ++m_useCounter;
+            return;
+        }
+    }
+
+    if (m_entries.size() >= m_capacity && !m_entries.empty()) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+        m_entries.erase(oldest);
+    }
+
+    m_entries.push_back({ shape, ++m_useCounter });
+}
+
+const CursorShape* CursorShapeCache::Find(uint64_t hash) {
+    for (Entry& entry : m_entries) {
+        if (entry.shape.hash == hash) {
+            entry.lastUsed = ++m_useCounter;
+            return &entry.shape;
+        }
+    }
+    return nullptr;
+}
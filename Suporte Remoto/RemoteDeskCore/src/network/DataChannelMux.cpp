@@ -0,0 +1,752 @@
+#include "DataChannelMux.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint8_t TYPE_DATA = 1;
+constexpr uint8_t TYPE_ACK = 2;
+constexpr uint8_t TYPE_FORWARD = 3;
+
+constexpr uint8_t FLAG_ORDERED = 0x01;
+constexpr uint8_t FLAG_RELIABLE = 0x02;
+
+constexpr size_t DATA_HEADER_SIZE = 19;
+constexpr size_t ACK_HEADER_SIZE = 4;
+constexpr size_t ACKS_PER_DATAGRAM = 256;
+constexpr size_t FORWARD_SIZE = 6;
+
+constexpr uint64_t INITIAL_RTO_US = 100000;     // Antes da primeira amostra de RTT
+constexpr uint64_t MIN_RTO_US = 20000;
+constexpr uint64_t MAX_RTO_US = 1000000;
+constexpr double MIN_RTO_SLACK_US = 10000.0;    // Folga mínima sobre o SRTT (ACKs saem por Poll)
+constexpr uint32_t FORWARD_REPEATS = 3;         // FORWARD avulso é reenviado (não tem ACK)
+
+// Pacer: crédito acumulado no máximo por 5 ms (e pelo menos 2 datagramas)
+constexpr double PACER_BURST_US = 5000.0;
+constexpr double PACER_MIN_BURST_BYTES = 2.0 * (DATA_HEADER_SIZE + DataChannelMux::MAX_FRAGMENT_PAYLOAD);
+
+// Fila do pacer: controle e input passam na frente do vídeo
+constexpr DataChannelKind DRAIN_ORDER[] = {
+    DataChannelKind::INPUT, DataChannelKind::CONTROL, DataChannelKind::VIDEO
+};
+
+constexpr uint64_t UNRELIABLE_REASSEMBLY_TIMEOUT_US = 500000;
+constexpr size_t MAX_UNRELIABLE_PARTIAL = 64;
+constexpr size_t DEDUP_WINDOW = 1024;
+
+void PutU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint16_t GetU16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+} // namespace
+
+DataChannelReliability DefaultDataChannelReliability(DataChannelKind kind) {
+    DataChannelReliability reliability;
+    switch (kind) {
+        case DataChannelKind::VIDEO:
+            // Frame perdido não volta: o próximo (ou um keyframe pedido) substitui
+            reliability.ordered = false;
+            reliability.maxRetransmits = 0;
+            break;
+        case DataChannelKind::INPUT:
+            // Teclas e cliques não podem se perder nem trocar de ordem
+            reliability.ordered = true;
+            reliability.maxRetransmits = -1;
+            break;
+        case DataChannelKind::CONTROL:
+            // Cursor/controle: retransmite enquanto ainda é relevante
+            reliability.ordered = false;
+            reliability.maxRetransmits = -1;
+            reliability.maxPacketLifeTimeMs = 250;
+            break;
+    }
+    return reliability;
+}
+
+const char* DataChannelLabel(DataChannelKind kind) {
+    switch (kind) {
+        case DataChannelKind::VIDEO: return "video";
+        case DataChannelKind::INPUT: return "input";
+        case DataChannelKind::CONTROL: return "control";
+    }
+    return "unknown";
+}
+
+DataChannelMux::DataChannelMux(std::shared_ptr<IDatagramChannel> transport)
+    : m_transport(std::move(transport)) {
+    for (size_t i = 0; i < DATA_CHANNEL_KIND_COUNT; ++i) {
+        m_send[i].reliability = DefaultDataChannelReliability(static_cast<DataChannelKind>(i));
+    }
+}
+
+void DataChannelMux::Configure(DataChannelKind kind, const DataChannelReliability& reliability) {
+    m_send[static_cast<size_t>(kind)].reliability = reliability;
+}
+
+const DataChannelReliability& DataChannelMux::GetReliability(DataChannelKind kind) const {
+    return m_send[static_cast<size_t>(kind)].reliability;
+}
+
+bool DataChannelMux::Send(DataChannelKind kind, std::span<const uint8_t> data, uint64_t nowUs) {
+    size_t channel = static_cast<size_t>(kind);
+    if (!m_transport || channel >= DATA_CHANNEL_KIND_COUNT || data.empty()) {
+        return false;
+    }
+
+    size_t fragCount = (data.size() + MAX_FRAGMENT_PAYLOAD - 1) / MAX_FRAGMENT_PAYLOAD;
+    if (fragCount > UINT16_MAX) {
+        return false;
+    }
+
+    SendState& state = m_send[channel];
+    RefillTokens(nowUs);
+
+    // Caminho direto (sem cópia): nada retido para retransmissão e a mensagem sai
+    // inteira agora. Senão, uma cópia compartilhada entre fila e retransmissões
+    bool queuesEmpty = std::all_of(std::begin(m_send), std::end(m_send),
+                                   [](const SendState& s) { return s.queue.empty(); });
+    bool direct = queuesEmpty && !state.reliability.NeedsAck() &&
+                  (m_sendRateKbps <= 0.0 || m_tokensBytes >= static_cast<double>(data.size()));
+    if (!direct) {
+        return Enqueue(channel, std::make_shared<const std::vector<uint8_t>>(data.begin(), data.end()), nowUs);
+    }
+
+    uint8_t flags = state.reliability.ordered ? FLAG_ORDERED : 0;
+    uint32_t floor = Floor(state);
+    uint32_t msgSeq = state.nextMsgSeq++;
+
+    bool ok = true;
+    for (size_t fragIndex = 0; fragIndex < fragCount; ++fragIndex) {
+        size_t offset = fragIndex * MAX_FRAGMENT_PAYLOAD;
+        size_t chunk = std::min(MAX_FRAGMENT_PAYLOAD, data.size() - offset);
+        ok = TransmitData(channel, state.nextTsn++, msgSeq, floor, static_cast<uint16_t>(fragIndex),
+                          static_cast<uint16_t>(fragCount), flags, data.data() + offset, chunk) && ok;
+    }
+
+    m_stats[channel].messagesSent++;
+    return ok;
+}
+
+bool DataChannelMux::Send(DataChannelKind kind, SharedBuffer buffer, uint64_t nowUs) {
+    size_t channel = static_cast<size_t>(kind);
+    if (!m_transport || channel >= DATA_CHANNEL_KIND_COUNT || !buffer || buffer->empty() ||
+        (buffer->size() + MAX_FRAGMENT_PAYLOAD - 1) / MAX_FRAGMENT_PAYLOAD > UINT16_MAX) {
+        return false;
+    }
+
+    RefillTokens(nowUs);
+    return Enqueue(channel, std::move(buffer), nowUs);
+}
+
+bool DataChannelMux::Enqueue(size_t channel, SharedBuffer buffer, uint64_t nowUs) {
+    SendState& state = m_send[channel];
+    const DataChannelReliability& reliability = state.reliability;
+
+    PendingMessage message;
+    message.msgSeq = state.nextMsgSeq++;
+    message.fragCount = static_cast<uint16_t>((buffer->size() + MAX_FRAGMENT_PAYLOAD - 1) / MAX_FRAGMENT_PAYLOAD);
+    message.flags = static_cast<uint8_t>((reliability.ordered ? FLAG_ORDERED : 0) |
+                                         (reliability.NeedsAck() ? FLAG_RELIABLE : 0));
+    message.maxRetransmits = reliability.maxRetransmits;
+    message.lifetimeMs = reliability.maxPacketLifeTimeMs;
+    message.enqueueUs = nowUs;
+    state.queuedBytes += buffer->size();
+    message.buffer = std::move(buffer);
+    state.queue.push_back(std::move(message));
+    m_stats[channel].messagesSent++;
+
+    bool ok = DrainQueues(nowUs);
+    CheckWatermarks(channel);
+    return ok;
+}
+
+bool DataChannelMux::DrainQueues(uint64_t nowUs) {
+    bool ok = true;
+
+    for (DataChannelKind kind : DRAIN_ORDER) {
+        size_t channel = static_cast<size_t>(kind);
+        SendState& state = m_send[channel];
+
+        // Tempo de vida conta desde o Send: o que expirou na fila não sai mais
+        for (auto it = state.queue.begin(); it != state.queue.end();) {
+            bool expired = it->lifetimeMs > 0 &&
+                           nowUs - it->enqueueUs >= static_cast<uint64_t>(it->lifetimeMs) * 1000;
+            if (!expired) {
+                ++it;
+                continue;
+            }
+            state.queuedBytes -= it->buffer->size() - std::min(it->buffer->size(),
+                                                               it->nextFragment * MAX_FRAGMENT_PAYLOAD);
+            if (it->nextFragment > 0 && (it->flags & FLAG_RELIABLE)) {
+                Abandon(channel, it->msgSeq);
+            } else {
+                m_stats[channel].messagesAbandoned++;
+            }
+            if (it->flags & FLAG_RELIABLE) {
+                state.forwardRepeats = FORWARD_REPEATS;
+            }
+            it = state.queue.erase(it);
+        }
+
+        while (!state.queue.empty()) {
+            if (m_sendRateKbps > 0.0 && m_tokensBytes <= 0.0) {
+                return ok;
+            }
+            PendingMessage& message = state.queue.front();
+            ok = SendFragment(channel, message, nowUs) && ok;
+            if (message.nextFragment == message.fragCount) {
+                state.queue.pop_front();
+            }
+        }
+    }
+    return ok;
+}
+
+bool DataChannelMux::SendFragment(size_t channel, PendingMessage& message, uint64_t nowUs) {
+    SendState& state = m_send[channel];
+    size_t offset = static_cast<size_t>(message.nextFragment) * MAX_FRAGMENT_PAYLOAD;
+    size_t chunk = std::min(MAX_FRAGMENT_PAYLOAD, message.buffer->size() - offset);
+    uint32_t tsn = state.nextTsn++;
+
+    bool ok = TransmitData(channel, tsn, message.msgSeq, Floor(state), message.nextFragment,
+                           message.fragCount, message.flags, message.buffer->data() + offset, chunk);
+    state.queuedBytes -= chunk;
+
+    if (message.flags & FLAG_RELIABLE) {
+        OutPacket& packet = state.outstanding[tsn];
+        packet.buffer = message.buffer;
+        packet.offset = offset;
+        packet.size = chunk;
+        packet.msgSeq = message.msgSeq;
+        packet.fragIndex = message.nextFragment;
+        packet.fragCount = message.fragCount;
+        packet.flags = message.flags;
+        packet.firstSendUs = message.enqueueUs;
+        packet.lastSendUs = nowUs;
+        packet.maxRetransmits = message.maxRetransmits;
+        packet.lifetimeMs = message.lifetimeMs;
+        state.outstandingBytes += chunk;
+    }
+
+    message.nextFragment++;
+    return ok;
+}
+
+bool DataChannelMux::TransmitData(size_t channel, uint32_t tsn, uint32_t msgSeq, uint32_t floor,
+                                  uint16_t fragIndex, uint16_t fragCount, uint8_t flags,
+                                  const uint8_t* payload, size_t size) {
+    std::vector<uint8_t>& datagram = m_sendScratch;
+    datagram.clear();
+    datagram.push_back(TYPE_DATA);
+    datagram.push_back(static_cast<uint8_t>(channel));
+    PutU32(datagram, tsn);
+    PutU32(datagram, msgSeq);
+    PutU32(datagram, floor);
+    PutU16(datagram, fragIndex);
+    PutU16(datagram, fragCount);
+    datagram.push_back(flags);
+    datagram.insert(datagram.end(), payload, payload + size);
+
+    if (m_sendRateKbps > 0.0) {
+        m_tokensBytes -= static_cast<double>(datagram.size());
+    }
+    return Transmit(channel, datagram);
+}
+
+void DataChannelMux::SetSendRateKbps(double kbps) {
+    kbps = std::max(0.0, kbps);
+    if (m_sendRateKbps <= 0.0) {
+        m_pacerPrimed = false;      // Começa com o burst cheio
+    }
+    m_sendRateKbps = kbps;
+}
+
+void DataChannelMux::RefillTokens(uint64_t nowUs) {
+    if (m_sendRateKbps <= 0.0) {
+        return;
+    }
+
+    double bytesPerUs = m_sendRateKbps * 1000.0 / 8.0 / 1e6;
+    double burstBytes = std::max(PACER_MIN_BURST_BYTES, bytesPerUs * PACER_BURST_US);
+    if (!m_pacerPrimed) {
+        m_pacerPrimed = true;
+        m_tokensBytes = burstBytes;
+    } else if (nowUs > m_lastRefillUs) {
+        m_tokensBytes = std::min(burstBytes, m_tokensBytes + bytesPerUs * (nowUs - m_lastRefillUs));
+    }
+    m_lastRefillUs = std::max(m_lastRefillUs, nowUs);
+}
+
+size_t DataChannelMux::GetBufferedAmount(DataChannelKind kind) const {
+    const SendState& state = m_send[static_cast<size_t>(kind)];
+    return state.queuedBytes + state.outstandingBytes;
+}
+
+void DataChannelMux::SetBufferedAmountThresholds(DataChannelKind kind, size_t lowBytes, size_t highBytes) {
+    SendState& state = m_send[static_cast<size_t>(kind)];
+    state.lowWatermark = lowBytes;
+    state.highWatermark = std::max(lowBytes, highBytes);
+    state.aboveLow = GetBufferedAmount(kind) > state.lowWatermark;
+    state.aboveHigh = IsAboveHighWatermark(kind);
+}
+
+void DataChannelMux::SetBufferedAmountCallbacks(BufferedAmountCallback onLow, BufferedAmountCallback onHigh) {
+    m_onBufferedAmountLow = std::move(onLow);
+    m_onBufferedAmountHigh = std::move(onHigh);
+}
+
+bool DataChannelMux::IsAboveHighWatermark(DataChannelKind kind) const {
+    const SendState& state = m_send[static_cast<size_t>(kind)];
+    return state.highWatermark > 0 && GetBufferedAmount(kind) > state.highWatermark;
+}
+
+size_t DataChannelMux::DropPendingMessages(DataChannelKind kind) {
+    size_t channel = static_cast<size_t>(kind);
+    SendState& state = m_send[channel];
+
+    size_t dropped = 0;
+    for (auto it = state.queue.begin(); it != state.queue.end();) {
+        if (it->nextFragment > 0) {
+            ++it;
+            continue;
+        }
+        if (it->flags & FLAG_RELIABLE) {
+            state.forwardRepeats = FORWARD_REPEATS;
+        }
+        state.queuedBytes -= it->buffer->size();
+        it = state.queue.erase(it);
+        dropped++;
+    }
+
+    m_stats[channel].messagesAbandoned += dropped;
+    CheckWatermarks(channel);
+    return dropped;
+}
+
+void DataChannelMux::CheckWatermarks(size_t channel) {
+    SendState& state = m_send[channel];
+    if (state.highWatermark == 0) {
+        return;
+    }
+
+    auto kind = static_cast<DataChannelKind>(channel);
+    size_t amount = state.queuedBytes + state.outstandingBytes;
+
+    if (amount > state.highWatermark) {
+        if (!state.aboveHigh) {
+            state.aboveHigh = true;
+            if (m_onBufferedAmountHigh) {
+                m_onBufferedAmountHigh(kind, amount);
+            }
+        }
+    } else {
+        state.aboveHigh = false;
+    }
+
+    // Mesma semântica do bufferedamountlow: dispara ao descer até o limite
+    if (amount > state.lowWatermark) {
+        state.aboveLow = true;
+    } else if (state.aboveLow) {
+        state.aboveLow = false;
+        if (m_onBufferedAmountLow) {
+            m_onBufferedAmountLow(kind, amount);
+        }
+    }
+}
+
+void DataChannelMux::Poll(uint64_t nowUs) {
+    if (!m_transport) {
+        return;
+    }
+
+    while (m_transport->Receive(m_scratch)) {
+        HandleDatagram(m_scratch.data(), m_scratch.size(), nowUs);
+    }
+
+    RefillTokens(nowUs);
+    for (size_t channel = 0; channel < DATA_CHANNEL_KIND_COUNT; ++channel) {
+        SendAcks(channel);
+        ServiceTimers(channel, nowUs);
+    }
+    DrainQueues(nowUs);
+
+    for (size_t channel = 0; channel < DATA_CHANNEL_KIND_COUNT; ++channel) {
+        CheckWatermarks(channel);
+
+        // Remontagens sem retransmissão que não vão mais completar
+        ReceiveState& receive = m_receive[channel];
+        for (auto it = receive.partial.begin(); it != receive.partial.end();) {
+            bool expired = !it->second.reliable &&
+                           nowUs - it->second.firstArrivalUs > UNRELIABLE_REASSEMBLY_TIMEOUT_US;
+            if (expired) {
+                m_stats[channel].messagesDropped++;
+                it = receive.partial.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool DataChannelMux::Receive(DataChannelKind& outKind, std::vector<uint8_t>& outData) {
+    if (m_delivered.empty()) {
+        return false;
+    }
+    outKind = m_delivered.front().first;
+    outData = std::move(m_delivered.front().second);
+    m_delivered.pop_front();
+    return true;
+}
+
+size_t DataChannelMux::GetOutstandingBytes(DataChannelKind kind) const {
+    return m_send[static_cast<size_t>(kind)].outstandingBytes;
+}
+
+DataChannelMux::ChannelStats DataChannelMux::GetStats(DataChannelKind kind) const {
+    return m_stats[static_cast<size_t>(kind)];
+}
+
+void DataChannelMux::HandleDatagram(const uint8_t* data, size_t size, uint64_t nowUs) {
+    if (size < 2 || data[1] >= DATA_CHANNEL_KIND_COUNT) {
+        return;
+    }
+
+    size_t channel = data[1];
+    m_stats[channel].bytesReceived += size;
+
+    switch (data[0]) {
+        case TYPE_DATA:
+            HandleData(channel, data, size, nowUs);
+            break;
+        case TYPE_ACK:
+            HandleAck(channel, data, size, nowUs);
+            break;
+        case TYPE_FORWARD:
+            if (size >= FORWARD_SIZE) {
+                AdvanceFloor(channel, GetU32(data + 2));
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void DataChannelMux::HandleData(size_t channel, const uint8_t* data, size_t size, uint64_t nowUs) {
+    if (size <= DATA_HEADER_SIZE) {
+        return;
+    }
+
+    uint32_t tsn = GetU32(data + 2);
+    uint32_t msgSeq = GetU32(data + 6);
+    uint32_t floor = GetU32(data + 10);
+    uint16_t fragIndex = GetU16(data + 14);
+    uint16_t fragCount = GetU16(data + 16);
+    uint8_t flags = data[18];
+    bool reliable = (flags & FLAG_RELIABLE) != 0;
+
+    if (fragCount == 0 || fragIndex >= fragCount) {
+        return;
+    }
+
+    ReceiveState& receive = m_receive[channel];
+    if (reliable) {
+        // Confirma mesmo duplicatas: o ACK anterior pode ter se perdido
+        receive.pendingAcks.push_back(tsn);
+        AdvanceFloor(channel, floor);
+        if (msgSeq < receive.floor) {
+            return;
+        }
+    }
+
+    if ((flags & FLAG_ORDERED) && msgSeq < receive.nextDeliver) {
+        return;
+    }
+
+    const uint8_t* payload = data + DATA_HEADER_SIZE;
+    size_t payloadSize = size - DATA_HEADER_SIZE;
+
+    if (fragCount == 1) {
+        CompleteMessage(channel, msgSeq, flags, std::vector<uint8_t>(payload, payload + payloadSize));
+        return;
+    }
+
+    auto found = receive.partial.find(msgSeq);
+    if (found == receive.partial.end()) {
+        if (!reliable && receive.partial.size() >= MAX_UNRELIABLE_PARTIAL) {
+            receive.partial.erase(receive.partial.begin());
+            m_stats[channel].messagesDropped++;
+        }
+        Reassembly& created = receive.partial[msgSeq];
+        created.fragments.resize(fragCount);
+        created.present.assign(fragCount, false);
+        created.reliable = reliable;
+        created.firstArrivalUs = nowUs;
+        found = receive.partial.find(msgSeq);
+    }
+
+    Reassembly& reassembly = found->second;
+    if (reassembly.fragments.size() != fragCount || reassembly.present[fragIndex]) {
+        return;
+    }
+
+    reassembly.fragments[fragIndex].assign(payload, payload + payloadSize);
+    reassembly.present[fragIndex] = true;
+    if (++reassembly.received < fragCount) {
+        return;
+    }
+
+    size_t total = 0;
+    for (const auto& fragment : reassembly.fragments) {
+        total += fragment.size();
+    }
+    std::vector<uint8_t> message;
+    message.reserve(total);
+    for (const auto& fragment : reassembly.fragments) {
+        message.insert(message.end(), fragment.begin(), fragment.end());
+    }
+    receive.partial.erase(found);
+    CompleteMessage(channel, msgSeq, flags, std::move(message));
+}
+
+void DataChannelMux::CompleteMessage(size_t channel, uint32_t msgSeq, uint8_t flags,
+                                     std::vector<uint8_t>&& message) {
+    ReceiveState& receive = m_receive[channel];
+
+    if (!(flags & FLAG_ORDERED)) {
+        if (std::find(receive.recentDelivered.begin(), receive.recentDelivered.end(), msgSeq) !=
+            receive.recentDelivered.end()) {
+            return;
+        }
+        receive.recentDelivered.push_back(msgSeq);
+        if (receive.recentDelivered.size() > DEDUP_WINDOW) {
+            receive.recentDelivered.pop_front();
+        }
+        Deliver(channel, std::move(message));
+        return;
+    }
+
+    if (!(flags & FLAG_RELIABLE)) {
+        // Ordenado sem retransmissão: o que ficou para trás nunca chega a tempo
+        for (auto it = receive.partial.begin(); it != receive.partial.end() && it->first < msgSeq;) {
+            m_stats[channel].messagesDropped++;
+            it = receive.partial.erase(it);
+        }
+        receive.nextDeliver = msgSeq + 1;
+        Deliver(channel, std::move(message));
+        return;
+    }
+
+    if (msgSeq != receive.nextDeliver) {
+        receive.waiting.emplace(msgSeq, std::move(message));
+        return;
+    }
+
+    Deliver(channel, std::move(message));
+    receive.nextDeliver++;
+    for (auto it = receive.waiting.begin();
+         it != receive.waiting.end() && it->first == receive.nextDeliver;
+         it = receive.waiting.erase(it)) {
+        Deliver(channel, std::move(it->second));
+        receive.nextDeliver++;
+    }
+}
+
+void DataChannelMux::AdvanceFloor(size_t channel, uint32_t floor) {
+    ReceiveState& receive = m_receive[channel];
+    if (floor <= receive.floor) {
+        return;
+    }
+    receive.floor = floor;
+
+    // Abaixo do floor o sender desistiu do que não foi confirmado
+    for (auto it = receive.partial.begin(); it != receive.partial.end() && it->first < floor;) {
+        if (it->second.reliable) {
+            m_stats[channel].messagesDropped++;
+            it = receive.partial.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (floor <= receive.nextDeliver) {
+        return;
+    }
+
+    // Canal ordenado: entrega o que já estava completo e pula os buracos abandonados
+    for (auto it = receive.waiting.begin(); it != receive.waiting.end() && it->first < floor;
+         it = receive.waiting.erase(it)) {
+        Deliver(channel, std::move(it->second));
+    }
+    receive.nextDeliver = floor;
+    for (auto it = receive.waiting.begin();
+         it != receive.waiting.end() && it->first == receive.nextDeliver;
+         it = receive.waiting.erase(it)) {
+        Deliver(channel, std::move(it->second));
+        receive.nextDeliver++;
+    }
+}
+
+void DataChannelMux::Deliver(size_t channel, std::vector<uint8_t>&& message) {
+    m_stats[channel].messagesDelivered++;
+    m_delivered.emplace_back(static_cast<DataChannelKind>(channel), std::move(message));
+}
+
+void DataChannelMux::HandleAck(size_t channel, const uint8_t* data, size_t size, uint64_t nowUs) {
+    if (size < ACK_HEADER_SIZE) {
+        return;
+    }
+
+    size_t count = GetU16(data + 2);
+    if (size < ACK_HEADER_SIZE + count * 4) {
+        return;
+    }
+
+    SendState& state = m_send[channel];
+    for (size_t i = 0; i < count; ++i) {
+        auto found = state.outstanding.find(GetU32(data + ACK_HEADER_SIZE + i * 4));
+        if (found == state.outstanding.end()) {
+            continue;
+        }
+        // Karn: só pacotes transmitidos uma vez dão amostra de RTT
+        if (found->second.retransmits == 0) {
+            AddRttSample(nowUs - found->second.lastSendUs);
+        }
+        state.outstandingBytes -= found->second.size;
+        state.outstanding.erase(found);
+    }
+}
+
+void DataChannelMux::ServiceTimers(size_t channel, uint64_t nowUs) {
+    SendState& state = m_send[channel];
+    uint64_t rtoUs = RetransmitTimeoutUs();
+
+    std::vector<uint32_t> abandoned;
+    for (auto& [tsn, packet] : state.outstanding) {
+        if (!abandoned.empty() && abandoned.back() == packet.msgSeq) {
+            continue;
+        }
+
+        bool expired = packet.lifetimeMs > 0 &&
+                       nowUs - packet.firstSendUs >= static_cast<uint64_t>(packet.lifetimeMs) * 1000;
+        if (!expired && nowUs - packet.lastSendUs < rtoUs) {
+            continue;
+        }
+        if (expired || (packet.maxRetransmits >= 0 && packet.retransmits >= packet.maxRetransmits)) {
+            abandoned.push_back(packet.msgSeq);
+            continue;
+        }
+
+        packet.retransmits++;
+        packet.lastSendUs = nowUs;
+        m_stats[channel].retransmissions++;
+        TransmitData(channel, tsn, packet.msgSeq, Floor(state), packet.fragIndex, packet.fragCount,
+                     packet.flags, packet.buffer->data() + packet.offset, packet.size);
+    }
+
+    for (uint32_t msgSeq : abandoned) {
+        Abandon(channel, msgSeq);
+    }
+
+    if (!abandoned.empty()) {
+        state.forwardRepeats = FORWARD_REPEATS;
+        SendForward(channel, nowUs);
+    } else if (state.forwardRepeats > 0 && nowUs - state.lastForwardUs >= rtoUs) {
+        SendForward(channel, nowUs);
+    }
+}
+
+void DataChannelMux::Abandon(size_t channel, uint32_t msgSeq) {
+    SendState& state = m_send[channel];
+    for (auto it = state.outstanding.begin(); it != state.outstanding.end();) {
+        if (it->second.msgSeq == msgSeq) {
+            state.outstandingBytes -= it->second.size;
+            it = state.outstanding.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_stats[channel].messagesAbandoned++;
+}
+
+void DataChannelMux::SendAcks(size_t channel) {
+    std::vector<uint32_t>& pending = m_receive[channel].pendingAcks;
+    for (size_t offset = 0; offset < pending.size(); offset += ACKS_PER_DATAGRAM) {
+        size_t count = std::min(ACKS_PER_DATAGRAM, pending.size() - offset);
+        std::vector<uint8_t> datagram;
+        datagram.reserve(ACK_HEADER_SIZE + count * 4);
+        datagram.push_back(TYPE_ACK);
+        datagram.push_back(static_cast<uint8_t>(channel));
+        PutU16(datagram, static_cast<uint16_t>(count));
+        for (size_t i = 0; i < count; ++i) {
+            PutU32(datagram, pending[offset + i]);
+        }
+        Transmit(channel, datagram);
+    }
+    pending.clear();
+}
+
+void DataChannelMux::SendForward(size_t channel, uint64_t nowUs) {
+    SendState& state = m_send[channel];
+    std::vector<uint8_t> datagram;
+    datagram.push_back(TYPE_FORWARD);
+    datagram.push_back(static_cast<uint8_t>(channel));
+    PutU32(datagram, Floor(state));
+    Transmit(channel, datagram);
+    state.lastForwardUs = nowUs;
+    if (state.forwardRepeats > 0) {
+        state.forwardRepeats--;
+    }
+}
+
+bool DataChannelMux::Transmit(size_t channel, const std::vector<uint8_t>& datagram) {
+    m_stats[channel].datagramsSent++;
+    m_stats[channel].bytesSent += datagram.size();
+    return m_transport->Send(datagram.data(), datagram.size());
+}
+
+uint32_t DataChannelMux::Floor(const SendState& state) const {
+    // tsn e msgSeq crescem juntos: o primeiro pacote pendente tem a menor mensagem,
+    // e a fila só tem mensagens mais novas que as já enviadas
+    if (!state.outstanding.empty()) {
+        return state.outstanding.begin()->second.msgSeq;
+    }
+    return state.queue.empty() ? state.nextMsgSeq : state.queue.front().msgSeq;
+}
+
+uint64_t DataChannelMux::RetransmitTimeoutUs() const {
+    if (m_srttUs <= 0.0) {
+        return INITIAL_RTO_US;
+    }
+    double rto = m_srttUs + std::max(4.0 * m_rttVarUs, MIN_RTO_SLACK_US);
+    return std::clamp(static_cast<uint64_t>(rto), MIN_RTO_US, MAX_RTO_US);
+}
+
+void DataChannelMux::AddRttSample(uint64_t sampleUs) {
+    // RFC 6298
+    double sample = static_cast<double>(sampleUs);
+    if (m_srttUs <= 0.0) {
+        m_srttUs = sample;
+        m_rttVarUs = sample / 2.0;
+        return;
+    }
+    m_rttVarUs = 0.75 * m_rttVarUs + 0.25 * std::abs(m_srttUs - sample);
+    m_srttUs = 0.875 * m_srttUs + 0.125 * sample;
+}
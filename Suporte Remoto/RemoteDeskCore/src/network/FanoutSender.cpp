@@ -0,0 +1,441 @@
+#include "FanoutSender.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// Mensagens de controle lidas por viewer a cada Service (o resto fica para a próxima)
+constexpr size_t MAX_MESSAGES_PER_SERVICE = 64;
+
+// Simulcast: janela do bitrate por camada e suavização entre janelas
+constexpr uint64_t LAYER_RATE_WINDOW_US = 1000000;
+constexpr double LAYER_RATE_ALPHA = 0.3;
+
+// Subir de camada: alvo >= bitrate da camada * margem, sustentado por LAYER_UP_HOLD_US
+constexpr double LAYER_UP_MARGIN = 1.2;
+constexpr uint64_t LAYER_UP_HOLD_US = 2000000;
+
+// Ritmo do viewer = alvo do controlador com folga (keyframes e rajadas da camada)
+constexpr double PACING_HEADROOM = 1.25;
+
+uint64_t WallNowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+FanoutSender::FanoutSender(const FanoutConfig& config)
+    : m_config(config) {
+}
+
+FanoutSender::ViewerId FanoutSender::AddViewer(std::unique_ptr<P2PManager> transport,
+                                               const FanoutViewerConfig& config) {
+    if (!transport) {
+        return 0;
+    }
+
+    Viewer viewer;
+    viewer.id = m_nextId++;
+    viewer.transport = std::move(transport);
+    viewer.config = config;
+    viewer.layer = std::min<uint8_t>(config.layer, MAX_SIMULCAST_LAYERS - 1);
+    viewer.targetLayer = viewer.layer;
+    viewer.tokens = config.burstBytes;
+    viewer.stats.id = viewer.id;
+    m_viewers.push_back(std::move(viewer));
+    return m_viewers.back().id;
+}
+
+bool FanoutSender::RemoveViewer(ViewerId id) {
+    auto it = std::find_if(m_viewers.begin(), m_viewers.end(),
+                           [id](const Viewer& viewer) { return viewer.id == id; });
+    if (it == m_viewers.end()) {
+        return false;
+    }
+    m_viewers.erase(it);
+    return true;
+}
+
+FanoutSender::Viewer* FanoutSender::FindViewer(ViewerId id) {
+    for (Viewer& viewer : m_viewers) {
+        if (viewer.id == id) {
+            return &viewer;
+        }
+    }
+    return nullptr;
+}
+
+bool FanoutSender::SetViewerRate(ViewerId id, double maxRateKbps) {
+    Viewer* viewer = FindViewer(id);
+    if (!viewer) {
+        return false;
+    }
+    viewer->config.maxRateKbps = std::max(0.0, maxRateKbps);
+    return true;
+}
+
+bool FanoutSender::SetViewerLayer(ViewerId id, uint8_t layer) {
+    Viewer* viewer = FindViewer(id);
+    if (!viewer || layer >= MAX_SIMULCAST_LAYERS) {
+        return false;
+    }
+    viewer->targetLayer = layer;
+    viewer->hasLayerUp = false;
+    return true;
+}
+
+bool FanoutSender::UpdateViewerTarget(ViewerId id, double targetKbps, uint64_t nowUs) {
+    Viewer* viewer = FindViewer(id);
+    if (!viewer) {
+        return false;
+    }
+
+    viewer->targetKbps = std::max(0.0, targetKbps);
+    viewer->config.maxRateKbps = viewer->targetKbps * PACING_HEADROOM;
+
+    // Maior camada já medida que cabe no alvo (a 0 sempre serve)
+    uint8_t best = 0;
+    for (uint8_t layer = 1; layer < m_layerCount; ++layer) {
+        if (m_layerKbps[layer] > 0.0 && m_layerKbps[layer] <= viewer->targetKbps) {
+            best = layer;
+        }
+    }
+
+    if (best < viewer->targetLayer) {
+        viewer->targetLayer = best;
+        viewer->hasLayerUp = false;
+    } else if (best > viewer->targetLayer) {
+        // Sobe uma camada por vez, com folga sustentada
+        uint8_t next = static_cast<uint8_t>(viewer->targetLayer + 1);
+        if (viewer->targetKbps < m_layerKbps[next] * LAYER_UP_MARGIN) {
+            viewer->hasLayerUp = false;
+        } else if (!viewer->hasLayerUp) {
+            viewer->hasLayerUp = true;
+            viewer->layerUpSinceUs = nowUs;
+        } else if (nowUs - viewer->layerUpSinceUs >= LAYER_UP_HOLD_US) {
+            viewer->targetLayer = next;
+            viewer->hasLayerUp = false;
+        }
+    } else {
+        viewer->hasLayerUp = false;
+    }
+    return true;
+}
+
+double FanoutSender::GetLayerBitrateKbps(uint8_t layer) const {
+    return layer < MAX_SIMULCAST_LAYERS ? m_layerKbps[layer] : 0.0;
+}
+
+P2PManager* FanoutSender::GetViewerTransport(ViewerId id) {
+    Viewer* viewer = FindViewer(id);
+    return viewer ? viewer->transport.get() : nullptr;
+}
+
+uint32_t FanoutSender::KeyframeLayerMask(uint64_t nowUs) const {
+    // Troca de camada pendente pede keyframe na camada nova; senão, na atual
+    uint32_t waiting = 0;
+    for (const Viewer& viewer : m_viewers) {
+        if (viewer.targetLayer != viewer.layer) {
+            waiting |= 1u << viewer.targetLayer;
+        } else if (viewer.awaitingKeyframe) {
+            waiting |= 1u << viewer.layer;
+        }
+    }
+
+    uint32_t mask = 0;
+    for (uint8_t layer = 0; layer < MAX_SIMULCAST_LAYERS; ++layer) {
+        if ((waiting >> layer) & 1) {
+            if (!m_hasKeyframe[layer] || nowUs - m_lastKeyframeUs[layer] >= m_config.keyframeMinIntervalUs) {
+                mask |= 1u << layer;
+            }
+        }
+    }
+    return mask;
+}
+
+size_t FanoutSender::PublishFrame(const EncodedFrame& frame, uint32_t stride, uint16_t sequence,
+                                  uint8_t flags) {
+    RDC_TRACE_SCOPE("FanoutSender::PublishFrame");
+
+    if (frame.data.empty() || frame.layerId >= MAX_SIMULCAST_LAYERS) {
+        return 0;
+    }
+
+    NetworkFrameHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = NetworkFrameHeader::MAGIC;
+    header.version = NetworkFrameHeader::VERSION;
+    header.packetType = static_cast<uint8_t>(PacketType::FRAME);
+    header.frameSequence = sequence;
+    header.frameWidth = frame.width;
+    header.frameHeight = frame.height;
+    header.frameStride = stride;
+    header.pixelDataSize = static_cast<uint32_t>(frame.data.size());
+    header.timestamp = WallNowMs();
+    header.flags = static_cast<uint8_t>(flags | (frame.isKeyframe ? FRAME_FLAG_KEYFRAME : 0));
+    header.layerId = frame.layerId;
+
+    // Serialização única: o mesmo buffer é enviado a todos os viewers
+    auto datagram = std::make_shared<std::vector<uint8_t>>(sizeof(header) + frame.data.size());
+    std::memcpy(datagram->data(), &header, sizeof(header));
+    std::memcpy(datagram->data() + sizeof(header), frame.data.data(), frame.data.size());
+
+    SharedFrame shared;
+    shared.datagram = std::move(datagram);
+    shared.sequence = sequence;
+    shared.layer = frame.layerId;
+    shared.isKeyframe = frame.isKeyframe;
+
+    m_stats.framesPublished++;
+    m_stats.bytesSerialized += shared.datagram->size();
+    m_layerCount = std::max<uint8_t>(m_layerCount, frame.layerId + 1);
+    m_layerBytes[frame.layerId] += shared.datagram->size();
+    if (frame.isKeyframe) {
+        // Intervalo mínimo entre keyframes conta do último Service (relógio do chamador)
+        m_stats.keyframesPublished++;
+        m_lastKeyframeUs[frame.layerId] = m_lastServiceUs;
+        m_hasKeyframe[frame.layerId] = true;
+    }
+
+    size_t queued = 0;
+    for (Viewer& viewer : m_viewers) {
+        Enqueue(viewer, shared);
+        if (!viewer.queue.empty() && viewer.queue.back().datagram == shared.datagram) {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+void FanoutSender::Enqueue(Viewer& viewer, const SharedFrame& frame) {
+    if (frame.layer != viewer.layer) {
+        // Outra camada só entra como keyframe da camada escolhida: a troca
+        if (frame.layer != viewer.targetLayer || !frame.isKeyframe) {
+            return;
+        }
+        // O mesmo frame da fonte já entrou pela camada antiga: o keyframe o substitui
+        if (!viewer.queue.empty() && viewer.queue.back().sequence == frame.sequence) {
+            viewer.queue.pop_back();
+        }
+        viewer.layer = frame.layer;
+        viewer.awaitingKeyframe = false;
+        viewer.stats.layerSwitches++;
+    }
+
+    if (viewer.awaitingKeyframe) {
+        if (!frame.isKeyframe) {
+            viewer.stats.framesSkipped++;
+            return;
+        }
+        viewer.awaitingKeyframe = false;
+    }
+
+    if (frame.isKeyframe) {
+        // O keyframe substitui o que ainda estava na fila
+        viewer.stats.framesDropped += viewer.queue.size();
+        viewer.queue.clear();
+    } else if (viewer.queue.size() >= viewer.config.maxQueuedFrames) {
+        // Viewer mais lento que a fonte: descartar quebra a cadeia, então espera keyframe
+        viewer.stats.framesDropped += viewer.queue.size();
+        viewer.stats.framesSkipped++;
+        viewer.queue.clear();
+        viewer.awaitingKeyframe = true;
+        return;
+    }
+
+    viewer.queue.push_back(frame);
+}
+
+void FanoutSender::Service(uint64_t nowUs) {
+    RDC_TRACE_SCOPE("FanoutSender::Service");
+
+    m_lastServiceUs = nowUs;
+    SampleLayerBitrates(nowUs);
+    for (Viewer& viewer : m_viewers) {
+        HandleMessages(viewer, nowUs);
+        viewer.transport->ServiceTransportStats();
+        Drain(viewer, nowUs);
+    }
+}
+
+void FanoutSender::HandleMessages(Viewer& viewer, uint64_t nowUs) {
+    PacketType type;
+    for (size_t i = 0; i < MAX_MESSAGES_PER_SERVICE &&
+                       viewer.transport->ReceiveControlMessage(type, m_messageBuffer); ++i) {
+        if (type != PacketType::KEYFRAME_REQUEST) {
+            if (m_controlCallback) {
+                m_controlCallback(viewer.id, type, m_messageBuffer);
+            }
+            continue;
+        }
+        if (m_messageBuffer.size() != sizeof(KeyframeRequestMessage)) {
+            continue;
+        }
+
+        viewer.stats.keyframeRequests++;
+
+        // Pedido que cruzou com o último keyframe enviado a este viewer: ainda pode chegar
+        uint64_t holdoffUs = m_config.requestHoldoffUs +
+            static_cast<uint64_t>(viewer.transport->GetTransportStats().rttMs * 1000.0);
+        if (viewer.hasKeyframeSent && nowUs - viewer.lastKeyframeSentUs < holdoffUs) {
+            continue;
+        }
+
+        viewer.stats.framesDropped += viewer.queue.size();
+        viewer.queue.clear();
+        viewer.awaitingKeyframe = true;
+    }
+}
+
+void FanoutSender::Drain(Viewer& viewer, uint64_t nowUs) {
+    // Token bucket: crédito em bytes, até burstBytes; um frame maior que o crédito sai
+    // assim que o crédito fica positivo e deixa o saldo negativo
+    if (viewer.config.maxRateKbps > 0.0) {
+        if (viewer.hasRefill && nowUs > viewer.lastRefillUs) {
+            double elapsedS = (nowUs - viewer.lastRefillUs) / 1e6;
+            viewer.tokens = std::min<double>(viewer.config.burstBytes,
+                                             viewer.tokens + viewer.config.maxRateKbps * 125.0 * elapsedS);
+        }
+        viewer.lastRefillUs = nowUs;
+        viewer.hasRefill = true;
+    }
+
+    while (!viewer.queue.empty()) {
+        if (viewer.config.maxRateKbps > 0.0 && viewer.tokens < 0.0) {
+            break;
+        }
+
+        SharedFrame frame = std::move(viewer.queue.front());
+        viewer.queue.pop_front();
+
+        const std::vector<uint8_t>& datagram = *frame.datagram;
+        if (!viewer.transport->SendDatagram(datagram.data(), datagram.size())) {
+            // Frame perdido na saída (delta ou keyframe): os deltas da fila dependem
+            // dele, então o viewer espera o próximo keyframe
+            viewer.stats.sendFailures++;
+            viewer.stats.framesDropped += viewer.queue.size();
+            viewer.queue.clear();
+            viewer.awaitingKeyframe = true;
+            continue;
+        }
+
+        viewer.tokens -= static_cast<double>(datagram.size());
+        viewer.stats.framesSent++;
+        viewer.stats.bytesSent += datagram.size();
+        m_stats.datagramsSent++;
+        if (frame.isKeyframe) {
+            viewer.stats.keyframesSent++;
+            viewer.lastKeyframeSentUs = nowUs;
+            viewer.hasKeyframeSent = true;
+        }
+    }
+}
+
+void FanoutSender::SampleLayerBitrates(uint64_t nowUs) {
+    if (!m_hasLayerWindow) {
+        m_hasLayerWindow = true;
+        m_layerWindowStartUs = nowUs;
+        return;
+    }
+
+    uint64_t elapsedUs = nowUs - m_layerWindowStartUs;
+    if (elapsedUs < LAYER_RATE_WINDOW_US) {
+        return;
+    }
+
+    for (uint8_t layer = 0; layer < m_layerCount; ++layer) {
+        double kbps = m_layerBytes[layer] * 8.0 * 1000.0 / elapsedUs;
+        m_layerKbps[layer] = m_layerKbps[layer] > 0.0
+            ? (1.0 - LAYER_RATE_ALPHA) * m_layerKbps[layer] + LAYER_RATE_ALPHA * kbps
+            : kbps;
+        m_layerBytes[layer] = 0;
+    }
+    m_layerWindowStartUs = nowUs;
+}
+
+std::vector<FanoutSender::ViewerStats> FanoutSender::GetViewerStats() const {
+    std::vector<ViewerStats> result;
+    result.reserve(m_viewers.size());
+    for (const Viewer& viewer : m_viewers) {
+        ViewerStats stats = viewer.stats;
+        stats.queuedFrames = viewer.queue.size();
+        stats.awaitingKeyframe = viewer.awaitingKeyframe;
+        stats.maxRateKbps = viewer.config.maxRateKbps;
+        stats.targetKbps = viewer.targetKbps;
+        stats.layer = viewer.layer;
+        stats.targetLayer = viewer.targetLayer;
+        stats.idleMs = viewer.transport->GetIdleMs();
+        stats.transport = viewer.transport->GetTransportStats();
+        result.push_back(stats);
+    }
+    return result;
+}
+
+FanoutSender::Stats FanoutSender::GetStats() const {
+    Stats stats = m_stats;
+    stats.viewerCount = m_viewers.size();
+    return stats;
+}
+
+// ============== FrameChainTracker ==============
+
+bool FrameChainTracker::OnFrame(uint16_t sequence, uint8_t flags) {
+    bool isKeyframe = (flags & FRAME_FLAG_KEYFRAME) != 0;
+
+    // Diferença com sinal em 16 bits: a sequência dá a volta
+    int16_t ahead = static_cast<int16_t>(static_cast<uint16_t>(sequence - m_lastSequence));
+    if (m_hasDecoded && ahead <= 0) {
+        m_stats.framesStale++;
+        return false;
+    }
+
+    if (isKeyframe) {
+        m_stats.keyframes++;
+    } else if (m_broken) {
+        m_stats.framesUndecodable++;
+        return false;
+    } else if (ahead != 1) {
+        m_stats.gaps++;
+        m_stats.framesUndecodable++;
+        m_broken = true;
+        m_reason = KeyframeRequestReason::FRAME_GAP;
+        m_hasRequest = false;
+        return false;
+    }
+
+    m_broken = false;
+    m_hasDecoded = true;
+    m_lastSequence = sequence;
+    m_stats.framesDecodable++;
+    return true;
+}
+
+void FrameChainTracker::MarkUndecodable() {
+    m_stats.framesDecodable = m_stats.framesDecodable > 0 ? m_stats.framesDecodable - 1 : 0;
+    m_stats.framesUndecodable++;
+    m_broken = true;
+    m_reason = KeyframeRequestReason::UNDECODABLE;
+    m_hasRequest = false;
+}
+
+bool FrameChainTracker::PollKeyframeRequest(uint64_t nowMs, KeyframeRequestMessage& outMessage) {
+    if (!m_broken) {
+        return false;
+    }
+    if (m_hasRequest && nowMs - m_lastRequestMs < m_retryMs) {
+        return false;
+    }
+
+    std::memset(&outMessage, 0, sizeof(outMessage));
+    outMessage.lastSequence = m_hasDecoded ? m_lastSequence : 0;
+    outMessage.reason = static_cast<uint8_t>(m_reason);
+
+    m_hasRequest = true;
+    m_lastRequestMs = nowMs;
+    m_stats.requestsSent++;
+    return true;
+}
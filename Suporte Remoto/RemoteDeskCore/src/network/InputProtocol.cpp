@@ -0,0 +1,356 @@
+#include "InputProtocol.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint8_t TYPE_MASK = 0x0F;
+constexpr uint8_t FLAG_PRESSED = 0x80;
+
+// Varint de 64 bits ocupa no máximo 10 bytes
+constexpr int MAX_VARINT_BYTES = 10;
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutSigned(std::vector<uint8_t>& out, int64_t value) {
+    // Zigzag: valores pequenos de qualquer sinal viram varints curtos
+    PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_end(data + size) {}
+
+    bool Varint(uint64_t& outValue) {
+        outValue = 0;
+        for (int i = 0; i < MAX_VARINT_BYTES; ++i) {
+            if (m_data == m_end) {
+                return false;
+            }
+            uint8_t byte = *m_data++;
+            outValue |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Signed(int64_t& outValue) {
+        uint64_t raw;
+        if (!Varint(raw)) {
+            return false;
+        }
+        outValue = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        return true;
+    }
+
+    bool Byte(uint8_t& outValue) {
+        if (m_data == m_end) {
+            return false;
+        }
+        outValue = *m_data++;
+        return true;
+    }
+
+    bool AtEnd() const { return m_data == m_end; }
+
+private:
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+};
+
+bool IsDiscrete(const InputEvent& event) {
+    return event.type != InputEventType::MOUSE_MOVE;
+}
+
+} // namespace
+
+bool InputPressedState::Apply(const InputEvent& event) {
+    if (event.type == InputEventType::MOUSE_BUTTON) {
+        uint8_t bit = static_cast<uint8_t>(1u << static_cast<uint8_t>(event.button));
+        uint8_t previous = buttons;
+        buttons = event.pressed ? static_cast<uint8_t>(buttons | bit) : static_cast<uint8_t>(buttons & ~bit);
+        return buttons != previous;
+    }
+
+    if (event.type == InputEventType::KEY) {
+        auto it = std::lower_bound(keys.begin(), keys.end(), event.virtualKey);
+        bool present = it != keys.end() && *it == event.virtualKey;
+        if (event.pressed && !present && keys.size() < INPUT_MAX_PRESSED_KEYS) {
+            keys.insert(it, event.virtualKey);
+            return true;
+        }
+        if (!event.pressed && present) {
+            keys.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputPressedState::IsKeyPressed(uint16_t virtualKey) const {
+    return std::binary_search(keys.begin(), keys.end(), virtualKey);
+}
+
+InputEvent InputEvent::MouseMove(int32_t x, int32_t y, uint64_t timestampUs) {
+    InputEvent event;
+    event.type = InputEventType::MOUSE_MOVE;
+    event.x = std::clamp(x, 0, INPUT_COORD_MAX);
+    event.y = std::clamp(y, 0, INPUT_COORD_MAX);
+    event.timestampUs = timestampUs;
+    return event;
+}
+
+InputEvent InputEvent::MouseButton(InputMouseButton button, bool pressed, uint64_t timestampUs) {
+    InputEvent event;
+    event.type = InputEventType::MOUSE_BUTTON;
+    event.button = button;
+    event.pressed = pressed;
+    event.timestampUs = timestampUs;
+    return event;
+}
+
+InputEvent InputEvent::MouseWheel(int32_t delta, uint64_t timestampUs) {
+    InputEvent event;
+    event.type = InputEventType::MOUSE_WHEEL;
+    event.wheelDelta = delta;
+    event.timestampUs = timestampUs;
+    return event;
+}
+
+InputEvent InputEvent::Key(uint16_t virtualKey, bool pressed, uint64_t timestampUs) {
+    InputEvent event;
+    event.type = InputEventType::KEY;
+    event.virtualKey = virtualKey;
+    event.pressed = pressed;
+    event.timestampUs = timestampUs;
+    return event;
+}
+
+void EncodeInputBatch(uint32_t sequence, const InputEvent* events, size_t count,
+                      std::vector<uint8_t>& outPayload, const InputPressedState* state) {
+    outPayload.clear();
+
+    const uint64_t baseTimestamp = count > 0 ? events[0].timestampUs : 0;
+    PutVarint(outPayload, sequence);
+    PutVarint(outPayload, baseTimestamp);
+    PutVarint(outPayload, count);
+
+    uint64_t lastTimestamp = baseTimestamp;
+    int32_t lastX = 0;
+    int32_t lastY = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const InputEvent& event = events[i];
+
+        uint8_t typeByte = static_cast<uint8_t>(event.type);
+        if (event.pressed) {
+            typeByte |= FLAG_PRESSED;
+        }
+        outPayload.push_back(typeByte);
+
+        // Timestamps não decrescem dentro do lote
+        uint64_t timestamp = std::max(event.timestampUs, lastTimestamp);
+        PutVarint(outPayload, timestamp - lastTimestamp);
+        lastTimestamp = timestamp;
+
+        switch (event.type) {
+            case InputEventType::MOUSE_MOVE:
+                PutSigned(outPayload, static_cast<int64_t>(event.x) - lastX);
+                PutSigned(outPayload, static_cast<int64_t>(event.y) - lastY);
+                lastX = event.x;
+                lastY = event.y;
+                break;
+
+            case InputEventType::MOUSE_BUTTON:
+                PutVarint(outPayload, static_cast<uint8_t>(event.button));
+                break;
+
+            case InputEventType::MOUSE_WHEEL:
+                PutSigned(outPayload, event.wheelDelta);
+                break;
+
+            case InputEventType::KEY:
+                PutVarint(outPayload, event.virtualKey);
+                break;
+        }
+    }
+
+    if (state) {
+        const size_t keyCount = std::min(state->keys.size(), INPUT_MAX_PRESSED_KEYS);
+        PutVarint(outPayload, state->buttons);
+        PutVarint(outPayload, keyCount);
+        for (size_t i = 0; i < keyCount; ++i) {
+            PutVarint(outPayload, state->keys[i]);
+        }
+    }
+}
+
+bool DecodeInputBatch(const uint8_t* data, size_t size, InputBatch& outBatch) {
+    if (!data) {
+        return false;
+    }
+
+    Reader reader(data, size);
+    uint64_t sequence, timestamp, count;
+    if (!reader.Varint(sequence) || !reader.Varint(timestamp) || !reader.Varint(count) ||
+        count > INPUT_MAX_BATCH_EVENTS) {
+        return false;
+    }
+
+    outBatch.sequence = static_cast<uint32_t>(sequence);
+    outBatch.events.clear();
+    outBatch.events.reserve(static_cast<size_t>(count));
+
+    int64_t lastX = 0;
+    int64_t lastY = 0;
+
+    for (uint64_t i = 0; i < count; ++i) {
+        uint8_t typeByte;
+        uint64_t deltaUs;
+        if (!reader.Byte(typeByte) || !reader.Varint(deltaUs)) {
+            return false;
+        }
+
+        InputEvent event;
+        event.pressed = (typeByte & FLAG_PRESSED) != 0;
+        timestamp += deltaUs;
+        event.timestampUs = timestamp;
+
+        uint64_t value;
+        int64_t dx, dy, delta;
+        switch (typeByte & TYPE_MASK) {
+            case static_cast<uint8_t>(InputEventType::MOUSE_MOVE):
+                if (!reader.Signed(dx) || !reader.Signed(dy)) {
+                    return false;
+                }
+                lastX += dx;
+                lastY += dy;
+                if (lastX < 0 || lastX > INPUT_COORD_MAX || lastY < 0 || lastY > INPUT_COORD_MAX) {
+                    return false;
+                }
+                event.type = InputEventType::MOUSE_MOVE;
+                event.x = static_cast<int32_t>(lastX);
+                event.y = static_cast<int32_t>(lastY);
+                break;
+
+            case static_cast<uint8_t>(InputEventType::MOUSE_BUTTON):
+                if (!reader.Varint(value) || value > static_cast<uint8_t>(InputMouseButton::X2)) {
+                    return false;
+                }
+                event.type = InputEventType::MOUSE_BUTTON;
+                event.button = static_cast<InputMouseButton>(value);
+                break;
+
+            case static_cast<uint8_t>(InputEventType::MOUSE_WHEEL):
+                if (!reader.Signed(delta) || delta < INT32_MIN || delta > INT32_MAX) {
+                    return false;
+                }
+                event.type = InputEventType::MOUSE_WHEEL;
+                event.wheelDelta = static_cast<int32_t>(delta);
+                break;
+
+            case static_cast<uint8_t>(InputEventType::KEY):
+                if (!reader.Varint(value) || value > 0xFFFF) {
+                    return false;
+                }
+                event.type = InputEventType::KEY;
+                event.virtualKey = static_cast<uint16_t>(value);
+                break;
+
+            default:
+                return false;
+        }
+
+        outBatch.events.push_back(event);
+    }
+
+    // Estado opcional no fim
+    outBatch.hasState = !reader.AtEnd();
+    outBatch.state.buttons = 0;
+    outBatch.state.keys.clear();
+    if (outBatch.hasState) {
+        uint64_t buttons, keyCount;
+        if (!reader.Varint(buttons) || buttons > 0xFF || !reader.Varint(keyCount) ||
+            keyCount > INPUT_MAX_PRESSED_KEYS) {
+            return false;
+        }
+        outBatch.state.buttons = static_cast<uint8_t>(buttons);
+        for (uint64_t i = 0; i < keyCount; ++i) {
+            uint64_t virtualKey;
+            if (!reader.Varint(virtualKey) || virtualKey > 0xFFFF) {
+                return false;
+            }
+            outBatch.state.keys.push_back(static_cast<uint16_t>(virtualKey));
+        }
+        std::sort(outBatch.state.keys.begin(), outBatch.state.keys.end());
+    }
+
+    return reader.AtEnd();
+}
+
+void InputBatcher::Push(const InputEvent& event) {
+    m_stats.eventsPushed++;
+
+    // Movimento seguido de movimento: só a última posição importa. Nunca funde
+    // através de um botão/tecla, então a ordem dos eventos discretos é preservada
+    if (event.type == InputEventType::MOUSE_MOVE && !m_pending.empty() &&
+        m_pending.back().type == InputEventType::MOUSE_MOVE) {
+        m_pending.back() = event;
+        m_stats.movesCoalesced++;
+        return;
+    }
+
+    m_pending.push_back(event);
+    m_hasDiscrete = m_hasDiscrete || IsDiscrete(event);
+}
+
+bool InputBatcher::ShouldFlush(uint64_t nowUs) const {
+    if (m_pending.empty()) {
+        return m_stateRepeatsLeft > 0 && nowUs >= m_nextStateRepeatUs;
+    }
+    return m_hasDiscrete || nowUs - m_lastFlushUs >= m_sendIntervalUs;
+}
+
+bool InputBatcher::Flush(std::vector<uint8_t>& outPayload, uint64_t nowUs) {
+    const bool repeatDue = m_stateRepeatsLeft > 0 && nowUs >= m_nextStateRepeatUs;
+    if (m_pending.empty() && !repeatDue) {
+        return false;
+    }
+
+    const size_t count = std::min(m_pending.size(), INPUT_MAX_BATCH_EVENTS);
+    bool stateChanged = false;
+    for (size_t i = 0; i < count; ++i) {
+        stateChanged = m_sentState.Apply(m_pending[i]) || stateChanged;
+    }
+
+    EncodeInputBatch(m_sequence++, m_pending.data(), count, outPayload, &m_sentState);
+    m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+
+    m_hasDiscrete = std::any_of(m_pending.begin(), m_pending.end(), IsDiscrete);
+    m_lastFlushUs = nowUs;
+
+    // Mudança de tecla/botão: o estado novo sai de novo em alguns lotes
+    if (stateChanged) {
+        m_stateRepeatsLeft = INPUT_STATE_REPEATS;
+        m_nextStateRepeatUs = nowUs + INPUT_STATE_REPEAT_US;
+    } else if (repeatDue) {
+        m_stateRepeatsLeft--;
+        m_nextStateRepeatUs = nowUs + INPUT_STATE_REPEAT_US;
+    }
+
+    if (count == 0) {
+        m_stats.stateRefreshes++;
+    }
+    m_stats.eventsSent += count;
+    m_stats.batchesSent++;
+    m_stats.bytesSent += outPayload.size();
+    return true;
+}
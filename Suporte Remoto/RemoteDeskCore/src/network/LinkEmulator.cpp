@@ -0,0 +1,499 @@
+#include "LinkEmulator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+// ============================================================================
+// LinkEmulator
+// ============================================================================
+
+LinkEmulator::LinkEmulator(const LinkProfile& profile, uint64_t seed)
+    : m_profile(profile),
+      m_rng(seed) {
+}
+
+bool LinkEmulator::Chance(double percent) {
+    if (percent <= 0.0) {
+        return false;
+    }
+    if (percent >= 100.0) {
+        return true;
+    }
+    return m_uniform(m_rng) < percent;
+}
+
+bool LinkEmulator::ShouldDrop() {
+    const GilbertElliottParams& burst = m_profile.burstLoss;
+
+    if (burst.enabled) {
+        // Transição de estado primeiro, perda conforme o novo estado
+        if (m_burstBadState) {
+            if (Chance(burst.badToGoodPercent)) {
+                m_burstBadState = false;
+            }
+        } else if (Chance(burst.goodToBadPercent)) {
+            m_burstBadState = true;
+        }
+
+        return Chance(m_burstBadState ? burst.lossInBadPercent : burst.lossInGoodPercent);
+    }
+
+    return Chance(m_profile.lossPercent);
+}
+
+void LinkEmulator::Submit(const uint8_t* data, size_t size, uint64_t nowUs) {
+    m_stats.packetsSubmitted++;
+
+    if (ShouldDrop()) {
+        m_stats.packetsLost++;
+        return;
+    }
+
+    Enqueue(data, size, nowUs);
+
+    if (Chance(m_profile.duplicatePercent)) {
+        m_stats.packetsDuplicated++;
+        Enqueue(data, size, nowUs);
+    }
+}
+
+void LinkEmulator::Enqueue(const uint8_t* data, size_t size, uint64_t nowUs) {
+    uint64_t txStartUs = std::max(nowUs, m_linkFreeAtUs);
+    uint64_t txDurationUs = 0;
+
+    if (m_profile.bandwidthKbps > 0.0) {
+        // Bytes ainda aguardando transmissão no gargalo
+        double backlogBytes = 0.0;
+        if (m_linkFreeAtUs > nowUs) {
+            backlogBytes = (m_linkFreeAtUs - nowUs) * m_profile.bandwidthKbps / 8000.0;
+        }
+
+        if (backlogBytes + size > m_profile.queueLimitBytes) {
+            m_stats.packetsQueueDropped++;
+            return;
+        }
+
+        txDurationUs = static_cast<uint64_t>(size * 8000.0 / m_profile.bandwidthKbps);
+        m_linkFreeAtUs = txStartUs + txDurationUs;
+    }
+
+    double delayUs = m_profile.delayMs * 1000.0;
+    if (m_profile.jitterMs > 0.0) {
+        delayUs += m_normal(m_rng) * m_profile.jitterMs * 1000.0;
+    }
+    delayUs = std::max(delayUs, 0.0);
+
+    uint64_t deliveryUs = txStartUs + txDurationUs + static_cast<uint64_t>(delayUs);
+
+    if (Chance(m_profile.reorderPercent)) {
+        // Retido: pacotes seguintes o ultrapassam
+        m_stats.packetsReordered++;
+        deliveryUs += static_cast<uint64_t>(m_profile.reorderDelayMs * 1000.0);
+    } else {
+        // Jitter sozinho não reordena (mesmo comportamento do netem com rate)
+        deliveryUs = std::max(deliveryUs, m_lastDeliveryUs);
+        m_lastDeliveryUs = deliveryUs;
+    }
+
+    InFlight packet;
+    packet.deliveryUs = deliveryUs;
+    packet.order = m_nextOrder++;
+    packet.data.assign(data, data + size);
+    m_inFlight.push(std::move(packet));
+}
+
+bool LinkEmulator::PopReady(uint64_t nowUs, std::vector<uint8_t>& outDatagram) {
+    if (m_inFlight.empty() || m_inFlight.top().deliveryUs > nowUs) {
+        return false;
+    }
+
+    // top() é const; o elemento sai da fila em seguida
+    outDatagram.swap(const_cast<InFlight&>(m_inFlight.top()).data);
+    m_inFlight.pop();
+
+    m_stats.packetsDelivered++;
+    m_stats.bytesDelivered += outDatagram.size();
+    return true;
+}
+
+uint64_t LinkEmulator::NextDeliveryUs() const {
+    if (m_inFlight.empty()) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return m_inFlight.top().deliveryUs;
+}
+
+// ============================================================================
+// EmulatedLink
+// ============================================================================
+
+namespace {
+
+class EmulatedEndpoint : public IDatagramChannel {
+public:
+    EmulatedEndpoint(std::shared_ptr<EmulatedLink> link, EmulatedLink::Side side)
+        : m_link(std::move(link)), m_side(side) {
+    }
+
+    bool Send(const uint8_t* data, size_t size) override {
+        return m_link->Send(m_side, data, size);
+    }
+
+    bool Receive(std::vector<uint8_t>& outDatagram) override {
+        return m_link->Receive(m_side, outDatagram);
+    }
+
+    bool WaitReadable(int timeoutMs) override {
+        return m_link->WaitReadable(m_side, timeoutMs);
+    }
+
+private:
+    std::shared_ptr<EmulatedLink> m_link;
+    EmulatedLink::Side m_side;
+};
+
+EmulatedLink::Side OtherSide(EmulatedLink::Side side) {
+    return side == EmulatedLink::Side::A ? EmulatedLink::Side::B : EmulatedLink::Side::A;
+}
+
+} // namespace
+
+EmulatedLink::EmulatedLink(const LinkProfile& profile, uint64_t seed, bool manualClock)
+    : m_aToB(profile, seed),
+      m_bToA(profile, seed ^ 0x9E3779B97F4A7C15ull),
+      m_manualClock(manualClock),
+      m_origin(std::chrono::steady_clock::now()) {
+}
+
+std::shared_ptr<IDatagramChannel> EmulatedLink::CreateEndpoint(Side side) {
+    return std::make_shared<EmulatedEndpoint>(shared_from_this(), side);
+}
+
+void EmulatedLink::SetProfile(const LinkProfile& profile) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_aToB.SetProfile(profile);
+    m_bToA.SetProfile(profile);
+}
+
+void EmulatedLink::SetProfile(Side from, const LinkProfile& profile) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Direction(from).SetProfile(profile);
+}
+
+void EmulatedLink::AdvanceTo(uint64_t nowUs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_manualClock && nowUs > m_virtualNowUs) {
+            m_virtualNowUs = nowUs;
+        }
+    }
+    m_cv.notify_all();
+}
+
+uint64_t EmulatedLink::NowUs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return NowUsLocked();
+}
+
+uint64_t EmulatedLink::NowUsLocked() const {
+    if (m_manualClock) {
+        return m_virtualNowUs;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_origin).count();
+}
+
+LinkEmulator::LinkStats EmulatedLink::GetStats(Side from) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Direction(from).GetStats();
+}
+
+bool EmulatedLink::Send(Side from, const uint8_t* data, size_t size) {
+    if (!data && size > 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Direction(from).Submit(data, size, NowUsLocked());
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+bool EmulatedLink::Receive(Side to, std::vector<uint8_t>& outDatagram) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Direction(OtherSide(to)).PopReady(NowUsLocked(), outDatagram);
+}
+
+bool EmulatedLink::WaitReadable(Side to, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const LinkEmulator& direction = Direction(OtherSide(to));
+
+    if (m_manualClock) {
+        // Tempo virtual não anda sozinho: responde pelo instante atual
+        return direction.NextDeliveryUs() <= m_virtualNowUs;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (true) {
+        uint64_t nextUs = direction.NextDeliveryUs();
+        if (nextUs <= NowUsLocked()) {
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+
+        auto wakeAt = deadline;
+        if (nextUs != std::numeric_limits<uint64_t>::max()) {
+            wakeAt = std::min(wakeAt, m_origin + std::chrono::microseconds(nextUs));
+        }
+        m_cv.wait_until(lock, wakeAt);
+    }
+}
+
+// ============================================================================
+// Cenários
+// ============================================================================
+
+const LinkProfile& LinkScenario::ProfileAt(uint64_t tMs) const {
+    static const LinkProfile unlimited;
+
+    const LinkProfile* active = &unlimited;
+    for (const LinkScenarioStep& step : steps) {
+        if (step.atMs <= tMs) {
+            active = &step.profile;
+        }
+    }
+    return *active;
+}
+
+namespace {
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// Número seguido de sufixo opcional; suffixScale mapeia sufixo → multiplicador
+bool ParseScaled(const std::string& text, double& outValue,
+                 std::initializer_list<std::pair<const char*, double>> suffixScale) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double value = std::strtod(begin, &end);
+    if (end == begin) {
+        return false;
+    }
+
+    std::string suffix = ToLower(end);
+    for (const auto& entry : suffixScale) {
+        if (suffix == entry.first) {
+            outValue = value * entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseDurationMs(const std::string& text, double& outMs) {
+    return ParseScaled(text, outMs, { { "", 1.0 }, { "ms", 1.0 }, { "s", 1000.0 } });
+}
+
+bool ParsePercent(const std::string& text, double& outPercent) {
+    return ParseScaled(text, outPercent, { { "", 1.0 }, { "%", 1.0 } });
+}
+
+bool ParseProfileField(const std::string& key, const std::string& value, LinkProfile& profile) {
+    if (key == "bw") {
+        return ParseScaled(value, profile.bandwidthKbps,
+                           { { "", 1.0 }, { "kbps", 1.0 }, { "mbps", 1000.0 } });
+    }
+    if (key == "delay") {
+        return ParseDurationMs(value, profile.delayMs);
+    }
+    if (key == "jitter") {
+        return ParseDurationMs(value, profile.jitterMs);
+    }
+    if (key == "loss") {
+        return ParsePercent(value, profile.lossPercent);
+    }
+    if (key == "reorder") {
+        return ParsePercent(value, profile.reorderPercent);
+    }
+    if (key == "reorder_delay") {
+        return ParseDurationMs(value, profile.reorderDelayMs);
+    }
+    if (key == "dup") {
+        return ParsePercent(value, profile.duplicatePercent);
+    }
+    if (key == "queue") {
+        double kb = 0.0;
+        if (!ParseScaled(value, kb, { { "", 1.0 }, { "kb", 1.0 } })) {
+            return false;
+        }
+        profile.queueLimitBytes = static_cast<uint32_t>(kb * 1024.0);
+        return true;
+    }
+    if (key == "burst") {
+        // P(G→B),P(B→G)[,perda em BAD] ou "off"
+        if (ToLower(value) == "off") {
+            profile.burstLoss.enabled = false;
+            return true;
+        }
+
+        std::vector<double> parts;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            double percent = 0.0;
+            if (!ParsePercent(item, percent)) {
+                return false;
+            }
+            parts.push_back(percent);
+        }
+        if (parts.size() < 2 || parts.size() > 3) {
+            return false;
+        }
+        profile.burstLoss.enabled = true;
+        profile.burstLoss.goodToBadPercent = parts[0];
+        profile.burstLoss.badToGoodPercent = parts[1];
+        profile.burstLoss.lossInBadPercent = parts.size() == 3 ? parts[2] : 100.0;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool ParseLinkScenario(const std::string& text, LinkScenario& outScenario, std::string& outError) {
+    LinkScenario scenario;
+    std::stringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(lines, line)) {
+        lineNumber++;
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::stringstream tokens(line);
+        std::string directive;
+        if (!(tokens >> directive)) {
+            continue;
+        }
+        directive = ToLower(directive);
+
+        auto fail = [&](const std::string& message) {
+            outError = "line " + std::to_string(lineNumber) + ": " + message;
+            return false;
+        };
+
+        if (directive == "name") {
+            tokens >> scenario.name;
+        } else if (directive == "duration" || directive == "seed") {
+            std::string value;
+            tokens >> value;
+            double number = 0.0;
+            bool ok = directive == "duration" ? ParseDurationMs(value, number)
+                                              : ParseScaled(value, number, { { "", 1.0 } });
+            if (!ok || number < 0.0) {
+                return fail("invalid " + directive + " '" + value + "'");
+            }
+            if (directive == "duration") {
+                scenario.durationMs = static_cast<uint64_t>(number);
+            } else {
+                scenario.seed = static_cast<uint64_t>(number);
+            }
+        } else if (directive == "at") {
+            std::string when;
+            double atMs = 0.0;
+            if (!(tokens >> when) || !ParseDurationMs(when, atMs) || atMs < 0.0) {
+                return fail("invalid time '" + when + "'");
+            }
+
+            // Campos omitidos herdam do passo anterior
+            LinkScenarioStep step;
+            step.atMs = static_cast<uint64_t>(atMs);
+            if (!scenario.steps.empty()) {
+                if (step.atMs < scenario.steps.back().atMs) {
+                    return fail("steps must be in time order");
+                }
+                step.profile = scenario.steps.back().profile;
+            }
+
+            std::string field;
+            while (tokens >> field) {
+                size_t equals = field.find('=');
+                if (equals == std::string::npos) {
+                    return fail("expected key=value, got '" + field + "'");
+                }
+                std::string key = ToLower(field.substr(0, equals));
+                if (!ParseProfileField(key, field.substr(equals + 1), step.profile)) {
+                    return fail("invalid field '" + field + "'");
+                }
+            }
+
+            scenario.steps.push_back(step);
+        } else {
+            return fail("unknown directive '" + directive + "'");
+        }
+    }
+
+    if (scenario.name.empty()) {
+        scenario.name = "scenario";
+    }
+
+    outScenario = std::move(scenario);
+    return true;
+}
+
+std::vector<LinkScenario> BuiltinLinkScenarios() {
+    static const char* const scripts[] = {
+        "name clean\n"
+        "duration 20s\n"
+        "at 0s bw=20mbps delay=20ms jitter=1ms\n",
+
+        "name bw-drop\n"
+        "duration 40s\n"
+        "at 0s  bw=20mbps delay=20ms jitter=2ms\n"
+        "at 10s bw=3mbps\n"
+        "at 20s bw=20mbps\n",
+
+        "name lossy\n"
+        "duration 20s\n"
+        "at 0s bw=20mbps delay=30ms jitter=3ms loss=2%\n",
+
+        "name burst\n"
+        "duration 20s\n"
+        "at 0s bw=20mbps delay=30ms jitter=2ms burst=1%,20%\n",
+
+        "name jitter-reorder\n"
+        "duration 20s\n"
+        "at 0s bw=20mbps delay=40ms jitter=15ms reorder=5% reorder_delay=20ms\n",
+
+        "name duplicate\n"
+        "duration 20s\n"
+        "at 0s bw=20mbps delay=20ms dup=3%\n",
+    };
+
+    std::vector<LinkScenario> scenarios;
+    for (const char* script : scripts) {
+        LinkScenario scenario;
+        std::string error;
+        if (ParseLinkScenario(script, scenario, error)) {
+            scenarios.push_back(std::move(scenario));
+        }
+    }
+    return scenarios;
+}
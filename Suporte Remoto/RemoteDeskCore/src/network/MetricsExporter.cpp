@@ -0,0 +1,360 @@
+#include "MetricsExporter.h"
+#include "SocketCompat.h"
+#include "TransportStats.h"
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+constexpr int ACCEPT_POLL_MS = 200;
+constexpr size_t MAX_REQUEST_BYTES = 4096;
+
+SOCKET ToSocket(intptr_t value) { return static_cast<SOCKET>(value); }
+
+void AppendMetric(std::string& out, const char* name, const char* type,
+                  const char* help, double value, const char* labels = nullptr) {
+    // HELP/TYPE só na primeira série de cada métrica
+    if (help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    char valueText[64];
+    std::snprintf(valueText, sizeof(valueText), "%.17g", value);
+
+    out += name;
+    if (labels) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += valueText;
+    out += '\n';
+}
+
+void AppendLatencyHistogram(std::string& out, const char* name, const char* help,
+                            const uint64_t* buckets, uint64_t count, double sum) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " histogram\n";
+
+    // Buckets cumulativos
+    std::string bucketName = std::string(name) + "_bucket";
+    uint64_t cumulative = 0;
+    char label[48];
+    for (size_t i = 0; i < LATENCY_BUCKETS_MS.size(); ++i) {
+        cumulative += buckets[i];
+        std::snprintf(label, sizeof(label), "le=\"%g\"", LATENCY_BUCKETS_MS[i]);
+        AppendMetric(out, bucketName.c_str(), nullptr, nullptr, (double)cumulative, label);
+    }
+    AppendMetric(out, bucketName.c_str(), nullptr, nullptr, (double)count, "le=\"+Inf\"");
+    AppendMetric(out, (std::string(name) + "_sum").c_str(), nullptr, nullptr, sum);
+    AppendMetric(out, (std::string(name) + "_count").c_str(), nullptr, nullptr, (double)count);
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter() {
+}
+
+MetricsExporter::~MetricsExporter() {
+    Stop();
+}
+
+bool MetricsExporter::Start(uint16_t port, const std::string& bindAddress) {
+    if (m_isRunning) {
+        return false;
+    }
+
+    if (!SocketStartup()) {
+        OutputDebugStringA("Metrics: WSAStartup failed\n");
+        return false;
+    }
+    m_socketsInitialized = true;
+
+    SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET) {
+        std::cerr << "Metrics: socket() failed\n";
+        Stop();
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Metrics: invalid bind address " << bindAddress << "\n";
+        closesocket(listenSocket);
+        Stop();
+        return false;
+    }
+
+    if (bind(listenSocket, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listenSocket, 8) != 0) {
+        std::cerr << "Metrics: bind/listen failed on port " << port << "\n";
+        closesocket(listenSocket);
+        Stop();
+        return false;
+    }
+
+    m_listenSocket = static_cast<intptr_t>(listenSocket);
+    m_shouldStop = false;
+    m_isRunning = true;
+
+    try {
+        m_listenThread = std::thread(&MetricsExporter::ListenThreadMain, this);
+    } catch (const std::exception&) {
+        m_isRunning = false;
+        Stop();
+        return false;
+    }
+
+    std::cout << "Metrics endpoint: http://" << bindAddress << ":" << port << "/metrics\n";
+    return true;
+}
+
+void MetricsExporter::Stop() {
+    m_shouldStop = true;
+
+    if (m_listenThread.joinable()) {
+        m_listenThread.join();
+    }
+
+    if (m_listenSocket != -1) {
+        closesocket(ToSocket(m_listenSocket));
+        m_listenSocket = -1;
+    }
+
+    if (m_socketsInitialized) {
+        SocketCleanup();
+        m_socketsInitialized = false;
+    }
+
+    m_isRunning = false;
+}
+
+void MetricsExporter::ListenThreadMain() {
+    SOCKET listenSocket = ToSocket(m_listenSocket);
+
+    while (!m_shouldStop) {
+        // select() com timeout para poder observar m_shouldStop
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(listenSocket, &readSet);
+
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = ACCEPT_POLL_MS * 1000;
+
+        int ready = select(static_cast<int>(listenSocket) + 1, &readSet, nullptr, nullptr, &timeout);
+        if (ready <= 0) {
+            continue;
+        }
+
+        SOCKET client = accept(listenSocket, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            continue;
+        }
+
+        HandleClient(static_cast<intptr_t>(client));
+        closesocket(client);
+    }
+}
+
+void MetricsExporter::HandleClient(intptr_t clientSocket) {
+    SOCKET client = ToSocket(clientSocket);
+
+    // Ler até o fim dos headers (requests do Prometheus são pequenos)
+    std::string request;
+    char buffer[1024];
+
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(client, &readSet);
+
+        timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+
+        if (select(static_cast<int>(client) + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+            return;
+        }
+
+        int received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string status;
+    std::string contentType;
+    std::string body;
+
+    if (request.rfind("GET /metrics", 0) == 0) {
+        status = "200 OK";
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+        body = FormatPrometheus(m_snapshot.Load());
+        m_scrapeCount.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "Use GET /metrics\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+                           "Content-Type: " + contentType + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sentTotal = 0;
+    while (sentTotal < response.size()) {
+        int sent = send(client, response.data() + sentTotal,
+                        static_cast<int>(response.size() - sentTotal), SOCKET_SEND_FLAGS);
+        if (sent <= 0) {
+            return;
+        }
+        sentTotal += static_cast<size_t>(sent);
+    }
+}
+
+std::string MetricsExporter::FormatPrometheus(const MetricsSnapshot& s) {
+    std::string out;
+    out.reserve(4096);
+
+    // SystemStats
+    AppendMetric(out, "rdc_frames_processed_total", "counter",
+                 "Frames processed by the main loop", (double)s.framesProcessed);
+    AppendMetric(out, "rdc_frame_time_ms", "gauge",
+                 "Average frame time in milliseconds", s.averageFrameTimeMs);
+    AppendMetric(out, "rdc_fps", "gauge", "Average frames per second", s.averageFPS);
+    AppendMetric(out, "rdc_latency_ms", "gauge",
+                 "Smoothed end-to-end loop latency in milliseconds", s.totalLatencyMs);
+    AppendMetric(out, "rdc_stage_time_ms", "gauge",
+                 "Last measured time per pipeline stage in milliseconds",
+                 s.captureTimeMs, "stage=\"capture\"");
+    AppendMetric(out, "rdc_stage_time_ms", "gauge", nullptr, s.encodeTimeMs, "stage=\"encode\"");
+    AppendMetric(out, "rdc_stage_time_ms", "gauge", nullptr, s.networkTimeMs, "stage=\"network\"");
+    AppendMetric(out, "rdc_stage_time_ms", "gauge", nullptr, s.renderTimeMs, "stage=\"render\"");
+    AppendMetric(out, "rdc_system_bytes_sent_total", "counter",
+                 "Encoded bytes produced for sending", (double)s.systemBytesSent);
+    AppendMetric(out, "rdc_system_bytes_received_total", "counter",
+                 "Payload bytes received by the client loop", (double)s.systemBytesReceived);
+    AppendMetric(out, "rdc_compression_ratio", "gauge",
+                 "Raw to encoded size ratio of the last frame", (double)s.compressionRatio);
+
+    // ConnectionStats
+    AppendMetric(out, "rdc_net_bytes_sent_total", "counter",
+                 "Bytes sent by P2PManager", (double)s.netBytesSent);
+    AppendMetric(out, "rdc_net_bytes_received_total", "counter",
+                 "Bytes received by P2PManager", (double)s.netBytesReceived);
+    AppendMetric(out, "rdc_net_frames_sent_total", "counter",
+                 "Frames sent by P2PManager", (double)s.netFramesSent);
+    AppendMetric(out, "rdc_net_frames_received_total", "counter",
+                 "Frames received by P2PManager", (double)s.netFramesReceived);
+    AppendMetric(out, "rdc_net_latency_ms", "gauge",
+                 "Network latency estimate in milliseconds", s.netLatencyMs);
+    AppendMetric(out, "rdc_net_bandwidth_mbps", "gauge",
+                 "Network bandwidth estimate in Mbps", s.netBandwidthMbps);
+
+    // TransportStats
+    AppendMetric(out, "rdc_net_rtt_ms", "gauge",
+                 "Smoothed transport round-trip time in milliseconds", s.netRttMs);
+    AppendMetric(out, "rdc_net_packet_loss_percent", "gauge",
+                 "Packet loss over the last transport stats window", s.netPacketLossPercent);
+    AppendMetric(out, "rdc_net_packets_sent_total", "counter",
+                 "Packets sent by the transport", (double)s.netPacketsSent);
+    AppendMetric(out, "rdc_net_packets_lost_total", "counter",
+                 "Packets lost (peer reports) or retransmitted (SCTP)", (double)s.netPacketsLost);
+    AppendMetric(out, "rdc_net_retransmissions_total", "counter",
+                 "Transport retransmissions", (double)s.netRetransmissions);
+    AppendMetric(out, "rdc_net_send_bitrate_kbps", "gauge",
+                 "Measured send bitrate over the last window in kbps", s.netSendBitrateKbps);
+    AppendMetric(out, "rdc_net_available_outgoing_bitrate_kbps", "gauge",
+                 "Transport estimate of available outgoing bitrate (0 = unknown)",
+                 s.netAvailableBitrateKbps);
+    for (size_t i = 0; i < CANDIDATE_PAIR_TYPE_COUNT; ++i) {
+        CandidatePairType type = static_cast<CandidatePairType>(i);
+        std::string label = std::string("type=\"") + CandidatePairTypeName(type) + "\"";
+        AppendMetric(out, "rdc_net_candidate_pair", "gauge",
+                     i == 0 ? "Selected ICE candidate pair type (1 = selected)" : nullptr,
+                     s.netCandidatePairType == i ? 1.0 : 0.0, label.c_str());
+    }
+
+    // EncoderStats
+    AppendMetric(out, "rdc_encoder_frames_total", "counter",
+                 "Frames encoded", (double)s.encoderFramesEncoded);
+    AppendMetric(out, "rdc_encoder_bytes_total", "counter",
+                 "Bytes produced by the encoder", (double)s.encoderBytesEncoded);
+    AppendMetric(out, "rdc_encoder_keyframe_interval", "gauge",
+                 "Configured keyframe interval in frames", (double)s.encoderKeyframeInterval);
+    AppendMetric(out, "rdc_encoder_average_bitrate_mbps", "gauge",
+                 "Average encoder output bitrate in Mbps", s.encoderAverageBitrateMbps);
+
+    // ABRStats
+    AppendMetric(out, "rdc_abr_bitrate_mbps", "gauge",
+                 "Current ABR target bitrate in Mbps", (double)s.abrBitrateMbps);
+    AppendMetric(out, "rdc_abr_latency_ms", "gauge",
+                 "Latency last reported to the ABR controller", s.abrLatencyMs);
+    AppendMetric(out, "rdc_abr_packet_loss_percent", "gauge",
+                 "Packet loss last reported to the ABR controller", s.abrPacketLossPercent);
+    AppendMetric(out, "rdc_abr_bitrate_changes_total", "counter",
+                 "Number of ABR bitrate changes", (double)s.abrBitrateChangeCount);
+    AppendMetric(out, "rdc_abr_rung", "gauge",
+                 "Current rung of the ABR resolution/framerate ladder", (double)s.abrRung);
+    AppendMetric(out, "rdc_abr_target_fps", "gauge",
+                 "Capture framerate chosen by the ABR controller", (double)s.abrTargetFps);
+    AppendMetric(out, "rdc_abr_target_resolution", "gauge",
+                 "Encode resolution chosen by the ABR controller (0 = source)",
+                 (double)s.abrTargetWidth, "dim=\"width\"");
+    AppendMetric(out, "rdc_abr_target_resolution", "gauge", nullptr,
+                 (double)s.abrTargetHeight, "dim=\"height\"");
+    AppendMetric(out, "rdc_abr_rung_changes_total", "counter",
+                 "Number of ABR ladder rung changes", (double)s.abrRungChangeCount);
+    AppendMetric(out, "rdc_abr_available_bitrate_kbps", "gauge",
+                 "Transport bitrate ceiling applied by the ABR (0 = none)", s.abrAvailableBitrateKbps);
+
+    // Filas
+    AppendMetric(out, "rdc_queue_depth", "gauge",
+                 "Frames waiting in pipeline queues", (double)s.captureQueueDepth, "queue=\"capture\"");
+    AppendMetric(out, "rdc_queue_depth", "gauge", nullptr, (double)s.renderQueueDepth, "queue=\"render\"");
+    AppendMetric(out, "rdc_queue_frames_total", "counter",
+                 "Frames that passed through pipeline queues",
+                 (double)s.captureFramesCaptured, "queue=\"capture\"");
+    AppendMetric(out, "rdc_queue_frames_total", "counter", nullptr,
+                 (double)s.renderFramesRendered, "queue=\"render\"");
+    AppendMetric(out, "rdc_queue_dropped_total", "counter",
+                 "Frames dropped because a pipeline queue was full",
+                 (double)s.captureFramesDropped, "queue=\"capture\"");
+    AppendMetric(out, "rdc_queue_dropped_total", "counter", nullptr,
+                 (double)s.renderFramesDropped, "queue=\"render\"");
+
+    // Probe de latência input → foto
+    AppendLatencyHistogram(out, "rdc_input_to_photon_ms",
+                           "Client-measured latency from probe input to presented frame",
+                           s.probeLatencyBuckets, s.probeLatencyCount, s.probeLatencySumMs);
+    AppendMetric(out, "rdc_input_probe_timeouts_total", "counter",
+                 "Latency probes that never showed up on screen", (double)s.probeTimeouts);
+
+    AppendMetric(out, "rdc_snapshot_timestamp_ms", "gauge",
+                 "Wall clock time of the last published snapshot", (double)s.publishTimestampMs);
+
+    return out;
+}
@@ -1,4 +1,6 @@
 #include "NVENCEncoder.h"
+#include "Trace.h"
+#include "FrameUtils.h"
 #include <iostream>
 #include <cstring>
 
@@ -40,10 +42,10 @@ bool NVENCEncoder::InitializeNVENC() {
     return true;
 }
 
-bool NVENCEncoder::Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateMbps) {
+bool NVENCEncoder::Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps) {
     m_width = width;
     m_height = height;
-    m_targetBitrateMbps = targetBitrateMbps;
+    m_targetBitrateKbps = targetBitrateKbps;
 
     if (!InitializeNVENC()) {
         return false;
@@ -131,6 +133,8 @@ bool NVENCEncoder::ConfigureEncoder(uint32_t width, uint32_t height) {
 
 bool NVENCEncoder::EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height,
                                uint32_t stride, EncodedFrame& outFrame, bool forceKeyframe) {
+    RDC_TRACE_SCOPE("NVENCEncoder::EncodeFrame");
+
     if (!m_device || !m_inputTexture || !bgraPixels) {
         return false;
     }
@@ -142,14 +146,8 @@ bool NVENCEncoder::EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32
         return false;
     }
 
-    uint8_t* destData = static_cast<uint8_t*>(mapped.pData);
-    for (uint32_t y = 0; y < height; ++y) {
-        std::memcpy(
-            destData + (y * mapped.RowPitch),
-            bgraPixels + (y * stride),
-            width * 4
-        );
-    }
+    CopyFrameRows(static_cast<uint8_t*>(mapped.pData), mapped.RowPitch,
+                  bgraPixels, stride, static_cast<size_t>(width) * 4, height);
 
     m_deviceContext->Unmap(m_stagingTexture.Get(), 0);
 
@@ -159,7 +157,7 @@ bool NVENCEncoder::EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32
     // Preparar frame codificado
     outFrame.width = width;
     outFrame.height = height;
-    outFrame.bitrate = m_targetBitrateMbps;
+    outFrame.bitrate = m_targetBitrateKbps;
     outFrame.isKeyframe = (m_keyframeCounter == 0) || forceKeyframe;
     outFrame.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::high_resolution_clock::now().time_since_epoch()
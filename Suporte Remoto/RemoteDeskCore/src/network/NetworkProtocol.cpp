@@ -0,0 +1,37 @@
+#include "NetworkProtocol.h"
+#include <cstring>
+
+size_t SerializePacket(const NetworkPacket& packet, std::vector<uint8_t>& outBuffer) {
+    const size_t totalSize = sizeof(NetworkFrameHeader) + packet.pixelData.size();
+
+    // resize sobre buffer já reservado não realoca no hot path
+    outBuffer.resize(totalSize);
+    std::memcpy(outBuffer.data(), &packet.header, sizeof(NetworkFrameHeader));
+
+    if (!packet.pixelData.empty()) {
+        std::memcpy(outBuffer.data() + sizeof(NetworkFrameHeader),
+                    packet.pixelData.data(), packet.pixelData.size());
+    }
+
+    return totalSize;
+}
+
+bool DeserializePacket(const uint8_t* data, size_t size, NetworkPacket& outPacket) {
+    if (!data || size < sizeof(NetworkFrameHeader)) {
+        return false;
+    }
+
+    std::memcpy(&outPacket.header, data, sizeof(NetworkFrameHeader));
+
+    if (outPacket.header.magic != NetworkFrameHeader::MAGIC) {
+        return false;
+    }
+
+    const size_t payloadSize = size - sizeof(NetworkFrameHeader);
+    outPacket.pixelData.resize(payloadSize);
+    if (payloadSize > 0) {
+        std::memcpy(outPacket.pixelData.data(), data + sizeof(NetworkFrameHeader), payloadSize);
+    }
+
+    return true;
+}
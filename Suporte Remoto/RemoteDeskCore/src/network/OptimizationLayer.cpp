@@ -1,5 +1,8 @@
 #include "OptimizationLayer.h"
+#include "PlatformCompat.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 
 // ============================================================================
@@ -181,9 +184,193 @@ bool MultiThreadedRenderer::QueueFrameForRender(const FrameBuffer& frame) {
 AdaptiveBitRateController::AdaptiveBitRateController(uint32_t minBitrateMbps,
                                                      uint32_t maxBitrateMbps)
     : m_minBitrateMbps(minBitrateMbps),
+      m_minBitrateKbps(minBitrateMbps * 1000),
       m_maxBitrateMbps(maxBitrateMbps),
       m_currentBitrateMbps((minBitrateMbps + maxBitrateMbps) / 2),
-      m_previousBitrateMbps(m_currentBitrateMbps) {
+      m_previousBitrateMbps(m_currentBitrateMbps),
+      m_currentBitrateKbps(m_currentBitrateMbps * 1000),
+      m_modelBitrateKbps(m_currentBitrateKbps) {
+}
+
+namespace {
+
+// Filtro de Kalman do gradiente de atraso
+constexpr double KALMAN_PROCESS_NOISE = 0.05;       // ms² por amostra
+constexpr double NOISE_ESTIMATE_ALPHA = 0.95;
+constexpr double TREND_GAIN = 4.0;                  // Gradiente (ms/frame) → sinal comparado ao limiar
+
+// Limiar adaptativo (mesma forma do detector do GCC)
+constexpr double THRESHOLD_UP_RATE = 0.0087;        // por ms, quando acima do limiar
+constexpr double THRESHOLD_DOWN_RATE = 0.039;       // por ms, quando abaixo
+constexpr double THRESHOLD_MIN_MS = 6.0;
+constexpr double THRESHOLD_MAX_MS = 600.0;
+constexpr double THRESHOLD_SPIKE_MS = 15.0;         // Picos acima de limiar+15 não adaptam o limiar
+
+// Atraso de fila
+constexpr double BASE_DELAY_BUCKET_MS = 5000.0;
+constexpr double QUEUEING_DELAY_ALPHA = 0.9;
+constexpr double QUEUEING_DELAY_HIGH_MS = 40.0;
+constexpr double QUEUE_DRAIN_TARGET_MS = 1000.0;    // Redução drena a fila estimada em ~1 s
+
+// Controle de taxa
+constexpr double GOODPUT_WINDOW_MS = 500.0;
+constexpr double DECREASE_FACTOR = 0.85;            // β sobre o goodput medido
+constexpr double MIN_DECREASE_INTERVAL_MS = 200.0;
+constexpr double HOLD_OFF_MS = 1000.0;              // Sem aumento após redução
+constexpr double MULTIPLICATIVE_INCREASE_PER_S = 0.25;
+constexpr double ADDITIVE_INCREASE_KBPS_PER_S = 500.0;
+constexpr double NEAR_CAPACITY_FRACTION = 0.9;
+constexpr double CAPACITY_RESET_FACTOR = 1.2;       // Acima disso a capacidade estimada é descartada
+constexpr double LOSS_DECREASE_PERCENT = 10.0;
+constexpr double LOSS_HOLD_PERCENT = 2.0;
+constexpr double LOSS_SMOOTHING_ALPHA = 0.7;        // Janelas de 100 ms são ruidosas em perda em rajada
+constexpr double DECODER_BUFFER_HIGH_MS = 100.0;
+constexpr double DECODER_BUFFER_LOW_MS = 50.0;
+constexpr double LATENCY_CEILING_MS = 300.0;        // Link parado: sem feedback, só latência
+
+// Escada de resolução/fps
+constexpr double RUNG_DOWN_MARGIN = 0.05;           // Desce quando alvo < 95% do mínimo do degrau
+constexpr double RUNG_UP_MARGIN = 0.15;             // Sobe só com 15% de folga sobre o próximo degrau...
+constexpr double RUNG_UP_HOLD_MS = 2000.0;          // ...mantida por 2 s
+constexpr double LADDER_FLOOR_FRACTION = 0.5;       // Mínimo com escada: metade do limiar do 2º degrau
+
+double SteadyNowMs() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+double AdaptiveBitRateController::NowMs() const {
+    return m_timeSource ? m_timeSource() : SteadyNowMs();
+}
+
+void AdaptiveBitRateController::OnPacketFeedback(double sendTimeMs, double arrivalTimeMs,
+                                                 size_t bytes) {
+    // Goodput por instante de chegada (relógio do receptor)
+    m_ackedBytes.emplace_back(arrivalTimeMs, bytes);
+    m_ackedBytesInWindow += bytes;
+
+    while (m_ackedBytes.front().first < arrivalTimeMs - GOODPUT_WINDOW_MS) {
+        m_ackedBytesInWindow -= m_ackedBytes.front().second;
+        m_ackedBytes.pop_front();
+    }
+
+    UpdateQueueingDelay(arrivalTimeMs - sendTimeMs, arrivalTimeMs);
+
+    if (m_hasPreviousPacket) {
+        double sendDeltaMs = sendTimeMs - m_previousSendMs;
+
+        // Reordenados/duplicados não entram no gradiente
+        if (sendDeltaMs <= 0.0) {
+            return;
+        }
+
+        double arrivalDeltaMs = arrivalTimeMs - m_previousArrivalMs;
+        UpdateOveruseDetector(arrivalDeltaMs - sendDeltaMs, arrivalDeltaMs);
+    }
+
+    m_hasPreviousPacket = true;
+    m_previousSendMs = sendTimeMs;
+    m_previousArrivalMs = arrivalTimeMs;
+}
+
+void AdaptiveBitRateController::UpdateOveruseDetector(double gradientMs, double deltaMs) {
+    // Kalman escalar (passeio aleatório) sobre a variação de atraso entre frames
+    m_gradientVariance += KALMAN_PROCESS_NOISE;
+
+    double residual = gradientMs - m_delayGradientMs;
+    double clampedResidual = std::min(std::fabs(residual), 3.0 * std::sqrt(m_measurementNoise));
+    m_measurementNoise = std::max(1.0, NOISE_ESTIMATE_ALPHA * m_measurementNoise +
+                                       (1.0 - NOISE_ESTIMATE_ALPHA) * clampedResidual * clampedResidual);
+
+    double gain = m_gradientVariance / (m_gradientVariance + m_measurementNoise);
+    m_delayGradientMs += gain * residual;
+    m_gradientVariance *= (1.0 - gain);
+    m_gradientSamples++;
+
+    if (m_gradientSamples < 2) {
+        return;
+    }
+
+    double trend = m_delayGradientMs * TREND_GAIN;
+    double absTrend = std::fabs(trend);
+
+    if (absTrend <= m_overuseThresholdMs + THRESHOLD_SPIKE_MS) {
+        double rate = absTrend < m_overuseThresholdMs ? THRESHOLD_DOWN_RATE : THRESHOLD_UP_RATE;
+        m_overuseThresholdMs += rate * (absTrend - m_overuseThresholdMs) * std::min(deltaMs, 100.0);
+        m_overuseThresholdMs = std::clamp(m_overuseThresholdMs, THRESHOLD_MIN_MS, THRESHOLD_MAX_MS);
+    }
+
+    if (trend > m_overuseThresholdMs) {
+        // Duas amostras seguidas para não reagir a um frame atrasado isolado
+        if (++m_overuseCount >= 2) {
+            m_bandwidthUsage = BandwidthUsage::OVERUSING;
+        }
+    } else if (trend < -m_overuseThresholdMs) {
+        m_overuseCount = 0;
+        m_bandwidthUsage = BandwidthUsage::UNDERUSING;
+    } else {
+        m_overuseCount = 0;
+        m_bandwidthUsage = BandwidthUsage::NORMAL;
+    }
+}
+
+void AdaptiveBitRateController::UpdateQueueingDelay(double oneWayDelayMs, double arrivalTimeMs) {
+    // Mínimo em janela deslizante de 2 baldes (offset de relógio se cancela)
+    if (!m_hasBaseDelay) {
+        m_hasBaseDelay = true;
+        m_baseDelayMs = oneWayDelayMs;
+        m_previousBucketMinMs = oneWayDelayMs;
+        m_bucketStartMs = arrivalTimeMs;
+    } else if (arrivalTimeMs - m_bucketStartMs >= BASE_DELAY_BUCKET_MS) {
+        double currentBucketMinMs = m_baseDelayMs;
+        m_baseDelayMs = std::min(m_previousBucketMinMs, oneWayDelayMs);
+        m_previousBucketMinMs = std::min(currentBucketMinMs, oneWayDelayMs);
+        m_bucketStartMs = arrivalTimeMs;
+    }
+
+    m_baseDelayMs = std::min(m_baseDelayMs, oneWayDelayMs);
+    m_previousBucketMinMs = std::min(m_previousBucketMinMs, oneWayDelayMs);
+
+    m_queueingDelayMs = QUEUEING_DELAY_ALPHA * m_queueingDelayMs +
+                        (1.0 - QUEUEING_DELAY_ALPHA) * (oneWayDelayMs - m_baseDelayMs);
+}
+
+double AdaptiveBitRateController::MeasureGoodputKbps() {
+    if (m_ackedBytes.empty()) {
+        return 0.0;
+    }
+
+    // Janela já aparada em OnPacketFeedback; efetiva curta no início da sessão
+    double newestMs = m_ackedBytes.back().first;
+    double spanMs = std::clamp(newestMs - m_ackedBytes.front().first, 100.0, GOODPUT_WINDOW_MS);
+    return m_ackedBytesInWindow * 8.0 / spanMs;     // bits/ms = kbps
+}
+
+void AdaptiveBitRateController::UpdateSendBuffer(size_t bufferedBytes, size_t lowWatermarkBytes,
+                                                 size_t highWatermarkBytes) {
+    m_sendBufferBytes = bufferedBytes;
+    m_sendBufferLowBytes = lowWatermarkBytes;
+    m_sendBufferHighBytes = highWatermarkBytes;
+}
+
+bool AdaptiveBitRateController::IsSendBufferAboveHigh() const {
+    return m_sendBufferHighBytes > 0 && m_sendBufferBytes > m_sendBufferHighBytes;
+}
+
+bool AdaptiveBitRateController::IsSendBufferAboveLow() const {
+    return m_sendBufferHighBytes > 0 && m_sendBufferBytes > m_sendBufferLowBytes;
+}
+
+void AdaptiveBitRateController::UpdateTransportStats(const TransportStats& stats) {
+    if (stats.rttMs <= 0.0) {
+        return;
+    }
+
+    m_transportRttMs = stats.rttMs;
+    m_availableBitrateKbps = stats.availableOutgoingBitrateKbps;
+    UpdateMetrics(stats.rttMs / 2.0, stats.packetLossPercent, m_decoderBufferMs);
 }
 
 void AdaptiveBitRateController::UpdateMetrics(double networkLatencyMs,
@@ -197,30 +384,47 @@ void AdaptiveBitRateController::UpdateMetrics(double networkLatencyMs,
 }
 
 void AdaptiveBitRateController::CalculateTargetBitrate() {
+    if (m_mode == AdaptationMode::MODEL_BASED) {
+        CalculateModelBasedBitrate();
+        UpdateRung();
+        return;
+    }
+
     uint32_t newBitrate = m_currentBitrateMbps;
 
+    // Buffer de envio acima do watermark alto: o link não escoa o bitrate atual
+    bool sendBacklog = IsSendBufferAboveHigh();
+    bool sendBuffered = IsSendBufferAboveLow();
+
     // Algoritmo de adaptação baseado em métricas
     if (m_mode == AdaptationMode::CONSERVATIVE) {
         // Reduzir agressivamente se houver problemas
-        if (m_packetLossPercent > 5.0) {
+        if (m_packetLossPercent > 5.0 || sendBacklog) {
             newBitrate = (m_currentBitrateMbps * 70) / 100; // Reduzir 30%
         } else if (m_networkLatencyMs > 100.0) {
             newBitrate = (m_currentBitrateMbps * 80) / 100; // Reduzir 20%
         }
     } else if (m_mode == AdaptationMode::BALANCED) {
         // Adaptação equilibrada
-        if (m_packetLossPercent > 3.0 || m_networkLatencyMs > 80.0) {
+        if (m_packetLossPercent > 3.0 || m_networkLatencyMs > 80.0 || sendBacklog) {
             newBitrate = (m_currentBitrateMbps * 85) / 100; // Reduzir 15%
-        } else if (m_packetLossPercent < 1.0 && m_networkLatencyMs < 50.0) {
+        } else if (m_packetLossPercent < 1.0 && m_networkLatencyMs < 50.0 && !sendBuffered) {
             newBitrate = std::min((m_currentBitrateMbps * 110) / 100, m_maxBitrateMbps); // Aumentar 10%
         }
     } else if (m_mode == AdaptationMode::AGGRESSIVE) {
         // Aumentar agressivamente se houver headroom
-        if (m_packetLossPercent < 0.5 && m_networkLatencyMs < 40.0) {
+        if (sendBacklog) {
+            newBitrate = (m_currentBitrateMbps * 85) / 100; // Reduzir 15%
+        } else if (m_packetLossPercent < 0.5 && m_networkLatencyMs < 40.0 && !sendBuffered) {
             newBitrate = std::min((m_currentBitrateMbps * 120) / 100, m_maxBitrateMbps); // Aumentar 20%
         }
     }
 
+    // Teto do transporte (banda disponível), sem descer do mínimo
+    if (m_availableBitrateKbps > 0.0) {
+        newBitrate = std::min(newBitrate, static_cast<uint32_t>(m_availableBitrateKbps / 1000.0));
+    }
+
     // Clampar dentro dos limites
     newBitrate = std::max(newBitrate, m_minBitrateMbps);
     newBitrate = std::min(newBitrate, m_maxBitrateMbps);
@@ -233,13 +437,239 @@ void AdaptiveBitRateController::CalculateTargetBitrate() {
         std::string msg = "ABR: Bitrate changed to " + std::to_string(newBitrate) + " Mbps\n";
         OutputDebugStringA(msg.c_str());
     }
+
+    m_currentBitrateKbps = m_currentBitrateMbps * 1000;
+    m_modelBitrateKbps = m_currentBitrateKbps;
+
+    UpdateRung();
+}
+
+void AdaptiveBitRateController::SetLadder(std::vector<LadderRung> ladder) {
+    std::sort(ladder.begin(), ladder.end(), [](const LadderRung& a, const LadderRung& b) {
+        return a.minBitrateKbps < b.minBitrateKbps;
+    });
+    m_ladder = std::move(ladder);
+    m_rungUpSinceMs = -1.0;
+
+    // Mínimo acima do limiar de descida do 2º degrau: o degrau 0 seria inalcançável
+    // (ex: 5 Mbps de mínimo contra 2 Mbps do degrau 5/6 em 1080p)
+    if (m_ladder.size() > 1) {
+        double reachableKbps = m_ladder[1].minBitrateKbps * (1.0 - RUNG_DOWN_MARGIN);
+        if (m_minBitrateKbps >= reachableKbps) {
+            uint32_t floorKbps = static_cast<uint32_t>(m_ladder[1].minBitrateKbps * LADDER_FLOOR_FRACTION);
+            m_minBitrateKbps = std::max(ABR_STEP_KBPS, floorKbps / ABR_STEP_KBPS * ABR_STEP_KBPS);
+            m_minBitrateMbps = std::max(1u, std::min(m_minBitrateMbps, m_minBitrateKbps / 1000));
+
+            std::string msg = "ABR: Minimo reduzido para " + std::to_string(m_minBitrateKbps) +
+                              " kbps (escada)\n";
+            OutputDebugStringA(msg.c_str());
+        }
+    }
+
+    // Degrau inicial sem histerese
+    m_currentRung = m_ladder.empty() ? -1 : 0;
+    for (size_t i = 0; i < m_ladder.size(); ++i) {
+        if (m_currentBitrateKbps >= m_ladder[i].minBitrateKbps) {
+            m_currentRung = static_cast<int32_t>(i);
+        }
+    }
+}
+
+std::vector<LadderRung> AdaptiveBitRateController::BuildDefaultLadder(uint32_t sourceWidth,
+                                                                      uint32_t sourceHeight) {
+    // Dimensões pares (exigência de encoders 4:2:0)
+    auto scaled = [](uint32_t value, uint32_t num, uint32_t den) {
+        return std::max(2u, (value * num / den) & ~1u);
+    };
+
+    // Limiares para 1080p; escalam com a área da captura
+    const double areaScale = std::max(0.25, (static_cast<double>(sourceWidth) * sourceHeight) / (1920.0 * 1080.0));
+    auto kbps = [areaScale](double base) { return static_cast<uint32_t>(base * areaScale); };
+
+    return {
+        { 0,          30, scaled(sourceWidth, 2, 3), scaled(sourceHeight, 2, 3) },
+        { kbps(2000), 30, scaled(sourceWidth, 5, 6), scaled(sourceHeight, 5, 6) },
+        { kbps(3500), 30, sourceWidth, sourceHeight },
+        { kbps(7000), 60, sourceWidth, sourceHeight },
+    };
+}
+
+void AdaptiveBitRateController::UpdateRung() {
+    if (m_ladder.empty()) {
+        return;
+    }
+
+    const int32_t previousRung = m_currentRung;
+
+    // Descida imediata (pode pular vários degraus)
+    while (m_currentRung > 0 &&
+           m_currentBitrateKbps < m_ladder[m_currentRung].minBitrateKbps * (1.0 - RUNG_DOWN_MARGIN)) {
+        m_currentRung--;
+    }
+
+    // Subida de um degrau por vez, com folga sustentada
+    const size_t next = static_cast<size_t>(m_currentRung) + 1;
+    if (m_currentRung == previousRung && next < m_ladder.size() &&
+        m_currentBitrateKbps >= m_ladder[next].minBitrateKbps * (1.0 + RUNG_UP_MARGIN)) {
+        double nowMs = NowMs();
+        if (m_rungUpSinceMs < 0.0) {
+            m_rungUpSinceMs = nowMs;
+        } else if (nowMs - m_rungUpSinceMs >= RUNG_UP_HOLD_MS) {
+            m_currentRung++;
+            m_rungUpSinceMs = -1.0;
+        }
+    } else {
+        m_rungUpSinceMs = -1.0;
+    }
+
+    if (m_currentRung != previousRung) {
+        m_rungChangeCount++;
+
+        const LadderRung& rung = m_ladder[m_currentRung];
+        std::string msg = "ABR: Rung " + std::to_string(m_currentRung) + " (" +
+                          std::to_string(rung.width) + "x" + std::to_string(rung.height) + "@" +
+                          std::to_string(rung.fps) + ")\n";
+        OutputDebugStringA(msg.c_str());
+    }
+}
+
+OperatingPoint AdaptiveBitRateController::GetOperatingPoint() const {
+    OperatingPoint point;
+    point.bitrateKbps = m_currentBitrateKbps;
+
+    if (m_currentRung >= 0) {
+        const LadderRung& rung = m_ladder[m_currentRung];
+        point.fps = rung.fps;
+        point.width = rung.width;
+        point.height = rung.height;
+    }
+
+    return point;
+}
+
+void AdaptiveBitRateController::CalculateModelBasedBitrate() {
+    double nowMs = NowMs();
+    double elapsedMs = m_lastUpdateMs < 0.0 ? 0.0 : std::max(0.0, nowMs - m_lastUpdateMs);
+    m_lastUpdateMs = nowMs;
+
+    m_goodputKbps = MeasureGoodputKbps();
+    m_smoothedLossPercent = LOSS_SMOOTHING_ALPHA * m_smoothedLossPercent +
+                            (1.0 - LOSS_SMOOTHING_ALPHA) * m_packetLossPercent;
+
+    const double current = m_modelBitrateKbps;
+    double next = current;
+
+    // Jitter alto eleva o atraso de fila aparente: limiar acompanha o ruído do filtro
+    double queueingThresholdMs = QUEUEING_DELAY_HIGH_MS + std::sqrt(m_measurementNoise);
+    bool deepQueue = m_queueingDelayMs > queueingThresholdMs;
+
+    bool heavyLoss = m_smoothedLossPercent > LOSS_DECREASE_PERCENT;
+    bool sendBacklog = IsSendBufferAboveHigh();
+    bool congested = m_bandwidthUsage == BandwidthUsage::OVERUSING || heavyLoss || deepQueue ||
+                     sendBacklog || m_decoderBufferMs > DECODER_BUFFER_HIGH_MS ||
+                     m_networkLatencyMs > LATENCY_CEILING_MS;
+
+    if (congested) {
+        // No máximo uma redução por RTT (aprox. 2x latência de ida)
+        double decreaseIntervalMs = std::max(MIN_DECREASE_INTERVAL_MS, 2.0 * m_networkLatencyMs);
+
+        if (nowMs - m_lastDecreaseMs >= decreaseIntervalMs) {
+            double base = m_goodputKbps > 0.0 ? std::min(m_goodputKbps, current) : current;
+
+            if (heavyLoss && m_bandwidthUsage != BandwidthUsage::OVERUSING && !deepQueue) {
+                // Perda sem fila crescendo: reduz proporcional à perda
+                next = current * (1.0 - 0.5 * m_smoothedLossPercent / 100.0);
+            } else {
+                // β sobre o goodput; com fila funda, abaixo disso para drená-la
+                double drainFactor = std::max(0.5, 1.0 - m_queueingDelayMs / QUEUE_DRAIN_TARGET_MS);
+                next = std::min(DECREASE_FACTOR, drainFactor) * base;
+            }
+            if (sendBacklog) {
+                // Escoar o backlog local em ~1 s, além da redução normal
+                double backlogKbps = m_sendBufferBytes * 8.0 / QUEUE_DRAIN_TARGET_MS;
+                next = std::min(next, std::max(0.5 * base, base - backlogKbps));
+            }
+            next = std::min(next, current);
+
+            if (m_goodputKbps > 0.0) {
+                m_linkCapacityKbps = m_linkCapacityKbps > 0.0
+                    ? 0.8 * m_linkCapacityKbps + 0.2 * m_goodputKbps
+                    : m_goodputKbps;
+            }
+            m_lastDecreaseMs = nowMs;
+        }
+    } else if (m_bandwidthUsage == BandwidthUsage::UNDERUSING ||
+               m_smoothedLossPercent >= LOSS_HOLD_PERCENT || IsSendBufferAboveLow() ||
+               m_decoderBufferMs > DECODER_BUFFER_LOW_MS) {
+        // Hold: fila drenando ou sinais moderados
+    } else if (nowMs - m_lastDecreaseMs >= HOLD_OFF_MS) {
+        if (m_linkCapacityKbps > 0.0 && current > CAPACITY_RESET_FACTOR * m_linkCapacityKbps) {
+            m_linkCapacityKbps = 0.0;
+        }
+
+        // Perto da capacidade conhecida: aditivo; longe (ou desconhecida): multiplicativo
+        double seconds = elapsedMs / 1000.0;
+        bool nearCapacity = m_linkCapacityKbps > 0.0 &&
+                            current >= NEAR_CAPACITY_FRACTION * m_linkCapacityKbps;
+        double increase = nearCapacity
+            ? ADDITIVE_INCREASE_KBPS_PER_S * seconds
+            : current * (std::pow(1.0 + MULTIPLICATIVE_INCREASE_PER_S, seconds) - 1.0);
+
+        next = current + increase;
+
+        // Não se afastar demais do que o link comprovadamente entrega
+        if (m_goodputKbps > 0.0) {
+            next = std::max(current, std::min(next, 1.5 * m_goodputKbps + 100.0));
+        }
+    }
+
+    if (m_availableBitrateKbps > 0.0) {
+        next = std::min(next, m_availableBitrateKbps);
+    }
+
+    ApplyBitrateKbps(next);
+}
+
+void AdaptiveBitRateController::ApplyBitrateKbps(double bitrateKbps) {
+    bitrateKbps = std::clamp(bitrateKbps, static_cast<double>(m_minBitrateKbps), m_maxBitrateMbps * 1000.0);
+    m_modelBitrateKbps = bitrateKbps;
+
+    uint32_t quantizedKbps = static_cast<uint32_t>(bitrateKbps / ABR_STEP_KBPS) * ABR_STEP_KBPS;
+    quantizedKbps = std::max(quantizedKbps, m_minBitrateKbps);
+
+    if (quantizedKbps != m_currentBitrateKbps) {
+        m_currentBitrateKbps = quantizedKbps;
+        m_previousBitrateMbps = m_currentBitrateMbps;
+        m_currentBitrateMbps = std::max(1u, (quantizedKbps + 500) / 1000);
+        m_bitrateChangeCount++;
+
+        std::string msg = "ABR: Bitrate changed to " + std::to_string(quantizedKbps) + " kbps\n";
+        OutputDebugStringA(msg.c_str());
+    }
 }
 
 AdaptiveBitRateController::ABRStats AdaptiveBitRateController::GetStats() const {
     ABRStats stats;
     stats.currentBitrateMbps = m_currentBitrateMbps;
+    stats.currentBitrateKbps = m_currentBitrateKbps;
     stats.currentLatencyMs = m_networkLatencyMs;
     stats.currentPacketLossPercent = m_packetLossPercent;
+    stats.decoderBufferMs = m_decoderBufferMs;
+    stats.delayGradientMs = m_delayGradientMs;
+    stats.queueingDelayMs = m_queueingDelayMs;
+    stats.goodputKbps = m_goodputKbps;
+    stats.sendBufferBytes = m_sendBufferBytes;
+    stats.transportRttMs = m_transportRttMs;
+    stats.availableBitrateKbps = m_availableBitrateKbps;
+    stats.bandwidthUsage = m_bandwidthUsage;
+
+    OperatingPoint point = GetOperatingPoint();
+    stats.currentRung = m_currentRung;
+    stats.rungCount = static_cast<uint32_t>(m_ladder.size());
+    stats.targetFps = point.fps;
+    stats.targetWidth = point.width;
+    stats.targetHeight = point.height;
+    stats.rungChangeCount = m_rungChangeCount;
     stats.bitrateChangeCount = m_bitrateChangeCount;
     return stats;
 }
@@ -270,30 +700,3 @@ bool WebRTCPeerConnection::ReceiveEncodedFrame(std::vector<uint8_t>& outData) {
     // Placeholder
     return false;
 }
-
-// ============================================================================
-// QUICTransport Implementation
-// ============================================================================
-
-QUICTransport::QUICTransport() {
-}
-
-QUICTransport::~QUICTransport() {
-}
-
-bool QUICTransport::Initialize(const std::string& remoteAddr, uint16_t remotePort) {
-    // Placeholder para integração futura com Quinn ou MASQUE
-    // TODO: Implementar transporte QUIC real
-    OutputDebugStringA("QUIC: Placeholder - Initialize not implemented\n");
-    return false;
-}
-
-bool QUICTransport::Send(const uint8_t* data, uint32_t size) {
-    // Placeholder
-    return false;
-}
-
-bool QUICTransport::Receive(std::vector<uint8_t>& outData) {
-    // Placeholder
-    return false;
-}
@@ -1,9 +1,31 @@
 #include "P2PManager.h"
+#include "Trace.h"
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <chrono>
 
-P2PManager::P2PManager() {
+namespace {
+
+// Mensagens de controle guardadas enquanto o chamador só lê frames
+constexpr size_t MAX_PENDING_MESSAGES = 256;
+
+// Probe de transporte: intervalo e suavização do RTT (RFC 6298, α = 1/8)
+constexpr auto TRANSPORT_PROBE_INTERVAL = std::chrono::milliseconds(250);
+constexpr double RTT_SMOOTHING_ALPHA = 0.125;
+
+// FRAME_FEEDBACK: chegadas juntadas por até 10 ms; confirmações guardadas até o ABR ler
+constexpr auto FRAME_FEEDBACK_INTERVAL = std::chrono::milliseconds(10);
+constexpr size_t MAX_PENDING_FEEDBACK = 1024;
+
+uint64_t SteadyNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+P2PManager::P2PManager() : m_sentFrames(SENT_FRAME_HISTORY) {
     m_sendBuffer.reserve(m_sendBufferSize);
     m_receiveBuffer.reserve(m_recvBufferSize);
 }
@@ -12,11 +34,8 @@ P2PManager::~P2PManager() {
     Disconnect();
 }
 
-bool P2PManager::InitializeWinsock() {
-    WSADATA wsaData;
-    int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
-    
-    if (result != 0) {
+bool P2PManager::InitializeSockets() {
+    if (!SocketStartup()) {
         OutputDebugStringA("WSAStartup failed\n");
         return false;
     }
@@ -34,8 +53,7 @@ bool P2PManager::CreateUDPSocket() {
     }
 
     // Configurar socket para não-bloqueante
-    u_long mode = 1;
-    if (ioctlsocket(m_socket, FIONBIO, &mode) != 0) {
+    if (!SetSocketNonBlocking(m_socket)) {
         OutputDebugStringA("ioctlsocket() failed\n");
         closesocket(m_socket);
         return false;
@@ -66,7 +84,7 @@ bool P2PManager::BindSocket(uint16_t port) {
 }
 
 bool P2PManager::InitializeAsServer(uint16_t listenPort) {
-    if (!InitializeWinsock()) {
+    if (!InitializeSockets()) {
         return false;
     }
 
@@ -88,7 +106,7 @@ bool P2PManager::InitializeAsServer(uint16_t listenPort) {
 }
 
 bool P2PManager::InitializeAsClient(const std::string& serverIP, uint16_t serverPort) {
-    if (!InitializeWinsock()) {
+    if (!InitializeSockets()) {
         return false;
     }
 
@@ -109,6 +127,77 @@ bool P2PManager::InitializeAsClient(const std::string& serverIP, uint16_t server
     return true;
 }
 
+bool P2PManager::InitializeWithChannel(std::shared_ptr<IDatagramChannel> channel, Role role) {
+    if (!channel) {
+        return false;
+    }
+
+    m_channel = std::move(channel);
+    m_role = role;
+    m_isConnected = true;
+
+    OutputDebugStringA("P2P initialized over datagram channel\n");
+    return true;
+}
+
+void P2PManager::AcceptResumedPeer() {
+    if (m_role == Role::SERVER && m_hasResumeAddr) {
+        m_peerAddr = m_resumeAddr;
+        m_hasResumeAddr = false;
+        m_peerGeneration++;
+    }
+}
+
+bool P2PManager::ReopenSocket() {
+    if (m_channel || m_role != Role::CLIENT) {
+        return m_isConnected;
+    }
+
+    if (m_socket != INVALID_SOCKET) {
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    // m_peerAddr continua o do host: último par de candidatos que funcionou
+    if (!CreateUDPSocket()) {
+        m_socket = INVALID_SOCKET;
+        return false;
+    }
+
+    // Pacotes lidos do socket antigo não valem mais
+    m_pendingMessages.clear();
+    m_hasPendingFrame = false;
+    return true;
+}
+
+uint64_t P2PManager::GetIdleMs() const {
+    if (m_stats.totalFramesReceived == 0) {
+        return UINT64_MAX;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - m_lastFrameTime).count();
+}
+
+uint16_t P2PManager::GetLocalPort() const {
+    if (m_socket == INVALID_SOCKET) {
+        return 0;
+    }
+
+    sockaddr_in localAddr = {};
+    socklen_t localAddrLen = sizeof(localAddr);
+    if (getsockname(m_socket, reinterpret_cast<sockaddr*>(&localAddr), &localAddrLen) == SOCKET_ERROR) {
+        return 0;
+    }
+    return ntohs(localAddr.sin_port);
+}
+
+size_t P2PManager::GetSendBufferedBytes() const {
+    if (m_channel) {
+        return m_channel->GetBufferedAmount();
+    }
+    return m_socket == INVALID_SOCKET ? 0 : SocketSendQueueBytes(m_socket);
+}
+
 bool P2PManager::ConnectToServer(const std::string& ip, uint16_t port) {
     m_peerAddr.sin_family = AF_INET;
     m_peerAddr.sin_port = htons(port);
@@ -123,28 +212,51 @@ bool P2PManager::ConnectToServer(const std::string& ip, uint16_t port) {
 }
 
 bool P2PManager::SendPacket(const NetworkPacket& packet) {
-    if (!m_isConnected || m_socket == INVALID_SOCKET) {
+    RDC_TRACE_SCOPE("P2PManager::SendPacket");
+
+    if (!m_isConnected) {
         return false;
     }
 
     // Serializar header + dados
-    m_sendBuffer.clear();
-    m_sendBuffer.reserve(sizeof(NetworkFrameHeader) + packet.pixelData.size());
+    SerializePacket(packet, m_sendBuffer);
 
-    // Copiar header
-    const uint8_t* headerPtr = reinterpret_cast<const uint8_t*>(&packet.header);
-    m_sendBuffer.insert(m_sendBuffer.end(), headerPtr, headerPtr + sizeof(NetworkFrameHeader));
+    return SendDatagram(m_sendBuffer.data(), m_sendBuffer.size());
+}
 
-    // Copiar dados dos pixels
-    m_sendBuffer.insert(m_sendBuffer.end(), 
-                       packet.pixelData.begin(), 
-                       packet.pixelData.end());
+bool P2PManager::SendDatagram(const uint8_t* datagram, size_t size) {
+    if (!m_isConnected || !datagram || size < sizeof(NetworkFrameHeader)) {
+        return false;
+    }
+
+    // FRAME: instante de envio para casar com o FRAME_FEEDBACK do peer
+    NetworkFrameHeader header;
+    std::memcpy(&header, datagram, sizeof(header));
+    if (static_cast<PacketType>(header.packetType) == PacketType::FRAME) {
+        SentFrame& sent = m_sentFrames[header.frameSequence % SENT_FRAME_HISTORY];
+        sent.sendTimeUs = SteadyNowUs();
+        sent.frameSequence = header.frameSequence;
+        sent.pending = true;
+    }
+
+    if (m_channel) {
+        if (!m_channel->Send(datagram, size)) {
+            return false;
+        }
+        m_stats.totalBytesSent += size;
+        m_stats.totalFramesSent++;
+        return true;
+    }
+
+    if (m_socket == INVALID_SOCKET) {
+        return false;
+    }
 
     // Enviar packet
     int sentBytes = sendto(
         m_socket,
-        (char*)m_sendBuffer.data(),
-        (int)m_sendBuffer.size(),
+        (const char*)datagram,
+        (int)size,
         0,
         (sockaddr*)&m_peerAddr,
         sizeof(m_peerAddr)
@@ -165,12 +277,33 @@ bool P2PManager::SendPacket(const NetworkPacket& packet) {
 }
 
 bool P2PManager::ReceivePacket(NetworkPacket& outPacket) {
-    if (!m_isConnected || m_socket == INVALID_SOCKET) {
+    RDC_TRACE_SCOPE("P2PManager::ReceivePacket");
+
+    if (!m_isConnected) {
+        return false;
+    }
+
+    if (m_channel) {
+        if (!m_channel->Receive(m_channelBuffer)) {
+            return false; // Nenhum dado disponível
+        }
+        if (!DeserializePacket(m_channelBuffer.data(), m_channelBuffer.size(), outPacket)) {
+            OutputDebugStringA("Invalid packet (too small or bad magic)\n");
+            return false;
+        }
+        m_stats.totalBytesReceived += m_channelBuffer.size();
+        m_stats.totalFramesReceived++;
+        m_lastFrameTime = std::chrono::high_resolution_clock::now();
+        RecordFrameArrival(outPacket, m_channelBuffer.size());
+        return true;
+    }
+
+    if (m_socket == INVALID_SOCKET) {
         return false;
     }
 
     sockaddr_in fromAddr = {};
-    int fromAddrLen = sizeof(fromAddr);
+    socklen_t fromAddrLen = sizeof(fromAddr);
 
     // Receber dados
     int receivedBytes = recvfrom(
@@ -191,37 +324,37 @@ bool P2PManager::ReceivePacket(NetworkPacket& outPacket) {
         return false; // Nenhum dado disponível
     }
 
-    if (receivedBytes < (int)sizeof(NetworkFrameHeader)) {
-        OutputDebugStringA("Packet too small\n");
+    // Desserializar header + pixels (valida tamanho e magic number)
+    if (!DeserializePacket(m_receiveBuffer.data(), static_cast<size_t>(receivedBytes), outPacket)) {
+        OutputDebugStringA("Invalid packet (too small or bad magic)\n");
         return false;
     }
 
-    // Desserializar header
-    std::memcpy(&outPacket.header, m_receiveBuffer.data(), sizeof(NetworkFrameHeader));
-
-    // Validar magic number
-    if (outPacket.header.magic != NetworkFrameHeader::MAGIC) {
-        OutputDebugStringA("Invalid magic number\n");
-        return false;
+    // Peer fixado: de outros endereços só entra SESSION_RESUME (o token decide)
+    bool fromOtherAddress = m_peerLocked && (fromAddr.sin_addr.s_addr != m_peerAddr.sin_addr.s_addr ||
+                                             fromAddr.sin_port != m_peerAddr.sin_port);
+    if (fromOtherAddress) {
+        if (static_cast<PacketType>(outPacket.header.packetType) != PacketType::SESSION_RESUME) {
+            return false;
+        }
+        m_resumeAddr = fromAddr;
+        m_hasResumeAddr = true;
     }
 
-    // Extrair dados dos pixels
-    uint32_t pixelDataSize = receivedBytes - sizeof(NetworkFrameHeader);
-    outPacket.pixelData.resize(pixelDataSize);
-    std::memcpy(outPacket.pixelData.data(), 
-                m_receiveBuffer.data() + sizeof(NetworkFrameHeader),
-                pixelDataSize);
-
     m_stats.totalBytesReceived += receivedBytes;
     m_stats.totalFramesReceived++;
 
     // Atualizar peer address para servidor modo
-    if (m_role == Role::SERVER) {
+    if (m_role == Role::SERVER && !fromOtherAddress) {
+        if (fromAddr.sin_addr.s_addr != m_peerAddr.sin_addr.s_addr || fromAddr.sin_port != m_peerAddr.sin_port) {
+            m_peerGeneration++;
+        }
         m_peerAddr = fromAddr;
     }
 
     // Calcular latência
     m_lastFrameTime = std::chrono::high_resolution_clock::now();
+    RecordFrameArrival(outPacket, static_cast<size_t>(receivedBytes));
 
     return true;
 }
@@ -233,17 +366,12 @@ bool P2PManager::SendFrame(const uint8_t* pixelData, uint32_t width, uint32_t he
     }
 
     NetworkPacket packet;
-    packet.header.magic = NetworkFrameHeader::MAGIC;
-    packet.header.version = NetworkFrameHeader::VERSION;
+    FillHeader(packet.header, PacketType::FRAME);
     packet.header.frameSequence = frameSequence;
     packet.header.frameWidth = width;
     packet.header.frameHeight = height;
     packet.header.frameStride = stride;
     packet.header.pixelDataSize = stride * height;
-    packet.header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch()
-    ).count();
-    packet.header.flags = 0;
 
     // Copiar dados de pixels
     packet.pixelData.resize(packet.header.pixelDataSize);
@@ -252,13 +380,50 @@ bool P2PManager::SendFrame(const uint8_t* pixelData, uint32_t width, uint32_t he
     return SendPacket(packet);
 }
 
+bool P2PManager::SendFrameDelta(const uint8_t* payload, size_t size, uint32_t width, uint32_t height,
+                                uint32_t stride, uint16_t frameSequence) {
+    if (!payload || size == 0) {
+        return false;
+    }
+
+    NetworkPacket packet;
+    FillHeader(packet.header, PacketType::FRAME);
+    packet.header.frameSequence = frameSequence;
+    packet.header.frameWidth = width;
+    packet.header.frameHeight = height;
+    packet.header.frameStride = stride;
+    packet.header.pixelDataSize = static_cast<uint32_t>(size);
+    packet.header.flags = FRAME_FLAG_TILE_DELTA;
+    packet.pixelData.assign(payload, payload + size);
+
+    return SendPacket(packet);
+}
+
 bool P2PManager::ReceiveFrame(std::vector<uint8_t>& outPixelData,
                              uint32_t& outWidth, uint32_t& outHeight,
                              uint32_t& outStride, uint16_t& outFrameSequence) {
     NetworkPacket packet;
-    
-    if (!ReceivePacket(packet)) {
-        return false;
+
+    if (m_hasPendingFrame) {
+        packet = std::move(m_pendingFrame);
+        m_hasPendingFrame = false;
+    } else {
+        // Mensagens de controle no caminho ficam para ReceiveControlMessage
+        while (true) {
+            if (!ReceivePacket(packet)) {
+                return false;
+            }
+            if (static_cast<PacketType>(packet.header.packetType) == PacketType::FRAME) {
+                break;
+            }
+            if (HandleTransportMessage(packet)) {
+                continue;
+            }
+            if (m_pendingMessages.size() >= MAX_PENDING_MESSAGES) {
+                m_pendingMessages.pop_front();
+            }
+            m_pendingMessages.push_back(std::move(packet));
+        }
     }
 
     outPixelData = std::move(packet.pixelData);
@@ -266,11 +431,219 @@ bool P2PManager::ReceiveFrame(std::vector<uint8_t>& outPixelData,
     outHeight = packet.header.frameHeight;
     outStride = packet.header.frameStride;
     outFrameSequence = packet.header.frameSequence;
+    m_lastFrameFlags = packet.header.flags;
+    m_lastFrameLayer = packet.header.layerId;
+
+    return true;
+}
+
+void P2PManager::FillHeader(NetworkFrameHeader& header, PacketType type) const {
+    std::memset(&header, 0, sizeof(header));
+    header.magic = NetworkFrameHeader::MAGIC;
+    header.version = NetworkFrameHeader::VERSION;
+    header.packetType = static_cast<uint8_t>(type);
+    header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now().time_since_epoch()
+    ).count();
+}
+
+bool P2PManager::SendControlMessage(PacketType type, const uint8_t* payload, size_t size) {
+    if (!payload && size > 0) {
+        return false;
+    }
+
+    NetworkPacket packet;
+    FillHeader(packet.header, type);
+    packet.header.pixelDataSize = static_cast<uint32_t>(size);
+    packet.pixelData.assign(payload, payload + size);
+
+    return SendPacket(packet);
+}
+
+bool P2PManager::ReceiveControlMessage(PacketType& outType, std::vector<uint8_t>& outPayload) {
+    NetworkPacket packet;
 
+    if (!m_pendingMessages.empty()) {
+        packet = std::move(m_pendingMessages.front());
+        m_pendingMessages.pop_front();
+    } else {
+        while (true) {
+            if (!ReceivePacket(packet)) {
+                return false;
+            }
+            if (static_cast<PacketType>(packet.header.packetType) != PacketType::FRAME) {
+                if (HandleTransportMessage(packet)) {
+                    continue;
+                }
+                break;
+            }
+            // Frame no caminho: guarda só o mais recente
+            m_pendingFrame = std::move(packet);
+            m_hasPendingFrame = true;
+        }
+    }
+
+    outType = static_cast<PacketType>(packet.header.packetType);
+    outPayload = std::move(packet.pixelData);
+    return true;
+}
+
+void P2PManager::ServiceTransportStats() {
+    // Servidor UDP só conhece o peer depois do primeiro pacote dele
+    if (!m_isConnected || (!m_channel && m_peerAddr.sin_port == 0)) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastProbeSent >= TRANSPORT_PROBE_INTERVAL) {
+        m_lastProbeSent = now;
+
+        // packetsSent inclui o próprio probe: o peer conta tudo até ele
+        TransportProbeMessage probe = {};
+        probe.sequence = ++m_probeSequence;
+        probe.sendTimeUs = SteadyNowUs();
+        probe.packetsSent = m_stats.totalFramesSent + 1;
+        SendControlMessage(PacketType::TRANSPORT_PROBE, reinterpret_cast<const uint8_t*>(&probe),
+                           sizeof(probe));
+    }
+
+    if (!m_frameArrivals.empty() && now - m_lastFeedbackSent >= FRAME_FEEDBACK_INTERVAL) {
+        FlushFrameArrivals();
+    }
+
+    double lossPercent = 0.0;
+    double bitrateKbps = 0.0;
+    uint64_t nowMs = SteadyNowUs() / 1000;
+    if (m_transportWindow.Sample(nowMs, m_probedPacketsSent, m_transportStats.packetsLost,
+                                 m_stats.totalBytesSent, lossPercent, bitrateKbps)) {
+        m_transportStats.packetLossPercent = lossPercent;
+        m_transportStats.sendBitrateKbps = bitrateKbps;
+        m_transportStats.sampleCount++;
+        m_stats.bandwidthMbps = bitrateKbps / 1000.0;
+    }
+    m_transportStats.packetsSent = m_stats.totalFramesSent;
+    m_transportStats.bytesSent = m_stats.totalBytesSent;
+}
+
+void P2PManager::TakeFrameFeedback(std::vector<FrameFeedback>& outFeedback) {
+    outFeedback.assign(m_frameFeedback.begin(), m_frameFeedback.end());
+    m_frameFeedback.clear();
+}
+
+void P2PManager::RecordFrameArrival(const NetworkPacket& packet, size_t bytes) {
+    if (static_cast<PacketType>(packet.header.packetType) != PacketType::FRAME) {
+        return;
+    }
+
+    FrameArrivalEntry entry = {};
+    entry.frameSequence = packet.header.frameSequence;
+    entry.bytes = static_cast<uint32_t>(bytes);
+    entry.arrivalTimeUs = SteadyNowUs();
+    m_frameArrivals.push_back(entry);
+
+    // Mensagem cheia sai na hora, sem esperar o próximo ServiceTransportStats
+    if (m_frameArrivals.size() >= FRAME_FEEDBACK_MAX_ENTRIES) {
+        FlushFrameArrivals();
+    }
+}
+
+void P2PManager::FlushFrameArrivals() {
+    m_lastFeedbackSent = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < m_frameArrivals.size(); first += FRAME_FEEDBACK_MAX_ENTRIES) {
+        size_t count = std::min(FRAME_FEEDBACK_MAX_ENTRIES, m_frameArrivals.size() - first);
+        SendControlMessage(PacketType::FRAME_FEEDBACK,
+                           reinterpret_cast<const uint8_t*>(m_frameArrivals.data() + first),
+                           count * sizeof(FrameArrivalEntry));
+    }
+    m_frameArrivals.clear();
+}
+
+void P2PManager::HandleFrameFeedback(const NetworkPacket& packet) {
+    size_t count = packet.pixelData.size() / sizeof(FrameArrivalEntry);
+    for (size_t i = 0; i < count; ++i) {
+        FrameArrivalEntry entry;
+        std::memcpy(&entry, packet.pixelData.data() + i * sizeof(entry), sizeof(entry));
+
+        // Cada frame enviado confirma uma vez; sequência já sobrescrita no histórico é ignorada
+        SentFrame& sent = m_sentFrames[entry.frameSequence % SENT_FRAME_HISTORY];
+        if (!sent.pending || sent.frameSequence != entry.frameSequence) {
+            continue;
+        }
+        sent.pending = false;
+
+        if (m_frameFeedback.size() >= MAX_PENDING_FEEDBACK) {
+            m_frameFeedback.pop_front();
+        }
+        FrameFeedback feedback;
+        feedback.sendTimeMs = sent.sendTimeUs / 1000.0;
+        feedback.arrivalTimeMs = entry.arrivalTimeUs / 1000.0;
+        feedback.bytes = entry.bytes;
+        m_frameFeedback.push_back(feedback);
+    }
+}
+
+bool P2PManager::HandleTransportMessage(const NetworkPacket& packet) {
+    PacketType type = static_cast<PacketType>(packet.header.packetType);
+    if (type == PacketType::FRAME_FEEDBACK) {
+        HandleFrameFeedback(packet);
+        return true;
+    }
+    if (type != PacketType::TRANSPORT_PROBE && type != PacketType::TRANSPORT_PROBE_REPLY) {
+        return false;
+    }
+    if (packet.pixelData.size() != sizeof(TransportProbeMessage)) {
+        return true;
+    }
+
+    TransportProbeMessage probe;
+    std::memcpy(&probe, packet.pixelData.data(), sizeof(probe));
+
+    if (type == PacketType::TRANSPORT_PROBE) {
+        // Ecoar com quantos pacotes deste peer chegaram até aqui (incluindo o probe)
+        probe.packetsReceived = m_stats.totalFramesReceived;
+        SendControlMessage(PacketType::TRANSPORT_PROBE_REPLY, reinterpret_cast<const uint8_t*>(&probe),
+                           sizeof(probe));
+        return true;
+    }
+
+    uint64_t nowUs = SteadyNowUs();
+    if (probe.sendTimeUs == 0 || probe.sendTimeUs > nowUs) {
+        return true;
+    }
+
+    double rttMs = (nowUs - probe.sendTimeUs) / 1000.0;
+    m_transportStats.rttMs = m_transportStats.rttMs > 0.0
+        ? (1.0 - RTT_SMOOTHING_ALPHA) * m_transportStats.rttMs + RTT_SMOOTHING_ALPHA * rttMs
+        : rttMs;
+    m_stats.latencyMs = m_transportStats.rttMs;
+
+    // Perda entre duas respostas: enviados no intervalo menos recebidos pelo peer.
+    // Respostas fora de ordem (contadores menores) são ignoradas
+    if (m_hasProbeReply) {
+        if (probe.packetsSent <= m_lastReplyPacketsSent ||
+            probe.packetsReceived < m_lastReplyPacketsReceived) {
+            return true;
+        }
+        uint64_t sent = probe.packetsSent - m_lastReplyPacketsSent;
+        uint64_t received = probe.packetsReceived - m_lastReplyPacketsReceived;
+        m_probedPacketsSent += sent;
+        m_transportStats.packetsLost += sent > received ? sent - received : 0;
+    }
+    m_hasProbeReply = true;
+    m_lastReplyPacketsSent = probe.packetsSent;
+    m_lastReplyPacketsReceived = probe.packetsReceived;
     return true;
 }
 
 bool P2PManager::IsDataAvailable(int timeoutMs) {
+    if (m_hasPendingFrame || !m_pendingMessages.empty()) {
+        return true;
+    }
+
+    if (m_isConnected && m_channel) {
+        return m_channel->WaitReadable(timeoutMs);
+    }
+
     if (!m_isConnected || m_socket == INVALID_SOCKET) {
         return false;
     }
@@ -283,18 +656,31 @@ bool P2PManager::IsDataAvailable(int timeoutMs) {
     timeout.tv_sec = timeoutMs / 1000;
     timeout.tv_usec = (timeoutMs % 1000) * 1000;
 
-    int result = select(0, &readSet, nullptr, nullptr, &timeout);
+    int result = select(static_cast<int>(m_socket) + 1, &readSet, nullptr, nullptr, &timeout);
     return result > 0;
 }
 
 void P2PManager::Disconnect() {
+    m_channel.reset();
+    m_pendingMessages.clear();
+    m_hasPendingFrame = false;
+    m_peerLocked = false;
+    m_hasResumeAddr = false;
+    m_transportStats = TransportStats();
+    m_transportWindow.Reset();
+    m_hasProbeReply = false;
+    m_probedPacketsSent = 0;
+    m_sentFrames.assign(SENT_FRAME_HISTORY, SentFrame());
+    m_frameFeedback.clear();
+    m_frameArrivals.clear();
+
     if (m_socket != INVALID_SOCKET) {
         closesocket(m_socket);
         m_socket = INVALID_SOCKET;
     }
 
     if (m_wsaInitialized) {
-        WSACleanup();
+        SocketCleanup();
         m_wsaInitialized = false;
     }
 
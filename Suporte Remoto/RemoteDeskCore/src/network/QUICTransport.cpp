@@ -0,0 +1,784 @@
+/**
+ * @file QUICTransport.cpp
+ * @brief QUICTransport sobre msquic (RDC_HAVE_MSQUIC); sem a lib, Initialize/Listen falham
+ *
+ * Callbacks do msquic rodam nas threads dele: frames e datagramas recebidos vão para
+ * filas protegidas pelo mutex do Impl, e as chamadas ao msquic a partir da thread da
+ * aplicação nunca seguram o mutex enquanto esperam o worker (GetParam, *Close).
+ * Handles de conexão só são fechados em Close(), na thread da aplicação.
+ *
+ * O cliente não valida o certificado contra uma CA (autoassinado é o caso comum), mas
+ * pede o certificado (INDICATE_CERTIFICATE_RECEIVED, DER portável) e recusa o
+ * handshake se o SHA-256 não for o fingerprint recebido pela sinalização.
+ */
+
+#include "CertificateFingerprint.h"
+#include "OptimizationLayer.h"
+#include "PlatformCompat.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+
+#if RDC_HAVE_MSQUIC
+#include <msquic.h>
+#endif
+
+#if RDC_HAVE_MSQUIC
+
+namespace {
+
+constexpr uint16_t PEER_UNIDI_STREAMS = 64;                 // Frames que o peer pode ter abertos
+constexpr uint32_t STREAM_RECV_WINDOW = 4 * 1024 * 1024;    // Frame bruto inteiro sem esperar crédito
+constexpr uint32_t CONN_FLOW_CONTROL_WINDOW = 16 * 1024 * 1024;
+constexpr size_t MAX_PENDING_DATAGRAMS = 256;
+constexpr QUIC_UINT62 FRAME_ABORT_ERROR = 1;                // Stream de frame abortado (frame velho)
+
+}  // namespace
+
+struct QUICTransport::Impl {
+    // Stream de frame: envio (dados até SEND_COMPLETE) ou recebimento (frame em montagem)
+    struct StreamContext {
+        Impl* owner = nullptr;
+        HQUIC stream = nullptr;
+        bool outgoing = false;
+        std::vector<uint8_t> data;
+        QUIC_BUFFER buffer = {};
+        // Sob o mutex: SendFrame abortando fora do lock adia StreamClose/delete para si
+        bool aborting = false;
+        bool shutdownComplete = false;
+        bool appCloseInProgress = false;
+    };
+
+    // Datagrama enviado: o buffer vive até um estado final
+    struct DatagramContext {
+        std::vector<uint8_t> data;
+        QUIC_BUFFER buffer = {};
+    };
+
+    explicit Impl(const QUICTransportConfig& cfg) : config(cfg) {}
+    ~Impl() { Close(); }
+
+    bool Open(bool server);
+    void Close();
+    HQUIC CurrentConnection() const;
+    bool ReadStatistics(QUIC_STATISTICS_V2& outStatistics) const;
+    void RemoveSendStream(StreamContext* context);
+
+    static QUIC_STATUS QUIC_API ListenerCallback(HQUIC listener, void* context, QUIC_LISTENER_EVENT* event);
+    static QUIC_STATUS QUIC_API ConnectionCallback(HQUIC connection, void* context, QUIC_CONNECTION_EVENT* event);
+    static QUIC_STATUS QUIC_API StreamCallback(HQUIC stream, void* context, QUIC_STREAM_EVENT* event);
+
+    QUICTransportConfig config;
+    const QUIC_API_TABLE* api = nullptr;
+    HQUIC registration = nullptr;
+    HQUIC configuration = nullptr;
+    HQUIC listener = nullptr;
+    bool bbr = false;
+    bool server = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable readable;
+    std::condition_variable stateChanged;
+    HQUIC connection = nullptr;                 // Um peer por Initialize/Listen
+    bool connected = false;
+    bool peerVerified = false;                  // Cliente: fingerprint conferido no handshake
+    bool datagramsEnabled = false;
+    uint16_t maxDatagramSize = 0;
+    std::deque<StreamContext*> sendStreams;     // Frames sem ack, mais antigo na frente
+    std::deque<std::vector<uint8_t>> frames;
+    std::deque<std::vector<uint8_t>> datagrams;
+    Stats stats;
+};
+
+bool QUICTransport::Impl::Open(bool isServer) {
+    server = isServer;
+    if (!server && config.peerCertificateSha256.empty()) {
+        std::cerr << "[QUIC] Cliente sem fingerprint do host (sinalizacao): conexao recusada\n";
+        return false;
+    }
+
+    if (QUIC_FAILED(MsQuicOpen2(&api))) {
+        api = nullptr;
+        std::cerr << "[QUIC] MsQuicOpen2 falhou\n";
+        return false;
+    }
+
+    QUIC_REGISTRATION_CONFIG registrationConfig = { "rdc", QUIC_EXECUTION_PROFILE_LOW_LATENCY };
+    if (QUIC_FAILED(api->RegistrationOpen(&registrationConfig, &registration))) {
+        std::cerr << "[QUIC] RegistrationOpen falhou\n";
+        return false;
+    }
+
+    // Janelas grandes o bastante para um frame bruto; o peer abre um stream por frame
+    QUIC_SETTINGS settings{};
+    settings.IdleTimeoutMs = config.idleTimeoutMs;
+    settings.IsSet.IdleTimeoutMs = TRUE;
+    settings.PeerUnidiStreamCount = PEER_UNIDI_STREAMS;
+    settings.IsSet.PeerUnidiStreamCount = TRUE;
+    settings.StreamRecvWindowDefault = STREAM_RECV_WINDOW;
+    settings.IsSet.StreamRecvWindowDefault = TRUE;
+    settings.ConnFlowControlWindow = CONN_FLOW_CONTROL_WINDOW;
+    settings.IsSet.ConnFlowControlWindow = TRUE;
+    settings.DatagramReceiveEnabled = TRUE;
+    settings.IsSet.DatagramReceiveEnabled = TRUE;
+    if (config.useBBR) {
+        settings.CongestionControlAlgorithm = QUIC_CONGESTION_CONTROL_ALGORITHM_BBR;
+        settings.IsSet.CongestionControlAlgorithm = TRUE;
+    }
+
+    QUIC_BUFFER alpn = { static_cast<uint32_t>(config.alpn.size()),
+                         reinterpret_cast<uint8_t*>(config.alpn.data()) };
+    QUIC_STATUS status = api->ConfigurationOpen(registration, &alpn, 1, &settings, sizeof(settings),
+                                                nullptr, &configuration);
+    bbr = config.useBBR;
+    if (QUIC_FAILED(status) && config.useBBR) {
+        // msquic sem BBR: segue com o padrão (Cubic)
+        std::cerr << "[QUIC] BBR indisponivel nesta versao do msquic, usando Cubic\n";
+        settings.IsSet.CongestionControlAlgorithm = FALSE;
+        bbr = false;
+        status = api->ConfigurationOpen(registration, &alpn, 1, &settings, sizeof(settings),
+                                        nullptr, &configuration);
+    }
+    if (QUIC_FAILED(status)) {
+        std::cerr << "[QUIC] ConfigurationOpen falhou\n";
+        return false;
+    }
+
+    // Servidor: certificado em arquivo. Cliente: sem CA, mas recebe o certificado em DER
+    // e confere o fingerprint em PEER_CERTIFICATE_RECEIVED
+    QUIC_CREDENTIAL_CONFIG credential{};
+    QUIC_CERTIFICATE_FILE certificateFile{};
+    if (server) {
+        if (config.certificateFile.empty() || config.privateKeyFile.empty()) {
+            std::cerr << "[QUIC] Servidor requer certificateFile e privateKeyFile\n";
+            return false;
+        }
+        certificateFile.CertificateFile = config.certificateFile.c_str();
+        certificateFile.PrivateKeyFile = config.privateKeyFile.c_str();
+        credential.Type = QUIC_CREDENTIAL_TYPE_CERTIFICATE_FILE;
+        credential.CertificateFile = &certificateFile;
+    } else {
+        credential.Type = QUIC_CREDENTIAL_TYPE_NONE;
+        credential.Flags = static_cast<QUIC_CREDENTIAL_FLAGS>(
+            QUIC_CREDENTIAL_FLAG_CLIENT | QUIC_CREDENTIAL_FLAG_NO_CERTIFICATE_VALIDATION |
+            QUIC_CREDENTIAL_FLAG_INDICATE_CERTIFICATE_RECEIVED | QUIC_CREDENTIAL_FLAG_USE_PORTABLE_CERTIFICATES);
+    }
+    if (QUIC_FAILED(api->ConfigurationLoadCredential(configuration, &credential))) {
+        std::cerr << "[QUIC] ConfigurationLoadCredential falhou\n";
+        return false;
+    }
+    return true;
+}
+
+void QUICTransport::Impl::Close() {
+    if (!api) {
+        return;
+    }
+
+    // Listener primeiro: nenhuma conexão nova chega depois daqui
+    if (listener) {
+        api->ListenerClose(listener);
+        listener = nullptr;
+    }
+
+    HQUIC closing = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = connection;
+        connection = nullptr;
+        connected = false;
+        peerVerified = false;
+    }
+    stateChanged.notify_all();
+
+    // ConnectionClose espera o fim da conexão (streams inclusive)
+    if (closing) {
+        api->ConnectionShutdown(closing, QUIC_CONNECTION_SHUTDOWN_FLAG_NONE, 0);
+        api->ConnectionClose(closing);
+    }
+    if (configuration) {
+        api->ConfigurationClose(configuration);
+        configuration = nullptr;
+    }
+    if (registration) {
+        api->RegistrationClose(registration);
+        registration = nullptr;
+    }
+    MsQuicClose(api);
+    api = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    sendStreams.clear();
+    datagramsEnabled = false;
+}
+
+HQUIC QUICTransport::Impl::CurrentConnection() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return connection;
+}
+
+bool QUICTransport::Impl::ReadStatistics(QUIC_STATISTICS_V2& outStatistics) const {
+    HQUIC current = CurrentConnection();
+    if (!api || !current) {
+        return false;
+    }
+    outStatistics = {};
+    uint32_t size = sizeof(outStatistics);
+    return QUIC_SUCCEEDED(api->GetParam(current, QUIC_PARAM_CONN_STATISTICS_V2, &size, &outStatistics));
+}
+
+void QUICTransport::Impl::RemoveSendStream(StreamContext* context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find(sendStreams.begin(), sendStreams.end(), context);
+    if (it != sendStreams.end()) {
+        sendStreams.erase(it);
+    }
+}
+
+QUIC_STATUS QUIC_API QUICTransport::Impl::ListenerCallback(HQUIC, void* context, QUIC_LISTENER_EVENT* event) {
+    auto* self = static_cast<Impl*>(context);
+    if (event->Type != QUIC_LISTENER_EVENT_NEW_CONNECTION) {
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    // Um peer por Listen: depois de uma queda, Shutdown + Listen de novo
+    HQUIC incoming = event->NEW_CONNECTION.Connection;
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        if (self->connection) {
+            return QUIC_STATUS_CONNECTION_REFUSED;
+        }
+        self->connection = incoming;
+    }
+
+    self->api->SetCallbackHandler(incoming, reinterpret_cast<void*>(&ConnectionCallback), self);
+    QUIC_STATUS status = self->api->ConnectionSetConfiguration(incoming, self->configuration);
+    if (QUIC_FAILED(status)) {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->connection = nullptr;     // Recusada: o msquic fecha o handle
+    }
+    return status;
+}
+
+QUIC_STATUS QUIC_API QUICTransport::Impl::ConnectionCallback(HQUIC handle, void* context, QUIC_CONNECTION_EVENT* event) {
+    auto* self = static_cast<Impl*>(context);
+
+    switch (event->Type) {
+        case QUIC_CONNECTION_EVENT_PEER_CERTIFICATE_RECEIVED: {
+            // Portável: QUIC_BUFFER com o certificado DER do host
+            const auto* certificate = static_cast<const QUIC_BUFFER*>(
+                event->PEER_CERTIFICATE_RECEIVED.Certificate);
+            bool matches = !self->server && certificate &&
+                           CertificateFingerprintMatches(self->config.peerCertificateSha256,
+                                                         certificate->Buffer, certificate->Length);
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->peerVerified = matches;
+            if (!matches) {
+                self->stats.certificatesRejected++;
+                OutputDebugStringA("QUIC: fingerprint do certificado do host nao confere\n");
+                return QUIC_STATUS_BAD_CERTIFICATE;
+            }
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_CONNECTED: {
+            bool verified;
+            {
+                std::lock_guard<std::mutex> lock(self->mutex);
+                // Cliente sem certificado conferido nunca fica conectado
+                verified = self->server || self->peerVerified;
+                self->connected = verified;
+                if (verified) {
+                    self->stateChanged.notify_all();
+                } else {
+                    self->stats.certificatesRejected++;
+                }
+            }
+            if (!verified) {
+                self->api->ConnectionShutdown(handle, QUIC_CONNECTION_SHUTDOWN_FLAG_NONE, 0);
+            }
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_INITIATED_BY_TRANSPORT:
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_INITIATED_BY_PEER:
+        case QUIC_CONNECTION_EVENT_SHUTDOWN_COMPLETE: {
+            // O handle só é fechado em Close()
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->connected = false;
+            self->datagramsEnabled = false;
+            self->stateChanged.notify_all();
+            self->readable.notify_all();
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED: {
+            auto* stream = new StreamContext;
+            stream->owner = self;
+            stream->stream = event->PEER_STREAM_STARTED.Stream;
+            self->api->SetCallbackHandler(stream->stream, reinterpret_cast<void*>(&StreamCallback), stream);
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED: {
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->datagramsEnabled = event->DATAGRAM_STATE_CHANGED.SendEnabled != FALSE;
+            self->maxDatagramSize = event->DATAGRAM_STATE_CHANGED.MaxSendLength;
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED: {
+            const QUIC_BUFFER* buffer = event->DATAGRAM_RECEIVED.Buffer;
+            std::lock_guard<std::mutex> lock(self->mutex);
+            if (self->datagrams.size() >= MAX_PENDING_DATAGRAMS) {
+                self->datagrams.pop_front();
+            }
+            self->datagrams.emplace_back(buffer->Buffer, buffer->Buffer + buffer->Length);
+            self->stats.datagramsReceived++;
+            self->readable.notify_all();
+            break;
+        }
+
+        case QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED: {
+            auto* datagram = static_cast<DatagramContext*>(event->DATAGRAM_SEND_STATE_CHANGED.ClientContext);
+            QUIC_DATAGRAM_SEND_STATE state = event->DATAGRAM_SEND_STATE_CHANGED.State;
+            if (state == QUIC_DATAGRAM_SEND_LOST_DISCARDED) {
+                std::lock_guard<std::mutex> lock(self->mutex);
+                self->stats.datagramsLost++;
+            }
+            if (QUIC_DATAGRAM_SEND_STATE_IS_FINAL(state)) {
+                delete datagram;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+QUIC_STATUS QUIC_API QUICTransport::Impl::StreamCallback(HQUIC stream, void* context, QUIC_STREAM_EVENT* event) {
+    auto* streamContext = static_cast<StreamContext*>(context);
+    Impl* self = streamContext->owner;
+
+    switch (event->Type) {
+        case QUIC_STREAM_EVENT_RECEIVE:
+            // Consumido inteiro: o crédito de fluxo volta na hora
+            for (uint32_t i = 0; i < event->RECEIVE.BufferCount; ++i) {
+                const QUIC_BUFFER& buffer = event->RECEIVE.Buffers[i];
+                streamContext->data.insert(streamContext->data.end(), buffer.Buffer, buffer.Buffer + buffer.Length);
+            }
+            break;
+
+        case QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN: {
+            // FIN: frame completo
+            std::lock_guard<std::mutex> lock(self->mutex);
+            if (self->frames.size() >= std::max<uint32_t>(1, self->config.maxPendingFrames)) {
+                self->frames.pop_front();
+                self->stats.framesDropped++;
+            }
+            self->frames.push_back(std::move(streamContext->data));
+            self->stats.framesReceived++;
+            self->readable.notify_all();
+            break;
+        }
+
+        case QUIC_STREAM_EVENT_PEER_SEND_ABORTED: {
+            streamContext->data.clear();
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->stats.framesDropped++;
+            break;
+        }
+
+        case QUIC_STREAM_EVENT_SEND_COMPLETE:
+            // O msquic já copiou (ou descartou) os dados
+            streamContext->data.clear();
+            streamContext->data.shrink_to_fit();
+            break;
+
+        case QUIC_STREAM_EVENT_SEND_SHUTDOWN_COMPLETE:
+            // Frame entregue (FIN confirmado) ou abortado: deixa de contar em voo
+            if (streamContext->outgoing) {
+                self->RemoveSendStream(streamContext);
+            }
+            break;
+
+        case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE:
+            if (streamContext->outgoing) {
+                self->RemoveSendStream(streamContext);
+                std::lock_guard<std::mutex> lock(self->mutex);
+                streamContext->shutdownComplete = true;
+                streamContext->appCloseInProgress = event->SHUTDOWN_COMPLETE.AppCloseInProgress;
+                if (streamContext->aborting) {
+                    break;  // SendFrame ainda usa o handle; fecha depois do StreamShutdown
+                }
+            }
+            if (!event->SHUTDOWN_COMPLETE.AppCloseInProgress) {
+                self->api->StreamClose(stream);
+            }
+            delete streamContext;
+            break;
+
+        default:
+            break;
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+QUICTransport::QUICTransport() : QUICTransport(QUICTransportConfig{}) {
+}
+
+QUICTransport::QUICTransport(const QUICTransportConfig& config)
+    : m_impl(std::make_unique<Impl>(config)) {
+}
+
+QUICTransport::~QUICTransport() {
+    Shutdown();
+}
+
+bool QUICTransport::IsAvailable() {
+    return true;
+}
+
+bool QUICTransport::Initialize(const std::string& remoteAddr, uint16_t remotePort) {
+    Shutdown();
+    if (!m_impl->Open(false)) {
+        Shutdown();
+        return false;
+    }
+
+    HQUIC connection = nullptr;
+    if (QUIC_FAILED(m_impl->api->ConnectionOpen(m_impl->registration, &Impl::ConnectionCallback,
+                                                m_impl.get(), &connection))) {
+        std::cerr << "[QUIC] ConnectionOpen falhou\n";
+        Shutdown();
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->connection = connection;
+    }
+
+    if (QUIC_FAILED(m_impl->api->ConnectionStart(connection, m_impl->configuration, QUIC_ADDRESS_FAMILY_UNSPEC,
+                                                 remoteAddr.c_str(), remotePort)) ||
+        !WaitConnected(static_cast<int>(m_impl->config.connectTimeoutMs))) {
+        std::cerr << "[QUIC] Conexao com " << remoteAddr << ":" << remotePort << " falhou\n";
+        Shutdown();
+        return false;
+    }
+
+    OutputDebugStringA("QUIC: conectado\n");
+    return true;
+}
+
+bool QUICTransport::Listen(uint16_t port) {
+    Shutdown();
+    if (!m_impl->Open(true)) {
+        Shutdown();
+        return false;
+    }
+
+    if (QUIC_FAILED(m_impl->api->ListenerOpen(m_impl->registration, &Impl::ListenerCallback,
+                                              m_impl.get(), &m_impl->listener))) {
+        std::cerr << "[QUIC] ListenerOpen falhou\n";
+        Shutdown();
+        return false;
+    }
+
+    QUIC_BUFFER alpn = { static_cast<uint32_t>(m_impl->config.alpn.size()),
+                         reinterpret_cast<uint8_t*>(m_impl->config.alpn.data()) };
+    QUIC_ADDR address{};
+    QuicAddrSetFamily(&address, QUIC_ADDRESS_FAMILY_UNSPEC);
+    QuicAddrSetPort(&address, port);
+    if (QUIC_FAILED(m_impl->api->ListenerStart(m_impl->listener, &alpn, 1, &address))) {
+        std::cerr << "[QUIC] ListenerStart falhou na porta " << port << "\n";
+        Shutdown();
+        return false;
+    }
+    return true;
+}
+
+std::string QUICTransport::GetCertificateFingerprint() const {
+    std::string fingerprint;
+    ComputeCertificateFileFingerprint(m_impl->config.certificateFile, fingerprint);
+    return fingerprint;
+}
+
+uint16_t QUICTransport::GetLocalPort() const {
+    if (!m_impl->api || !m_impl->listener) {
+        return 0;
+    }
+    QUIC_ADDR address{};
+    uint32_t size = sizeof(address);
+    if (QUIC_FAILED(m_impl->api->GetParam(m_impl->listener, QUIC_PARAM_LISTENER_LOCAL_ADDRESS, &size, &address))) {
+        return 0;
+    }
+    return QuicAddrGetPort(&address);
+}
+
+bool QUICTransport::WaitConnected(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    return m_impl->stateChanged.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                         [this]() { return m_impl->connected; });
+}
+
+bool QUICTransport::SendFrame(const uint8_t* data, uint32_t size) {
+    if (!data || size == 0 || !m_impl->api) {
+        return false;
+    }
+    HQUIC connection = m_impl->CurrentConnection();
+    if (!connection || !IsConnected()) {
+        return false;
+    }
+
+    auto* stream = new Impl::StreamContext;
+    stream->owner = m_impl.get();
+    stream->outgoing = true;
+    stream->data.assign(data, data + size);
+    stream->buffer = { size, stream->data.data() };
+
+    if (QUIC_FAILED(m_impl->api->StreamOpen(connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL,
+                                            &Impl::StreamCallback, stream, &stream->stream))) {
+        delete stream;
+        return false;
+    }
+
+    // Frames velhos sem ack não disputam banda com o atual. Só escolhe sob o mutex:
+    // StreamShutdown pode chamar o callback do stream na mesma thread, e ele trava o mutex
+    std::vector<Impl::StreamContext*> aborted;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        while (!m_impl->sendStreams.empty() &&
+               m_impl->sendStreams.size() >= std::max<uint32_t>(1, m_impl->config.maxFramesInFlight)) {
+            m_impl->sendStreams.front()->aborting = true;
+            aborted.push_back(m_impl->sendStreams.front());
+            m_impl->sendStreams.pop_front();
+            m_impl->stats.framesAborted++;
+        }
+        m_impl->sendStreams.push_back(stream);
+    }
+    for (Impl::StreamContext* old : aborted) {
+        m_impl->api->StreamShutdown(old->stream, QUIC_STREAM_SHUTDOWN_FLAG_ABORT_SEND, FRAME_ABORT_ERROR);
+        bool release = false;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            old->aborting = false;
+            release = old->shutdownComplete;
+        }
+        // SHUTDOWN_COMPLETE chegou enquanto abortávamos: o fechamento ficou conosco
+        if (release) {
+            if (!old->appCloseInProgress) {
+                m_impl->api->StreamClose(old->stream);
+            }
+            delete old;
+        }
+    }
+
+    // START abre o stream junto com os dados; FIN fecha o frame
+    if (QUIC_FAILED(m_impl->api->StreamSend(stream->stream, &stream->buffer, 1,
+                                            static_cast<QUIC_SEND_FLAGS>(QUIC_SEND_FLAG_START | QUIC_SEND_FLAG_FIN),
+                                            stream))) {
+        m_impl->RemoveSendStream(stream);
+        m_impl->api->StreamClose(stream->stream);
+        delete stream;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->stats.framesSent++;
+    return true;
+}
+
+bool QUICTransport::SendDatagram(const uint8_t* data, uint32_t size) {
+    if (!data || size == 0 || !m_impl->api) {
+        return false;
+    }
+    HQUIC connection = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        if (!m_impl->connected || !m_impl->datagramsEnabled || size > m_impl->maxDatagramSize) {
+            return false;
+        }
+        connection = m_impl->connection;
+    }
+
+    auto* datagram = new Impl::DatagramContext;
+    datagram->data.assign(data, data + size);
+    datagram->buffer = { size, datagram->data.data() };
+    if (QUIC_FAILED(m_impl->api->DatagramSend(connection, &datagram->buffer, 1, QUIC_SEND_FLAG_NONE, datagram))) {
+        delete datagram;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->stats.datagramsSent++;
+    return true;
+}
+
+uint32_t QUICTransport::GetMaxDatagramSize() const {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->datagramsEnabled ? m_impl->maxDatagramSize : 0;
+}
+
+bool QUICTransport::Receive(std::vector<uint8_t>& outData) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->frames.empty()) {
+        return false;
+    }
+    outData = std::move(m_impl->frames.front());
+    m_impl->frames.pop_front();
+    return true;
+}
+
+bool QUICTransport::ReceiveDatagram(std::vector<uint8_t>& outData) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->datagrams.empty()) {
+        return false;
+    }
+    outData = std::move(m_impl->datagrams.front());
+    m_impl->datagrams.pop_front();
+    return true;
+}
+
+bool QUICTransport::WaitReadable(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    return m_impl->readable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+        return !m_impl->frames.empty() || !m_impl->datagrams.empty();
+    });
+}
+
+double QUICTransport::GetLatencyMs() const {
+    QUIC_STATISTICS_V2 statistics;
+    if (!m_impl->ReadStatistics(statistics)) {
+        return 0.0;
+    }
+    return statistics.Rtt / 1000.0;
+}
+
+bool QUICTransport::IsConnected() const {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->connected;
+}
+
+QUICTransport::Stats QUICTransport::GetStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        stats = m_impl->stats;
+    }
+    stats.bbr = m_impl->bbr;
+
+    QUIC_STATISTICS_V2 statistics;
+    if (m_impl->ReadStatistics(statistics)) {
+        stats.smoothedRttMs = statistics.Rtt / 1000.0;
+        stats.minRttMs = statistics.MinRtt / 1000.0;
+        stats.packetsSent = statistics.SendTotalPackets;
+        stats.packetsLost = statistics.SendSuspectedLostPackets;
+        stats.congestionWindow = statistics.SendCongestionWindow;
+    }
+    return stats;
+}
+
+void QUICTransport::Shutdown() {
+    m_impl->Close();
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->frames.clear();
+    m_impl->datagrams.clear();
+}
+
+#else // !RDC_HAVE_MSQUIC
+
+struct QUICTransport::Impl {
+    explicit Impl(const QUICTransportConfig& cfg) : config(cfg) {}
+    QUICTransportConfig config;
+};
+
+namespace {
+
+bool ReportUnavailable() {
+    std::cerr << "[QUIC] Build sem msquic (RDC_WITH_MSQUIC)\n";
+    return false;
+}
+
+}  // namespace
+
+QUICTransport::QUICTransport() : QUICTransport(QUICTransportConfig{}) {
+}
+
+QUICTransport::QUICTransport(const QUICTransportConfig& config)
+    : m_impl(std::make_unique<Impl>(config)) {
+}
+
+QUICTransport::~QUICTransport() = default;
+
+bool QUICTransport::IsAvailable() {
+    return false;
+}
+
+bool QUICTransport::Initialize(const std::string&, uint16_t) {
+    return ReportUnavailable();
+}
+
+bool QUICTransport::Listen(uint16_t) {
+    return ReportUnavailable();
+}
+
+uint16_t QUICTransport::GetLocalPort() const {
+    return 0;
+}
+
+std::string QUICTransport::GetCertificateFingerprint() const {
+    std::string fingerprint;
+    ComputeCertificateFileFingerprint(m_impl->config.certificateFile, fingerprint);
+    return fingerprint;
+}
+
+bool QUICTransport::WaitConnected(int) {
+    return false;
+}
+
+bool QUICTransport::SendFrame(const uint8_t*, uint32_t) {
+    return false;
+}
+
+bool QUICTransport::SendDatagram(const uint8_t*, uint32_t) {
+    return false;
+}
+
+uint32_t QUICTransport::GetMaxDatagramSize() const {
+    return 0;
+}
+
+bool QUICTransport::Receive(std::vector<uint8_t>&) {
+    return false;
+}
+
+bool QUICTransport::ReceiveDatagram(std::vector<uint8_t>&) {
+    return false;
+}
+
+bool QUICTransport::WaitReadable(int) {
+    return false;
+}
+
+double QUICTransport::GetLatencyMs() const {
+    return 0.0;
+}
+
+bool QUICTransport::IsConnected() const {
+    return false;
+}
+
+QUICTransport::Stats QUICTransport::GetStats() const {
+    return Stats{};
+}
+
+void QUICTransport::Shutdown() {
+}
+
+#endif // RDC_HAVE_MSQUIC
@@ -1,7 +1,39 @@
 #include "RemoteDesktopSystem.h"
+#include "Trace.h"
+#include "FrameUtils.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Classificação de conteúdo a cada N frames (~5 ms em 1080p)
+constexpr uint16_t CONTENT_CLASSIFY_INTERVAL = 4;
+
+// Downscale incremental: tiles da captura comparados com a que gerou o último frame
+// escalado; acima de 1/4 dos tiles alterados o frame inteiro sai mais barato
+constexpr uint32_t SCALE_TILE_SIZE = 64;
+constexpr uint32_t SCALE_REGION_MAX_FRACTION = 4;
+
+// Cursor: no máximo uma posição a cada 4 ms (~250 Hz); pedido de forma repetido a cada 100 ms
+constexpr auto CURSOR_SEND_INTERVAL = std::chrono::milliseconds(4);
+constexpr auto CURSOR_SHAPE_REQUEST_INTERVAL = std::chrono::milliseconds(100);
+
+// Token de retomada reenviado a cada segundo (UDP: o primeiro pode se perder)
+constexpr auto SESSION_TOKEN_INTERVAL = std::chrono::seconds(1);
+
+// Watermarks da fila de envio para o ABR (os mesmos do vídeo no rdc_dcloop)
+constexpr size_t SEND_BUFFER_LOW_WATERMARK = 32 * 1024;
+constexpr size_t SEND_BUFFER_HIGH_WATERMARK = 128 * 1024;
+
+uint64_t SteadyNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
 
 RemoteDesktopSystem::RemoteDesktopSystem() {
 }
@@ -33,6 +65,38 @@ bool RemoteDesktopSystem::InitializeLoopback(uint32_t width, uint32_t height) {
 
 bool RemoteDesktopSystem::InitializeAsServer(uint16_t networkPort, 
                                               uint32_t targetBitrateMbps) {
+    // Fase 2: Network
+    m_network = std::make_unique<P2PManager>();
+    if (!m_network->InitializeAsServer(networkPort)) {
+        std::cerr << "ERROR: Failed to initialize network server\n";
+        return false;
+    }
+
+    return InitializeServerPipeline(targetBitrateMbps);
+}
+
+bool RemoteDesktopSystem::InitializeAsHost(const std::string& signalingUrl,
+                                            uint32_t targetBitrateMbps) {
+    // Sinalização, coleta de candidatos e socket LAN começam antes do pipeline:
+    // DXGI/NVENC inicializam enquanto o guest ainda está entrando
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::HOST;
+    config.signalingUrl = signalingUrl;
+    config.timeoutMs = 0;   // Espera o guest sem limite
+    if (!connector.Start(config)) {
+        std::cerr << "ERROR: Invalid signaling URL: " << signalingUrl << "\n";
+        return false;
+    }
+
+    if (!InitializeServerPipeline(targetBitrateMbps)) {
+        return false;
+    }
+
+    return WaitForSession(connector);
+}
+
+bool RemoteDesktopSystem::InitializeServerPipeline(uint32_t targetBitrateMbps) {
     m_mode = Mode::SERVER;
 
     // Fase 1: Captura
@@ -42,33 +106,38 @@ bool RemoteDesktopSystem::InitializeAsServer(uint16_t networkPort,
         return false;
     }
 
-    // Fase 2: Network
-    m_network = std::make_unique<P2PManager>();
-    if (!m_network->InitializeAsServer(networkPort)) {
-        std::cerr << "ERROR: Failed to initialize network server\n";
-        return false;
-    }
-
     // Fase 3: Encoding (opcional)
     if (m_useEncoding) {
         m_encoder = std::make_unique<NVENCEncoder>();
         if (!m_encoder->Initialize(m_capturer->GetScreenWidth(),
                                    m_capturer->GetScreenHeight(),
-                                   targetBitrateMbps)) {
+                                   targetBitrateMbps * 1000)) {
             std::cerr << "WARNING: NVENC encoder not available\n";
             m_useEncoding = false;
         }
+        m_encodeWidth = m_capturer->GetScreenWidth();
+        m_encodeHeight = m_capturer->GetScreenHeight();
+        m_encodeBitrateKbps = targetBitrateMbps * 1000;
+
+        if (m_useEncoding && m_useContentClassification) {
+            m_contentClassifier = std::make_unique<ContentClassifier>();
+        }
     }
 
     // Fase 4: Input (para receber input remoto)
     if (m_inputEnabled) {
         m_inputInjector = std::make_unique<InputInjector>();
-        if (!m_inputInjector->Initialize()) {
+        if (m_inputInjector->Initialize()) {
+            m_remoteInput = std::make_unique<RemoteInputHandler>(*m_inputInjector);
+        } else {
             std::cerr << "WARNING: Input injector failed\n";
             m_inputEnabled = false;
         }
     }
 
+    // Retomada: cliente que cair volta sem renegociar, com frame incremental
+    m_resumeHost = std::make_unique<SessionResumeHost>();
+
     // Fase 5: Multi-threading (opcional)
     if (m_useMultiThreading) {
         m_threadedCapture = std::make_unique<MultiThreadedCapture>();
@@ -79,6 +148,8 @@ bool RemoteDesktopSystem::InitializeAsServer(uint16_t networkPort,
 
         m_abrController = std::make_unique<AdaptiveBitRateController>(5, 100);
         m_abrController->SetAdaptationMode(m_abrMode);
+        m_abrController->SetLadder(AdaptiveBitRateController::BuildDefaultLadder(
+            m_capturer->GetScreenWidth(), m_capturer->GetScreenHeight()));
     }
 
     std::cout << "Server mode initialized\n";
@@ -87,8 +158,6 @@ bool RemoteDesktopSystem::InitializeAsServer(uint16_t networkPort,
 
 bool RemoteDesktopSystem::InitializeAsClient(const std::string& serverIP,
                                               uint16_t networkPort) {
-    m_mode = Mode::CLIENT;
-
     // Fase 2: Network
     m_network = std::make_unique<P2PManager>();
     if (!m_network->InitializeAsClient(serverIP, networkPort)) {
@@ -96,6 +165,56 @@ bool RemoteDesktopSystem::InitializeAsClient(const std::string& serverIP,
         return false;
     }
 
+    return InitializeClientPipeline();
+}
+
+bool RemoteDesktopSystem::InitializeAsGuest(const std::string& signalingUrl,
+                                             const std::string& sessionId) {
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::GUEST;
+    config.signalingUrl = signalingUrl;
+    config.sessionId = sessionId;
+    if (!connector.Start(config)) {
+        std::cerr << "ERROR: Invalid signaling URL: " << signalingUrl << "\n";
+        return false;
+    }
+
+    // Janela e render sobem enquanto os caminhos correm
+    if (!InitializeClientPipeline()) {
+        return false;
+    }
+
+    return WaitForSession(connector);
+}
+
+bool RemoteDesktopSystem::WaitForSession(SessionConnector& connector) {
+    bool sessionPrinted = false;
+    SessionConnector::State state;
+    while ((state = connector.Poll()) == SessionConnector::State::CONNECTING) {
+        if (!sessionPrinted && m_mode == Mode::SERVER && connector.GetTimings().registeredMs >= 0.0) {
+            std::cout << "Session ID: " << connector.GetSessionId()
+                      << " (guest: remote_desktop_app join " << connector.GetSessionId() << ")\n";
+            sessionPrinted = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    if (state != SessionConnector::State::CONNECTED) {
+        std::cerr << "ERROR: Could not connect to remote peer\n";
+        return false;
+    }
+
+    m_network = connector.TakeTransport();
+    SessionConnector::Timings timings = connector.GetTimings();
+    std::cout << "Connected via " << connector.GetWinnerName() << " in "
+              << static_cast<int>(timings.connectedMs) << " ms\n";
+    return m_network != nullptr;
+}
+
+bool RemoteDesktopSystem::InitializeClientPipeline() {
+    m_mode = Mode::CLIENT;
+
     // Fase 1: Renderer
     m_renderer = std::make_unique<Renderer>();
     if (!m_renderer->Initialize(1920, 1080, "Remote Desktop - Client")) {
@@ -104,14 +223,14 @@ bool RemoteDesktopSystem::InitializeAsClient(const std::string& serverIP,
     }
 
     // Fase 4: Input (para enviar input remoto)
-    if (m_inputEnabled) {
-        m_inputInjector = std::make_unique<InputInjector>();
-        if (!m_inputInjector->Initialize()) {
-            std::cerr << "WARNING: Input injector failed\n";
-            m_inputEnabled = false;
-        }
+    m_renderer->SetInputCapture(m_inputEnabled);
+
+    if (m_useLatencyProbe) {
+        m_latencyProbeClient = std::make_unique<LatencyProbeClient>(m_latencyProbeMode, m_latencyProbeKey);
     }
 
+    m_resumeClient = std::make_unique<SessionResumeClient>();
+
     // Fase 5: Multi-threading (opcional)
     if (m_useMultiThreading) {
         m_threadedRenderer = std::make_unique<MultiThreadedRenderer>();
@@ -141,6 +260,18 @@ void RemoteDesktopSystem::Run() {
     std::cout << "Input: " << (m_inputEnabled ? "ON" : "OFF") << "\n";
     std::cout << "=========================================\n\n";
 
+    if (!m_traceOutputPath.empty()) {
+        PipelineTracer::SetEnabled(true);
+    }
+
+    if (m_metricsPort != 0) {
+        m_metricsExporter = std::make_unique<MetricsExporter>();
+        if (!m_metricsExporter->Start(m_metricsPort, m_metricsBindAddress)) {
+            std::cerr << "WARNING: Metrics endpoint failed to start\n";
+            m_metricsExporter.reset();
+        }
+    }
+
     switch (m_mode) {
     case Mode::LOOPBACK:
         MainLoopLoopback();
@@ -153,15 +284,32 @@ void RemoteDesktopSystem::Run() {
         break;
     }
 
+    if (!m_traceOutputPath.empty()) {
+        DumpTrace(m_traceOutputPath);
+    }
+
     PrintStats();
 }
 
+bool RemoteDesktopSystem::DumpTrace(const std::string& path) const {
+    if (!PipelineTracer::WriteTrace(path)) {
+        std::cerr << "ERROR: Failed to write trace to " << path << "\n";
+        return false;
+    }
+
+    std::cout << "Trace written to " << path << "\n";
+    return true;
+}
+
 void RemoteDesktopSystem::MainLoopLoopback() {
+    RDC_TRACE_THREAD_NAME("MainLoopLoopback");
+
     auto startTime = std::chrono::high_resolution_clock::now();
     FrameData frameData;
     uint16_t frameSequence = 0;
 
     while (m_isRunning && m_renderer && m_renderer->IsRunning()) {
+        RDC_TRACE_SCOPE("MainLoopLoopback");
         auto loopStart = std::chrono::high_resolution_clock::now();
 
         // Processar eventos
@@ -191,6 +339,7 @@ void RemoteDesktopSystem::MainLoopLoopback() {
 
         m_stats.totalFramesProcessed++;
         frameSequence++;
+        PublishMetrics();
 
         // Atualizar estatísticas
         auto loopEnd = std::chrono::high_resolution_clock::now();
@@ -211,32 +360,68 @@ void RemoteDesktopSystem::MainLoopLoopback() {
 }
 
 void RemoteDesktopSystem::MainLoopServer() {
+    RDC_TRACE_THREAD_NAME("MainLoopServer");
     std::cout << "Server running. Press Ctrl+C to stop.\n";
 
     FrameData frameData;
     uint16_t frameSequence = 0;
 
     while (m_isRunning) {
+        RDC_TRACE_SCOPE("MainLoopServer");
+        UpdateTransportMetrics();
+        PublishMetrics();
+
+        // Input e cursor não esperam o fps do vídeo
+        ProcessHostMessages();
+        SendCursorUpdates();
+
+        // Limitar a captura ao fps do degrau do ABR / do conteúdo
+        if (std::chrono::steady_clock::now() < m_nextCaptureTime) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
         // Capturar frame
-        if (!m_capturer->AcquireFrame(frameData) || !frameData.hasChanged) {
+        bool captured = m_capturer->AcquireFrame(frameData);
+
+        // Probe de latência ou retomada pendente precisa de um frame mesmo com a tela parada
+        bool probeFrame = ((m_latencyProbeHost && m_latencyProbeHost->NeedsFrame()) ||
+                           (m_resumeHost && m_resumeHost->NeedsResumeFrame())) &&
+                          !frameData.pixels.empty();
+        if (!captured || (!frameData.hasChanged && !probeFrame)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
 
+        if (m_latencyProbeHost) {
+            m_latencyProbeHost->StampFrame(frameData.pixels.data(), frameData.width, frameData.height,
+                                           frameData.stride, frameData.hasChanged, SteadyNowUs());
+        }
+
+        const FrameData& outFrame = ApplyOperatingPoint(frameData);
+
+        // Qualidade por região: o fps sugerido limita a captura; o mapa só vale para
+        // encoders com QP map (o NVENC daqui ainda não abre sessão e o ignora)
+        if (m_contentClassifier && m_encoder && frameSequence % CONTENT_CLASSIFY_INTERVAL == 0) {
+            const ContentMap& contentMap = m_contentClassifier->Classify(
+                outFrame.pixels.data(), outFrame.width, outFrame.height, outFrame.stride);
+            m_encoder->SetContentMap(contentMap);
+            m_contentFpsCap = contentMap.suggestedFps;
+        }
+
         // Codificar (opcional)
         if (m_useEncoding && m_encoder) {
             EncodedFrame encoded;
-            m_encoder->EncodeFrame(frameData.pixels.data(), frameData.width,
-                                  frameData.height, frameData.stride, encoded);
+            m_encoder->EncodeFrame(outFrame.pixels.data(), outFrame.width,
+                                  outFrame.height, outFrame.stride, encoded);
             m_stats.totalBytesSent += encoded.data.size();
-            m_stats.compressionRatio = (frameData.stride * frameData.height) / 
+            m_stats.compressionRatio = (outFrame.stride * outFrame.height) / 
                                        std::max(1UL, encoded.data.size());
         }
 
         // Enviar via rede (opcional)
         if (m_useNetworking && m_network) {
-            m_network->SendFrame(frameData.pixels.data(), frameData.width,
-                                frameData.height, frameData.stride, frameSequence);
+            SendNetworkFrame(outFrame, frameSequence);
         }
 
         m_stats.totalFramesProcessed++;
@@ -250,32 +435,76 @@ void RemoteDesktopSystem::MainLoopServer() {
 }
 
 void RemoteDesktopSystem::MainLoopClient() {
+    RDC_TRACE_THREAD_NAME("MainLoopClient");
     std::cout << "Client connected. Press ESC to disconnect.\n";
 
     std::vector<uint8_t> pixelData;
     uint32_t width, height, stride;
     uint16_t frameSequence;
+    bool sessionLostReported = false;
 
     while (m_isRunning && m_renderer && m_renderer->IsRunning()) {
+        RDC_TRACE_SCOPE("MainLoopClient");
+
         // Processar eventos
         if (!m_renderer->ProcessEvents()) {
             break;
         }
 
+        UpdateTransportMetrics();
+        PublishMetrics();
+        SendInputEvents();
+
+        // Cursor primeiro: sem frame novo, só o cursor é redesenhado (vsync limita a taxa)
+        bool cursorChanged = ProcessCursorMessages();
+        ServiceSessionResume();
+        if (m_resumeClient && m_resumeClient->HasGivenUp() && !sessionLostReported) {
+            std::cerr << "WARNING: Session could not be resumed (host restarted or grace period expired)\n";
+            sessionLostReported = true;
+        }
+
         // Receber frame
         if (!m_network->ReceiveFrame(pixelData, width, height, stride, frameSequence)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (cursorChanged) {
+                m_renderer->RenderFrame();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
             continue;
         }
 
+        m_stats.totalFramesProcessed++;
+        m_stats.totalBytesReceived += pixelData.size();
+
+        // Frame de retomada: só os tiles que mudaram, aplicados sobre o último frame
+        const std::vector<uint8_t>* frame = &pixelData;
+        if (m_network->GetLastFrameFlags() & FRAME_FLAG_TILE_DELTA) {
+            if (!m_resumeClient || !m_resumeClient->ApplyDelta(pixelData.data(), pixelData.size(),
+                                                               width, height, stride, frameSequence)) {
+                continue; // Base diferente: frame completo pedido no próximo ServiceSessionResume
+            }
+            frame = &m_resumeClient->GetReference();
+        }
+
         // Renderizar
-        if (!pixelData.empty()) {
-            m_renderer->UpdateFrame(pixelData.data(), width, height, stride);
+        if (!frame->empty()) {
+            m_renderer->UpdateFrame(frame->data(), width, height, stride);
             m_renderer->RenderFrame();
-        }
 
-        m_stats.totalFramesProcessed++;
-        m_stats.totalBytesReceived += pixelData.size();
+            // RenderFrame retorna após o present (vsync): momento mais próximo da foto
+            uint64_t presentUs = SteadyNowUs();
+            if (m_latencyProbeClient) {
+                m_latencyProbeClient->OnFramePresented(frame->data(), width, height, stride, presentUs);
+            }
+
+            if (m_resumeClient) {
+                m_resumeClient->OnFramePresented(presentUs);
+                if (frame == &pixelData) {
+                    // Troca de buffers: pixelData recebe o vetor antigo da referência
+                    m_resumeClient->KeepReference(pixelData, width, height, stride, frameSequence);
+                }
+            }
+        }
 
         if (m_stats.totalFramesProcessed % 60 == 0) {
             m_stats.averageFPS = 60.0; // Aproximado
@@ -287,9 +516,476 @@ void RemoteDesktopSystem::MainLoopClient() {
     }
 }
 
+const FrameData& RemoteDesktopSystem::ApplyOperatingPoint(const FrameData& frame) {
+    // Sem ABR: fps cheio, resolução da captura e bitrate inicial
+    OperatingPoint point;
+    if (m_abrController) {
+        point = m_abrController->GetOperatingPoint();
+    } else {
+        point.bitrateKbps = m_encodeBitrateKbps;
+    }
+
+    // Próxima captura permitida pelo fps do degrau (tela dominada por texto pede menos)
+    uint32_t fps = std::max(1u, std::min(point.fps, m_contentFpsCap));
+    auto interval = std::chrono::microseconds(1000000 / fps);
+    m_nextCaptureTime = std::max(m_nextCaptureTime + interval, std::chrono::steady_clock::now());
+
+    uint32_t width = point.width ? std::min(point.width, frame.width) : frame.width;
+    uint32_t height = point.height ? std::min(point.height, frame.height) : frame.height;
+
+    // Resolução mudou: reconfigurar o encoder (próximo frame sai como keyframe).
+    // O bitrate vai em kbps, nos passos de 50 kbps do ABR
+    if (m_useEncoding && m_encoder) {
+        if (width != m_encodeWidth || height != m_encodeHeight) {
+            m_encoder->Release();
+            if (!m_encoder->Initialize(width, height, point.bitrateKbps)) {
+                std::cerr << "WARNING: Encoder re-init failed at " << width << "x" << height << "\n";
+                m_useEncoding = false;
+            }
+            m_encodeWidth = width;
+            m_encodeHeight = height;
+            m_encodeBitrateKbps = point.bitrateKbps;
+        } else if (point.bitrateKbps != m_encodeBitrateKbps) {
+            m_encoder->SetTargetBitrate(point.bitrateKbps);
+            m_encodeBitrateKbps = point.bitrateKbps;
+        }
+    }
+
+    if (width == frame.width && height == frame.height) {
+        return frame;
+    }
+
+    // Downscale para a resolução do degrau (box 2:1 ou bilinear, SSE2)
+    if (m_scaler.GetSourceWidth() != frame.width || m_scaler.GetSourceHeight() != frame.height ||
+        m_scaler.GetDestWidth() != width || m_scaler.GetDestHeight() != height) {
+        if (!m_scaler.Configure(frame.width, frame.height, width, height)) {
+            return frame;
+        }
+        m_scaleReference.clear();
+    }
+
+    m_scaledFrame.width = width;
+    m_scaledFrame.height = height;
+    m_scaledFrame.stride = width * 4;
+    m_scaledFrame.hasChanged = frame.hasChanged;
+    m_scaledFrame.pixels.resize(static_cast<size_t>(m_scaledFrame.stride) * height);
+
+    // Mesma escala do frame anterior: reescala só o destino dos tiles alterados
+    // (MapSourceRect inclui a vizinhança do filtro)
+    const size_t frameBytes = static_cast<size_t>(frame.stride) * frame.height;
+    const uint32_t tilesX = (frame.width + SCALE_TILE_SIZE - 1) / SCALE_TILE_SIZE;
+    const uint32_t tilesY = (frame.height + SCALE_TILE_SIZE - 1) / SCALE_TILE_SIZE;
+    if (m_scaleReference.size() == frameBytes && frame.pixels.size() >= frameBytes) {
+        uint32_t dirtyCount = DiffFrameTiles(m_scaleReference.data(), frame.pixels.data(), frame.width,
+                                             frame.height, frame.stride, SCALE_TILE_SIZE, m_scaleDirtyTiles);
+        if (dirtyCount * SCALE_REGION_MAX_FRACTION <= tilesX * tilesY) {
+            for (uint32_t ty = 0; ty < tilesY; ++ty) {
+                for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                    if (!m_scaleDirtyTiles[ty * tilesX + tx]) {
+                        continue;
+                    }
+                    FrameRect tile;
+                    tile.x = tx * SCALE_TILE_SIZE;
+                    tile.y = ty * SCALE_TILE_SIZE;
+                    tile.width = std::min(SCALE_TILE_SIZE, frame.width - tile.x);
+                    tile.height = std::min(SCALE_TILE_SIZE, frame.height - tile.y);
+                    m_scaler.ScaleRegion(frame.pixels.data(), frame.stride, m_scaledFrame.pixels.data(),
+                                         m_scaledFrame.stride, m_scaler.MapSourceRect(tile));
+
+                    const size_t offset = static_cast<size_t>(tile.y) * frame.stride + tile.x * 4;
+                    CopyFrameRows(m_scaleReference.data() + offset, frame.stride, frame.pixels.data() + offset,
+                                  frame.stride, static_cast<size_t>(tile.width) * 4, tile.height);
+                }
+            }
+            return m_scaledFrame;
+        }
+    }
+
+    m_scaler.Scale(frame.pixels.data(), frame.stride, m_scaledFrame.pixels.data(), m_scaledFrame.stride);
+    m_scaleReference.assign(frame.pixels.begin(), frame.pixels.begin() + frameBytes);
+    return m_scaledFrame;
+}
+
+void RemoteDesktopSystem::SendCursorUpdates() {
+    if (!m_useNetworking || !m_network || !m_network->IsConnected()) {
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+
+    m_capturer->PollCursorPosition();
+    const DXGICapturer::CursorState& cursor = m_capturer->GetCursorState();
+
+    // Forma nova: vai uma vez, antes da posição que a referencia. Comparada com a
+    // última forma enviada, não com a última posição (que espera o intervalo de envio)
+    if (cursor.shapeHash != 0 && cursor.shapeHash != m_lastSentShapeHash) {
+        const CursorShape& shape = m_capturer->GetCursorShape();
+        m_cursorShapes.Put(shape);
+        SerializeCursorShape(shape, payload);
+        if (m_network->SendControlMessage(PacketType::CURSOR_SHAPE, payload.data(), payload.size())) {
+            m_lastSentShapeHash = cursor.shapeHash;
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    bool changed = cursor.x != m_lastCursor.x || cursor.y != m_lastCursor.y ||
+                   cursor.visible != (m_lastCursor.visible != 0) ||
+                   cursor.shapeHash != m_lastCursor.shapeHash;
+    if (!changed || now - m_lastCursorSend < CURSOR_SEND_INTERVAL) {
+        return;
+    }
+
+    CursorPositionMessage message{};
+    message.x = cursor.x;
+    message.y = cursor.y;
+    message.shapeHash = cursor.shapeHash;
+    message.sourceWidth = static_cast<uint16_t>(m_capturer->GetScreenWidth());
+    message.sourceHeight = static_cast<uint16_t>(m_capturer->GetScreenHeight());
+    message.visible = cursor.visible ? 1 : 0;
+
+    if (m_network->SendControlMessage(PacketType::CURSOR_POSITION,
+                                      reinterpret_cast<const uint8_t*>(&message), sizeof(message))) {
+        m_lastCursor = message;
+        m_lastCursorSend = now;
+    }
+}
+
+void RemoteDesktopSystem::ProcessHostMessages() {
+    if (!m_useNetworking || !m_network || !m_network->IsConnected()) {
+        return;
+    }
+
+    uint64_t nowMs = SteadyNowUs() / 1000;
+    if (m_resumeHost) {
+        // Antes de ler: um SESSION_RESUME zera o tempo ocioso do transporte
+        m_resumeHost->UpdatePeerActivity(m_network->GetIdleMs(), nowMs);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastTokenSend >= SESSION_TOKEN_INTERVAL) {
+            SessionTokenMessage token;
+            m_resumeHost->FillTokenMessage(token);
+            m_network->SendControlMessage(PacketType::SESSION_TOKEN,
+                                          reinterpret_cast<const uint8_t*>(&token), sizeof(token));
+            m_lastTokenSend = now;
+        }
+    }
+
+    PacketType type;
+    std::vector<uint8_t> payload;
+
+    while (m_network->ReceiveControlMessage(type, payload)) {
+        if (type == PacketType::SESSION_RESUME && payload.size() == sizeof(SessionResumeMessage)) {
+            if (!m_resumeHost) {
+                continue;
+            }
+
+            SessionResumeMessage resume;
+            std::memcpy(&resume, payload.data(), sizeof(resume));
+            SessionResumeAckMessage ack;
+            if (m_resumeHost->HandleResume(resume, nowMs, ack) == ResumeStatus::ACCEPTED) {
+                // Cliente pode ter voltado por outro endereço (rede trocada)
+                m_network->AcceptResumedPeer();
+                if (m_remoteInput) {
+                    m_remoteInput->Reset();
+                }
+                m_inputPeerGeneration = m_network->GetPeerGeneration();
+            }
+            m_network->SendControlMessage(PacketType::SESSION_RESUME_ACK,
+                                          reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+        } else if (type == PacketType::INPUT_BATCH) {
+            if (m_remoteInput) {
+                // Outro endereço: cliente novo/reiniciado, com sequência de input do 0
+                if (m_network->GetPeerGeneration() != m_inputPeerGeneration) {
+                    m_remoteInput->Reset();
+                    m_inputPeerGeneration = m_network->GetPeerGeneration();
+                }
+                m_remoteInput->HandleBatch(payload.data(), payload.size());
+            }
+        } else if (type == PacketType::LATENCY_PROBE && payload.size() == sizeof(LatencyProbeMessage)) {
+            LatencyProbeMessage probe;
+            std::memcpy(&probe, payload.data(), sizeof(probe));
+
+            // Input marcado: tecla injetada antes de armar o marcador
+            if (probe.virtualKey != 0 && m_remoteInput) {
+                m_remoteInput->InjectKeyTap(probe.virtualKey, SteadyNowUs());
+            }
+
+            if (!m_latencyProbeHost) {
+                m_latencyProbeHost = std::make_unique<LatencyProbeHost>();
+            }
+            m_latencyProbeHost->OnProbe(probe, SteadyNowUs());
+        } else if (type == PacketType::CURSOR_SHAPE_REQUEST && payload.size() == sizeof(uint64_t)) {
+            // Cache do cliente perdido ou forma perdida na rede
+            uint64_t hash;
+            std::memcpy(&hash, payload.data(), sizeof(hash));
+            if (const CursorShape* shape = m_cursorShapes.Find(hash)) {
+                SerializeCursorShape(*shape, payload);
+                m_network->SendControlMessage(PacketType::CURSOR_SHAPE, payload.data(), payload.size());
+            }
+        }
+    }
+}
+
+void RemoteDesktopSystem::SendInputEvents() {
+    LatencyProbeMessage probe;
+    if (m_latencyProbeClient && m_latencyProbeClient->ShouldSend(SteadyNowUs(), probe)) {
+        m_network->SendControlMessage(PacketType::LATENCY_PROBE,
+                                      reinterpret_cast<const uint8_t*>(&probe), sizeof(probe));
+    }
+
+    if (!m_inputEnabled) {
+        return;
+    }
+
+    m_renderer->TakeInputEvents(m_inputEvents);
+    for (const InputEvent& event : m_inputEvents) {
+        m_inputBatcher.Push(event);
+    }
+
+    uint64_t nowUs = SteadyNowUs();
+
+    while (m_inputBatcher.ShouldFlush(nowUs) && m_inputBatcher.Flush(m_inputPayload, nowUs)) {
+        m_network->SendControlMessage(PacketType::INPUT_BATCH, m_inputPayload.data(), m_inputPayload.size());
+    }
+}
+
+bool RemoteDesktopSystem::ProcessCursorMessages() {
+    PacketType type;
+    std::vector<uint8_t> payload;
+    bool changed = false;
+
+    while (m_network->ReceiveControlMessage(type, payload)) {
+        if (type == PacketType::SESSION_TOKEN) {
+            if (m_resumeClient) {
+                m_resumeClient->OnToken(payload.data(), payload.size());
+            }
+        } else if (type == PacketType::SESSION_RESUME_ACK) {
+            if (m_resumeClient) {
+                m_resumeClient->OnResumeAck(payload.data(), payload.size());
+            }
+        } else if (type == PacketType::CURSOR_SHAPE) {
+            CursorShape shape;
+            if (!DeserializeCursorShape(payload.data(), payload.size(), shape)) {
+                continue;
+            }
+            m_cursorShapes.Put(shape);
+
+            if (shape.hash == m_lastCursor.shapeHash) {
+                m_renderer->SetCursorShape(shape);
+                m_pendingCursorShape = 0;
+                changed = true;
+            }
+        } else if (type == PacketType::CURSOR_POSITION) {
+            CursorPositionMessage message;
+            if (!DeserializeCursorPosition(payload.data(), payload.size(), message)) {
+                continue;
+            }
+
+            if (message.shapeHash != m_lastCursor.shapeHash && message.shapeHash != 0) {
+                if (const CursorShape* shape = m_cursorShapes.Find(message.shapeHash)) {
+                    m_renderer->SetCursorShape(*shape);
+                    m_pendingCursorShape = 0;
+                } else {
+                    m_pendingCursorShape = message.shapeHash;
+                }
+            }
+
+            m_renderer->SetCursorPosition(message.x, message.y, message.visible != 0,
+                                          message.sourceWidth, message.sourceHeight);
+            m_lastCursor = message;
+            changed = true;
+        }
+    }
+
+    // Forma desconhecida: pedir ao host (repetido enquanto não chegar)
+    auto now = std::chrono::steady_clock::now();
+    if (m_pendingCursorShape != 0 && now - m_lastShapeRequest >= CURSOR_SHAPE_REQUEST_INTERVAL) {
+        m_network->SendControlMessage(PacketType::CURSOR_SHAPE_REQUEST,
+                                      reinterpret_cast<const uint8_t*>(&m_pendingCursorShape),
+                                      sizeof(m_pendingCursorShape));
+        m_lastShapeRequest = now;
+    }
+
+    return changed;
+}
+
+void RemoteDesktopSystem::SendNetworkFrame(const FrameData& frame, uint16_t frameSequence) {
+    bool sent = false;
+    if (m_resumeHost && m_resumeHost->NeedsResumeFrame()) {
+        if (m_resumeHost->BuildResumeDelta(frame.pixels.data(), frame.width, frame.height, frame.stride,
+                                           m_resumePayload)) {
+            sent = m_network->SendFrameDelta(m_resumePayload.data(), m_resumePayload.size(),
+                                             frame.width, frame.height, frame.stride, frameSequence);
+        } else {
+            m_resumeHost->OnFullResumeFrame(static_cast<size_t>(frame.stride) * frame.height);
+        }
+    }
+
+    if (!sent) {
+        m_network->SendFrame(frame.pixels.data(), frame.width, frame.height, frame.stride, frameSequence);
+    }
+
+    if (m_resumeHost) {
+        m_resumeHost->OnFrameSent(frame.pixels.data(), frame.width, frame.height, frame.stride, frameSequence);
+    }
+}
+
+void RemoteDesktopSystem::ServiceSessionResume() {
+    if (!m_resumeClient || !m_network) {
+        return;
+    }
+
+    SessionResumeMessage resume;
+    bool reopenSocket = false;
+    if (!m_resumeClient->Service(SteadyNowUs(), m_network->GetIdleMs(), resume, reopenSocket)) {
+        return;
+    }
+
+    // Socket novo para o mesmo host: a rede pode ter trocado durante a queda
+    if (reopenSocket && !m_network->ReopenSocket()) {
+        std::cerr << "WARNING: Could not reopen socket for session resume\n";
+        return;
+    }
+
+    m_network->SendControlMessage(PacketType::SESSION_RESUME,
+                                  reinterpret_cast<const uint8_t*>(&resume), sizeof(resume));
+}
+
+void RemoteDesktopSystem::UpdateTransportMetrics() {
+    if (!m_useNetworking || !m_network || !m_network->IsConnected()) {
+        return;
+    }
+
+    m_network->ServiceTransportStats();
+
+    // Fila de envio a cada iteração: acima do watermark alto o ABR reduz sem esperar
+    // a próxima janela de RTT/perda
+    if (m_abrController) {
+        m_abrController->UpdateSendBuffer(m_network->GetSendBufferedBytes(),
+                                          SEND_BUFFER_LOW_WATERMARK, SEND_BUFFER_HIGH_WATERMARK);
+    }
+
+    // Chegada de cada frame no cliente (FRAME_FEEDBACK): gradiente de atraso, atraso
+    // de fila e goodput do modo MODEL_BASED
+    if (m_abrController) {
+        m_network->TakeFrameFeedback(m_frameFeedback);
+        for (const FrameFeedback& feedback : m_frameFeedback) {
+            m_abrController->OnPacketFeedback(feedback.sendTimeMs, feedback.arrivalTimeMs, feedback.bytes);
+        }
+    }
+
+    // Uma atualização do ABR por janela de medição (não por iteração do loop)
+    TransportStats transport = m_network->GetTransportStats();
+    if (m_abrController && transport.sampleCount != m_lastTransportSample) {
+        m_lastTransportSample = transport.sampleCount;
+        m_abrController->UpdateTransportStats(transport);
+    }
+}
+
+void RemoteDesktopSystem::PublishMetrics() {
+    if (!m_metricsExporter) {
+        return;
+    }
+
+    // Publicar no máximo 4x por segundo; o scrape lê sempre o último snapshot
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastMetricsPublish < std::chrono::milliseconds(250)) {
+        return;
+    }
+    m_lastMetricsPublish = now;
+
+    MetricsSnapshot snapshot;
+    snapshot.framesProcessed = m_stats.totalFramesProcessed;
+    snapshot.averageFrameTimeMs = m_stats.averageFrameTimeMs;
+    snapshot.averageFPS = m_stats.averageFPS;
+    snapshot.totalLatencyMs = m_stats.totalLatencyMs;
+    snapshot.captureTimeMs = m_stats.captureTimeMs;
+    snapshot.encodeTimeMs = m_stats.encodeTimeMs;
+    snapshot.networkTimeMs = m_stats.networkTimeMs;
+    snapshot.renderTimeMs = m_stats.renderTimeMs;
+    snapshot.systemBytesSent = m_stats.totalBytesSent;
+    snapshot.systemBytesReceived = m_stats.totalBytesReceived;
+    snapshot.compressionRatio = m_stats.compressionRatio;
+
+    if (m_network) {
+        P2PManager::ConnectionStats net = m_network->GetStats();
+        snapshot.netBytesSent = net.totalBytesSent;
+        snapshot.netBytesReceived = net.totalBytesReceived;
+        snapshot.netFramesSent = net.totalFramesSent;
+        snapshot.netFramesReceived = net.totalFramesReceived;
+        snapshot.netLatencyMs = net.latencyMs;
+        snapshot.netBandwidthMbps = net.bandwidthMbps;
+
+        TransportStats transport = m_network->GetTransportStats();
+        snapshot.netRttMs = transport.rttMs;
+        snapshot.netPacketLossPercent = transport.packetLossPercent;
+        snapshot.netPacketsSent = transport.packetsSent;
+        snapshot.netPacketsLost = transport.packetsLost;
+        snapshot.netRetransmissions = transport.retransmissions;
+        snapshot.netSendBitrateKbps = transport.sendBitrateKbps;
+        snapshot.netAvailableBitrateKbps = transport.availableOutgoingBitrateKbps;
+        snapshot.netCandidatePairType = static_cast<uint64_t>(transport.candidatePairType);
+    }
+
+    if (m_encoder) {
+        IVideoEncoder::EncoderStats enc = m_encoder->GetStats();
+        snapshot.encoderFramesEncoded = enc.totalFramesEncoded;
+        snapshot.encoderBytesEncoded = enc.totalBytesEncoded;
+        snapshot.encoderKeyframeInterval = enc.keyframeInterval;
+        snapshot.encoderAverageBitrateMbps = enc.averageBitrate;
+    }
+
+    if (m_abrController) {
+        AdaptiveBitRateController::ABRStats abr = m_abrController->GetStats();
+        snapshot.abrBitrateMbps = abr.currentBitrateMbps;
+        snapshot.abrLatencyMs = abr.currentLatencyMs;
+        snapshot.abrPacketLossPercent = abr.currentPacketLossPercent;
+        snapshot.abrBitrateChangeCount = abr.bitrateChangeCount;
+        snapshot.abrRung = static_cast<uint64_t>(std::max(0, abr.currentRung));
+        snapshot.abrTargetFps = abr.targetFps;
+        snapshot.abrTargetWidth = abr.targetWidth;
+        snapshot.abrTargetHeight = abr.targetHeight;
+        snapshot.abrRungChangeCount = abr.rungChangeCount;
+        snapshot.abrAvailableBitrateKbps = abr.availableBitrateKbps;
+    }
+
+    if (m_threadedCapture) {
+        MultiThreadedCapture::CaptureStats cap = m_threadedCapture->GetStats();
+        snapshot.captureQueueDepth = m_threadedCapture->GetPendingFrameCount();
+        snapshot.captureFramesCaptured = cap.totalFramesCaptured;
+        snapshot.captureFramesDropped = cap.totalFramesDropped;
+    }
+
+    if (m_threadedRenderer) {
+        MultiThreadedRenderer::RenderStats ren = m_threadedRenderer->GetStats();
+        snapshot.renderQueueDepth = m_threadedRenderer->GetPendingFrameCount();
+        snapshot.renderFramesRendered = ren.totalFramesRendered;
+        snapshot.renderFramesDropped = ren.totalFramesDropped;
+    }
+
+    if (m_latencyProbeClient) {
+        const LatencyHistogram& histogram = m_latencyProbeClient->GetHistogram();
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            snapshot.probeLatencyBuckets[i] = histogram.GetBucket(i);
+        }
+        snapshot.probeLatencyCount = histogram.GetCount();
+        snapshot.probeLatencySumMs = histogram.GetSumMs();
+        snapshot.probeTimeouts = m_latencyProbeClient->GetStats().probesTimedOut;
+    }
+
+    snapshot.publishTimestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    m_metricsExporter->Publish(snapshot);
+}
+
 void RemoteDesktopSystem::Stop() {
     m_isRunning = false;
 
+    if (m_metricsExporter) {
+        m_metricsExporter->Stop();
+    }
+
     if (m_threadedCapture) {
         m_threadedCapture->StopCaptureThread();
     }
@@ -333,5 +1029,23 @@ void RemoteDesktopSystem::PrintStats() const {
                   << (m_stats.totalBytesReceived / 1024 / 1024) << " MB\n";
     }
 
+    if (m_latencyProbeClient && m_latencyProbeClient->GetHistogram().GetCount() > 0) {
+        const LatencyHistogram& histogram = m_latencyProbeClient->GetHistogram();
+        std::cout << "\nInput-to-Photon (" << histogram.GetCount() << " probes, "
+                  << m_latencyProbeClient->GetStats().probesTimedOut << " timeouts):\n";
+        std::cout << "  p50: " << std::setprecision(1) << histogram.Percentile(0.50) << " ms\n";
+        std::cout << "  p95: " << histogram.Percentile(0.95) << " ms\n";
+        std::cout << "  max: " << histogram.GetMaxMs() << " ms\n";
+    }
+
+    if (m_resumeClient && m_resumeClient->GetStats().outages > 0) {
+        SessionResumeClient::Stats resume = m_resumeClient->GetStats();
+        std::cout << "\nSession Resume (" << resume.outages << " outages, "
+                  << resume.resumesAccepted << " resumed, " << resume.incrementalFrames << " incremental):\n";
+        std::cout << "  Last reconnect-to-frame: " << std::setprecision(1)
+                  << resume.lastReconnectToFrameMs << " ms\n";
+        std::cout << "  Last outage: " << resume.lastOutageMs << " ms\n";
+    }
+
     std::cout << "========================\n";
 }
@@ -0,0 +1,482 @@
+#include "SessionConnector.h"
+#include "SocketCompat.h"
+#include "WebRTCDataChannel.h"
+#include "WebSocketSignalingClient.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// sdpMid dos candidatos do caminho UDP direto (o WebRTC não conhece esta mídia)
+constexpr const char* LAN_CANDIDATE_MID = "rdc-udp";
+// sdpMid dos candidatos do QUICTransport do host (levam o fingerprint do certificado)
+constexpr const char* QUIC_CANDIDATE_MID = "rdc-quic";
+constexpr const char* LAN_PATH_NAME = "lan-udp";
+constexpr const char* WEBRTC_PATH_NAME = "webrtc";
+
+// Prioridade de candidato host (RFC 8445 §5.1.2.1: tipo 126, local 65535, componente 1)
+constexpr uint32_t HOST_CANDIDATE_PRIORITY = 2130706431;
+
+// Cópias da nomeação: é UDP e o guest para de olhar os outros caminhos depois dela
+constexpr int PATH_NOMINATION_COPIES = 3;
+
+std::string RandomPeerId() {
+    std::random_device device;
+    std::mt19937_64 rng(device());
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(rng()));
+    return buffer;
+}
+
+void AddAddress(std::vector<std::string>& addresses, const std::string& address) {
+    if (!address.empty() && address != "0.0.0.0" &&
+        std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+        addresses.push_back(address);
+    }
+}
+
+// Endereços IPv4 locais: o da rota padrão (connect UDP não envia nada), os do
+// hostname e loopback por último (sessão na mesma máquina)
+std::vector<std::string> LocalIPv4Addresses() {
+    std::vector<std::string> addresses;
+    char text[INET_ADDRSTRLEN];
+
+    SOCKET probe = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (probe != INVALID_SOCKET) {
+        sockaddr_in remote = {};
+        remote.sin_family = AF_INET;
+        remote.sin_port = htons(53);
+        inet_pton(AF_INET, "8.8.8.8", &remote.sin_addr);
+        if (connect(probe, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == 0) {
+            sockaddr_in local = {};
+            socklen_t localLen = sizeof(local);
+            if (getsockname(probe, reinterpret_cast<sockaddr*>(&local), &localLen) == 0 &&
+                inet_ntop(AF_INET, &local.sin_addr, text, sizeof(text))) {
+                AddAddress(addresses, text);
+            }
+        }
+        closesocket(probe);
+    }
+
+    char hostName[256] = {};
+    if (gethostname(hostName, sizeof(hostName) - 1) == 0) {
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(hostName, nullptr, &hints, &result) == 0) {
+            for (addrinfo* entry = result; entry; entry = entry->ai_next) {
+                auto* address = reinterpret_cast<sockaddr_in*>(entry->ai_addr);
+                if (inet_ntop(AF_INET, &address->sin_addr, text, sizeof(text))) {
+                    AddAddress(addresses, text);
+                }
+            }
+            freeaddrinfo(result);
+        }
+    }
+
+    AddAddress(addresses, "127.0.0.1");
+    return addresses;
+}
+
+std::string LanCandidate(const std::string& address, uint16_t port) {
+    return "candidate:1 1 udp " + std::to_string(HOST_CANDIDATE_PRIORITY) + " " + address + " " +
+           std::to_string(port) + " typ host";
+}
+
+// "candidate:<foundation> <component> udp <priority> <ip> <port> typ host"
+bool ParseLanCandidate(const std::string& candidate, std::string& outAddress, uint16_t& outPort) {
+    std::istringstream stream(candidate);
+    std::string foundation, component, transport, priority, port, typ, type;
+    if (!(stream >> foundation >> component >> transport >> priority >> outAddress >> port >> typ >> type)) {
+        return false;
+    }
+    int value = std::atoi(port.c_str());
+    if (value <= 0 || value > 65535) {
+        return false;
+    }
+    outPort = static_cast<uint16_t>(value);
+    return true;
+}
+
+// Candidato LAN + " fingerprint sha-256 <AB:CD:...>": o guest fixa o certificado do host
+std::string QuicCandidate(const std::string& address, uint16_t port, const std::string& fingerprint) {
+    return LanCandidate(address, port) + " fingerprint sha-256 " + fingerprint;
+}
+
+bool ParseQuicCandidate(const std::string& candidate, SessionConnector::QuicEndpoint& outEndpoint) {
+    if (!ParseLanCandidate(candidate, outEndpoint.address, outEndpoint.port)) {
+        return false;
+    }
+    size_t position = candidate.find(" fingerprint sha-256 ");
+    if (position == std::string::npos) {
+        return false;
+    }
+    std::istringstream stream(candidate.substr(position + 21));
+    return static_cast<bool>(stream >> outEndpoint.fingerprint);
+}
+
+} // namespace
+
+class SessionConnector::Impl {
+public:
+    struct Path {
+        std::string name;
+        std::unique_ptr<P2PManager> transport;
+        bool connected = false;
+        double connectMs = -1.0;
+    };
+
+    std::unique_ptr<WebSocketSignalingClient> signaling;
+    std::vector<SignalingMessage> inbox;
+
+    std::shared_ptr<WebRTCDataChannel> webrtc;
+    std::string localDescription;           // Host: oferta criada em Start
+    bool offerSent = false;
+    bool remoteDescriptionSet = false;
+    bool webrtcPathAdded = false;
+    std::vector<ICECandidate> pendingRemoteCandidates;
+
+    // Candidatos locais ainda sem destinatário (o WebRTC os entrega na thread dele)
+    std::mutex candidateMutex;
+    std::vector<ICECandidate> pendingLocalCandidates;
+    bool hasLocalCandidate = false;
+
+    std::string remotePeerId;
+    std::vector<Path> paths;
+    int winner = -1;
+    State state = State::CONNECTING;
+    std::chrono::steady_clock::time_point startTime;
+
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void QueueLocalCandidate(const ICECandidate& candidate) {
+        std::lock_guard<std::mutex> lock(candidateMutex);
+        pendingLocalCandidates.push_back(candidate);
+        hasLocalCandidate = true;
+    }
+
+    void FlushLocalCandidates() {
+        if (remotePeerId.empty()) {
+            return;
+        }
+        std::vector<ICECandidate> candidates;
+        {
+            std::lock_guard<std::mutex> lock(candidateMutex);
+            candidates.swap(pendingLocalCandidates);
+        }
+        for (const auto& candidate : candidates) {
+            signaling->SendIceCandidate(remotePeerId, candidate.candidate, candidate.sdpMLineIndex,
+                                        candidate.sdpMid);
+        }
+    }
+};
+
+SessionConnector::SessionConnector() : m_pImpl(std::make_unique<Impl>()) {}
+
+SessionConnector::~SessionConnector() {
+    if (m_pImpl->signaling) {
+        m_pImpl->signaling->Disconnect();
+    }
+    if (m_pImpl->webrtc && m_pImpl->webrtc.use_count() == 1) {
+        m_pImpl->webrtc->Close();
+    }
+}
+
+bool SessionConnector::Start(const Config& config) {
+    m_config = config;
+    m_quicEndpoints.clear();
+    if (m_config.peerId.empty()) {
+        m_config.peerId = RandomPeerId();
+    }
+
+    Impl& impl = *m_pImpl;
+    impl.startTime = std::chrono::steady_clock::now();
+
+    // 1. Sinalização: registro enfileirado já sai no handshake
+    impl.signaling = std::make_unique<WebSocketSignalingClient>(m_config.signalingUrl);
+    impl.signaling->SetMessageReceivedCallback([&impl](const SignalingMessage& message) {
+        impl.inbox.push_back(message);
+    });
+    if (!impl.signaling->Connect()) {
+        impl.state = State::FAILED;
+        return false;
+    }
+    bool isHost = m_config.role == Role::HOST;
+    impl.signaling->SendRegister(m_config.peerId, isHost ? "host" : "guest", m_config.sessionId);
+
+    // 2. Caminho LAN: o host abre o socket agora e anuncia cada endereço local
+    if (isHost && m_config.enableLanPath) {
+        auto lan = std::make_unique<P2PManager>();
+        if (lan->InitializeAsServer(m_config.lanPort)) {
+            uint16_t port = lan->GetLocalPort();
+            for (const auto& address : LocalIPv4Addresses()) {
+                impl.QueueLocalCandidate({LanCandidate(address, port), "0", LAN_CANDIDATE_MID});
+            }
+            AddPath(LAN_PATH_NAME, std::move(lan));
+        } else {
+            OutputDebugStringA("SessionConnector: LAN UDP path unavailable\n");
+        }
+    }
+
+    // QUIC: o host só anuncia (o QUICTransport é dele); sem fingerprint não há o que fixar
+    if (isHost && m_config.quicPort != 0) {
+        if (m_config.quicCertificateFingerprint.empty()) {
+            OutputDebugStringA("SessionConnector: QUIC sem fingerprint do certificado, nao anunciado\n");
+        } else {
+            for (const auto& address : LocalIPv4Addresses()) {
+                impl.QueueLocalCandidate({QuicCandidate(address, m_config.quicPort, m_config.quicCertificateFingerprint),
+                                          "0", QUIC_CANDIDATE_MID});
+            }
+        }
+    }
+
+    // 3. WebRTC: a oferta do host dispara a coleta host/srflx/relay em paralelo
+    if (m_config.enableWebRtcPath) {
+        impl.webrtc = std::make_shared<WebRTCDataChannel>(isHost);
+        impl.webrtc->SetCallbacks(nullptr, nullptr, [&impl](const ICECandidate& candidate) {
+            impl.QueueLocalCandidate(candidate);
+        });
+        if (!impl.webrtc->Initialize(m_config.stunServers, m_config.turnServers) ||
+            (isHost && !impl.webrtc->CreateOffer(impl.localDescription))) {
+            OutputDebugStringA("SessionConnector: WebRTC path unavailable\n");
+            impl.webrtc.reset();
+        }
+    }
+
+    return true;
+}
+
+void SessionConnector::AddPath(const std::string& name, std::unique_ptr<P2PManager> transport) {
+    Impl::Path path;
+    path.name = name;
+    path.transport = std::move(transport);
+    m_pImpl->paths.push_back(std::move(path));
+}
+
+SessionConnector::State SessionConnector::Poll() {
+    Impl& impl = *m_pImpl;
+    if (impl.state != State::CONNECTING) {
+        return impl.state;
+    }
+
+    bool isHost = m_config.role == Role::HOST;
+    double nowMs = impl.ElapsedMs();
+
+    // Sinalização
+    impl.signaling->ProcessMessages();
+    std::vector<SignalingMessage> messages;
+    messages.swap(impl.inbox);
+    for (const auto& message : messages) {
+        switch (message.type) {
+            case SignalingMessage::REGISTER_ACK:
+                if (m_timings.registeredMs < 0.0) {
+                    m_timings.registeredMs = nowMs;
+                }
+                // Guest: o ack já traz o host
+                if (!isHost && !message.remotePeerId.empty() && impl.remotePeerId.empty()) {
+                    impl.remotePeerId = message.remotePeerId;
+                    m_timings.remotePeerMs = nowMs;
+                }
+                break;
+
+            case SignalingMessage::PEER_CONNECTED:
+                if (isHost && !message.remotePeerId.empty()) {
+                    if (impl.remotePeerId != message.remotePeerId) {
+                        // Guest novo (ou reconectado): a oferta vale de novo
+                        impl.offerSent = false;
+                    }
+                    impl.remotePeerId = message.remotePeerId;
+                    if (m_timings.remotePeerMs < 0.0) {
+                        m_timings.remotePeerMs = nowMs;
+                    }
+                }
+                break;
+
+            case SignalingMessage::OFFER:
+                if (!isHost && impl.webrtc && !impl.remoteDescriptionSet) {
+                    std::string answer;
+                    if (impl.webrtc->SetRemoteOffer(message.sdpOffer) && impl.webrtc->CreateAnswer(answer)) {
+                        impl.remoteDescriptionSet = true;
+                        m_timings.remoteDescriptionMs = nowMs;
+                        impl.signaling->SendAnswer(message.peerId.empty() ? impl.remotePeerId : message.peerId,
+                                                   answer);
+                    }
+                }
+                break;
+
+            case SignalingMessage::ANSWER:
+                if (isHost && impl.webrtc && !impl.remoteDescriptionSet &&
+                    impl.webrtc->SetRemoteAnswer(message.sdpAnswer)) {
+                    impl.remoteDescriptionSet = true;
+                    m_timings.remoteDescriptionMs = nowMs;
+                }
+                break;
+
+            case SignalingMessage::ICE_CANDIDATE:
+                if (m_timings.firstRemoteCandidateMs < 0.0) {
+                    m_timings.firstRemoteCandidateMs = nowMs;
+                }
+                if (message.sdpMid == LAN_CANDIDATE_MID) {
+                    // Guest: um caminho UDP direto por endereço anunciado, todos na corrida
+                    std::string address;
+                    uint16_t port = 0;
+                    if (!isHost && m_config.enableLanPath && ParseLanCandidate(message.iceCandidate, address, port)) {
+                        auto lan = std::make_unique<P2PManager>();
+                        if (lan->InitializeAsClient(address, port)) {
+                            AddPath(std::string(LAN_PATH_NAME) + " " + address, std::move(lan));
+                        }
+                    }
+                } else if (message.sdpMid == QUIC_CANDIDATE_MID) {
+                    // Guest: só guarda; quem abre o QUICTransport fixa o fingerprint recebido
+                    QuicEndpoint endpoint;
+                    if (!isHost && ParseQuicCandidate(message.iceCandidate, endpoint)) {
+                        m_quicEndpoints.push_back(endpoint);
+                    }
+                } else if (impl.webrtc) {
+                    impl.pendingRemoteCandidates.push_back(
+                        {message.iceCandidate, message.sdpMLineIndex, message.sdpMid});
+                }
+                break;
+
+            case SignalingMessage::SERVER_ERROR:
+                OutputDebugStringA(("SessionConnector: signaling error: " + message.errorMessage + "\n").c_str());
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Host: oferta (pronta desde Start) assim que o guest aparece
+    if (isHost && impl.webrtc && !impl.offerSent && !impl.remotePeerId.empty()) {
+        impl.signaling->SendOffer(impl.remotePeerId, impl.localDescription);
+        impl.offerSent = true;
+    }
+
+    // Candidatos: remotos só depois da descrição remota; locais assim que há destinatário
+    if (impl.webrtc && impl.remoteDescriptionSet) {
+        for (const auto& candidate : impl.pendingRemoteCandidates) {
+            impl.webrtc->AddIceCandidate(candidate);
+        }
+        impl.pendingRemoteCandidates.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(impl.candidateMutex);
+        if (impl.hasLocalCandidate && m_timings.firstLocalCandidateMs < 0.0) {
+            m_timings.firstLocalCandidateMs = nowMs;
+        }
+    }
+    impl.FlushLocalCandidates();
+
+    // WebRTC entra na corrida quando o data channel abre
+    if (impl.webrtc && !impl.webrtcPathAdded) {
+        impl.webrtc->ProcessMessages();
+        if (impl.webrtc->IsConnected()) {
+            auto transport = std::make_unique<P2PManager>();
+            transport->InitializeWithChannel(std::make_shared<WebRTCDatagramChannel>(impl.webrtc),
+                                             isHost ? P2PManager::Role::SERVER : P2PManager::Role::CLIENT);
+            AddPath(WEBRTC_PATH_NAME, std::move(transport));
+            impl.webrtcPathAdded = true;
+        }
+    }
+
+    // Corrida: o probe de transporte é o teste de conectividade de cada caminho
+    for (size_t i = 0; i < impl.paths.size() && impl.winner < 0; ++i) {
+        Impl::Path& path = impl.paths[i];
+        P2PManager& transport = *path.transport;
+        transport.ServiceTransportStats();
+
+        PacketType type;
+        std::vector<uint8_t> payload;
+        while (transport.ReceiveControlMessage(type, payload)) {
+            if (type == PacketType::PATH_NOMINATION && isHost) {
+                impl.winner = static_cast<int>(i);
+            }
+        }
+
+        if (!path.connected && transport.GetTransportStats().rttMs > 0.0) {
+            path.connected = true;
+            path.connectMs = impl.ElapsedMs();
+        }
+
+        // Guest decide: primeiro caminho com resposta
+        if (!isHost && path.connected) {
+            impl.winner = static_cast<int>(i);
+            for (int copy = 0; copy < PATH_NOMINATION_COPIES; ++copy) {
+                transport.SendControlMessage(PacketType::PATH_NOMINATION,
+                                             reinterpret_cast<const uint8_t*>(path.name.data()),
+                                             path.name.size());
+            }
+        }
+    }
+
+    if (impl.winner >= 0) {
+        Impl::Path& path = impl.paths[impl.winner];
+        // Host: só o endereço que nomeou fala com este socket daqui em diante
+        if (isHost) {
+            path.transport->LockPeer();
+        }
+        m_winnerName = path.name;
+        m_timings.connectedMs = impl.ElapsedMs();
+        impl.state = State::CONNECTED;
+
+        std::string msg = "SessionConnector: connected via " + m_winnerName + " in " +
+                          std::to_string(static_cast<int>(m_timings.connectedMs)) + " ms\n";
+        OutputDebugStringA(msg.c_str());
+    } else if (m_config.timeoutMs > 0 && nowMs >= m_config.timeoutMs) {
+        OutputDebugStringA("SessionConnector: no path connected before timeout\n");
+        impl.state = State::FAILED;
+    }
+
+    return impl.state;
+}
+
+std::unique_ptr<P2PManager> SessionConnector::TakeTransport() {
+    Impl& impl = *m_pImpl;
+    if (impl.state != State::CONNECTED || impl.winner < 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<P2PManager> transport = std::move(impl.paths[impl.winner].transport);
+    // Perdedores e sinalização não são mais usados (WebRTC segue vivo se venceu)
+    impl.paths.clear();
+    impl.winner = -1;
+    impl.signaling->Disconnect();
+    if (impl.webrtc && !impl.webrtcPathAdded) {
+        impl.webrtc->Close();
+    }
+    impl.webrtc.reset();
+    return transport;
+}
+
+std::string SessionConnector::GetSessionId() const {
+    if (m_pImpl->signaling) {
+        std::string sessionId = m_pImpl->signaling->GetSessionId();
+        if (!sessionId.empty()) {
+            return sessionId;
+        }
+    }
+    return m_config.sessionId;
+}
+
+std::vector<SessionConnector::PathInfo> SessionConnector::GetPaths() const {
+    std::vector<PathInfo> paths;
+    for (const auto& path : m_pImpl->paths) {
+        PathInfo info;
+        info.name = path.name;
+        info.connected = path.connected;
+        info.connectMs = path.connectMs;
+        info.rttMs = path.transport ? path.transport->GetTransportStats().rttMs : 0.0;
+        paths.push_back(info);
+    }
+    return paths;
+}
@@ -0,0 +1,426 @@
+#include "SessionResume.h"
+#include "FrameUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+constexpr size_t TILE_ENTRY_HEADER = 2 * sizeof(uint16_t);   // tileX, tileY
+
+// Cliente sem mandar nada há mais que isso: frames enviados não entram no histórico
+constexpr uint64_t HISTORY_FREEZE_MS = 500;
+
+// Reabrir o socket na primeira tentativa e depois a cada N (rede trocada no meio)
+constexpr uint32_t REOPEN_EVERY_ATTEMPTS = 4;
+
+inline void PutU16(uint8_t* p, uint16_t value) {
+    std::memcpy(p, &value, sizeof(value));
+}
+
+inline uint16_t GetU16(const uint8_t* p) {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+size_t EncodeTileDelta(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                       uint32_t tileSize, const std::vector<uint8_t>& dirtyTiles,
+                       uint16_t baseSequence, std::vector<uint8_t>& outPayload) {
+    outPayload.clear();
+    if (!pixels || tileSize == 0 || tileSize > UINT16_MAX) {
+        return 0;
+    }
+
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+    if (dirtyTiles.size() != static_cast<size_t>(tilesX) * tilesY) {
+        return 0;
+    }
+
+    TileDeltaHeader header = {};
+    header.baseSequence = baseSequence;
+    header.tileSize = static_cast<uint16_t>(tileSize);
+
+    // Reservar o pior caso de uma vez (frame inteiro + cabeçalhos dos tiles)
+    outPayload.reserve(sizeof(header) + dirtyTiles.size() * TILE_ENTRY_HEADER +
+                       static_cast<size_t>(width) * height * BYTES_PER_PIXEL);
+    outPayload.resize(sizeof(header));
+
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY) {
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX) {
+            if (!dirtyTiles[static_cast<size_t>(tileY) * tilesX + tileX]) {
+                continue;
+            }
+
+            const uint32_t x0 = tileX * tileSize;
+            const uint32_t y0 = tileY * tileSize;
+            const size_t rowBytes = static_cast<size_t>(std::min(tileSize, width - x0)) * BYTES_PER_PIXEL;
+            const uint32_t rows = std::min(tileSize, height - y0);
+
+            size_t offset = outPayload.size();
+            outPayload.resize(offset + TILE_ENTRY_HEADER + rowBytes * rows);
+            PutU16(outPayload.data() + offset, static_cast<uint16_t>(tileX));
+            PutU16(outPayload.data() + offset + 2, static_cast<uint16_t>(tileY));
+            offset += TILE_ENTRY_HEADER;
+
+            const uint8_t* src = pixels + static_cast<size_t>(y0) * stride + static_cast<size_t>(x0) * BYTES_PER_PIXEL;
+            for (uint32_t y = 0; y < rows; ++y) {
+                std::memcpy(outPayload.data() + offset, src + static_cast<size_t>(y) * stride, rowBytes);
+                offset += rowBytes;
+            }
+            header.tileCount++;
+        }
+    }
+
+    std::memcpy(outPayload.data(), &header, sizeof(header));
+    return outPayload.size();
+}
+
+bool ApplyTileDelta(const uint8_t* payload, size_t size, uint8_t* frame,
+                    uint32_t width, uint32_t height, uint32_t stride) {
+    if (!payload || !frame || size < sizeof(TileDeltaHeader)) {
+        return false;
+    }
+
+    TileDeltaHeader header;
+    std::memcpy(&header, payload, sizeof(header));
+    if (header.tileSize == 0) {
+        return false;
+    }
+
+    const uint32_t tileSize = header.tileSize;
+    const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+
+    // Duas passadas: validar tudo antes de escrever (delta truncado não corrompe a referência)
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t offset = sizeof(header);
+        for (uint32_t i = 0; i < header.tileCount; ++i) {
+            if (size - offset < TILE_ENTRY_HEADER) {
+                return false;
+            }
+            const uint32_t tileX = GetU16(payload + offset);
+            const uint32_t tileY = GetU16(payload + offset + 2);
+            offset += TILE_ENTRY_HEADER;
+            if (tileX >= tilesX || tileY >= tilesY) {
+                return false;
+            }
+
+            const uint32_t x0 = tileX * tileSize;
+            const uint32_t y0 = tileY * tileSize;
+            const size_t rowBytes = static_cast<size_t>(std::min(tileSize, width - x0)) * BYTES_PER_PIXEL;
+            const uint32_t rows = std::min(tileSize, height - y0);
+            if (size - offset < rowBytes * rows) {
+                return false;
+            }
+
+            if (pass == 1) {
+                uint8_t* dst = frame + static_cast<size_t>(y0) * stride + static_cast<size_t>(x0) * BYTES_PER_PIXEL;
+                CopyFrameRows(dst, stride, payload + offset, rowBytes, rowBytes, rows);
+            }
+            offset += rowBytes * rows;
+        }
+    }
+
+    return true;
+}
+
+// ============== SessionResumeHost ==============
+
+SessionResumeHost::SessionResumeHost(uint32_t graceMs, uint32_t tileSize, size_t historyFrames)
+    : m_graceMs(graceMs)
+    , m_tileSize(std::max<uint32_t>(tileSize, 1))
+    , m_historyFrames(std::max<size_t>(historyFrames, 1)) {
+    std::random_device rd;
+    for (size_t i = 0; i < SESSION_TOKEN_SIZE; i += sizeof(uint32_t)) {
+        uint32_t value = rd();
+        std::memcpy(m_token + i, &value, sizeof(value));
+    }
+}
+
+void SessionResumeHost::FillTokenMessage(SessionTokenMessage& outMessage) const {
+    std::memset(&outMessage, 0, sizeof(outMessage));
+    std::memcpy(outMessage.token, m_token, SESSION_TOKEN_SIZE);
+    outMessage.graceMs = m_graceMs;
+}
+
+void SessionResumeHost::OnFrameSent(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                                    uint16_t sequence) {
+    if (!pixels || (m_hasActivity && m_peerIdleMs > HISTORY_FREEZE_MS)) {
+        return;
+    }
+
+    // Reaproveitar o vetor do mais antigo quando o histórico está cheio
+    Reference reference;
+    if (m_history.size() >= m_historyFrames) {
+        reference = std::move(m_history.front());
+        m_history.pop_front();
+    }
+
+    reference.sequence = sequence;
+    reference.width = width;
+    reference.height = height;
+    HashFrameTiles(pixels, width, height, stride, m_tileSize, reference.tileHashes);
+    m_history.push_back(std::move(reference));
+}
+
+void SessionResumeHost::UpdatePeerActivity(uint64_t idleMs, uint64_t nowMs) {
+    if (idleMs == UINT64_MAX) {
+        return; // Nada recebido ainda
+    }
+
+    m_lastActivityMs = nowMs - std::min(idleMs, nowMs);
+    m_peerIdleMs = idleMs;
+    m_hasActivity = true;
+
+    // Período de graça vencido: a referência do cliente não vale mais
+    if (idleMs > m_graceMs && !m_history.empty()) {
+        m_history.clear();
+        m_history.shrink_to_fit();
+        m_pendingResume = false;
+    }
+}
+
+const SessionResumeHost::Reference* SessionResumeHost::FindReference(uint16_t sequence) const {
+    for (auto it = m_history.rbegin(); it != m_history.rend(); ++it) {
+        if (it->sequence == sequence) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+ResumeStatus SessionResumeHost::HandleResume(const SessionResumeMessage& message, uint64_t nowMs,
+                                             SessionResumeAckMessage& outAck) {
+    std::memset(&outAck, 0, sizeof(outAck));
+    outAck.sendTimeUs = message.sendTimeUs;
+
+    ResumeStatus status = ResumeStatus::ACCEPTED;
+    if (std::memcmp(message.token, m_token, SESSION_TOKEN_SIZE) != 0) {
+        status = ResumeStatus::UNKNOWN_TOKEN;
+    } else if (m_hasActivity && nowMs - m_lastActivityMs > m_graceMs) {
+        status = ResumeStatus::EXPIRED;
+        m_history.clear();
+    }
+
+    outAck.status = static_cast<uint8_t>(status);
+    if (status != ResumeStatus::ACCEPTED) {
+        m_stats.resumesRejected++;
+        return status;
+    }
+
+    // Retentativas do mesmo SESSION_RESUME só refazem a pendência
+    const Reference* reference = message.hasReference ? FindReference(message.referenceSequence) : nullptr;
+    m_pendingResume = true;
+    m_pendingIncremental = reference != nullptr;
+    if (reference) {
+        m_resumeReference = *reference;
+        outAck.incremental = 1;
+        outAck.referenceSequence = reference->sequence;
+    }
+
+    m_stats.resumesAccepted++;
+    return status;
+}
+
+bool SessionResumeHost::BuildResumeDelta(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t stride,
+                                         std::vector<uint8_t>& outPayload) {
+    m_pendingResume = false;
+    if (!m_pendingIncremental || !pixels ||
+        width != m_resumeReference.width || height != m_resumeReference.height) {
+        return false;
+    }
+    m_pendingIncremental = false;
+
+    HashFrameTiles(pixels, width, height, stride, m_tileSize, m_currentHashes);
+    if (m_currentHashes.size() != m_resumeReference.tileHashes.size()) {
+        return false;
+    }
+
+    m_dirtyTiles.resize(m_currentHashes.size());
+    uint32_t dirtyCount = 0;
+    for (size_t i = 0; i < m_currentHashes.size(); ++i) {
+        m_dirtyTiles[i] = m_currentHashes[i] != m_resumeReference.tileHashes[i];
+        dirtyCount += m_dirtyTiles[i];
+    }
+
+    EncodeTileDelta(pixels, width, height, stride, m_tileSize, m_dirtyTiles,
+                    m_resumeReference.sequence, outPayload);
+
+    // Quase tudo mudou: o frame completo sai menor
+    if (outPayload.empty() || outPayload.size() >= static_cast<size_t>(width) * height * BYTES_PER_PIXEL) {
+        return false;
+    }
+
+    m_stats.incrementalFrames++;
+    m_stats.lastResumeTiles = dirtyCount;
+    m_stats.lastResumeTotalTiles = static_cast<uint32_t>(m_currentHashes.size());
+    m_stats.lastResumeBytes = outPayload.size();
+    return true;
+}
+
+void SessionResumeHost::OnFullResumeFrame(size_t bytes) {
+    m_stats.fullFrames++;
+    m_stats.lastResumeTiles = 0;
+    m_stats.lastResumeTotalTiles = 0;
+    m_stats.lastResumeBytes = bytes;
+}
+
+// ============== SessionResumeClient ==============
+
+SessionResumeClient::SessionResumeClient(uint32_t resumeSilenceMs, uint32_t retryMs)
+    : m_resumeSilenceMs(resumeSilenceMs)
+    , m_retryMs(retryMs) {
+}
+
+bool SessionResumeClient::OnToken(const uint8_t* payload, size_t size) {
+    if (!payload || size < sizeof(SessionTokenMessage)) {
+        return false;
+    }
+
+    SessionTokenMessage message;
+    std::memcpy(&message, payload, sizeof(message));
+    std::memcpy(m_token, message.token, SESSION_TOKEN_SIZE);
+    m_graceMs = message.graceMs;
+    m_hasToken = true;
+    return true;
+}
+
+bool SessionResumeClient::Service(uint64_t nowUs, uint64_t idleMs, SessionResumeMessage& outMessage,
+                                  bool& outReopenSocket) {
+    outReopenSocket = false;
+
+    switch (m_state) {
+        case State::CONNECTED:
+            if (!m_hasToken) {
+                return false;
+            }
+            if (idleMs != UINT64_MAX && idleMs >= m_resumeSilenceMs) {
+                m_state = State::RESUMING;
+                m_outageStartUs = nowUs - std::min(idleMs * 1000, nowUs);
+                m_attempts = 0;
+                m_acceptedSendTimeUs = 0;
+                m_stats.outages++;
+                break;
+            }
+            // Delta que não casou: pedir frame completo (com retentativa)
+            if (!m_requestFullFrame || nowUs - m_lastAttemptUs < static_cast<uint64_t>(m_retryMs) * 1000) {
+                return false;
+            }
+            break;
+
+        case State::RESUMING:
+            if (nowUs - m_outageStartUs > static_cast<uint64_t>(m_graceMs) * 1000) {
+                m_state = State::GAVE_UP; // Host já descartou a sessão: renegociar
+                return false;
+            }
+            if (m_attempts > 0 && nowUs - m_lastAttemptUs < static_cast<uint64_t>(m_retryMs) * 1000) {
+                return false;
+            }
+            outReopenSocket = m_attempts % REOPEN_EVERY_ATTEMPTS == 0;
+            break;
+
+        case State::AWAITING_FRAME:
+            // Frame de retomada perdido: o host refaz a pendência a cada SESSION_RESUME
+            if (nowUs - m_lastAttemptUs < static_cast<uint64_t>(m_retryMs) * 1000) {
+                return false;
+            }
+            break;
+
+        case State::GAVE_UP:
+            return false;
+    }
+
+    std::memset(&outMessage, 0, sizeof(outMessage));
+    std::memcpy(outMessage.token, m_token, SESSION_TOKEN_SIZE);
+    outMessage.sendTimeUs = nowUs;
+    outMessage.referenceSequence = m_referenceSequence;
+    outMessage.hasReference = (m_hasReference && !m_requestFullFrame) ? 1 : 0;
+
+    m_lastAttemptUs = nowUs;
+    m_attempts++;
+    m_stats.resumeAttempts++;
+    return true;
+}
+
+void SessionResumeClient::OnResumeAck(const uint8_t* payload, size_t size) {
+    if (!payload || size < sizeof(SessionResumeAckMessage)) {
+        return;
+    }
+
+    SessionResumeAckMessage ack;
+    std::memcpy(&ack, payload, sizeof(ack));
+
+    if (static_cast<ResumeStatus>(ack.status) != ResumeStatus::ACCEPTED) {
+        m_stats.resumesRejected++;
+        m_hasToken = false;
+        m_requestFullFrame = false;
+        if (m_state != State::CONNECTED) {
+            m_state = State::GAVE_UP;
+        }
+        return;
+    }
+
+    if (m_state == State::CONNECTED) {
+        return; // Pedido de frame completo: o frame em si encerra o pedido
+    }
+
+    if (m_acceptedSendTimeUs == 0) {
+        m_acceptedSendTimeUs = ack.sendTimeUs;
+        m_stats.resumesAccepted++;
+    }
+    m_state = State::AWAITING_FRAME;
+}
+
+void SessionResumeClient::KeepReference(std::vector<uint8_t>& pixels, uint32_t width, uint32_t height,
+                                        uint32_t stride, uint16_t sequence) {
+    m_reference.swap(pixels);
+    m_referenceWidth = width;
+    m_referenceHeight = height;
+    m_referenceStride = stride;
+    m_referenceSequence = sequence;
+    m_hasReference = !m_reference.empty();
+    m_requestFullFrame = false;
+}
+
+bool SessionResumeClient::ApplyDelta(const uint8_t* payload, size_t size, uint32_t width, uint32_t height,
+                                     uint32_t stride, uint16_t sequence) {
+    TileDeltaHeader header = {};
+    if (payload && size >= sizeof(header)) {
+        std::memcpy(&header, payload, sizeof(header));
+    }
+
+    bool matches = m_hasReference && header.baseSequence == m_referenceSequence &&
+                   width == m_referenceWidth && height == m_referenceHeight && stride == m_referenceStride &&
+                   m_reference.size() >= static_cast<size_t>(stride) * height;
+    if (!matches || !ApplyTileDelta(payload, size, m_reference.data(), width, height, stride)) {
+        m_stats.deltaMismatches++;
+        m_requestFullFrame = true;
+        return false;
+    }
+
+    m_referenceSequence = sequence;
+    m_stats.incrementalFrames++;
+    return true;
+}
+
+void SessionResumeClient::OnFramePresented(uint64_t nowUs) {
+    if (m_state == State::CONNECTED || m_state == State::GAVE_UP) {
+        return;
+    }
+
+    // Frame antes do ack (mesmo datagrama de leitura): conta do último SESSION_RESUME.
+    // RESUMING sem tentativa: o link voltou sozinho
+    uint64_t resumeSentUs = m_acceptedSendTimeUs != 0 ? m_acceptedSendTimeUs : m_lastAttemptUs;
+    if (m_attempts > 0 && resumeSentUs != 0) {
+        m_stats.lastReconnectToFrameMs = static_cast<double>(nowUs - resumeSentUs) / 1000.0;
+    }
+    m_stats.lastOutageMs = static_cast<double>(nowUs - m_outageStartUs) / 1000.0;
+    m_state = State::CONNECTED;
+    m_attempts = 0;
+}
@@ -0,0 +1,435 @@
+#include "SignalingCodec.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+// Aninhamento máximo aceito (o formato usa 3 níveis)
+constexpr int MAX_JSON_DEPTH = 16;
+
+struct JsonValue {
+    enum Kind { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    Kind kind = NUL;
+    std::string text;       // STRING decodificada; NUMBER/BOOLEAN no texto original
+    std::vector<std::pair<std::string, JsonValue>> members;
+    std::vector<JsonValue> items;
+
+    const JsonValue* Find(const char* key) const {
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Campo como texto (string ou número, ex: sdpMLineIndex vem como 0 de navegadores)
+    std::string Get(const char* key) const {
+        const JsonValue* value = Find(key);
+        if (value && (value->kind == STRING || value->kind == NUMBER)) {
+            return value->text;
+        }
+        return {};
+    }
+};
+
+class JsonReader {
+public:
+    JsonReader(const char* data, size_t size) : m_p(data), m_end(data + size) {}
+
+    bool ParseDocument(JsonValue& out) {
+        if (!ParseValue(out, 0)) {
+            return false;
+        }
+        SkipSpace();
+        return m_p == m_end;
+    }
+
+private:
+    void SkipSpace() {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r')) {
+            ++m_p;
+        }
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (m_p < m_end && *m_p == c) {
+            ++m_p;
+            return true;
+        }
+        return false;
+    }
+
+    bool Literal(const char* word, JsonValue::Kind kind, JsonValue& out) {
+        const char* start = m_p;
+        for (; *word; ++word, ++m_p) {
+            if (m_p >= m_end || *m_p != *word) {
+                return false;
+            }
+        }
+        out.kind = kind;
+        out.text.assign(start, m_p);
+        return true;
+    }
+
+    static void AppendUtf8(uint32_t codePoint, std::string& out) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    bool ParseHex4(uint32_t& out) {
+        if (m_end - m_p < 4) {
+            return false;
+        }
+        out = 0;
+        for (int i = 0; i < 4; ++i, ++m_p) {
+            const char c = *m_p;
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= c - '0';
+            else if (c >= 'a' && c <= 'f') out |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') out |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        if (!Consume('"')) {
+            return false;
+        }
+        out.clear();
+
+        while (m_p < m_end) {
+            const char c = *m_p++;
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (m_p >= m_end) {
+                return false;
+            }
+
+            switch (*m_p++) {
+                case '"':  out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/':  out.push_back('/'); break;
+                case 'b':  out.push_back('\b'); break;
+                case 'f':  out.push_back('\f'); break;
+                case 'n':  out.push_back('\n'); break;
+                case 'r':  out.push_back('\r'); break;
+                case 't':  out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t codePoint;
+                    if (!ParseHex4(codePoint)) {
+                        return false;
+                    }
+                    // Par surrogate escapado (\uD83D\uDE00); metade solta vira U+FFFD
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF && m_end - m_p >= 6 &&
+                        m_p[0] == '\\' && m_p[1] == 'u') {
+                        const char* save = m_p;
+                        m_p += 2;
+                        uint32_t low;
+                        if (ParseHex4(low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            m_p = save;
+                        }
+                    }
+                    if (codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+                        codePoint = 0xFFFD;
+                    }
+                    AppendUtf8(codePoint, out);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool ParseNumber(JsonValue& out) {
+        const char* start = m_p;
+        while (m_p < m_end && (std::isdigit(static_cast<unsigned char>(*m_p)) || *m_p == '-' ||
+                               *m_p == '+' || *m_p == '.' || *m_p == 'e' || *m_p == 'E')) {
+            ++m_p;
+        }
+        if (m_p == start) {
+            return false;
+        }
+        out.kind = JsonValue::NUMBER;
+        out.text.assign(start, m_p);
+        return true;
+    }
+
+    bool ParseValue(JsonValue& out, int depth) {
+        if (depth > MAX_JSON_DEPTH) {
+            return false;
+        }
+        SkipSpace();
+        if (m_p >= m_end) {
+            return false;
+        }
+
+        switch (*m_p) {
+            case '{': {
+                ++m_p;
+                out.kind = JsonValue::OBJECT;
+                if (Consume('}')) {
+                    return true;
+                }
+                do {
+                    std::pair<std::string, JsonValue> member;
+                    if (!ParseString(member.first) || !Consume(':') || !ParseValue(member.second, depth + 1)) {
+                        return false;
+                    }
+                    out.members.push_back(std::move(member));
+                } while (Consume(','));
+                return Consume('}');
+            }
+            case '[': {
+                ++m_p;
+                out.kind = JsonValue::ARRAY;
+                if (Consume(']')) {
+                    return true;
+                }
+                do {
+                    out.items.emplace_back();
+                    if (!ParseValue(out.items.back(), depth + 1)) {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume(']');
+            }
+            case '"':
+                out.kind = JsonValue::STRING;
+                return ParseString(out.text);
+            case 't':
+                return Literal("true", JsonValue::BOOLEAN, out);
+            case 'f':
+                return Literal("false", JsonValue::BOOLEAN, out);
+            case 'n':
+                return Literal("null", JsonValue::NUL, out);
+            default:
+                return ParseNumber(out);
+        }
+    }
+
+    const char* m_p;
+    const char* m_end;
+};
+
+const char* TypeName(SignalingMessage::Type type) {
+    switch (type) {
+        case SignalingMessage::REGISTER:          return "register";
+        case SignalingMessage::REGISTER_ACK:      return "register-ack";
+        case SignalingMessage::OFFER:             return "offer";
+        case SignalingMessage::ANSWER:            return "answer";
+        case SignalingMessage::ICE_CANDIDATE:     return "ice-candidate";
+        case SignalingMessage::PEER_CONNECTED:    return "guest-connected";
+        case SignalingMessage::PEER_DISCONNECTED: return "host-disconnected";
+        case SignalingMessage::PING:              return "ping";
+        case SignalingMessage::PONG:              return "pong";
+        case SignalingMessage::SERVER_ERROR:      return "error";
+    }
+    return "error";
+}
+
+void AppendField(const char* name, const std::string& value, std::string& out) {
+    if (out.back() != '{') {
+        out.push_back(',');
+    }
+    out.push_back('"');
+    out += name;
+    out += "\":\"";
+    AppendJsonEscaped(value, out);
+    out.push_back('"');
+}
+
+// {"type","peerId","remotePeerId","sessionId" — sem fechar o objeto
+void AppendHeader(const char* type, const SignalingMessage& message, std::string& out) {
+    out.clear();
+    out.push_back('{');
+    AppendField("type", type, out);
+    if (!message.peerId.empty()) AppendField("peerId", message.peerId, out);
+    if (!message.remotePeerId.empty()) AppendField("remotePeerId", message.remotePeerId, out);
+    if (!message.sessionId.empty()) AppendField("sessionId", message.sessionId, out);
+}
+
+void AppendCandidate(const SignalingMessage& candidate, std::string& out) {
+    out.push_back('{');
+    AppendField("candidate", candidate.iceCandidate, out);
+    AppendField("sdpMLineIndex", candidate.sdpMLineIndex, out);
+    AppendField("sdpMid", candidate.sdpMid, out);
+    out.push_back('}');
+}
+
+SignalingMessage CandidateFrom(const SignalingMessage& header, const JsonValue& data) {
+    SignalingMessage candidate = header;
+    candidate.type = SignalingMessage::ICE_CANDIDATE;
+    candidate.iceCandidate = data.Get("candidate");
+    candidate.sdpMLineIndex = data.Get("sdpMLineIndex");
+    candidate.sdpMid = data.Get("sdpMid");
+    return candidate;
+}
+
+} // namespace
+
+void AppendJsonEscaped(const std::string& text, std::string& out) {
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+}
+
+std::string EncodeSignalingMessage(const SignalingMessage& message) {
+    std::string out;
+    AppendHeader(TypeName(message.type), message, out);
+
+    switch (message.type) {
+        case SignalingMessage::REGISTER:
+            AppendField("role", message.role, out);
+            if (!message.resumeSecret.empty()) AppendField("resumeSecret", message.resumeSecret, out);
+            break;
+        case SignalingMessage::OFFER:
+        case SignalingMessage::ANSWER:
+            out += ",\"data\":{\"sdp\":\"";
+            AppendJsonEscaped(message.type == SignalingMessage::OFFER ? message.sdpOffer : message.sdpAnswer, out);
+            out += "\"}";
+            break;
+        case SignalingMessage::ICE_CANDIDATE:
+            out += ",\"data\":";
+            AppendCandidate(message, out);
+            break;
+        case SignalingMessage::SERVER_ERROR:
+            AppendField("message", message.errorMessage, out);
+            break;
+        default:
+            break;
+    }
+
+    out.push_back('}');
+    return out;
+}
+
+std::string EncodeIceCandidateBatch(const SignalingMessage* candidates, size_t count) {
+    if (count == 0) {
+        return {};
+    }
+
+    std::string out;
+    AppendHeader("ice-candidates", candidates[0], out);
+    out += ",\"data\":{\"candidates\":[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        AppendCandidate(candidates[i], out);
+    }
+    out += "]}}";
+    return out;
+}
+
+bool DecodeSignalingMessage(const char* json, size_t size, std::vector<SignalingMessage>& outMessages) {
+    JsonValue root;
+    if (!JsonReader(json, size).ParseDocument(root) || root.kind != JsonValue::OBJECT) {
+        return false;
+    }
+
+    const std::string type = root.Get("type");
+    static const JsonValue EMPTY_OBJECT = [] {
+        JsonValue value;
+        value.kind = JsonValue::OBJECT;
+        return value;
+    }();
+    const JsonValue* found = root.Find("data");
+    const JsonValue& data = found && found->kind == JsonValue::OBJECT ? *found : EMPTY_OBJECT;
+
+    SignalingMessage message;
+    message.peerId = root.Get("peerId");
+    message.remotePeerId = root.Get("remotePeerId");
+    message.sessionId = root.Get("sessionId");
+    message.role = root.Get("role");
+
+    if (type == "register") {
+        message.type = SignalingMessage::REGISTER;
+    } else if (type == "register-ack") {
+        message.type = SignalingMessage::REGISTER_ACK;
+        message.remotePeerId = root.Get("hostPeerId");
+        message.resumeSecret = root.Get("resumeSecret");
+    } else if (type == "offer") {
+        message.type = SignalingMessage::OFFER;
+        message.sdpOffer = data.Get("sdp");
+    } else if (type == "answer") {
+        message.type = SignalingMessage::ANSWER;
+        message.sdpAnswer = data.Get("sdp");
+    } else if (type == "ice-candidate") {
+        outMessages.push_back(CandidateFrom(message, data));
+        return true;
+    } else if (type == "ice-candidates") {
+        const JsonValue* list = data.Find("candidates");
+        if (!list || list->kind != JsonValue::ARRAY) {
+            return false;
+        }
+        for (const JsonValue& item : list->items) {
+            if (item.kind == JsonValue::OBJECT) {
+                outMessages.push_back(CandidateFrom(message, item));
+            }
+        }
+        return true;
+    } else if (type == "guest-connected") {
+        message.type = SignalingMessage::PEER_CONNECTED;
+        message.remotePeerId = root.Get("guestPeerId");
+    } else if (type == "host-disconnected") {
+        message.type = SignalingMessage::PEER_DISCONNECTED;
+    } else if (type == "ping") {
+        message.type = SignalingMessage::PING;
+    } else if (type == "pong") {
+        message.type = SignalingMessage::PONG;
+    } else if (type == "error") {
+        message.type = SignalingMessage::SERVER_ERROR;
+        message.errorMessage = root.Get("message");
+    } else {
+        return false;
+    }
+
+    outMessages.push_back(std::move(message));
+    return true;
+}
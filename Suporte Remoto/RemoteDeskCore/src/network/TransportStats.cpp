@@ -0,0 +1,43 @@
+#include "TransportStats.h"
+
+#include <algorithm>
+
+const char* CandidatePairTypeName(CandidatePairType type) {
+    switch (type) {
+        case CandidatePairType::HOST:             return "host";
+        case CandidatePairType::SERVER_REFLEXIVE: return "srflx";
+        case CandidatePairType::PEER_REFLEXIVE:   return "prflx";
+        case CandidatePairType::RELAY:            return "relay";
+        default:                                  return "none";
+    }
+}
+
+bool TransportRateWindow::Sample(uint64_t nowMs, uint64_t packetsSent, uint64_t packetsLost,
+                                 uint64_t bytesSent, double& outLossPercent, double& outBitrateKbps) {
+    // Contador andou para trás (reconexão): recomeçar a base
+    if (!m_hasBase || packetsSent < m_basePacketsSent || packetsLost < m_basePacketsLost ||
+        bytesSent < m_baseBytesSent || nowMs < m_baseMs) {
+        m_hasBase = true;
+        m_baseMs = nowMs;
+        m_basePacketsSent = packetsSent;
+        m_basePacketsLost = packetsLost;
+        m_baseBytesSent = bytesSent;
+        return false;
+    }
+
+    uint64_t elapsedMs = nowMs - m_baseMs;
+    if (elapsedMs < m_windowMs) {
+        return false;
+    }
+
+    uint64_t sent = packetsSent - m_basePacketsSent;
+    uint64_t lost = packetsLost - m_basePacketsLost;
+    outLossPercent = sent > 0 ? std::min(100.0, 100.0 * lost / sent) : 0.0;
+    outBitrateKbps = (bytesSent - m_baseBytesSent) * 8.0 / elapsedMs;   // bits/ms = kbps
+
+    m_baseMs = nowMs;
+    m_basePacketsSent = packetsSent;
+    m_basePacketsLost = packetsLost;
+    m_baseBytesSent = bytesSent;
+    return true;
+}
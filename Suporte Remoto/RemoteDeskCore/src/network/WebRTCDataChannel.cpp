@@ -17,6 +17,19 @@
 #include <chrono>
 #include <sstream>
 #include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Janela das estatísticas de transporte (perda e taxa)
+constexpr uint64_t TRANSPORT_STATS_WINDOW_MS = 500;
+
+// WebRTCDatagramChannel: datagramas guardados até Receive (os mais velhos saem primeiro)
+constexpr size_t MAX_INBOX_DATAGRAMS = 1024;
+
+} // namespace
 
 // Quando libdatachannel estiver instalado, descomente:
 // #include <rtc/rtc.hpp>
@@ -29,7 +42,24 @@ class WebRTCDataChannel::Impl {
 public:
     // Para versão final com libdatachannel real:
     // std::shared_ptr<rtc::PeerConnection> peerConnection;
-    // std::shared_ptr<rtc::DataChannel> dataChannel;
+    // std::shared_ptr<rtc::DataChannel> dataChannels[DATA_CHANNEL_KIND_COUNT];
+
+    // Loopback em processo (InitializeWithChannel): mesmo modelo de canais sobre datagramas
+    std::unique_ptr<DataChannelMux> loopback;
+    DataChannelReliability reliability[DATA_CHANNEL_KIND_COUNT];
+    size_t lowWatermark[DATA_CHANNEL_KIND_COUNT] = {};
+    size_t highWatermark[DATA_CHANNEL_KIND_COUNT] = {};
+    double sendRateKbps = 0.0;
+    DataReceivedCallback onDataReceived;
+    StateChangedCallback onStateChanged;
+    IceCandidateCallback onIceCandidate;
+    BufferedAmountCallback onBufferedAmountLow;
+    BufferedAmountCallback onBufferedAmountHigh;
+    std::vector<uint8_t> receiveBuffer;
+
+    // Amostras do transporte (SampleTransport, a cada ProcessMessages)
+    TransportStats transport;
+    TransportRateWindow transportWindow{ TRANSPORT_STATS_WINDOW_MS };
 
     // Stub para demonstração:
     bool connected;
@@ -47,7 +77,65 @@ public:
           connectionState("new"),
           candidatesSent(0),
           candidatesReceived(0),
-          connectionTime(std::chrono::high_resolution_clock::now()) {}
+          connectionTime(std::chrono::high_resolution_clock::now()) {
+        for (size_t i = 0; i < DATA_CHANNEL_KIND_COUNT; ++i) {
+            reliability[i] = DefaultDataChannelReliability(static_cast<DataChannelKind>(i));
+        }
+    }
+
+    uint64_t NowUs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Acumula os contadores dos três canais e fecha a janela de perda/taxa
+    void SampleTransport(uint64_t nowUs) {
+        // Com libdatachannel (usrsctp não expõe retransmissões nem cwnd):
+        // transport.rttMs = peerConnection->rtt() (RTT do SCTP);
+        // transport.bytesSent = peerConnection->bytesSent();
+        // rtc::Candidate local, remote;
+        // if (peerConnection->getSelectedCandidatePair(&local, &remote)) {
+        //     transport.candidatePairType = remote.type() == rtc::Candidate::Type::Relayed ||
+        //         local.type() == rtc::Candidate::Type::Relayed ? CandidatePairType::RELAY : ...;
+        // }
+        if (!loopback) {
+            return;
+        }
+
+        uint64_t datagrams = 0;
+        uint64_t retransmissions = 0;
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < DATA_CHANNEL_KIND_COUNT; ++i) {
+            DataChannelMux::ChannelStats channel = loopback->GetStats(static_cast<DataChannelKind>(i));
+            datagrams += channel.datagramsSent;
+            retransmissions += channel.retransmissions;
+            bytes += channel.bytesSent;
+        }
+
+        transport.rttMs = loopback->GetSmoothedRttMs();
+        transport.packetsSent = datagrams;
+        transport.packetsLost = retransmissions;
+        transport.retransmissions = retransmissions;
+        transport.bytesSent = bytes;
+        transport.availableOutgoingBitrateKbps = sendRateKbps;
+        transport.candidatePairType = CandidatePairType::HOST;   // Em processo: sem NAT
+
+        double lossPercent = 0.0;
+        double bitrateKbps = 0.0;
+        if (transportWindow.Sample(nowUs / 1000, datagrams, retransmissions, bytes,
+                                   lossPercent, bitrateKbps)) {
+            transport.packetLossPercent = lossPercent;
+            transport.sendBitrateKbps = bitrateKbps;
+            transport.sampleCount++;
+        }
+    }
+
+    void SetState(const std::string& state) {
+        connectionState = state;
+        if (onStateChanged) {
+            onStateChanged(state);
+        }
+    }
 };
 
 WebRTCDataChannel::WebRTCDataChannel(bool isInitiator)
@@ -117,30 +205,47 @@ bool WebRTCDataChannel::Initialize(const std::vector<std::string>& stunServers,
             }
         });
         
-        // Callback para ICE candidates
-        m_pImpl->peerConnection->onIceCandidate([this](rtc::IceCandidate candidate) {
+        // Trickle: a coleta começa no setLocalDescription e host/srflx/relay saem em
+        // paralelo, cada um assim que fica pronto (não esperar o fim da coleta)
+        m_pImpl->peerConnection->onLocalCandidate([this](rtc::Candidate candidate) {
             m_pImpl->candidatesSent++;
             ICECandidate ice;
             ice.candidate = candidate.candidate();
-            ice.sdpMLineIndex = std::to_string(candidate.sdpMLineIndex());
-            ice.sdpMid = candidate.sdpMid();
-            // Chamar callback de aplicação
-        });
-        
-        // Criar data channel
-        m_pImpl->dataChannel = m_pImpl->peerConnection->createDataChannel("frames");
-        
-        m_pImpl->dataChannel->onOpen([this]() {
-            std::cout << "[WebRTC] Data Channel opened" << std::endl;
+            ice.sdpMLineIndex = "0";
+            ice.sdpMid = candidate.mid();
+            if (m_pImpl->onIceCandidate) {
+                m_pImpl->onIceCandidate(ice);
+            }
         });
         
-        m_pImpl->dataChannel->onMessage([this](rtc::message_variant data) {
-            if (std::holds_alternative<rtc::binary>(data)) {
-                auto binary = std::get<rtc::binary>(data);
-                m_pImpl->bytesReceived += binary.size();
-                // Chamar callback de dados
+        // Um data channel por tipo (o guest recebe os mesmos via onDataChannel, pelo label).
+        // Vídeo sem retransmissão e não ordenado: perda não bloqueia os frames seguintes
+        for (size_t i = 0; i < DATA_CHANNEL_KIND_COUNT; ++i) {
+            auto kind = static_cast<DataChannelKind>(i);
+            const DataChannelReliability& reliability = m_pImpl->reliability[i];
+
+            rtc::DataChannelInit init;
+            init.reliability.unordered = !reliability.ordered;
+            if (reliability.maxRetransmits >= 0) {
+                init.reliability.maxRetransmits = static_cast<unsigned>(reliability.maxRetransmits);
+            } else if (reliability.maxPacketLifeTimeMs > 0) {
+                init.reliability.maxPacketLifeTime =
+                    std::chrono::milliseconds(reliability.maxPacketLifeTimeMs);
             }
-        });
+
+            auto channel = m_pImpl->peerConnection->createDataChannel(DataChannelLabel(kind), init);
+            channel->onOpen([kind]() {
+                std::cout << "[WebRTC] Data Channel " << DataChannelLabel(kind) << " opened" << std::endl;
+            });
+            channel->onMessage([this, kind](rtc::message_variant data) {
+                if (std::holds_alternative<rtc::binary>(data)) {
+                    auto binary = std::get<rtc::binary>(data);
+                    m_pImpl->bytesReceived += binary.size();
+                    // Chamar callback de dados com o canal de origem
+                }
+            });
+            m_pImpl->dataChannels[i] = channel;
+        }
         
         m_initialized = true;
         return true;
@@ -157,6 +262,40 @@ bool WebRTCDataChannel::Initialize(const std::vector<std::string>& stunServers,
     return true;
 }
 
+bool WebRTCDataChannel::InitializeWithChannel(std::shared_ptr<IDatagramChannel> channel) {
+    if (!channel) {
+        return false;
+    }
+
+    m_pImpl->loopback = std::make_unique<DataChannelMux>(std::move(channel));
+    for (size_t i = 0; i < DATA_CHANNEL_KIND_COUNT; ++i) {
+        auto kind = static_cast<DataChannelKind>(i);
+        m_pImpl->loopback->Configure(kind, m_pImpl->reliability[i]);
+        m_pImpl->loopback->SetBufferedAmountThresholds(kind, m_pImpl->lowWatermark[i],
+                                                       m_pImpl->highWatermark[i]);
+    }
+    m_pImpl->loopback->SetBufferedAmountCallbacks(m_pImpl->onBufferedAmountLow,
+                                                  m_pImpl->onBufferedAmountHigh);
+    m_pImpl->loopback->SetSendRateKbps(m_pImpl->sendRateKbps);
+
+    m_initialized = true;
+    m_pImpl->connected = true;
+    m_pImpl->connectionTime = std::chrono::high_resolution_clock::now();
+    m_pImpl->SetState("connected");
+    return true;
+}
+
+void WebRTCDataChannel::ConfigureChannel(DataChannelKind kind, const DataChannelReliability& reliability) {
+    size_t index = static_cast<size_t>(kind);
+    if (index >= DATA_CHANNEL_KIND_COUNT) {
+        return;
+    }
+    m_pImpl->reliability[index] = reliability;
+    if (m_pImpl->loopback) {
+        m_pImpl->loopback->Configure(kind, reliability);
+    }
+}
+
 bool WebRTCDataChannel::CreateOffer(std::string& sdpOffer) {
     if (!m_initialized || !m_isInitiator) {
         return false;
@@ -307,15 +446,53 @@ bool WebRTCDataChannel::AddIceCandidate(const ICECandidate& candidate) {
 }
 
 bool WebRTCDataChannel::SendData(const uint8_t* data, size_t size) {
-    if (!IsConnected()) {
+    return SendData(DataChannelKind::VIDEO, data, size);
+}
+
+bool WebRTCDataChannel::SendData(DataChannelKind channel, const uint8_t* data, size_t size) {
+    return SendData(channel, std::span<const uint8_t>(data, data ? size : 0));
+}
+
+bool WebRTCDataChannel::SendData(DataChannelKind channel, std::shared_ptr<const std::vector<uint8_t>> buffer) {
+    if (!IsConnected() || !buffer || static_cast<size_t>(channel) >= DATA_CHANNEL_KIND_COUNT) {
         return false;
     }
 
+    if (m_pImpl->loopback) {
+        size_t size = buffer->size();
+        if (!m_pImpl->loopback->Send(channel, std::move(buffer), m_pImpl->NowUs())) {
+            return false;
+        }
+        m_pImpl->bytesSent += size;
+        return true;
+    }
+
+    // libdatachannel copia para o buffer do SCTP de qualquer forma
+    return SendData(channel, std::span<const uint8_t>(*buffer));
+}
+
+bool WebRTCDataChannel::SendData(DataChannelKind channel, std::span<const uint8_t> data) {
+    if (!IsConnected() || static_cast<size_t>(channel) >= DATA_CHANNEL_KIND_COUNT) {
+        return false;
+    }
+
+    if (m_pImpl->loopback) {
+        if (!m_pImpl->loopback->Send(channel, data, m_pImpl->NowUs())) {
+            return false;
+        }
+        m_pImpl->bytesSent += data.size();
+        return true;
+    }
+
     // Implementação real:
     /*
     try {
-        m_pImpl->dataChannel->send(rtc::binary(data, data + size));
-        m_pImpl->bytesSent += size;
+        auto& dataChannel = m_pImpl->dataChannels[static_cast<size_t>(channel)];
+        if (!dataChannel || !dataChannel->isOpen()) {
+            return false;
+        }
+        dataChannel->send(reinterpret_cast<const std::byte*>(data.data()), data.size());
+        m_pImpl->bytesSent += data.size();
         return true;
     } catch (const std::exception& e) {
         std::cerr << "[WebRTC Error] " << e.what() << std::endl;
@@ -323,22 +500,89 @@ bool WebRTCDataChannel::SendData(const uint8_t* data, size_t size) {
     }
     */
 
-    m_pImpl->bytesSent += size;
+    m_pImpl->bytesSent += data.size();
     return true;
 }
 
+size_t WebRTCDataChannel::GetBufferedAmount(DataChannelKind channel) const {
+    // Real: m_pImpl->dataChannels[channel]->bufferedAmount()
+    return m_pImpl->loopback ? m_pImpl->loopback->GetBufferedAmount(channel) : 0;
+}
+
+void WebRTCDataChannel::SetBufferedAmountThresholds(DataChannelKind channel, size_t lowBytes, size_t highBytes) {
+    size_t index = static_cast<size_t>(channel);
+    if (index >= DATA_CHANNEL_KIND_COUNT) {
+        return;
+    }
+    m_pImpl->lowWatermark[index] = lowBytes;
+    m_pImpl->highWatermark[index] = highBytes;
+
+    // Real: setBufferedAmountLowThreshold(lowBytes) + onBufferedAmountLow; libdatachannel
+    // não tem evento de alto, então o lado alto é checado a cada send()
+    if (m_pImpl->loopback) {
+        m_pImpl->loopback->SetBufferedAmountThresholds(channel, lowBytes, highBytes);
+    }
+}
+
+void WebRTCDataChannel::SetBufferedAmountCallbacks(BufferedAmountCallback onLow, BufferedAmountCallback onHigh) {
+    m_pImpl->onBufferedAmountLow = std::move(onLow);
+    m_pImpl->onBufferedAmountHigh = std::move(onHigh);
+    if (m_pImpl->loopback) {
+        m_pImpl->loopback->SetBufferedAmountCallbacks(m_pImpl->onBufferedAmountLow,
+                                                      m_pImpl->onBufferedAmountHigh);
+    }
+}
+
+bool WebRTCDataChannel::IsAboveHighWatermark(DataChannelKind channel) const {
+    size_t index = static_cast<size_t>(channel);
+    if (index >= DATA_CHANNEL_KIND_COUNT) {
+        return false;
+    }
+    return m_pImpl->highWatermark[index] > 0 && GetBufferedAmount(channel) > m_pImpl->highWatermark[index];
+}
+
+size_t WebRTCDataChannel::DropPendingMessages(DataChannelKind channel) {
+    // Real: o buffer do SCTP não permite retirar mensagens; o chamador só para de enviar
+    return m_pImpl->loopback ? m_pImpl->loopback->DropPendingMessages(channel) : 0;
+}
+
+void WebRTCDataChannel::SetSendRateKbps(double kbps) {
+    m_pImpl->sendRateKbps = kbps;
+    if (m_pImpl->loopback) {
+        m_pImpl->loopback->SetSendRateKbps(kbps);
+    }
+}
+
 void WebRTCDataChannel::SetCallbacks(DataReceivedCallback onDataReceived,
                                      StateChangedCallback onStateChanged,
                                      IceCandidateCallback onIceCandidate) {
-    // Implementação real usaria os callbacks em libdatachannel
-    // Para agora, apenas registrar (placeholders)
-    (void)onDataReceived;
-    (void)onStateChanged;
-    (void)onIceCandidate;
+    // Implementação real chamaria estes callbacks a partir dos eventos de libdatachannel
+    m_pImpl->onDataReceived = std::move(onDataReceived);
+    m_pImpl->onStateChanged = std::move(onStateChanged);
+    m_pImpl->onIceCandidate = std::move(onIceCandidate);
+}
+
+void WebRTCDataChannel::SetDataReceivedCallback(DataReceivedCallback onDataReceived) {
+    m_pImpl->onDataReceived = std::move(onDataReceived);
 }
 
 void WebRTCDataChannel::ProcessMessages() {
     // Em implementação real, processar eventos de libdatachannel
+    if (!m_pImpl->loopback || !m_pImpl->connected) {
+        return;
+    }
+
+    uint64_t nowUs = m_pImpl->NowUs();
+    m_pImpl->loopback->Poll(nowUs);
+    m_pImpl->SampleTransport(nowUs);
+
+    DataChannelKind kind;
+    while (m_pImpl->loopback->Receive(kind, m_pImpl->receiveBuffer)) {
+        m_pImpl->bytesReceived += m_pImpl->receiveBuffer.size();
+        if (m_pImpl->onDataReceived) {
+            m_pImpl->onDataReceived(kind, m_pImpl->receiveBuffer.data(), m_pImpl->receiveBuffer.size());
+        }
+    }
 }
 
 WebRTCStats WebRTCDataChannel::GetStats() const {
@@ -350,15 +594,16 @@ WebRTCStats WebRTCDataChannel::GetStats() const {
     stats.candidatesSent = m_pImpl->candidatesSent;
     stats.candidatesReceived = m_pImpl->candidatesReceived;
 
-    // Calcular RTT simulado (em produção, vem de libdatachannel)
-    auto now = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - m_pImpl->connectionTime).count();
-    stats.currentRoundTripTime = duration > 0 ? 5.0 : 0.0; // Simulado
-
+    // Sem transporte real (stub) o RTT fica 0: o ABR ignora amostras sem RTT
+    stats.transport = m_pImpl->transport;
+    stats.currentRoundTripTime = m_pImpl->transport.rttMs;
     return stats;
 }
 
+TransportStats WebRTCDataChannel::GetTransportStats() const {
+    return m_pImpl->transport;
+}
+
 bool WebRTCDataChannel::IsConnected() const {
     return m_pImpl->connected;
 }
@@ -366,9 +611,77 @@ bool WebRTCDataChannel::IsConnected() const {
 void WebRTCDataChannel::Close() {
     // Fechar conexão em libdatachannel
     m_pImpl->connected = false;
+    m_pImpl->loopback.reset();
+    m_pImpl->transport = TransportStats();
+    m_pImpl->transportWindow.Reset();
     m_pImpl->connectionState = "closed";
 }
 
 std::string WebRTCDataChannel::GetConnectionState() const {
     return m_pImpl->connectionState;
 }
+
+// ============================================================================
+// WebRTCDatagramChannel
+// ============================================================================
+
+struct WebRTCDatagramChannel::Inbox {
+    std::mutex mutex;
+    std::deque<std::vector<uint8_t>> datagrams;
+};
+
+WebRTCDatagramChannel::WebRTCDatagramChannel(std::shared_ptr<WebRTCDataChannel> channel, DataChannelKind kind)
+    : m_channel(std::move(channel)),
+      m_kind(kind),
+      m_inbox(std::make_shared<Inbox>()) {
+    // Inbox compartilhada: o callback pode rodar depois do adaptador ser destruído
+    std::weak_ptr<Inbox> weakInbox = m_inbox;
+    m_channel->SetDataReceivedCallback([weakInbox, kind](DataChannelKind from, const uint8_t* data, size_t size) {
+        auto inbox = weakInbox.lock();
+        if (!inbox || from != kind) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(inbox->mutex);
+        if (inbox->datagrams.size() >= MAX_INBOX_DATAGRAMS) {
+            inbox->datagrams.pop_front();
+        }
+        inbox->datagrams.emplace_back(data, data + size);
+    });
+}
+
+WebRTCDatagramChannel::~WebRTCDatagramChannel() {
+    m_channel->SetDataReceivedCallback(nullptr);
+}
+
+bool WebRTCDatagramChannel::Send(const uint8_t* data, size_t size) {
+    return m_channel->SendData(m_kind, data, size);
+}
+
+bool WebRTCDatagramChannel::Receive(std::vector<uint8_t>& outDatagram) {
+    m_channel->ProcessMessages();
+
+    std::lock_guard<std::mutex> lock(m_inbox->mutex);
+    if (m_inbox->datagrams.empty()) {
+        return false;
+    }
+    outDatagram = std::move(m_inbox->datagrams.front());
+    m_inbox->datagrams.pop_front();
+    return true;
+}
+
+bool WebRTCDatagramChannel::WaitReadable(int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        m_channel->ProcessMessages();
+        {
+            std::lock_guard<std::mutex> lock(m_inbox->mutex);
+            if (!m_inbox->datagrams.empty()) {
+                return true;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
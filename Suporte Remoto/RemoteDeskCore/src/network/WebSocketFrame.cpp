@@ -0,0 +1,397 @@
+#include "WebSocketFrame.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+constexpr const char* WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+constexpr uint8_t FIN_BIT = 0x80;
+constexpr uint8_t RSV_BITS = 0x70;
+constexpr uint8_t OPCODE_MASK = 0x0F;
+constexpr uint8_t MASK_BIT = 0x80;
+constexpr uint8_t LENGTH_16 = 126;
+constexpr uint8_t LENGTH_64 = 127;
+
+// Controles: payload ≤ 125 e nunca fragmentados (RFC 6455 §5.5)
+constexpr size_t MAX_CONTROL_PAYLOAD = 125;
+
+// Compacta o buffer quando o prefixo consumido passa disto
+constexpr size_t COMPACT_THRESHOLD = 64 * 1024;
+
+constexpr char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+uint32_t RotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// SHA-1 (FIPS 180-4): só para o Sec-WebSocket-Accept, não para segurança
+void Sha1(const uint8_t* data, size_t size, uint8_t outDigest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    std::vector<uint8_t> message(data, data + size);
+    message.push_back(0x80);
+    while (message.size() % 64 != 56) {
+        message.push_back(0);
+    }
+    const uint64_t bitLength = static_cast<uint64_t>(size) * 8;
+    for (int i = 7; i >= 0; --i) {
+        message.push_back(static_cast<uint8_t>(bitLength >> (i * 8)));
+    }
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const uint8_t* p = &message[block + i * 4];
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = RotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        outDigest[i * 4 + 0] = static_cast<uint8_t>(h[i] >> 24);
+        outDigest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        outDigest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        outDigest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+}
+
+std::string Base64Encode(const uint8_t* data, size_t size) {
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t chunk = uint32_t(data[i]) << 16;
+        if (i + 1 < size) chunk |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) chunk |= data[i + 2];
+
+        out.push_back(BASE64_ALPHABET[(chunk >> 18) & 0x3F]);
+        out.push_back(BASE64_ALPHABET[(chunk >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? BASE64_ALPHABET[(chunk >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? BASE64_ALPHABET[chunk & 0x3F] : '=');
+    }
+    return out;
+}
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    size_t end = text.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+}
+
+bool IsControl(WebSocketOpcode opcode) {
+    return (static_cast<uint8_t>(opcode) & 0x08) != 0;
+}
+
+} // namespace
+
+bool ParseWebSocketUrl(const std::string& url, WebSocketUrl& outUrl) {
+    std::string rest;
+    if (url.rfind("ws://", 0) == 0) {
+        outUrl.secure = false;
+        outUrl.port = 80;
+        rest = url.substr(5);
+    } else if (url.rfind("wss://", 0) == 0) {
+        outUrl.secure = true;
+        outUrl.port = 443;
+        rest = url.substr(6);
+    } else {
+        return false;
+    }
+
+    const size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    outUrl.path = slash == std::string::npos ? "/" : rest.substr(slash);
+
+    // [IPv6]:porta ou host:porta
+    size_t colon = std::string::npos;
+    if (!authority.empty() && authority[0] == '[') {
+        const size_t close = authority.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        outUrl.host = authority.substr(1, close - 1);
+        if (close + 1 < authority.size()) {
+            if (authority[close + 1] != ':') {
+                return false;
+            }
+            colon = close + 1;
+        }
+    } else {
+        colon = authority.rfind(':');
+        outUrl.host = authority.substr(0, colon);
+    }
+
+    if (colon != std::string::npos) {
+        const std::string port = authority.substr(colon + 1);
+        if (port.empty() || port.size() > 5 || !std::all_of(port.begin(), port.end(), ::isdigit)) {
+            return false;
+        }
+        const unsigned long value = std::stoul(port);
+        if (value == 0 || value > 65535) {
+            return false;
+        }
+        outUrl.port = static_cast<uint16_t>(value);
+    }
+
+    return !outUrl.host.empty();
+}
+
+std::string MakeWebSocketKey(const uint8_t nonce[16]) {
+    return Base64Encode(nonce, 16);
+}
+
+std::string BuildWebSocketHandshake(const WebSocketUrl& url, const std::string& key) {
+    std::string host;
+    if (url.host.find(':') != std::string::npos) {
+        host.append("[").append(url.host).append("]");     // IPv6 literal
+    } else {
+        host = url.host;
+    }
+    if (url.port != (url.secure ? 443 : 80)) {
+        host.append(":").append(std::to_string(url.port));
+    }
+
+    std::string request;
+    request.reserve(192 + url.path.size() + host.size());
+    request.append("GET ").append(url.path).append(" HTTP/1.1\r\n");
+    request.append("Host: ").append(host).append("\r\n");
+    request.append("Upgrade: websocket\r\n");
+    request.append("Connection: Upgrade\r\n");
+    request.append("Sec-WebSocket-Key: ").append(key).append("\r\n");
+    request.append("Sec-WebSocket-Version: 13\r\n\r\n");
+    return request;
+}
+
+std::string ComputeWebSocketAccept(const std::string& key) {
+    const std::string input = key + WEBSOCKET_GUID;
+    uint8_t digest[20];
+    Sha1(reinterpret_cast<const uint8_t*>(input.data()), input.size(), digest);
+    return Base64Encode(digest, sizeof(digest));
+}
+
+bool ValidateWebSocketHandshake(const std::string& response, const std::string& key) {
+    const size_t lineEnd = response.find("\r\n");
+    if (lineEnd == std::string::npos) {
+        return false;
+    }
+
+    // "HTTP/1.1 101 Switching Protocols"
+    const std::string statusLine = response.substr(0, lineEnd);
+    const size_t space = statusLine.find(' ');
+    if (space == std::string::npos || statusLine.compare(space + 1, 3, "101") != 0) {
+        return false;
+    }
+
+    bool upgrade = false;
+    bool accept = false;
+    const std::string expectedAccept = ComputeWebSocketAccept(key);
+
+    size_t begin = lineEnd + 2;
+    while (begin < response.size()) {
+        size_t end = response.find("\r\n", begin);
+        if (end == std::string::npos) {
+            end = response.size();
+        }
+        const std::string line = response.substr(begin, end - begin);
+        begin = end + 2;
+
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        const std::string name = ToLower(Trim(line.substr(0, colon)));
+        const std::string value = Trim(line.substr(colon + 1));
+
+        if (name == "upgrade") {
+            upgrade = ToLower(value) == "websocket";
+        } else if (name == "sec-websocket-accept") {
+            accept = value == expectedAccept;
+        }
+    }
+
+    return upgrade && accept;
+}
+
+void EncodeWebSocketFrame(WebSocketOpcode opcode, const uint8_t* payload, size_t size,
+                          uint32_t maskKey, std::vector<uint8_t>& outFrame) {
+    outFrame.push_back(FIN_BIT | static_cast<uint8_t>(opcode));
+
+    if (size < LENGTH_16) {
+        outFrame.push_back(MASK_BIT | static_cast<uint8_t>(size));
+    } else if (size <= 0xFFFF) {
+        outFrame.push_back(MASK_BIT | LENGTH_16);
+        outFrame.push_back(static_cast<uint8_t>(size >> 8));
+        outFrame.push_back(static_cast<uint8_t>(size));
+    } else {
+        outFrame.push_back(MASK_BIT | LENGTH_64);
+        for (int i = 7; i >= 0; --i) {
+            outFrame.push_back(static_cast<uint8_t>(static_cast<uint64_t>(size) >> (i * 8)));
+        }
+    }
+
+    const uint8_t mask[4] = {
+        static_cast<uint8_t>(maskKey >> 24), static_cast<uint8_t>(maskKey >> 16),
+        static_cast<uint8_t>(maskKey >> 8), static_cast<uint8_t>(maskKey)
+    };
+    outFrame.insert(outFrame.end(), mask, mask + 4);
+
+    const size_t start = outFrame.size();
+    outFrame.resize(start + size);
+    uint8_t* out = outFrame.data() + start;
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = payload[i] ^ mask[i & 3];
+    }
+}
+
+void WebSocketFrameParser::Feed(const uint8_t* data, size_t size) {
+    if (m_offset >= COMPACT_THRESHOLD) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+        m_offset = 0;
+    }
+    m_buffer.insert(m_buffer.end(), data, data + size);
+}
+
+bool WebSocketFrameParser::Next(WebSocketOpcode& outOpcode, std::vector<uint8_t>& outPayload) {
+    while (!m_error) {
+        const size_t available = m_buffer.size() - m_offset;
+        if (available < 2) {
+            return false;
+        }
+
+        const uint8_t* p = m_buffer.data() + m_offset;
+        const bool fin = (p[0] & FIN_BIT) != 0;
+        const WebSocketOpcode opcode = static_cast<WebSocketOpcode>(p[0] & OPCODE_MASK);
+        const bool masked = (p[1] & MASK_BIT) != 0;
+        uint64_t length = p[1] & 0x7F;
+
+        size_t header = 2;
+        if (length == LENGTH_16) {
+            if (available < 4) return false;
+            length = (uint64_t(p[2]) << 8) | p[3];
+            header = 4;
+        } else if (length == LENGTH_64) {
+            if (available < 10) return false;
+            length = 0;
+            for (int i = 0; i < 8; ++i) {
+                length = (length << 8) | p[2 + i];
+            }
+            header = 10;
+        }
+        const size_t maskOffset = header;
+        if (masked) {
+            header += 4;
+        }
+
+        // Sem extensões negociadas os bits RSV têm que ser 0
+        const bool control = IsControl(opcode);
+        if ((p[0] & RSV_BITS) != 0 || length > WEBSOCKET_MAX_MESSAGE_SIZE ||
+            (control && (!fin || length > MAX_CONTROL_PAYLOAD))) {
+            m_error = true;
+            return false;
+        }
+        if (available < header + length) {
+            return false;
+        }
+
+        const uint8_t* payload = p + header;
+        const size_t size = static_cast<size_t>(length);
+        m_offset += header + size;
+
+        std::vector<uint8_t>& target = control ? outPayload : m_message;
+        if (control) {
+            outPayload.clear();
+        } else if (opcode == WebSocketOpcode::CONTINUATION) {
+            if (!m_inMessage) {
+                m_error = true;
+                return false;
+            }
+        } else if (opcode == WebSocketOpcode::TEXT || opcode == WebSocketOpcode::BINARY) {
+            if (m_inMessage) {
+                m_error = true;         // Nova mensagem antes de terminar a anterior
+                return false;
+            }
+            m_message.clear();
+            m_messageOpcode = opcode;
+            m_inMessage = true;
+        } else {
+            m_error = true;             // Opcode reservado
+            return false;
+        }
+
+        if (target.size() + size > WEBSOCKET_MAX_MESSAGE_SIZE) {
+            m_error = true;
+            return false;
+        }
+
+        const size_t start = target.size();
+        target.insert(target.end(), payload, payload + size);
+        if (masked) {
+            const uint8_t* mask = p + maskOffset;
+            for (size_t i = 0; i < size; ++i) {
+                target[start + i] ^= mask[i & 3];
+            }
+        }
+
+        if (control) {
+            outOpcode = opcode;
+            return true;
+        }
+        if (fin) {
+            outOpcode = m_messageOpcode;
+            outPayload.swap(m_message);
+            m_message.clear();
+            m_inMessage = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebSocketFrameParser::Reset() {
+    m_buffer.clear();
+    m_offset = 0;
+    m_message.clear();
+    m_inMessage = false;
+    m_error = false;
+}
@@ -2,275 +2,709 @@
  * @file WebSocketSignalingClient.cpp
  * @brief Implementação do cliente de sinalização WebSocket
  *
- * Nota: Esta é uma implementação STUB usando websocketpp.
- * Para produção, você precisará:
- * 1. Instalar websocketpp via vcpkg:
- *    vcpkg install websocketpp:x64-windows
- * 2. Descomentadar includes e usar API real
+ * RFC 6455 direto sobre SocketCompat (WebSocketFrame.h) e JSON do SignalingCodec,
+ * sem websocketpp/nlohmann. Uma thread de IO por cliente: conecta, lê, envia a
+ * fila a cada tick e reconecta com backoff exponencial quando a conexão cai.
  *
  * @author Lucas D.
  * @date 2025-12-09
  */
 
 #include "WebSocketSignalingClient.h"
+#include "SocketCompat.h"
+#include "WebSocketFrame.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <iostream>
-#include <sstream>
-#include <thread>
-#include <nlohmann/json.hpp> // vcpkg install nlohmann-json:x64-windows
+#include <random>
 
-// Quando websocketpp estiver instalado, descomente:
-// #include <websocketpp/config/asio_client.hpp>
-// #include <websocketpp/client.hpp>
+namespace {
 
-using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+// Tick da thread de IO: a fila de envio e o lote de ICE saem uma vez por tick
+constexpr uint32_t SIGNALING_TICK_MS = 10;
+
+// Backoff de reconexão: 250 ms, 500 ms, ... até 10 s (com jitter de até -50%)
+constexpr uint32_t RECONNECT_INITIAL_MS = 250;
+constexpr uint32_t RECONNECT_MAX_MS = 10000;
+
+constexpr uint32_t CONNECT_TIMEOUT_MS = 5000;
+constexpr uint32_t SEND_TIMEOUT_MS = 2000;
+
+// Ping WebSocket para manter NATs/proxies abertos; sem nada recebido por
+// IDLE_TIMEOUT_MS a conexão é considerada morta (o servidor pinga a cada 30 s)
+constexpr uint32_t KEEPALIVE_INTERVAL_MS = 15000;
+constexpr uint32_t IDLE_TIMEOUT_MS = 45000;
+
+// Mensagens aguardando envio (SDP/controle); além disso Send* falha
+constexpr size_t MAX_SEND_QUEUE = 256;
+constexpr size_t MAX_PENDING_CANDIDATES = 512;
+
+constexpr size_t MAX_HANDSHAKE_RESPONSE = 8192;
+constexpr size_t RECEIVE_BUFFER_SIZE = 16 * 1024;
+
+// Close 1000 (normal)
+constexpr uint8_t CLOSE_NORMAL[2] = { 0x03, 0xE8 };
+
+double MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// > 0 pronto, 0 timeout, < 0 erro
+int WaitSocket(SOCKET socketHandle, bool forWrite, uint32_t timeoutMs) {
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(socketHandle, &set);
+
+    timeval timeout;
+    timeout.tv_sec = static_cast<long>(timeoutMs / 1000);
+    timeout.tv_usec = static_cast<long>((timeoutMs % 1000) * 1000);
+
+    return select(static_cast<int>(socketHandle) + 1, forWrite ? nullptr : &set,
+                  forWrite ? &set : nullptr, nullptr, &timeout);
+}
+
+} // namespace
 
 /**
  * @class WebSocketSignalingClient::Impl
- * @brief Implementação privada do cliente WebSocket
+ * @brief Thread de IO e estado compartilhado com a main loop
  */
 class WebSocketSignalingClient::Impl {
 public:
+    explicit Impl(WebSocketSignalingClient& owner)
+        : m_owner(owner), m_rng(std::random_device{}()) {}
+
+    ~Impl() {
+        Stop();
+    }
+
+    bool Start(const std::string& urlText);
+    void Stop();
+
+    bool IsRunning() const { return m_shouldRun; }
+    bool IsConnected() const { return m_connected; }
+
+    // Mensagem já codificada para a fila de envio
+    bool Enqueue(std::string message);
+
+    // Estado compartilhado com a main loop
+    mutable std::mutex stateMutex;
+    std::vector<SignalingMessage> pendingCandidates;
     std::string peerId;
+    std::string role;
     std::string sessionId;
+    std::string resumeSecret;               // Do register-ack; volta em cada re-registro
     std::string remotePeerId;
-    bool connected;
-    std::string url;
-    std::thread receiveThread;
-    bool shouldRun;
+    bool registerRequested = false;
+    bool registerPending = false;
+    SignalingStats stats;
+
+    MessageReceivedCallback callback;       // Só na thread de ProcessMessages
+
+private:
+    void Run();
+    bool OpenConnection();
+    bool ReadHandshakeResponse(const std::string& key);
+    void CloseConnection(bool sendClose);
+    bool SendBytes(const uint8_t* data, size_t size);
+    void AppendFrame(WebSocketOpcode opcode, const void* payload, size_t size);
+    bool FlushOutgoing();
+    bool ReadIncoming();
+    bool HandleMessage(const std::vector<uint8_t>& payload);
+    uint32_t NextBackoffMs();
+    uint32_t NextMaskKey();
+
+    WebSocketSignalingClient& m_owner;
+    WebSocketUrl m_url;
+    std::thread m_ioThread;
+    std::atomic<bool> m_shouldRun{ false };
+    std::atomic<bool> m_connected{ false };
+    std::deque<std::string> m_sendQueue;        // stateMutex
+
+    // Só na thread de IO
+    SOCKET m_socket = INVALID_SOCKET;
+    WebSocketFrameParser m_parser;
+    std::vector<uint8_t> m_frameBuffer;
+    std::vector<uint8_t> m_receiveBuffer;
+    std::vector<SignalingMessage> m_decoded;
+    std::minstd_rand m_rng;
+    uint32_t m_failures = 0;
+    bool m_everConnected = false;
+    bool m_awaitingRegisterAck = false;
+    Clock::time_point m_connectStart;
+    Clock::time_point m_lastReceive;
+    Clock::time_point m_lastPing;
+};
 
-    // Para versão real com websocketpp:
-    // websocketpp::client<websocketpp::config::asio_client> client;
-    // websocketpp::connection_hdl connectionHandle;
+bool WebSocketSignalingClient::Impl::Start(const std::string& urlText) {
+    if (!ParseWebSocketUrl(urlText, m_url)) {
+        std::cerr << "[WebSocket Error] URL invalida: " << urlText << std::endl;
+        return false;
+    }
+    if (m_url.secure) {
+        std::cerr << "[WebSocket Error] wss:// requer TLS; use ws:// (ou um proxy TLS na frente)" << std::endl;
+        return false;
+    }
+    if (!SocketStartup()) {
+        std::cerr << "[WebSocket Error] Falha ao inicializar sockets" << std::endl;
+        return false;
+    }
 
-    Impl() : connected(false), shouldRun(true) {}
+    m_shouldRun = true;
+    m_ioThread = std::thread(&Impl::Run, this);
+    return true;
+}
 
-    ~Impl() {
-        shouldRun = false;
-        if (receiveThread.joinable()) {
-            receiveThread.join();
-        }
+void WebSocketSignalingClient::Impl::Stop() {
+    if (!m_shouldRun.exchange(false)) {
+        return;
     }
-};
+    if (m_ioThread.joinable()) {
+        m_ioThread.join();
+    }
+    SocketCleanup();
+}
 
-WebSocketSignalingClient::WebSocketSignalingClient(const std::string& signalingServerUrl)
-    : m_pImpl(std::make_unique<Impl>()),
-      m_signalingServerUrl(signalingServerUrl) {
-    m_pImpl->url = signalingServerUrl;
+bool WebSocketSignalingClient::Impl::Enqueue(std::string message) {
+    if (!m_shouldRun) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (m_sendQueue.size() >= MAX_SEND_QUEUE) {
+        return false;
+    }
+    m_sendQueue.push_back(std::move(message));
+    return true;
 }
 
-WebSocketSignalingClient::~WebSocketSignalingClient() {
-    Disconnect();
+uint32_t WebSocketSignalingClient::Impl::NextBackoffMs() {
+    const uint32_t exponent = std::min<uint32_t>(m_failures, 16);
+    const uint32_t ceiling = std::min<uint64_t>(uint64_t(RECONNECT_INITIAL_MS) << exponent, RECONNECT_MAX_MS);
+    m_failures++;
+
+    // Jitter: metade fixa, metade aleatória (evita que os clientes voltem juntos)
+    return ceiling / 2 + static_cast<uint32_t>(m_rng() % (ceiling / 2 + 1));
 }
 
-bool WebSocketSignalingClient::Connect() {
-    if (m_pImpl->connected) {
-        return true;
+uint32_t WebSocketSignalingClient::Impl::NextMaskKey() {
+    return (static_cast<uint32_t>(m_rng()) << 16) ^ static_cast<uint32_t>(m_rng());
+}
+
+void WebSocketSignalingClient::Impl::Run() {
+    Clock::time_point nextAttempt = Clock::now();
+
+    while (m_shouldRun) {
+        if (m_socket == INVALID_SOCKET) {
+            if (Clock::now() < nextAttempt) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(SIGNALING_TICK_MS));
+                continue;
+            }
+            if (!OpenConnection()) {
+                nextAttempt = Clock::now() + std::chrono::milliseconds(NextBackoffMs());
+                continue;
+            }
+            m_failures = 0;
+        }
+
+        // Espera dados até o fim do tick; depois envia o que acumulou
+        const int ready = WaitSocket(m_socket, false, SIGNALING_TICK_MS);
+        bool ok = ready >= 0 && (ready == 0 || ReadIncoming());
+        ok = ok && FlushOutgoing();
+
+        const Clock::time_point now = Clock::now();
+        if (ok && now - m_lastReceive > std::chrono::milliseconds(IDLE_TIMEOUT_MS)) {
+            std::cerr << "[WebSocket] Sem resposta do servidor, reconectando" << std::endl;
+            ok = false;
+        } else if (ok && now - m_lastPing > std::chrono::milliseconds(KEEPALIVE_INTERVAL_MS)) {
+            m_frameBuffer.clear();
+            AppendFrame(WebSocketOpcode::PING, nullptr, 0);
+            ok = SendBytes(m_frameBuffer.data(), m_frameBuffer.size());
+            m_lastPing = now;
+        }
+
+        if (!ok) {
+            CloseConnection(false);
+            nextAttempt = Clock::now() + std::chrono::milliseconds(NextBackoffMs());
+        }
+    }
+
+    if (m_socket != INVALID_SOCKET) {
+        FlushOutgoing();
+        CloseConnection(true);
+    }
+}
+
+bool WebSocketSignalingClient::Impl::OpenConnection() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stats.connectAttempts++;
+    }
+    m_connectStart = Clock::now();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    const std::string port = std::to_string(m_url.port);
+    if (getaddrinfo(m_url.host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        if (m_failures == 0) {
+            std::cerr << "[WebSocket Error] Host nao resolvido: " << m_url.host << std::endl;
+        }
+        return false;
+    }
+
+    // Connect não bloqueante com timeout, tentando cada endereço (IPv6/IPv4)
+    for (addrinfo* address = addresses; address && m_socket == INVALID_SOCKET; address = address->ai_next) {
+        SOCKET candidate = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (candidate == INVALID_SOCKET) {
+            continue;
+        }
+
+        bool connected = SetSocketNonBlocking(candidate);
+        if (connected && connect(candidate, address->ai_addr, static_cast<int>(address->ai_addrlen)) != 0) {
+            connected = SocketConnectPending() && WaitSocket(candidate, true, CONNECT_TIMEOUT_MS) > 0;
+            if (connected) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                connected = getsockopt(candidate, SOL_SOCKET, SO_ERROR,
+                                       reinterpret_cast<char*>(&error), &length) == 0 && error == 0;
+            }
+        }
+
+        if (connected) {
+            m_socket = candidate;
+        } else {
+            closesocket(candidate);
+        }
     }
+    freeaddrinfo(addresses);
 
-    // Implementação real com websocketpp:
-    /*
-    try {
-        m_pImpl->client.init_asio();
-        m_pImpl->client.start_perpetual();
-        
-        // Callbacks
-        m_pImpl->client.set_open_handler([this](websocketpp::connection_hdl hdl) {
-            m_pImpl->connected = true;
-            std::cout << "[WebSocket] Conectado ao servidor de sinalização" << std::endl;
-        });
-        
-        m_pImpl->client.set_message_handler([this](websocketpp::connection_hdl hdl,
-                                                  websocketpp::client<websocketpp::config::asio_client>::message_ptr msg) {
-            ProcessSignalingMessage(msg->get_payload());
-        });
-        
-        m_pImpl->client.set_close_handler([this](websocketpp::connection_hdl hdl) {
-            m_pImpl->connected = false;
-            std::cout << "[WebSocket] Desconectado do servidor" << std::endl;
-        });
-        
-        websocketpp::lib::error_code ec;
-        auto con = m_pImpl->client.get_connection(m_pImpl->url, ec);
-        
-        if (ec) {
-            std::cerr << "[WebSocket Error] " << ec.message() << std::endl;
+    if (m_socket == INVALID_SOCKET) {
+        if (m_failures == 0) {
+            std::cerr << "[WebSocket Error] Falha ao conectar em " << m_url.host << ":" << m_url.port << std::endl;
+        }
+        return false;
+    }
+    SetSocketNoDelay(m_socket);
+
+    uint8_t nonce[16];
+    for (uint8_t& byte : nonce) {
+        byte = static_cast<uint8_t>(m_rng());
+    }
+    const std::string key = MakeWebSocketKey(nonce);
+    const std::string request = BuildWebSocketHandshake(m_url, key);
+
+    if (!SendBytes(reinterpret_cast<const uint8_t*>(request.data()), request.size()) ||
+        !ReadHandshakeResponse(key)) {
+        std::cerr << "[WebSocket Error] Handshake recusado por " << m_url.host << std::endl;
+        CloseConnection(false);
+        return false;
+    }
+
+    const double connectMs = MillisecondsSince(m_connectStart);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stats.lastConnectMs = connectMs;
+        if (m_everConnected) {
+            stats.reconnects++;
+        }
+        // Toda conexão nova começa pelo registro (o servidor esquece o peer ao cair)
+        registerPending = registerRequested;
+    }
+
+    m_everConnected = true;
+    m_awaitingRegisterAck = true;
+    m_lastReceive = m_lastPing = Clock::now();
+    m_connected = true;
+
+    std::cout << "[WebSocket] Conectado em " << m_url.host << ":" << m_url.port
+              << " (" << connectMs << " ms)" << std::endl;
+    return true;
+}
+
+bool WebSocketSignalingClient::Impl::ReadHandshakeResponse(const std::string& key) {
+    std::string response;
+    char buffer[1024];
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(CONNECT_TIMEOUT_MS);
+
+    size_t headerEnd = std::string::npos;
+    while (headerEnd == std::string::npos) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        if (remaining.count() <= 0 || response.size() > MAX_HANDSHAKE_RESPONSE ||
+            WaitSocket(m_socket, false, static_cast<uint32_t>(remaining.count())) <= 0) {
             return false;
         }
-        
-        m_pImpl->connectionHandle = con->get_handle();
-        m_pImpl->client.connect(con);
-        
-        // Processar em thread
-        m_pImpl->receiveThread = std::thread([this]() {
-            m_pImpl->client.run();
-        });
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "[WebSocket Error] " << e.what() << std::endl;
+
+        const int received = recv(m_socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return false;
+        }
+        response.append(buffer, static_cast<size_t>(received));
+        headerEnd = response.find("\r\n\r\n");
+    }
+
+    if (!ValidateWebSocketHandshake(response.substr(0, headerEnd + 2), key)) {
         return false;
     }
-    */
 
-    // STUB: Simular conexão
-    std::cout << "[WebSocket STUB] Conectando em " << m_pImpl->url << std::endl;
-    m_pImpl->connected = true;
+    // Frames que chegaram colados na resposta
+    m_parser.Reset();
+    const size_t bodyStart = headerEnd + 4;
+    if (bodyStart < response.size()) {
+        m_parser.Feed(reinterpret_cast<const uint8_t*>(response.data()) + bodyStart, response.size() - bodyStart);
+    }
     return true;
 }
 
-bool WebSocketSignalingClient::IsConnected() const {
-    return m_pImpl->connected;
+void WebSocketSignalingClient::Impl::CloseConnection(bool sendClose) {
+    if (m_socket == INVALID_SOCKET) {
+        return;
+    }
+
+    if (sendClose) {
+        m_frameBuffer.clear();
+        AppendFrame(WebSocketOpcode::CLOSE, CLOSE_NORMAL, sizeof(CLOSE_NORMAL));
+        SendBytes(m_frameBuffer.data(), m_frameBuffer.size());
+    }
+
+    closesocket(m_socket);
+    m_socket = INVALID_SOCKET;
+    m_connected = false;
+    m_parser.Reset();
 }
 
-bool WebSocketSignalingClient::SendRegister(const std::string& peerId,
-                                           const std::string& role,
-                                           const std::string& sessionId) {
-    if (!IsConnected()) {
+bool WebSocketSignalingClient::Impl::SendBytes(const uint8_t* data, size_t size) {
+    size_t sentTotal = 0;
+    while (sentTotal < size) {
+        const int sent = send(m_socket, reinterpret_cast<const char*>(data) + sentTotal,
+                              static_cast<int>(size - sentTotal), SOCKET_SEND_FLAGS);
+        if (sent > 0) {
+            sentTotal += static_cast<size_t>(sent);
+            continue;
+        }
+        // Buffer do kernel cheio: espera o socket drenar
+        if (sent == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK &&
+            WaitSocket(m_socket, true, SEND_TIMEOUT_MS) > 0) {
+            continue;
+        }
         return false;
     }
 
-    m_pImpl->peerId = peerId;
-    
-    if (role == "host") {
-        // Gerar session ID para host
-        m_pImpl->sessionId = peerId + "_" + std::to_string(
-            std::chrono::system_clock::now().time_since_epoch().count());
-    } else {
-        m_pImpl->sessionId = sessionId;
-    }
-
-    // Montar mensagem JSON
-    json msg;
-    msg["type"] = "register";
-    msg["peerId"] = peerId;
-    msg["role"] = role;
-    msg["sessionId"] = m_pImpl->sessionId;
-
-    std::string payload = msg.dump();
-
-    // Enviar em implementação real:
-    /*
-    try {
-        m_pImpl->client.send(m_pImpl->connectionHandle, payload,
-                           websocketpp::frame::opcode::text);
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stats.bytesSent += size;
+    return true;
+}
+
+void WebSocketSignalingClient::Impl::AppendFrame(WebSocketOpcode opcode, const void* payload, size_t size) {
+    EncodeWebSocketFrame(opcode, static_cast<const uint8_t*>(payload), size, NextMaskKey(), m_frameBuffer);
+}
+
+bool WebSocketSignalingClient::Impl::FlushOutgoing() {
+    std::string registerMessage;
+    std::deque<std::string> messages;
+    std::vector<SignalingMessage> candidates;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (registerPending) {
+            SignalingMessage message;
+            message.type = SignalingMessage::REGISTER;
+            message.peerId = peerId;
+            message.role = role;
+            message.sessionId = sessionId;      // Reconexão retoma a mesma sessão...
+            message.resumeSecret = resumeSecret; // ...provando que é o mesmo peer
+            registerMessage = EncodeSignalingMessage(message);
+            registerPending = false;
+        }
+        messages.swap(m_sendQueue);
+        candidates.swap(pendingCandidates);
+    }
+
+    // Candidatos do tick: um "ice-candidates" por destinatário consecutivo
+    uint64_t batches = 0;
+    for (size_t begin = 0; begin < candidates.size(); ++batches) {
+        size_t end = begin + 1;
+        while (end < candidates.size() && candidates[end].remotePeerId == candidates[begin].remotePeerId) {
+            ++end;
+        }
+        messages.push_back(EncodeIceCandidateBatch(candidates.data() + begin, end - begin));
+        begin = end;
+    }
+
+    if (registerMessage.empty() && messages.empty()) {
         return true;
-    } catch (const std::exception& e) {
-        std::cerr << "[WebSocket Error] " << e.what() << std::endl;
+    }
+
+    // Tudo em um send: o registro na frente, depois a fila na ordem
+    m_frameBuffer.clear();
+    if (!registerMessage.empty()) {
+        AppendFrame(WebSocketOpcode::TEXT, registerMessage.data(), registerMessage.size());
+    }
+    for (const std::string& message : messages) {
+        AppendFrame(WebSocketOpcode::TEXT, message.data(), message.size());
+    }
+
+    if (!SendBytes(m_frameBuffer.data(), m_frameBuffer.size())) {
+        // Devolve para a próxima conexão (o registro é refeito de qualquer forma)
+        std::lock_guard<std::mutex> lock(stateMutex);
+        m_sendQueue.insert(m_sendQueue.begin(), messages.begin(), messages.end());
         return false;
     }
-    */
 
-    std::cout << "[WebSocket STUB] Register enviado para peer: " << peerId 
-              << " (role: " << role << ")" << std::endl;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stats.messagesSent += messages.size() + (registerMessage.empty() ? 0 : 1);
+    stats.iceCandidatesSent += candidates.size();
+    stats.iceBatchesSent += batches;
     return true;
 }
 
-bool WebSocketSignalingClient::SendOffer(const std::string& peerId,
-                                        const std::string& sdpOffer) {
-    if (!IsConnected()) {
+bool WebSocketSignalingClient::Impl::ReadIncoming() {
+    m_receiveBuffer.resize(RECEIVE_BUFFER_SIZE);
+
+    size_t receivedTotal = 0;
+    for (;;) {
+        const int received = recv(m_socket, reinterpret_cast<char*>(m_receiveBuffer.data()),
+                                  static_cast<int>(m_receiveBuffer.size()), 0);
+        if (received > 0) {
+            m_parser.Feed(m_receiveBuffer.data(), static_cast<size_t>(received));
+            receivedTotal += static_cast<size_t>(received);
+            continue;
+        }
+        if (received == 0) {
+            std::cout << "[WebSocket] Conexao fechada pelo servidor" << std::endl;
+            return false;
+        }
+        if (WSAGetLastError() == WSAEWOULDBLOCK) {
+            break;
+        }
         return false;
     }
 
-    json msg;
-    msg["type"] = "offer";
-    msg["peerId"] = m_pImpl->peerId;
-    msg["remotePeerId"] = peerId;
-    msg["sessionId"] = m_pImpl->sessionId;
-    msg["data"]["sdp"] = sdpOffer;
+    if (receivedTotal > 0) {
+        m_lastReceive = Clock::now();
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stats.bytesReceived += receivedTotal;
+    }
 
-    std::string payload = msg.dump();
+    WebSocketOpcode opcode;
+    std::vector<uint8_t> payload;
+    while (m_parser.Next(opcode, payload)) {
+        switch (opcode) {
+            case WebSocketOpcode::TEXT:
+            case WebSocketOpcode::BINARY:
+                if (!HandleMessage(payload)) {
+                    CloseConnection(true);
+                    return false;
+                }
+                break;
+            case WebSocketOpcode::PING:
+                m_frameBuffer.clear();
+                AppendFrame(WebSocketOpcode::PONG, payload.data(), payload.size());
+                if (!SendBytes(m_frameBuffer.data(), m_frameBuffer.size())) {
+                    return false;
+                }
+                break;
+            case WebSocketOpcode::CLOSE:
+                CloseConnection(true);
+                return false;
+            default:
+                break;
+        }
+    }
 
-    // Enviar em implementação real
-    std::cout << "[WebSocket STUB] Offer enviado (" << sdpOffer.size() << " bytes)" << std::endl;
+    if (m_parser.HasError()) {
+        std::cerr << "[WebSocket Error] Frame invalido do servidor" << std::endl;
+        return false;
+    }
     return true;
 }
 
-bool WebSocketSignalingClient::SendAnswer(const std::string& peerId,
-                                         const std::string& sdpAnswer) {
-    if (!IsConnected()) {
-        return false;
+bool WebSocketSignalingClient::Impl::HandleMessage(const std::vector<uint8_t>& payload) {
+    m_decoded.clear();
+    if (!DecodeSignalingMessage(reinterpret_cast<const char*>(payload.data()), payload.size(), m_decoded)) {
+        std::cerr << "[WebSocket] Mensagem ignorada (JSON invalido ou tipo desconhecido)" << std::endl;
+        return true;
     }
 
-    json msg;
-    msg["type"] = "answer";
-    msg["peerId"] = m_pImpl->peerId;
-    msg["remotePeerId"] = peerId;
-    msg["sessionId"] = m_pImpl->sessionId;
-    msg["data"]["sdp"] = sdpAnswer;
+    bool registerRejected = false;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stats.messagesReceived++;
+
+        for (const SignalingMessage& message : m_decoded) {
+            if (message.type == SignalingMessage::REGISTER_ACK) {
+                sessionId = message.sessionId;
+                resumeSecret = message.resumeSecret;
+                if (!message.remotePeerId.empty()) {
+                    remotePeerId = message.remotePeerId;
+                }
+                if (m_awaitingRegisterAck) {
+                    stats.lastRegisterMs = MillisecondsSince(m_connectStart);
+                    m_awaitingRegisterAck = false;
+                }
+            } else if (message.type == SignalingMessage::PEER_CONNECTED) {
+                remotePeerId = message.remotePeerId;
+            } else if (message.type == SignalingMessage::SERVER_ERROR) {
+                std::cerr << "[WebSocket] Erro do servidor: " << message.errorMessage << std::endl;
+                registerRejected = m_awaitingRegisterAck && registerRequested;
+            }
+        }
+    }
 
-    std::string payload = msg.dump();
+    {
+        std::lock_guard<std::mutex> lock(m_owner.m_queueMutex);
+        for (SignalingMessage& message : m_decoded) {
+            m_owner.m_messageQueue.push(std::move(message));
+        }
+    }
+
+    // Registro recusado (ex: guest voltou antes do host após o servidor reiniciar):
+    // derruba a conexão e deixa o backoff tentar de novo
+    return !registerRejected;
+}
+
+WebSocketSignalingClient::WebSocketSignalingClient(const std::string& signalingServerUrl)
+    : m_pImpl(std::make_unique<Impl>(*this)),
+      m_signalingServerUrl(signalingServerUrl) {
+}
+
+WebSocketSignalingClient::~WebSocketSignalingClient() {
+    Disconnect();
+}
+
+bool WebSocketSignalingClient::Connect() {
+    if (m_pImpl->IsRunning()) {
+        return true;
+    }
+    return m_pImpl->Start(m_signalingServerUrl);
+}
+
+bool WebSocketSignalingClient::IsConnected() const {
+    return m_pImpl->IsConnected();
+}
+
+bool WebSocketSignalingClient::SendRegister(const std::string& peerId,
+                                           const std::string& role,
+                                           const std::string& sessionId) {
+    if (!m_pImpl->IsRunning()) {
+        return false;
+    }
 
-    std::cout << "[WebSocket STUB] Answer enviado (" << sdpAnswer.size() << " bytes)" << std::endl;
+    // Sai na frente da fila no próximo tick e de novo a cada reconexão
+    std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
+    m_pImpl->peerId = peerId;
+    m_pImpl->role = role;
+    m_pImpl->sessionId = sessionId;     // Host: vazio = sessão nova (o servidor gera o ID)
+    m_pImpl->resumeSecret.clear();      // Registro novo: o segredo vem no próximo register-ack
+    m_pImpl->registerRequested = true;
+    m_pImpl->registerPending = true;
     return true;
 }
 
+bool WebSocketSignalingClient::SendOffer(const std::string& peerId,
+                                        const std::string& sdpOffer) {
+    SignalingMessage message;
+    message.type = SignalingMessage::OFFER;
+    message.remotePeerId = peerId;
+    message.sdpOffer = sdpOffer;
+    {
+        std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
+        message.peerId = m_pImpl->peerId;
+        message.sessionId = m_pImpl->sessionId;
+    }
+    return m_pImpl->Enqueue(EncodeSignalingMessage(message));
+}
+
+bool WebSocketSignalingClient::SendAnswer(const std::string& peerId,
+                                         const std::string& sdpAnswer) {
+    SignalingMessage message;
+    message.type = SignalingMessage::ANSWER;
+    message.remotePeerId = peerId;
+    message.sdpAnswer = sdpAnswer;
+    {
+        std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
+        message.peerId = m_pImpl->peerId;
+        message.sessionId = m_pImpl->sessionId;
+    }
+    return m_pImpl->Enqueue(EncodeSignalingMessage(message));
+}
+
 bool WebSocketSignalingClient::SendIceCandidate(const std::string& peerId,
                                                const std::string& candidate,
                                                const std::string& sdpMLineIndex,
                                                const std::string& sdpMid) {
-    if (!IsConnected()) {
+    if (!m_pImpl->IsRunning()) {
         return false;
     }
 
-    json msg;
-    msg["type"] = "ice-candidate";
-    msg["peerId"] = m_pImpl->peerId;
-    msg["remotePeerId"] = peerId;
-    msg["sessionId"] = m_pImpl->sessionId;
-    msg["data"]["candidate"] = candidate;
-    msg["data"]["sdpMLineIndex"] = sdpMLineIndex;
-    msg["data"]["sdpMid"] = sdpMid;
-
-    std::string payload = msg.dump();
+    // Acumula até o próximo tick da thread de IO (trickle ICE em lote)
+    std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
+    if (m_pImpl->pendingCandidates.size() >= MAX_PENDING_CANDIDATES) {
+        return false;
+    }
 
-    std::cout << "[WebSocket STUB] ICE candidate enviado" << std::endl;
+    SignalingMessage message;
+    message.type = SignalingMessage::ICE_CANDIDATE;
+    message.peerId = m_pImpl->peerId;
+    message.remotePeerId = peerId;
+    message.sessionId = m_pImpl->sessionId;
+    message.iceCandidate = candidate;
+    message.sdpMLineIndex = sdpMLineIndex;
+    message.sdpMid = sdpMid;
+    m_pImpl->pendingCandidates.push_back(std::move(message));
     return true;
 }
 
 void WebSocketSignalingClient::SetMessageReceivedCallback(
     MessageReceivedCallback callback) {
-    // Armazenar callback para uso em receiveThread
-    (void)callback;
+    m_pImpl->callback = std::move(callback);
 }
 
 void WebSocketSignalingClient::ProcessMessages() {
-    // Processar fila de mensagens recebidas
-    std::lock_guard<std::mutex> lock(m_queueMutex);
-    
-    while (!m_messageQueue.empty()) {
-        auto msg = m_messageQueue.front();
-        m_messageQueue.pop();
-        
-        std::cout << "[WebSocket] Mensagem processada: " << msg.type << std::endl;
+    // Esvazia a fila sob o lock e chama o callback fora dele
+    std::queue<SignalingMessage> messages;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        messages.swap(m_messageQueue);
+    }
+
+    while (!messages.empty()) {
+        if (m_pImpl->callback) {
+            m_pImpl->callback(messages.front());
+        }
+        messages.pop();
     }
 }
 
 void WebSocketSignalingClient::Disconnect() {
-    if (!m_pImpl->connected) {
+    if (!m_pImpl->IsRunning()) {
         return;
     }
 
-    // Implementação real:
-    /*
-    try {
-        m_pImpl->client.stop_perpetual();
-        m_pImpl->client.close(m_pImpl->connectionHandle,
-                            websocketpp::close::status::going_away, "");
-        m_pImpl->client.stop();
-        m_pImpl->connected = false;
-    } catch (const std::exception& e) {
-        std::cerr << "[WebSocket Error] " << e.what() << std::endl;
-    }
-    */
-
-    m_pImpl->connected = false;
+    // A thread de IO envia o que restou na fila e o close frame antes de sair
+    m_pImpl->Stop();
     std::cout << "[WebSocket] Desconectado" << std::endl;
 }
 
 std::string WebSocketSignalingClient::GetSessionId() const {
+    std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
     return m_pImpl->sessionId;
 }
 
 std::string WebSocketSignalingClient::GetRemotePeerId() const {
+    std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
     return m_pImpl->remotePeerId;
 }
+
+WebSocketSignalingClient::SignalingStats WebSocketSignalingClient::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_pImpl->stateMutex);
+    return m_pImpl->stats;
+}
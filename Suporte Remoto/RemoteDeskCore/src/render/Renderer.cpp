@@ -1,8 +1,97 @@
 #include "Renderer.h"
+#include "Trace.h"
+#include "FrameUtils.h"
+#include "CursorProtocol.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <stdexcept>
 
+namespace {
+
+constexpr int32_t WHEEL_STEP = 120;     // WHEEL_DELTA do Windows
+
+uint64_t InputTimestampUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Posição física da tecla (scancode) → VK_* do layout US; 0 = não mapeada
+uint16_t ScancodeToVirtualKey(SDL_Scancode scancode) {
+    if (scancode >= SDL_SCANCODE_A && scancode <= SDL_SCANCODE_Z) {
+        return static_cast<uint16_t>('A' + (scancode - SDL_SCANCODE_A));
+    }
+    if (scancode >= SDL_SCANCODE_1 && scancode <= SDL_SCANCODE_9) {
+        return static_cast<uint16_t>('1' + (scancode - SDL_SCANCODE_1));
+    }
+    if (scancode >= SDL_SCANCODE_F1 && scancode <= SDL_SCANCODE_F12) {
+        return static_cast<uint16_t>(0x70 + (scancode - SDL_SCANCODE_F1));    // VK_F1
+    }
+    if (scancode >= SDL_SCANCODE_F13 && scancode <= SDL_SCANCODE_F24) {
+        return static_cast<uint16_t>(0x7C + (scancode - SDL_SCANCODE_F13));   // VK_F13
+    }
+    if (scancode >= SDL_SCANCODE_KP_1 && scancode <= SDL_SCANCODE_KP_9) {
+        return static_cast<uint16_t>(0x61 + (scancode - SDL_SCANCODE_KP_1));  // VK_NUMPAD1
+    }
+
+    switch (scancode) {
+        case SDL_SCANCODE_0:            return '0';
+        case SDL_SCANCODE_RETURN:       return 0x0D;    // VK_RETURN
+        case SDL_SCANCODE_KP_ENTER:     return 0x0D;
+        case SDL_SCANCODE_BACKSPACE:    return 0x08;    // VK_BACK
+        case SDL_SCANCODE_TAB:          return 0x09;    // VK_TAB
+        case SDL_SCANCODE_SPACE:        return 0x20;    // VK_SPACE
+        case SDL_SCANCODE_PAUSE:        return 0x13;    // VK_PAUSE
+        case SDL_SCANCODE_CAPSLOCK:     return 0x14;    // VK_CAPITAL
+        case SDL_SCANCODE_PAGEUP:       return 0x21;    // VK_PRIOR
+        case SDL_SCANCODE_PAGEDOWN:     return 0x22;    // VK_NEXT
+        case SDL_SCANCODE_END:          return 0x23;    // VK_END
+        case SDL_SCANCODE_HOME:         return 0x24;    // VK_HOME
+        case SDL_SCANCODE_LEFT:         return 0x25;    // VK_LEFT
+        case SDL_SCANCODE_UP:           return 0x26;    // VK_UP
+        case SDL_SCANCODE_RIGHT:        return 0x27;    // VK_RIGHT
+        case SDL_SCANCODE_DOWN:         return 0x28;    // VK_DOWN
+        case SDL_SCANCODE_PRINTSCREEN:  return 0x2C;    // VK_SNAPSHOT
+        case SDL_SCANCODE_INSERT:       return 0x2D;    // VK_INSERT
+        case SDL_SCANCODE_DELETE:       return 0x2E;    // VK_DELETE
+        case SDL_SCANCODE_LGUI:         return 0x5B;    // VK_LWIN
+        case SDL_SCANCODE_RGUI:         return 0x5C;    // VK_RWIN
+        case SDL_SCANCODE_APPLICATION:  return 0x5D;    // VK_APPS
+        case SDL_SCANCODE_KP_0:         return 0x60;    // VK_NUMPAD0
+        case SDL_SCANCODE_KP_MULTIPLY:  return 0x6A;    // VK_MULTIPLY
+        case SDL_SCANCODE_KP_PLUS:      return 0x6B;    // VK_ADD
+        case SDL_SCANCODE_KP_MINUS:     return 0x6D;    // VK_SUBTRACT
+        case SDL_SCANCODE_KP_PERIOD:    return 0x6E;    // VK_DECIMAL
+        case SDL_SCANCODE_KP_DIVIDE:    return 0x6F;    // VK_DIVIDE
+        case SDL_SCANCODE_NUMLOCKCLEAR: return 0x90;    // VK_NUMLOCK
+        case SDL_SCANCODE_SCROLLLOCK:   return 0x91;    // VK_SCROLL
+        case SDL_SCANCODE_LSHIFT:       return 0xA0;    // VK_LSHIFT
+        case SDL_SCANCODE_RSHIFT:       return 0xA1;    // VK_RSHIFT
+        case SDL_SCANCODE_LCTRL:        return 0xA2;    // VK_LCONTROL
+        case SDL_SCANCODE_RCTRL:        return 0xA3;    // VK_RCONTROL
+        case SDL_SCANCODE_LALT:         return 0xA4;    // VK_LMENU
+        case SDL_SCANCODE_RALT:         return 0xA5;    // VK_RMENU (AltGr)
+        case SDL_SCANCODE_SEMICOLON:    return 0xBA;    // VK_OEM_1 (ç no ABNT2)
+        case SDL_SCANCODE_EQUALS:       return 0xBB;    // VK_OEM_PLUS
+        case SDL_SCANCODE_COMMA:        return 0xBC;    // VK_OEM_COMMA
+        case SDL_SCANCODE_MINUS:        return 0xBD;    // VK_OEM_MINUS
+        case SDL_SCANCODE_PERIOD:       return 0xBE;    // VK_OEM_PERIOD
+        case SDL_SCANCODE_SLASH:        return 0xBF;    // VK_OEM_2
+        case SDL_SCANCODE_GRAVE:        return 0xC0;    // VK_OEM_3
+        case SDL_SCANCODE_LEFTBRACKET:  return 0xDB;    // VK_OEM_4
+        case SDL_SCANCODE_BACKSLASH:    return 0xDC;    // VK_OEM_5
+        case SDL_SCANCODE_RIGHTBRACKET: return 0xDD;    // VK_OEM_6
+        case SDL_SCANCODE_APOSTROPHE:   return 0xDE;    // VK_OEM_7
+        case SDL_SCANCODE_NONUSBACKSLASH: return 0xE2;  // VK_OEM_102
+        case SDL_SCANCODE_INTERNATIONAL1: return 0xC1;  // VK_ABNT_C1 (/ do ABNT2)
+        case SDL_SCANCODE_KP_COMMA:     return 0xC2;    // VK_ABNT_C2 (. do teclado numérico ABNT2)
+        default:                        return 0;
+    }
+}
+
+} // namespace
+
 Renderer::Renderer() 
     : m_window(nullptr), m_renderer(nullptr), m_texture(nullptr), 
       m_windowWidth(0), m_windowHeight(0), m_isRunning(false) {
@@ -96,6 +185,10 @@ bool Renderer::CreateTextureIfNeeded(uint32_t width, uint32_t height) {
         return false;
     }
 
+    // Frames reduzidos pelo ABR (degraus de resolução) voltam ao tamanho da
+    // janela no SDL_RenderCopy; filtro linear em vez de nearest
+    SDL_SetTextureScaleMode(m_texture, SDL_ScaleModeLinear);
+
     m_textureWidth = width;
     m_textureHeight = height;
 
@@ -103,6 +196,8 @@ bool Renderer::CreateTextureIfNeeded(uint32_t width, uint32_t height) {
 }
 
 bool Renderer::UpdateFrame(const uint8_t* pixelData, uint32_t width, uint32_t height, uint32_t stride) {
+    RDC_TRACE_SCOPE("Renderer::UpdateFrame");
+
     if (!m_renderer || !pixelData) {
         return false;
     }
@@ -126,14 +221,10 @@ bool Renderer::UpdateFrame(const uint8_t* pixelData, uint32_t width, uint32_t he
 
     // Copiar dados de pixels
     // Como ambos são BGRA de 32 bits, podemos copiar diretamente
-    uint8_t* dstData = static_cast<uint8_t*>(pixels);
-    for (uint32_t y = 0; y < height; ++y) {
-        std::memcpy(
-            dstData + (y * pitch),
-            pixelData + (y * stride),
-            width * 4  // 4 bytes por pixel (BGRA)
-        );
-    }
+    CopyFrameRows(static_cast<uint8_t*>(pixels), static_cast<size_t>(pitch),
+                  pixelData, stride,
+                  static_cast<size_t>(width) * 4,  // 4 bytes por pixel (BGRA)
+                  height);
 
     SDL_UnlockTexture(m_texture);
 
@@ -141,6 +232,8 @@ bool Renderer::UpdateFrame(const uint8_t* pixelData, uint32_t width, uint32_t he
 }
 
 bool Renderer::RenderFrame() {
+    RDC_TRACE_SCOPE("Renderer::RenderFrame");
+
     if (!m_renderer || !m_texture) {
         return false;
     }
@@ -160,12 +253,72 @@ bool Renderer::RenderFrame() {
         return false;
     }
 
+    // Cursor por cima do frame, na escala da janela
+    if (m_cursorTexture && m_cursorVisible && m_cursorSourceWidth && m_cursorSourceHeight) {
+        const float scaleX = static_cast<float>(m_windowWidth) / m_cursorSourceWidth;
+        const float scaleY = static_cast<float>(m_windowHeight) / m_cursorSourceHeight;
+
+        SDL_Rect cursorDst = {
+            static_cast<int>((m_cursorX - m_cursorHotspotX) * scaleX),
+            static_cast<int>((m_cursorY - m_cursorHotspotY) * scaleY),
+            static_cast<int>(m_cursorWidth * scaleX + 0.5f),
+            static_cast<int>(m_cursorHeight * scaleY + 0.5f)
+        };
+        SDL_RenderCopy(m_renderer, m_cursorTexture, nullptr, &cursorDst);
+    }
+
     // Apresentar frame na tela
     SDL_RenderPresent(m_renderer);
 
     return true;
 }
 
+bool Renderer::SetCursorShape(const CursorShape& shape) {
+    if (!m_renderer || shape.width == 0 || shape.height == 0) {
+        return false;
+    }
+
+    if (!m_cursorTexture || m_cursorWidth != shape.width || m_cursorHeight != shape.height) {
+        if (m_cursorTexture) {
+            SDL_DestroyTexture(m_cursorTexture);
+        }
+
+        m_cursorTexture = SDL_CreateTexture(
+            m_renderer,
+            SDL_PIXELFORMAT_ARGB8888,  // BGRA com alpha
+            SDL_TEXTUREACCESS_STATIC,
+            shape.width,
+            shape.height
+        );
+
+        if (!m_cursorTexture) {
+            OutputDebugStringA("SDL_CreateTexture (cursor) failed: ");
+            OutputDebugStringA(SDL_GetError());
+            OutputDebugStringA("\n");
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(m_cursorTexture, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_UpdateTexture(m_cursorTexture, nullptr, shape.pixels.data(), static_cast<int>(shape.width * 4));
+
+    m_cursorWidth = shape.width;
+    m_cursorHeight = shape.height;
+    m_cursorHotspotX = shape.hotspotX;
+    m_cursorHotspotY = shape.hotspotY;
+    return true;
+}
+
+void Renderer::SetCursorPosition(int32_t x, int32_t y, bool visible,
+                                 uint32_t sourceWidth, uint32_t sourceHeight) {
+    m_cursorX = x;
+    m_cursorY = y;
+    m_cursorVisible = visible;
+    m_cursorSourceWidth = sourceWidth;
+    m_cursorSourceHeight = sourceHeight;
+}
+
 bool Renderer::ProcessEvents() {
     SDL_Event event;
 
@@ -198,6 +351,51 @@ bool Renderer::ProcessEvents() {
                 m_isRunning = false;
                 return false;
             }
+            [[fallthrough]];
+
+        case SDL_KEYUP:
+            if (m_captureInput) {
+                uint16_t virtualKey = ScancodeToVirtualKey(event.key.keysym.scancode);
+                if (virtualKey != 0) {
+                    m_inputEvents.push_back(InputEvent::Key(
+                        virtualKey, event.type == SDL_KEYDOWN, InputTimestampUs()));
+                }
+            }
+            break;
+
+        case SDL_MOUSEMOTION:
+            if (m_captureInput && m_windowWidth > 1 && m_windowHeight > 1) {
+                // O frame ocupa a janela inteira: janela → 0..65535
+                int32_t x = static_cast<int32_t>(
+                    static_cast<int64_t>(event.motion.x) * INPUT_COORD_MAX / (m_windowWidth - 1));
+                int32_t y = static_cast<int32_t>(
+                    static_cast<int64_t>(event.motion.y) * INPUT_COORD_MAX / (m_windowHeight - 1));
+                m_inputEvents.push_back(InputEvent::MouseMove(x, y, InputTimestampUs()));
+            }
+            break;
+
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            if (m_captureInput) {
+                InputMouseButton button;
+                switch (event.button.button) {
+                    case SDL_BUTTON_LEFT:   button = InputMouseButton::LEFT; break;
+                    case SDL_BUTTON_RIGHT:  button = InputMouseButton::RIGHT; break;
+                    case SDL_BUTTON_MIDDLE: button = InputMouseButton::MIDDLE; break;
+                    case SDL_BUTTON_X1:     button = InputMouseButton::X1; break;
+                    case SDL_BUTTON_X2:     button = InputMouseButton::X2; break;
+                    default: continue;
+                }
+                m_inputEvents.push_back(InputEvent::MouseButton(
+                    button, event.type == SDL_MOUSEBUTTONDOWN, InputTimestampUs()));
+            }
+            break;
+
+        case SDL_MOUSEWHEEL:
+            if (m_captureInput && event.wheel.y != 0) {
+                int32_t steps = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+                m_inputEvents.push_back(InputEvent::MouseWheel(steps * WHEEL_STEP, InputTimestampUs()));
+            }
             break;
 
         default:
@@ -208,6 +406,11 @@ bool Renderer::ProcessEvents() {
     return true;
 }
 
+void Renderer::TakeInputEvents(std::vector<InputEvent>& outEvents) {
+    outEvents.clear();
+    outEvents.swap(m_inputEvents);
+}
+
 void Renderer::SetWindowTitle(const std::string& title) {
     if (m_window) {
         SDL_SetWindowTitle(m_window, title.c_str());
@@ -215,6 +418,11 @@ void Renderer::SetWindowTitle(const std::string& title) {
 }
 
 void Renderer::Release() {
+    if (m_cursorTexture) {
+        SDL_DestroyTexture(m_cursorTexture);
+        m_cursorTexture = nullptr;
+    }
+
     if (m_texture) {
         SDL_DestroyTexture(m_texture);
         m_texture = nullptr;
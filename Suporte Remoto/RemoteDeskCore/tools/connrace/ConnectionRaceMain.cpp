@@ -0,0 +1,1073 @@
+/**
+ * @file ConnectionRaceMain.cpp
+ * @brief rdc_connrace: tempo até o primeiro frame (TTFF) com abertura sequencial vs. em paralelo
+ *
+ * Sobe em processo um servidor de sinalização substituto (o protocolo do
+ * signaling-server.js sobre WebSocket, em 127.0.0.1) que atrasa tudo que envia em
+ * --signal-rtt-ms, no papel de um servidor distante. Host e guest rodam em threads
+ * e o host manda frames sintéticos a 60 fps assim que tem um transporte.
+ *
+ * - sequencial: registro → oferta → resposta, cada lado esperando a coleta completa
+ *   (--gather-ms, ICE sem trickle: srflx/relay no SDP) antes de mandar a descrição;
+ *   checagem de conectividade só depois da troca
+ * - corrida: SessionConnector nos dois lados (candidatos LAN no registro, trickle,
+ *   probe de transporte por caminho, nomeação pelo guest)
+ *
+ * Os dois usam o caminho UDP direto de verdade (P2PManager). O data channel WebRTC
+ * desta árvore é um stub e nunca conecta, então a coleta srflx/relay entra só como
+ * tempo modelado no sequencial; na corrida ela não bloqueia nada.
+ *
+ * TTFF = guest inicia (host já registrado) → primeiro FRAME no guest.
+ *
+ * --resume: queda curta depois de conectado (SessionResume.h). Com a sessão estável
+ * (frames de 120x90 em que só um bloco pequeno muda), o guest fica --blip-ms sem ler
+ * nem enviar e volta com um socket novo (porta nova, como depois de trocar de rede).
+ * - retomada: SESSION_RESUME pelo último endereço do host; primeiro frame = delta de tiles
+ * - renegociação: o host desiste do guest depois de 1 s de silêncio e registra uma
+ *   sessão nova; o guest refaz a corrida do SessionConnector; primeiro frame completo
+ * Mede fim da queda → primeiro frame apresentado, e o tamanho desse frame.
+ */
+
+#include "P2PManager.h"
+#include "SessionConnector.h"
+#include "SessionResume.h"
+#include "SignalingCodec.h"
+#include "SocketCompat.h"
+#include "WebRTCDataChannel.h"
+#include "WebSocketFrame.h"
+#include "WebSocketSignalingClient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t FRAME_WIDTH = 64;
+constexpr uint32_t FRAME_HEIGHT = 36;
+constexpr auto FRAME_INTERVAL = std::chrono::microseconds(16667);
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1);
+constexpr auto RUN_TIMEOUT = std::chrono::seconds(10);
+constexpr const char* LAN_CANDIDATE_MID = "rdc-udp";
+
+// Retomada: frame pequeno com tiles de 16 (48 tiles), um bloco 10x10 se movendo
+constexpr uint32_t RESUME_FRAME_WIDTH = 120;
+constexpr uint32_t RESUME_FRAME_HEIGHT = 90;
+constexpr uint32_t RESUME_TILE_SIZE = 16;
+constexpr uint32_t RESUME_BLOCK_SIZE = 10;
+constexpr uint32_t RESUME_SILENCE_MS = 1000;       // Guest: queda detectada; host (renegociação): guest perdido
+constexpr uint32_t RESUME_RETRY_MS = 250;
+constexpr uint32_t RESUME_GRACE_MS = 10000;
+constexpr auto RESUME_STEADY_DURATION = std::chrono::seconds(1);
+constexpr auto RESUME_TOKEN_INTERVAL = std::chrono::seconds(1);
+
+struct RaceOptions {
+    uint32_t signalRttMs = 40;
+    uint32_t gatherMs = 300;
+    uint32_t runs = 5;
+    bool resume = false;
+    uint32_t blipMs = 2000;
+};
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string MakePeerId(const char* prefix, uint32_t run) {
+    return std::string(prefix) + "-" + std::to_string(run) + "-" +
+           std::to_string(Clock::now().time_since_epoch().count() % 1000000);
+}
+
+// Frame do servidor: FIN, sem máscara (RFC 6455 §5.1)
+void EncodeServerFrame(WebSocketOpcode opcode, const std::string& payload, std::vector<uint8_t>& out) {
+    out.push_back(static_cast<uint8_t>(0x80 | static_cast<uint8_t>(opcode)));
+    size_t size = payload.size();
+    if (size < 126) {
+        out.push_back(static_cast<uint8_t>(size));
+    } else if (size <= 0xFFFF) {
+        out.push_back(126);
+        out.push_back(static_cast<uint8_t>(size >> 8));
+        out.push_back(static_cast<uint8_t>(size));
+    } else {
+        out.push_back(127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(size) >> shift));
+        }
+    }
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+/**
+ * @class StandInSignalingServer
+ * @brief register/relay/ping do signaling-server.js, com atraso fixo em tudo que sai
+ */
+class StandInSignalingServer {
+public:
+    ~StandInSignalingServer() { Stop(); }
+
+    bool Start(uint32_t rttMs) {
+        m_delay = std::chrono::milliseconds(rttMs);
+        if (!SocketStartup()) {
+            return false;
+        }
+
+        m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (m_listenSocket == INVALID_SOCKET) {
+            return false;
+        }
+        int reuse = 1;
+        setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = 0;
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        socklen_t addressLen = sizeof(address);
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+            listen(m_listenSocket, 16) == SOCKET_ERROR ||
+            getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLen) == SOCKET_ERROR ||
+            !SetSocketNonBlocking(m_listenSocket)) {
+            closesocket(m_listenSocket);
+            m_listenSocket = INVALID_SOCKET;
+            return false;
+        }
+        m_port = ntohs(address.sin_port);
+
+        m_running = true;
+        m_thread = std::thread(&StandInSignalingServer::Run, this);
+        return true;
+    }
+
+    void Stop() {
+        m_running = false;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        for (auto& connection : m_connections) {
+            closesocket(connection->socket);
+        }
+        m_connections.clear();
+        if (m_listenSocket != INVALID_SOCKET) {
+            closesocket(m_listenSocket);
+            m_listenSocket = INVALID_SOCKET;
+        }
+    }
+
+    std::string GetUrl() const { return "ws://127.0.0.1:" + std::to_string(m_port); }
+
+private:
+    struct Outgoing {
+        Clock::time_point sendAt;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Connection {
+        SOCKET socket = INVALID_SOCKET;
+        std::string request;                // Até o fim do upgrade HTTP
+        bool upgraded = false;
+        WebSocketFrameParser parser;
+        std::string peerId;
+        std::deque<Outgoing> outbox;
+        bool closed = false;
+    };
+
+    void Run() {
+        while (m_running) {
+            AcceptConnections();
+
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            SOCKET maxSocket = m_listenSocket;
+            FD_SET(m_listenSocket, &readSet);
+            for (auto& connection : m_connections) {
+                FD_SET(connection->socket, &readSet);
+                maxSocket = std::max(maxSocket, connection->socket);
+            }
+            timeval timeout = { 0, 1000 };
+            select(static_cast<int>(maxSocket + 1), &readSet, nullptr, nullptr, &timeout);
+
+            for (auto& connection : m_connections) {
+                if (FD_ISSET(connection->socket, &readSet)) {
+                    ReadConnection(*connection);
+                }
+            }
+            FlushOutboxes();
+
+            // Fechadas: saem do mapa de peers e da lista
+            for (auto it = m_connections.begin(); it != m_connections.end();) {
+                if ((*it)->closed) {
+                    if (!(*it)->peerId.empty() && m_peers[(*it)->peerId] == it->get()) {
+                        m_peers.erase((*it)->peerId);
+                    }
+                    closesocket((*it)->socket);
+                    it = m_connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    void AcceptConnections() {
+        while (true) {
+            SOCKET accepted = accept(m_listenSocket, nullptr, nullptr);
+            if (accepted == INVALID_SOCKET) {
+                return;
+            }
+            SetSocketNonBlocking(accepted);
+            SetSocketNoDelay(accepted);
+            auto connection = std::make_unique<Connection>();
+            connection->socket = accepted;
+            m_connections.push_back(std::move(connection));
+        }
+    }
+
+    void ReadConnection(Connection& connection) {
+        char buffer[8192];
+        int received = recv(connection.socket, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            if (received == 0 || WSAGetLastError() != WSAEWOULDBLOCK) {
+                connection.closed = true;
+            }
+            return;
+        }
+
+        size_t offset = 0;
+        if (!connection.upgraded) {
+            connection.request.append(buffer, static_cast<size_t>(received));
+            size_t end = connection.request.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                return;
+            }
+            AnswerUpgrade(connection, connection.request.substr(0, end));
+            // Bytes depois do upgrade já são frames
+            std::string rest = connection.request.substr(end + 4);
+            connection.request.clear();
+            connection.parser.Feed(reinterpret_cast<const uint8_t*>(rest.data()), rest.size());
+            offset = static_cast<size_t>(received);
+        }
+        if (offset < static_cast<size_t>(received)) {
+            connection.parser.Feed(reinterpret_cast<const uint8_t*>(buffer) + offset,
+                                   static_cast<size_t>(received) - offset);
+        }
+
+        WebSocketOpcode opcode;
+        std::vector<uint8_t> payload;
+        while (connection.parser.Next(opcode, payload)) {
+            if (opcode == WebSocketOpcode::TEXT) {
+                HandleMessage(connection, std::string(payload.begin(), payload.end()));
+            } else if (opcode == WebSocketOpcode::CLOSE) {
+                connection.closed = true;
+            } else if (opcode == WebSocketOpcode::PING) {
+                Send(connection, WebSocketOpcode::PONG, std::string(payload.begin(), payload.end()));
+            }
+        }
+        if (connection.parser.HasError()) {
+            connection.closed = true;
+        }
+    }
+
+    void AnswerUpgrade(Connection& connection, const std::string& request) {
+        std::string key;
+        size_t begin = 0;
+        while (begin < request.size()) {
+            size_t end = request.find("\r\n", begin);
+            if (end == std::string::npos) {
+                end = request.size();
+            }
+            std::string line = request.substr(begin, end - begin);
+            begin = end + 2;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (name == "sec-websocket-key") {
+                key = line.substr(colon + 1);
+                key.erase(0, key.find_first_not_of(' '));
+                key.erase(key.find_last_not_of(" \r") + 1);
+            }
+        }
+
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                               "Upgrade: websocket\r\n"
+                               "Connection: Upgrade\r\n"
+                               "Sec-WebSocket-Accept: " + ComputeWebSocketAccept(key) + "\r\n\r\n";
+        connection.outbox.push_back({ Clock::now() + m_delay, std::vector<uint8_t>(response.begin(), response.end()) });
+        connection.upgraded = true;
+    }
+
+    void Send(Connection& connection, WebSocketOpcode opcode, const std::string& payload) {
+        Outgoing outgoing;
+        outgoing.sendAt = Clock::now() + m_delay;
+        EncodeServerFrame(opcode, payload, outgoing.bytes);
+        connection.outbox.push_back(std::move(outgoing));
+    }
+
+    void HandleMessage(Connection& connection, const std::string& json) {
+        std::vector<SignalingMessage> messages;
+        if (!DecodeSignalingMessage(json.data(), json.size(), messages) || messages.empty()) {
+            Send(connection, WebSocketOpcode::TEXT, "{\"type\":\"error\",\"message\":\"Mensagem invalida\"}");
+            return;
+        }
+
+        const SignalingMessage& message = messages.front();
+        switch (message.type) {
+            case SignalingMessage::REGISTER:
+                HandleRegister(connection, message);
+                break;
+
+            case SignalingMessage::OFFER:
+            case SignalingMessage::ANSWER:
+            case SignalingMessage::ICE_CANDIDATE: {
+                // Repasse do JSON original (lotes "ice-candidates" inclusive)
+                auto peer = m_peers.find(message.remotePeerId);
+                if (peer != m_peers.end()) {
+                    Send(*peer->second, WebSocketOpcode::TEXT, json);
+                }
+                break;
+            }
+
+            case SignalingMessage::PING:
+                Send(connection, WebSocketOpcode::TEXT, "{\"type\":\"pong\"}");
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void HandleRegister(Connection& connection, const SignalingMessage& message) {
+        connection.peerId = message.peerId;
+        m_peers[message.peerId] = &connection;
+
+        if (message.role == "host") {
+            std::string sessionId = message.sessionId;
+            if (sessionId.empty()) {
+                sessionId = message.peerId + "_" +
+                            std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                Clock::now().time_since_epoch()).count());
+            }
+            m_sessions[sessionId] = message.peerId;
+            Send(connection, WebSocketOpcode::TEXT,
+                 "{\"type\":\"register-ack\",\"sessionId\":\"" + sessionId + "\",\"role\":\"host\"}");
+            return;
+        }
+
+        auto session = m_sessions.find(message.sessionId);
+        if (session == m_sessions.end()) {
+            Send(connection, WebSocketOpcode::TEXT, "{\"type\":\"error\",\"message\":\"Sessao nao encontrada\"}");
+            return;
+        }
+        Send(connection, WebSocketOpcode::TEXT,
+             "{\"type\":\"register-ack\",\"sessionId\":\"" + session->first + "\",\"role\":\"guest\"," +
+             "\"hostPeerId\":\"" + session->second + "\"}");
+
+        auto host = m_peers.find(session->second);
+        if (host != m_peers.end()) {
+            Send(*host->second, WebSocketOpcode::TEXT,
+                 "{\"type\":\"guest-connected\",\"guestPeerId\":\"" + message.peerId + "\"}");
+        }
+    }
+
+    void FlushOutboxes() {
+        Clock::time_point now = Clock::now();
+        for (auto& connection : m_connections) {
+            while (!connection->outbox.empty() && connection->outbox.front().sendAt <= now) {
+                const std::vector<uint8_t>& bytes = connection->outbox.front().bytes;
+                // Sinalização é pequena: o buffer do socket absorve tudo de uma vez
+                send(connection->socket, reinterpret_cast<const char*>(bytes.data()),
+                     static_cast<int>(bytes.size()), SOCKET_SEND_FLAGS);
+                connection->outbox.pop_front();
+            }
+        }
+    }
+
+    SOCKET m_listenSocket = INVALID_SOCKET;
+    uint16_t m_port = 0;
+    std::chrono::milliseconds m_delay{ 0 };
+    std::atomic<bool> m_running{ false };
+    std::thread m_thread;
+
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::map<std::string, Connection*> m_peers;
+    std::map<std::string, std::string> m_sessions;     // sessionId → host
+};
+
+// Host compartilhado pelos dois fluxos: depois de ter um transporte, frames a 60 fps
+void SendFramesUntil(P2PManager& transport, const std::atomic<bool>& stop) {
+    std::vector<uint8_t> pixels(FRAME_WIDTH * FRAME_HEIGHT * 4, 0x80);
+    uint16_t sequence = 0;
+    while (!stop) {
+        transport.SendFrame(pixels.data(), FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH * 4, sequence++);
+        std::this_thread::sleep_for(FRAME_INTERVAL);
+    }
+}
+
+bool WaitFirstFrame(P2PManager& transport, Clock::time_point deadline) {
+    std::vector<uint8_t> pixels;
+    uint32_t width, height, stride;
+    uint16_t sequence;
+    while (Clock::now() < deadline) {
+        transport.ServiceTransportStats();
+        if (transport.IsDataAvailable(1) &&
+            transport.ReceiveFrame(pixels, width, height, stride, sequence)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Mensagens de sinalização recebidas, consumidas na ordem pelo fluxo sequencial
+class SignalingInbox {
+public:
+    explicit SignalingInbox(WebSocketSignalingClient& client) : m_client(client) {
+        client.SetMessageReceivedCallback([this](const SignalingMessage& message) {
+            m_messages.push_back(message);
+        });
+    }
+
+    // Espera uma mensagem do tipo; as de outros tipos ficam guardadas
+    bool WaitFor(SignalingMessage::Type type, SignalingMessage& outMessage, Clock::time_point deadline) {
+        while (Clock::now() < deadline) {
+            m_client.ProcessMessages();
+            for (auto it = m_messages.begin(); it != m_messages.end(); ++it) {
+                if (it->type == type) {
+                    outMessage = *it;
+                    m_messages.erase(it);
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+        return false;
+    }
+
+private:
+    WebSocketSignalingClient& m_client;
+    std::deque<SignalingMessage> m_messages;
+};
+
+// Host do fluxo sequencial: coleta completa → oferta → resposta → frames
+void SequentialHost(const std::string& url, const RaceOptions& options, uint32_t run,
+                    std::string& outSessionId, std::atomic<bool>& registered, std::atomic<bool>& stop) {
+    Clock::time_point deadline = Clock::now() + RUN_TIMEOUT;
+    WebSocketSignalingClient client(url);
+    SignalingInbox inbox(client);
+    std::string hostId = MakePeerId("seq-host", run);
+    client.Connect();
+    client.SendRegister(hostId, "host");
+
+    SignalingMessage message;
+    if (!inbox.WaitFor(SignalingMessage::REGISTER_ACK, message, deadline)) {
+        return;
+    }
+    outSessionId = client.GetSessionId();
+    registered = true;
+
+    if (!inbox.WaitFor(SignalingMessage::PEER_CONNECTED, message, deadline)) {
+        return;
+    }
+    std::string guestId = message.remotePeerId;
+
+    // Oferta só com a coleta completa (candidatos dentro do SDP)
+    P2PManager lan;
+    lan.InitializeAsServer(0);
+    WebRTCDataChannel webrtc(true);
+    std::string offer;
+    webrtc.Initialize({ "stun:stun.l.google.com:19302" });
+    webrtc.CreateOffer(offer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.gatherMs));
+    client.SendOffer(guestId, offer);
+    client.SendIceCandidate(guestId, "candidate:1 1 udp 2130706431 127.0.0.1 " +
+                            std::to_string(lan.GetLocalPort()) + " typ host", "0", LAN_CANDIDATE_MID);
+
+    if (!inbox.WaitFor(SignalingMessage::ANSWER, message, deadline)) {
+        return;
+    }
+
+    // Checagem de conectividade: o primeiro pacote do guest revela o endereço dele
+    PacketType type;
+    std::vector<uint8_t> payload;
+    while (!stop && lan.GetStats().totalFramesReceived == 0) {
+        lan.ReceiveControlMessage(type, payload);
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    SendFramesUntil(lan, stop);
+}
+
+double SequentialGuest(const std::string& url, const std::string& sessionId, const RaceOptions& options,
+                       uint32_t run) {
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + RUN_TIMEOUT;
+    WebSocketSignalingClient client(url);
+    SignalingInbox inbox(client);
+    client.Connect();
+    client.SendRegister(MakePeerId("seq-guest", run), "guest", sessionId);
+
+    SignalingMessage message;
+    SignalingMessage candidate;
+    if (!inbox.WaitFor(SignalingMessage::REGISTER_ACK, message, deadline) ||
+        !inbox.WaitFor(SignalingMessage::OFFER, message, deadline) ||
+        !inbox.WaitFor(SignalingMessage::ICE_CANDIDATE, candidate, deadline)) {
+        return -1.0;
+    }
+
+    WebRTCDataChannel webrtc(false);
+    std::string answer;
+    webrtc.Initialize({ "stun:stun.l.google.com:19302" });
+    webrtc.SetRemoteOffer(message.sdpOffer);
+    webrtc.CreateAnswer(answer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.gatherMs));
+    client.SendAnswer(client.GetRemotePeerId(), answer);
+
+    // "candidate:1 1 udp <prio> <ip> <porta> typ host"
+    char address[64] = {};
+    unsigned port = 0;
+    if (std::sscanf(candidate.iceCandidate.c_str(), "candidate:%*s %*s %*s %*s %63s %u", address, &port) != 2) {
+        return -1.0;
+    }
+    P2PManager lan;
+    if (!lan.InitializeAsClient(address, static_cast<uint16_t>(port)) || !WaitFirstFrame(lan, deadline)) {
+        return -1.0;
+    }
+    double ttff = MsSince(start);
+    client.Disconnect();
+    return ttff;
+}
+
+struct RaceResult {
+    double ttffMs = -1.0;
+    SessionConnector::Timings guest;
+    std::string winner;
+};
+
+void RaceHost(const std::string& url, std::string& outSessionId, std::atomic<bool>& registered,
+              std::atomic<bool>& stop) {
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::HOST;
+    config.signalingUrl = url;
+    config.timeoutMs = static_cast<uint32_t>(std::chrono::milliseconds(RUN_TIMEOUT).count());
+    config.stunServers = { "stun:stun.l.google.com:19302" };
+    if (!connector.Start(config)) {
+        return;
+    }
+
+    SessionConnector::State state;
+    while ((state = connector.Poll()) == SessionConnector::State::CONNECTING && !stop) {
+        if (!registered && connector.GetTimings().registeredMs >= 0.0) {
+            outSessionId = connector.GetSessionId();
+            registered = true;
+        }
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    if (state != SessionConnector::State::CONNECTED) {
+        return;
+    }
+
+    std::unique_ptr<P2PManager> transport = connector.TakeTransport();
+    SendFramesUntil(*transport, stop);
+}
+
+RaceResult RaceGuest(const std::string& url, const std::string& sessionId) {
+    RaceResult result;
+    Clock::time_point start = Clock::now();
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::GUEST;
+    config.signalingUrl = url;
+    config.sessionId = sessionId;
+    config.stunServers = { "stun:stun.l.google.com:19302" };
+    if (!connector.Start(config)) {
+        return result;
+    }
+
+    SessionConnector::State state;
+    while ((state = connector.Poll()) == SessionConnector::State::CONNECTING) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    if (state != SessionConnector::State::CONNECTED) {
+        return result;
+    }
+
+    result.guest = connector.GetTimings();
+    result.winner = connector.GetWinnerName();
+    std::unique_ptr<P2PManager> transport = connector.TakeTransport();
+    if (WaitFirstFrame(*transport, start + RUN_TIMEOUT)) {
+        result.ttffMs = MsSince(start);
+    }
+    return result;
+}
+
+// Host em thread até registrar; guest mede na thread atual
+template <typename HostFn, typename GuestFn>
+void RunPair(HostFn hostFn, GuestFn guestFn) {
+    std::string sessionId;
+    std::atomic<bool> registered{ false };
+    std::atomic<bool> stop{ false };
+    std::thread host([&] { hostFn(sessionId, registered, stop); });
+
+    Clock::time_point deadline = Clock::now() + RUN_TIMEOUT;
+    while (!registered && Clock::now() < deadline) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    if (registered) {
+        guestFn(sessionId);
+    }
+    stop = true;
+    host.join();
+}
+
+// ============== Retomada após queda curta ==============
+
+uint64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Sessão publicada pelo host a cada registro (a renegociação registra de novo)
+class PublishedSession {
+public:
+    void Publish(const std::string& sessionId) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessionId = sessionId;
+        m_generation++;
+    }
+
+    // Espera um registro mais novo que afterGeneration
+    bool Wait(uint32_t afterGeneration, std::string& outSessionId, uint32_t& outGeneration,
+              Clock::time_point deadline) {
+        while (Clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_generation > afterGeneration) {
+                    outSessionId = m_sessionId;
+                    outGeneration = m_generation;
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+        return false;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::string m_sessionId;
+    uint32_t m_generation = 0;
+};
+
+std::unique_ptr<P2PManager> ConnectHost(const std::string& url, PublishedSession& session,
+                                        const std::atomic<bool>& stop) {
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::HOST;
+    config.signalingUrl = url;
+    config.timeoutMs = 0;
+    if (!connector.Start(config)) {
+        return nullptr;
+    }
+
+    bool published = false;
+    SessionConnector::State state;
+    while ((state = connector.Poll()) == SessionConnector::State::CONNECTING && !stop) {
+        if (!published && connector.GetTimings().registeredMs >= 0.0) {
+            session.Publish(connector.GetSessionId());
+            published = true;
+        }
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    return state == SessionConnector::State::CONNECTED ? connector.TakeTransport() : nullptr;
+}
+
+std::unique_ptr<P2PManager> ConnectGuest(const std::string& url, const std::string& sessionId) {
+    SessionConnector connector;
+    SessionConnector::Config config;
+    config.role = SessionConnector::Role::GUEST;
+    config.signalingUrl = url;
+    config.sessionId = sessionId;
+    if (!connector.Start(config)) {
+        return nullptr;
+    }
+
+    SessionConnector::State state;
+    while ((state = connector.Poll()) == SessionConnector::State::CONNECTING) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    return state == SessionConnector::State::CONNECTED ? connector.TakeTransport() : nullptr;
+}
+
+// Fundo fixo em degradê e um bloco que anda 1 px por frame: poucos tiles mudam
+void DrawResumeFrame(std::vector<uint8_t>& pixels, uint16_t sequence) {
+    const uint32_t stride = RESUME_FRAME_WIDTH * 4;
+    pixels.resize(static_cast<size_t>(stride) * RESUME_FRAME_HEIGHT);
+    const uint32_t blockX = sequence % (RESUME_FRAME_WIDTH - RESUME_BLOCK_SIZE);
+    const uint32_t blockY = RESUME_FRAME_HEIGHT / 2;
+
+    for (uint32_t y = 0; y < RESUME_FRAME_HEIGHT; ++y) {
+        uint8_t* row = pixels.data() + static_cast<size_t>(y) * stride;
+        for (uint32_t x = 0; x < RESUME_FRAME_WIDTH; ++x) {
+            bool block = x >= blockX && x < blockX + RESUME_BLOCK_SIZE &&
+                         y >= blockY && y < blockY + RESUME_BLOCK_SIZE;
+            row[x * 4 + 0] = block ? 0xFF : static_cast<uint8_t>(x * 2);
+            row[x * 4 + 1] = block ? 0xFF : static_cast<uint8_t>(y * 2);
+            row[x * 4 + 2] = block ? 0xFF : 0x40;
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+}
+
+// Host da retomada: token, SESSION_RESUME e frame de retomada incremental. Com
+// renegotiate, sem token: guest em silêncio = sessão perdida, registra outra
+void ResumeHost(const std::string& url, bool renegotiate, PublishedSession& session,
+                const std::atomic<bool>& stop) {
+    std::unique_ptr<P2PManager> transport = ConnectHost(url, session, stop);
+    SessionResumeHost resume(RESUME_GRACE_MS, RESUME_TILE_SIZE);
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> delta;
+    PacketType type;
+    std::vector<uint8_t> payload;
+    Clock::time_point lastToken;
+    uint16_t sequence = 0;
+
+    while (!stop && transport) {
+        uint64_t idleMs = transport->GetIdleMs();
+        uint64_t nowMs = NowUs() / 1000;
+
+        if (renegotiate) {
+            if (idleMs != UINT64_MAX && idleMs >= RESUME_SILENCE_MS) {
+                transport = ConnectHost(url, session, stop);
+                continue;
+            }
+        } else {
+            resume.UpdatePeerActivity(idleMs, nowMs);
+            if (Clock::now() - lastToken >= RESUME_TOKEN_INTERVAL) {
+                SessionTokenMessage token;
+                resume.FillTokenMessage(token);
+                transport->SendControlMessage(PacketType::SESSION_TOKEN,
+                                              reinterpret_cast<const uint8_t*>(&token), sizeof(token));
+                lastToken = Clock::now();
+            }
+        }
+
+        transport->ServiceTransportStats();
+        while (transport->ReceiveControlMessage(type, payload)) {
+            if (type == PacketType::SESSION_RESUME && payload.size() == sizeof(SessionResumeMessage) &&
+                !renegotiate) {
+                SessionResumeMessage message;
+                std::memcpy(&message, payload.data(), sizeof(message));
+                SessionResumeAckMessage ack;
+                if (resume.HandleResume(message, nowMs, ack) == ResumeStatus::ACCEPTED) {
+                    transport->AcceptResumedPeer();
+                }
+                transport->SendControlMessage(PacketType::SESSION_RESUME_ACK,
+                                              reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+            }
+        }
+
+        DrawResumeFrame(pixels, sequence);
+        const uint32_t stride = RESUME_FRAME_WIDTH * 4;
+        bool sent = false;
+        if (resume.NeedsResumeFrame()) {
+            if (resume.BuildResumeDelta(pixels.data(), RESUME_FRAME_WIDTH, RESUME_FRAME_HEIGHT, stride, delta)) {
+                sent = transport->SendFrameDelta(delta.data(), delta.size(), RESUME_FRAME_WIDTH,
+                                                 RESUME_FRAME_HEIGHT, stride, sequence);
+            } else {
+                resume.OnFullResumeFrame(pixels.size());
+            }
+        }
+        if (!sent) {
+            transport->SendFrame(pixels.data(), RESUME_FRAME_WIDTH, RESUME_FRAME_HEIGHT, stride, sequence);
+        }
+        resume.OnFrameSent(pixels.data(), RESUME_FRAME_WIDTH, RESUME_FRAME_HEIGHT, stride, sequence);
+        sequence++;
+
+        std::this_thread::sleep_for(FRAME_INTERVAL);
+    }
+}
+
+// Uma iteração do guest: token/ack, SESSION_RESUME e um frame. Retorna os bytes do
+// frame apresentado (0 = nenhum)
+size_t PumpResumeGuest(P2PManager& transport, SessionResumeClient& resume, std::vector<uint8_t>& pixels) {
+    PacketType type;
+    std::vector<uint8_t> payload;
+    transport.ServiceTransportStats();
+    while (transport.ReceiveControlMessage(type, payload)) {
+        if (type == PacketType::SESSION_TOKEN) {
+            resume.OnToken(payload.data(), payload.size());
+        } else if (type == PacketType::SESSION_RESUME_ACK) {
+            resume.OnResumeAck(payload.data(), payload.size());
+        }
+    }
+
+    SessionResumeMessage message;
+    bool reopenSocket = false;
+    if (resume.Service(NowUs(), transport.GetIdleMs(), message, reopenSocket)) {
+        if (!reopenSocket || transport.ReopenSocket()) {
+            transport.SendControlMessage(PacketType::SESSION_RESUME,
+                                         reinterpret_cast<const uint8_t*>(&message), sizeof(message));
+        }
+    }
+
+    uint32_t width, height, stride;
+    uint16_t sequence;
+    if (!transport.IsDataAvailable(1) || !transport.ReceiveFrame(pixels, width, height, stride, sequence)) {
+        return 0;
+    }
+
+    size_t bytes = pixels.size();
+    bool incremental = (transport.GetLastFrameFlags() & FRAME_FLAG_TILE_DELTA) != 0;
+    if (incremental && !resume.ApplyDelta(pixels.data(), pixels.size(), width, height, stride, sequence)) {
+        return 0;
+    }
+
+    resume.OnFramePresented(NowUs());
+    if (!incremental) {
+        resume.KeepReference(pixels, width, height, stride, sequence);
+    }
+    return bytes;
+}
+
+struct ResumeResult {
+    double blipToFrameMs = -1.0;        // Fim da queda → primeiro frame apresentado
+    size_t firstFrameBytes = 0;
+    double resumeToFrameMs = -1.0;      // SESSION_RESUME aceito → frame (SessionResumeClient)
+};
+
+ResumeResult ResumeGuest(const std::string& url, bool renegotiate, PublishedSession& session,
+                         const RaceOptions& options) {
+    ResumeResult result;
+    std::string sessionId;
+    uint32_t generation = 0;
+    if (!session.Wait(0, sessionId, generation, Clock::now() + RUN_TIMEOUT)) {
+        return result;
+    }
+
+    std::unique_ptr<P2PManager> transport = ConnectGuest(url, sessionId);
+    if (!transport) {
+        return result;
+    }
+
+    SessionResumeClient resume(RESUME_SILENCE_MS, RESUME_RETRY_MS);
+    std::vector<uint8_t> pixels;
+    Clock::time_point steadyEnd = Clock::now() + RESUME_STEADY_DURATION;
+    while (Clock::now() < steadyEnd) {
+        PumpResumeGuest(*transport, resume, pixels);
+    }
+    if (!renegotiate && !resume.HasToken()) {
+        return result;
+    }
+
+    // Queda: nada lido nem enviado. O que o host mandou nesse tempo se perdeu com a
+    // rede antiga (socket novo, porta nova)
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.blipMs));
+    Clock::time_point blipEnd = Clock::now();
+    Clock::time_point deadline = blipEnd + RUN_TIMEOUT;
+    transport->ReopenSocket();
+
+    if (renegotiate) {
+        // Sessão nova do host (publicada depois de ele desistir do guest)
+        transport.reset();
+        if (!session.Wait(generation, sessionId, generation, deadline) ||
+            !(transport = ConnectGuest(url, sessionId))) {
+            return result;
+        }
+    }
+
+    while (Clock::now() < deadline) {
+        size_t bytes = PumpResumeGuest(*transport, resume, pixels);
+        if (bytes > 0) {
+            result.blipToFrameMs = MsSince(blipEnd);
+            result.firstFrameBytes = bytes;
+            result.resumeToFrameMs = resume.GetStats().lastReconnectToFrameMs;
+            break;
+        }
+    }
+    return result;
+}
+
+ResumeResult RunResume(const std::string& url, bool renegotiate, const RaceOptions& options) {
+    PublishedSession session;
+    std::atomic<bool> stop{ false };
+    std::thread host([&] { ResumeHost(url, renegotiate, session, stop); });
+    ResumeResult result = ResumeGuest(url, renegotiate, session, options);
+    stop = true;
+    host.join();
+    return result;
+}
+
+double Median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void PrintRow(const char* name, const std::vector<double>& values, uint32_t runs) {
+    if (values.empty()) {
+        std::printf("%-11s %6s %8s %8s %8s\n", name, "0", "-", "-", "-");
+        return;
+    }
+    std::printf("%-11s %3zu/%-2u %8.1f %8.1f %8.1f\n", name, values.size(), runs, Median(values),
+                *std::min_element(values.begin(), values.end()), *std::max_element(values.begin(), values.end()));
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_connrace [opcoes]" << std::endl;
+    std::cout << "  --signal-rtt-ms <n>       - Atraso do servidor de sinalizacao (padrao 40)." << std::endl;
+    std::cout << "  --gather-ms <n>           - Coleta srflx/relay completa, fluxo sequencial (padrao 300)." << std::endl;
+    std::cout << "  --runs <n>                - Repeticoes de cada fluxo (padrao 5)." << std::endl;
+    std::cout << "  --resume                  - Queda curta: retomada vs. renegociacao completa." << std::endl;
+    std::cout << "  --blip-ms <n>             - Duracao da queda com --resume (padrao 2000)." << std::endl;
+}
+
+int RunResumeComparison(const std::string& url, const RaceOptions& options) {
+    std::vector<double> resumed;
+    std::vector<double> renegotiated;
+    std::vector<double> resumedBytes;
+    std::vector<double> renegotiatedBytes;
+    std::vector<double> resumeToFrame;
+
+    for (uint32_t run = 0; run < options.runs; ++run) {
+        ResumeResult fast = RunResume(url, false, options);
+        if (fast.blipToFrameMs >= 0.0) {
+            resumed.push_back(fast.blipToFrameMs);
+            resumedBytes.push_back(static_cast<double>(fast.firstFrameBytes));
+            resumeToFrame.push_back(fast.resumeToFrameMs);
+        }
+
+        ResumeResult full = RunResume(url, true, options);
+        if (full.blipToFrameMs >= 0.0) {
+            renegotiated.push_back(full.blipToFrameMs);
+            renegotiatedBytes.push_back(static_cast<double>(full.firstFrameBytes));
+        }
+    }
+
+    std::printf("queda de %u ms, sinalizacao %u ms RTT, frame %ux%u, %u rodadas\n",
+                options.blipMs, options.signalRttMs, RESUME_FRAME_WIDTH, RESUME_FRAME_HEIGHT, options.runs);
+    std::printf("%-11s %6s %8s %8s %8s\n", "fluxo", "ok", "1o frame", "min", "max");
+    PrintRow("retomada", resumed, options.runs);
+    PrintRow("renegociar", renegotiated, options.runs);
+    if (!resumed.empty()) {
+        std::printf("retomada (p50): SESSION_RESUME aceito -> frame %.1f ms, 1o frame %.0f bytes\n",
+                    Median(resumeToFrame), Median(resumedBytes));
+    }
+    if (!renegotiated.empty()) {
+        std::printf("renegociar (p50): 1o frame %.0f bytes\n", Median(renegotiatedBytes));
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    RaceOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--signal-rtt-ms" && hasValue) {
+            options.signalRttMs = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--gather-ms" && hasValue) {
+            options.gatherMs = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--runs" && hasValue) {
+            options.runs = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--blip-ms" && hasValue) {
+            options.blipMs = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.runs == 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    StandInSignalingServer server;
+    if (!server.Start(options.signalRttMs)) {
+        std::cerr << "Falha ao iniciar o servidor de sinalizacao" << std::endl;
+        return 1;
+    }
+    const std::string url = server.GetUrl();
+
+    if (options.resume) {
+        int status = RunResumeComparison(url, options);
+        server.Stop();
+        return status;
+    }
+
+    std::vector<double> sequential;
+    std::vector<double> race;
+    std::vector<double> raceRemotePeer;
+    std::vector<double> raceRemoteCandidate;
+    std::vector<double> raceConnected;
+    std::string winner;
+
+    for (uint32_t run = 0; run < options.runs; ++run) {
+        RunPair(
+            [&](std::string& sessionId, std::atomic<bool>& registered, std::atomic<bool>& stop) {
+                SequentialHost(url, options, run, sessionId, registered, stop);
+            },
+            [&](const std::string& sessionId) {
+                double ttff = SequentialGuest(url, sessionId, options, run);
+                if (ttff >= 0.0) {
+                    sequential.push_back(ttff);
+                }
+            });
+
+        RunPair(
+            [&](std::string& sessionId, std::atomic<bool>& registered, std::atomic<bool>& stop) {
+                RaceHost(url, sessionId, registered, stop);
+            },
+            [&](const std::string& sessionId) {
+                RaceResult result = RaceGuest(url, sessionId);
+                if (result.ttffMs >= 0.0) {
+                    race.push_back(result.ttffMs);
+                    raceRemotePeer.push_back(result.guest.remotePeerMs);
+                    raceRemoteCandidate.push_back(result.guest.firstRemoteCandidateMs);
+                    raceConnected.push_back(result.guest.connectedMs);
+                    winner = result.winner;
+                }
+            });
+    }
+
+    std::printf("sinalizacao %u ms RTT, coleta completa %u ms (sequencial), %u rodadas\n",
+                options.signalRttMs, options.gatherMs, options.runs);
+    std::printf("%-11s %6s %8s %8s %8s\n", "fluxo", "ok", "ttff p50", "min", "max");
+    PrintRow("sequencial", sequential, options.runs);
+    PrintRow("corrida", race, options.runs);
+    if (!race.empty()) {
+        std::printf("corrida (guest, p50): peer remoto %.1f ms, 1o candidato %.1f ms, caminho %.1f ms (%s)\n",
+                    Median(raceRemotePeer), Median(raceRemoteCandidate), Median(raceConnected), winner.c_str());
+    }
+
+    server.Stop();
+    return 0;
+}
@@ -0,0 +1,378 @@
+/**
+ * @file DataChannelLoopMain.cpp
+ * @brief rdc_dcloop: dois peers em processo (DataChannelMux sobre EmulatedLink) sob perda
+ *
+ * O host envia vídeo (60 fps) e cursor pelo canal CONTROL; o guest envia lotes de
+ * input (125 Hz) pelo canal INPUT, ordenado e confiável. Para cada taxa de perda,
+ * compara a configuração do canal de vídeo:
+ * - unordered-rtx0:   não ordenado, maxRetransmits = 0 (padrão)
+ * - unordered-life:   não ordenado, maxPacketLifeTime = 4 × atraso (~1 retransmissão)
+ * - ordered-reliable: um stream SCTP comum (head-of-line blocking)
+ *
+ * Com --backpressure, a taxa de envio (pacer do mux, no papel da janela do SCTP)
+ * cai de 20 para 4 Mbps no segundo quarto da corrida e o vídeo segue o alvo do ABR
+ * (balanced e model, este com feedback ideal dos frames entregues):
+ * - ignore:   só RTT/perda chegam ao ABR; o buffer de envio cresce sem limite
+ * - skip:     pula frames enquanto o bufferedAmount está acima do watermark alto
+ * - skip+abr: também repassa o bufferedAmount ao ABR (UpdateSendBuffer)
+ *
+ * Tempo virtual (passo de 1 ms) e seed fixa: o resultado é reprodutível.
+ * Latência = envio → entrega ao Receive() do outro peer.
+ */
+
+#include "DataChannelMux.h"
+#include "LinkEmulator.h"
+#include "OptimizationLayer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t STEP_US = 1000;
+constexpr uint32_t VIDEO_FPS = 60;
+constexpr uint32_t CURSOR_HZ = 60;
+constexpr uint32_t INPUT_HZ = 125;
+constexpr size_t CURSOR_MESSAGE_BYTES = 24;
+constexpr size_t INPUT_MESSAGE_BYTES = 40;
+constexpr uint64_t DRAIN_MS = 2000;
+
+// --backpressure: taxa de envio 20 → 4 → 20 Mbps, watermarks do canal de vídeo
+constexpr double PACER_HIGH_KBPS = 20000.0;
+constexpr double PACER_LOW_KBPS = 4000.0;
+constexpr size_t VIDEO_LOW_WATERMARK = 32 * 1024;
+constexpr size_t VIDEO_HIGH_WATERMARK = 128 * 1024;
+constexpr uint64_t ABR_INTERVAL_US = 100000;
+
+struct LoopOptions {
+    std::vector<double> lossPercents = { 0.0, 1.0, 2.0, 5.0 };
+    double delayMs = 20.0;
+    double linkMbps = 50.0;
+    double videoMbps = 8.0;
+    uint32_t seconds = 20;
+    uint64_t seed = 1;
+    bool backpressure = false;
+};
+
+struct VideoMode {
+    const char* name;
+    DataChannelReliability reliability;
+};
+
+struct LatencySeries {
+    uint64_t sent = 0;
+    std::vector<double> latenciesMs;
+
+    double Percentile(double fraction) {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latenciesMs.size() - 1,
+                                static_cast<size_t>(fraction * latenciesMs.size()));
+        std::nth_element(latenciesMs.begin(), latenciesMs.begin() + index, latenciesMs.end());
+        return latenciesMs[index];
+    }
+
+    double DeliveredPercent() const {
+        return sent ? 100.0 * latenciesMs.size() / sent : 0.0;
+    }
+};
+
+std::vector<uint8_t> MakeMessage(size_t size, uint64_t nowUs) {
+    std::vector<uint8_t> message(std::max(size, sizeof(nowUs)), 0xA5);
+    std::memcpy(message.data(), &nowUs, sizeof(nowUs));
+    return message;
+}
+
+void Collect(DataChannelMux& mux, uint64_t nowUs, LatencySeries* series) {
+    DataChannelKind kind;
+    std::vector<uint8_t> message;
+    while (mux.Receive(kind, message)) {
+        uint64_t sentUs = 0;
+        std::memcpy(&sentUs, message.data(), sizeof(sentUs));
+        series[static_cast<size_t>(kind)].latenciesMs.push_back((nowUs - sentUs) / 1000.0);
+    }
+}
+
+void RunLoop(const LoopOptions& options, double lossPercent, const VideoMode& mode) {
+    LinkProfile profile;
+    profile.bandwidthKbps = options.linkMbps * 1000.0;
+    profile.delayMs = options.delayMs;
+    profile.jitterMs = options.delayMs * 0.05;
+    profile.lossPercent = lossPercent;
+    profile.queueLimitBytes = 1024 * 1024;
+
+    auto link = std::make_shared<EmulatedLink>(profile, options.seed);
+    DataChannelMux host(link->CreateEndpoint(EmulatedLink::Side::A));
+    DataChannelMux guest(link->CreateEndpoint(EmulatedLink::Side::B));
+    host.Configure(DataChannelKind::VIDEO, mode.reliability);
+
+    LatencySeries atGuest[DATA_CHANNEL_KIND_COUNT];
+    LatencySeries atHost[DATA_CHANNEL_KIND_COUNT];
+
+    size_t frameBytes = static_cast<size_t>(options.videoMbps * 1e6 / 8.0 / VIDEO_FPS);
+    uint64_t durationUs = static_cast<uint64_t>(options.seconds) * 1000000;
+    uint64_t endUs = durationUs + DRAIN_MS * 1000;
+    uint64_t nextFrameUs = 0;
+    uint64_t nextCursorUs = 0;
+    uint64_t nextInputUs = 0;
+
+    for (uint64_t nowUs = 0; nowUs <= endUs; nowUs += STEP_US) {
+        link->AdvanceTo(nowUs);
+
+        if (nowUs < durationUs) {
+            if (nowUs >= nextFrameUs) {
+                std::vector<uint8_t> frame = MakeMessage(frameBytes, nowUs);
+                host.Send(DataChannelKind::VIDEO, frame.data(), frame.size(), nowUs);
+                atGuest[static_cast<size_t>(DataChannelKind::VIDEO)].sent++;
+                nextFrameUs += 1000000 / VIDEO_FPS;
+            }
+            if (nowUs >= nextCursorUs) {
+                std::vector<uint8_t> cursor = MakeMessage(CURSOR_MESSAGE_BYTES, nowUs);
+                host.Send(DataChannelKind::CONTROL, cursor.data(), cursor.size(), nowUs);
+                atGuest[static_cast<size_t>(DataChannelKind::CONTROL)].sent++;
+                nextCursorUs += 1000000 / CURSOR_HZ;
+            }
+            if (nowUs >= nextInputUs) {
+                std::vector<uint8_t> input = MakeMessage(INPUT_MESSAGE_BYTES, nowUs);
+                guest.Send(DataChannelKind::INPUT, input.data(), input.size(), nowUs);
+                atHost[static_cast<size_t>(DataChannelKind::INPUT)].sent++;
+                nextInputUs += 1000000 / INPUT_HZ;
+            }
+        }
+
+        host.Poll(nowUs);
+        guest.Poll(nowUs);
+        Collect(guest, nowUs, atGuest);
+        Collect(host, nowUs, atHost);
+    }
+
+    LatencySeries& video = atGuest[static_cast<size_t>(DataChannelKind::VIDEO)];
+    LatencySeries& cursor = atGuest[static_cast<size_t>(DataChannelKind::CONTROL)];
+    LatencySeries& input = atHost[static_cast<size_t>(DataChannelKind::INPUT)];
+    DataChannelMux::ChannelStats videoStats = host.GetStats(DataChannelKind::VIDEO);
+
+    std::printf("%6.1f %-17s %7.2f %7.1f %7.1f %7.1f %7.1f %8llu %8.2f %8.1f %8.2f %8.1f\n",
+                lossPercent, mode.name, video.DeliveredPercent(),
+                video.Percentile(0.50), video.Percentile(0.95), video.Percentile(0.99),
+                video.Percentile(1.0), static_cast<unsigned long long>(videoStats.retransmissions),
+                cursor.DeliveredPercent(), cursor.Percentile(0.99),
+                input.DeliveredPercent(), input.Percentile(0.99));
+}
+
+enum class BackpressurePolicy { IGNORE, SKIP, SKIP_ABR };
+
+void RunBackpressure(const LoopOptions& options, BackpressurePolicy policy, const char* name,
+                     AdaptiveBitRateController::AdaptationMode abrMode, const char* abrName) {
+    LinkProfile profile;
+    profile.bandwidthKbps = options.linkMbps * 1000.0;
+    profile.delayMs = options.delayMs;
+    profile.queueLimitBytes = 1024 * 1024;
+
+    auto link = std::make_shared<EmulatedLink>(profile, options.seed);
+    DataChannelMux host(link->CreateEndpoint(EmulatedLink::Side::A));
+    DataChannelMux guest(link->CreateEndpoint(EmulatedLink::Side::B));
+    host.SetBufferedAmountThresholds(DataChannelKind::VIDEO, VIDEO_LOW_WATERMARK, VIDEO_HIGH_WATERMARK);
+
+    AdaptiveBitRateController abr(2, 30);
+    abr.SetAdaptationMode(abrMode);
+    double virtualNowMs = 0.0;
+    abr.SetTimeSource([&virtualNowMs]() { return virtualNowMs; });
+
+    LatencySeries atGuest[DATA_CHANNEL_KIND_COUNT];
+    uint64_t framesSkipped = 0;
+    size_t maxBuffered = 0;
+    double targetSumMbps = 0.0;
+    uint64_t targetSamples = 0;
+
+    uint64_t durationUs = static_cast<uint64_t>(options.seconds) * 1000000;
+    uint64_t endUs = durationUs + DRAIN_MS * 1000;
+    uint64_t nextFrameUs = 0;
+    uint64_t nextCursorUs = 0;
+    uint64_t nextAbrUs = ABR_INTERVAL_US;
+
+    for (uint64_t nowUs = 0; nowUs <= endUs; nowUs += STEP_US) {
+        link->AdvanceTo(nowUs);
+        virtualNowMs = nowUs / 1000.0;
+
+        // Queda da taxa no segundo quarto da corrida
+        bool slow = nowUs >= durationUs / 4 && nowUs < durationUs / 2;
+        host.SetSendRateKbps(slow ? PACER_LOW_KBPS : PACER_HIGH_KBPS);
+
+        if (nowUs < durationUs) {
+            if (nowUs >= nextFrameUs) {
+                nextFrameUs += 1000000 / VIDEO_FPS;
+                atGuest[static_cast<size_t>(DataChannelKind::VIDEO)].sent++;
+                if (policy != BackpressurePolicy::IGNORE && host.IsAboveHighWatermark(DataChannelKind::VIDEO)) {
+                    framesSkipped++;
+                } else {
+                    size_t frameBytes = abr.GetTargetBitrateKbps() * 1000 / 8 / VIDEO_FPS;
+                    auto frame = std::make_shared<const std::vector<uint8_t>>(MakeMessage(frameBytes, nowUs));
+                    host.Send(DataChannelKind::VIDEO, frame, nowUs);
+                }
+            }
+            if (nowUs >= nextCursorUs) {
+                std::vector<uint8_t> cursor = MakeMessage(CURSOR_MESSAGE_BYTES, nowUs);
+                host.Send(DataChannelKind::CONTROL, cursor.data(), cursor.size(), nowUs);
+                nextCursorUs += 1000000 / CURSOR_HZ;
+            }
+        }
+
+        host.Poll(nowUs);
+        guest.Poll(nowUs);
+
+        // Feedback ideal dos frames entregues (envio/chegada/bytes), sem passar pelo link
+        DataChannelKind kind;
+        std::vector<uint8_t> message;
+        while (guest.Receive(kind, message)) {
+            uint64_t sentUs = 0;
+            std::memcpy(&sentUs, message.data(), sizeof(sentUs));
+            atGuest[static_cast<size_t>(kind)].latenciesMs.push_back((nowUs - sentUs) / 1000.0);
+            if (kind == DataChannelKind::VIDEO) {
+                abr.OnPacketFeedback(sentUs / 1000.0, nowUs / 1000.0, message.size());
+            }
+        }
+        Collect(host, nowUs, atGuest);
+
+        size_t buffered = host.GetBufferedAmount(DataChannelKind::VIDEO);
+        maxBuffered = std::max(maxBuffered, buffered);
+
+        if (nowUs >= nextAbrUs && nowUs < durationUs) {
+            nextAbrUs += ABR_INTERVAL_US;
+            if (policy == BackpressurePolicy::SKIP_ABR) {
+                abr.UpdateSendBuffer(buffered, VIDEO_LOW_WATERMARK, VIDEO_HIGH_WATERMARK);
+            }
+            abr.UpdateMetrics(host.GetSmoothedRttMs() / 2.0, 0.0, 0.0);
+            targetSumMbps += abr.GetTargetBitrateKbps() / 1000.0;
+            targetSamples++;
+        }
+    }
+
+    LatencySeries& video = atGuest[static_cast<size_t>(DataChannelKind::VIDEO)];
+    std::printf("%-9s %-10s %7llu %7llu %7.2f %7.1f %7.1f %7.1f %8.1f %10.1f %9.1f\n", abrName, name,
+                static_cast<unsigned long long>(video.sent),
+                static_cast<unsigned long long>(framesSkipped), video.DeliveredPercent(),
+                video.Percentile(0.50), video.Percentile(0.95), video.Percentile(0.99),
+                video.Percentile(1.0), maxBuffered / 1024.0,
+                targetSamples ? targetSumMbps / targetSamples : 0.0);
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_dcloop [opcoes]" << std::endl;
+    std::cout << "  --loss <p1,p2,...>        - Perdas em % (padrao 0,1,2,5)." << std::endl;
+    std::cout << "  --delay <ms>              - Atraso de ida (padrao 20)." << std::endl;
+    std::cout << "  --link-mbps <n>           - Banda do link (padrao 50)." << std::endl;
+    std::cout << "  --video-mbps <n>          - Bitrate do video (padrao 8)." << std::endl;
+    std::cout << "  --seconds <n>             - Duracao simulada (padrao 20)." << std::endl;
+    std::cout << "  --seed <n>                - Seed do link (padrao 1)." << std::endl;
+    std::cout << "  --backpressure            - Taxa de envio 20 -> 4 -> 20 Mbps: ignore / skip / skip+abr." << std::endl;
+}
+
+std::vector<double> ParseList(const std::string& text) {
+    std::vector<double> values;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        if (!item.empty()) {
+            values.push_back(std::atof(item.c_str()));
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    LoopOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--loss" && hasValue) {
+            options.lossPercents = ParseList(args[++i]);
+        } else if (arg == "--delay" && hasValue) {
+            options.delayMs = std::atof(args[++i].c_str());
+        } else if (arg == "--link-mbps" && hasValue) {
+            options.linkMbps = std::atof(args[++i].c_str());
+        } else if (arg == "--video-mbps" && hasValue) {
+            options.videoMbps = std::atof(args[++i].c_str());
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--backpressure") {
+            options.backpressure = true;
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.lossPercents.empty() || options.seconds == 0 || options.videoMbps <= 0.0) {
+        PrintUsage();
+        return 1;
+    }
+
+    if (options.backpressure) {
+        std::printf("taxa de envio %.0f -> %.0f -> %.0f Mbps (%u s), watermarks %zu/%zu KB\n",
+                    PACER_HIGH_KBPS / 1000.0, PACER_LOW_KBPS / 1000.0, PACER_HIGH_KBPS / 1000.0,
+                    options.seconds, VIDEO_LOW_WATERMARK / 1024, VIDEO_HIGH_WATERMARK / 1024);
+        std::printf("%-9s %-10s %7s %7s %7s %7s %7s %7s %8s %10s %9s\n", "abr", "politica", "frames",
+                    "pulados", "entr%", "p50", "p95", "p99", "max", "buf max KB", "alvo Mbps");
+        const std::pair<AdaptiveBitRateController::AdaptationMode, const char*> abrModes[] = {
+            { AdaptiveBitRateController::AdaptationMode::BALANCED, "balanced" },
+            { AdaptiveBitRateController::AdaptationMode::MODEL_BASED, "model" },
+        };
+        for (const auto& [mode, abrName] : abrModes) {
+            RunBackpressure(options, BackpressurePolicy::IGNORE, "ignore", mode, abrName);
+            RunBackpressure(options, BackpressurePolicy::SKIP, "skip", mode, abrName);
+            RunBackpressure(options, BackpressurePolicy::SKIP_ABR, "skip+abr", mode, abrName);
+        }
+        return 0;
+    }
+
+    DataChannelReliability lifetime = DefaultDataChannelReliability(DataChannelKind::VIDEO);
+    lifetime.maxRetransmits = -1;
+    lifetime.maxPacketLifeTimeMs = static_cast<uint32_t>(std::max(1.0, 4.0 * options.delayMs));
+
+    DataChannelReliability reliable;
+    reliable.ordered = true;
+    reliable.maxRetransmits = -1;
+
+    const VideoMode modes[] = {
+        { "unordered-rtx0", DefaultDataChannelReliability(DataChannelKind::VIDEO) },
+        { "unordered-life", lifetime },
+        { "ordered-reliable", reliable },
+    };
+
+    std::printf("link %.0f Mbps, atraso %.0f ms, video %.1f Mbps @ %u fps, %u s\n",
+                options.linkMbps, options.delayMs, options.videoMbps, VIDEO_FPS, options.seconds);
+    std::printf("%6s %-17s %7s %7s %7s %7s %7s %8s %8s %8s %8s %8s\n",
+                "loss%", "video", "entr%", "p50", "p95", "p99", "max", "retrans",
+                "cur%", "cur p99", "inp%", "inp p99");
+
+    for (double loss : options.lossPercents) {
+        for (const VideoMode& mode : modes) {
+            RunLoop(options, loss, mode);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,482 @@
+/**
+ * @file FanoutMain.cpp
+ * @brief rdc_fanout: um host, N viewers em links emulados; codificar uma vez contra uma vez por viewer
+ *
+ * Tudo em tempo virtual (passo de 1 ms) sobre EmulatedLink, um por viewer, com perfis
+ * em rodízio (lan, wifi, dsl, mobile). O "encoder" é o delta por tiles de SessionResume.h:
+ * keyframe = frame BGRA completo, demais = tiles alterados desde o frame anterior, então
+ * um delta perdido quebra a cadeia até o próximo keyframe (FrameChainTracker no viewer
+ * pede KEYFRAME_REQUEST).
+ * - fanout:     um encoder e um FanoutSender com N viewers (buffer compartilhado)
+ * - per-viewer: um encoder e um FanoutSender por viewer (o que seria N sessões 1:1)
+ *
+ * O tempo de CPU medido é só o do host (encode + PublishFrame + Service, que inclui o
+ * envio para o link), por frame da fonte. Com encoder de hardware o encode custa
+ * milissegundos e a diferença entre os modos cresce na mesma proporção.
+ */
+
+#include "FanoutSender.h"
+#include "LinkEmulator.h"
+#include "P2PManager.h"
+#include "SessionResume.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t SIM_STEP_US = 1000;
+constexpr uint64_t DRAIN_MS = 1000;
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+constexpr uint32_t BOX_SIZE = 20;
+constexpr double PACING_SHARE = 0.9;        // Ritmo do viewer = 90% da banda do link
+
+struct FanoutOptions {
+    std::vector<size_t> viewerCounts = { 1, 5, 10, 25, 50 };
+    uint32_t seconds = 10;
+    uint32_t fps = 30;
+    uint32_t width = 120;                   // 120x120 BGRA: o keyframe cabe em um datagrama
+    uint32_t height = 120;
+    uint32_t tileSize = 16;
+    bool runFanout = true;
+    bool runPerViewer = true;
+    uint64_t seed = 7;
+};
+
+struct ViewerProfile {
+    const char* name;
+    LinkProfile link;
+};
+
+std::vector<ViewerProfile> BuildProfiles() {
+    std::vector<ViewerProfile> profiles(4);
+
+    profiles[0].name = "lan";
+    profiles[0].link.bandwidthKbps = 100000.0;
+    profiles[0].link.delayMs = 2.0;
+
+    profiles[1].name = "wifi";
+    profiles[1].link.bandwidthKbps = 20000.0;
+    profiles[1].link.delayMs = 10.0;
+    profiles[1].link.jitterMs = 3.0;
+    profiles[1].link.lossPercent = 0.5;
+
+    profiles[2].name = "dsl";
+    profiles[2].link.bandwidthKbps = 6000.0;
+    profiles[2].link.delayMs = 30.0;
+    profiles[2].link.lossPercent = 1.0;
+
+    profiles[3].name = "mobile";
+    profiles[3].link.bandwidthKbps = 3000.0;
+    profiles[3].link.delayMs = 60.0;
+    profiles[3].link.jitterMs = 8.0;
+    profiles[3].link.burstLoss.enabled = true;
+    profiles[3].link.burstLoss.goodToBadPercent = 1.0;
+    profiles[3].link.burstLoss.badToGoodPercent = 30.0;
+    profiles[3].link.burstLoss.lossInBadPercent = 50.0;
+
+    return profiles;
+}
+
+// Tela sintética: fundo fixo, um quadrado que anda e um "relógio" que pisca
+void RenderFrame(uint32_t index, const FanoutOptions& options, std::vector<uint8_t>& pixels) {
+    uint32_t stride = options.width * BYTES_PER_PIXEL;
+    pixels.resize(static_cast<size_t>(stride) * options.height);
+
+    for (uint32_t y = 0; y < options.height; ++y) {
+        uint8_t* row = pixels.data() + static_cast<size_t>(y) * stride;
+        for (uint32_t x = 0; x < options.width; ++x) {
+            row[x * 4 + 0] = static_cast<uint8_t>(x * 2);
+            row[x * 4 + 1] = static_cast<uint8_t>(y * 2);
+            row[x * 4 + 2] = 0x40;
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+
+    uint32_t span = options.width - BOX_SIZE;
+    uint32_t position = (index * 2) % (2 * span);
+    uint32_t boxX = position < span ? position : 2 * span - position;
+    uint32_t boxY = options.height / 3;
+    for (uint32_t y = boxY; y < boxY + BOX_SIZE && y < options.height; ++y) {
+        std::memset(pixels.data() + static_cast<size_t>(y) * stride + boxX * BYTES_PER_PIXEL, 0xE0,
+                    BOX_SIZE * BYTES_PER_PIXEL);
+    }
+
+    uint8_t clock = static_cast<uint8_t>(index * 37);
+    for (uint32_t y = options.height - 8; y < options.height; ++y) {
+        std::memset(pixels.data() + static_cast<size_t>(y) * stride + (options.width - 8) * BYTES_PER_PIXEL,
+                    clock, 8 * BYTES_PER_PIXEL);
+    }
+}
+
+/**
+ * Delta por tiles contra o frame anterior; keyframe = frame completo
+ */
+class TileDeltaEncoder {
+public:
+    explicit TileDeltaEncoder(const FanoutOptions& options) : m_options(options) {}
+
+    // outFlags recebe FRAME_FLAG_TILE_DELTA nos deltas
+    void Encode(const std::vector<uint8_t>& pixels, uint16_t sequence, bool forceKeyframe,
+                EncodedFrame& outFrame, uint8_t& outFlags) {
+        uint32_t stride = m_options.width * BYTES_PER_PIXEL;
+        bool keyframe = forceKeyframe || m_previous.empty();
+
+        outFrame.width = m_options.width;
+        outFrame.height = m_options.height;
+        outFrame.bitrate = 0;
+        outFrame.timestamp = 0;
+        outFrame.isKeyframe = keyframe;
+        outFlags = 0;
+
+        if (keyframe) {
+            outFrame.data = pixels;
+        } else {
+            uint32_t tileSize = m_options.tileSize;
+            uint32_t tilesX = (m_options.width + tileSize - 1) / tileSize;
+            uint32_t tilesY = (m_options.height + tileSize - 1) / tileSize;
+            m_dirtyTiles.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+
+            for (uint32_t y = 0; y < m_options.height; ++y) {
+                size_t rowOffset = static_cast<size_t>(y) * stride;
+                for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                    uint8_t& dirty = m_dirtyTiles[(y / tileSize) * tilesX + tx];
+                    if (dirty) {
+                        continue;
+                    }
+                    uint32_t x = tx * tileSize;
+                    uint32_t bytes = (std::min(tileSize, m_options.width - x)) * BYTES_PER_PIXEL;
+                    size_t offset = rowOffset + x * BYTES_PER_PIXEL;
+                    dirty = std::memcmp(pixels.data() + offset, m_previous.data() + offset, bytes) != 0;
+                }
+            }
+
+            EncodeTileDelta(pixels.data(), m_options.width, m_options.height, stride, tileSize,
+                            m_dirtyTiles, m_previousSequence, outFrame.data);
+            outFlags = FRAME_FLAG_TILE_DELTA;
+        }
+
+        m_previous = pixels;
+        m_previousSequence = sequence;
+    }
+
+private:
+    const FanoutOptions& m_options;
+    std::vector<uint8_t> m_previous;
+    uint16_t m_previousSequence = 0;
+    std::vector<uint8_t> m_dirtyTiles;
+};
+
+struct ViewerClient {
+    std::shared_ptr<EmulatedLink> link;
+    P2PManager transport;
+    FrameChainTracker tracker;
+    size_t profile = 0;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> received;
+    uint64_t applyFailures = 0;
+    std::vector<double> latenciesMs;
+
+    double Percentile(double fraction) {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latenciesMs.size() - 1,
+                                static_cast<size_t>(fraction * latenciesMs.size()));
+        std::nth_element(latenciesMs.begin(), latenciesMs.begin() + index, latenciesMs.end());
+        return latenciesMs[index];
+    }
+};
+
+struct RunResult {
+    double encodeUsPerFrame = 0.0;
+    double sendUsPerFrame = 0.0;            // PublishFrame + Service
+    uint64_t framesPublished = 0;
+    uint64_t encodes = 0;
+};
+
+// Recebe frames, aplica deltas e pede keyframe quando a cadeia quebra
+void PollClient(ViewerClient& client, const std::vector<uint64_t>& publishUs, uint64_t nowUs) {
+    uint32_t width = 0, height = 0, stride = 0;
+    uint16_t sequence = 0;
+
+    while (client.transport.ReceiveFrame(client.received, width, height, stride, sequence)) {
+        uint8_t flags = client.transport.GetLastFrameFlags();
+        if (!client.tracker.OnFrame(sequence, flags)) {
+            continue;
+        }
+
+        bool applied = true;
+        if (flags & FRAME_FLAG_TILE_DELTA) {
+            applied = client.frame.size() == static_cast<size_t>(stride) * height &&
+                      ApplyTileDelta(client.received.data(), client.received.size(), client.frame.data(),
+                                     width, height, stride);
+        } else {
+            client.frame = client.received;
+        }
+        if (!applied) {
+            client.applyFailures++;
+            client.tracker.MarkUndecodable();
+            continue;
+        }
+        client.latenciesMs.push_back((nowUs - publishUs[sequence]) / 1000.0);
+    }
+
+    KeyframeRequestMessage request;
+    if (client.tracker.PollKeyframeRequest(nowUs / 1000, request)) {
+        client.transport.SendControlMessage(PacketType::KEYFRAME_REQUEST,
+                                            reinterpret_cast<const uint8_t*>(&request), sizeof(request));
+    }
+}
+
+RunResult RunSession(const FanoutOptions& options, size_t viewerCount, bool shared,
+                     std::vector<std::unique_ptr<ViewerClient>>& outClients,
+                     std::vector<FanoutSender::ViewerStats>& outViewerStats) {
+    std::vector<ViewerProfile> profiles = BuildProfiles();
+    LinkProfile returnPath;
+    returnPath.delayMs = 5.0;
+
+    // shared: um sender com todos; senão um sender (e um encoder) por viewer
+    size_t senderCount = shared ? 1 : viewerCount;
+    std::vector<std::unique_ptr<FanoutSender>> senders;
+    std::vector<std::unique_ptr<TileDeltaEncoder>> encoders;
+    for (size_t i = 0; i < senderCount; ++i) {
+        senders.push_back(std::make_unique<FanoutSender>());
+        encoders.push_back(std::make_unique<TileDeltaEncoder>(options));
+    }
+
+    outClients.clear();
+    for (size_t v = 0; v < viewerCount; ++v) {
+        auto client = std::make_unique<ViewerClient>();
+        client->profile = v % profiles.size();
+        const LinkProfile& link = profiles[client->profile].link;
+        client->link = std::make_shared<EmulatedLink>(link, options.seed + v);
+        client->link->SetProfile(EmulatedLink::Side::B, returnPath);
+
+        auto hostSide = std::make_unique<P2PManager>();
+        hostSide->InitializeWithChannel(client->link->CreateEndpoint(EmulatedLink::Side::A), P2PManager::Role::SERVER);
+        client->transport.InitializeWithChannel(client->link->CreateEndpoint(EmulatedLink::Side::B),
+                                                P2PManager::Role::CLIENT);
+
+        FanoutViewerConfig config;
+        config.maxRateKbps = PACING_SHARE * link.bandwidthKbps;
+        senders[shared ? 0 : v]->AddViewer(std::move(hostSide), config);
+        outClients.push_back(std::move(client));
+    }
+
+    std::vector<uint64_t> publishUs(65536, 0);
+    std::vector<uint8_t> pixels;
+    EncodedFrame encoded;
+    uint8_t flags = 0;
+    RunResult result;
+    double encodeUs = 0.0;
+    double sendUs = 0.0;
+
+    uint64_t endUs = static_cast<uint64_t>(options.seconds) * 1000000;
+    uint64_t drainEndUs = endUs + DRAIN_MS * 1000;
+    uint64_t frameIntervalUs = 1000000 / options.fps;
+    uint64_t nextFrameUs = 0;
+    uint32_t frameIndex = 0;
+
+    for (uint64_t nowUs = 0; nowUs < drainEndUs; nowUs += SIM_STEP_US) {
+        auto hostStart = std::chrono::steady_clock::now();
+
+        if (nowUs < endUs && nowUs >= nextFrameUs) {
+            uint16_t sequence = static_cast<uint16_t>(frameIndex);
+            RenderFrame(frameIndex, options, pixels);
+            publishUs[sequence] = nowUs;
+
+            for (size_t s = 0; s < senderCount; ++s) {
+                auto encodeStart = std::chrono::steady_clock::now();
+                encoders[s]->Encode(pixels, sequence, senders[s]->NeedsKeyframe(nowUs), encoded, flags);
+                auto encodeEnd = std::chrono::steady_clock::now();
+                encodeUs += std::chrono::duration<double, std::micro>(encodeEnd - encodeStart).count();
+                result.encodes++;
+
+                senders[s]->PublishFrame(encoded, options.width * BYTES_PER_PIXEL, sequence, flags);
+            }
+            result.framesPublished++;
+            frameIndex++;
+            nextFrameUs += frameIntervalUs;
+        }
+
+        for (auto& sender : senders) {
+            sender->Service(nowUs);
+        }
+        sendUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - hostStart).count();
+
+        for (auto& client : outClients) {
+            client->link->AdvanceTo(nowUs);
+            PollClient(*client, publishUs, nowUs);
+        }
+    }
+
+    outViewerStats.clear();
+    for (auto& sender : senders) {
+        std::vector<FanoutSender::ViewerStats> stats = sender->GetViewerStats();
+        outViewerStats.insert(outViewerStats.end(), stats.begin(), stats.end());
+    }
+
+    if (result.framesPublished > 0) {
+        result.encodeUsPerFrame = encodeUs / result.framesPublished;
+        result.sendUsPerFrame = (sendUs - encodeUs) / result.framesPublished;
+    }
+    return result;
+}
+
+void PrintViewerTable(const std::vector<std::unique_ptr<ViewerClient>>& clients,
+                      const std::vector<FanoutSender::ViewerStats>& stats, uint64_t framesPublished) {
+    std::vector<ViewerProfile> profiles = BuildProfiles();
+    std::printf("\n%-4s %-7s %8s %6s %5s %6s %6s %5s %6s %7s %7s %7s\n", "id", "perfil", "ritmo",
+                "env", "key", "pulou", "desc", "ped", "falha", "decod%", "p50", "p95");
+    for (size_t v = 0; v < clients.size() && v < stats.size(); ++v) {
+        ViewerClient& client = *clients[v];
+        const FanoutSender::ViewerStats& viewer = stats[v];
+        FrameChainTracker::Stats chain = client.tracker.GetStats();
+        double decodedPercent = framesPublished ? 100.0 * client.latenciesMs.size() / framesPublished : 0.0;
+        std::printf("%-4zu %-7s %8.0f %6llu %5llu %6llu %6llu %5llu %6llu %7.1f %7.1f %7.1f\n",
+                    v + 1, profiles[client.profile].name, viewer.maxRateKbps,
+                    static_cast<unsigned long long>(viewer.framesSent),
+                    static_cast<unsigned long long>(viewer.keyframesSent),
+                    static_cast<unsigned long long>(viewer.framesSkipped),
+                    static_cast<unsigned long long>(viewer.framesDropped),
+                    static_cast<unsigned long long>(chain.requestsSent),
+                    static_cast<unsigned long long>(client.applyFailures),
+                    decodedPercent, client.Percentile(0.50), client.Percentile(0.95));
+    }
+}
+
+bool ParseViewerCounts(const std::string& text, std::vector<size_t>& outCounts) {
+    outCounts.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        long value = std::atol(item.c_str());
+        if (value <= 0) {
+            return false;
+        }
+        outCounts.push_back(static_cast<size_t>(value));
+    }
+    return !outCounts.empty();
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_fanout [opcoes]" << std::endl;
+    std::cout << "  --viewers <n,n,...>      - Numeros de viewers (padrao 1,5,10,25,50)." << std::endl;
+    std::cout << "  --seconds <n>            - Duracao virtual (padrao 10)." << std::endl;
+    std::cout << "  --fps <n>                - Frames por segundo da fonte (padrao 30)." << std::endl;
+    std::cout << "  --size <LxA>             - Tamanho do frame (padrao 120x120)." << std::endl;
+    std::cout << "  --tile <n>               - Lado do tile do delta (padrao 16)." << std::endl;
+    std::cout << "  --mode <both|fanout|per-viewer>" << std::endl;
+    std::cout << "  --seed <n>               - Seed dos links (padrao 7)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    FanoutOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--viewers" && hasValue) {
+            if (!ParseViewerCounts(args[++i], options.viewerCounts)) {
+                std::cerr << "Lista de viewers invalida" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--fps" && hasValue) {
+            options.fps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--size" && hasValue) {
+            unsigned width = 0, height = 0;
+            if (std::sscanf(args[++i].c_str(), "%ux%u", &width, &height) != 2) {
+                std::cerr << "Tamanho invalido (use LxA)" << std::endl;
+                return 1;
+            }
+            options.width = width;
+            options.height = height;
+        } else if (arg == "--tile" && hasValue) {
+            options.tileSize = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--mode" && hasValue) {
+            const std::string& mode = args[++i];
+            options.runFanout = mode == "both" || mode == "fanout";
+            options.runPerViewer = mode == "both" || mode == "per-viewer";
+            if (!options.runFanout && !options.runPerViewer) {
+                std::cerr << "Modo desconhecido: " << mode << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.seconds == 0 || options.fps == 0 || options.width <= BOX_SIZE || options.height < 8 ||
+        options.tileSize == 0 || options.tileSize > UINT16_MAX) {
+        PrintUsage();
+        return 1;
+    }
+    if (static_cast<size_t>(options.width) * options.height * BYTES_PER_PIXEL + sizeof(NetworkFrameHeader) > 65507) {
+        std::cerr << "Keyframe nao cabe em um datagrama UDP: reduza --size" << std::endl;
+        return 1;
+    }
+
+    std::printf("%ux%u @ %u fps, %u s virtuais, perfis em rodizio: lan, wifi, dsl, mobile\n",
+                options.width, options.height, options.fps, options.seconds);
+    std::printf("%-10s %7s %8s %10s %10s %12s %8s %8s\n", "modo", "viewers", "encodes", "encode us",
+                "envio us", "host us/fr", "us/view", "decod%");
+
+    std::vector<std::unique_ptr<ViewerClient>> clients;
+    std::vector<FanoutSender::ViewerStats> viewerStats;
+    std::vector<std::unique_ptr<ViewerClient>> lastFanoutClients;
+    std::vector<FanoutSender::ViewerStats> lastFanoutStats;
+    uint64_t lastFanoutFrames = 0;
+
+    for (size_t viewerCount : options.viewerCounts) {
+        for (int pass = 0; pass < 2; ++pass) {
+            bool shared = pass == 0;
+            if ((shared && !options.runFanout) || (!shared && !options.runPerViewer)) {
+                continue;
+            }
+
+            RunResult result = RunSession(options, viewerCount, shared, clients, viewerStats);
+
+            double decoded = 0.0;
+            for (auto& client : clients) {
+                decoded += result.framesPublished ? 100.0 * client->latenciesMs.size() / result.framesPublished : 0.0;
+            }
+            double hostUs = result.encodeUsPerFrame + result.sendUsPerFrame;
+            std::printf("%-10s %7zu %8llu %10.1f %10.1f %12.1f %8.2f %8.1f\n", shared ? "fanout" : "per-viewer",
+                        viewerCount, static_cast<unsigned long long>(result.encodes), result.encodeUsPerFrame,
+                        result.sendUsPerFrame, hostUs, hostUs / viewerCount, decoded / clients.size());
+
+            if (shared) {
+                lastFanoutClients = std::move(clients);
+                lastFanoutStats = viewerStats;
+                lastFanoutFrames = result.framesPublished;
+            }
+        }
+    }
+
+    if (!lastFanoutClients.empty()) {
+        PrintViewerTable(lastFanoutClients, lastFanoutStats, lastFanoutFrames);
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file LatencyProbeMain.cpp
+ * @brief rdc_latprobe: probe de latência input → foto sobre captura sintética (roda em Linux)
+ *
+ * Host e cliente são dois P2PManager ligados por EmulatedLink, em tempo virtual.
+ * O host "captura" uma tela sintética na taxa de captura, grava o marcador do
+ * LatencyProbeHost e envia o frame cru; o cliente apresenta cada frame no próximo
+ * vsync e mede com LatencyProbeClient, exatamente como no pipeline real.
+ *
+ * No modo pixel a aplicação sintética reage à tecla do probe depois de --app-ms,
+ * e o marcador só aparece no primeiro frame alterado.
+ */
+
+#include "LatencyProbe.h"
+#include "LinkEmulator.h"
+#include "P2PManager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t SIM_STEP_US = 250;
+constexpr int HISTOGRAM_BAR_WIDTH = 40;
+
+struct ProbeOptions {
+    ProbeMode mode = ProbeMode::MARKER;
+    double delayMs = 10.0;
+    double jitterMs = 0.0;
+    double lossPercent = 0.0;
+    uint32_t captureFps = 60;
+    uint32_t displayHz = 60;
+    double encodeMs = 4.0;              // Captura → envio (cópia + encode)
+    double appMs = 16.0;                // Modo pixel: tecla → tela alterada
+    uint32_t durationS = 30;
+    uint64_t seed = 1;
+    uint32_t width = 480;
+    uint32_t height = 270;
+};
+
+struct PendingSend {
+    uint64_t sendUs;
+    std::vector<uint8_t> pixels;
+};
+
+void PrintHistogram(const LatencyHistogram& histogram) {
+    uint64_t largest = 1;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        largest = std::max(largest, histogram.GetBucket(i));
+    }
+
+    double lower = 0.0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        char range[32];
+        if (i < LATENCY_BUCKETS_MS.size()) {
+            std::snprintf(range, sizeof(range), "%5.0f-%-5.0f ms", lower, LATENCY_BUCKETS_MS[i]);
+            lower = LATENCY_BUCKETS_MS[i];
+        } else {
+            std::snprintf(range, sizeof(range), "%5.0f+      ms", lower);
+        }
+
+        int bar = static_cast<int>(histogram.GetBucket(i) * HISTOGRAM_BAR_WIDTH / largest);
+        std::printf("  %s %6llu %s\n", range, static_cast<unsigned long long>(histogram.GetBucket(i)),
+                    std::string(bar, '#').c_str());
+    }
+}
+
+int RunProbe(const ProbeOptions& options) {
+    LinkProfile profile;
+    profile.delayMs = options.delayMs;
+    profile.jitterMs = options.jitterMs;
+    profile.lossPercent = options.lossPercent;
+    profile.queueLimitBytes = 16 * 1024 * 1024;   // Frames crus: sem tail drop no gargalo
+
+    auto link = std::make_shared<EmulatedLink>(profile, options.seed);
+
+    P2PManager host;
+    P2PManager client;
+    host.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::A), P2PManager::Role::SERVER);
+    client.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::B), P2PManager::Role::CLIENT);
+
+    LatencyProbeHost probeHost;
+    LatencyProbeClient probeClient(options.mode, options.mode == ProbeMode::PIXEL_CHANGE ? 0x7E : 0);
+
+    const uint32_t stride = options.width * 4;
+    std::vector<uint8_t> screen(static_cast<size_t>(stride) * options.height, 0x40);
+    bool screenChanged = true;
+    uint8_t appShade = 0x40;
+
+    std::deque<uint64_t> appReactionsUs;   // Modo pixel: instantes em que a tela muda
+    std::deque<PendingSend> encodeQueue;
+
+    std::vector<uint8_t> received;
+    std::vector<uint8_t> presentPixels;
+    uint32_t presentWidth = 0, presentHeight = 0, presentStride = 0;
+    bool hasNewFrame = false;
+
+    const uint64_t captureIntervalUs = 1000000 / options.captureFps;
+    const uint64_t vsyncIntervalUs = 1000000 / options.displayHz;
+    const uint64_t encodeUs = static_cast<uint64_t>(options.encodeMs * 1000);
+    const uint64_t appUs = static_cast<uint64_t>(options.appMs * 1000);
+    const uint64_t endUs = static_cast<uint64_t>(options.durationS) * 1000000;
+
+    // Fases diferentes para captura e vsync, como em máquinas distintas
+    uint64_t nextCaptureUs = captureIntervalUs / 3;
+    uint64_t nextVsyncUs = vsyncIntervalUs / 2;
+    uint16_t frameSequence = 0;
+
+    for (uint64_t nowUs = 0; nowUs <= endUs; nowUs += SIM_STEP_US) {
+        link->AdvanceTo(nowUs);
+
+        // Cliente: dispara probes
+        LatencyProbeMessage message;
+        if (probeClient.ShouldSend(nowUs, message)) {
+            client.SendControlMessage(PacketType::LATENCY_PROBE,
+                                      reinterpret_cast<const uint8_t*>(&message), sizeof(message));
+        }
+
+        // Host: probes recebidos (a "injeção" da tecla agenda a reação da aplicação)
+        PacketType type;
+        std::vector<uint8_t> payload;
+        while (host.ReceiveControlMessage(type, payload)) {
+            if (type != PacketType::LATENCY_PROBE || payload.size() != sizeof(LatencyProbeMessage)) {
+                continue;
+            }
+            LatencyProbeMessage probe;
+            std::memcpy(&probe, payload.data(), sizeof(probe));
+            if (probe.virtualKey != 0) {
+                appReactionsUs.push_back(nowUs + appUs);
+            }
+            probeHost.OnProbe(probe, nowUs);
+        }
+
+        while (!appReactionsUs.empty() && appReactionsUs.front() <= nowUs) {
+            appReactionsUs.pop_front();
+            appShade = static_cast<uint8_t>(appShade ^ 0x20);
+            std::fill(screen.begin() + stride * (options.height / 2), screen.end(), appShade);
+            screenChanged = true;
+        }
+
+        // Host: captura na taxa configurada
+        if (nowUs >= nextCaptureUs) {
+            nextCaptureUs += captureIntervalUs;
+            if (screenChanged || probeHost.NeedsFrame()) {
+                probeHost.StampFrame(screen.data(), options.width, options.height, stride,
+                                     screenChanged, nowUs);
+                encodeQueue.push_back({ nowUs + encodeUs, screen });
+                screenChanged = false;
+            }
+        }
+
+        while (!encodeQueue.empty() && encodeQueue.front().sendUs <= nowUs) {
+            host.SendFrame(encodeQueue.front().pixels.data(), options.width, options.height,
+                           stride, frameSequence++);
+            encodeQueue.pop_front();
+        }
+
+        // Cliente: guarda o último frame e apresenta no vsync
+        uint32_t width, height, frameStride;
+        uint16_t sequence;
+        while (client.ReceiveFrame(received, width, height, frameStride, sequence)) {
+            presentPixels.swap(received);
+            presentWidth = width;
+            presentHeight = height;
+            presentStride = frameStride;
+            hasNewFrame = true;
+        }
+
+        if (nowUs >= nextVsyncUs) {
+            nextVsyncUs += vsyncIntervalUs;
+            if (hasNewFrame) {
+                probeClient.OnFramePresented(presentPixels.data(), presentWidth, presentHeight,
+                                             presentStride, nowUs);
+                hasNewFrame = false;
+            }
+        }
+    }
+
+    const LatencyHistogram& histogram = probeClient.GetHistogram();
+    LatencyProbeClient::ProbeStats stats = probeClient.GetStats();
+
+    std::printf("modo %s | link %.1f ms (+-%.1f), perda %.1f%% | captura %u fps, display %u Hz, encode %.1f ms",
+                options.mode == ProbeMode::PIXEL_CHANGE ? "pixel" : "marker",
+                options.delayMs, options.jitterMs, options.lossPercent,
+                options.captureFps, options.displayHz, options.encodeMs);
+    if (options.mode == ProbeMode::PIXEL_CHANGE) {
+        std::printf(", app %.1f ms", options.appMs);
+    }
+    std::printf("\n\n");
+
+    std::printf("probes %llu, medidos %llu, timeouts %llu\n",
+                static_cast<unsigned long long>(stats.probesSent),
+                static_cast<unsigned long long>(stats.probesCompleted),
+                static_cast<unsigned long long>(stats.probesTimedOut));
+    std::printf("min %.1f | p50 %.1f | p95 %.1f | p99 %.1f | max %.1f ms\n\n",
+                histogram.GetMinMs(), histogram.Percentile(0.50), histogram.Percentile(0.95),
+                histogram.Percentile(0.99), histogram.GetMaxMs());
+    PrintHistogram(histogram);
+
+    return stats.probesCompleted > 0 ? 0 : 2;
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_latprobe [opcoes]" << std::endl;
+    std::cout << "  --mode marker|pixel       - Marcador no proximo frame / no primeiro frame alterado." << std::endl;
+    std::cout << "  --delay-ms <n>            - Atraso do link em cada direcao (padrao: 10)." << std::endl;
+    std::cout << "  --jitter-ms <n>           - Jitter do link (padrao: 0)." << std::endl;
+    std::cout << "  --loss <pct>              - Perda de pacotes (padrao: 0)." << std::endl;
+    std::cout << "  --fps <n>                 - Taxa de captura do host (padrao: 60)." << std::endl;
+    std::cout << "  --display-hz <n>          - Refresh do cliente (padrao: 60)." << std::endl;
+    std::cout << "  --encode-ms <n>           - Tempo de captura ate envio (padrao: 4)." << std::endl;
+    std::cout << "  --app-ms <n>              - Modo pixel: reacao da aplicacao a tecla (padrao: 16)." << std::endl;
+    std::cout << "  --duration-s <n>          - Duracao simulada (padrao: 30)." << std::endl;
+    std::cout << "  --seed <n>                - Seed do link." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    ProbeOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--mode" && hasValue) {
+            const std::string& value = args[++i];
+            if (value == "pixel") {
+                options.mode = ProbeMode::PIXEL_CHANGE;
+            } else if (value == "marker") {
+                options.mode = ProbeMode::MARKER;
+            } else {
+                std::cerr << "Modo desconhecido: " << value << std::endl;
+                return 1;
+            }
+        } else if (arg == "--delay-ms" && hasValue) {
+            options.delayMs = std::atof(args[++i].c_str());
+        } else if (arg == "--jitter-ms" && hasValue) {
+            options.jitterMs = std::atof(args[++i].c_str());
+        } else if (arg == "--loss" && hasValue) {
+            options.lossPercent = std::atof(args[++i].c_str());
+        } else if (arg == "--fps" && hasValue) {
+            options.captureFps = std::max(1, std::atoi(args[++i].c_str()));
+        } else if (arg == "--display-hz" && hasValue) {
+            options.displayHz = std::max(1, std::atoi(args[++i].c_str()));
+        } else if (arg == "--encode-ms" && hasValue) {
+            options.encodeMs = std::atof(args[++i].c_str());
+        } else if (arg == "--app-ms" && hasValue) {
+            options.appMs = std::atof(args[++i].c_str());
+        } else if (arg == "--duration-s" && hasValue) {
+            options.durationS = static_cast<uint32_t>(std::max(1, std::atoi(args[++i].c_str())));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    return RunProbe(options);
+}
@@ -0,0 +1,520 @@
+/**
+ * @file NetSimMain.cpp
+ * @brief rdc_netsim: roda cenários de rede sobre dois P2PManager ligados por EmulatedLink
+ *
+ * Tudo em tempo virtual (passo de 1 ms) com seed fixa: o mesmo cenário gera sempre
+ * o mesmo relatório, em qualquer máquina. O sender produz frames "codificados" de
+ * tamanho bitrate/fps conforme o AdaptiveBitRateController; o receiver devolve
+ * perda, latência, buffer do decoder e (para MODEL_BASED) os instantes de envio/chegada
+ * de cada frame (feedback ideal, sem passar pelo link).
+ *
+ * Comparação entre modos, por segmento do cenário (entre dois "at"):
+ * - conv: tempo até o alvo ficar 2 s seguidos dentro de ±15% do alvo justo
+ *   (85% da banda do segmento, limitado ao range do ABR); segmentos que não
+ *   convergem contam a duração inteira
+ * - osc: desvio padrão / média do alvo na segunda metade do segmento
+ */
+
+#include "LinkEmulator.h"
+#include "OptimizationLayer.h"
+#include "P2PManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SIM_FPS = 60;
+constexpr uint32_t SIM_SOURCE_WIDTH = 1920;      // Captura simulada (escada padrão)
+constexpr uint32_t SIM_SOURCE_HEIGHT = 1080;
+constexpr uint64_t SIM_STEP_US = 1000;
+constexpr uint64_t FEEDBACK_INTERVAL_MS = 100;
+constexpr uint64_t DRAIN_MS = 3000;
+constexpr double FAIR_SHARE = 0.85;
+constexpr double CONVERGENCE_BAND = 0.15;
+constexpr uint64_t CONVERGENCE_HOLD_MS = 2000;
+
+struct SimOptions {
+    std::string abrMode = "balanced";   // fixed | conservative | balanced | aggressive | model
+    uint32_t minBitrateMbps = 2;
+    uint32_t maxBitrateMbps = 30;
+    uint32_t fixedBitrateMbps = 8;
+    double decodeMbps = 0.0;            // Vazão do decoder simulado (0 = instantâneo)
+    bool timeline = false;
+};
+
+struct TargetSample {
+    uint64_t tMs;
+    double targetKbps;
+};
+
+struct SimReport {
+    std::string scenario;
+    std::string abrMode;
+    uint64_t framesSent = 0;
+    uint64_t framesReceived = 0;
+    uint64_t duplicatesReceived = 0;
+    uint64_t bytesReceived = 0;
+    double durationS = 0.0;
+    double averageTargetMbps = 0.0;
+    uint32_t bitrateChanges = 0;
+    double convergenceS = 0.0;
+    double oscillationPercent = 0.0;
+    std::vector<double> latenciesMs;
+
+    double FrameLossPercent() const {
+        return framesSent ? 100.0 * (framesSent - framesReceived) / framesSent : 0.0;
+    }
+
+    double ThroughputMbps() const {
+        return durationS > 0.0 ? bytesReceived * 8.0 / durationS / 1e6 : 0.0;
+    }
+
+    double LatencyPercentile(double fraction) {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latenciesMs.size() - 1,
+                                static_cast<size_t>(fraction * latenciesMs.size()));
+        std::nth_element(latenciesMs.begin(), latenciesMs.begin() + index, latenciesMs.end());
+        return latenciesMs[index];
+    }
+
+    double LatencyAverage() const {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        double sum = 0.0;
+        for (double value : latenciesMs) {
+            sum += value;
+        }
+        return sum / latenciesMs.size();
+    }
+};
+
+bool ParseAbrMode(const std::string& name, AdaptiveBitRateController::AdaptationMode& outMode) {
+    if (name == "conservative") {
+        outMode = AdaptiveBitRateController::AdaptationMode::CONSERVATIVE;
+    } else if (name == "balanced") {
+        outMode = AdaptiveBitRateController::AdaptationMode::BALANCED;
+    } else if (name == "aggressive") {
+        outMode = AdaptiveBitRateController::AdaptationMode::AGGRESSIVE;
+    } else if (name == "model") {
+        outMode = AdaptiveBitRateController::AdaptationMode::MODEL_BASED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Convergência e oscilação do alvo em cada segmento do cenário
+void EvaluateConvergence(const LinkScenario& scenario, const SimOptions& options,
+                         const std::vector<TargetSample>& samples, SimReport& report) {
+    double convergenceSum = 0.0;
+    double oscillationSum = 0.0;
+    size_t segments = 0;
+
+    for (size_t s = 0; s < scenario.steps.size(); ++s) {
+        uint64_t startMs = scenario.steps[s].atMs;
+        uint64_t endMs = s + 1 < scenario.steps.size() ? scenario.steps[s + 1].atMs : scenario.durationMs;
+        if (endMs <= startMs) {
+            continue;
+        }
+
+        double bandwidthKbps = scenario.steps[s].profile.bandwidthKbps;
+        double fairKbps = options.maxBitrateMbps * 1000.0;
+        if (bandwidthKbps > 0.0) {
+            fairKbps = std::min(fairKbps, FAIR_SHARE * bandwidthKbps);
+        }
+        fairKbps = std::max(fairKbps, options.minBitrateMbps * 1000.0);
+
+        std::vector<TargetSample> segment;
+        for (const TargetSample& sample : samples) {
+            if (sample.tMs >= startMs && sample.tMs < endMs) {
+                segment.push_back(sample);
+            }
+        }
+        if (segment.empty()) {
+            continue;
+        }
+
+        // Primeiro instante a partir do qual o alvo fica CONVERGENCE_HOLD_MS dentro da banda
+        double convergenceMs = static_cast<double>(endMs - startMs);
+        size_t runStart = 0;
+        bool inRun = false;
+        for (size_t i = 0; i < segment.size(); ++i) {
+            bool inside = std::fabs(segment[i].targetKbps - fairKbps) <= CONVERGENCE_BAND * fairKbps;
+            if (!inside) {
+                inRun = false;
+                continue;
+            }
+            if (!inRun) {
+                inRun = true;
+                runStart = i;
+            }
+            if (segment[i].tMs - segment[runStart].tMs >= CONVERGENCE_HOLD_MS) {
+                convergenceMs = static_cast<double>(segment[runStart].tMs - startMs);
+                break;
+            }
+        }
+
+        // Oscilação na segunda metade do segmento
+        uint64_t halfMs = startMs + (endMs - startMs) / 2;
+        double sum = 0.0, sumSquares = 0.0;
+        size_t count = 0;
+        for (const TargetSample& sample : segment) {
+            if (sample.tMs >= halfMs) {
+                sum += sample.targetKbps;
+                sumSquares += sample.targetKbps * sample.targetKbps;
+                count++;
+            }
+        }
+        if (count > 0 && sum > 0.0) {
+            double mean = sum / count;
+            double variance = std::max(0.0, sumSquares / count - mean * mean);
+            oscillationSum += 100.0 * std::sqrt(variance) / mean;
+        }
+
+        convergenceSum += convergenceMs / 1000.0;
+        segments++;
+    }
+
+    if (segments > 0) {
+        report.convergenceS = convergenceSum / segments;
+        report.oscillationPercent = oscillationSum / segments;
+    }
+}
+
+SimReport RunScenario(const LinkScenario& scenario, const SimOptions& options) {
+    SimReport report;
+    report.scenario = scenario.name;
+    report.abrMode = options.abrMode;
+
+    auto link = std::make_shared<EmulatedLink>(scenario.ProfileAt(0), scenario.seed);
+
+    P2PManager sender;
+    P2PManager receiver;
+    sender.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::A), P2PManager::Role::SERVER);
+    receiver.InitializeWithChannel(link->CreateEndpoint(EmulatedLink::Side::B), P2PManager::Role::CLIENT);
+
+    const bool fixedBitrate = options.abrMode == "fixed";
+    AdaptiveBitRateController abr(options.minBitrateMbps, options.maxBitrateMbps);
+    AdaptiveBitRateController::AdaptationMode mode;
+    if (!fixedBitrate && ParseAbrMode(options.abrMode, mode)) {
+        abr.SetAdaptationMode(mode);
+        abr.SetLadder(AdaptiveBitRateController::BuildDefaultLadder(SIM_SOURCE_WIDTH, SIM_SOURCE_HEIGHT));
+    }
+
+    uint64_t nowUs = 0;
+    abr.SetTimeSource([&nowUs]() { return nowUs / 1000.0; });
+
+    // Decoder simulado: fila de trabalho em µs
+    uint64_t decoderBusyUntilUs = 0;
+    std::vector<TargetSample> targetSamples;
+
+    // Frame i leva o índice nos primeiros 8 bytes do payload
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> received;
+    std::map<uint64_t, uint64_t> outstandingSendUs;
+    uint64_t nextFrameIndex = 0;
+
+    // Janela de feedback (estilo receiver report: perda pelos gaps de índice)
+    uint64_t windowHighestIndex = 0;
+    uint64_t reportedHighestIndex = 0;
+    uint64_t windowReceived = 0;
+    uint64_t windowBytes = 0;
+    double windowLatencySum = 0.0;
+    double targetMbpsSum = 0.0;
+    uint64_t targetFrameCount = 0;
+
+    const LinkProfile* activeProfile = &scenario.ProfileAt(0);
+    const uint64_t endUs = scenario.durationMs * 1000;
+    const uint64_t drainEndUs = endUs + DRAIN_MS * 1000;
+    uint64_t nextFrameUs = 0;
+    uint64_t nextFeedbackUs = FEEDBACK_INTERVAL_MS * 1000;
+
+    if (options.timeline) {
+        std::printf("%8s %10s %10s %10s %8s %10s %12s\n",
+                    "t(s)", "link Mbps", "target", "goodput", "loss%", "lat ms", "rung");
+    }
+
+    for (nowUs = 0; nowUs <= drainEndUs; nowUs += SIM_STEP_US) {
+        link->AdvanceTo(nowUs);
+
+        const LinkProfile* profile = &scenario.ProfileAt(nowUs / 1000);
+        if (profile != activeProfile) {
+            link->SetProfile(*profile);
+            activeProfile = profile;
+        }
+
+        uint32_t targetKbps = fixedBitrate ? options.fixedBitrateMbps * 1000 : abr.GetTargetBitrateKbps();
+        OperatingPoint point = abr.GetOperatingPoint();
+        const uint32_t fps = fixedBitrate ? SIM_FPS : point.fps;
+
+        // Sender
+        if (nowUs < endUs && nowUs >= nextFrameUs) {
+            size_t frameBytes = std::max<size_t>(sizeof(uint64_t),
+                                                 static_cast<size_t>(targetKbps) * 1000 / 8 / fps);
+            payload.resize(frameBytes);
+            std::memcpy(payload.data(), &nextFrameIndex, sizeof(uint64_t));
+
+            sender.SendFrame(payload.data(), static_cast<uint32_t>(frameBytes), 1,
+                             static_cast<uint32_t>(frameBytes),
+                             static_cast<uint16_t>(nextFrameIndex));
+            outstandingSendUs[nextFrameIndex] = nowUs;
+            nextFrameIndex++;
+            report.framesSent++;
+            nextFrameUs += 1000000 / fps;
+
+            targetMbpsSum += targetKbps / 1000.0;
+            targetFrameCount++;
+        }
+
+        // Receiver
+        uint32_t width = 0, height = 0, stride = 0;
+        uint16_t sequence = 0;
+        while (receiver.ReceiveFrame(received, width, height, stride, sequence)) {
+            if (received.size() < sizeof(uint64_t)) {
+                continue;
+            }
+
+            uint64_t frameIndex = 0;
+            std::memcpy(&frameIndex, received.data(), sizeof(uint64_t));
+
+            auto it = outstandingSendUs.find(frameIndex);
+            if (it == outstandingSendUs.end()) {
+                report.duplicatesReceived++;
+                continue;
+            }
+
+            double latencyMs = (nowUs - it->second) / 1000.0;
+            abr.OnPacketFeedback(it->second / 1000.0, nowUs / 1000.0,
+                                 received.size() + sizeof(NetworkFrameHeader));
+            outstandingSendUs.erase(it);
+
+            if (options.decodeMbps > 0.0) {
+                uint64_t decodeUs = static_cast<uint64_t>(received.size() * 8.0 / options.decodeMbps);
+                decoderBusyUntilUs = std::max(decoderBusyUntilUs, nowUs) + decodeUs;
+            }
+
+            report.framesReceived++;
+            report.bytesReceived += received.size() + sizeof(NetworkFrameHeader);
+            report.latenciesMs.push_back(latencyMs);
+
+            windowHighestIndex = std::max(windowHighestIndex, frameIndex + 1);
+            windowReceived++;
+            windowBytes += received.size() + sizeof(NetworkFrameHeader);
+            windowLatencySum += latencyMs;
+        }
+
+        // Feedback para o ABR
+        if (nowUs >= nextFeedbackUs && nowUs <= endUs) {
+            uint64_t expected = windowHighestIndex > reportedHighestIndex
+                                    ? windowHighestIndex - reportedHighestIndex : 0;
+            double lossPercent = expected > windowReceived
+                                     ? 100.0 * (expected - windowReceived) / expected : 0.0;
+
+            // Sem chegadas na janela: a latência é a idade do frame mais antigo pendente
+            double latencyMs = 0.0;
+            if (windowReceived > 0) {
+                latencyMs = windowLatencySum / windowReceived;
+            } else if (!outstandingSendUs.empty()) {
+                latencyMs = (nowUs - outstandingSendUs.begin()->second) / 1000.0;
+            }
+
+            double decoderBufferMs = decoderBusyUntilUs > nowUs
+                                         ? (decoderBusyUntilUs - nowUs) / 1000.0 : 0.0;
+
+            if (!fixedBitrate) {
+                abr.UpdateMetrics(latencyMs, lossPercent, decoderBufferMs);
+            }
+            targetSamples.push_back({ nowUs / 1000, static_cast<double>(targetKbps) });
+
+            if (options.timeline && (nowUs / 1000) % 1000 == 0) {
+                char rung[32] = "-";
+                if (!fixedBitrate) {
+                    std::snprintf(rung, sizeof(rung), "%ux%u@%u", point.width ? point.width : SIM_SOURCE_WIDTH,
+                                  point.height ? point.height : SIM_SOURCE_HEIGHT, point.fps);
+                }
+                std::printf("%8.1f %10.1f %10.2f %10.2f %8.2f %10.1f %12s\n",
+                            nowUs / 1e6, activeProfile->bandwidthKbps / 1000.0, targetKbps / 1000.0,
+                            windowBytes * 8.0 / (FEEDBACK_INTERVAL_MS * 1000.0),
+                            lossPercent, latencyMs, rung);
+            }
+
+            reportedHighestIndex = std::max(reportedHighestIndex, windowHighestIndex);
+            windowReceived = 0;
+            windowBytes = 0;
+            windowLatencySum = 0.0;
+            nextFeedbackUs += FEEDBACK_INTERVAL_MS * 1000;
+        }
+    }
+
+    report.durationS = scenario.durationMs / 1000.0;
+    report.averageTargetMbps = targetFrameCount ? targetMbpsSum / targetFrameCount : 0.0;
+    report.bitrateChanges = fixedBitrate ? 0 : abr.GetStats().bitrateChangeCount;
+    EvaluateConvergence(scenario, options, targetSamples, report);
+    return report;
+}
+
+void PrintReportHeader() {
+    std::printf("%-16s %-13s %7s %7s %7s %9s %9s %8s %8s %8s %8s %7s %7s\n",
+                "scenario", "abr", "sent", "recv", "loss%", "goodput", "target", "lat avg",
+                "lat p95", "lat max", "changes", "conv s", "osc%");
+}
+
+void PrintReport(SimReport& report) {
+    double latencyMax = report.latenciesMs.empty()
+                            ? 0.0 : *std::max_element(report.latenciesMs.begin(), report.latenciesMs.end());
+    std::printf("%-16s %-13s %7llu %7llu %7.2f %9.2f %9.2f %8.1f %8.1f %8.1f %8u %7.1f %7.1f\n",
+                report.scenario.c_str(), report.abrMode.c_str(),
+                static_cast<unsigned long long>(report.framesSent),
+                static_cast<unsigned long long>(report.framesReceived),
+                report.FrameLossPercent(), report.ThroughputMbps(), report.averageTargetMbps,
+                report.LatencyAverage(), report.LatencyPercentile(0.95), latencyMax,
+                report.bitrateChanges, report.convergenceS, report.oscillationPercent);
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_netsim [opcoes] [cenario...]" << std::endl;
+    std::cout << "  cenario                   - Nome embutido ou arquivo de script (.txt)." << std::endl;
+    std::cout << "                              Sem cenarios: roda todos os embutidos." << std::endl;
+    std::cout << "  --abr <modo|all>          - fixed, conservative, balanced (padrao), aggressive, model." << std::endl;
+    std::cout << "  --fixed <mbps>            - Bitrate do modo fixed (padrao 8)." << std::endl;
+    std::cout << "  --range <min> <max>       - Limites do ABR em Mbps (padrao 2 30)." << std::endl;
+    std::cout << "  --seed <n>                - Sobrescreve a seed dos cenarios." << std::endl;
+    std::cout << "  --decode-mbps <n>         - Vazao do decoder simulado (padrao: instantaneo)." << std::endl;
+    std::cout << "  --timeline                - Imprime uma linha por segundo simulado." << std::endl;
+    std::cout << "  --list                    - Lista cenarios embutidos." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    SimOptions options;
+    std::vector<std::string> abrModes;
+    std::vector<std::string> scenarioNames;
+    bool overrideSeed = false;
+    uint64_t seed = 0;
+
+    std::vector<LinkScenario> builtins = BuiltinLinkScenarios();
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--list") {
+            for (const LinkScenario& scenario : builtins) {
+                std::cout << scenario.name << " (" << scenario.durationMs / 1000 << " s)" << std::endl;
+            }
+            return 0;
+        } else if (arg == "--abr" && hasValue) {
+            std::string value = args[++i];
+            if (value == "all") {
+                abrModes = { "fixed", "conservative", "balanced", "aggressive", "model" };
+            } else {
+                abrModes.push_back(value);
+            }
+        } else if (arg == "--fixed" && hasValue) {
+            options.fixedBitrateMbps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--range" && i + 2 < args.size()) {
+            options.minBitrateMbps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+            options.maxBitrateMbps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--seed" && hasValue) {
+            overrideSeed = true;
+            seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (arg == "--decode-mbps" && hasValue) {
+            options.decodeMbps = std::atof(args[++i].c_str());
+        } else if (arg == "--timeline") {
+            options.timeline = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        } else {
+            scenarioNames.push_back(arg);
+        }
+    }
+
+    if (abrModes.empty()) {
+        abrModes.push_back(options.abrMode);
+    }
+
+    for (const std::string& mode : abrModes) {
+        AdaptiveBitRateController::AdaptationMode parsed;
+        if (mode != "fixed" && !ParseAbrMode(mode, parsed)) {
+            std::cerr << "Modo ABR desconhecido: " << mode << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<LinkScenario> scenarios;
+    if (scenarioNames.empty()) {
+        scenarios = builtins;
+    }
+
+    for (const std::string& name : scenarioNames) {
+        auto builtin = std::find_if(builtins.begin(), builtins.end(),
+                                    [&](const LinkScenario& s) { return s.name == name; });
+        if (builtin != builtins.end()) {
+            scenarios.push_back(*builtin);
+            continue;
+        }
+
+        std::ifstream file(name);
+        if (!file) {
+            std::cerr << "Cenario nao encontrado: " << name << std::endl;
+            return 1;
+        }
+
+        std::stringstream text;
+        text << file.rdbuf();
+
+        LinkScenario scenario;
+        std::string error;
+        if (!ParseLinkScenario(text.str(), scenario, error)) {
+            std::cerr << name << ": " << error << std::endl;
+            return 1;
+        }
+        scenarios.push_back(std::move(scenario));
+    }
+
+    if (!options.timeline) {
+        PrintReportHeader();
+    }
+
+    for (LinkScenario& scenario : scenarios) {
+        if (overrideSeed) {
+            scenario.seed = seed;
+        }
+
+        for (const std::string& mode : abrModes) {
+            options.abrMode = mode;
+            SimReport report = RunScenario(scenario, options);
+
+            if (options.timeline) {
+                PrintReportHeader();
+            }
+            PrintReport(report);
+            if (options.timeline) {
+                std::printf("\n");
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * @file QuicLoopMain.cpp
+ * @brief rdc_quicloop: frames e cursor em loopback, UDP do P2PManager contra QUICTransport
+ *
+ * Os dois peers ficam no mesmo processo, em 127.0.0.1. O cliente envia frames
+ * (--fps, --frame-bytes) e posições de cursor (--cursor-hz); o servidor mede a latência
+ * envio → entrega e a fração entregue:
+ * - p2p-udp:     P2PManager::SendFrame (um datagrama por frame) e SendControlMessage
+ * - quic-stream: QUICTransport::SendFrame (um stream unidirecional por frame) e
+ *                SendDatagram (QUIC DATAGRAM) para o cursor
+ *
+ * Frames acima de ~64 KB não cabem em um datagrama UDP: o caminho p2p-udp falha, o QUIC
+ * não. Para comparar com perda/atraso, aplique netem no loopback antes de rodar (ex:
+ * tc qdisc add dev lo root netem delay 10ms loss 2%). O QUIC precisa de msquic no build
+ * (RDC_WITH_MSQUIC) e de um certificado para o servidor (--cert/--key, autoassinado serve).
+ */
+
+#include "OptimizationLayer.h"
+#include "P2PManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t CURSOR_MESSAGE_BYTES = 24;
+constexpr uint64_t DRAIN_MS = 500;
+constexpr uint32_t CONNECT_TIMEOUT_MS = 3000;
+
+struct LoopOptions {
+    uint32_t seconds = 5;
+    uint32_t fps = 60;
+    size_t frameBytes = 43200;          // 120x90 BGRA: cabe em um datagrama
+    uint32_t cursorHz = 125;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    bool skipUdp = false;
+};
+
+struct LatencySeries {
+    uint64_t sent = 0;
+    uint64_t sendFailures = 0;
+    std::vector<double> latenciesMs;
+
+    double Percentile(double fraction) {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latenciesMs.size() - 1,
+                                static_cast<size_t>(fraction * latenciesMs.size()));
+        std::nth_element(latenciesMs.begin(), latenciesMs.begin() + index, latenciesMs.end());
+        return latenciesMs[index];
+    }
+
+    double DeliveredPercent() const {
+        return sent ? 100.0 * latenciesMs.size() / sent : 0.0;
+    }
+};
+
+uint64_t NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::vector<uint8_t> MakeMessage(size_t size, uint64_t nowUs) {
+    std::vector<uint8_t> message(std::max(size, sizeof(nowUs)), 0xA5);
+    std::memcpy(message.data(), &nowUs, sizeof(nowUs));
+    return message;
+}
+
+void Record(LatencySeries& series, const std::vector<uint8_t>& message) {
+    if (message.size() < sizeof(uint64_t)) {
+        return;
+    }
+    uint64_t sentUs = 0;
+    std::memcpy(&sentUs, message.data(), sizeof(sentUs));
+    series.latenciesMs.push_back((NowUs() - sentUs) / 1000.0);
+}
+
+void PrintRow(const char* path, LatencySeries& frames, LatencySeries& cursor, double rttMs, const std::string& extra) {
+    std::printf("%-12s %7llu %7llu %7.2f %7.2f %7.2f %7.2f %7.2f %8.2f %8.2f %7.2f%s%s\n",
+                path, static_cast<unsigned long long>(frames.sent),
+                static_cast<unsigned long long>(frames.sendFailures), frames.DeliveredPercent(),
+                frames.Percentile(0.50), frames.Percentile(0.95), frames.Percentile(0.99),
+                frames.Percentile(1.0), cursor.DeliveredPercent(), cursor.Percentile(0.99),
+                rttMs, extra.empty() ? "" : "  ", extra.c_str());
+}
+
+// Envia no ritmo de fps/cursorHz por options.seconds; poll() drena o receptor
+template <typename SendFrameFn, typename SendCursorFn, typename PollFn>
+void RunPaced(const LoopOptions& options, LatencySeries& frames, LatencySeries& cursor,
+              SendFrameFn sendFrame, SendCursorFn sendCursor, PollFn poll) {
+    uint64_t startUs = NowUs();
+    uint64_t endUs = startUs + static_cast<uint64_t>(options.seconds) * 1000000;
+    uint64_t drainEndUs = endUs + DRAIN_MS * 1000;
+    uint64_t nextFrameUs = startUs;
+    uint64_t nextCursorUs = startUs;
+
+    for (uint64_t nowUs = startUs; nowUs < drainEndUs; nowUs = NowUs()) {
+        if (nowUs < endUs) {
+            if (nowUs >= nextFrameUs) {
+                std::vector<uint8_t> frame = MakeMessage(options.frameBytes, NowUs());
+                frames.sent++;
+                if (!sendFrame(frame)) {
+                    frames.sendFailures++;
+                }
+                nextFrameUs += 1000000 / options.fps;
+            }
+            if (options.cursorHz > 0 && nowUs >= nextCursorUs) {
+                std::vector<uint8_t> message = MakeMessage(CURSOR_MESSAGE_BYTES, NowUs());
+                cursor.sent++;
+                if (!sendCursor(message)) {
+                    cursor.sendFailures++;
+                }
+                nextCursorUs += 1000000 / options.cursorHz;
+            }
+        }
+
+        poll();
+        uint64_t nextUs = std::min(nextFrameUs, options.cursorHz > 0 ? nextCursorUs : nextFrameUs);
+        if (NowUs() < nextUs) {
+            std::this_thread::sleep_for(std::chrono::microseconds(std::min<uint64_t>(nextUs - NowUs(), 500)));
+        }
+    }
+}
+
+void RunUdp(const LoopOptions& options) {
+    P2PManager server;
+    P2PManager client;
+    if (!server.InitializeAsServer(0) || !client.InitializeAsClient("127.0.0.1", server.GetLocalPort())) {
+        std::cerr << "p2p-udp: falha ao abrir sockets" << std::endl;
+        return;
+    }
+
+    // width/height só carregam o tamanho: uma linha de frameBytes
+    uint32_t stride = static_cast<uint32_t>(options.frameBytes);
+    uint32_t width = std::max<uint32_t>(1, stride / 4);
+    LatencySeries frames;
+    LatencySeries cursor;
+    std::vector<uint8_t> received;
+
+    RunPaced(options, frames, cursor,
+        [&](const std::vector<uint8_t>& frame) {
+            return client.SendFrame(frame.data(), width, 1, stride, static_cast<uint16_t>(frames.sent));
+        },
+        [&](const std::vector<uint8_t>& message) {
+            return client.SendControlMessage(PacketType::CURSOR_POSITION, message.data(), message.size());
+        },
+        [&]() {
+            client.ServiceTransportStats();
+            server.ServiceTransportStats();
+            uint32_t w = 0, h = 0, s = 0;
+            uint16_t sequence = 0;
+            while (server.ReceiveFrame(received, w, h, s, sequence)) {
+                Record(frames, received);
+            }
+            PacketType type;
+            while (server.ReceiveControlMessage(type, received)) {
+                if (type == PacketType::CURSOR_POSITION) {
+                    Record(cursor, received);
+                }
+            }
+            while (client.ReceiveControlMessage(type, received)) {
+            }
+        });
+
+    PrintRow("p2p-udp", frames, cursor, client.GetTransportStats().rttMs, "");
+}
+
+// false se não conectou ou nenhum frame chegou (o job de CI do msquic depende disso)
+bool RunQuic(const LoopOptions& options) {
+    QUICTransportConfig serverConfig;
+    serverConfig.certificateFile = options.certificateFile;
+    serverConfig.privateKeyFile = options.privateKeyFile;
+    QUICTransport server(serverConfig);
+    // Em produção o fingerprint chega pela sinalização; aqui vem do próprio arquivo
+    QUICTransportConfig clientConfig;
+    clientConfig.peerCertificateSha256 = server.GetCertificateFingerprint();
+    QUICTransport client(clientConfig);
+
+    if (!server.Listen(0) || !client.Initialize("127.0.0.1", server.GetLocalPort()) ||
+        !server.WaitConnected(CONNECT_TIMEOUT_MS)) {
+        std::cerr << "quic-stream: falha ao conectar" << std::endl;
+        return false;
+    }
+
+    LatencySeries frames;
+    LatencySeries cursor;
+    std::vector<uint8_t> received;
+
+    RunPaced(options, frames, cursor,
+        [&](const std::vector<uint8_t>& frame) {
+            return client.SendFrame(frame.data(), static_cast<uint32_t>(frame.size()));
+        },
+        [&](const std::vector<uint8_t>& message) {
+            return client.SendDatagram(message.data(), static_cast<uint32_t>(message.size()));
+        },
+        [&]() {
+            while (server.Receive(received)) {
+                Record(frames, received);
+            }
+            while (server.ReceiveDatagram(received)) {
+                Record(cursor, received);
+            }
+        });
+
+    QUICTransport::Stats stats = client.GetStats();
+    char extra[160];
+    std::snprintf(extra, sizeof(extra), "%s, cwnd %u B, abortados %llu, pacotes perdidos %llu/%llu",
+                  stats.bbr ? "BBR" : "Cubic", stats.congestionWindow,
+                  static_cast<unsigned long long>(stats.framesAborted),
+                  static_cast<unsigned long long>(stats.packetsLost),
+                  static_cast<unsigned long long>(stats.packetsSent));
+    PrintRow("quic-stream", frames, cursor, client.GetLatencyMs(), extra);
+    return !frames.latenciesMs.empty();
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_quicloop [opcoes]" << std::endl;
+    std::cout << "  --seconds <n>             - Duracao (padrao 5)." << std::endl;
+    std::cout << "  --fps <n>                 - Frames por segundo (padrao 60)." << std::endl;
+    std::cout << "  --frame-bytes <n>         - Tamanho do frame (padrao 43200)." << std::endl;
+    std::cout << "  --cursor-hz <n>           - Posicoes de cursor por segundo (padrao 125)." << std::endl;
+    std::cout << "  --cert <pem> --key <pem>  - Certificado do servidor QUIC." << std::endl;
+    std::cout << "  --quic-only               - So o caminho QUIC (sai com 1 se ele falhar)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    LoopOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--fps" && hasValue) {
+            options.fps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--frame-bytes" && hasValue) {
+            options.frameBytes = static_cast<size_t>(std::strtoull(args[++i].c_str(), nullptr, 10));
+        } else if (arg == "--cursor-hz" && hasValue) {
+            options.cursorHz = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--cert" && hasValue) {
+            options.certificateFile = args[++i];
+        } else if (arg == "--key" && hasValue) {
+            options.privateKeyFile = args[++i];
+        } else if (arg == "--quic-only") {
+            options.skipUdp = true;
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.seconds == 0 || options.fps == 0 || options.frameBytes < sizeof(uint64_t)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::printf("loopback, frames de %zu bytes @ %u fps, cursor %u Hz, %u s\n",
+                options.frameBytes, options.fps, options.cursorHz, options.seconds);
+    std::printf("%-12s %7s %7s %7s %7s %7s %7s %7s %8s %8s %7s\n", "caminho", "frames", "falhas",
+                "entr%", "p50", "p95", "p99", "max", "cur%", "cur p99", "rtt");
+
+    if (!options.skipUdp) {
+        RunUdp(options);
+    }
+    bool quicOk = false;
+    if (!QUICTransport::IsAvailable()) {
+        std::printf("%-12s build sem msquic (RDC_WITH_MSQUIC)\n", "quic-stream");
+    } else if (options.certificateFile.empty() || options.privateKeyFile.empty()) {
+        std::printf("%-12s requer --cert e --key\n", "quic-stream");
+    } else {
+        quicOk = RunQuic(options);
+    }
+    return (options.skipUdp && !quicOk) ? 1 : 0;
+}
@@ -0,0 +1,518 @@
+/**
+ * @file SimulcastMain.cpp
+ * @brief rdc_simulcast: viewers em links diferentes, alvo único contra camada por viewer
+ *
+ * Tempo virtual (passo de 1 ms), um EmulatedLink por viewer com perfis em rodízio
+ * (lan, wifi, dsl, mobile, 3g). O host codifica 3 camadas por frame com SimulcastEncoder
+ * (1/4, 1/2 e 1/1 da resolução) sobre o delta por tiles de SessionResume.h, e cada
+ * viewer tem o seu AdaptiveBitRateController (MODEL_BASED), alimentado como no
+ * rdc_netsim: feedback por frame e relatório de perda/latência a cada 100 ms.
+ * - single:    um alvo para todos, o menor entre os controladores (o que um
+ *              AdaptiveBitRateController único faria): todos na camada do mais lento
+ * - simulcast: cada viewer passa o próprio alvo para FanoutSender::UpdateViewerTarget
+ *
+ * Por viewer: camada final, resolução média dos frames decodificados, fração
+ * decodificável, latência p95 e trocas de camada.
+ */
+
+#include "FanoutSender.h"
+#include "LinkEmulator.h"
+#include "OptimizationLayer.h"
+#include "P2PManager.h"
+#include "SessionResume.h"
+#include "SimulcastEncoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t SIM_STEP_US = 1000;
+constexpr uint64_t DRAIN_MS = 1000;
+constexpr uint64_t FEEDBACK_INTERVAL_MS = 100;
+constexpr uint32_t BYTES_PER_PIXEL = 4;
+constexpr uint32_t TILE_SIZE = 8;
+constexpr uint32_t LAYER_COUNT = 3;
+constexpr uint32_t ABR_MAX_MBPS = 20;
+
+struct SimulcastOptions {
+    size_t viewers = 10;
+    uint32_t seconds = 30;
+    uint32_t fps = 30;
+    uint32_t size = 120;                // Camada de cima size x size (keyframe em um datagrama)
+    bool runSingle = true;
+    bool runSimulcast = true;
+    uint64_t seed = 11;
+};
+
+struct ViewerProfile {
+    const char* name;
+    LinkProfile link;
+};
+
+std::vector<ViewerProfile> BuildProfiles() {
+    std::vector<ViewerProfile> profiles(5);
+
+    profiles[0].name = "lan";
+    profiles[0].link.bandwidthKbps = 100000.0;
+    profiles[0].link.delayMs = 2.0;
+
+    profiles[1].name = "wifi";
+    profiles[1].link.bandwidthKbps = 20000.0;
+    profiles[1].link.delayMs = 10.0;
+    profiles[1].link.jitterMs = 2.0;
+    profiles[1].link.lossPercent = 0.2;
+
+    profiles[2].name = "dsl";
+    profiles[2].link.bandwidthKbps = 6000.0;
+    profiles[2].link.delayMs = 25.0;
+    profiles[2].link.lossPercent = 0.5;
+
+    profiles[3].name = "mobile";
+    profiles[3].link.bandwidthKbps = 3000.0;
+    profiles[3].link.delayMs = 50.0;
+    profiles[3].link.jitterMs = 5.0;
+    profiles[3].link.lossPercent = 0.5;
+
+    profiles[4].name = "3g";
+    profiles[4].link.bandwidthKbps = 1000.0;
+    profiles[4].link.delayMs = 80.0;
+    profiles[4].link.jitterMs = 8.0;
+    profiles[4].link.lossPercent = 1.0;
+
+    for (ViewerProfile& profile : profiles) {
+        profile.link.queueLimitBytes = 128 * 1024;
+    }
+    return profiles;
+}
+
+// Tela sintética: metade de cima rola 1 px por frame (texto), resto parado
+void RenderFrame(uint32_t index, uint32_t size, std::vector<uint8_t>& pixels) {
+    uint32_t stride = size * BYTES_PER_PIXEL;
+    pixels.resize(static_cast<size_t>(stride) * size);
+
+    for (uint32_t y = 0; y < size; ++y) {
+        uint8_t* row = pixels.data() + static_cast<size_t>(y) * stride;
+        bool scrolling = y < size / 2;
+        uint32_t line = scrolling ? y + index : y;
+        for (uint32_t x = 0; x < size; ++x) {
+            uint32_t hash = (line * 2654435761u) ^ ((x / 3) * 40503u);
+            uint8_t ink = scrolling && ((hash >> 13) & 3) == 0 ? 0x20 : 0xF0;
+            row[x * 4 + 0] = scrolling ? ink : static_cast<uint8_t>(x * 2);
+            row[x * 4 + 1] = scrolling ? ink : static_cast<uint8_t>(y * 2);
+            row[x * 4 + 2] = scrolling ? ink : 0x40;
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+}
+
+/**
+ * IVideoEncoder sobre o delta por tiles: keyframe = frame completo, demais = tiles
+ * alterados desde o frame anterior
+ */
+class TileDeltaEncoder : public IVideoEncoder {
+public:
+    bool Initialize(uint32_t width, uint32_t height, uint32_t targetBitrateKbps) override {
+        m_width = width;
+        m_height = height;
+        m_bitrateKbps = targetBitrateKbps;
+        m_previous.clear();
+        return width > 0 && height > 0;
+    }
+
+    bool EncodeFrame(const uint8_t* bgraPixels, uint32_t width, uint32_t height, uint32_t stride,
+                     EncodedFrame& outFrame, bool forceKeyframe) override {
+        if (width != m_width || height != m_height) {
+            return false;
+        }
+        uint32_t rowBytes = width * BYTES_PER_PIXEL;
+        m_current.resize(static_cast<size_t>(rowBytes) * height);
+        for (uint32_t y = 0; y < height; ++y) {
+            std::memcpy(m_current.data() + static_cast<size_t>(y) * rowBytes,
+                        bgraPixels + static_cast<size_t>(y) * stride, rowBytes);
+        }
+
+        bool keyframe = forceKeyframe || m_previous.empty();
+        outFrame.width = width;
+        outFrame.height = height;
+        outFrame.bitrate = m_bitrateKbps;
+        outFrame.isKeyframe = keyframe;
+        outFrame.timestamp = 0;
+
+        if (keyframe) {
+            outFrame.data = m_current;
+        } else {
+            uint32_t tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+            uint32_t tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+            m_dirtyTiles.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+            for (uint32_t y = 0; y < height; ++y) {
+                size_t rowOffset = static_cast<size_t>(y) * rowBytes;
+                for (uint32_t tx = 0; tx < tilesX; ++tx) {
+                    uint8_t& dirty = m_dirtyTiles[(y / TILE_SIZE) * tilesX + tx];
+                    uint32_t x = tx * TILE_SIZE;
+                    size_t offset = rowOffset + x * BYTES_PER_PIXEL;
+                    if (!dirty) {
+                        dirty = std::memcmp(m_current.data() + offset, m_previous.data() + offset,
+                                            std::min(TILE_SIZE, width - x) * BYTES_PER_PIXEL) != 0;
+                    }
+                }
+            }
+            EncodeTileDelta(m_current.data(), width, height, rowBytes, TILE_SIZE, m_dirtyTiles,
+                            static_cast<uint16_t>(m_stats.totalFramesEncoded), outFrame.data);
+        }
+
+        m_previous.swap(m_current);
+        m_stats.totalFramesEncoded++;
+        m_stats.totalBytesEncoded += outFrame.data.size();
+        return true;
+    }
+
+    bool EndEncode(std::vector<EncodedFrame>& outFrames) override {
+        outFrames.clear();
+        return true;
+    }
+
+    void SetTargetBitrate(uint32_t kbps) override { m_bitrateKbps = kbps; }
+
+    EncoderStats GetStats() const override { return m_stats; }
+
+    void Release() override { m_previous.clear(); }
+
+private:
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_bitrateKbps = 0;
+    std::vector<uint8_t> m_previous;
+    std::vector<uint8_t> m_current;
+    std::vector<uint8_t> m_dirtyTiles;
+    EncoderStats m_stats;
+};
+
+struct ViewerClient {
+    std::shared_ptr<EmulatedLink> link;
+    P2PManager transport;
+    FrameChainTracker tracker;
+    std::unique_ptr<AdaptiveBitRateController> abr;
+    FanoutSender::ViewerId id = 0;
+    size_t profile = 0;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> received;
+
+    // Janela de feedback (perda pelos buracos de sequência)
+    bool hasHighest = false;
+    uint16_t windowHighest = 0;
+    uint16_t reportedHighest = 0;
+    uint64_t windowReceived = 0;
+    double windowLatencySum = 0.0;
+
+    uint64_t framesDecoded = 0;
+    uint64_t pixelsDecoded = 0;
+    double targetKbpsSum = 0.0;
+    uint64_t targetSamples = 0;
+    std::vector<double> latenciesMs;
+
+    double Percentile(double fraction) {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(latenciesMs.size() - 1,
+                                static_cast<size_t>(fraction * latenciesMs.size()));
+        std::nth_element(latenciesMs.begin(), latenciesMs.begin() + index, latenciesMs.end());
+        return latenciesMs[index];
+    }
+};
+
+struct RunResult {
+    double encodeUsPerFrame = 0.0;
+    uint64_t framesPublished = 0;
+    double layerKbps[LAYER_COUNT] = {};
+};
+
+void PollClient(ViewerClient& client, const std::vector<uint64_t>& publishUs, uint64_t nowUs) {
+    uint32_t width = 0, height = 0, stride = 0;
+    uint16_t sequence = 0;
+
+    while (client.transport.ReceiveFrame(client.received, width, height, stride, sequence)) {
+        double latencyMs = (nowUs - publishUs[sequence]) / 1000.0;
+        client.abr->OnPacketFeedback(publishUs[sequence] / 1000.0, nowUs / 1000.0,
+                                     client.received.size() + sizeof(NetworkFrameHeader));
+
+        if (!client.hasHighest || static_cast<int16_t>(static_cast<uint16_t>(sequence - client.windowHighest)) > 0) {
+            if (!client.hasHighest) {
+                client.reportedHighest = static_cast<uint16_t>(sequence - 1);
+            }
+            client.windowHighest = sequence;
+            client.hasHighest = true;
+        }
+        client.windowReceived++;
+        client.windowLatencySum += latencyMs;
+
+        uint8_t flags = client.transport.GetLastFrameFlags();
+        if (!client.tracker.OnFrame(sequence, flags)) {
+            continue;
+        }
+
+        bool applied = true;
+        if (flags & FRAME_FLAG_KEYFRAME) {
+            client.frame = client.received;
+        } else {
+            applied = client.frame.size() == static_cast<size_t>(stride) * height &&
+                      ApplyTileDelta(client.received.data(), client.received.size(), client.frame.data(),
+                                     width, height, stride);
+        }
+        if (!applied) {
+            client.tracker.MarkUndecodable();
+            continue;
+        }
+        client.framesDecoded++;
+        client.pixelsDecoded += static_cast<uint64_t>(width) * height;
+        client.latenciesMs.push_back(latencyMs);
+    }
+
+    KeyframeRequestMessage request;
+    if (client.tracker.PollKeyframeRequest(nowUs / 1000, request)) {
+        client.transport.SendControlMessage(PacketType::KEYFRAME_REQUEST,
+                                            reinterpret_cast<const uint8_t*>(&request), sizeof(request));
+    }
+}
+
+// Relatório de 100 ms para o controlador do viewer
+void ReportFeedback(ViewerClient& client, uint64_t nowUs) {
+    uint16_t expected = static_cast<uint16_t>(client.windowHighest - client.reportedHighest);
+    double lossPercent = expected > client.windowReceived
+                             ? 100.0 * (expected - client.windowReceived) / expected : 0.0;
+    double latencyMs = client.windowReceived > 0 ? client.windowLatencySum / client.windowReceived : 0.0;
+
+    client.abr->UpdateMetrics(latencyMs, lossPercent, 0.0);
+    client.reportedHighest = client.windowHighest;
+    client.windowReceived = 0;
+    client.windowLatencySum = 0.0;
+    (void)nowUs;
+}
+
+RunResult RunSession(const SimulcastOptions& options, bool perViewerLayers,
+                     std::vector<std::unique_ptr<ViewerClient>>& outClients,
+                     std::vector<FanoutSender::ViewerStats>& outStats) {
+    std::vector<ViewerProfile> profiles = BuildProfiles();
+    LinkProfile returnPath;
+    returnPath.delayMs = 5.0;
+
+    std::vector<std::unique_ptr<IVideoEncoder>> encoders;
+    for (uint32_t i = 0; i < LAYER_COUNT; ++i) {
+        encoders.push_back(std::make_unique<TileDeltaEncoder>());
+    }
+    SimulcastEncoder simulcast(std::move(encoders), BuildDefaultSimulcastLayers(LAYER_COUNT));
+    simulcast.Initialize(options.size, options.size, ABR_MAX_MBPS * 1000);
+
+    FanoutSender fanout;
+    uint64_t nowUs = 0;
+
+    outClients.clear();
+    for (size_t v = 0; v < options.viewers; ++v) {
+        auto client = std::make_unique<ViewerClient>();
+        client->profile = v % profiles.size();
+        client->link = std::make_shared<EmulatedLink>(profiles[client->profile].link, options.seed + v);
+        client->link->SetProfile(EmulatedLink::Side::B, returnPath);
+        client->abr = std::make_unique<AdaptiveBitRateController>(0, ABR_MAX_MBPS);
+        client->abr->SetAdaptationMode(AdaptiveBitRateController::AdaptationMode::MODEL_BASED);
+        client->abr->SetTimeSource([&nowUs]() { return nowUs / 1000.0; });
+
+        auto hostSide = std::make_unique<P2PManager>();
+        hostSide->InitializeWithChannel(client->link->CreateEndpoint(EmulatedLink::Side::A), P2PManager::Role::SERVER);
+        client->transport.InitializeWithChannel(client->link->CreateEndpoint(EmulatedLink::Side::B),
+                                                P2PManager::Role::CLIENT);
+        client->id = fanout.AddViewer(std::move(hostSide));
+        outClients.push_back(std::move(client));
+    }
+
+    std::vector<uint64_t> publishUs(65536, 0);
+    std::vector<uint8_t> pixels;
+    std::vector<EncodedFrame> layers;
+    RunResult result;
+    double encodeUs = 0.0;
+
+    uint64_t endUs = static_cast<uint64_t>(options.seconds) * 1000000;
+    uint64_t drainEndUs = endUs + DRAIN_MS * 1000;
+    uint64_t frameIntervalUs = 1000000 / options.fps;
+    uint64_t nextFrameUs = 0;
+    uint64_t nextFeedbackUs = FEEDBACK_INTERVAL_MS * 1000;
+    uint32_t frameIndex = 0;
+
+    for (nowUs = 0; nowUs < drainEndUs; nowUs += SIM_STEP_US) {
+        if (nowUs < endUs && nowUs >= nextFrameUs) {
+            uint16_t sequence = static_cast<uint16_t>(frameIndex);
+            RenderFrame(frameIndex, options.size, pixels);
+            publishUs[sequence] = nowUs;
+
+            auto encodeStart = std::chrono::steady_clock::now();
+            simulcast.EncodeLayers(pixels.data(), options.size, options.size, options.size * BYTES_PER_PIXEL,
+                                   layers, fanout.KeyframeLayerMask(nowUs));
+            encodeUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - encodeStart).count();
+
+            for (const EncodedFrame& layer : layers) {
+                fanout.PublishFrame(layer, layer.width * BYTES_PER_PIXEL, sequence,
+                                    layer.isKeyframe ? 0 : FRAME_FLAG_TILE_DELTA);
+            }
+            result.framesPublished++;
+            frameIndex++;
+            nextFrameUs += frameIntervalUs;
+        }
+
+        fanout.Service(nowUs);
+
+        for (auto& client : outClients) {
+            client->link->AdvanceTo(nowUs);
+            PollClient(*client, publishUs, nowUs);
+        }
+
+        // Controladores → camada de cada viewer (ou a do mais lento para todos)
+        if (nowUs >= nextFeedbackUs && nowUs <= endUs) {
+            double minTargetKbps = 0.0;
+            for (size_t v = 0; v < outClients.size(); ++v) {
+                ReportFeedback(*outClients[v], nowUs);
+                double targetKbps = outClients[v]->abr->GetTargetBitrateKbps();
+                minTargetKbps = v == 0 ? targetKbps : std::min(minTargetKbps, targetKbps);
+            }
+            for (auto& client : outClients) {
+                double targetKbps = perViewerLayers ? client->abr->GetTargetBitrateKbps() : minTargetKbps;
+                fanout.UpdateViewerTarget(client->id, targetKbps, nowUs);
+                client->targetKbpsSum += targetKbps;
+                client->targetSamples++;
+            }
+            nextFeedbackUs += FEEDBACK_INTERVAL_MS * 1000;
+        }
+    }
+
+    outStats = fanout.GetViewerStats();
+    if (result.framesPublished > 0) {
+        result.encodeUsPerFrame = encodeUs / result.framesPublished;
+    }
+    for (uint8_t layer = 0; layer < LAYER_COUNT; ++layer) {
+        result.layerKbps[layer] = fanout.GetLayerBitrateKbps(layer);
+    }
+    return result;
+}
+
+void PrintRun(const char* mode, const SimulcastOptions& options, const RunResult& result,
+              std::vector<std::unique_ptr<ViewerClient>>& clients,
+              const std::vector<FanoutSender::ViewerStats>& stats) {
+    std::vector<ViewerProfile> profiles = BuildProfiles();
+
+    std::printf("\n[%s] encode %.1f us/frame (%u camadas), camadas: %.0f / %.0f / %.0f kbps\n", mode,
+                result.encodeUsPerFrame, LAYER_COUNT, result.layerKbps[0], result.layerKbps[1],
+                result.layerKbps[2]);
+    std::printf("%-4s %-7s %9s %7s %7s %8s %8s %7s %7s\n", "id", "perfil", "alvo kbps", "camada",
+                "trocas", "res med", "decod%", "p50", "p95");
+
+    for (size_t v = 0; v < clients.size() && v < stats.size(); ++v) {
+        ViewerClient& client = *clients[v];
+        double meanSide = client.framesDecoded
+            ? std::sqrt(static_cast<double>(client.pixelsDecoded) / client.framesDecoded) : 0.0;
+        double decodedPercent = result.framesPublished ? 100.0 * client.framesDecoded / result.framesPublished : 0.0;
+        double targetKbps = client.targetSamples ? client.targetKbpsSum / client.targetSamples : 0.0;
+        std::printf("%-4zu %-7s %9.0f %7u %7llu %8.1f %8.1f %7.1f %7.1f\n", v + 1,
+                    profiles[client.profile].name, targetKbps, stats[v].layer,
+                    static_cast<unsigned long long>(stats[v].layerSwitches), meanSide, decodedPercent,
+                    client.Percentile(0.50), client.Percentile(0.95));
+    }
+
+    // Resumo por perfil
+    std::printf("%-7s %8s %8s\n", "perfil", "res med", "decod%");
+    for (size_t p = 0; p < profiles.size(); ++p) {
+        double sideSum = 0.0, decodedSum = 0.0;
+        size_t count = 0;
+        for (auto& client : clients) {
+            if (client->profile != p || client->framesDecoded == 0) {
+                continue;
+            }
+            sideSum += std::sqrt(static_cast<double>(client->pixelsDecoded) / client->framesDecoded);
+            decodedSum += 100.0 * client->framesDecoded / result.framesPublished;
+            count++;
+        }
+        if (count > 0) {
+            std::printf("%-7s %8.1f %8.1f\n", profiles[p].name, sideSum / count, decodedSum / count);
+        }
+    }
+    (void)options;
+}
+
+void PrintUsage() {
+    std::cout << "Uso: rdc_simulcast [opcoes]" << std::endl;
+    std::cout << "  --viewers <n>            - Viewers (padrao 10)." << std::endl;
+    std::cout << "  --seconds <n>            - Duracao virtual (padrao 30)." << std::endl;
+    std::cout << "  --fps <n>                - Frames por segundo da fonte (padrao 30)." << std::endl;
+    std::cout << "  --size <n>               - Lado da camada de cima em pixels (padrao 120)." << std::endl;
+    std::cout << "  --mode <both|single|simulcast>" << std::endl;
+    std::cout << "  --seed <n>               - Seed dos links (padrao 11)." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    SimulcastOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "--viewers" && hasValue) {
+            options.viewers = static_cast<size_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--fps" && hasValue) {
+            options.fps = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--size" && hasValue) {
+            options.size = static_cast<uint32_t>(std::atoi(args[++i].c_str()));
+        } else if (arg == "--mode" && hasValue) {
+            const std::string& mode = args[++i];
+            options.runSingle = mode == "both" || mode == "single";
+            options.runSimulcast = mode == "both" || mode == "simulcast";
+            if (!options.runSingle && !options.runSimulcast) {
+                std::cerr << "Modo desconhecido: " << mode << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        } else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.viewers == 0 || options.seconds == 0 || options.fps == 0 || options.size < 4 * TILE_SIZE) {
+        PrintUsage();
+        return 1;
+    }
+    if (static_cast<size_t>(options.size) * options.size * BYTES_PER_PIXEL + sizeof(NetworkFrameHeader) > 65507) {
+        std::cerr << "Keyframe nao cabe em um datagrama UDP: reduza --size" << std::endl;
+        return 1;
+    }
+
+    std::printf("%zu viewers, %ux%u @ %u fps, %u s virtuais, perfis em rodizio: lan, wifi, dsl, mobile, 3g\n",
+                options.viewers, options.size, options.size, options.fps, options.seconds);
+
+    std::vector<std::unique_ptr<ViewerClient>> clients;
+    std::vector<FanoutSender::ViewerStats> stats;
+    if (options.runSingle) {
+        RunResult result = RunSession(options, false, clients, stats);
+        PrintRun("single", options, result, clients, stats);
+    }
+    if (options.runSimulcast) {
+        RunResult result = RunSession(options, true, clients, stats);
+        PrintRun("simulcast", options, result, clients, stats);
+    }
+    return 0;
+}